@@ -0,0 +1,104 @@
+// The global operator new and delete, and the operator new[] overloads EASTL allocates with. Shared by every
+// executable in the solution, so the benchmarks count their allocations the same way the application does.
+
+#include "MemoryTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+#if SCRAP_MEMORY_TRACKING_ENABLED
+// Everything allocated through new is counted against the current SCRAP_MEMORY_TAG. The sized and nothrow versions
+// forward to these.
+void* operator new(size_t size)
+{
+    void* pointer = scrap::MemoryTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    if(pointer == nullptr) { throw std::bad_alloc(); }
+    return pointer;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* pointer = scrap::MemoryTracker::allocate(size, (size_t)alignment);
+    if(pointer == nullptr) { throw std::bad_alloc(); }
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    scrap::MemoryTracker::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept
+{
+    scrap::MemoryTracker::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    scrap::MemoryTracker::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t /*alignment*/) noexcept
+{
+    scrap::MemoryTracker::free(pointer);
+}
+
+// eastl new operators. EASTL frees with the global operator delete[], so these have to allocate through the tracker
+// too.
+void* operator new[](size_t size,
+                     const char* /*pName*/,
+                     int /*flags*/,
+                     unsigned /*debugFlags*/,
+                     const char* /*file*/,
+                     int /*line*/)
+{
+    return scrap::MemoryTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size,
+                     size_t alignment,
+                     size_t alignmentOffset,
+                     const char* /*pName*/,
+                     int /*flags*/,
+                     unsigned /*debugFlags*/,
+                     const char* /*file*/,
+                     int /*line*/)
+{
+    return scrap::MemoryTracker::allocate(size, alignment, alignmentOffset);
+}
+#else
+// eastl new operators
+void* operator new[](size_t size,
+                     const char* /*pName*/,
+                     int /*flags*/,
+                     unsigned /*debugFlags*/,
+                     const char* /*file*/,
+                     int /*line*/)
+{
+    return malloc(size);
+}
+
+void* operator new[](size_t size,
+                     size_t alignment,
+                     size_t alignmentOffset,
+                     const char* /*pName*/,
+                     int /*flags*/,
+                     unsigned /*debugFlags*/,
+                     const char* /*file*/,
+                     int /*line*/)
+{
+    return _aligned_offset_malloc(size, alignment, alignmentOffset);
+}
+#endif
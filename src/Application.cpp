@@ -1,10 +1,17 @@
 #include "Application.h"
 
+#include "AsyncLog.h"
+#include "CpuProfiler.h"
 #include "FrameInfo.h"
+#include "FramePipeline.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
 #include "RenderScene.h"
 #include "Window.h"
 #include "d3d12/D3D12Context.h"
 
+#include <algorithm>
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
 #include <fmt/chrono.h>
@@ -12,11 +19,20 @@
 
 namespace scrap
 {
-Application::Application()
+Application::Application(DeviceBackend deviceBackend,
+                         const d3d12::CommandCaptureParams& commandCaptureParams,
+                         const FramePipelineParams& framePipelineParams,
+                         const d3d12::FramePacingParams& framePacingParams,
+                         const d3d12::GpuProfilerParams& gpuProfilerParams,
+                         const GpuMemoryParams& gpuMemoryParams,
+                         const StressSceneConfig* stressSceneConfig,
+                         const InputRecordingParams& inputRecordingParams)
     : mApplicationStartTime(std::chrono::steady_clock::now())
 {
     spdlog::info("Starting application");
 
+    mJobSystem = std::make_unique<JobSystem>();
+
     if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0)
     {
         spdlog::critical("Failed to initialize SDL '{}'", SDL_GetError());
@@ -33,7 +49,9 @@ Application::Application()
         return;
     }
 
-    mD3D12Context = std::make_unique<d3d12::DeviceContext>(*mMainWindow, GpuPreference::None);
+    mD3D12Context = std::make_unique<d3d12::DeviceContext>(*mMainWindow, GpuPreference::None, deviceBackend,
+                                                           d3d12::NullDeviceOptions{}, commandCaptureParams,
+                                                           framePacingParams, gpuProfilerParams, gpuMemoryParams);
 
     if(!mD3D12Context->isInitialized())
     {
@@ -41,7 +59,7 @@ Application::Application()
         return;
     }
 
-    mRenderScene = std::make_unique<RenderScene>();
+    mRenderScene = std::make_unique<RenderScene>(stressSceneConfig);
 
     if(!mRenderScene->isInitialized())
     {
@@ -52,12 +70,78 @@ Application::Application()
     mD3D12Context->getCopyContext().endFrame();
     mD3D12Context->getCopyContext().beginFrame();
 
+    if(!inputRecordingParams.replayFilePath.empty())
+    {
+        tl::expected<InputRecording, InputRecordingError> recording =
+            LoadInputRecording(inputRecordingParams.replayFilePath);
+
+        if(!recording.has_value())
+        {
+            spdlog::critical("Failed to load input recording '{}'. {}", inputRecordingParams.replayFilePath.string(),
+                             recording.error());
+            return;
+        }
+
+        mInputPlayer = std::make_unique<InputPlayer>(std::move(recording.value()), inputRecordingParams.fixedTimestep);
+
+        if(inputRecordingParams.fixedTimestep.count() > 0)
+        {
+            spdlog::info("Replaying {} frames of input from '{}' with a fixed {} timestep",
+                         mInputPlayer->getFrameCount(), inputRecordingParams.replayFilePath.string(),
+                         std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+                             inputRecordingParams.fixedTimestep));
+        }
+        else
+        {
+            spdlog::info("Replaying {} frames of input from '{}' with the recorded timesteps",
+                         mInputPlayer->getFrameCount(), inputRecordingParams.replayFilePath.string());
+        }
+    }
+
+    if(!inputRecordingParams.recordFilePath.empty())
+    {
+        mInputRecorder = std::make_unique<InputRecorder>();
+        mInputRecordFilePath = inputRecordingParams.recordFilePath;
+        spdlog::info("Recording input to '{}'", mInputRecordFilePath.string());
+    }
+
+    mFrameTimingRecorder = std::make_unique<FrameTimingRecorder>(framePipelineParams.timingReportInterval);
+
+    if(framePipelineParams.snapshotCount > 0)
+    {
+        mFramePipeline = std::make_unique<FramePipeline>(framePipelineParams.snapshotCount);
+        mRenderThread = std::thread([this]() { runRenderThread(); });
+
+        spdlog::info("Rendering on a separate thread with {} RenderParams snapshots",
+                     mFramePipeline->getSnapshotCount());
+    }
+    else
+    {
+        mRenderParams = std::make_unique<RenderParams>();
+    }
+
     spdlog::info("Application initialized");
     mRunning = true;
+    mInputReplayStartTime = std::chrono::steady_clock::now();
 }
 
 Application::~Application()
 {
+    stopRenderThread();
+
+    if(mInputRecorder != nullptr)
+    {
+        const InputRecording& recording = mInputRecorder->getRecording();
+        if(std::optional<InputRecordingError> error = SaveInputRecording(mInputRecordFilePath, recording))
+        {
+            spdlog::error("Failed to save input recording '{}'. {}", mInputRecordFilePath.string(), error.value());
+        }
+        else
+        {
+            spdlog::info("Saved {} frames of input to '{}'", recording.frames.size(), mInputRecordFilePath.string());
+        }
+    }
+
     mRenderScene.reset();
     mD3D12Context.reset();
     if(SDL_WasInit(0) != 0) { SDL_Quit(); }
@@ -70,6 +154,24 @@ Application::operator bool() const
 
 void Application::update()
 {
+    SCRAP_CPU_ZONE("Application::update");
+
+    if(mInputPlayer != nullptr && mInputPlayer->isFinished())
+    {
+        const size_t frameCount = mInputPlayer->getFrameCount();
+        const std::chrono::duration<double> replayTime = std::chrono::steady_clock::now() - mInputReplayStartTime;
+        spdlog::info("Input replay finished. {} frames in {:.3f} s, {:.3f} ms per frame", frameCount,
+                     replayTime.count(), replayTime.count() * 1000.0 / (double)std::max<size_t>(frameCount, 1));
+
+        mRunning = false;
+        stopRenderThread();
+        return;
+    }
+
+    // Waiting for a free snapshot before sampling the input keeps the wait out of the input latency
+    RenderParams* renderParams = (mFramePipeline != nullptr) ? mFramePipeline->beginSimulation() : mRenderParams.get();
+    if(renderParams == nullptr) { return; }
+
     auto now = std::chrono::steady_clock::now();
     mFrameDelta = now - mLastFrameTime;
     mLastFrameTime = now;
@@ -79,32 +181,38 @@ void Application::update()
 
     mMainWindow->beginFrame();
 
+    // A replay dictates the frame's timing along with its input
+    const std::optional<ReplayedInputFrame> replayedFrame =
+        (mInputPlayer != nullptr) ? mInputPlayer->nextFrame() : std::nullopt;
+
     FrameInfo frameInfo;
-    frameInfo.runtime = now - mApplicationStartTime;
+    frameInfo.runtime = replayedFrame.has_value() ? replayedFrame->runtime : now - mApplicationStartTime;
     frameInfo.runtimeSec = std::chrono::duration_cast<std::chrono::duration<float>>(frameInfo.runtime);
-    frameInfo.frameDelta = mFrameDelta;
-    frameInfo.frameDeltaSec = std::chrono::duration_cast<std::chrono::duration<float>>(mFrameDelta);
+    frameInfo.frameDelta = replayedFrame.has_value() ? replayedFrame->frameDelta : mFrameDelta;
+    frameInfo.frameDeltaSec = std::chrono::duration_cast<std::chrono::duration<float>>(frameInfo.frameDelta);
     frameInfo.mainWindow = mMainWindow.get();
     frameInfo.keyboard = &mKeyboard;
     frameInfo.mouse = &mMouse;
 
+    if(mInputRecorder != nullptr) { mInputRecorder->beginFrame(frameInfo.runtime, frameInfo.frameDelta); }
+
     SDL_Event event;
     while(SDL_PollEvent(&event))
     {
         switch(event.type)
         {
         case SDL_QUIT:
-            spdlog::debug("Event SDL_QUIT");
+            SCRAP_LOG_DEBUG("Event SDL_QUIT");
             mRunning = false;
             break;
-        case SDL_APP_TERMINATING: spdlog::debug("Event SDL_APP_TERMINATING"); break;
-        case SDL_APP_LOWMEMORY: spdlog::debug("Event SDL_APP_LOWMEMORY"); break;
-        case SDL_APP_WILLENTERBACKGROUND: spdlog::debug("Event SDL_APP_WILLENTERBACKGROUND"); break;
-        case SDL_APP_DIDENTERBACKGROUND: spdlog::debug("Event SDL_APP_DIDENTERBACKGROUND"); break;
-        case SDL_APP_WILLENTERFOREGROUND: spdlog::debug("Event SDL_APP_WILLENTERFOREGROUND"); break;
-        case SDL_APP_DIDENTERFOREGROUND: spdlog::debug("Event SDL_APP_DIDENTERFOREGROUND"); break;
-        case SDL_LOCALECHANGED: spdlog::debug("Event SDL_LOCALECHANGED"); break;
-        case SDL_DISPLAYEVENT: spdlog::debug("Event SDL_DISPLAYEVENT"); break;
+        case SDL_APP_TERMINATING: SCRAP_LOG_DEBUG("Event SDL_APP_TERMINATING"); break;
+        case SDL_APP_LOWMEMORY: SCRAP_LOG_DEBUG("Event SDL_APP_LOWMEMORY"); break;
+        case SDL_APP_WILLENTERBACKGROUND: SCRAP_LOG_DEBUG("Event SDL_APP_WILLENTERBACKGROUND"); break;
+        case SDL_APP_DIDENTERBACKGROUND: SCRAP_LOG_DEBUG("Event SDL_APP_DIDENTERBACKGROUND"); break;
+        case SDL_APP_WILLENTERFOREGROUND: SCRAP_LOG_DEBUG("Event SDL_APP_WILLENTERFOREGROUND"); break;
+        case SDL_APP_DIDENTERFOREGROUND: SCRAP_LOG_DEBUG("Event SDL_APP_DIDENTERFOREGROUND"); break;
+        case SDL_LOCALECHANGED: SCRAP_LOG_DEBUG("Event SDL_LOCALECHANGED"); break;
+        case SDL_DISPLAYEVENT: SCRAP_LOG_DEBUG("Event SDL_DISPLAYEVENT"); break;
         case SDL_WINDOWEVENT:
             if(event.window.windowID == SDL_GetWindowID(mMainWindow->sdlWindow()))
             {
@@ -112,8 +220,8 @@ void Application::update()
             }
             else
             {
-                spdlog::debug("Event SDL_WINDOWEVENT. WindowEventId {}, data1 {}, data2 {}", event.window.event,
-                              event.window.data1, event.window.data2);
+                SCRAP_LOG_DEBUG("Event SDL_WINDOWEVENT. WindowEventId {}, data1 {}, data2 {}", event.window.event,
+                                event.window.data1, event.window.data2);
             }
             break;
         case SDL_SYSWMEVENT:
@@ -124,8 +232,8 @@ void Application::update()
                 const DWORD dpiY = HIWORD(event.syswm.msg->msg.win.wParam);
                 const HWND windowHandle = event.syswm.msg->msg.win.hwnd;
 
-                spdlog::debug("Event SDL_SYSWMEVENT. WM_DPICHANGED: dpiX {}, dpiY {}, HWND {}", dpiX, dpiY,
-                              (void*)windowHandle);
+                SCRAP_LOG_DEBUG("Event SDL_SYSWMEVENT. WM_DPICHANGED: dpiX {}, dpiY {}, HWND {}", dpiX, dpiY,
+                                (void*)windowHandle);
 
                 // TODO: set the new window size based on the dpi
                 // TODO: remake the swap chain
@@ -134,91 +242,152 @@ void Application::update()
             }
             break;
         case SDL_KEYDOWN:
-            mKeyboard.handleEvent(event.key);
-            if(event.key.windowID == SDL_GetWindowID(mMainWindow->sdlWindow())) { mMainWindow->handleEvent(event.key); }
-            break;
         case SDL_KEYUP:
-            mKeyboard.handleEvent(event.key);
-            if(event.key.windowID == SDL_GetWindowID(mMainWindow->sdlWindow())) { mMainWindow->handleEvent(event.key); }
+            // The recorded input replaces the live input during a replay
+            if(mInputPlayer == nullptr) { handleInputEvent(event); }
             break;
-        case SDL_TEXTEDITING: spdlog::debug("Event SDL_TEXTEDITING"); break;
-        case SDL_TEXTINPUT: spdlog::debug("Event SDL_TEXTINPUT"); break;
-        case SDL_KEYMAPCHANGED: spdlog::debug("Event SDL_KEYMAPCHANGED"); break;
+        case SDL_TEXTEDITING: SCRAP_LOG_DEBUG("Event SDL_TEXTEDITING"); break;
+        case SDL_TEXTINPUT: SCRAP_LOG_DEBUG("Event SDL_TEXTINPUT"); break;
+        case SDL_KEYMAPCHANGED: SCRAP_LOG_DEBUG("Event SDL_KEYMAPCHANGED"); break;
         case SDL_MOUSEMOTION:
-            spdlog::debug("Event SDL_MOUSEMOTION");
-            mMouse.handleEvent(event.motion);
-            if(event.motion.windowID == SDL_GetWindowID(mMainWindow->sdlWindow()))
-            {
-                mMainWindow->handleEvent(event.motion);
-            }
-            break;
         case SDL_MOUSEBUTTONDOWN:
-            spdlog::debug("Event SDL_MOUSEBUTTONDOWN");
-            mMouse.handleEvent(event.button);
-            if(event.button.windowID == SDL_GetWindowID(mMainWindow->sdlWindow()))
-            {
-                mMainWindow->handleEvent(event.button);
-            }
-            break;
         case SDL_MOUSEBUTTONUP:
-            spdlog::debug("Event SDL_MOUSEBUTTONUP");
-            mMouse.handleEvent(event.button);
-            if(event.button.windowID == SDL_GetWindowID(mMainWindow->sdlWindow()))
-            {
-                mMainWindow->handleEvent(event.button);
-            }
-            break;
         case SDL_MOUSEWHEEL:
-            spdlog::debug("Event SDL_MOUSEWHEEL");
-            mMouse.handleEvent(event.wheel);
-            if(event.wheel.windowID == SDL_GetWindowID(mMainWindow->sdlWindow()))
-            {
-                mMainWindow->handleEvent(event.wheel);
-            }
+            if(mInputPlayer == nullptr) { handleInputEvent(event); }
             break;
-        case SDL_JOYAXISMOTION: spdlog::debug("Event SDL_JOYAXISMOTION"); break;
-        case SDL_JOYBALLMOTION: spdlog::debug("Event SDL_JOYBALLMOTION"); break;
-        case SDL_JOYHATMOTION: spdlog::debug("Event SDL_JOYHATMOTION"); break;
-        case SDL_JOYBUTTONDOWN: spdlog::debug("Event SDL_JOYBUTTONDOWN"); break;
-        case SDL_JOYBUTTONUP: spdlog::debug("Event SDL_JOYBUTTONUP"); break;
-        case SDL_JOYDEVICEADDED: spdlog::debug("Event SDL_JOYDEVICEADDED"); break;
-        case SDL_JOYDEVICEREMOVED: spdlog::debug("Event SDL_JOYDEVICEREMOVED"); break;
-        case SDL_CONTROLLERAXISMOTION: spdlog::debug("Event SDL_CONTROLLERAXISMOTION"); break;
-        case SDL_CONTROLLERBUTTONDOWN: spdlog::debug("Event SDL_CONTROLLERBUTTONDOWN"); break;
-        case SDL_CONTROLLERBUTTONUP: spdlog::debug("Event SDL_CONTROLLERBUTTONUP"); break;
-        case SDL_CONTROLLERDEVICEADDED: spdlog::debug("Event SDL_CONTROLLERDEVICEADDED"); break;
-        case SDL_CONTROLLERDEVICEREMOVED: spdlog::debug("Event SDL_CONTROLLERDEVICEREMOVED"); break;
-        case SDL_CONTROLLERDEVICEREMAPPED: spdlog::debug("Event SDL_CONTROLLERDEVICEREMAPPED"); break;
-        case SDL_CONTROLLERTOUCHPADDOWN: spdlog::debug("Event SDL_CONTROLLERTOUCHPADDOWN"); break;
-        case SDL_CONTROLLERTOUCHPADMOTION: spdlog::debug("Event SDL_CONTROLLERTOUCHPADMOTION"); break;
-        case SDL_CONTROLLERTOUCHPADUP: spdlog::debug("Event SDL_CONTROLLERTOUCHPADUP"); break;
-        case SDL_CONTROLLERSENSORUPDATE: spdlog::debug("Event SDL_CONTROLLERSENSORUPDATE"); break;
-        case SDL_FINGERDOWN: spdlog::debug("Event SDL_FINGERDOWN"); break;
-        case SDL_FINGERUP: spdlog::debug("Event SDL_FINGERUP"); break;
-        case SDL_FINGERMOTION: spdlog::debug("Event SDL_FINGERMOTION"); break;
-        case SDL_DOLLARGESTURE: spdlog::debug("Event SDL_DOLLARGESTURE"); break;
-        case SDL_DOLLARRECORD: spdlog::debug("Event SDL_DOLLARRECORD"); break;
-        case SDL_MULTIGESTURE: spdlog::debug("Event SDL_MULTIGESTURE"); break;
-        case SDL_CLIPBOARDUPDATE: spdlog::debug("Event SDL_CLIPBOARDUPDATE"); break;
-        case SDL_DROPFILE: spdlog::debug("Event SDL_DROPFILE"); break;
-        case SDL_DROPTEXT: spdlog::debug("Event SDL_DROPTEXT"); break;
-        case SDL_DROPBEGIN: spdlog::debug("Event SDL_DROPBEGIN"); break;
-        case SDL_DROPCOMPLETE: spdlog::debug("Event SDL_DROPCOMPLETE"); break;
-        case SDL_AUDIODEVICEADDED: spdlog::debug("Event SDL_AUDIODEVICEADDED"); break;
-        case SDL_AUDIODEVICEREMOVED: spdlog::debug("Event SDL_AUDIODEVICEREMOVED"); break;
-        case SDL_SENSORUPDATE: spdlog::debug("Event SDL_SENSORUPDATE"); break;
-        case SDL_RENDER_TARGETS_RESET: spdlog::debug("Event SDL_RENDER_TARGETS_RESET"); break;
-        case SDL_RENDER_DEVICE_RESET: spdlog::debug("Event SDL_RENDER_DEVICE_RESET"); break;
-        case SDL_USEREVENT: spdlog::debug("Event SDL_USEREVENT"); break;
-        default: spdlog::debug("Unknown SDL event: {0} ({0:#x})", event.type);
+        case SDL_JOYAXISMOTION: SCRAP_LOG_DEBUG("Event SDL_JOYAXISMOTION"); break;
+        case SDL_JOYBALLMOTION: SCRAP_LOG_DEBUG("Event SDL_JOYBALLMOTION"); break;
+        case SDL_JOYHATMOTION: SCRAP_LOG_DEBUG("Event SDL_JOYHATMOTION"); break;
+        case SDL_JOYBUTTONDOWN: SCRAP_LOG_DEBUG("Event SDL_JOYBUTTONDOWN"); break;
+        case SDL_JOYBUTTONUP: SCRAP_LOG_DEBUG("Event SDL_JOYBUTTONUP"); break;
+        case SDL_JOYDEVICEADDED: SCRAP_LOG_DEBUG("Event SDL_JOYDEVICEADDED"); break;
+        case SDL_JOYDEVICEREMOVED: SCRAP_LOG_DEBUG("Event SDL_JOYDEVICEREMOVED"); break;
+        case SDL_CONTROLLERAXISMOTION: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERAXISMOTION"); break;
+        case SDL_CONTROLLERBUTTONDOWN: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERBUTTONDOWN"); break;
+        case SDL_CONTROLLERBUTTONUP: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERBUTTONUP"); break;
+        case SDL_CONTROLLERDEVICEADDED: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERDEVICEADDED"); break;
+        case SDL_CONTROLLERDEVICEREMOVED: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERDEVICEREMOVED"); break;
+        case SDL_CONTROLLERDEVICEREMAPPED: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERDEVICEREMAPPED"); break;
+        case SDL_CONTROLLERTOUCHPADDOWN: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERTOUCHPADDOWN"); break;
+        case SDL_CONTROLLERTOUCHPADMOTION: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERTOUCHPADMOTION"); break;
+        case SDL_CONTROLLERTOUCHPADUP: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERTOUCHPADUP"); break;
+        case SDL_CONTROLLERSENSORUPDATE: SCRAP_LOG_DEBUG("Event SDL_CONTROLLERSENSORUPDATE"); break;
+        case SDL_FINGERDOWN: SCRAP_LOG_DEBUG("Event SDL_FINGERDOWN"); break;
+        case SDL_FINGERUP: SCRAP_LOG_DEBUG("Event SDL_FINGERUP"); break;
+        case SDL_FINGERMOTION: SCRAP_LOG_DEBUG("Event SDL_FINGERMOTION"); break;
+        case SDL_DOLLARGESTURE: SCRAP_LOG_DEBUG("Event SDL_DOLLARGESTURE"); break;
+        case SDL_DOLLARRECORD: SCRAP_LOG_DEBUG("Event SDL_DOLLARRECORD"); break;
+        case SDL_MULTIGESTURE: SCRAP_LOG_DEBUG("Event SDL_MULTIGESTURE"); break;
+        case SDL_CLIPBOARDUPDATE: SCRAP_LOG_DEBUG("Event SDL_CLIPBOARDUPDATE"); break;
+        case SDL_DROPFILE: SCRAP_LOG_DEBUG("Event SDL_DROPFILE"); break;
+        case SDL_DROPTEXT: SCRAP_LOG_DEBUG("Event SDL_DROPTEXT"); break;
+        case SDL_DROPBEGIN: SCRAP_LOG_DEBUG("Event SDL_DROPBEGIN"); break;
+        case SDL_DROPCOMPLETE: SCRAP_LOG_DEBUG("Event SDL_DROPCOMPLETE"); break;
+        case SDL_AUDIODEVICEADDED: SCRAP_LOG_DEBUG("Event SDL_AUDIODEVICEADDED"); break;
+        case SDL_AUDIODEVICEREMOVED: SCRAP_LOG_DEBUG("Event SDL_AUDIODEVICEREMOVED"); break;
+        case SDL_SENSORUPDATE: SCRAP_LOG_DEBUG("Event SDL_SENSORUPDATE"); break;
+        case SDL_RENDER_TARGETS_RESET: SCRAP_LOG_DEBUG("Event SDL_RENDER_TARGETS_RESET"); break;
+        case SDL_RENDER_DEVICE_RESET: SCRAP_LOG_DEBUG("Event SDL_RENDER_DEVICE_RESET"); break;
+        case SDL_USEREVENT: SCRAP_LOG_DEBUG("Event SDL_USEREVENT"); break;
+        default: SCRAP_LOG_DEBUG("Unknown SDL event: {0} ({0:#x})", event.type);
         }
     }
 
-    mRenderScene->preRender(frameInfo);
+    if(replayedFrame.has_value())
+    {
+        const uint32_t mainWindowId = SDL_GetWindowID(mMainWindow->sdlWindow());
+        for(const RecordedInputEvent& recordedEvent : replayedFrame->events)
+        {
+            handleInputEvent(ToSdlEvent(recordedEvent, mainWindowId));
+        }
+    }
+
+    // Everything the frame reacts to has been polled by now
+    const std::chrono::steady_clock::time_point inputTime = std::chrono::steady_clock::now();
+
+    mRenderScene->simulate(frameInfo, *renderParams);
+    renderParams->frameNumber = mFrameNumber++;
+    renderParams->inputTime = inputTime;
+
+    if(mFramePipeline == nullptr)
+    {
+        renderFrame(*renderParams);
+        return;
+    }
+
+    mFramePipeline->endSimulation();
+
+    // The render thread finishes the frames that were already published before it stops
+    if(!mRunning) { stopRenderThread(); }
+}
+
+void Application::handleInputEvent(const SDL_Event& event)
+{
+    const uint32_t mainWindowId = SDL_GetWindowID(mMainWindow->sdlWindow());
+
+    if(mInputRecorder != nullptr)
+    {
+        if(std::optional<RecordedInputEvent> recordedEvent = RecordInputEvent(event, mainWindowId))
+        {
+            mInputRecorder->addEvent(recordedEvent.value());
+        }
+    }
+
+    switch(event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        mKeyboard.handleEvent(event.key);
+        if(event.key.windowID == mainWindowId) { mMainWindow->handleEvent(event.key); }
+        break;
+    case SDL_MOUSEMOTION:
+        SCRAP_LOG_DEBUG("Event SDL_MOUSEMOTION");
+        mMouse.handleEvent(event.motion);
+        if(event.motion.windowID == mainWindowId) { mMainWindow->handleEvent(event.motion); }
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        SCRAP_LOG_DEBUG("Event {}", (event.type == SDL_MOUSEBUTTONDOWN) ? "SDL_MOUSEBUTTONDOWN" : "SDL_MOUSEBUTTONUP");
+        mMouse.handleEvent(event.button);
+        if(event.button.windowID == mainWindowId) { mMainWindow->handleEvent(event.button); }
+        break;
+    case SDL_MOUSEWHEEL:
+        SCRAP_LOG_DEBUG("Event SDL_MOUSEWHEEL");
+        mMouse.handleEvent(event.wheel);
+        if(event.wheel.windowID == mainWindowId) { mMainWindow->handleEvent(event.wheel); }
+        break;
+    }
+}
+
+void Application::renderFrame(const RenderParams& renderParams)
+{
+    SCRAP_CPU_ZONE("Application::renderFrame");
+
+    mRenderScene->preRender(renderParams);
     mD3D12Context->beginFrame();
-    mRenderScene->render(frameInfo, *mD3D12Context);
-    mRenderScene->endFrame();
+    mRenderScene->render(renderParams, *mD3D12Context);
+    mFrameTimingRecorder->addFrame(renderParams.inputTime, std::chrono::steady_clock::now());
+    mRenderScene->endFrame(renderParams);
     mD3D12Context->endFrame();
+
+    mFrameTimingRecorder->report((mFramePipeline != nullptr) ? "Pipelined" : "Serial");
+}
+
+void Application::runRenderThread()
+{
+    SCRAP_CPU_THREAD_NAME("Render");
+
+    while(const RenderParams* renderParams = mFramePipeline->beginRender())
+    {
+        renderFrame(*renderParams);
+        mFramePipeline->endRender();
+    }
+}
+
+void Application::stopRenderThread()
+{
+    if(mFramePipeline != nullptr) { mFramePipeline->stop(); }
+    if(mRenderThread.joinable()) { mRenderThread.join(); }
 }
 
 } // namespace scrap
\ No newline at end of file
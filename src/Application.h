@@ -4,46 +4,100 @@
 // holds (that need it).
 //
 // The event handling is routed by SDL and then handled as needed here.
+//
+// Every frame is split into a simulation stage and a render stage. The simulation stage pumps the events and advances
+// the scene on the main thread, then hands a RenderParams snapshot to the render stage. By default the render stage
+// runs right after it on the same thread. With FramePipelineParams::snapshotCount set, it runs on a render thread
+// instead, recording one frame while the main thread simulates the next.
+//
+// With InputRecordingParams the keyboard and mouse events and the frame times can be recorded to a file, or replayed
+// from one in place of the live input. The application quits when a replay runs out of frames.
 
 #pragma once
 
 #include "Keyboard.h"
 #include "Mouse.h"
+#include "RenderDefs.h"
 
 #include <chrono>
+#include <filesystem>
 #include <memory>
+#include <thread>
+
+union SDL_Event;
 
 namespace scrap
 {
 namespace d3d12
 {
 class DeviceContext;
+struct CommandCaptureParams;
+struct FramePacingParams;
+struct GpuProfilerParams;
 }
 
+class FramePipeline;
+class FrameTimingRecorder;
+class InputPlayer;
+class InputRecorder;
+class JobSystem;
 class RenderScene;
 class Window;
+struct FramePipelineParams;
+struct GpuMemoryParams;
+struct InputRecordingParams;
+struct RenderParams;
+struct StressSceneConfig;
 
 class Application
 {
 public:
-    Application();
+    Application(DeviceBackend deviceBackend,
+                const d3d12::CommandCaptureParams& commandCaptureParams,
+                const FramePipelineParams& framePipelineParams,
+                const d3d12::FramePacingParams& framePacingParams,
+                const d3d12::GpuProfilerParams& gpuProfilerParams,
+                const GpuMemoryParams& gpuMemoryParams,
+                const StressSceneConfig* stressSceneConfig,
+                const InputRecordingParams& inputRecordingParams);
     ~Application();
 
     operator bool() const;
 
+    // Runs the simulation stage of a frame. Also runs the render stage unless it has its own thread.
     void update();
 
 private:
+    // Routes a keyboard or mouse event to the keyboard, mouse and main window, recording it if input is being recorded
+    void handleInputEvent(const SDL_Event& event);
+    void renderFrame(const RenderParams& renderParams);
+    void runRenderThread();
+    void stopRenderThread();
+
+    // Declared first so every other object is destroyed before it, in case they have jobs still in flight
+    std::unique_ptr<JobSystem> mJobSystem;
     std::unique_ptr<Window> mMainWindow;
     Keyboard mKeyboard;
     Mouse mMouse;
+    std::unique_ptr<InputRecorder> mInputRecorder;
+    std::filesystem::path mInputRecordFilePath;
+    std::unique_ptr<InputPlayer> mInputPlayer;
     std::unique_ptr<d3d12::DeviceContext> mD3D12Context;
     std::unique_ptr<RenderScene> mRenderScene;
     bool mRunning = false;
 
+    // Only one of these is used. The pipeline when the render stage has its own thread, otherwise the single snapshot.
+    std::unique_ptr<FramePipeline> mFramePipeline;
+    std::unique_ptr<RenderParams> mRenderParams;
+    std::thread mRenderThread;
+    // Owned by whichever thread runs the render stage
+    std::unique_ptr<FrameTimingRecorder> mFrameTimingRecorder;
+    uint64_t mFrameNumber = 0;
+
     std::chrono::steady_clock::time_point mApplicationStartTime;
     std::chrono::steady_clock::time_point mLastFrameTime;
     std::chrono::nanoseconds mFrameDelta{0};
+    std::chrono::steady_clock::time_point mInputReplayStartTime;
 };
 
 } // namespace scrap
\ No newline at end of file
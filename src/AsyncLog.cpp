@@ -0,0 +1,255 @@
+#include "AsyncLog.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace scrap
+{
+AsyncLogRingBuffer::AsyncLogRingBuffer(size_t capacity)
+    : mBuffer(std::make_unique<std::byte[]>(capacity))
+    , mCapacity(capacity)
+{
+    assert(std::has_single_bit(capacity));
+    assert(capacity % kRecordAlignment == 0);
+}
+
+std::byte* AsyncLogRingBuffer::beginWrite(uint32_t byteSize)
+{
+    assert(byteSize % kRecordAlignment == 0);
+
+    uint64_t writePosition = mWritePosition.load(std::memory_order_relaxed);
+    const size_t offset = writePosition & (mCapacity - 1);
+    const size_t contiguousByteSize = mCapacity - offset;
+
+    // Records never wrap around the end of the buffer. The rest of it is skipped instead.
+    const size_t skippedByteSize = (contiguousByteSize < byteSize) ? contiguousByteSize : 0;
+    const uint64_t requiredPosition = writePosition + skippedByteSize + byteSize;
+
+    if(requiredPosition - mCachedReadPosition > mCapacity)
+    {
+        mCachedReadPosition = mReadPosition.load(std::memory_order_acquire);
+        if(requiredPosition - mCachedReadPosition > mCapacity) { return nullptr; }
+    }
+
+    if(skippedByteSize > 0)
+    {
+        // Too small for a header means the consumer skips it without being told
+        if(skippedByteSize >= sizeof(AsyncLogRecordHeader))
+        {
+            AsyncLogRecordHeader* padding = new(mBuffer.get() + offset) AsyncLogRecordHeader;
+            padding->formatFunction = nullptr;
+            padding->byteSize = (uint32_t)skippedByteSize;
+        }
+
+        writePosition += skippedByteSize;
+    }
+
+    mPendingWritePosition = writePosition;
+
+    return mBuffer.get() + (writePosition & (mCapacity - 1));
+}
+
+void AsyncLogRingBuffer::endWrite(uint32_t byteSize)
+{
+    mWritePosition.store(mPendingWritePosition + byteSize, std::memory_order_release);
+}
+
+const AsyncLogRecordHeader* AsyncLogRingBuffer::peek()
+{
+    uint64_t readPosition = mReadPosition.load(std::memory_order_relaxed);
+    const uint64_t writePosition = mWritePosition.load(std::memory_order_acquire);
+
+    while(readPosition != writePosition)
+    {
+        const size_t offset = readPosition & (mCapacity - 1);
+        const size_t contiguousByteSize = mCapacity - offset;
+
+        if(contiguousByteSize < sizeof(AsyncLogRecordHeader))
+        {
+            readPosition += contiguousByteSize;
+            continue;
+        }
+
+        const auto* header = reinterpret_cast<const AsyncLogRecordHeader*>(mBuffer.get() + offset);
+        if(header->formatFunction == nullptr)
+        {
+            readPosition += header->byteSize;
+            continue;
+        }
+
+        mPeekPosition = readPosition;
+        mPeekByteSize = header->byteSize;
+        return header;
+    }
+
+    return nullptr;
+}
+
+void AsyncLogRingBuffer::pop()
+{
+    mReadPosition.store(mPeekPosition + mPeekByteSize, std::memory_order_release);
+}
+
+bool AsyncLogRingBuffer::isEmpty() const
+{
+    return mReadPosition.load(std::memory_order_acquire) == mWritePosition.load(std::memory_order_acquire);
+}
+
+AsyncLog* AsyncLog::sInstance = nullptr;
+std::atomic<spdlog::level::level_enum> AsyncLog::sLevel{spdlog::level::info};
+std::atomic<uint64_t> AsyncLog::sNextInstanceId{1};
+thread_local std::shared_ptr<AsyncLogRingBuffer> AsyncLog::tRingBuffer;
+thread_local uint64_t AsyncLog::tRingBufferInstanceId = 0;
+
+AsyncLog::AsyncLog(std::shared_ptr<spdlog::logger> logger)
+    : mLogger(std::move(logger))
+    , mInstanceId(sNextInstanceId.fetch_add(1, std::memory_order_relaxed))
+{
+    assert(sInstance == nullptr);
+
+    setLevel(mLogger->level());
+
+    mFormatterThread = std::thread([this]() { runFormatter(); });
+
+    sInstance = this;
+}
+
+AsyncLog::~AsyncLog()
+{
+    assert(sInstance == this);
+    sInstance = nullptr;
+
+    {
+        std::lock_guard lockGuard(mWakeMutex);
+        mStopping = true;
+    }
+
+    mWakeCondition.notify_one();
+    mFormatterThread.join();
+}
+
+void AsyncLog::flush()
+{
+    std::unique_lock lock(mWakeMutex);
+
+    const uint64_t flushRequest = ++mFlushRequestCount;
+    mWakeCondition.notify_one();
+
+    mFlushedCondition.wait(lock, [this, flushRequest]() { return mFlushCompletedCount >= flushRequest; });
+}
+
+uint64_t AsyncLog::getDroppedRecordCount() const
+{
+    std::lock_guard lockGuard(mRingBuffersMutex);
+
+    uint64_t droppedRecordCount = 0;
+    for(const std::shared_ptr<AsyncLogRingBuffer>& ringBuffer : mRingBuffers)
+    {
+        droppedRecordCount += ringBuffer->getDroppedRecordCount();
+    }
+
+    return droppedRecordCount;
+}
+
+AsyncLogRingBuffer* AsyncLog::getThreadRingBuffer()
+{
+    if(tRingBufferInstanceId == mInstanceId) { return tRingBuffer.get(); }
+
+    // The first message from this thread, or the first since a new AsyncLog was created
+    tRingBuffer = std::make_shared<AsyncLogRingBuffer>(kRingBufferByteSize);
+    tRingBufferInstanceId = mInstanceId;
+
+    std::lock_guard lockGuard(mRingBuffersMutex);
+    mRingBuffers.push_back(tRingBuffer);
+
+    return tRingBuffer.get();
+}
+
+void AsyncLog::runFormatter()
+{
+    while(true)
+    {
+        uint64_t flushRequest;
+        bool stopping;
+        {
+            std::unique_lock lock(mWakeMutex);
+            mWakeCondition.wait_for(lock, kFormatInterval, [this]() {
+                return mStopping || mFlushRequestCount != mFlushCompletedCount;
+            });
+
+            flushRequest = mFlushRequestCount;
+            stopping = mStopping;
+        }
+
+        // Anything logged before flush() was called is in a ring buffer by the time the request was read
+        const bool wroteMessages = drainRingBuffers();
+        if(wroteMessages || flushRequest != mFlushCompletedCount) { mLogger->flush(); }
+
+        {
+            std::lock_guard lockGuard(mWakeMutex);
+            mFlushCompletedCount = flushRequest;
+        }
+        mFlushedCondition.notify_all();
+
+        if(stopping) { break; }
+    }
+}
+
+bool AsyncLog::drainRingBuffers()
+{
+    mMessages.clear();
+    mText.clear();
+
+    uint64_t droppedRecordCount = 0;
+    {
+        std::lock_guard lockGuard(mRingBuffersMutex);
+
+        for(const std::shared_ptr<AsyncLogRingBuffer>& ringBuffer : mRingBuffers)
+        {
+            while(const AsyncLogRecordHeader* header = ringBuffer->peek())
+            {
+                mRecordText.clear();
+                header->formatFunction(std::string_view(header->format, header->formatLength),
+                                       reinterpret_cast<const std::byte*>(header + 1), mRecordText);
+
+                mMessages.push_back(FormattedMessage{.time = header->time,
+                                                     .level = header->level,
+                                                     .textOffset = mText.size(),
+                                                     .textLength = mRecordText.size()});
+                mText.append(mRecordText.data(), mRecordText.data() + mRecordText.size());
+
+                ringBuffer->pop();
+            }
+
+            droppedRecordCount += ringBuffer->getDroppedRecordCount();
+        }
+
+        // Ring buffers of threads that have exited are released once they have been drained
+        std::erase_if(mRingBuffers, [](const std::shared_ptr<AsyncLogRingBuffer>& ringBuffer) {
+            return ringBuffer.use_count() == 1 && ringBuffer->isEmpty() && ringBuffer->getDroppedRecordCount() == 0;
+        });
+    }
+
+    // Each ring buffer is in order, but different threads interleave
+    std::stable_sort(mMessages.begin(), mMessages.end(),
+                     [](const FormattedMessage& left, const FormattedMessage& right) {
+                         return left.time < right.time;
+                     });
+
+    for(const FormattedMessage& message : mMessages)
+    {
+        mLogger->log(message.time, spdlog::source_loc{}, message.level,
+                     spdlog::string_view_t(mText.data() + message.textOffset, message.textLength));
+    }
+
+    if(droppedRecordCount > mReportedDroppedRecordCount)
+    {
+        mLogger->warn("The async log dropped {} messages because a ring buffer was full",
+                      droppedRecordCount - mReportedDroppedRecordCount);
+        mReportedDroppedRecordCount = droppedRecordCount;
+    }
+
+    return !mMessages.empty();
+}
+} // namespace scrap
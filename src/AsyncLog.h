@@ -0,0 +1,316 @@
+// Classes:
+//   AsyncLogRingBuffer
+//   AsyncLog
+//
+// A logging path for hot loops, like the per event logging in Application::update. The SCRAP_LOG_* macros below the
+// compile time threshold SCRAP_LOG_LEVEL expand to nothing, so their arguments aren't even evaluated. The rest check
+// the runtime level and copy their arguments as bytes into a ring buffer that belongs to the calling thread. Nothing is
+// formatted, allocated or locked on the calling thread. A background thread formats the records and hands them to the
+// logger, which is also where the sinks get flushed.
+//
+// Arguments are copied when the message is logged and formatted later, so they have to be trivially copyable. Strings
+// (const char*, std::string_view and std::string) are the exception, their characters are copied into the record. The
+// format string has to outlive the AsyncLog, which string literals do.
+//
+// When there isn't an AsyncLog, the macros log through spdlog directly.
+//
+// AsyncLogRingBuffer:
+//   A single producer, single consumer ring buffer of variable sized records. The producer is the thread that owns it
+//   and the consumer is the AsyncLog's formatter thread. A record that doesn't fit is dropped and counted instead of
+//   waiting for the formatter to catch up.
+//
+// AsyncLog:
+//   Owns the ring buffers and the formatter thread. Every thread gets its ring buffer the first time it logs. Records
+//   from different threads are merged by time every time the formatter wakes up, which is every few milliseconds or
+//   when flush() is called.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+// Messages below this level are compiled out. Uses the SPDLOG_LEVEL_* values.
+#ifndef SCRAP_LOG_LEVEL
+#ifdef _DEBUG
+#define SCRAP_LOG_LEVEL SPDLOG_LEVEL_DEBUG
+#else
+#define SCRAP_LOG_LEVEL SPDLOG_LEVEL_INFO
+#endif
+#endif
+
+#if SCRAP_LOG_LEVEL <= SPDLOG_LEVEL_TRACE
+#define SCRAP_LOG_TRACE(...) ::scrap::AsyncLog::write(spdlog::level::trace, __VA_ARGS__)
+#else
+#define SCRAP_LOG_TRACE(...) (void)0
+#endif
+
+#if SCRAP_LOG_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define SCRAP_LOG_DEBUG(...) ::scrap::AsyncLog::write(spdlog::level::debug, __VA_ARGS__)
+#else
+#define SCRAP_LOG_DEBUG(...) (void)0
+#endif
+
+#if SCRAP_LOG_LEVEL <= SPDLOG_LEVEL_INFO
+#define SCRAP_LOG_INFO(...) ::scrap::AsyncLog::write(spdlog::level::info, __VA_ARGS__)
+#else
+#define SCRAP_LOG_INFO(...) (void)0
+#endif
+
+namespace scrap
+{
+struct AsyncLogRecordHeader
+{
+    using FormatFunction = void (*)(std::string_view format, const std::byte* arguments, fmt::memory_buffer& out);
+
+    // nullptr marks padding that skips to the start of the ring buffer
+    FormatFunction formatFunction;
+    const char* format;
+    uint32_t formatLength;
+    // Including the header and the alignment padding
+    uint32_t byteSize;
+    std::chrono::system_clock::time_point time;
+    spdlog::level::level_enum level;
+};
+
+namespace detail
+{
+template<class T>
+inline constexpr bool kIsAsyncLogString = std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                                          std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>;
+
+template<class T>
+using AsyncLogStoredType = std::conditional_t<kIsAsyncLogString<T>, std::string_view, T>;
+
+template<class T>
+size_t AsyncLogArgumentByteSize(const T& value)
+{
+    if constexpr(kIsAsyncLogString<T>) { return sizeof(uint32_t) + std::string_view(value).size(); }
+    else { return sizeof(T); }
+}
+
+template<class T>
+std::byte* EncodeAsyncLogArgument(std::byte* out, const T& value)
+{
+    if constexpr(kIsAsyncLogString<T>)
+    {
+        const std::string_view string(value);
+        const uint32_t length = (uint32_t)string.size();
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), string.data(), length);
+        return out + sizeof(length) + length;
+    }
+    else
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Async log arguments are copied as bytes and formatted later");
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+}
+
+template<class T>
+const std::byte* DecodeAsyncLogArgument(const std::byte* in, AsyncLogStoredType<T>& value)
+{
+    if constexpr(kIsAsyncLogString<T>)
+    {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof(length));
+        value = std::string_view(reinterpret_cast<const char*>(in + sizeof(length)), length);
+        return in + sizeof(length) + length;
+    }
+    else
+    {
+        std::memcpy(&value, in, sizeof(T));
+        return in + sizeof(T);
+    }
+}
+
+template<class... Args>
+void FormatAsyncLogRecord(std::string_view format, const std::byte* arguments, fmt::memory_buffer& out)
+{
+    std::tuple<AsyncLogStoredType<Args>...> values;
+    std::apply(
+        [&](auto&... value) {
+            ((arguments = DecodeAsyncLogArgument<Args>(arguments, value)), ...);
+            fmt::vformat_to(fmt::appender(out), format, fmt::make_format_args(value...));
+        },
+        values);
+}
+} // namespace detail
+
+class AsyncLogRingBuffer
+{
+public:
+    static constexpr size_t kRecordAlignment = alignof(AsyncLogRecordHeader);
+
+    // The capacity has to be a power of 2
+    explicit AsyncLogRingBuffer(size_t capacity);
+    AsyncLogRingBuffer(const AsyncLogRingBuffer&) = delete;
+    AsyncLogRingBuffer(AsyncLogRingBuffer&&) = delete;
+    ~AsyncLogRingBuffer() = default;
+
+    AsyncLogRingBuffer& operator=(const AsyncLogRingBuffer&) = delete;
+    AsyncLogRingBuffer& operator=(AsyncLogRingBuffer&&) = delete;
+
+    // Producer. Returns nullptr when there isn't room for the record. byteSize has to be a multiple of
+    // kRecordAlignment. Every beginWrite that returns a record has to be followed by an endWrite.
+    [[nodiscard]] std::byte* beginWrite(uint32_t byteSize);
+    void endWrite(uint32_t byteSize);
+    void addDroppedRecord() { mDroppedRecordCount.fetch_add(1, std::memory_order_relaxed); }
+
+    // Consumer. Returns the oldest record or nullptr when there isn't one. pop() releases the record returned by the
+    // last peek().
+    [[nodiscard]] const AsyncLogRecordHeader* peek();
+    void pop();
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] uint64_t getDroppedRecordCount() const { return mDroppedRecordCount.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<std::byte[]> mBuffer;
+    size_t mCapacity;
+
+    // Both positions only ever grow. The offset into the buffer is the position modulo the capacity.
+    alignas(64) std::atomic<uint64_t> mWritePosition{0};
+    uint64_t mPendingWritePosition = 0;
+    uint64_t mCachedReadPosition = 0;
+
+    alignas(64) std::atomic<uint64_t> mReadPosition{0};
+    uint64_t mPeekPosition = 0;
+    uint32_t mPeekByteSize = 0;
+
+    std::atomic<uint64_t> mDroppedRecordCount{0};
+};
+
+class AsyncLog
+{
+public:
+    static constexpr size_t kRingBufferByteSize = 64 * 1024;
+    static constexpr std::chrono::milliseconds kFormatInterval{2};
+
+    explicit AsyncLog(std::shared_ptr<spdlog::logger> logger);
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog(AsyncLog&&) = delete;
+    // Formats and flushes everything that was logged before it
+    ~AsyncLog();
+
+    AsyncLog& operator=(const AsyncLog&) = delete;
+    AsyncLog& operator=(AsyncLog&&) = delete;
+
+    // Can be nullptr
+    [[nodiscard]] static AsyncLog* instance() { return sInstance; }
+
+    // Messages below the runtime level are skipped before anything is copied. Starts at the logger's level.
+    static void setLevel(spdlog::level::level_enum level) { sLevel.store(level, std::memory_order_relaxed); }
+    [[nodiscard]] static spdlog::level::level_enum getLevel() { return sLevel.load(std::memory_order_relaxed); }
+
+    template<class... Args>
+    static void write(spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args);
+
+    // Returns once every message logged before the call has been written to the sinks and the sinks are flushed
+    void flush();
+
+    [[nodiscard]] uint64_t getDroppedRecordCount() const;
+
+private:
+    struct FormattedMessage
+    {
+        std::chrono::system_clock::time_point time;
+        spdlog::level::level_enum level;
+        size_t textOffset;
+        size_t textLength;
+    };
+
+    [[nodiscard]] AsyncLogRingBuffer* getThreadRingBuffer();
+
+    void runFormatter();
+    // Returns true if anything was written to the logger
+    bool drainRingBuffers();
+
+    static AsyncLog* sInstance;
+    static std::atomic<spdlog::level::level_enum> sLevel;
+
+    // Tells apart AsyncLogs that were created one after another at the same address
+    static std::atomic<uint64_t> sNextInstanceId;
+
+    thread_local static std::shared_ptr<AsyncLogRingBuffer> tRingBuffer;
+    thread_local static uint64_t tRingBufferInstanceId;
+
+    std::shared_ptr<spdlog::logger> mLogger;
+    const uint64_t mInstanceId;
+
+    mutable std::mutex mRingBuffersMutex;
+    std::vector<std::shared_ptr<AsyncLogRingBuffer>> mRingBuffers;
+
+    // Only used by the formatter thread
+    std::vector<FormattedMessage> mMessages;
+    fmt::memory_buffer mText;
+    fmt::memory_buffer mRecordText;
+    uint64_t mReportedDroppedRecordCount = 0;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mFlushedCondition;
+    uint64_t mFlushRequestCount = 0;
+    uint64_t mFlushCompletedCount = 0;
+    bool mStopping = false;
+
+    std::thread mFormatterThread;
+};
+
+template<class... Args>
+void AsyncLog::write(spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args)
+{
+    if(level < sLevel.load(std::memory_order_relaxed)) { return; }
+
+    AsyncLogRingBuffer* ringBuffer = (sInstance != nullptr) ? sInstance->getThreadRingBuffer() : nullptr;
+    if(ringBuffer == nullptr)
+    {
+        spdlog::log(level, format, std::forward<Args>(args)...);
+        return;
+    }
+
+    const size_t argumentByteSize = (detail::AsyncLogArgumentByteSize<std::decay_t<Args>>(args) + ... + size_t(0));
+    const size_t recordByteSize = sizeof(AsyncLogRecordHeader) + argumentByteSize;
+    const uint32_t byteSize =
+        (uint32_t)((recordByteSize + AsyncLogRingBuffer::kRecordAlignment - 1) &
+                   ~(AsyncLogRingBuffer::kRecordAlignment - 1));
+
+    std::byte* record = ringBuffer->beginWrite(byteSize);
+    if(record == nullptr)
+    {
+        ringBuffer->addDroppedRecord();
+        return;
+    }
+
+    const fmt::string_view formatString = format;
+
+    AsyncLogRecordHeader* header = new(record) AsyncLogRecordHeader;
+    header->formatFunction = &detail::FormatAsyncLogRecord<std::decay_t<Args>...>;
+    header->format = formatString.data();
+    header->formatLength = (uint32_t)formatString.size();
+    header->byteSize = byteSize;
+    header->time = std::chrono::system_clock::now();
+    header->level = level;
+
+    std::byte* arguments = record + sizeof(AsyncLogRecordHeader);
+    ((arguments = detail::EncodeAsyncLogArgument<std::decay_t<Args>>(arguments, args)), ...);
+
+    ringBuffer->endWrite(byteSize);
+}
+} // namespace scrap
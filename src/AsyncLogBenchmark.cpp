@@ -0,0 +1,85 @@
+#include "AsyncLogBenchmark.h"
+
+#include "AsyncLog.h"
+
+#include <memory>
+
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint32_t kBatchSize = 256;
+constexpr uint32_t kBatchCount = 1024;
+
+template<class LogFunction>
+std::chrono::nanoseconds TimeBatches(LogFunction&& logFunction, AsyncLog* asyncLog)
+{
+    std::chrono::nanoseconds totalTime{0};
+
+    for(uint32_t batch = 0; batch < kBatchCount; ++batch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t message = 0; message < kBatchSize; ++message)
+        {
+            logFunction(batch * kBatchSize + message);
+        }
+        totalTime += std::chrono::steady_clock::now() - start;
+
+        if(asyncLog != nullptr) { asyncLog->flush(); }
+    }
+
+    return totalTime / ((int64_t)kBatchSize * kBatchCount);
+}
+} // namespace
+
+AsyncLogBenchmarkReport RunAsyncLogBenchmark()
+{
+    AsyncLogBenchmarkReport report;
+    report.messageCount = kBatchSize * kBatchCount;
+
+    auto logger = std::make_shared<spdlog::logger>("benchmark", std::make_shared<spdlog::sinks::null_sink_mt>());
+    logger->set_level(spdlog::level::debug);
+
+    {
+        AsyncLog asyncLog(logger);
+
+        AsyncLog::setLevel(spdlog::level::info);
+        report.filteredTime = TimeBatches(
+            [](uint32_t index) {
+                AsyncLog::write(spdlog::level::debug, "Event {} at {:.3f}, {}", index, 0.5f * index, "SDL_MOUSEMOTION");
+            },
+            &asyncLog);
+
+        AsyncLog::setLevel(spdlog::level::debug);
+        report.asyncTime = TimeBatches(
+            [](uint32_t index) {
+                AsyncLog::write(spdlog::level::debug, "Event {} at {:.3f}, {}", index, 0.5f * index, "SDL_MOUSEMOTION");
+            },
+            &asyncLog);
+
+        if(asyncLog.getDroppedRecordCount() > 0)
+        {
+            spdlog::warn("The async log benchmark dropped {} messages", asyncLog.getDroppedRecordCount());
+        }
+    }
+
+    report.syncTime = TimeBatches(
+        [&logger](uint32_t index) {
+            logger->debug("Event {} at {:.3f}, {}", index, 0.5f * index, "SDL_MOUSEMOTION");
+        },
+        nullptr);
+
+    return report;
+}
+
+void LogAsyncLogBenchmarkReport(const AsyncLogBenchmarkReport& report)
+{
+    spdlog::info("Async log benchmark, {} messages per case", report.messageCount);
+    spdlog::info("    Filtered: {} ns per message", report.filteredTime.count());
+    spdlog::info("    Async:    {} ns per message", report.asyncTime.count());
+    spdlog::info("    Sync:     {} ns per message", report.syncTime.count());
+}
+} // namespace scrap
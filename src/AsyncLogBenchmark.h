@@ -0,0 +1,32 @@
+// Measures what a log call costs the thread that makes it. Each case logs the same message with an integer, a float and
+// a string argument to a logger without sinks, so only the cost of the logging path is measured and not the cost of
+// writing to the console. Has to run before main creates the AsyncLog the engine uses.
+//
+// Filtered: the message is below the runtime level. This is the cost of a verbose message with verbose logging off.
+// Async: the message is written to the calling thread's ring buffer. Formatting happens on the formatter thread and
+// isn't timed. The ring buffer is flushed between batches, so no messages are dropped.
+// Sync: spdlog formats the message on the calling thread, which is what spdlog::debug did in Application::update.
+//
+// Messages below SCRAP_LOG_LEVEL compile to nothing and cost nothing.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace scrap
+{
+struct AsyncLogBenchmarkReport
+{
+    uint32_t messageCount = 0;
+
+    // Per message
+    std::chrono::nanoseconds filteredTime{0};
+    std::chrono::nanoseconds asyncTime{0};
+    std::chrono::nanoseconds syncTime{0};
+};
+
+[[nodiscard]] AsyncLogBenchmarkReport RunAsyncLogBenchmark();
+
+void LogAsyncLogBenchmarkReport(const AsyncLogBenchmarkReport& report);
+} // namespace scrap
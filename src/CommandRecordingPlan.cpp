@@ -0,0 +1,55 @@
+#include "CommandRecordingPlan.h"
+
+#include <algorithm>
+
+namespace scrap
+{
+CommandRecordingPlan::CommandRecordingPlan(size_t itemCount, uint32_t workerCount, size_t minItemsPerChunk)
+    : mItemCount(itemCount)
+    , mWorkerCount(std::max(workerCount, 1u))
+{
+    // An empty draw list still gets its one (empty) chunk, so every plan has at least one chunk to submit
+    if(itemCount == 0)
+    {
+        mChunks.push_back(RecordingChunk{});
+        return;
+    }
+
+    minItemsPerChunk = std::max(minItemsPerChunk, size_t(1));
+
+    // One chunk per worker at most. Small draw lists aren't worth spreading out since every chunk has to rebind all of
+    // the pass state in its own command list.
+    const size_t chunkCount = std::clamp(itemCount / minItemsPerChunk, size_t(1), size_t(mWorkerCount));
+
+    // The first (itemCount % chunkCount) chunks get one extra item
+    const size_t baseChunkSize = itemCount / chunkCount;
+    const size_t remainder = itemCount % chunkCount;
+
+    mChunks.reserve(chunkCount);
+
+    size_t begin = 0;
+    for(size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        RecordingChunk chunk;
+        chunk.index = (uint32_t)chunkIndex;
+        chunk.workerIndex = (uint32_t)(chunkIndex % mWorkerCount);
+        chunk.begin = begin;
+        chunk.count = baseChunkSize + ((chunkIndex < remainder) ? 1 : 0);
+
+        begin += chunk.count;
+        mChunks.push_back(chunk);
+    }
+}
+
+std::vector<uint32_t> CommandRecordingPlan::getWorkerChunkIndices(uint32_t workerIndex) const
+{
+    std::vector<uint32_t> chunkIndices;
+
+    for(const RecordingChunk& chunk : mChunks)
+    {
+        if(chunk.workerIndex == workerIndex) { chunkIndices.push_back(chunk.index); }
+    }
+
+    return chunkIndices;
+}
+} // namespace scrap
@@ -0,0 +1,57 @@
+// Classes:
+//   CommandRecordingPlan
+//
+// CommandRecordingPlan:
+//   Splits a pass's draw list into contiguous chunks so that each chunk can be recorded into its own command list on a
+//   separate thread. The split only depends on the item count, worker count and minimum chunk size, so the same inputs
+//   always produce the same chunks in the same order. Submitting the recorded command lists in chunk order gives the
+//   same GPU command stream as recording everything serially. Nothing in here touches the device. The d3d12 side lives
+//   in D3D12ParallelCommandRecorder.
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace scrap
+{
+struct RecordingChunk
+{
+    // Position of the chunk in the submission order
+    uint32_t index = 0;
+    uint32_t workerIndex = 0;
+    size_t begin = 0;
+    size_t count = 0;
+
+    [[nodiscard]] size_t end() const { return begin + count; }
+};
+
+class CommandRecordingPlan
+{
+public:
+    CommandRecordingPlan() = default;
+    CommandRecordingPlan(size_t itemCount, uint32_t workerCount, size_t minItemsPerChunk);
+    CommandRecordingPlan(const CommandRecordingPlan&) = default;
+    CommandRecordingPlan(CommandRecordingPlan&&) = default;
+    ~CommandRecordingPlan() = default;
+
+    CommandRecordingPlan& operator=(const CommandRecordingPlan&) = default;
+    CommandRecordingPlan& operator=(CommandRecordingPlan&&) = default;
+
+    [[nodiscard]] size_t getItemCount() const { return mItemCount; }
+    [[nodiscard]] uint32_t getWorkerCount() const { return mWorkerCount; }
+
+    // Chunks in submission order. Chunk i covers the items right after chunk i - 1. There is always at least one chunk,
+    // an empty draw list has a single chunk with no items.
+    [[nodiscard]] std::span<const RecordingChunk> getChunks() const { return mChunks; }
+
+    // Indices of the chunks assigned to the worker, in the order the worker should record them.
+    [[nodiscard]] std::vector<uint32_t> getWorkerChunkIndices(uint32_t workerIndex) const;
+
+private:
+    size_t mItemCount = 0;
+    uint32_t mWorkerCount = 0;
+    std::vector<RecordingChunk> mChunks;
+};
+} // namespace scrap
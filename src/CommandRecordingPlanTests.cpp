@@ -0,0 +1,119 @@
+#include "CommandRecordingPlan.h"
+#include "UnitTest.h"
+
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+// The minimum chunk size the raster renderer records its objects with
+constexpr size_t kMinObjectsPerChunk = 256;
+
+bool ChunksCoverItemsInOrder(const CommandRecordingPlan& plan)
+{
+    size_t begin = 0;
+    for(size_t chunkIndex = 0; chunkIndex < plan.getChunks().size(); ++chunkIndex)
+    {
+        const RecordingChunk& chunk = plan.getChunks()[chunkIndex];
+        if(chunk.index != chunkIndex || chunk.begin != begin) { return false; }
+
+        begin = chunk.end();
+    }
+
+    return begin == plan.getItemCount();
+}
+} // namespace
+
+SCRAP_TEST(CommandRecordingPlan, IsDeterministic)
+{
+    const CommandRecordingPlan planA(10000, 6, kMinObjectsPerChunk);
+    const CommandRecordingPlan planB(10000, 6, kMinObjectsPerChunk);
+
+    SCRAP_REQUIRE(planA.getChunks().size() == planB.getChunks().size());
+    for(size_t chunkIndex = 0; chunkIndex < planA.getChunks().size(); ++chunkIndex)
+    {
+        const RecordingChunk& chunkA = planA.getChunks()[chunkIndex];
+        const RecordingChunk& chunkB = planB.getChunks()[chunkIndex];
+        SCRAP_CHECK(chunkA.index == chunkB.index);
+        SCRAP_CHECK(chunkA.workerIndex == chunkB.workerIndex);
+        SCRAP_CHECK(chunkA.begin == chunkB.begin);
+        SCRAP_CHECK(chunkA.count == chunkB.count);
+    }
+}
+
+SCRAP_TEST(CommandRecordingPlan, RespectsMinimumChunkSize)
+{
+    for(size_t itemCount : {255u, 256u, 511u, 512u, 1000u, 1536u, 10000u})
+    {
+        const CommandRecordingPlan plan(itemCount, 8, kMinObjectsPerChunk);
+        SCRAP_CHECK(ChunksCoverItemsInOrder(plan));
+
+        // Only a draw list smaller than the minimum has a smaller chunk, and then it's the only one
+        for(const RecordingChunk& chunk : plan.getChunks())
+        {
+            SCRAP_CHECK(chunk.count >= kMinObjectsPerChunk || plan.getChunks().size() == 1);
+        }
+    }
+
+    SCRAP_CHECK(CommandRecordingPlan(511, 8, kMinObjectsPerChunk).getChunks().size() == 1);
+    SCRAP_CHECK(CommandRecordingPlan(512, 8, kMinObjectsPerChunk).getChunks().size() == 2);
+    SCRAP_CHECK(CommandRecordingPlan(1000, 8, kMinObjectsPerChunk).getChunks().size() == 3);
+}
+
+SCRAP_TEST(CommandRecordingPlan, SpreadsRemainderOverFirstChunks)
+{
+    const CommandRecordingPlan plan(1000, 3, kMinObjectsPerChunk);
+
+    SCRAP_REQUIRE(plan.getChunks().size() == 3);
+    SCRAP_CHECK(plan.getChunks()[0].count == 334);
+    SCRAP_CHECK(plan.getChunks()[1].count == 333);
+    SCRAP_CHECK(plan.getChunks()[2].count == 333);
+}
+
+SCRAP_TEST(CommandRecordingPlan, HasOneChunkPerWorkerAtMost)
+{
+    const CommandRecordingPlan plan(100000, 4, kMinObjectsPerChunk);
+
+    SCRAP_REQUIRE(plan.getChunks().size() == 4);
+    SCRAP_CHECK(ChunksCoverItemsInOrder(plan));
+
+    for(uint32_t workerIndex = 0; workerIndex < 4; ++workerIndex)
+    {
+        SCRAP_CHECK(plan.getWorkerChunkIndices(workerIndex) == std::vector<uint32_t>{workerIndex});
+    }
+}
+
+SCRAP_TEST(CommandRecordingPlan, SubmitsChunksInItemOrder)
+{
+    const CommandRecordingPlan plan(5000, 6, kMinObjectsPerChunk);
+
+    SCRAP_CHECK(plan.getChunks().size() == 6);
+    SCRAP_CHECK(ChunksCoverItemsInOrder(plan));
+}
+
+SCRAP_TEST(CommandRecordingPlan, EmptyAndSingleItemHaveOneChunk)
+{
+    const CommandRecordingPlan emptyPlan(0, 8, kMinObjectsPerChunk);
+    SCRAP_REQUIRE(emptyPlan.getChunks().size() == 1);
+    SCRAP_CHECK(emptyPlan.getChunks()[0].begin == 0);
+    SCRAP_CHECK(emptyPlan.getChunks()[0].count == 0);
+    SCRAP_CHECK(emptyPlan.getChunks()[0].workerIndex == 0);
+
+    const CommandRecordingPlan singlePlan(1, 8, kMinObjectsPerChunk);
+    SCRAP_REQUIRE(singlePlan.getChunks().size() == 1);
+    SCRAP_CHECK(singlePlan.getChunks()[0].begin == 0);
+    SCRAP_CHECK(singlePlan.getChunks()[0].count == 1);
+    SCRAP_CHECK(singlePlan.getWorkerChunkIndices(0) == std::vector<uint32_t>{0});
+    SCRAP_CHECK(singlePlan.getWorkerChunkIndices(1).empty());
+}
+
+SCRAP_TEST(CommandRecordingPlan, TreatsZeroWorkersAsOne)
+{
+    const CommandRecordingPlan plan(10000, 0, kMinObjectsPerChunk);
+
+    SCRAP_CHECK(plan.getWorkerCount() == 1);
+    SCRAP_CHECK(plan.getChunks().size() == 1);
+    SCRAP_CHECK(ChunksCoverItemsInOrder(plan));
+}
+} // namespace scrap
@@ -1,5 +1,7 @@
 #include "CpuMesh.h"
 
+#include "MemoryTracker.h"
+
 #include <gpufmt/traits.h>
 
 namespace scrap
@@ -8,12 +10,16 @@ CpuMesh::CpuMesh(PrimitiveTopology topology): mPrimitiveTopology(topology) {}
 
 void CpuMesh::initIndices(IndexBufferFormat format, uint32_t indexCount)
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     mIndexBuffer.format = format;
     mIndexBuffer.data.resize(IndexBufferFormatByteSize(format) * indexCount);
 }
 
 void CpuMesh::initIndices(IndexBufferFormat format, uint32_t indexCount, std::span<std::byte> data)
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     mIndexBuffer.format = format;
     mIndexBuffer.data.resize(IndexBufferFormatByteSize(format) * indexCount);
     mIndexBuffer.indexCount = indexCount;
@@ -31,6 +37,8 @@ void CpuMesh::createVertexElement(ShaderVertexSemantic semantic,
                                   gpufmt::Format format,
                                   uint32_t elementCount)
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     auto elementItr = std::find_if(mVertexElements.begin(), mVertexElements.end(),
                                    [semantic, semanticIndex](const VertexElement& element) {
                                        return element.semantic == semantic && element.semanticIndex == semanticIndex;
@@ -51,6 +59,8 @@ void CpuMesh::createVertexElement(ShaderVertexSemantic semantic,
                                   uint32_t elementCount,
                                   std::span<const std::byte> data)
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     auto elementItr = std::find_if(mVertexElements.begin(), mVertexElements.end(),
                                    [semantic, semanticIndex](const VertexElement& element) {
                                        return element.semantic == semantic && element.semanticIndex == semanticIndex;
@@ -0,0 +1,390 @@
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+uint64_t CombinePath(uint64_t parentPath, const char* name)
+{
+    // splitmix64 finalizer
+    uint64_t value = parentPath ^ ((uint64_t)(uintptr_t)name + 0x9e3779b97f4a7c15ull);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    value = value ^ (value >> 31);
+
+    // 0 is the parent path of the roots
+    return (value != 0) ? value : 1;
+}
+
+void AppendJsonString(fmt::memory_buffer& out, std::string_view string)
+{
+    out.push_back('"');
+    for(char c : string)
+    {
+        switch(c)
+        {
+        case '"': fmt::format_to(fmt::appender(out), "\\\""); break;
+        case '\\': fmt::format_to(fmt::appender(out), "\\\\"); break;
+        case '\n': fmt::format_to(fmt::appender(out), "\\n"); break;
+        case '\t': fmt::format_to(fmt::appender(out), "\\t"); break;
+        default:
+            if((unsigned char)c < 0x20) { fmt::format_to(fmt::appender(out), "\\u{:04x}", (unsigned)c); }
+            else { out.push_back(c); }
+            break;
+        }
+    }
+    out.push_back('"');
+}
+
+double ToMilliseconds(std::chrono::nanoseconds time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+} // namespace
+
+CpuZoneRingBuffer::CpuZoneRingBuffer(std::string threadName, uint32_t threadIndex)
+    : mRecords(std::make_unique<CpuZoneRecord[]>(kCapacity))
+    , mThreadName(std::move(threadName))
+    , mThreadIndex(threadIndex)
+{}
+
+void CpuZoneRingBuffer::push(const CpuZoneRecord& record)
+{
+    const uint64_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    if(writeIndex - mReadIndex.load(std::memory_order_acquire) >= kCapacity)
+    {
+        mDroppedRecordCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    mRecords[writeIndex & (kCapacity - 1)] = record;
+    mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+CpuProfiler* CpuProfiler::sInstance = nullptr;
+std::atomic<bool> CpuProfiler::sEnabled{false};
+const std::chrono::steady_clock::time_point CpuProfiler::sEpoch = std::chrono::steady_clock::now();
+std::atomic<uint64_t> CpuProfiler::sNextInstanceId{1};
+thread_local std::shared_ptr<CpuZoneRingBuffer> CpuProfiler::tRingBuffer;
+thread_local uint64_t CpuProfiler::tRingBufferInstanceId = 0;
+thread_local uint64_t CpuProfiler::tCurrentPath = 0;
+thread_local uint32_t CpuProfiler::tDepth = 0;
+thread_local std::string CpuProfiler::tThreadName;
+
+CpuProfiler::CpuProfiler(const CpuProfilerParams& params)
+    : mParams(params)
+    , mInstanceId(sNextInstanceId.fetch_add(1, std::memory_order_relaxed))
+{
+    assert(sInstance == nullptr);
+
+    if(mParams.captureFilePath.empty() || mParams.captureFrameCount == 0) { mCaptureFinished = true; }
+
+    sInstance = this;
+    sEnabled.store(true, std::memory_order_release);
+}
+
+CpuProfiler::~CpuProfiler()
+{
+    assert(sInstance == this);
+
+    sEnabled.store(false, std::memory_order_release);
+    sInstance = nullptr;
+
+    if(!mCaptureFinished && !mCapturedZones.empty()) { finishCapture(); }
+}
+
+void CpuProfiler::setCurrentThreadName(std::string_view name)
+{
+    tThreadName = name;
+}
+
+void CpuProfiler::beginZone(const char* name, uint64_t& parentPath, int64_t& startTime)
+{
+    parentPath = tCurrentPath;
+    tCurrentPath = CombinePath(parentPath, name);
+    ++tDepth;
+
+    startTime = now();
+}
+
+void CpuProfiler::endZone(const char* name, uint64_t parentPath, int64_t startTime)
+{
+    const int64_t endTime = now();
+
+    const uint64_t path = tCurrentPath;
+    tCurrentPath = parentPath;
+    --tDepth;
+
+    CpuZoneRingBuffer* ringBuffer = getThreadRingBuffer();
+    if(ringBuffer == nullptr) { return; }
+
+    ringBuffer->push(CpuZoneRecord{.name = name,
+                                   .path = path,
+                                   .parentPath = parentPath,
+                                   .startTime = startTime,
+                                   .endTime = endTime,
+                                   .depth = tDepth});
+}
+
+void CpuProfiler::endFrame(uint64_t frameNumber)
+{
+    const bool capturing = !mCaptureFinished && frameNumber >= mParams.captureFirstFrame;
+
+    mFrameZoneIndices.clear();
+    mFrameZoneAccumulator.clear();
+
+    uint64_t droppedRecordCount = 0;
+    {
+        std::lock_guard lockGuard(mRingBuffersMutex);
+
+        for(const std::shared_ptr<CpuZoneRingBuffer>& ringBuffer : mRingBuffers)
+        {
+            ringBuffer->drain([&](const CpuZoneRecord& record) {
+                const std::chrono::nanoseconds time(record.endTime - record.startTime);
+
+                auto [itr, inserted] = mFrameZoneIndices.try_emplace(record.path, mFrameZoneAccumulator.size());
+                if(inserted)
+                {
+                    mFrameZoneAccumulator.push_back(CpuZoneStats{.name = record.name,
+                                                                 .path = record.path,
+                                                                 .parentPath = record.parentPath,
+                                                                 .depth = record.depth,
+                                                                 .firstStartTime = record.startTime});
+                }
+
+                CpuZoneStats& stats = mFrameZoneAccumulator[itr->second];
+                ++stats.callCount;
+                stats.totalTime += time;
+                stats.maxTime = std::max(stats.maxTime, time);
+                stats.firstStartTime = std::min(stats.firstStartTime, record.startTime);
+
+                if(capturing)
+                {
+                    mCapturedZones.push_back(
+                        CapturedZone{.record = record, .threadIndex = ringBuffer->getThreadIndex()});
+                }
+            });
+
+            droppedRecordCount += ringBuffer->getDroppedRecordCount();
+        }
+    }
+
+    if(droppedRecordCount > mReportedDroppedRecordCount)
+    {
+        spdlog::warn("The cpu profiler dropped {} zones because a ring buffer was full",
+                     droppedRecordCount - mReportedDroppedRecordCount);
+        mReportedDroppedRecordCount = droppedRecordCount;
+    }
+
+    buildFrameTree();
+
+    if(mParams.reportInterval > 0 && frameNumber % mParams.reportInterval == 0) { logFrameReport(frameNumber); }
+
+    if(capturing)
+    {
+        mCapturedFrameEnds.emplace_back(frameNumber, now());
+
+        if(frameNumber + 1 >= mParams.captureFirstFrame + mParams.captureFrameCount) { finishCapture(); }
+    }
+}
+
+void CpuProfiler::logFrameReport(uint64_t frameNumber) const
+{
+    spdlog::info("Cpu profile of frame {}", frameNumber);
+
+    for(const CpuZoneStats& zone : mFrameZones)
+    {
+        spdlog::info("    {:{}}{}: {:.3f} ms, {} calls, {:.3f} ms max", "", zone.depth * 2, zone.name,
+                     ToMilliseconds(zone.totalTime), zone.callCount, ToMilliseconds(zone.maxTime));
+    }
+
+    std::lock_guard lockGuard(mGpuPassesMutex);
+    if(!mGpuFrameNumber) { return; }
+
+    spdlog::info("    Gpu passes of frame {}: {:.3f} ms", *mGpuFrameNumber, mGpuFrameMilliseconds);
+    for(const GpuPassTiming& pass : mGpuPasses)
+    {
+        spdlog::info("      {:{}}{}: {:.3f} ms, {} scopes", "", pass.depth * 2, pass.label, pass.milliseconds,
+                     pass.scopeCount);
+    }
+}
+
+void CpuProfiler::publishGpuPasses(uint64_t gpuFrameNumber,
+                                   double gpuFrameMilliseconds,
+                                   std::span<const GpuPassTiming> passes)
+{
+    std::lock_guard lockGuard(mGpuPassesMutex);
+
+    mGpuFrameNumber = gpuFrameNumber;
+    mGpuFrameMilliseconds = gpuFrameMilliseconds;
+
+    // Assigning element by element reuses the label strings' memory from frame to frame
+    mGpuPasses.resize(passes.size());
+    for(size_t i = 0; i < passes.size(); ++i)
+    {
+        mGpuPasses[i].label.assign(passes[i].label);
+        mGpuPasses[i].depth = passes[i].depth;
+        mGpuPasses[i].scopeCount = passes[i].scopeCount;
+        mGpuPasses[i].milliseconds = passes[i].milliseconds;
+    }
+}
+
+bool CpuProfiler::writeChromeTrace(const std::filesystem::path& filePath) const
+{
+    fmt::memory_buffer json;
+    fmt::format_to(fmt::appender(json), "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::vector<std::string> threadNames;
+    {
+        std::lock_guard lockGuard(mRingBuffersMutex);
+        threadNames = mThreadNames;
+    }
+
+    bool first = true;
+    auto beginEvent = [&]() {
+        if(!first) { fmt::format_to(fmt::appender(json), ",\n"); }
+        first = false;
+    };
+
+    for(uint32_t threadIndex = 0; threadIndex < (uint32_t)threadNames.size(); ++threadIndex)
+    {
+        beginEvent();
+        fmt::format_to(fmt::appender(json),
+                       "{{\"ph\":\"M\",\"pid\":1,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":",
+                       threadIndex);
+        AppendJsonString(json, threadNames[threadIndex]);
+        fmt::format_to(fmt::appender(json), "}}}}");
+    }
+
+    // Chrome trace timestamps are in microseconds
+    for(const CapturedZone& zone : mCapturedZones)
+    {
+        beginEvent();
+        fmt::format_to(fmt::appender(json),
+                       "{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"name\":", zone.threadIndex,
+                       zone.record.startTime / 1000.0, (zone.record.endTime - zone.record.startTime) / 1000.0);
+        AppendJsonString(json, zone.record.name);
+        fmt::format_to(fmt::appender(json), "}}");
+    }
+
+    for(const auto& [frameNumber, time] : mCapturedFrameEnds)
+    {
+        beginEvent();
+        fmt::format_to(fmt::appender(json),
+                       "{{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":{:.3f},\"name\":\"End of frame {}\"}}",
+                       time / 1000.0, frameNumber);
+    }
+
+    fmt::format_to(fmt::appender(json), "\n]}}\n");
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if(!file)
+    {
+        spdlog::error("Failed to open '{}' to write the cpu capture", filePath.string());
+        return false;
+    }
+
+    file.write(json.data(), (std::streamsize)json.size());
+    return file.good();
+}
+
+CpuZoneRingBuffer* CpuProfiler::getThreadRingBuffer()
+{
+    CpuProfiler* profiler = sInstance;
+    if(profiler == nullptr) { return nullptr; }
+
+    if(tRingBufferInstanceId == profiler->mInstanceId) { return tRingBuffer.get(); }
+
+    return profiler->registerThread();
+}
+
+CpuZoneRingBuffer* CpuProfiler::registerThread()
+{
+    // The first zone of this thread, or the first since a new CpuProfiler was created
+    std::lock_guard lockGuard(mRingBuffersMutex);
+
+    const uint32_t threadIndex = (uint32_t)mRingBuffers.size();
+    std::string threadName = tThreadName.empty() ? fmt::format("Thread {}", threadIndex) : tThreadName;
+
+    mThreadNames.push_back(threadName);
+    tRingBuffer = std::make_shared<CpuZoneRingBuffer>(std::move(threadName), threadIndex);
+    tRingBufferInstanceId = mInstanceId;
+    mRingBuffers.push_back(tRingBuffer);
+
+    return tRingBuffer.get();
+}
+
+void CpuProfiler::buildFrameTree()
+{
+    // Siblings end up next to each other, in the order they first ran
+    std::sort(mFrameZoneAccumulator.begin(), mFrameZoneAccumulator.end(),
+              [](const CpuZoneStats& left, const CpuZoneStats& right) {
+                  if(left.parentPath != right.parentPath) { return left.parentPath < right.parentPath; }
+                  return left.firstStartTime < right.firstStartTime;
+              });
+
+    auto findChildren = [this](uint64_t parentPath) {
+        return std::equal_range(mFrameZoneAccumulator.begin(), mFrameZoneAccumulator.end(), parentPath,
+                                [](const auto& left, const auto& right) {
+                                    if constexpr(std::is_same_v<std::decay_t<decltype(left)>, uint64_t>)
+                                    {
+                                        return left < right.parentPath;
+                                    }
+                                    else { return left.parentPath < right; }
+                                });
+    };
+
+    // A zone whose parent didn't end in this frame is shown as a root
+    std::vector<const CpuZoneStats*> roots;
+    for(const CpuZoneStats& zone : mFrameZoneAccumulator)
+    {
+        if(zone.parentPath == 0 || !mFrameZoneIndices.contains(zone.parentPath)) { roots.push_back(&zone); }
+    }
+
+    std::sort(roots.begin(), roots.end(), [](const CpuZoneStats* left, const CpuZoneStats* right) {
+        return left->firstStartTime < right->firstStartTime;
+    });
+
+    mFrameZones.clear();
+
+    std::vector<std::pair<const CpuZoneStats*, uint32_t>> stack;
+    for(auto itr = roots.rbegin(); itr != roots.rend(); ++itr) { stack.emplace_back(*itr, 0); }
+
+    while(!stack.empty())
+    {
+        const auto [zone, depth] = stack.back();
+        stack.pop_back();
+
+        mFrameZones.push_back(*zone);
+        mFrameZones.back().depth = depth;
+
+        const auto [childrenBegin, childrenEnd] = findChildren(zone->path);
+        for(auto itr = std::make_reverse_iterator(childrenEnd); itr != std::make_reverse_iterator(childrenBegin); ++itr)
+        {
+            stack.emplace_back(&*itr, depth + 1);
+        }
+    }
+}
+
+void CpuProfiler::finishCapture()
+{
+    mCaptureFinished = true;
+
+    if(writeChromeTrace(mParams.captureFilePath))
+    {
+        spdlog::info("Wrote a cpu capture of {} frames to '{}'", mCapturedFrameEnds.size(),
+                     mParams.captureFilePath.string());
+    }
+
+    mCapturedZones.clear();
+    mCapturedZones.shrink_to_fit();
+    mCapturedFrameEnds.clear();
+}
+} // namespace scrap
@@ -0,0 +1,263 @@
+// Classes:
+//   CpuProfileZone
+//   CpuProfiler
+//
+// The cpu side counterpart to d3d12::ScopedGpuEvent. SCRAP_CPU_ZONE("Name") times the rest of the scope it's declared
+// in. Zones nest, so a zone inside another is its child. Zone names have to be string literals, only the pointer is
+// kept.
+//
+// SCRAP_CPU_PROFILER_ENABLED set to 0 compiles the zones out. When compiled in, a zone costs a single relaxed atomic
+// load unless a CpuProfiler exists.
+//
+// CpuProfileZone:
+//   What SCRAP_CPU_ZONE declares. When it goes out of scope, the zone is written to a ring buffer that belongs to the
+//   calling thread. Nothing is locked or allocated, except the first time a thread records a zone.
+//
+// CpuProfiler:
+//   Collects the zones of every thread once per frame in endFrame. The zones are added up by their place in the zone
+//   tree, so a zone that runs many times in a frame, or on several threads, shows up once with its total time and call
+//   count. logFrameReport prints the tree of the last frame.
+//
+//   A capture keeps every zone of a range of frames with its thread and timestamps, and writes them to a Chrome trace
+//   json file when the last frame has ended. The file opens in chrome://tracing and in Perfetto.
+//
+//   A zone that runs on a job worker starts a tree of its own, it isn't a child of the zone that scheduled the job.
+//   Zones are added to the frame in which endFrame collects them. With the render stage on its own thread, the render
+//   zones in a frame's report belong to the previous simulation frame. The capture keeps the real timestamps.
+
+#pragma once
+
+#include "GpuTimestampTracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifndef SCRAP_CPU_PROFILER_ENABLED
+#define SCRAP_CPU_PROFILER_ENABLED 1
+#endif
+
+#if SCRAP_CPU_PROFILER_ENABLED
+#define SCRAP_CPU_ZONE_CONCAT_IMPL(left, right) left##right
+#define SCRAP_CPU_ZONE_CONCAT(left, right) SCRAP_CPU_ZONE_CONCAT_IMPL(left, right)
+#define SCRAP_CPU_ZONE(name) ::scrap::CpuProfileZone SCRAP_CPU_ZONE_CONCAT(cpuProfileZone, __LINE__)(name)
+#define SCRAP_CPU_THREAD_NAME(name) ::scrap::CpuProfiler::setCurrentThreadName(name)
+#else
+#define SCRAP_CPU_ZONE(name) (void)0
+#define SCRAP_CPU_THREAD_NAME(name) (void)0
+#endif
+
+namespace scrap
+{
+struct CpuProfilerParams
+{
+    // Logs the zone tree of every reportInterval'th frame. 0 disables the report.
+    uint32_t reportInterval = 0;
+
+    // Captures captureFrameCount frames starting at captureFirstFrame. An empty path disables the capture.
+    std::filesystem::path captureFilePath;
+    uint64_t captureFirstFrame = 0;
+    uint32_t captureFrameCount = 0;
+};
+
+struct CpuZoneRecord
+{
+    const char* name;
+    // Identifies the zone's place in the tree. Combines the name with the path of the parent.
+    uint64_t path;
+    uint64_t parentPath;
+    // Nanoseconds since the profiler's clock started
+    int64_t startTime;
+    int64_t endTime;
+    uint32_t depth;
+};
+
+// One node of the zone tree of a frame
+struct CpuZoneStats
+{
+    const char* name = nullptr;
+    uint64_t path = 0;
+    uint64_t parentPath = 0;
+    // In the tree of the frame
+    uint32_t depth = 0;
+    uint32_t callCount = 0;
+    std::chrono::nanoseconds totalTime{0};
+    std::chrono::nanoseconds maxTime{0};
+    // Orders siblings by when they first ran
+    int64_t firstStartTime = 0;
+};
+
+class CpuZoneRingBuffer
+{
+public:
+    static constexpr size_t kCapacity = 16 * 1024;
+
+    CpuZoneRingBuffer(std::string threadName, uint32_t threadIndex);
+    CpuZoneRingBuffer(const CpuZoneRingBuffer&) = delete;
+    CpuZoneRingBuffer(CpuZoneRingBuffer&&) = delete;
+    ~CpuZoneRingBuffer() = default;
+
+    CpuZoneRingBuffer& operator=(const CpuZoneRingBuffer&) = delete;
+    CpuZoneRingBuffer& operator=(CpuZoneRingBuffer&&) = delete;
+
+    // Producer. Drops the zone when the buffer is full.
+    void push(const CpuZoneRecord& record);
+
+    // Consumer. Calls function for every zone recorded since the last drain.
+    template<class Function>
+    void drain(Function&& function);
+
+    [[nodiscard]] const std::string& getThreadName() const { return mThreadName; }
+    [[nodiscard]] uint32_t getThreadIndex() const { return mThreadIndex; }
+    [[nodiscard]] uint64_t getDroppedRecordCount() const { return mDroppedRecordCount.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<CpuZoneRecord[]> mRecords;
+    std::string mThreadName;
+    uint32_t mThreadIndex;
+
+    alignas(64) std::atomic<uint64_t> mWriteIndex{0};
+    alignas(64) std::atomic<uint64_t> mReadIndex{0};
+    std::atomic<uint64_t> mDroppedRecordCount{0};
+};
+
+class CpuProfiler
+{
+public:
+    explicit CpuProfiler(const CpuProfilerParams& params);
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler(CpuProfiler&&) = delete;
+    // Writes a capture that hasn't finished yet
+    ~CpuProfiler();
+
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(CpuProfiler&&) = delete;
+
+    // Can be nullptr
+    [[nodiscard]] static CpuProfiler* instance() { return sInstance; }
+    [[nodiscard]] static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+    // Shows up as the thread's name in captures. Has to be called before the thread's first zone.
+    static void setCurrentThreadName(std::string_view name);
+
+    [[nodiscard]] static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sEpoch).count();
+    }
+
+    static void beginZone(const char* name, uint64_t& parentPath, int64_t& startTime);
+    static void endZone(const char* name, uint64_t parentPath, int64_t startTime);
+
+    // Called once per frame by the thread that runs the frame loop
+    void endFrame(uint64_t frameNumber);
+
+    // The zone tree of the last frame, depth first
+    [[nodiscard]] std::span<const CpuZoneStats> getFrameZones() const { return mFrameZones; }
+    void logFrameReport(uint64_t frameNumber) const;
+
+    // The gpu times of a frame, which arrive a few frames after its cpu zones. The latest ones are added to the frame
+    // report. Can be called from any thread.
+    void publishGpuPasses(uint64_t gpuFrameNumber, double gpuFrameMilliseconds, std::span<const GpuPassTiming> passes);
+
+    [[nodiscard]] bool writeChromeTrace(const std::filesystem::path& filePath) const;
+
+private:
+    struct CapturedZone
+    {
+        CpuZoneRecord record;
+        uint32_t threadIndex;
+    };
+
+    [[nodiscard]] static CpuZoneRingBuffer* getThreadRingBuffer();
+    [[nodiscard]] CpuZoneRingBuffer* registerThread();
+
+    void buildFrameTree();
+    void finishCapture();
+
+    static CpuProfiler* sInstance;
+    static std::atomic<bool> sEnabled;
+    static const std::chrono::steady_clock::time_point sEpoch;
+    // Tells apart CpuProfilers that were created one after another at the same address
+    static std::atomic<uint64_t> sNextInstanceId;
+
+    thread_local static std::shared_ptr<CpuZoneRingBuffer> tRingBuffer;
+    thread_local static uint64_t tRingBufferInstanceId;
+    thread_local static uint64_t tCurrentPath;
+    thread_local static uint32_t tDepth;
+    thread_local static std::string tThreadName;
+
+    CpuProfilerParams mParams;
+    const uint64_t mInstanceId;
+
+    mutable std::mutex mRingBuffersMutex;
+    std::vector<std::shared_ptr<CpuZoneRingBuffer>> mRingBuffers;
+
+    std::unordered_map<uint64_t, size_t> mFrameZoneIndices;
+    std::vector<CpuZoneStats> mFrameZoneAccumulator;
+    std::vector<CpuZoneStats> mFrameZones;
+
+    // Indexed by the thread index of the ring buffers
+    std::vector<std::string> mThreadNames;
+    uint64_t mReportedDroppedRecordCount = 0;
+
+    mutable std::mutex mGpuPassesMutex;
+    std::vector<GpuPassTiming> mGpuPasses;
+    std::optional<uint64_t> mGpuFrameNumber;
+    double mGpuFrameMilliseconds = 0.0;
+
+    std::vector<CapturedZone> mCapturedZones;
+    std::vector<std::pair<uint64_t, int64_t>> mCapturedFrameEnds;
+    bool mCaptureFinished = false;
+};
+
+class CpuProfileZone
+{
+public:
+    explicit CpuProfileZone(const char* name)
+    {
+        if(!CpuProfiler::isEnabled()) { return; }
+
+        mName = name;
+        CpuProfiler::beginZone(name, mParentPath, mStartTime);
+    }
+
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone(CpuProfileZone&&) = delete;
+
+    ~CpuProfileZone()
+    {
+        if(mName != nullptr) { CpuProfiler::endZone(mName, mParentPath, mStartTime); }
+    }
+
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(CpuProfileZone&&) = delete;
+
+private:
+    const char* mName = nullptr;
+    uint64_t mParentPath = 0;
+    int64_t mStartTime = 0;
+};
+
+template<class Function>
+void CpuZoneRingBuffer::drain(Function&& function)
+{
+    uint64_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+    const uint64_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+
+    for(; readIndex != writeIndex; ++readIndex)
+    {
+        function(mRecords[readIndex & (kCapacity - 1)]);
+    }
+
+    mReadIndex.store(readIndex, std::memory_order_release);
+}
+} // namespace scrap
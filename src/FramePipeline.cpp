@@ -0,0 +1,142 @@
+#include "FramePipeline.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+struct DurationDistribution
+{
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// Sorts the samples in place
+DurationDistribution CalculateDistribution(std::vector<std::chrono::nanoseconds>& samples)
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    DurationDistribution distribution;
+    if(samples.empty()) { return distribution; }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::chrono::nanoseconds total{0};
+    for(std::chrono::nanoseconds sample : samples)
+    {
+        total += sample;
+    }
+
+    distribution.meanMs = Milliseconds(total).count() / (double)samples.size();
+    distribution.p50Ms = Milliseconds(samples[(samples.size() - 1) / 2]).count();
+    distribution.p99Ms = Milliseconds(samples[((samples.size() - 1) * 99) / 100]).count();
+    distribution.maxMs = Milliseconds(samples.back()).count();
+
+    return distribution;
+}
+} // namespace
+
+FramePipeline::FramePipeline(uint32_t snapshotCount)
+    : mSnapshots(std::clamp(snapshotCount, kMinSnapshotCount, kMaxSnapshotCount))
+{}
+
+RenderParams* FramePipeline::beginSimulation()
+{
+    std::unique_lock lock(mMutex);
+
+    // The snapshot at the write index is free as long as not every snapshot is waiting for or in the render stage
+    mSnapshotReleased.wait(lock, [this]() { return mStopped || mInUseCount < mSnapshots.size(); });
+    if(mStopped) { return nullptr; }
+
+    return &mSnapshots[mWriteIndex];
+}
+
+void FramePipeline::endSimulation()
+{
+    {
+        std::lock_guard lockGuard(mMutex);
+        mWriteIndex = (mWriteIndex + 1) % (uint32_t)mSnapshots.size();
+        ++mPublishedCount;
+        ++mInUseCount;
+    }
+
+    mSnapshotPublished.notify_one();
+}
+
+const RenderParams* FramePipeline::beginRender()
+{
+    std::unique_lock lock(mMutex);
+
+    mSnapshotPublished.wait(lock, [this]() { return mStopped || mPublishedCount > 0; });
+    if(mPublishedCount == 0) { return nullptr; }
+
+    --mPublishedCount;
+    return &mSnapshots[mReadIndex];
+}
+
+void FramePipeline::endRender()
+{
+    {
+        std::lock_guard lockGuard(mMutex);
+        mReadIndex = (mReadIndex + 1) % (uint32_t)mSnapshots.size();
+        --mInUseCount;
+    }
+
+    mSnapshotReleased.notify_one();
+}
+
+void FramePipeline::stop()
+{
+    {
+        std::lock_guard lockGuard(mMutex);
+        mStopped = true;
+    }
+
+    mSnapshotReleased.notify_all();
+    mSnapshotPublished.notify_all();
+}
+
+FrameTimingRecorder::FrameTimingRecorder(uint32_t reportInterval)
+    : mReportInterval(reportInterval)
+{
+    mFrameTimes.reserve(reportInterval);
+    mInputToSubmitLatencies.reserve(reportInterval);
+}
+
+void FrameTimingRecorder::addFrame(std::chrono::steady_clock::time_point inputTime,
+                                   std::chrono::steady_clock::time_point submitTime)
+{
+    if(!isEnabled()) { return; }
+
+    // The first frame has nothing to measure its frame time against
+    if(mLastSubmitTime != std::chrono::steady_clock::time_point{})
+    {
+        mFrameTimes.push_back(submitTime - mLastSubmitTime);
+        mInputToSubmitLatencies.push_back(submitTime - inputTime);
+    }
+
+    mLastSubmitTime = submitTime;
+}
+
+void FrameTimingRecorder::report(std::string_view modeName)
+{
+    if(!isEnabled() || mFrameTimes.size() < mReportInterval) { return; }
+
+    const DurationDistribution frameTime = CalculateDistribution(mFrameTimes);
+    const DurationDistribution latency = CalculateDistribution(mInputToSubmitLatencies);
+
+    spdlog::info("{} frame timing over {} frames", modeName, mFrameTimes.size());
+    spdlog::info("    Frame time:            mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+                 frameTime.meanMs, frameTime.p50Ms, frameTime.p99Ms, frameTime.maxMs);
+    spdlog::info("    Input to submit:       mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+                 latency.meanMs, latency.p50Ms, latency.p99Ms, latency.maxMs);
+
+    mFrameTimes.clear();
+    mInputToSubmitLatencies.clear();
+}
+} // namespace scrap
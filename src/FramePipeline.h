@@ -0,0 +1,106 @@
+// Classes:
+//   FramePipeline
+//   FrameTimingRecorder
+//
+// FramePipeline:
+//   Connects the simulation stage to the render stage with a ring of RenderParams snapshots. The simulation fills the
+//   next free snapshot and publishes it, then goes on with the next frame while the render stage records the published
+//   one on its own thread. Snapshots are rendered in the order they were published and none are dropped. With two
+//   snapshots the simulation can be one frame ahead of rendering, with three it can be two frames ahead. When every
+//   snapshot is in use, beginSimulation blocks until the render stage releases one, which is what keeps the stages
+//   from drifting apart.
+//
+//   A snapshot is only ever touched by one stage at a time, so nothing inside it needs to be synchronized. Its vectors
+//   keep their capacity, so publishing a frame doesn't allocate once every snapshot has been used once.
+//
+// FrameTimingRecorder:
+//   Collects the frame time and the input to submit latency of every frame and logs their distribution every
+//   reportInterval frames. The input to submit latency runs from when the input for a frame was sampled to when the
+//   frame's command lists were submitted, which is the part of the latency that pipelining trades frame time for.
+
+#pragma once
+
+#include "RenderScene.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+struct FramePipelineParams
+{
+    // 0 runs the simulation and render stages one after the other on the main thread. 2 or 3 runs the render stage on
+    // its own thread with that many snapshots.
+    uint32_t snapshotCount = 0;
+
+    // Logs frame timing every this many frames. 0 disables the measurement.
+    uint32_t timingReportInterval = 0;
+};
+
+class FramePipeline
+{
+public:
+    static constexpr uint32_t kMinSnapshotCount = 2;
+    static constexpr uint32_t kMaxSnapshotCount = 3;
+
+    explicit FramePipeline(uint32_t snapshotCount);
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline(FramePipeline&&) = delete;
+    ~FramePipeline() = default;
+
+    FramePipeline& operator=(const FramePipeline&) = delete;
+    FramePipeline& operator=(FramePipeline&&) = delete;
+
+    // Simulation stage. Blocks until a snapshot is free. Returns nullptr once the pipeline is stopped.
+    [[nodiscard]] RenderParams* beginSimulation();
+    void endSimulation();
+
+    // Render stage. Blocks until a snapshot is published. Returns nullptr once the pipeline is stopped and every
+    // published snapshot has been rendered.
+    [[nodiscard]] const RenderParams* beginRender();
+    void endRender();
+
+    // Wakes up both stages. Snapshots that were already published are still handed to the render stage.
+    void stop();
+
+    [[nodiscard]] uint32_t getSnapshotCount() const { return (uint32_t)mSnapshots.size(); }
+
+private:
+    std::vector<RenderParams> mSnapshots;
+
+    std::mutex mMutex;
+    std::condition_variable mSnapshotReleased;
+    std::condition_variable mSnapshotPublished;
+    uint32_t mWriteIndex = 0;
+    uint32_t mReadIndex = 0;
+    // Published snapshots the render stage hasn't started on
+    uint32_t mPublishedCount = 0;
+    // Published snapshots the render stage hasn't released, including the one it's rendering
+    uint32_t mInUseCount = 0;
+    bool mStopped = false;
+};
+
+class FrameTimingRecorder
+{
+public:
+    explicit FrameTimingRecorder(uint32_t reportInterval);
+
+    [[nodiscard]] bool isEnabled() const { return mReportInterval > 0; }
+
+    // Called by the render stage right after a frame's command lists were submitted
+    void addFrame(std::chrono::steady_clock::time_point inputTime, std::chrono::steady_clock::time_point submitTime);
+
+    // Logs the frames added since the last report when there are at least reportInterval of them
+    void report(std::string_view modeName);
+
+private:
+    uint32_t mReportInterval;
+    std::chrono::steady_clock::time_point mLastSubmitTime;
+    std::vector<std::chrono::nanoseconds> mFrameTimes;
+    std::vector<std::chrono::nanoseconds> mInputToSubmitLatencies;
+};
+} // namespace scrap
@@ -0,0 +1,31 @@
+#include "GpuEventLabels.h"
+
+#include <atomic>
+
+#include <fmt/format.h>
+
+namespace scrap
+{
+namespace
+{
+std::atomic<GpuEventVerbosity> sGpuEventVerbosity{GpuEventVerbosity::Passes};
+} // namespace
+
+void SetGpuEventVerbosity(GpuEventVerbosity verbosity)
+{
+    sGpuEventVerbosity.store(verbosity, std::memory_order_relaxed);
+}
+
+GpuEventVerbosity GetGpuEventVerbosity()
+{
+    return sGpuEventVerbosity.load(std::memory_order_relaxed);
+}
+
+std::string_view GpuEventLabelCache::getObjectLabel(uint32_t objectId, std::string_view name)
+{
+    auto [itr, inserted] = mObjectLabels.try_emplace(objectId);
+    if(inserted) { itr->second = fmt::format("{} {}", name, objectId); }
+
+    return itr->second;
+}
+} // namespace scrap
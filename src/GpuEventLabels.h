@@ -0,0 +1,89 @@
+// Classes:
+//   GpuEventLabelCache
+//
+// The verbosity of the gpu events and the labels of the events that are recorded per object. Pass events, like "Main
+// Pass", are always recorded and are what the GpuProfiler times. Per object events are only recorded with the
+// verbosity at GpuEventVerbosity::Objects, which is meant for looking at a frame in PIX. Even then a frame only times
+// the first GpuProfilerParams::maxScopesPerFrame of them.
+//
+// SCRAP_GPU_OBJECT_EVENTS_ENABLED set to 0 compiles the per object events out. It defaults to 1 in debug builds only,
+// because PIX events are only recorded in debug builds.
+//
+// GpuEventLabelCache:
+//   Formats the label of an object's event the first time it's asked for and returns the same label from then on, so
+//   a frame doesn't format a string per object. The labels are null terminated, as PIX expects, and keep their address
+//   until the cache is cleared or destroyed. Not thread safe.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#ifndef SCRAP_GPU_OBJECT_EVENTS_ENABLED
+#ifdef _DEBUG
+#define SCRAP_GPU_OBJECT_EVENTS_ENABLED 1
+#else
+#define SCRAP_GPU_OBJECT_EVENTS_ENABLED 0
+#endif
+#endif
+
+namespace scrap
+{
+enum class GpuEventVerbosity
+{
+    Passes,
+    Objects,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(GpuEventVerbosity verbosity)
+{
+    switch(verbosity)
+    {
+    case GpuEventVerbosity::Passes: return "Passes";
+    case GpuEventVerbosity::Objects: return "Objects";
+    default: return "Unknown GpuEventVerbosity";
+    }
+}
+
+// Can be changed at any time. Frames that are already being recorded may use either verbosity.
+void SetGpuEventVerbosity(GpuEventVerbosity verbosity);
+[[nodiscard]] GpuEventVerbosity GetGpuEventVerbosity();
+
+// Always false when the per object events are compiled out. Meant to be read once per pass, not per object.
+[[nodiscard]] inline bool AreGpuObjectEventsEnabled()
+{
+#if SCRAP_GPU_OBJECT_EVENTS_ENABLED
+    return GetGpuEventVerbosity() >= GpuEventVerbosity::Objects;
+#else
+    return false;
+#endif
+}
+
+class GpuEventLabelCache
+{
+public:
+    GpuEventLabelCache() = default;
+    GpuEventLabelCache(const GpuEventLabelCache&) = delete;
+    GpuEventLabelCache(GpuEventLabelCache&&) = default;
+    ~GpuEventLabelCache() = default;
+
+    GpuEventLabelCache& operator=(const GpuEventLabelCache&) = delete;
+    GpuEventLabelCache& operator=(GpuEventLabelCache&&) = default;
+
+    // "<name> <objectId>". The name is only read the first time the id is seen, an object is expected to keep its name.
+    [[nodiscard]] std::string_view getObjectLabel(uint32_t objectId, std::string_view name);
+
+    [[nodiscard]] size_t getLabelCount() const { return mObjectLabels.size(); }
+
+    void clear() { mObjectLabels.clear(); }
+
+private:
+    // The map's nodes never move, so neither do the strings' characters
+    std::unordered_map<uint32_t, std::string> mObjectLabels;
+};
+} // namespace scrap
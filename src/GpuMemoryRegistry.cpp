@@ -0,0 +1,277 @@
+#include "GpuMemoryRegistry.h"
+
+#include "EnumIterator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+double ToMebibytes(int64_t byteSize)
+{
+    return (double)byteSize / (1024.0 * 1024.0);
+}
+
+void AddBytes(GpuMemoryStats& stats, int64_t byteSize)
+{
+    stats.liveBytes += byteSize;
+    stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+    ++stats.liveAllocationCount;
+}
+
+void RemoveBytes(GpuMemoryStats& stats, int64_t byteSize)
+{
+    stats.liveBytes -= byteSize;
+    --stats.liveAllocationCount;
+}
+} // namespace
+
+GpuMemoryAllocation::GpuMemoryAllocation(GpuMemoryAllocation&& other) noexcept
+    : mRegistry(std::exchange(other.mRegistry, nullptr))
+    , mId(std::exchange(other.mId, 0))
+{}
+
+GpuMemoryAllocation::~GpuMemoryAllocation()
+{
+    reset();
+}
+
+GpuMemoryAllocation& GpuMemoryAllocation::operator=(GpuMemoryAllocation&& other) noexcept
+{
+    if(this != &other)
+    {
+        reset();
+        mRegistry = std::exchange(other.mRegistry, nullptr);
+        mId = std::exchange(other.mId, 0);
+    }
+
+    return *this;
+}
+
+void GpuMemoryAllocation::reset()
+{
+    if(mRegistry == nullptr) { return; }
+
+    mRegistry->remove(mId);
+    mRegistry = nullptr;
+    mId = 0;
+}
+
+GpuMemoryRegistry::GpuMemoryRegistry(const GpuMemoryParams& params)
+    : mParams(params)
+{
+    mHistory.reserve(mParams.historyFrameCount);
+}
+
+GpuMemoryAllocation GpuMemoryRegistry::add(GpuAllocationDesc desc)
+{
+    const int64_t byteSize = (int64_t)desc.byteSize;
+
+    std::lock_guard lock(mMutex);
+
+    AddBytes(mCategoryStats[desc.category], byteSize);
+    AddBytes(mHeapStats[desc.heapType], byteSize);
+    AddBytes(mTotalStats, byteSize);
+
+    const uint64_t id = mNextId++;
+    mAllocations.emplace(id, std::move(desc));
+
+    return GpuMemoryAllocation(this, id);
+}
+
+void GpuMemoryRegistry::remove(uint64_t id)
+{
+    std::lock_guard lock(mMutex);
+
+    auto itr = mAllocations.find(id);
+    if(itr == mAllocations.end()) { return; }
+
+    const GpuAllocationDesc& desc = itr->second;
+    const int64_t byteSize = (int64_t)desc.byteSize;
+
+    RemoveBytes(mCategoryStats[desc.category], byteSize);
+    RemoveBytes(mHeapStats[desc.heapType], byteSize);
+    RemoveBytes(mTotalStats, byteSize);
+
+    mAllocations.erase(itr);
+}
+
+GpuMemoryStats GpuMemoryRegistry::getCategoryStats(GpuMemoryCategory category) const
+{
+    std::lock_guard lock(mMutex);
+    return mCategoryStats[category];
+}
+
+GpuMemoryStats GpuMemoryRegistry::getHeapStats(GpuHeapType heapType) const
+{
+    std::lock_guard lock(mMutex);
+    return mHeapStats[heapType];
+}
+
+GpuMemoryStats GpuMemoryRegistry::getTotalStats() const
+{
+    std::lock_guard lock(mMutex);
+    return mTotalStats;
+}
+
+std::vector<GpuAllocationDesc> GpuMemoryRegistry::getLargestAllocations(size_t count) const
+{
+    std::vector<const GpuAllocationDesc*> allocations;
+
+    std::lock_guard lock(mMutex);
+
+    allocations.reserve(mAllocations.size());
+    for(const auto& [id, desc] : mAllocations)
+    {
+        allocations.push_back(&desc);
+    }
+
+    count = std::min(count, allocations.size());
+    std::partial_sort(allocations.begin(), allocations.begin() + count, allocations.end(),
+                      [](const GpuAllocationDesc* left, const GpuAllocationDesc* right) {
+                          return left->byteSize > right->byteSize;
+                      });
+
+    std::vector<GpuAllocationDesc> largestAllocations;
+    largestAllocations.reserve(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        largestAllocations.push_back(*allocations[i]);
+    }
+
+    return largestAllocations;
+}
+
+GpuMemoryBudget GpuMemoryRegistry::getBudget(uint64_t deviceBudgetBytes) const
+{
+    std::lock_guard lock(mMutex);
+    return getBudgetLocked(deviceBudgetBytes);
+}
+
+GpuMemoryBudget GpuMemoryRegistry::getBudgetLocked(uint64_t deviceBudgetBytes) const
+{
+    GpuMemoryBudget budget;
+    budget.usedBytes = (uint64_t)std::max<int64_t>(mTotalStats.liveBytes, 0);
+    budget.budgetBytes = (mParams.budgetBytes > 0) ? mParams.budgetBytes : deviceBudgetBytes;
+
+    return budget;
+}
+
+void GpuMemoryRegistry::endFrame(uint64_t deviceBudgetBytes)
+{
+    bool reportDue = false;
+
+    {
+        std::lock_guard lock(mMutex);
+
+        ++mFrameNumber;
+
+        if(mParams.historyFrameCount > 0)
+        {
+            GpuMemoryFrameSnapshot snapshot;
+            snapshot.frameNumber = mFrameNumber;
+            for(GpuMemoryCategory category : enumerate<GpuMemoryCategory>())
+            {
+                snapshot.categoryBytes[category] = mCategoryStats[category].liveBytes;
+            }
+            snapshot.totalBytes = mTotalStats.liveBytes;
+
+            if(mHistory.size() < mParams.historyFrameCount) { mHistory.push_back(snapshot); }
+            else
+            {
+                mHistory[mHistoryStart] = snapshot;
+                mHistoryStart = (mHistoryStart + 1) % mHistory.size();
+            }
+        }
+
+        // Only the crossings are logged, not every frame spent over the budget
+        const GpuMemoryBudget budget = getBudgetLocked(deviceBudgetBytes);
+        if(budget.isOverBudget() != mOverBudget)
+        {
+            mOverBudget = budget.isOverBudget();
+            if(mOverBudget)
+            {
+                spdlog::warn("Gpu memory is over budget on frame {}: {:.1f} MiB committed of a {:.1f} MiB budget",
+                             mFrameNumber, ToMebibytes((int64_t)budget.usedBytes),
+                             ToMebibytes((int64_t)budget.budgetBytes));
+            }
+            else
+            {
+                spdlog::info("Gpu memory is back under budget on frame {}: {:.1f} MiB committed of a {:.1f} MiB budget",
+                             mFrameNumber, ToMebibytes((int64_t)budget.usedBytes),
+                             ToMebibytes((int64_t)budget.budgetBytes));
+            }
+        }
+
+        reportDue = mParams.reportInterval > 0 && mFrameNumber % mParams.reportInterval == 0;
+    }
+
+    if(reportDue) { logReport(deviceBudgetBytes); }
+}
+
+std::vector<GpuMemoryFrameSnapshot> GpuMemoryRegistry::getHistory() const
+{
+    std::lock_guard lock(mMutex);
+
+    std::vector<GpuMemoryFrameSnapshot> history;
+    history.reserve(mHistory.size());
+    history.insert(history.end(), mHistory.begin() + mHistoryStart, mHistory.end());
+    history.insert(history.end(), mHistory.begin(), mHistory.begin() + mHistoryStart);
+
+    return history;
+}
+
+void GpuMemoryRegistry::logReport(uint64_t deviceBudgetBytes) const
+{
+    const std::vector<GpuAllocationDesc> largestAllocations = getLargestAllocations(mParams.reportAllocationCount);
+
+    fmt::memory_buffer message;
+
+    {
+        std::lock_guard lock(mMutex);
+
+        const GpuMemoryBudget budget = getBudgetLocked(deviceBudgetBytes);
+        fmt::format_to(fmt::appender(message), "Gpu memory of frame {}: {:.1f} MiB in {} allocations", mFrameNumber,
+                       ToMebibytes(mTotalStats.liveBytes), mTotalStats.liveAllocationCount);
+        if(budget.budgetBytes > 0)
+        {
+            fmt::format_to(fmt::appender(message), " of a {:.1f} MiB budget",
+                           ToMebibytes((int64_t)budget.budgetBytes));
+        }
+
+        for(GpuMemoryCategory category : enumerate<GpuMemoryCategory>())
+        {
+            const GpuMemoryStats& stats = mCategoryStats[category];
+            fmt::format_to(fmt::appender(message), "\n    {}: {:.1f} MiB live, {:.1f} MiB peak, {} allocations",
+                           ToStringView(category), ToMebibytes(stats.liveBytes), ToMebibytes(stats.peakBytes),
+                           stats.liveAllocationCount);
+        }
+
+        for(GpuHeapType heapType : enumerate<GpuHeapType>())
+        {
+            const GpuMemoryStats& stats = mHeapStats[heapType];
+            fmt::format_to(fmt::appender(message), "\n    {} heap: {:.1f} MiB live, {:.1f} MiB peak",
+                           ToStringView(heapType), ToMebibytes(stats.liveBytes), ToMebibytes(stats.peakBytes));
+        }
+    }
+
+    if(!largestAllocations.empty())
+    {
+        fmt::format_to(fmt::appender(message), "\n    Largest allocations:");
+        for(const GpuAllocationDesc& desc : largestAllocations)
+        {
+            const std::string_view name = desc.name.empty() ? std::string_view("<unnamed>") : desc.name;
+            fmt::format_to(fmt::appender(message), "\n        {:.2f} MiB {} ({}, {} heap)",
+                           ToMebibytes((int64_t)desc.byteSize), name, ToStringView(desc.category),
+                           ToStringView(desc.heapType));
+        }
+    }
+
+    spdlog::info("{}", std::string_view(message.data(), message.size()));
+}
+} // namespace scrap
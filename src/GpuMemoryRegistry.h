@@ -0,0 +1,216 @@
+// Classes:
+//   GpuMemoryRegistry
+//   GpuMemoryAllocation
+//
+// Accounts for the gpu memory the engine commits. Every committed resource is registered with the size the device
+// reports for it, the heap it lives in, a category and its debug name. Nothing in here talks to a device, the d3d12
+// code registers its resources and passes in the budget the adapter reports.
+//
+// GpuMemoryRegistry:
+//   Keeps every live allocation, the live and peak bytes of every category and heap type, and the per category bytes
+//   of the last historyFrameCount frames. The budget is GpuMemoryParams::budgetBytes, or what the device reports when
+//   that's 0. Crossing the budget logs a warning once, and every reportInterval frames the per category totals and the
+//   largest allocations are logged. Allocations can be added and removed from any thread.
+//
+// GpuMemoryAllocation:
+//   What GpuMemoryRegistry::add returns. Removes the allocation from the registry when it's destroyed, so it's kept
+//   next to the resource it accounts for. A resource whose release is deferred until the gpu is done with it stops
+//   being counted when its owner is destroyed. The registry has to outlive its allocations.
+
+#pragma once
+
+#include "EnumArray.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scrap
+{
+enum class GpuHeapType : uint8_t
+{
+    Default,
+    Upload,
+    Readback,
+    Custom,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(GpuHeapType heapType)
+{
+    switch(heapType)
+    {
+    case GpuHeapType::Default: return "Default";
+    case GpuHeapType::Upload: return "Upload";
+    case GpuHeapType::Readback: return "Readback";
+    case GpuHeapType::Custom: return "Custom";
+    default: return "Unknown GpuHeapType";
+    }
+}
+
+enum class GpuMemoryCategory : uint8_t
+{
+    Buffer,
+    Texture,
+    // Render target and depth stencil textures
+    RenderTarget,
+    // Acceleration structures with their scratch and instance buffers
+    AccelerationStructure,
+    ShaderTable,
+    // The upload copies buffers and textures keep next to their resource
+    Staging,
+    UploadPool,
+    Readback,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(GpuMemoryCategory category)
+{
+    switch(category)
+    {
+    case GpuMemoryCategory::Buffer: return "Buffer";
+    case GpuMemoryCategory::Texture: return "Texture";
+    case GpuMemoryCategory::RenderTarget: return "RenderTarget";
+    case GpuMemoryCategory::AccelerationStructure: return "AccelerationStructure";
+    case GpuMemoryCategory::ShaderTable: return "ShaderTable";
+    case GpuMemoryCategory::Staging: return "Staging";
+    case GpuMemoryCategory::UploadPool: return "UploadPool";
+    case GpuMemoryCategory::Readback: return "Readback";
+    default: return "Unknown GpuMemoryCategory";
+    }
+}
+
+struct GpuMemoryParams
+{
+    // Logs the per category memory and the largest allocations every reportInterval frames. 0 disables the report.
+    uint32_t reportInterval = 0;
+    uint32_t reportAllocationCount = 10;
+
+    // 0 uses the budget the device reports
+    uint64_t budgetBytes = 0;
+
+    uint32_t historyFrameCount = 300;
+};
+
+struct GpuAllocationDesc
+{
+    uint64_t byteSize = 0;
+    GpuHeapType heapType = GpuHeapType::Default;
+    GpuMemoryCategory category = GpuMemoryCategory::Buffer;
+    std::string name;
+};
+
+struct GpuMemoryStats
+{
+    int64_t liveBytes = 0;
+    int64_t peakBytes = 0;
+    uint64_t liveAllocationCount = 0;
+};
+
+struct GpuMemoryBudget
+{
+    uint64_t usedBytes = 0;
+    // 0 when there is no budget
+    uint64_t budgetBytes = 0;
+
+    [[nodiscard]] bool isOverBudget() const { return budgetBytes > 0 && usedBytes > budgetBytes; }
+};
+
+struct GpuMemoryFrameSnapshot
+{
+    uint64_t frameNumber = 0;
+    EnumArray<int64_t, GpuMemoryCategory> categoryBytes{};
+    int64_t totalBytes = 0;
+};
+
+class GpuMemoryRegistry;
+
+class GpuMemoryAllocation
+{
+public:
+    GpuMemoryAllocation() = default;
+    GpuMemoryAllocation(const GpuMemoryAllocation&) = delete;
+    GpuMemoryAllocation(GpuMemoryAllocation&& other) noexcept;
+    ~GpuMemoryAllocation();
+
+    GpuMemoryAllocation& operator=(const GpuMemoryAllocation&) = delete;
+    GpuMemoryAllocation& operator=(GpuMemoryAllocation&& other) noexcept;
+
+    [[nodiscard]] bool isValid() const { return mRegistry != nullptr; }
+
+    // Removes the allocation from the registry
+    void reset();
+
+private:
+    friend class GpuMemoryRegistry;
+
+    GpuMemoryAllocation(GpuMemoryRegistry* registry, uint64_t id): mRegistry(registry), mId(id) {}
+
+    GpuMemoryRegistry* mRegistry = nullptr;
+    uint64_t mId = 0;
+};
+
+class GpuMemoryRegistry
+{
+public:
+    explicit GpuMemoryRegistry(const GpuMemoryParams& params = {});
+    GpuMemoryRegistry(const GpuMemoryRegistry&) = delete;
+    GpuMemoryRegistry(GpuMemoryRegistry&&) = delete;
+    ~GpuMemoryRegistry() = default;
+
+    GpuMemoryRegistry& operator=(const GpuMemoryRegistry&) = delete;
+    GpuMemoryRegistry& operator=(GpuMemoryRegistry&&) = delete;
+
+    [[nodiscard]] const GpuMemoryParams& getParams() const { return mParams; }
+
+    [[nodiscard]] GpuMemoryAllocation add(GpuAllocationDesc desc);
+
+    [[nodiscard]] GpuMemoryStats getCategoryStats(GpuMemoryCategory category) const;
+    [[nodiscard]] GpuMemoryStats getHeapStats(GpuHeapType heapType) const;
+    [[nodiscard]] GpuMemoryStats getTotalStats() const;
+
+    // Largest first
+    [[nodiscard]] std::vector<GpuAllocationDesc> getLargestAllocations(size_t count) const;
+
+    // Compares every committed byte against the configured budget, or deviceBudgetBytes if there is none. 0 means the
+    // device doesn't report a budget.
+    [[nodiscard]] GpuMemoryBudget getBudget(uint64_t deviceBudgetBytes = 0) const;
+
+    // Called once per frame. Records the frame's snapshot, checks the budget and logs the report when it's due.
+    void endFrame(uint64_t deviceBudgetBytes = 0);
+
+    // Oldest first
+    [[nodiscard]] std::vector<GpuMemoryFrameSnapshot> getHistory() const;
+
+    void logReport(uint64_t deviceBudgetBytes = 0) const;
+
+private:
+    friend class GpuMemoryAllocation;
+
+    void remove(uint64_t id);
+    [[nodiscard]] GpuMemoryBudget getBudgetLocked(uint64_t deviceBudgetBytes) const;
+
+    GpuMemoryParams mParams;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, GpuAllocationDesc> mAllocations;
+    uint64_t mNextId = 1;
+
+    EnumArray<GpuMemoryStats, GpuMemoryCategory> mCategoryStats{};
+    EnumArray<GpuMemoryStats, GpuHeapType> mHeapStats{};
+    GpuMemoryStats mTotalStats;
+
+    // A ring of historyFrameCount snapshots, mHistoryStart is the oldest once it's full
+    std::vector<GpuMemoryFrameSnapshot> mHistory;
+    size_t mHistoryStart = 0;
+    uint64_t mFrameNumber = 0;
+    bool mOverBudget = false;
+};
+} // namespace scrap
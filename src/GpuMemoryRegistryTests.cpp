@@ -0,0 +1,222 @@
+#include "GpuMemoryRegistry.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint64_t kMebibyte = 1024 * 1024;
+
+// Sends everything logged while it's alive into a string instead of the default logger
+class LogCapture
+{
+public:
+    LogCapture()
+        : mPreviousLogger(spdlog::default_logger())
+    {
+        auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(mStream);
+        sink->set_pattern("%l %v");
+        spdlog::set_default_logger(std::make_shared<spdlog::logger>("capture", sink));
+    }
+
+    LogCapture(const LogCapture&) = delete;
+    LogCapture(LogCapture&&) = delete;
+
+    ~LogCapture() { spdlog::set_default_logger(mPreviousLogger); }
+
+    LogCapture& operator=(const LogCapture&) = delete;
+    LogCapture& operator=(LogCapture&&) = delete;
+
+    // Lines logged at the level that contain the text
+    [[nodiscard]] uint32_t count(std::string_view level, std::string_view text) const
+    {
+        std::istringstream stream(mStream.str());
+        uint32_t lineCount = 0;
+
+        for(std::string line; std::getline(stream, line);)
+        {
+            if(line.starts_with(level) && line.find(text) != std::string::npos) { ++lineCount; }
+        }
+
+        return lineCount;
+    }
+
+private:
+    std::shared_ptr<spdlog::logger> mPreviousLogger;
+    std::ostringstream mStream;
+};
+
+GpuAllocationDesc MakeAllocation(uint64_t byteSize, GpuHeapType heapType, GpuMemoryCategory category, std::string name)
+{
+    return GpuAllocationDesc{.byteSize = byteSize, .heapType = heapType, .category = category, .name = std::move(name)};
+}
+} // namespace
+
+SCRAP_TEST(GpuMemoryRegistry, TracksCategoryAndHeapTotals)
+{
+    GpuMemoryRegistry registry;
+
+    GpuMemoryAllocation vertexBuffer =
+        registry.add(MakeAllocation(3 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Buffer, "Vertices"));
+    GpuMemoryAllocation staging =
+        registry.add(MakeAllocation(1 * kMebibyte, GpuHeapType::Upload, GpuMemoryCategory::Staging, "Staging"));
+    GpuMemoryAllocation texture =
+        registry.add(MakeAllocation(8 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Albedo"));
+
+    SCRAP_CHECK(registry.getCategoryStats(GpuMemoryCategory::Buffer).liveBytes == (int64_t)(3 * kMebibyte));
+    SCRAP_CHECK(registry.getCategoryStats(GpuMemoryCategory::Texture).liveAllocationCount == 1);
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Default).liveBytes == (int64_t)(11 * kMebibyte));
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Default).liveAllocationCount == 2);
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Upload).liveBytes == (int64_t)kMebibyte);
+    SCRAP_CHECK(registry.getTotalStats().liveBytes == (int64_t)(12 * kMebibyte));
+    SCRAP_CHECK(registry.getTotalStats().liveAllocationCount == 3);
+
+    texture.reset();
+    SCRAP_CHECK(!texture.isValid());
+    SCRAP_CHECK(registry.getCategoryStats(GpuMemoryCategory::Texture).liveBytes == 0);
+    SCRAP_CHECK(registry.getCategoryStats(GpuMemoryCategory::Texture).liveAllocationCount == 0);
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Default).liveBytes == (int64_t)(3 * kMebibyte));
+
+    // Moving the handle keeps the allocation, destroying it removes it
+    {
+        GpuMemoryAllocation movedStaging = std::move(staging);
+        SCRAP_CHECK(!staging.isValid());
+        SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Upload).liveBytes == (int64_t)kMebibyte);
+    }
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Upload).liveBytes == 0);
+    SCRAP_CHECK(registry.getTotalStats().liveBytes == (int64_t)(3 * kMebibyte));
+    SCRAP_CHECK(registry.getTotalStats().liveAllocationCount == 1);
+}
+
+SCRAP_TEST(GpuMemoryRegistry, KeepsPeakAfterRemoval)
+{
+    GpuMemoryRegistry registry;
+
+    {
+        GpuMemoryAllocation first =
+            registry.add(MakeAllocation(4 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "First"));
+        GpuMemoryAllocation second =
+            registry.add(MakeAllocation(6 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Second"));
+    }
+
+    GpuMemoryAllocation third =
+        registry.add(MakeAllocation(2 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Third"));
+
+    const GpuMemoryStats textureStats = registry.getCategoryStats(GpuMemoryCategory::Texture);
+    SCRAP_CHECK(textureStats.liveBytes == (int64_t)(2 * kMebibyte));
+    SCRAP_CHECK(textureStats.peakBytes == (int64_t)(10 * kMebibyte));
+    SCRAP_CHECK(registry.getHeapStats(GpuHeapType::Default).peakBytes == (int64_t)(10 * kMebibyte));
+    SCRAP_CHECK(registry.getTotalStats().peakBytes == (int64_t)(10 * kMebibyte));
+    SCRAP_CHECK(registry.getCategoryStats(GpuMemoryCategory::Buffer).peakBytes == 0);
+}
+
+SCRAP_TEST(GpuMemoryRegistry, LogsOnlyBudgetCrossings)
+{
+    GpuMemoryRegistry registry(GpuMemoryParams{.budgetBytes = 10 * kMebibyte});
+    LogCapture logCapture;
+
+    GpuMemoryAllocation base =
+        registry.add(MakeAllocation(8 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Base"));
+    registry.endFrame();
+
+    GpuMemoryAllocation spike =
+        registry.add(MakeAllocation(4 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Spike"));
+    SCRAP_CHECK(registry.getBudget().isOverBudget());
+
+    // Several frames over the budget only warn once
+    for(uint32_t frame = 0; frame < 5; ++frame)
+    {
+        registry.endFrame();
+    }
+    SCRAP_CHECK(logCapture.count("warning", "over budget") == 1);
+    SCRAP_CHECK(logCapture.count("info", "back under budget") == 0);
+
+    spike.reset();
+    registry.endFrame();
+    registry.endFrame();
+    SCRAP_CHECK(logCapture.count("info", "back under budget") == 1);
+
+    spike = registry.add(MakeAllocation(4 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Spike"));
+    registry.endFrame();
+    SCRAP_CHECK(logCapture.count("warning", "over budget") == 2);
+}
+
+SCRAP_TEST(GpuMemoryRegistry, UsesDeviceBudgetWithoutConfiguredBudget)
+{
+    GpuMemoryRegistry registry;
+
+    GpuMemoryAllocation texture =
+        registry.add(MakeAllocation(8 * kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Texture, "Texture"));
+
+    SCRAP_CHECK(!registry.getBudget().isOverBudget());
+    SCRAP_CHECK(registry.getBudget(4 * kMebibyte).isOverBudget());
+    SCRAP_CHECK(registry.getBudget(4 * kMebibyte).usedBytes == 8 * kMebibyte);
+    SCRAP_CHECK(!registry.getBudget(16 * kMebibyte).isOverBudget());
+}
+
+SCRAP_TEST(GpuMemoryRegistry, HistoryWrapsAround)
+{
+    GpuMemoryRegistry registry(GpuMemoryParams{.historyFrameCount = 4});
+
+    std::vector<GpuMemoryAllocation> allocations;
+    for(uint32_t frame = 1; frame <= 10; ++frame)
+    {
+        allocations.push_back(
+            registry.add(MakeAllocation(kMebibyte, GpuHeapType::Default, GpuMemoryCategory::Buffer, "Buffer")));
+        registry.endFrame();
+
+        SCRAP_CHECK(registry.getHistory().size() == std::min(frame, 4u));
+    }
+
+    // The last four frames, oldest first
+    const std::vector<GpuMemoryFrameSnapshot> history = registry.getHistory();
+    SCRAP_REQUIRE(history.size() == 4);
+    for(size_t index = 0; index < history.size(); ++index)
+    {
+        const uint64_t frameNumber = 7 + index;
+        SCRAP_CHECK(history[index].frameNumber == frameNumber);
+        SCRAP_CHECK(history[index].totalBytes == (int64_t)(frameNumber * kMebibyte));
+        SCRAP_CHECK(history[index].categoryBytes[GpuMemoryCategory::Buffer] == (int64_t)(frameNumber * kMebibyte));
+    }
+}
+
+SCRAP_TEST(GpuMemoryRegistry, ListsLargestAllocationsFirst)
+{
+    GpuMemoryRegistry registry;
+
+    std::vector<GpuMemoryAllocation> allocations;
+    for(uint64_t size : {3u, 9u, 1u, 7u, 5u})
+    {
+        allocations.push_back(registry.add(MakeAllocation(size * kMebibyte, GpuHeapType::Default,
+                                                          GpuMemoryCategory::Buffer, fmt::format("{} MiB", size))));
+    }
+
+    const std::vector<GpuAllocationDesc> largest = registry.getLargestAllocations(3);
+    SCRAP_REQUIRE(largest.size() == 3);
+    SCRAP_CHECK(largest[0].byteSize == 9 * kMebibyte);
+    SCRAP_CHECK(largest[0].name == "9 MiB");
+    SCRAP_CHECK(largest[1].byteSize == 7 * kMebibyte);
+    SCRAP_CHECK(largest[2].byteSize == 5 * kMebibyte);
+
+    // Clamped to the live allocations
+    const std::vector<GpuAllocationDesc> all = registry.getLargestAllocations(100);
+    SCRAP_REQUIRE(all.size() == 5);
+    SCRAP_CHECK(all.back().byteSize == kMebibyte);
+
+    SCRAP_CHECK(registry.getLargestAllocations(0).empty());
+
+    allocations.clear();
+    SCRAP_CHECK(registry.getLargestAllocations(3).empty());
+}
+} // namespace scrap
@@ -1,6 +1,7 @@
 #include "GpuMesh.h"
 
 #include "CpuMesh.h"
+#include "MemoryTracker.h"
 #include "d3d12/D3D12BLAccelerationStructure.h"
 #include "d3d12/D3D12Buffer.h"
 #include "d3d12/D3D12VertexBuffer.h"
@@ -15,6 +16,8 @@ GpuMesh::GpuMesh(PrimitiveTopology topology): mPrimitiveTopology(topology) {}
 GpuMesh::GpuMesh(const CpuMesh& cpuMesh, ResourceAccessFlags accessFlags, std::string_view name)
     : mPrimitiveTopology(cpuMesh.getPrimitiveTopology())
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     std::string bufferName;
 
     {
@@ -0,0 +1,122 @@
+#include "GpuTimestampTracker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include <fmt/format.h>
+
+namespace scrap
+{
+void GpuTimestampTracker::init(uint32_t frameSlotCount, uint32_t maxScopesPerFrame)
+{
+    assert(frameSlotCount > 0);
+
+    mFrameSlotCount = frameSlotCount;
+    mQueriesPerSlot = maxScopesPerFrame * kQueriesPerScope;
+    mCurrentSlot = 0;
+
+    mFrameSlots.clear();
+    mFrameSlots.resize(frameSlotCount);
+    for(FrameSlot& frameSlot : mFrameSlots)
+    {
+        frameSlot.scopes.reserve(maxScopesPerFrame);
+    }
+}
+
+std::optional<uint32_t> GpuTimestampTracker::beginScope(std::string_view label, uint32_t depth)
+{
+    std::lock_guard lockGuard(mScopeMutex);
+
+    FrameSlot& frameSlot = mFrameSlots[mCurrentSlot];
+    const uint32_t scopeIndex = (uint32_t)frameSlot.scopes.size();
+    if((scopeIndex + 1) * kQueriesPerScope > mQueriesPerSlot)
+    {
+        ++mDroppedScopeCount;
+        return std::nullopt;
+    }
+
+    frameSlot.scopes.push_back(
+        Scope{.labelOffset = (uint32_t)frameSlot.labels.size(), .labelLength = (uint32_t)label.size(), .depth = depth});
+    frameSlot.labels.append(label);
+
+    return mCurrentSlot * mQueriesPerSlot + scopeIndex * kQueriesPerScope;
+}
+
+GpuTimestampQueryRange GpuTimestampTracker::endFrame(uint64_t frameNumber)
+{
+    std::lock_guard lockGuard(mScopeMutex);
+
+    FrameSlot& frameSlot = mFrameSlots[mCurrentSlot];
+    frameSlot.frameNumber = frameNumber;
+    frameSlot.resolved = true;
+
+    return GpuTimestampQueryRange{.firstQuery = mCurrentSlot * mQueriesPerSlot,
+                                  .queryCount = (uint32_t)frameSlot.scopes.size() * kQueriesPerScope};
+}
+
+bool GpuTimestampTracker::beginFrame(uint32_t slot, std::span<const uint64_t> timestamps, uint64_t timestampFrequency)
+{
+    assert(slot < mFrameSlotCount);
+    assert(timestamps.empty() || timestamps.size() >= getQueryCount());
+
+    std::lock_guard lockGuard(mScopeMutex);
+
+    FrameSlot& frameSlot = mFrameSlots[slot];
+    const bool hadResults = frameSlot.resolved && !timestamps.empty() && timestampFrequency > 0;
+    if(hadResults)
+    {
+        readSlot(frameSlot, timestamps.subspan((size_t)slot * mQueriesPerSlot, mQueriesPerSlot), timestampFrequency);
+    }
+
+    frameSlot.scopes.clear();
+    frameSlot.labels.clear();
+    frameSlot.resolved = false;
+
+    mCurrentSlot = slot;
+
+    return hadResults;
+}
+
+void GpuTimestampTracker::readSlot(const FrameSlot& frameSlot,
+                                   std::span<const uint64_t> slotTimestamps,
+                                   uint64_t timestampFrequency)
+{
+    const double ticksToMilliseconds = 1000.0 / (double)timestampFrequency;
+
+    mPassTimingIndices.clear();
+    mPassTimings.clear();
+    mPassTimingsFrameNumber = frameSlot.frameNumber;
+
+    uint64_t frameBegin = std::numeric_limits<uint64_t>::max();
+    uint64_t frameEnd = 0;
+
+    fmt::memory_buffer key;
+    for(size_t scopeIndex = 0; scopeIndex < frameSlot.scopes.size(); ++scopeIndex)
+    {
+        const Scope& scope = frameSlot.scopes[scopeIndex];
+        const uint64_t begin = slotTimestamps[scopeIndex * kQueriesPerScope];
+        const uint64_t end = slotTimestamps[scopeIndex * kQueriesPerScope + 1];
+
+        // A scope whose end was never written, or one that was recorded into a command list that didn't execute
+        if(end < begin) { continue; }
+
+        frameBegin = std::min(frameBegin, begin);
+        frameEnd = std::max(frameEnd, end);
+
+        const std::string_view label(frameSlot.labels.data() + scope.labelOffset, scope.labelLength);
+
+        key.clear();
+        fmt::format_to(fmt::appender(key), "{}/{}", scope.depth, label);
+
+        auto [itr, inserted] = mPassTimingIndices.try_emplace(std::string(key.data(), key.size()), mPassTimings.size());
+        if(inserted) { mPassTimings.push_back(GpuPassTiming{.label = std::string(label), .depth = scope.depth}); }
+
+        GpuPassTiming& passTiming = mPassTimings[itr->second];
+        ++passTiming.scopeCount;
+        passTiming.milliseconds += (double)(end - begin) * ticksToMilliseconds;
+    }
+
+    mFrameMilliseconds = (frameEnd > frameBegin) ? (double)(frameEnd - frameBegin) * ticksToMilliseconds : 0.0;
+}
+} // namespace scrap
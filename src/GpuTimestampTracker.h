@@ -0,0 +1,117 @@
+// Classes:
+//   GpuTimestampTracker
+//
+// The bookkeeping behind gpu timestamp queries, without anything device specific. A query heap is split into one slot
+// per frame in flight. Every timed scope takes two consecutive queries from the current frame's slot, one for its
+// begin and one for its end timestamp. At the end of the frame the used part of the slot is resolved into the same
+// range of a readback buffer. The gpu is done with the slot once the frame's fence completes, which is when the frame
+// slot comes around again, so the results are read right before the slot is reused.
+//
+// GpuTimestampTracker:
+//   Hands out the query indices and remembers the label and depth of every scope, so the timestamps can be turned
+//   into per pass times later. beginScope can be called from several threads while a frame is recorded. Everything
+//   else is called by the thread that ends the frames. Scopes that don't fit in a slot aren't timed and are counted.
+//
+//   Scopes with the same label at the same depth are added up, so a pass recorded in chunks shows up once.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scrap
+{
+struct GpuPassTiming
+{
+    std::string label;
+    // Nesting of the scope on the thread that recorded it
+    uint32_t depth = 0;
+    uint32_t scopeCount = 0;
+    double milliseconds = 0.0;
+};
+
+struct GpuTimestampQueryRange
+{
+    uint32_t firstQuery = 0;
+    uint32_t queryCount = 0;
+};
+
+class GpuTimestampTracker
+{
+public:
+    static constexpr uint32_t kQueriesPerScope = 2;
+
+    GpuTimestampTracker() = default;
+    GpuTimestampTracker(const GpuTimestampTracker&) = delete;
+    GpuTimestampTracker(GpuTimestampTracker&&) = delete;
+    ~GpuTimestampTracker() = default;
+
+    GpuTimestampTracker& operator=(const GpuTimestampTracker&) = delete;
+    GpuTimestampTracker& operator=(GpuTimestampTracker&&) = delete;
+
+    void init(uint32_t frameSlotCount, uint32_t maxScopesPerFrame);
+
+    // The size of the query heap and the readback buffer, in queries
+    [[nodiscard]] uint32_t getQueryCount() const { return mFrameSlotCount * mQueriesPerSlot; }
+    [[nodiscard]] uint32_t getCurrentSlot() const { return mCurrentSlot; }
+
+    // Returns the query for the begin timestamp. The end timestamp goes into the query after it. Empty when the
+    // frame's slot is full.
+    [[nodiscard]] std::optional<uint32_t> beginScope(std::string_view label, uint32_t depth);
+
+    // The queries the current frame used, which have to be resolved before the frame's fence is signaled
+    [[nodiscard]] GpuTimestampQueryRange endFrame(uint64_t frameNumber);
+
+    // Reads the timestamps of the frame that last used the slot and starts recording the next frame into it. The gpu
+    // has to be done with the slot. timestamps is the whole readback buffer. Returns false if the slot didn't hold a
+    // resolved frame.
+    bool beginFrame(uint32_t slot, std::span<const uint64_t> timestamps, uint64_t timestampFrequency);
+
+    // The timings of the last frame beginFrame read, in the order its scopes began
+    [[nodiscard]] std::span<const GpuPassTiming> getPassTimings() const { return mPassTimings; }
+    [[nodiscard]] uint64_t getPassTimingsFrameNumber() const { return mPassTimingsFrameNumber; }
+    // From the first begin to the last end timestamp of the frame
+    [[nodiscard]] double getFrameMilliseconds() const { return mFrameMilliseconds; }
+
+    [[nodiscard]] uint64_t getDroppedScopeCount() const { return mDroppedScopeCount; }
+
+private:
+    struct Scope
+    {
+        uint32_t labelOffset;
+        uint32_t labelLength;
+        uint32_t depth;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<Scope> scopes;
+        std::string labels;
+        uint64_t frameNumber = 0;
+        bool resolved = false;
+    };
+
+    void readSlot(const FrameSlot& frameSlot,
+                  std::span<const uint64_t> slotTimestamps,
+                  uint64_t timestampFrequency);
+
+    uint32_t mFrameSlotCount = 0;
+    uint32_t mQueriesPerSlot = 0;
+    uint32_t mCurrentSlot = 0;
+
+    std::mutex mScopeMutex;
+    std::vector<FrameSlot> mFrameSlots;
+    uint64_t mDroppedScopeCount = 0;
+
+    std::unordered_map<std::string, size_t> mPassTimingIndices;
+    std::vector<GpuPassTiming> mPassTimings;
+    uint64_t mPassTimingsFrameNumber = 0;
+    double mFrameMilliseconds = 0.0;
+};
+} // namespace scrap
@@ -0,0 +1,136 @@
+#include "GpuTimestampTracker.h"
+#include "UnitTest.h"
+
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace scrap
+{
+namespace
+{
+// One tick per millisecond keeps the expected times exact
+constexpr uint64_t kTimestampFrequency = 1000;
+} // namespace
+
+SCRAP_TEST(GpuTimestampTracker, HandsOutQueryPairsOfCurrentSlot)
+{
+    GpuTimestampTracker tracker;
+    tracker.init(3, 4);
+    SCRAP_CHECK(tracker.getQueryCount() == 24);
+
+    SCRAP_CHECK(!tracker.beginFrame(1, {}, kTimestampFrequency));
+    SCRAP_CHECK(tracker.getCurrentSlot() == 1);
+
+    SCRAP_CHECK(tracker.beginScope("Shadows", 0) == 8u);
+    SCRAP_CHECK(tracker.beginScope("Opaque", 0) == 10u);
+    SCRAP_CHECK(tracker.beginScope("Sky", 1) == 12u);
+
+    // Only the used part of the slot is resolved
+    const GpuTimestampQueryRange range = tracker.endFrame(1);
+    SCRAP_CHECK(range.firstQuery == 8);
+    SCRAP_CHECK(range.queryCount == 6);
+}
+
+SCRAP_TEST(GpuTimestampTracker, DropsScopesOfFullSlot)
+{
+    GpuTimestampTracker tracker;
+    tracker.init(2, 2);
+    (void)tracker.beginFrame(0, {}, kTimestampFrequency);
+
+    SCRAP_CHECK(tracker.beginScope("Shadows", 0).has_value());
+    SCRAP_CHECK(tracker.beginScope("Opaque", 0).has_value());
+    SCRAP_CHECK(!tracker.beginScope("Transparent", 0).has_value());
+    SCRAP_CHECK(!tracker.beginScope("Post", 0).has_value());
+    SCRAP_CHECK(tracker.getDroppedScopeCount() == 2);
+
+    const GpuTimestampQueryRange range = tracker.endFrame(1);
+    SCRAP_CHECK(range.firstQuery == 0);
+    SCRAP_CHECK(range.queryCount == 4);
+
+    // The next slot starts out empty again
+    (void)tracker.beginFrame(1, {}, kTimestampFrequency);
+    SCRAP_CHECK(tracker.beginScope("Shadows", 0) == 4u);
+    SCRAP_CHECK(tracker.getDroppedScopeCount() == 2);
+}
+
+SCRAP_TEST(GpuTimestampTracker, ReadsSlotWhenItComesAround)
+{
+    constexpr uint32_t kFrameSlotCount = 3;
+
+    GpuTimestampTracker tracker;
+    tracker.init(kFrameSlotCount, 4);
+
+    std::vector<uint64_t> timestamps(tracker.getQueryCount(), 0);
+
+    for(uint64_t frameNumber = 0; frameNumber < 10; ++frameNumber)
+    {
+        const uint32_t slot = (uint32_t)(frameNumber % kFrameSlotCount);
+
+        // The first time around, the slots hold nothing
+        const bool hadResults = tracker.beginFrame(slot, timestamps, kTimestampFrequency);
+        SCRAP_CHECK(hadResults == (frameNumber >= kFrameSlotCount));
+
+        if(hadResults)
+        {
+            // The results are the frame that used the slot before, not one of the frames still in flight
+            SCRAP_CHECK(tracker.getPassTimingsFrameNumber() == frameNumber - kFrameSlotCount);
+            SCRAP_REQUIRE(tracker.getPassTimings().size() == 1);
+            SCRAP_CHECK(tracker.getPassTimings()[0].label == fmt::format("Frame {}", frameNumber - kFrameSlotCount));
+            SCRAP_CHECK(tracker.getPassTimings()[0].milliseconds == (double)(frameNumber - kFrameSlotCount + 1));
+        }
+
+        const std::string label = fmt::format("Frame {}", frameNumber);
+        const std::optional<uint32_t> query = tracker.beginScope(label, 0);
+        SCRAP_REQUIRE(query.has_value());
+
+        // What resolving the range writes into the readback buffer
+        const GpuTimestampQueryRange range = tracker.endFrame(frameNumber);
+        SCRAP_REQUIRE(range.firstQuery == query.value() && range.queryCount == 2);
+        timestamps[range.firstQuery] = 100;
+        timestamps[range.firstQuery + 1] = 100 + frameNumber + 1;
+    }
+}
+
+SCRAP_TEST(GpuTimestampTracker, SumsScopesWithSameLabelAndDepth)
+{
+    GpuTimestampTracker tracker;
+    tracker.init(1, 8);
+
+    std::vector<uint64_t> timestamps(tracker.getQueryCount(), 0);
+
+    (void)tracker.beginFrame(0, timestamps, kTimestampFrequency);
+    const uint32_t opaqueChunk0 = tracker.beginScope("Opaque", 0).value_or(0);
+    const uint32_t opaqueChunk1 = tracker.beginScope("Opaque", 0).value_or(0);
+    const uint32_t nestedOpaque = tracker.beginScope("Opaque", 1).value_or(0);
+    const uint32_t unfinished = tracker.beginScope("Unfinished", 0).value_or(0);
+    (void)tracker.endFrame(7);
+
+    timestamps[opaqueChunk0] = 10;
+    timestamps[opaqueChunk0 + 1] = 14;
+    timestamps[opaqueChunk1] = 12;
+    timestamps[opaqueChunk1 + 1] = 18;
+    timestamps[nestedOpaque] = 13;
+    timestamps[nestedOpaque + 1] = 15;
+    // An end timestamp that was never written
+    timestamps[unfinished] = 20;
+    timestamps[unfinished + 1] = 0;
+
+    SCRAP_REQUIRE(tracker.beginFrame(0, timestamps, kTimestampFrequency));
+    SCRAP_CHECK(tracker.getPassTimingsFrameNumber() == 7);
+
+    const std::span<const GpuPassTiming> passTimings = tracker.getPassTimings();
+    SCRAP_REQUIRE(passTimings.size() == 2);
+    SCRAP_CHECK(passTimings[0].label == "Opaque");
+    SCRAP_CHECK(passTimings[0].depth == 0);
+    SCRAP_CHECK(passTimings[0].scopeCount == 2);
+    SCRAP_CHECK(passTimings[0].milliseconds == 10.0);
+    SCRAP_CHECK(passTimings[1].label == "Opaque");
+    SCRAP_CHECK(passTimings[1].depth == 1);
+    SCRAP_CHECK(passTimings[1].milliseconds == 2.0);
+
+    // From the first begin to the last end, without the unfinished scope
+    SCRAP_CHECK(tracker.getFrameMilliseconds() == 8.0);
+}
+} // namespace scrap
@@ -0,0 +1,153 @@
+#include "InitGraph.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+InitTaskId InitGraph::addTask(std::string_view name,
+                              TaskFunction function,
+                              std::initializer_list<InitTaskId> dependencies)
+{
+    return addTask(name, std::move(function), std::span<const InitTaskId>(dependencies.begin(), dependencies.size()));
+}
+
+InitTaskId InitGraph::addTask(std::string_view name, TaskFunction function, std::span<const InitTaskId> dependencies)
+{
+    const InitTaskId taskId = (InitTaskId)mTasks.size();
+
+    auto task = std::make_unique<Task>();
+    task->name = name;
+    task->function = std::move(function);
+    task->dependencies.assign(dependencies.begin(), dependencies.end());
+    task->pendingDependencyCount.store((uint32_t)dependencies.size(), std::memory_order_relaxed);
+
+    for(InitTaskId dependency : dependencies)
+    {
+        assert(dependency < taskId);
+        mTasks[dependency]->dependents.push_back(taskId);
+    }
+
+    mTasks.push_back(std::move(task));
+
+    return taskId;
+}
+
+bool InitGraph::run(JobSystem& jobSystem)
+{
+    mThreadCount = jobSystem.getThreadCount();
+    mStartTime = std::chrono::steady_clock::now();
+
+    JobCounter counter;
+    mRunCounter = &counter;
+
+    for(InitTaskId taskId = 0; taskId < (InitTaskId)mTasks.size(); ++taskId)
+    {
+        if(!mTasks[taskId]->dependencies.empty()) { continue; }
+
+        jobSystem.run([this, &jobSystem, taskId]() { runTask(jobSystem, taskId); }, &counter);
+    }
+
+    // Dependents are run from the job that finished their last dependency, which is before that job decrements the
+    // counter. The counter can't reach 0 while any task is still on its way.
+    jobSystem.wait(counter);
+
+    mEndTime = std::chrono::steady_clock::now();
+    mRunCounter = nullptr;
+
+    return std::all_of(mTasks.begin(), mTasks.end(),
+                       [](const std::unique_ptr<Task>& task) { return task->status == InitTaskStatus::Succeeded; });
+}
+
+bool InitGraph::hasSucceeded(std::span<const InitTaskId> tasks) const
+{
+    return std::all_of(tasks.begin(), tasks.end(),
+                       [this](InitTaskId task) { return mTasks[task]->status == InitTaskStatus::Succeeded; });
+}
+
+void InitGraph::runTask(JobSystem& jobSystem, InitTaskId taskId)
+{
+    Task& task = *mTasks[taskId];
+
+    task.workerIndex = jobSystem.getCurrentWorkerIndex();
+    task.startTime = std::chrono::steady_clock::now();
+
+    if(task.dependencyFailed.load(std::memory_order_acquire)) { task.status = InitTaskStatus::Skipped; }
+    else { task.status = task.function() ? InitTaskStatus::Succeeded : InitTaskStatus::Failed; }
+
+    task.endTime = std::chrono::steady_clock::now();
+
+    if(task.status == InitTaskStatus::Failed) { spdlog::error("Init task '{}' failed", task.name); }
+
+    // The release on the last decrement publishes this task's results to the dependent that runs next
+    for(InitTaskId dependentId : task.dependents)
+    {
+        Task& dependent = *mTasks[dependentId];
+
+        if(task.status != InitTaskStatus::Succeeded)
+        {
+            dependent.dependencyFailed.store(true, std::memory_order_release);
+        }
+
+        if(dependent.pendingDependencyCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            jobSystem.run([this, &jobSystem, dependentId]() { runTask(jobSystem, dependentId); }, mRunCounter);
+        }
+    }
+}
+
+void InitGraph::logReport(std::string_view graphName) const
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // Dependencies always come before their dependents, so one pass in order finds every task's longest chain
+    std::vector<std::chrono::nanoseconds> chainEndTimes(mTasks.size());
+    std::chrono::nanoseconds totalTaskTime{0};
+    std::chrono::nanoseconds criticalPathTime{0};
+
+    for(size_t taskIndex = 0; taskIndex < mTasks.size(); ++taskIndex)
+    {
+        const Task& task = *mTasks[taskIndex];
+        const std::chrono::nanoseconds taskTime = task.endTime - task.startTime;
+
+        std::chrono::nanoseconds chainStartTime{0};
+        for(InitTaskId dependency : task.dependencies)
+        {
+            chainStartTime = std::max(chainStartTime, chainEndTimes[dependency]);
+        }
+
+        chainEndTimes[taskIndex] = chainStartTime + taskTime;
+        criticalPathTime = std::max(criticalPathTime, chainEndTimes[taskIndex]);
+        totalTaskTime += taskTime;
+    }
+
+    spdlog::info("{} took {:.3f} ms on {} threads. The tasks add up to {:.3f} ms with a critical path of {:.3f} ms",
+                 graphName, Milliseconds(mEndTime - mStartTime).count(), mThreadCount,
+                 Milliseconds(totalTaskTime).count(), Milliseconds(criticalPathTime).count());
+
+    std::vector<const Task*> tasksByStartTime;
+    tasksByStartTime.reserve(mTasks.size());
+    for(const std::unique_ptr<Task>& task : mTasks)
+    {
+        tasksByStartTime.push_back(task.get());
+    }
+
+    std::sort(tasksByStartTime.begin(), tasksByStartTime.end(),
+              [](const Task* left, const Task* right) { return left->startTime < right->startTime; });
+
+    for(const Task* task : tasksByStartTime)
+    {
+        const std::string workerName = (task->workerIndex == JobSystem::kExternalThread)
+                                           ? std::string("external")
+                                           : fmt::format("worker {}", task->workerIndex);
+
+        spdlog::info("    {:<40} start {:>9.3f} ms, {:>9.3f} ms, {}, {}", task->name,
+                     Milliseconds(task->startTime - mStartTime).count(),
+                     Milliseconds(task->endTime - task->startTime).count(), workerName, task->status);
+    }
+}
+} // namespace scrap
@@ -0,0 +1,126 @@
+// Classes:
+//   InitGraph
+//
+// InitGraph:
+//   Runs startup work as a graph of tasks on the JobSystem. A task starts as soon as every task it depends on has
+//   succeeded, so tasks that don't depend on each other run at the same time. A task that fails, or that depends on
+//   one that failed, makes everything after it get skipped instead of run against half created objects. Dependencies
+//   always point at tasks that were added earlier, which keeps the graph free of cycles.
+//
+//   Every task records when it started and finished and which worker ran it. logReport prints the per task breakdown
+//   along with the total time, the time all tasks would have taken one after another and the critical path, which is
+//   the longest chain of dependent tasks and the shortest the startup could possibly take.
+//
+//   Tasks run on worker threads, so anything they touch that another task might touch at the same time has to be
+//   thread safe. Tasks that record gpu commands should only record them. Submitting and waiting on the gpu is left to
+//   the code that runs the graph, once it has finished.
+
+#pragma once
+
+#include "StringUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace scrap
+{
+class JobCounter;
+class JobSystem;
+
+using InitTaskId = uint32_t;
+
+enum class InitTaskStatus
+{
+    Pending,
+    Succeeded,
+    Failed,
+    Skipped,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(InitTaskStatus status)
+{
+    switch(status)
+    {
+    case scrap::InitTaskStatus::Pending: return "Pending";
+    case scrap::InitTaskStatus::Succeeded: return "Succeeded";
+    case scrap::InitTaskStatus::Failed: return "Failed";
+    case scrap::InitTaskStatus::Skipped: return "Skipped";
+    default: return "Unknown InitTaskStatus";
+    }
+}
+
+class InitGraph
+{
+public:
+    // Returns false when the task failed
+    using TaskFunction = std::function<bool()>;
+
+    InitGraph() = default;
+    InitGraph(const InitGraph&) = delete;
+    InitGraph(InitGraph&&) = delete;
+    ~InitGraph() = default;
+
+    InitGraph& operator=(const InitGraph&) = delete;
+    InitGraph& operator=(InitGraph&&) = delete;
+
+    // Can't be called once the graph is running
+    InitTaskId addTask(std::string_view name,
+                       TaskFunction function,
+                       std::initializer_list<InitTaskId> dependencies = {});
+    InitTaskId addTask(std::string_view name, TaskFunction function, std::span<const InitTaskId> dependencies);
+
+    // Runs every task and returns once they have all finished or been skipped. Returns true if every task succeeded.
+    bool run(JobSystem& jobSystem);
+
+    [[nodiscard]] InitTaskStatus getStatus(InitTaskId task) const { return mTasks[task]->status; }
+    [[nodiscard]] bool hasSucceeded(std::span<const InitTaskId> tasks) const;
+
+    void logReport(std::string_view graphName) const;
+
+private:
+    struct Task
+    {
+        std::string name;
+        TaskFunction function;
+        std::vector<InitTaskId> dependencies;
+        std::vector<InitTaskId> dependents;
+
+        // Dependencies that haven't finished yet
+        std::atomic<uint32_t> pendingDependencyCount{0};
+        // Set by any dependency that didn't succeed
+        std::atomic<bool> dependencyFailed{false};
+
+        InitTaskStatus status = InitTaskStatus::Pending;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point endTime;
+        uint32_t workerIndex = 0;
+    };
+
+    void runTask(JobSystem& jobSystem, InitTaskId taskId);
+
+    // Tasks are never moved once added, their atomics are shared with the jobs that run them
+    std::vector<std::unique_ptr<Task>> mTasks;
+
+    std::chrono::steady_clock::time_point mStartTime;
+    std::chrono::steady_clock::time_point mEndTime;
+    uint32_t mThreadCount = 0;
+
+    // Only set while run() is running. Every task's job counts against it.
+    JobCounter* mRunCounter = nullptr;
+};
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::InitTaskStatus> : public scrap::ToStringViewFormatter<scrap::InitTaskStatus>
+{};
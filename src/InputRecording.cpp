@@ -0,0 +1,228 @@
+#include "InputRecording.h"
+
+#include <fstream>
+#include <utility>
+
+#include <SDL2/SDL_events.h>
+
+namespace scrap
+{
+namespace
+{
+constexpr std::array<char, 4> kInputRecordingFileMagic = {'S', 'I', 'N', 'P'};
+constexpr uint32_t kInputRecordingFileVersion = 1;
+
+struct InputRecordingFileHeader
+{
+    std::array<char, 4> magic = kInputRecordingFileMagic;
+    uint32_t version = kInputRecordingFileVersion;
+    uint32_t frameCount = 0;
+    uint32_t eventCount = 0;
+};
+
+template<class T>
+void WriteValue(std::ofstream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+bool ReadValue(std::ifstream& stream, T& value)
+{
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+}
+} // namespace
+
+tl::expected<InputRecording, InputRecordingError> LoadInputRecording(const std::filesystem::path& filePath)
+{
+    std::ifstream stream(filePath, std::ios::binary);
+    if(!stream.is_open()) { return tl::make_unexpected(InputRecordingError::FileOpenFailed); }
+
+    InputRecordingFileHeader header;
+    if(!ReadValue(stream, header)) { return tl::make_unexpected(InputRecordingError::FileReadFailed); }
+    if(header.magic != kInputRecordingFileMagic) { return tl::make_unexpected(InputRecordingError::InvalidFile); }
+    if(header.version != kInputRecordingFileVersion)
+    {
+        return tl::make_unexpected(InputRecordingError::UnsupportedVersion);
+    }
+
+    InputRecording recording;
+
+    recording.frames.resize(header.frameCount);
+    stream.read(reinterpret_cast<char*>(recording.frames.data()),
+                recording.frames.size() * sizeof(RecordedInputFrame));
+
+    recording.events.resize(header.eventCount);
+    stream.read(reinterpret_cast<char*>(recording.events.data()),
+                recording.events.size() * sizeof(RecordedInputEvent));
+
+    if(!stream.good()) { return tl::make_unexpected(InputRecordingError::FileReadFailed); }
+
+    // The frames have to account for exactly the events in the file
+    uint64_t frameEventCount = 0;
+    for(const RecordedInputFrame& frame : recording.frames)
+    {
+        frameEventCount += frame.eventCount;
+    }
+    if(frameEventCount != header.eventCount) { return tl::make_unexpected(InputRecordingError::InvalidFile); }
+
+    for(const RecordedInputEvent& event : recording.events)
+    {
+        if(event.type >= RecordedInputEventType::Count)
+        {
+            return tl::make_unexpected(InputRecordingError::InvalidFile);
+        }
+    }
+
+    return recording;
+}
+
+std::optional<InputRecordingError> SaveInputRecording(const std::filesystem::path& filePath,
+                                                      const InputRecording& recording)
+{
+    std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open()) { return InputRecordingError::FileOpenFailed; }
+
+    InputRecordingFileHeader header;
+    header.frameCount = (uint32_t)recording.frames.size();
+    header.eventCount = (uint32_t)recording.events.size();
+    WriteValue(stream, header);
+
+    stream.write(reinterpret_cast<const char*>(recording.frames.data()),
+                 recording.frames.size() * sizeof(RecordedInputFrame));
+    stream.write(reinterpret_cast<const char*>(recording.events.data()),
+                 recording.events.size() * sizeof(RecordedInputEvent));
+
+    if(!stream.good()) { return InputRecordingError::FileWriteFailed; }
+
+    return std::nullopt;
+}
+
+std::optional<RecordedInputEvent> RecordInputEvent(const SDL_Event& event, uint32_t mainWindowId)
+{
+    RecordedInputEvent recordedEvent;
+
+    switch(event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        recordedEvent.type =
+            (event.type == SDL_KEYDOWN) ? RecordedInputEventType::KeyDown : RecordedInputEventType::KeyUp;
+        recordedEvent.forMainWindow = (event.key.windowID == mainWindowId);
+        recordedEvent.repeatOrButton = event.key.repeat;
+        recordedEvent.values[0] = event.key.keysym.sym;
+        return recordedEvent;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        recordedEvent.type = (event.type == SDL_MOUSEBUTTONDOWN) ? RecordedInputEventType::MouseButtonDown
+                                                                 : RecordedInputEventType::MouseButtonUp;
+        recordedEvent.forMainWindow = (event.button.windowID == mainWindowId);
+        recordedEvent.repeatOrButton = event.button.button;
+        recordedEvent.clicks = event.button.clicks;
+        return recordedEvent;
+    case SDL_MOUSEMOTION:
+        recordedEvent.type = RecordedInputEventType::MouseMotion;
+        recordedEvent.forMainWindow = (event.motion.windowID == mainWindowId);
+        recordedEvent.values = {event.motion.x, event.motion.y, event.motion.xrel, event.motion.yrel};
+        return recordedEvent;
+    case SDL_MOUSEWHEEL:
+        recordedEvent.type = RecordedInputEventType::MouseWheel;
+        recordedEvent.forMainWindow = (event.wheel.windowID == mainWindowId);
+        recordedEvent.values[0] = event.wheel.y;
+        recordedEvent.values[1] = (int32_t)event.wheel.direction;
+        return recordedEvent;
+    default: return std::nullopt;
+    }
+}
+
+SDL_Event ToSdlEvent(const RecordedInputEvent& recordedEvent, uint32_t mainWindowId)
+{
+    SDL_Event event{};
+    const uint32_t windowId = recordedEvent.forMainWindow ? mainWindowId : 0;
+
+    switch(recordedEvent.type)
+    {
+    case RecordedInputEventType::KeyDown:
+    case RecordedInputEventType::KeyUp:
+        event.type = (recordedEvent.type == RecordedInputEventType::KeyDown) ? SDL_KEYDOWN : SDL_KEYUP;
+        event.key.windowID = windowId;
+        event.key.state = (recordedEvent.type == RecordedInputEventType::KeyDown) ? SDL_PRESSED : SDL_RELEASED;
+        event.key.repeat = recordedEvent.repeatOrButton;
+        event.key.keysym.sym = recordedEvent.values[0];
+        break;
+    case RecordedInputEventType::MouseButtonDown:
+    case RecordedInputEventType::MouseButtonUp:
+        event.type = (recordedEvent.type == RecordedInputEventType::MouseButtonDown) ? SDL_MOUSEBUTTONDOWN
+                                                                                     : SDL_MOUSEBUTTONUP;
+        event.button.windowID = windowId;
+        event.button.button = recordedEvent.repeatOrButton;
+        event.button.state =
+            (recordedEvent.type == RecordedInputEventType::MouseButtonDown) ? SDL_PRESSED : SDL_RELEASED;
+        event.button.clicks = recordedEvent.clicks;
+        break;
+    case RecordedInputEventType::MouseMotion:
+        event.type = SDL_MOUSEMOTION;
+        event.motion.windowID = windowId;
+        event.motion.x = recordedEvent.values[0];
+        event.motion.y = recordedEvent.values[1];
+        event.motion.xrel = recordedEvent.values[2];
+        event.motion.yrel = recordedEvent.values[3];
+        break;
+    case RecordedInputEventType::MouseWheel:
+        event.type = SDL_MOUSEWHEEL;
+        event.wheel.windowID = windowId;
+        event.wheel.y = recordedEvent.values[0];
+        event.wheel.direction = (uint32_t)recordedEvent.values[1];
+        break;
+    }
+
+    return event;
+}
+
+void InputRecorder::beginFrame(std::chrono::nanoseconds runtime, std::chrono::nanoseconds frameDelta)
+{
+    RecordedInputFrame& frame = mRecording.frames.emplace_back();
+    frame.runtimeNs = runtime.count();
+    frame.frameDeltaNs = frameDelta.count();
+}
+
+void InputRecorder::addEvent(const RecordedInputEvent& event)
+{
+    // Events before the first frame belong to it
+    if(mRecording.frames.empty()) { mRecording.frames.emplace_back(); }
+
+    mRecording.events.push_back(event);
+    ++mRecording.frames.back().eventCount;
+}
+
+InputPlayer::InputPlayer(InputRecording recording, std::chrono::nanoseconds fixedTimestep)
+    : mRecording(std::move(recording))
+    , mFixedTimestep(fixedTimestep)
+{}
+
+std::optional<ReplayedInputFrame> InputPlayer::nextFrame()
+{
+    if(isFinished()) { return std::nullopt; }
+
+    const RecordedInputFrame& frame = mRecording.frames[mNextFrame];
+
+    ReplayedInputFrame replayedFrame;
+    if(mFixedTimestep.count() > 0)
+    {
+        replayedFrame.runtime = mFixedTimestep * (int64_t)(mNextFrame + 1);
+        replayedFrame.frameDelta = mFixedTimestep;
+    }
+    else
+    {
+        replayedFrame.runtime = std::chrono::nanoseconds(frame.runtimeNs);
+        replayedFrame.frameDelta = std::chrono::nanoseconds(frame.frameDeltaNs);
+    }
+    replayedFrame.events = std::span<const RecordedInputEvent>(mRecording.events).subspan(mNextEvent, frame.eventCount);
+
+    ++mNextFrame;
+    mNextEvent += frame.eventCount;
+
+    return replayedFrame;
+}
+} // namespace scrap
@@ -0,0 +1,175 @@
+// Classes:
+//   InputRecorder
+//   InputPlayer
+//
+// InputRecorder:
+//   Records the frame timing and the keyboard and mouse events of every frame while the application runs. The events
+//   are what the Keyboard and Mouse build their state from, so feeding them back rebuilds the same state on the same
+//   frames without storing every key's state every frame.
+//
+// InputPlayer:
+//   Plays a recording back one frame at a time, either with the recorded frame times or with a fixed timestep. With a
+//   fixed timestep the simulation no longer depends on how long the frames took, so two runs of a long flythrough move
+//   the camera through exactly the same frames and can be compared frame for frame.
+//
+// File layout: InputRecordingFileHeader, RecordedInputFrame[frameCount], then RecordedInputEvent[eventCount]. A frame's
+// events follow the events of the frames before it.
+
+#pragma once
+
+#include "StringUtils.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <tl/expected.hpp>
+
+union SDL_Event;
+
+namespace scrap
+{
+enum class RecordedInputEventType : uint8_t
+{
+    KeyDown,
+    KeyUp,
+    MouseButtonDown,
+    MouseButtonUp,
+    MouseMotion,
+    MouseWheel,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+struct RecordedInputEvent
+{
+    RecordedInputEventType type = RecordedInputEventType::KeyDown;
+    // Events for the main window also go to the window's own keyboard and mouse
+    bool forMainWindow = false;
+    // The key's repeat count, or the mouse button
+    uint8_t repeatOrButton = 0;
+    uint8_t clicks = 0;
+    // Key: key code. Motion: x, y, xrel, yrel. Wheel: y, direction.
+    std::array<int32_t, 4> values{};
+};
+
+struct RecordedInputFrame
+{
+    int64_t runtimeNs = 0;
+    int64_t frameDeltaNs = 0;
+    uint32_t eventCount = 0;
+    uint32_t reserved = 0;
+};
+
+struct InputRecording
+{
+    std::vector<RecordedInputFrame> frames;
+    std::vector<RecordedInputEvent> events;
+};
+
+enum class InputRecordingError
+{
+    FileOpenFailed,
+    FileWriteFailed,
+    FileReadFailed,
+    InvalidFile,
+    UnsupportedVersion,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(InputRecordingError error)
+{
+    switch(error)
+    {
+    case InputRecordingError::FileOpenFailed: return "FileOpenFailed";
+    case InputRecordingError::FileWriteFailed: return "FileWriteFailed";
+    case InputRecordingError::FileReadFailed: return "FileReadFailed";
+    case InputRecordingError::InvalidFile: return "InvalidFile";
+    case InputRecordingError::UnsupportedVersion: return "UnsupportedVersion";
+    default: return "Unknown InputRecordingError";
+    }
+}
+
+[[nodiscard]] tl::expected<InputRecording, InputRecordingError>
+LoadInputRecording(const std::filesystem::path& filePath);
+[[nodiscard]] std::optional<InputRecordingError> SaveInputRecording(const std::filesystem::path& filePath,
+                                                                    const InputRecording& recording);
+
+// Returns nullopt for events that aren't keyboard or mouse events
+[[nodiscard]] std::optional<RecordedInputEvent> RecordInputEvent(const SDL_Event& event, uint32_t mainWindowId);
+// The event is addressed to the main window if it was recorded for it, otherwise to no window
+[[nodiscard]] SDL_Event ToSdlEvent(const RecordedInputEvent& event, uint32_t mainWindowId);
+
+struct InputRecordingParams
+{
+    // Records the input of every frame and writes it to the file when the application shuts down
+    std::filesystem::path recordFilePath;
+
+    // Replays the input in the file instead of the live keyboard and mouse input, then quits
+    std::filesystem::path replayFilePath;
+    // 0 replays with the recorded frame times
+    std::chrono::nanoseconds fixedTimestep{0};
+};
+
+class InputRecorder
+{
+public:
+    InputRecorder() = default;
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder(InputRecorder&&) = default;
+    ~InputRecorder() = default;
+
+    InputRecorder& operator=(const InputRecorder&) = delete;
+    InputRecorder& operator=(InputRecorder&&) = default;
+
+    // The events added after this belong to the frame
+    void beginFrame(std::chrono::nanoseconds runtime, std::chrono::nanoseconds frameDelta);
+    void addEvent(const RecordedInputEvent& event);
+
+    [[nodiscard]] const InputRecording& getRecording() const { return mRecording; }
+
+private:
+    InputRecording mRecording;
+};
+
+struct ReplayedInputFrame
+{
+    std::chrono::nanoseconds runtime{0};
+    std::chrono::nanoseconds frameDelta{0};
+    std::span<const RecordedInputEvent> events;
+};
+
+class InputPlayer
+{
+public:
+    InputPlayer(InputRecording recording, std::chrono::nanoseconds fixedTimestep);
+    InputPlayer(const InputPlayer&) = delete;
+    InputPlayer(InputPlayer&&) = default;
+    ~InputPlayer() = default;
+
+    InputPlayer& operator=(const InputPlayer&) = delete;
+    InputPlayer& operator=(InputPlayer&&) = default;
+
+    [[nodiscard]] bool isFinished() const { return mNextFrame >= mRecording.frames.size(); }
+    [[nodiscard]] size_t getFrameCount() const { return mRecording.frames.size(); }
+
+    // The events stay valid for as long as the player. Returns nullopt once every frame has been played.
+    [[nodiscard]] std::optional<ReplayedInputFrame> nextFrame();
+
+private:
+    InputRecording mRecording;
+    std::chrono::nanoseconds mFixedTimestep{0};
+    size_t mNextFrame = 0;
+    size_t mNextEvent = 0;
+};
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::InputRecordingError> : public scrap::ToStringViewFormatter<scrap::InputRecordingError>
+{};
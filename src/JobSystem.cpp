@@ -0,0 +1,325 @@
+#include "JobSystem.h"
+
+#include "CpuProfiler.h"
+
+#include <bit>
+#include <cassert>
+#include <functional>
+
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+Job* JobCounter::decrement()
+{
+    // Only the decrement that can bring the counter to 0 takes the lock. Every other one is done with the counter as
+    // soon as its decrement has landed.
+    uint32_t count = mCount.load(std::memory_order_relaxed);
+    while(count > 1)
+    {
+        if(mCount.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+    }
+
+    std::lock_guard lockGuard(mContinuationMutex);
+
+    if(mCount.fetch_sub(1, std::memory_order_acq_rel) != 1) { return nullptr; }
+
+    Job* continuations = mContinuations;
+    mContinuations = nullptr;
+    return continuations;
+}
+
+bool JobCounter::addContinuation(Job* job)
+{
+    std::lock_guard lockGuard(mContinuationMutex);
+
+    if(mCount.load(std::memory_order_acquire) == 0) { return false; }
+
+    job->nextContinuation = mContinuations;
+    mContinuations = job;
+    return true;
+}
+
+WorkStealingDeque::WorkStealingDeque(size_t capacity)
+    : mJobs(std::make_unique<std::atomic<Job*>[]>(capacity))
+    , mMask((int64_t)capacity - 1)
+{
+    assert(std::has_single_bit(capacity));
+}
+
+bool WorkStealingDeque::push(Job* job)
+{
+    const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+    const int64_t top = mTop.load(std::memory_order_acquire);
+    if(bottom - top > mMask) { return false; }
+
+    mJobs[bottom & mMask].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+Job* WorkStealingDeque::pop()
+{
+    const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if(top > bottom)
+    {
+        // Empty
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = mJobs[bottom & mMask].load(std::memory_order_relaxed);
+    if(top == bottom)
+    {
+        // The last job. A thief might be taking it at the same time.
+        if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+Job* WorkStealingDeque::steal()
+{
+    int64_t top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+    if(top >= bottom) { return nullptr; }
+
+    Job* job = mJobs[top & mMask].load(std::memory_order_relaxed);
+    if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return job;
+}
+
+JobSystem* JobSystem::sInstance = nullptr;
+thread_local JobSystem* JobSystem::tJobSystem = nullptr;
+thread_local uint32_t JobSystem::tWorkerIndex = JobSystem::kExternalThread;
+thread_local uint32_t JobSystem::tRandomState = 0;
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+    assert(sInstance == nullptr);
+    sInstance = this;
+
+    if(threadCount == 0) { threadCount = std::max(std::thread::hardware_concurrency(), 1u); }
+
+    mWorkers.reserve(threadCount);
+    for(uint32_t workerIndex = 0; workerIndex < threadCount; ++workerIndex)
+    {
+        std::unique_ptr<Worker>& worker = mWorkers.emplace_back(std::make_unique<Worker>(kDequeCapacity));
+        worker->jobPool.resize(kJobPoolSize);
+    }
+
+    mExternalJobs.reserve(kJobPoolSize);
+    mExternalJobPool.resize(kJobPoolSize);
+
+    // The creating thread is worker 0
+    tJobSystem = this;
+    tWorkerIndex = 0;
+
+    for(uint32_t workerIndex = 1; workerIndex < threadCount; ++workerIndex)
+    {
+        mWorkers[workerIndex]->thread = std::thread([this, workerIndex]() { runWorker(workerIndex); });
+    }
+
+    spdlog::info("Started job system with {} threads", threadCount);
+}
+
+JobSystem::~JobSystem()
+{
+    mStopping.store(true);
+    mWorkGeneration.fetch_add(1);
+    mWorkGeneration.notify_all();
+
+    for(std::unique_ptr<Worker>& worker : mWorkers)
+    {
+        if(worker->thread.joinable()) { worker->thread.join(); }
+    }
+
+    tJobSystem = nullptr;
+    tWorkerIndex = kExternalThread;
+
+    assert(sInstance != nullptr);
+    sInstance = nullptr;
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+    const uint32_t workerIndex = getCurrentWorkerIndex();
+
+    while(!counter.isDone())
+    {
+        if(Job* job = findJob(workerIndex)) { execute(job); }
+        else { std::this_thread::yield(); }
+    }
+
+    // The job that finished the counter may still be releasing its continuations
+    std::lock_guard lockGuard(counter.mContinuationMutex);
+}
+
+uint32_t JobSystem::getCurrentWorkerIndex() const
+{
+    return (tJobSystem == this) ? tWorkerIndex : kExternalThread;
+}
+
+bool JobSystem::isLocalQueueEmpty() const
+{
+    const uint32_t workerIndex = getCurrentWorkerIndex();
+    if(workerIndex == kExternalThread) { return mExternalJobCount.load(std::memory_order_relaxed) == 0; }
+
+    return mWorkers[workerIndex]->deque.isEmpty();
+}
+
+Job* JobSystem::allocateJob()
+{
+    const uint32_t workerIndex = getCurrentWorkerIndex();
+    if(workerIndex == kExternalThread)
+    {
+        std::lock_guard lockGuard(mExternalMutex);
+        return &mExternalJobPool[mNextExternalJob++ % kJobPoolSize];
+    }
+
+    Worker& worker = *mWorkers[workerIndex];
+    return &worker.jobPool[worker.nextJob++ % kJobPoolSize];
+}
+
+void JobSystem::schedule(Job* job)
+{
+    const uint32_t workerIndex = getCurrentWorkerIndex();
+    if(workerIndex == kExternalThread)
+    {
+        std::lock_guard lockGuard(mExternalMutex);
+        mExternalJobs.push_back(job);
+        mExternalJobCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if(!mWorkers[workerIndex]->deque.push(job))
+    {
+        execute(job);
+        return;
+    }
+
+    mWorkGeneration.fetch_add(1);
+    if(mSleepingCount.load() > 0) { mWorkGeneration.notify_one(); }
+}
+
+void JobSystem::execute(Job* job)
+{
+    {
+        MemoryTagScope memoryTagScope(job->memoryTag);
+        job->invoke(*job);
+    }
+
+    if(job->counter == nullptr) { return; }
+
+    Job* continuation = job->counter->decrement();
+    while(continuation != nullptr)
+    {
+        Job* nextContinuation = continuation->nextContinuation;
+        schedule(continuation);
+        continuation = nextContinuation;
+    }
+}
+
+Job* JobSystem::findJob(uint32_t workerIndex)
+{
+    if(workerIndex != kExternalThread)
+    {
+        if(Job* job = mWorkers[workerIndex]->deque.pop()) { return job; }
+    }
+
+    if(mExternalJobCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard lockGuard(mExternalMutex);
+        if(!mExternalJobs.empty())
+        {
+            Job* job = mExternalJobs.back();
+            mExternalJobs.pop_back();
+            mExternalJobCount.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return stealJob(workerIndex);
+}
+
+Job* JobSystem::stealJob(uint32_t workerIndex)
+{
+    const uint32_t workerCount = getThreadCount();
+
+    if(tRandomState == 0)
+    {
+        tRandomState = (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1u;
+    }
+
+    // xorshift32
+    tRandomState ^= tRandomState << 13;
+    tRandomState ^= tRandomState >> 17;
+    tRandomState ^= tRandomState << 5;
+
+    const uint32_t firstVictim = tRandomState % workerCount;
+    for(uint32_t offset = 0; offset < workerCount; ++offset)
+    {
+        const uint32_t victimIndex = (firstVictim + offset) % workerCount;
+        if(victimIndex == workerIndex) { continue; }
+
+        if(Job* job = mWorkers[victimIndex]->deque.steal()) { return job; }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::runWorker(uint32_t workerIndex)
+{
+    tJobSystem = this;
+    tWorkerIndex = workerIndex;
+
+    SCRAP_CPU_THREAD_NAME(fmt::format("Job worker {}", workerIndex));
+
+    // Jobs tend to come in bursts, so a worker looks around for a while before it goes to sleep
+    constexpr uint32_t kSpinCount = 64;
+
+    while(true)
+    {
+        // Read before looking for jobs. A job scheduled after this changes the generation, so the wait below can't
+        // miss it.
+        const uint32_t generation = mWorkGeneration.load();
+
+        Job* job = nullptr;
+        for(uint32_t spin = 0; spin < kSpinCount && job == nullptr; ++spin)
+        {
+            job = findJob(workerIndex);
+            if(job == nullptr) { std::this_thread::yield(); }
+        }
+
+        if(job != nullptr)
+        {
+            execute(job);
+            continue;
+        }
+
+        if(mStopping.load()) { break; }
+
+        mSleepingCount.fetch_add(1);
+        mWorkGeneration.wait(generation);
+        mSleepingCount.fetch_sub(1);
+    }
+}
+} // namespace scrap
@@ -0,0 +1,325 @@
+// Classes:
+//   JobCounter
+//   WorkStealingDeque
+//   JobSystem
+//
+// JobCounter:
+//   Counts the jobs that are still outstanding. Every job that's run with a counter increments it when it's submitted
+//   and decrements it once it has finished. A counter is done when it's back to 0. Jobs can be made to run once a
+//   counter is done, which is how job graphs are built: each node signals a counter that the nodes after it depend on.
+//
+// WorkStealingDeque:
+//   The Chase-Lev deque from "Dynamic Circular Work-Stealing Deque" (Chase, Lev 2005) with the memory orderings from
+//   "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al. 2013). The owning thread pushes and pops at
+//   the bottom without any atomic read-modify-write unless it's racing for the last job. Any thread can steal from the
+//   top. The capacity is fixed. A push to a full deque fails and the job is run right away instead.
+//
+// JobSystem:
+//   A fixed number of threads that run jobs. The thread that creates the JobSystem is worker 0 and only runs jobs while
+//   it's waiting on a counter. The other workers run jobs until the JobSystem is destroyed. Every worker pushes the
+//   jobs it spawns onto its own deque and pops them back off in LIFO order, which keeps a job's children on the cache
+//   that just touched their data. Workers that run out of jobs steal the oldest job from a random other worker, and
+//   sleep once there's nothing left to steal. Threads that aren't workers, like the render thread, submit their jobs to
+//   a shared queue that the workers check before stealing.
+//
+//   A job runs under the memory tag that was current on the thread that created it, so allocations made by jobs are
+//   attributed the same as if the creating thread had made them itself. Tags set inside a job end with the job.
+//
+//   Jobs are stored inline in fixed size slots. Capturing more than kJobDataSize bytes doesn't compile, so large state
+//   has to be captured by pointer. Slots come from a per worker ring of kJobPoolSize jobs and are reused without
+//   checking, so a worker can't have more than kJobPoolSize jobs in flight at once.
+//
+//   Waiting never blocks while there's work. wait() keeps running jobs, from its own deque first, until the counter is
+//   done, so a job can wait on the jobs it spawned without tying up its worker.
+//
+//   parallelFor uses lazy binary splitting ("Lazy Binary-Splitting: A Run-Time Adaptive Work-Stealing Scheduler",
+//   Tzannes et al. 2010). A range is only split in half when the worker's deque is empty, which means the other workers
+//   have stolen everything it had. Otherwise it works through its range one grain at a time. The split depth adapts to
+//   how busy the other workers are, so the grain size only has to be large enough to hide the cost of a job.
+
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace scrap
+{
+class JobCounter;
+
+struct alignas(64) Job
+{
+    static constexpr size_t kDataSize = 32;
+
+    // Runs the stored function and destroys it
+    void (*invoke)(Job& job) = nullptr;
+    JobCounter* counter = nullptr;
+    // Next job waiting on the same counter
+    Job* nextContinuation = nullptr;
+    // The creating thread's current tag
+    MemoryTag memoryTag = MemoryTag::Untagged;
+    alignas(16) std::array<std::byte, kDataSize> data;
+};
+
+static_assert(sizeof(Job) == 64);
+
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) = delete;
+    ~JobCounter() = default;
+
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter& operator=(JobCounter&&) = delete;
+
+    [[nodiscard]] bool isDone() const { return mCount.load(std::memory_order_acquire) == 0; }
+    [[nodiscard]] uint32_t getCount() const { return mCount.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+
+    void add(uint32_t count) { mCount.fetch_add(count, std::memory_order_relaxed); }
+
+    // Returns the jobs waiting on the counter when it reaches 0
+    [[nodiscard]] Job* decrement();
+
+    // Returns false if the counter is already done, in which case the job has to be scheduled by the caller
+    [[nodiscard]] bool addContinuation(Job* job);
+
+    std::atomic<uint32_t> mCount{0};
+    // A job that brings the counter to 0 still holds the mutex while it releases the continuations. JobSystem::wait
+    // locks it once before returning, so a counter can be destroyed as soon as wait returns for it.
+    mutable std::mutex mContinuationMutex;
+    Job* mContinuations = nullptr;
+};
+
+class WorkStealingDeque
+{
+public:
+    // capacity has to be a power of two
+    explicit WorkStealingDeque(size_t capacity);
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    ~WorkStealingDeque() = default;
+
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    // Owner only. Returns false if the deque is full.
+    [[nodiscard]] bool push(Job* job);
+
+    // Owner only. Returns the most recently pushed job.
+    [[nodiscard]] Job* pop();
+
+    // Any thread. Returns the oldest job, or nullptr if the deque is empty or another thread took the job first.
+    [[nodiscard]] Job* steal();
+
+    // Only a hint when read by a thread other than the owner
+    [[nodiscard]] bool isEmpty() const
+    {
+        return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<std::atomic<Job*>[]> mJobs;
+    int64_t mMask;
+
+    // Kept on separate cache lines. Thieves only write the top and the owner mostly writes the bottom.
+    alignas(64) std::atomic<int64_t> mTop{0};
+    alignas(64) std::atomic<int64_t> mBottom{0};
+};
+
+class JobSystem
+{
+private:
+    static JobSystem* sInstance;
+
+public:
+    static constexpr size_t kJobDataSize = Job::kDataSize;
+    static constexpr size_t kJobPoolSize = 4096;
+    static constexpr size_t kDequeCapacity = 4096;
+
+    static JobSystem& instance() { return *sInstance; }
+
+    // A thread count of 0 uses one thread per hardware thread. The count includes the calling thread.
+    explicit JobSystem(uint32_t threadCount = 0);
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    ~JobSystem();
+
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    // The worker index of threads that aren't part of the JobSystem
+    static constexpr uint32_t kExternalThread = ~0u;
+
+    [[nodiscard]] uint32_t getThreadCount() const { return (uint32_t)mWorkers.size(); }
+
+    // The calling thread's worker index, or kExternalThread
+    [[nodiscard]] uint32_t getCurrentWorkerIndex() const;
+
+    // Runs function on any worker. counter is incremented now and decremented once function returns.
+    template<class FunctionT>
+    void run(FunctionT&& function, JobCounter* counter = nullptr)
+    {
+        if(counter != nullptr) { counter->add(1); }
+        schedule(createJob(std::forward<FunctionT>(function), counter));
+    }
+
+    // Runs function once dependency is done. counter is incremented now, so waiting on it includes the time the job
+    // spends waiting for its dependency.
+    template<class FunctionT>
+    void runAfter(JobCounter& dependency, FunctionT&& function, JobCounter* counter = nullptr)
+    {
+        if(counter != nullptr) { counter->add(1); }
+
+        Job* job = createJob(std::forward<FunctionT>(function), counter);
+        if(!dependency.addContinuation(job)) { schedule(job); }
+    }
+
+    // Runs jobs until the counter is done
+    void wait(const JobCounter& counter);
+
+    // Calls function(first, last) for subranges that together cover [begin, end) and returns once every call has
+    // returned. A grain size of 0 picks one based on the thread count.
+    template<class FunctionT>
+    void parallelFor(size_t begin, size_t end, FunctionT&& function, size_t grainSize = 0);
+
+private:
+    struct alignas(64) Worker
+    {
+        explicit Worker(size_t dequeCapacity)
+            : deque(dequeCapacity)
+        {}
+
+        WorkStealingDeque deque;
+        std::vector<Job> jobPool;
+        size_t nextJob = 0;
+        std::thread thread;
+    };
+
+    template<class FunctionT>
+    struct ParallelForState
+    {
+        JobSystem* jobSystem;
+        FunctionT* function;
+        JobCounter* counter;
+        size_t grainSize;
+    };
+
+    thread_local static JobSystem* tJobSystem;
+    thread_local static uint32_t tWorkerIndex;
+    // Picks the first victim to steal from
+    thread_local static uint32_t tRandomState;
+
+    template<class FunctionT>
+    Job* createJob(FunctionT&& function, JobCounter* counter)
+    {
+        using StoredT = std::decay_t<FunctionT>;
+        static_assert(sizeof(StoredT) <= kJobDataSize, "Capture large job state by pointer");
+        static_assert(alignof(StoredT) <= alignof(std::max_align_t));
+
+        Job* job = allocateJob();
+        job->counter = counter;
+        job->nextContinuation = nullptr;
+        job->memoryTag = MemoryTracker::getCurrentTag();
+        new(job->data.data()) StoredT(std::forward<FunctionT>(function));
+        job->invoke = [](Job& job) {
+            StoredT& storedFunction = *std::launder(reinterpret_cast<StoredT*>(job.data.data()));
+            storedFunction();
+            storedFunction.~StoredT();
+        };
+
+        return job;
+    }
+
+    template<class FunctionT>
+    static void RunParallelForRange(const ParallelForState<FunctionT>& state, size_t first, size_t last);
+
+    [[nodiscard]] bool isLocalQueueEmpty() const;
+
+    [[nodiscard]] Job* allocateJob();
+    void schedule(Job* job);
+    void execute(Job* job);
+    [[nodiscard]] Job* findJob(uint32_t workerIndex);
+    [[nodiscard]] Job* stealJob(uint32_t workerIndex);
+    void runWorker(uint32_t workerIndex);
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    // Jobs submitted by threads that aren't workers
+    std::mutex mExternalMutex;
+    std::vector<Job*> mExternalJobs;
+    std::atomic<size_t> mExternalJobCount{0};
+    std::vector<Job> mExternalJobPool;
+    size_t mNextExternalJob = 0;
+
+    // Bumped whenever a job is scheduled. Sleeping workers wait for it to change.
+    std::atomic<uint32_t> mWorkGeneration{0};
+    std::atomic<uint32_t> mSleepingCount{0};
+    std::atomic<bool> mStopping{false};
+};
+
+template<class FunctionT>
+void JobSystem::parallelFor(size_t begin, size_t end, FunctionT&& function, size_t grainSize)
+{
+    if(begin >= end) { return; }
+
+    // Enough grains that every thread can steal a few times, without making a grain so small that the cost of
+    // checking the deque shows up
+    constexpr size_t kGrainsPerThread = 16;
+    if(grainSize == 0) { grainSize = std::max<size_t>((end - begin) / (getThreadCount() * kGrainsPerThread), 1); }
+
+    if(end - begin <= grainSize)
+    {
+        function(begin, end);
+        return;
+    }
+
+    using StoredT = std::remove_reference_t<FunctionT>;
+    JobCounter counter;
+    const ParallelForState<StoredT> state{this, &function, &counter, grainSize};
+
+    RunParallelForRange(state, begin, end);
+    wait(counter);
+}
+
+template<class FunctionT>
+void JobSystem::RunParallelForRange(const ParallelForState<FunctionT>& state, size_t first, size_t last)
+{
+    while(last - first > state.grainSize)
+    {
+        if(state.jobSystem->isLocalQueueEmpty())
+        {
+            const size_t middle = first + (last - first) / 2;
+
+            // state lives on the stack of the parallelFor call, which doesn't return until this job has finished
+            const ParallelForState<FunctionT>* statePointer = &state;
+            state.jobSystem->run([statePointer, middle, last]() { RunParallelForRange(*statePointer, middle, last); },
+                                 state.counter);
+
+            last = middle;
+        }
+        else
+        {
+            (*state.function)(first, first + state.grainSize);
+            first += state.grainSize;
+        }
+    }
+
+    (*state.function)(first, last);
+}
+} // namespace scrap
@@ -0,0 +1,197 @@
+#include "JobSystemBenchmark.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint32_t kSpawnBatchSize = 1024;
+constexpr uint32_t kSpawnBatchCount = 256;
+constexpr uint32_t kStealSampleCount = 10000;
+constexpr size_t kTransformCount = 4 * 1024 * 1024;
+constexpr uint32_t kTransformIterationCount = 20;
+
+JobLatencyReport CalculateLatencyReport(std::vector<std::chrono::nanoseconds>& samples)
+{
+    JobLatencyReport report;
+    if(samples.empty()) { return report; }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::chrono::nanoseconds total{0};
+    for(std::chrono::nanoseconds sample : samples)
+    {
+        total += sample;
+    }
+
+    report.sampleCount = (uint32_t)samples.size();
+    report.mean = total / (int64_t)samples.size();
+    report.p50 = samples[(samples.size() - 1) / 2];
+    report.p99 = samples[((samples.size() - 1) * 99) / 100];
+    report.max = samples.back();
+
+    return report;
+}
+
+void BenchmarkSpawn(JobSystemBenchmarkReport& report)
+{
+    JobSystem jobSystem(1);
+
+    std::atomic<uint32_t> executedCount{0};
+    std::chrono::nanoseconds spawnTime{0};
+    std::chrono::nanoseconds totalTime{0};
+
+    for(uint32_t batch = 0; batch < kSpawnBatchCount; ++batch)
+    {
+        JobCounter counter;
+
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t jobIndex = 0; jobIndex < kSpawnBatchSize; ++jobIndex)
+        {
+            jobSystem.run([&executedCount]() { executedCount.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        const auto spawned = std::chrono::steady_clock::now();
+        jobSystem.wait(counter);
+        const auto finished = std::chrono::steady_clock::now();
+
+        spawnTime += spawned - start;
+        totalTime += finished - start;
+    }
+
+    const int64_t jobCount = (int64_t)kSpawnBatchSize * kSpawnBatchCount;
+    report.spawnTime = spawnTime / jobCount;
+    report.spawnAndRunTime = totalTime / jobCount;
+
+    if((int64_t)executedCount.load() != jobCount)
+    {
+        spdlog::error("Spawn benchmark ran {} of {} jobs", executedCount.load(), jobCount);
+    }
+}
+
+void BenchmarkSteal(JobSystemBenchmarkReport& report)
+{
+    JobSystem jobSystem(2);
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    latencies.reserve(kStealSampleCount);
+
+    for(uint32_t sample = 0; sample < kStealSampleCount; ++sample)
+    {
+        JobCounter counter;
+        std::chrono::steady_clock::time_point startTime;
+
+        const auto spawnTime = std::chrono::steady_clock::now();
+        jobSystem.run([&startTime]() { startTime = std::chrono::steady_clock::now(); }, &counter);
+
+        // Not JobSystem::wait, which would pop the job off this thread's own deque
+        while(!counter.isDone())
+        {
+            std::this_thread::yield();
+        }
+
+        latencies.push_back(startTime - spawnTime);
+    }
+
+    report.stealLatency = CalculateLatencyReport(latencies);
+}
+
+void BenchmarkScaling(JobSystemBenchmarkReport& report, uint32_t maxThreadCount)
+{
+    std::vector<glm::vec4> positions(kTransformCount);
+    std::vector<glm::vec4> transformedPositions(kTransformCount);
+
+    for(size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i] = glm::vec4((float)(i % 1024), (float)((i / 1024) % 1024), (float)(i / (1024 * 1024)), 1.0f);
+    }
+
+    const glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)), 0.5f,
+                                            glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)));
+
+    auto transformRange = [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i)
+        {
+            transformedPositions[i] = transform * positions[i];
+        }
+    };
+
+    report.transformCount = kTransformCount;
+
+    for(uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        JobSystem jobSystem(threadCount);
+
+        // Warms up the caches and wakes up the workers
+        jobSystem.parallelFor(0, positions.size(), transformRange);
+
+        ParallelForScalingSample sample;
+        sample.threadCount = threadCount;
+        sample.bestTime = std::chrono::nanoseconds::max();
+
+        std::chrono::nanoseconds totalTime{0};
+        for(uint32_t iteration = 0; iteration < kTransformIterationCount; ++iteration)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            jobSystem.parallelFor(0, positions.size(), transformRange);
+            const std::chrono::nanoseconds time = std::chrono::steady_clock::now() - start;
+
+            totalTime += time;
+            sample.bestTime = std::min(sample.bestTime, time);
+        }
+
+        sample.meanTime = totalTime / kTransformIterationCount;
+        report.scaling.push_back(sample);
+    }
+}
+} // namespace
+
+JobSystemBenchmarkReport RunJobSystemBenchmarks(uint32_t maxThreadCount)
+{
+    JobSystemBenchmarkReport report;
+
+    BenchmarkSpawn(report);
+    BenchmarkSteal(report);
+    BenchmarkScaling(report, std::max(maxThreadCount, 1u));
+
+    return report;
+}
+
+void LogJobSystemBenchmarkReport(const JobSystemBenchmarkReport& report)
+{
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    spdlog::info("Job system benchmarks on {} hardware threads", std::thread::hardware_concurrency());
+    spdlog::info("    Spawn:              {} ns per job", report.spawnTime.count());
+    spdlog::info("    Spawn and run:      {} ns per job", report.spawnAndRunTime.count());
+    spdlog::info("    Steal latency:      mean {:.3f} us, p50 {:.3f} us, p99 {:.3f} us, max {:.3f} us ({} samples)",
+                 Microseconds(report.stealLatency.mean).count(), Microseconds(report.stealLatency.p50).count(),
+                 Microseconds(report.stealLatency.p99).count(), Microseconds(report.stealLatency.max).count(),
+                 report.stealLatency.sampleCount);
+
+    spdlog::info("    parallelFor transform of {} positions", report.transformCount);
+
+    const std::chrono::nanoseconds singleThreadTime =
+        report.scaling.empty() ? std::chrono::nanoseconds(0) : report.scaling.front().bestTime;
+
+    for(const ParallelForScalingSample& sample : report.scaling)
+    {
+        const double speedup = (sample.bestTime.count() > 0)
+                                   ? (double)singleThreadTime.count() / (double)sample.bestTime.count()
+                                   : 0.0;
+
+        spdlog::info("        {:>2} threads: best {:.3f} ms, mean {:.3f} ms, {:.2f}x", sample.threadCount,
+                     Milliseconds(sample.bestTime).count(), Milliseconds(sample.meanTime).count(), speedup);
+    }
+}
+} // namespace scrap
@@ -0,0 +1,53 @@
+// Microbenchmarks for the JobSystem. Each one creates its own JobSystem, so they have to run before the Application
+// creates the one the engine uses.
+//
+// Spawn: one thread spawns and runs batches of empty jobs. Measures the cost of run() and of popping and executing a
+// job without any other thread involved.
+//
+// Steal: two threads. Worker 0 spawns a job and waits for it without running anything, so the job can only run after
+// worker 1 steals it. Measures from the spawn to the job starting. A worker that ran out of jobs spins for a while
+// before it sleeps, and steals that come after it fell asleep include the time it takes to wake up.
+//
+// Scaling: transforms a large array of positions by a matrix with parallelFor at thread counts from 1 up to the
+// maximum, doubling each time. Thread counts above the number of hardware threads oversubscribe the cpu.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace scrap
+{
+struct JobLatencyReport
+{
+    uint32_t sampleCount = 0;
+    std::chrono::nanoseconds mean{0};
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+};
+
+struct ParallelForScalingSample
+{
+    uint32_t threadCount = 0;
+    std::chrono::nanoseconds bestTime{0};
+    std::chrono::nanoseconds meanTime{0};
+};
+
+struct JobSystemBenchmarkReport
+{
+    // Per job, averaged over every spawned job
+    std::chrono::nanoseconds spawnTime{0};
+    std::chrono::nanoseconds spawnAndRunTime{0};
+
+    JobLatencyReport stealLatency;
+
+    size_t transformCount = 0;
+    std::vector<ParallelForScalingSample> scaling;
+};
+
+[[nodiscard]] JobSystemBenchmarkReport RunJobSystemBenchmarks(uint32_t maxThreadCount);
+
+void LogJobSystemBenchmarkReport(const JobSystemBenchmarkReport& report);
+} // namespace scrap
@@ -0,0 +1,263 @@
+#include "JobSystem.h"
+#include "UnitTest.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+// Counts how often each of a fixed set of jobs was taken out of a deque
+class JobTakeCounts
+{
+public:
+    explicit JobTakeCounts(size_t jobCount)
+        : mJobs(jobCount)
+        , mTakeCounts(std::make_unique<std::atomic<uint32_t>[]>(jobCount))
+    {}
+
+    [[nodiscard]] Job* getJob(size_t index) { return &mJobs[index]; }
+    [[nodiscard]] size_t getJobCount() const { return mJobs.size(); }
+
+    void take(Job* job) { mTakeCounts[(size_t)(job - mJobs.data())].fetch_add(1, std::memory_order_relaxed); }
+
+    [[nodiscard]] bool wasEachTakenOnce() const
+    {
+        for(size_t i = 0; i < mJobs.size(); ++i)
+        {
+            if(mTakeCounts[i].load() != 1) { return false; }
+        }
+
+        return true;
+    }
+
+private:
+    std::vector<Job> mJobs;
+    std::unique_ptr<std::atomic<uint32_t>[]> mTakeCounts;
+};
+} // namespace
+
+SCRAP_TEST(WorkStealingDeque, OwnerPopsInLifoOrder)
+{
+    std::array<Job, 4> jobs;
+    WorkStealingDeque deque(8);
+    SCRAP_CHECK(deque.isEmpty());
+
+    for(Job& job : jobs)
+    {
+        SCRAP_CHECK(deque.push(&job));
+    }
+
+    SCRAP_CHECK(deque.pop() == &jobs[3]);
+    SCRAP_CHECK(deque.pop() == &jobs[2]);
+
+    // Thieves take from the other end
+    SCRAP_CHECK(deque.steal() == &jobs[0]);
+
+    SCRAP_CHECK(deque.pop() == &jobs[1]);
+    SCRAP_CHECK(deque.isEmpty());
+    SCRAP_CHECK(deque.pop() == nullptr);
+    SCRAP_CHECK(deque.steal() == nullptr);
+}
+
+SCRAP_TEST(WorkStealingDeque, RejectsPushWhenFull)
+{
+    std::array<Job, 5> jobs;
+    WorkStealingDeque deque(4);
+
+    for(size_t i = 0; i < 4; ++i)
+    {
+        SCRAP_CHECK(deque.push(&jobs[i]));
+    }
+
+    SCRAP_CHECK(!deque.push(&jobs[4]));
+
+    // A steal frees the slot at the top, which the next push wraps around into
+    SCRAP_CHECK(deque.steal() == &jobs[0]);
+    SCRAP_CHECK(deque.push(&jobs[4]));
+    SCRAP_CHECK(!deque.push(&jobs[0]));
+
+    SCRAP_CHECK(deque.pop() == &jobs[4]);
+    SCRAP_CHECK(deque.pop() == &jobs[3]);
+    SCRAP_CHECK(deque.steal() == &jobs[1]);
+    SCRAP_CHECK(deque.pop() == &jobs[2]);
+    SCRAP_CHECK(deque.pop() == nullptr);
+}
+
+SCRAP_TEST(WorkStealingDeque, ConcurrentStealsTakeEveryJobOnce)
+{
+    constexpr size_t kJobCount = 200000;
+    constexpr uint32_t kThiefCount = 3;
+
+    JobTakeCounts takeCounts(kJobCount);
+    // Small enough that the owner keeps running into a full deque and racing the thieves for the last job
+    WorkStealingDeque deque(64);
+    std::atomic<bool> ownerDone{false};
+
+    std::vector<std::thread> thieves;
+    for(uint32_t thiefIndex = 0; thiefIndex < kThiefCount; ++thiefIndex)
+    {
+        thieves.emplace_back([&]() {
+            while(!ownerDone.load() || !deque.isEmpty())
+            {
+                if(Job* job = deque.steal()) { takeCounts.take(job); }
+            }
+        });
+    }
+
+    for(size_t i = 0; i < kJobCount; ++i)
+    {
+        while(!deque.push(takeCounts.getJob(i)))
+        {
+            if(Job* job = deque.pop()) { takeCounts.take(job); }
+        }
+
+        if(i % 3 == 0)
+        {
+            if(Job* job = deque.pop()) { takeCounts.take(job); }
+        }
+    }
+
+    while(!deque.isEmpty())
+    {
+        if(Job* job = deque.pop()) { takeCounts.take(job); }
+    }
+
+    ownerDone.store(true);
+    for(std::thread& thief : thieves)
+    {
+        thief.join();
+    }
+
+    SCRAP_CHECK(takeCounts.wasEachTakenOnce());
+}
+
+SCRAP_TEST(JobSystem, RunAfterRunsContinuationsOnce)
+{
+    constexpr uint32_t kRoundCount = 200;
+    constexpr uint32_t kDependencyJobCount = 8;
+    constexpr uint32_t kContinuationCount = 16;
+
+    JobSystem jobSystem(4);
+
+    for(uint32_t round = 0; round < kRoundCount; ++round)
+    {
+        std::array<std::atomic<uint32_t>, kContinuationCount> runCounts{};
+        std::atomic<uint32_t> dependencyRunCount{0};
+        JobCounter dependency;
+        JobCounter continuationsDone;
+
+        for(uint32_t i = 0; i < kDependencyJobCount; ++i)
+        {
+            jobSystem.run([&dependencyRunCount]() { dependencyRunCount.fetch_add(1); }, &dependency);
+        }
+
+        // The dependency's jobs finish on other workers while these are added, so some continuations are added to
+        // the counter and some are scheduled right away because it's already done
+        for(uint32_t i = 0; i < kContinuationCount; ++i)
+        {
+            std::atomic<uint32_t>* runCount = &runCounts[i];
+            std::atomic<uint32_t>* dependencyRunCountPointer = &dependencyRunCount;
+            jobSystem.runAfter(
+                dependency,
+                [runCount, dependencyRunCountPointer]() {
+                    // Continuations only start once every job of the dependency has finished
+                    if(dependencyRunCountPointer->load() == kDependencyJobCount) { runCount->fetch_add(1); }
+                },
+                &continuationsDone);
+        }
+
+        jobSystem.wait(continuationsDone);
+        jobSystem.wait(dependency);
+
+        SCRAP_CHECK(dependencyRunCount.load() == kDependencyJobCount);
+        for(const std::atomic<uint32_t>& runCount : runCounts)
+        {
+            SCRAP_CHECK(runCount.load() == 1);
+        }
+    }
+}
+
+SCRAP_TEST(JobSystem, RunAfterChainsThroughWorkers)
+{
+    constexpr uint32_t kChainLength = 64;
+
+    JobSystem jobSystem(4);
+
+    // Each link waits on the counter of the link before it, so the links have to run in order
+    std::array<JobCounter, kChainLength> links;
+    std::atomic<uint32_t> nextLink{0};
+    std::atomic<uint32_t> outOfOrderCount{0};
+
+    for(uint32_t link = 0; link < kChainLength; ++link)
+    {
+        std::atomic<uint32_t>* nextLinkPointer = &nextLink;
+        std::atomic<uint32_t>* outOfOrderCountPointer = &outOfOrderCount;
+        auto function = [nextLinkPointer, outOfOrderCountPointer, link]() {
+            if(nextLinkPointer->fetch_add(1) != link) { outOfOrderCountPointer->fetch_add(1); }
+        };
+
+        if(link == 0) { jobSystem.run(function, &links[link]); }
+        else { jobSystem.runAfter(links[link - 1], function, &links[link]); }
+    }
+
+    jobSystem.wait(links.back());
+
+    SCRAP_CHECK(nextLink.load() == kChainLength);
+    SCRAP_CHECK(outOfOrderCount.load() == 0);
+}
+
+SCRAP_TEST(JobSystem, ParallelForCoversRangeOnce)
+{
+    constexpr size_t kBegin = 3;
+    constexpr size_t kEnd = 10007;
+    constexpr std::array<size_t, 6> kGrainSizes{0, 1, 7, 64, 1000, 20000};
+
+    JobSystem jobSystem(4);
+    const std::unique_ptr<std::atomic<uint32_t>[]> callCounts = std::make_unique<std::atomic<uint32_t>[]>(kEnd + 8);
+
+    for(size_t grainSize : kGrainSizes)
+    {
+        for(size_t i = 0; i < kEnd + 8; ++i)
+        {
+            callCounts[i].store(0);
+        }
+
+        std::atomic<uint32_t> emptyRangeCount{0};
+        std::atomic<uint32_t> oversizedRangeCount{0};
+
+        jobSystem.parallelFor(
+            kBegin, kEnd,
+            [&](size_t first, size_t last) {
+                if(first >= last) { emptyRangeCount.fetch_add(1); }
+                // Only the explicit grain sizes bound the range size
+                if(grainSize != 0 && last - first > grainSize) { oversizedRangeCount.fetch_add(1); }
+
+                for(size_t i = first; i < last; ++i)
+                {
+                    callCounts[i].fetch_add(1);
+                }
+            },
+            grainSize);
+
+        uint32_t wrongCount = 0;
+        for(size_t i = 0; i < kEnd + 8; ++i)
+        {
+            const uint32_t expected = (i >= kBegin && i < kEnd) ? 1 : 0;
+            if(callCounts[i].load() != expected) { ++wrongCount; }
+        }
+
+        SCRAP_CHECK(wrongCount == 0);
+        SCRAP_CHECK(emptyRangeCount.load() == 0);
+        SCRAP_CHECK(oversizedRangeCount.load() == 0);
+    }
+
+    bool calledForEmptyRange = false;
+    jobSystem.parallelFor(5, 5, [&](size_t, size_t) { calledForEmptyRange = true; });
+    SCRAP_CHECK(!calledForEmptyRange);
+}
+} // namespace scrap
@@ -1,7 +1,8 @@
 #include "Keyboard.h"
 
+#include "AsyncLog.h"
+
 #include <SDL2/SDL_events.h>
-#include <spdlog/spdlog.h>
 
 namespace scrap
 {
@@ -21,8 +22,8 @@ void Keyboard::handleEvent(const SDL_KeyboardEvent& keyboardEvent)
     switch(keyboardEvent.type)
     {
     case SDL_KEYDOWN:
-        spdlog::debug("Event SDL_KEYDOWN: key={}, state={}, repeat={}", keyboardEvent.keysym.sym, keyboardEvent.state,
-                      keyboardEvent.repeat);
+        SCRAP_LOG_DEBUG("Event SDL_KEYDOWN: key={}, state={}, repeat={}", keyboardEvent.keysym.sym, keyboardEvent.state,
+                        keyboardEvent.repeat);
         keyState = &mKeyStates[keyboardEvent.keysym.sym];
         keyState->keyCode = keyboardEvent.keysym.sym;
         ++keyState->pressedCount;
@@ -30,8 +31,8 @@ void Keyboard::handleEvent(const SDL_KeyboardEvent& keyboardEvent)
         keyState->repeat |= keyboardEvent.repeat > 0;
         break;
     case SDL_KEYUP:
-        spdlog::debug("Event SDL_KEYUP: key={}, state={}, repeat={}", keyboardEvent.keysym.sym, keyboardEvent.state,
-                      keyboardEvent.repeat);
+        SCRAP_LOG_DEBUG("Event SDL_KEYUP: key={}, state={}, repeat={}", keyboardEvent.keysym.sym, keyboardEvent.state,
+                        keyboardEvent.repeat);
         keyState = &mKeyStates[keyboardEvent.keysym.sym];
         keyState->keyCode = keyboardEvent.keysym.sym;
         ++keyState->releasedCount;
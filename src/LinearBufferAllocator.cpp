@@ -0,0 +1,39 @@
+#include "LinearBufferAllocator.h"
+
+namespace scrap
+{
+size_t LinearBufferAllocator::addBuffer(size_t byteSize)
+{
+    mBuffers.push_back(Buffer{.byteSize = byteSize, .byteOffset = 0});
+    return mBuffers.size() - 1;
+}
+
+std::optional<size_t> LinearBufferAllocator::findBuffer(size_t byteSize, size_t firstBufferIndex) const
+{
+    for(size_t i = firstBufferIndex; i < mBuffers.size(); ++i)
+    {
+        const Buffer& buffer = mBuffers[i];
+        if(buffer.byteSize - buffer.byteOffset >= byteSize) { return i; }
+    }
+
+    return std::nullopt;
+}
+
+size_t LinearBufferAllocator::allocate(size_t bufferIndex, size_t byteSize)
+{
+    Buffer& buffer = mBuffers[bufferIndex];
+
+    const size_t byteOffset = buffer.byteOffset;
+    buffer.byteOffset += byteSize;
+
+    return byteOffset;
+}
+
+void LinearBufferAllocator::reset()
+{
+    for(Buffer& buffer : mBuffers)
+    {
+        buffer.byteOffset = 0;
+    }
+}
+} // namespace scrap
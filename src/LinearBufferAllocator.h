@@ -0,0 +1,51 @@
+// Classes:
+//   LinearBufferAllocator
+//
+// LinearBufferAllocator:
+//   Hands out byte ranges of a list of fixed size buffers by bumping an offset in each buffer. Nothing is freed on its
+//   own, reset starts every buffer over at offset 0. Only tracks the offsets, the buffers themselves belong to the
+//   owner, which is what lets the UploadBufferPool's allocation logic run without a d3d12 device. Not thread safe.
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+namespace scrap
+{
+class LinearBufferAllocator
+{
+public:
+    LinearBufferAllocator() = default;
+    LinearBufferAllocator(const LinearBufferAllocator&) = delete;
+    LinearBufferAllocator(LinearBufferAllocator&&) noexcept = default;
+    ~LinearBufferAllocator() = default;
+
+    LinearBufferAllocator& operator=(const LinearBufferAllocator&) = delete;
+    LinearBufferAllocator& operator=(LinearBufferAllocator&&) noexcept = default;
+
+    // Returns the index of the new buffer
+    size_t addBuffer(size_t byteSize);
+
+    // The first buffer, starting at firstBufferIndex, that has byteSize bytes left
+    [[nodiscard]] std::optional<size_t> findBuffer(size_t byteSize, size_t firstBufferIndex = 0) const;
+
+    // Returns the byte offset of the range. The buffer has to have byteSize bytes left.
+    size_t allocate(size_t bufferIndex, size_t byteSize);
+
+    void reset();
+
+    [[nodiscard]] size_t getBufferCount() const { return mBuffers.size(); }
+    [[nodiscard]] size_t getByteSize(size_t bufferIndex) const { return mBuffers[bufferIndex].byteSize; }
+    [[nodiscard]] size_t getByteOffset(size_t bufferIndex) const { return mBuffers[bufferIndex].byteOffset; }
+
+private:
+    struct Buffer
+    {
+        size_t byteSize = 0;
+        size_t byteOffset = 0;
+    };
+
+    std::vector<Buffer> mBuffers;
+};
+} // namespace scrap
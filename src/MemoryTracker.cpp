@@ -0,0 +1,176 @@
+#include "MemoryTracker.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+struct AllocationHeader
+{
+    uint64_t byteSize;
+    // From the start of the malloc'ed block to the pointer handed out
+    uint32_t baseOffset;
+    MemoryTag tag;
+};
+static_assert(sizeof(AllocationHeader) <= MemoryTracker::kHeaderByteSize);
+
+// What malloc aligns to, and what operator new has to align to without an explicit alignment
+constexpr size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+static_assert(MemoryTracker::kHeaderByteSize % kDefaultAlignment == 0);
+
+void UpdateMaximum(std::atomic<int64_t>& maximum, int64_t value)
+{
+    int64_t current = maximum.load(std::memory_order_relaxed);
+    while(value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+double ToKibibytes(int64_t byteSize)
+{
+    return (double)byteSize / 1024.0;
+}
+} // namespace
+
+std::array<MemoryTracker::TagCounters, ToUnderlying(MemoryTag::Count)> MemoryTracker::sTagCounters;
+thread_local MemoryTag MemoryTracker::tCurrentTag = MemoryTag::Untagged;
+
+void* MemoryTracker::allocate(size_t byteSize, size_t alignment, size_t alignmentOffset) noexcept
+{
+    std::byte* base = nullptr;
+    std::byte* pointer = nullptr;
+
+    if(alignment <= kDefaultAlignment && alignmentOffset == 0)
+    {
+        if(byteSize > std::numeric_limits<size_t>::max() - kHeaderByteSize) { return nullptr; }
+
+        base = static_cast<std::byte*>(std::malloc(kHeaderByteSize + byteSize));
+        if(base == nullptr) { return nullptr; }
+
+        pointer = base + kHeaderByteSize;
+    }
+    else
+    {
+        // Worst case the alignment wastes alignment - 1 bytes after the header
+        const size_t paddingByteSize = kHeaderByteSize + alignmentOffset + alignment - 1;
+        if(byteSize > std::numeric_limits<size_t>::max() - paddingByteSize) { return nullptr; }
+
+        base = static_cast<std::byte*>(std::malloc(paddingByteSize + byteSize));
+        if(base == nullptr) { return nullptr; }
+
+        const uintptr_t alignedAddress =
+            ((uintptr_t)(base + kHeaderByteSize + alignmentOffset) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        pointer = reinterpret_cast<std::byte*>(alignedAddress - alignmentOffset);
+    }
+
+    const MemoryTag tag = tCurrentTag;
+
+    // With an alignment offset the header might not be aligned
+    const AllocationHeader header{.byteSize = byteSize, .baseOffset = (uint32_t)(pointer - base), .tag = tag};
+    std::memcpy(pointer - kHeaderByteSize, &header, sizeof(header));
+
+    TagCounters& counters = sTagCounters[ToUnderlying(tag)];
+    counters.allocationCount.fetch_add(1, std::memory_order_relaxed);
+    counters.allocatedBytes.fetch_add(byteSize, std::memory_order_relaxed);
+
+    const int64_t liveBytes = counters.liveBytes.fetch_add((int64_t)byteSize, std::memory_order_relaxed) +
+                              (int64_t)byteSize;
+    UpdateMaximum(counters.peakBytes, liveBytes);
+    UpdateMaximum(counters.periodPeakBytes, liveBytes);
+
+    return pointer;
+}
+
+void MemoryTracker::free(void* pointer) noexcept
+{
+    if(pointer == nullptr) { return; }
+
+    std::byte* bytes = static_cast<std::byte*>(pointer);
+
+    AllocationHeader header;
+    std::memcpy(&header, bytes - kHeaderByteSize, sizeof(header));
+
+    TagCounters& counters = sTagCounters[ToUnderlying(header.tag)];
+    counters.freeCount.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_sub((int64_t)header.byteSize, std::memory_order_relaxed);
+
+    std::free(bytes - header.baseOffset);
+}
+
+MemoryTagStats MemoryTracker::getStats(MemoryTag tag)
+{
+    const TagCounters& counters = sTagCounters[ToUnderlying(tag)];
+
+    MemoryTagStats stats;
+    stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+    stats.allocationCount = counters.allocationCount.load(std::memory_order_relaxed);
+    stats.freeCount = counters.freeCount.load(std::memory_order_relaxed);
+    stats.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+int64_t MemoryTracker::collectPeriodPeakBytes(MemoryTag tag)
+{
+    TagCounters& counters = sTagCounters[ToUnderlying(tag)];
+
+    const int64_t liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+    return counters.periodPeakBytes.exchange(liveBytes, std::memory_order_relaxed);
+}
+
+MemoryTagRecorder::MemoryTagRecorder(const MemoryTagRecorderParams& params): mParams(params)
+{
+    for(MemoryTag tag : enumerate<MemoryTag>())
+    {
+        mPreviousStats[tag] = MemoryTracker::getStats(tag);
+        (void)MemoryTracker::collectPeriodPeakBytes(tag);
+    }
+}
+
+void MemoryTagRecorder::endFrame(uint64_t frameNumber)
+{
+    for(MemoryTag tag : enumerate<MemoryTag>())
+    {
+        const MemoryTagStats stats = MemoryTracker::getStats(tag);
+        const MemoryTagStats& previousStats = mPreviousStats[tag];
+
+        MemoryTagFrameStats& frameStats = mFrameStats[tag];
+        frameStats.liveBytes = stats.liveBytes;
+        frameStats.peakBytes = MemoryTracker::collectPeriodPeakBytes(tag);
+        frameStats.allocationCount = stats.allocationCount - previousStats.allocationCount;
+        frameStats.freeCount = stats.freeCount - previousStats.freeCount;
+        frameStats.allocatedBytes = stats.allocatedBytes - previousStats.allocatedBytes;
+
+        mPreviousStats[tag] = stats;
+    }
+
+    if(mParams.reportInterval > 0 && frameNumber % mParams.reportInterval == 0) { logFrameReport(frameNumber); }
+}
+
+void MemoryTagRecorder::logFrameReport(uint64_t frameNumber) const
+{
+    fmt::memory_buffer message;
+    fmt::format_to(fmt::appender(message), "Cpu memory of frame {}:", frameNumber);
+
+    for(MemoryTag tag : enumerate<MemoryTag>())
+    {
+        const MemoryTagFrameStats& frameStats = mFrameStats[tag];
+        const MemoryTagStats& stats = mPreviousStats[tag];
+
+        fmt::format_to(fmt::appender(message),
+                       "\n    {}: {:.1f} KiB live, {:.1f} KiB frame peak, {:.1f} KiB peak, {} allocations ({:.1f} KiB) "
+                       "and {} frees this frame",
+                       ToStringView(tag), ToKibibytes(frameStats.liveBytes), ToKibibytes(frameStats.peakBytes),
+                       ToKibibytes(stats.peakBytes), frameStats.allocationCount,
+                       ToKibibytes((int64_t)frameStats.allocatedBytes), frameStats.freeCount);
+    }
+
+    spdlog::info("{}", std::string_view(message.data(), message.size()));
+}
+} // namespace scrap
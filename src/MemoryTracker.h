@@ -0,0 +1,184 @@
+// Classes:
+//   MemoryTracker
+//   MemoryTagScope
+//   MemoryTagRecorder
+//
+// Attributes cpu allocations to the subsystem that made them. SCRAP_MEMORY_TAG(Mesh) tags every allocation the calling
+// thread makes for the rest of the scope. Tags nest, the innermost one wins. Allocations outside of any tag are
+// Untagged.
+//
+// SCRAP_MEMORY_TRACKING_ENABLED set to 0 compiles the tags out and leaves the global operator new and delete alone.
+//
+// MemoryTracker:
+//   The global operator new and delete and the EASTL operator new[] in AllocationOperators.cpp allocate through
+//   MemoryTracker. Every allocation gets a 16 byte header in front of it that remembers its size and tag, so a free is
+//   counted against the tag that allocated the memory, no matter which tag is current when it's freed. Each tag counts
+//   its live bytes, peak bytes, allocations and frees with relaxed atomics. The counters of a tag share a cache line,
+//   threads that allocate under the same tag at the same time contend on it.
+//
+// MemoryTagRecorder:
+//   Turns the running totals into per frame numbers once per frame in endFrame: how many allocations and frees a tag
+//   made during the frame, how many bytes it allocated and the most it had live at any point in the frame. In steady
+//   state, a tag that keeps allocating every frame is churn.
+
+#pragma once
+
+#include "EnumArray.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifndef SCRAP_MEMORY_TRACKING_ENABLED
+#define SCRAP_MEMORY_TRACKING_ENABLED 1
+#endif
+
+#if SCRAP_MEMORY_TRACKING_ENABLED
+#define SCRAP_MEMORY_TAG_CONCAT_IMPL(left, right) left##right
+#define SCRAP_MEMORY_TAG_CONCAT(left, right) SCRAP_MEMORY_TAG_CONCAT_IMPL(left, right)
+#define SCRAP_MEMORY_TAG(tag) \
+    ::scrap::MemoryTagScope SCRAP_MEMORY_TAG_CONCAT(memoryTagScope, __LINE__)(::scrap::MemoryTag::tag)
+#else
+#define SCRAP_MEMORY_TAG(tag) (void)0
+#endif
+
+namespace scrap
+{
+enum class MemoryTag : uint8_t
+{
+    Untagged,
+    Mesh,
+    Texture,
+    ShaderReflection,
+    Scene,
+    D3D12Wrapper,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(MemoryTag tag)
+{
+    switch(tag)
+    {
+    case MemoryTag::Untagged: return "Untagged";
+    case MemoryTag::Mesh: return "Mesh";
+    case MemoryTag::Texture: return "Texture";
+    case MemoryTag::ShaderReflection: return "ShaderReflection";
+    case MemoryTag::Scene: return "Scene";
+    case MemoryTag::D3D12Wrapper: return "D3D12Wrapper";
+    default: return "Unknown MemoryTag";
+    }
+}
+
+struct MemoryTagStats
+{
+    int64_t liveBytes = 0;
+    int64_t peakBytes = 0;
+    uint64_t allocationCount = 0;
+    uint64_t freeCount = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+class MemoryTracker
+{
+public:
+    static constexpr size_t kHeaderByteSize = 16;
+
+    MemoryTracker() = delete;
+
+    // Returns nullptr when out of memory. alignment has to be a power of 2. The returned pointer plus alignmentOffset
+    // is aligned, which is what EASTL asks for.
+    [[nodiscard]] static void* allocate(size_t byteSize, size_t alignment, size_t alignmentOffset = 0) noexcept;
+    // Only takes pointers returned by allocate
+    static void free(void* pointer) noexcept;
+
+    [[nodiscard]] static MemoryTag getCurrentTag() { return tCurrentTag; }
+    // Returns the previous tag
+    static MemoryTag setCurrentTag(MemoryTag tag)
+    {
+        const MemoryTag previousTag = tCurrentTag;
+        tCurrentTag = tag;
+        return previousTag;
+    }
+
+    [[nodiscard]] static MemoryTagStats getStats(MemoryTag tag);
+
+    // The most bytes the tag had live since the last call. Starts the next period at the bytes live now.
+    [[nodiscard]] static int64_t collectPeriodPeakBytes(MemoryTag tag);
+
+private:
+    struct alignas(64) TagCounters
+    {
+        std::atomic<int64_t> liveBytes{0};
+        std::atomic<int64_t> peakBytes{0};
+        std::atomic<int64_t> periodPeakBytes{0};
+        std::atomic<uint64_t> allocationCount{0};
+        std::atomic<uint64_t> freeCount{0};
+        std::atomic<uint64_t> allocatedBytes{0};
+    };
+
+    static std::array<TagCounters, ToUnderlying(MemoryTag::Count)> sTagCounters;
+
+    thread_local static MemoryTag tCurrentTag;
+};
+
+class MemoryTagScope
+{
+public:
+    explicit MemoryTagScope(MemoryTag tag): mPreviousTag(MemoryTracker::setCurrentTag(tag)) {}
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope(MemoryTagScope&&) = delete;
+    ~MemoryTagScope() { MemoryTracker::setCurrentTag(mPreviousTag); }
+
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(MemoryTagScope&&) = delete;
+
+private:
+    MemoryTag mPreviousTag;
+};
+
+struct MemoryTagFrameStats
+{
+    int64_t liveBytes = 0;
+    // The most bytes live at any point during the frame
+    int64_t peakBytes = 0;
+    uint64_t allocationCount = 0;
+    uint64_t freeCount = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+struct MemoryTagRecorderParams
+{
+    // Logs the per tag memory of every reportInterval'th frame. 0 disables the report.
+    uint32_t reportInterval = 0;
+};
+
+class MemoryTagRecorder
+{
+public:
+    explicit MemoryTagRecorder(const MemoryTagRecorderParams& params);
+    MemoryTagRecorder(const MemoryTagRecorder&) = delete;
+    MemoryTagRecorder(MemoryTagRecorder&&) = delete;
+    ~MemoryTagRecorder() = default;
+
+    MemoryTagRecorder& operator=(const MemoryTagRecorder&) = delete;
+    MemoryTagRecorder& operator=(MemoryTagRecorder&&) = delete;
+
+    // Called once per frame by the thread that runs the frame loop
+    void endFrame(uint64_t frameNumber);
+
+    // The frame endFrame was last called for
+    [[nodiscard]] const MemoryTagFrameStats& getFrameStats(MemoryTag tag) const { return mFrameStats[tag]; }
+
+    void logFrameReport(uint64_t frameNumber) const;
+
+private:
+    MemoryTagRecorderParams mParams;
+
+    EnumArray<MemoryTagStats, MemoryTag> mPreviousStats{};
+    EnumArray<MemoryTagFrameStats, MemoryTag> mFrameStats{};
+};
+} // namespace scrap
@@ -0,0 +1,392 @@
+#include "PerfBaseline.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint32_t kBaselineVersion = 1;
+
+// Reads the subset of json the baseline is written in. Values it doesn't know are skipped, so a newer baseline with
+// more fields still reads.
+class JsonReader
+{
+public:
+    explicit JsonReader(std::string_view text): mText(text) {}
+
+    // Consumes the character if it's the next one after the whitespace
+    bool consume(char character)
+    {
+        skipWhitespace();
+        if(mPosition >= mText.size() || mText[mPosition] != character) { return false; }
+
+        ++mPosition;
+        return true;
+    }
+
+    [[nodiscard]] std::optional<std::string> readString()
+    {
+        if(!consume('"')) { return std::nullopt; }
+
+        std::string string;
+        while(mPosition < mText.size())
+        {
+            const char character = mText[mPosition++];
+            if(character == '"') { return string; }
+
+            // Names don't need anything but the simple escapes
+            if(character == '\\')
+            {
+                if(mPosition >= mText.size()) { return std::nullopt; }
+                string.push_back(mText[mPosition++]);
+            }
+            else { string.push_back(character); }
+        }
+
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<double> readNumber()
+    {
+        skipWhitespace();
+
+        double value = 0.0;
+        const auto [end, error] = std::from_chars(mText.data() + mPosition, mText.data() + mText.size(), value);
+        if(error != std::errc()) { return std::nullopt; }
+
+        mPosition = (size_t)(end - mText.data());
+        return value;
+    }
+
+    bool skipValue()
+    {
+        skipWhitespace();
+        if(mPosition >= mText.size()) { return false; }
+
+        const char character = mText[mPosition];
+
+        if(character == '"') { return readString().has_value(); }
+
+        if(character == '{' || character == '[')
+        {
+            const char closing = (character == '{') ? '}' : ']';
+            ++mPosition;
+
+            if(consume(closing)) { return true; }
+
+            do
+            {
+                if(closing == '}' && (!readString().has_value() || !consume(':'))) { return false; }
+                if(!skipValue()) { return false; }
+            } while(consume(','));
+
+            return consume(closing);
+        }
+
+        for(std::string_view literal : {"true", "false", "null"})
+        {
+            if(mText.substr(mPosition, literal.size()) == literal)
+            {
+                mPosition += literal.size();
+                return true;
+            }
+        }
+
+        return readNumber().has_value();
+    }
+
+private:
+    void skipWhitespace()
+    {
+        while(mPosition < mText.size() &&
+              (mText[mPosition] == ' ' || mText[mPosition] == '\n' || mText[mPosition] == '\r' ||
+               mText[mPosition] == '\t'))
+        {
+            ++mPosition;
+        }
+    }
+
+    std::string_view mText;
+    size_t mPosition = 0;
+};
+
+std::optional<PerfBenchmarkSamples> ReadBenchmark(JsonReader& reader)
+{
+    if(!reader.consume('{')) { return std::nullopt; }
+
+    PerfBenchmarkSamples benchmark;
+    if(reader.consume('}')) { return benchmark; }
+
+    do
+    {
+        const std::optional<std::string> key = reader.readString();
+        if(!key.has_value() || !reader.consume(':')) { return std::nullopt; }
+
+        if(key.value() == "name")
+        {
+            std::optional<std::string> name = reader.readString();
+            if(!name.has_value()) { return std::nullopt; }
+            benchmark.name = std::move(name.value());
+        }
+        else if(key.value() == "samples")
+        {
+            if(!reader.consume('[')) { return std::nullopt; }
+            if(reader.consume(']')) { continue; }
+
+            do
+            {
+                const std::optional<double> sample = reader.readNumber();
+                if(!sample.has_value()) { return std::nullopt; }
+                benchmark.samples.push_back(sample.value());
+            } while(reader.consume(','));
+
+            if(!reader.consume(']')) { return std::nullopt; }
+        }
+        else if(!reader.skipValue()) { return std::nullopt; }
+    } while(reader.consume(','));
+
+    if(!reader.consume('}')) { return std::nullopt; }
+
+    return benchmark;
+}
+
+std::optional<std::vector<PerfBenchmarkSamples>> ReadBaseline(JsonReader& reader)
+{
+    if(!reader.consume('{')) { return std::nullopt; }
+
+    std::vector<PerfBenchmarkSamples> benchmarks;
+    if(reader.consume('}')) { return benchmarks; }
+
+    do
+    {
+        const std::optional<std::string> key = reader.readString();
+        if(!key.has_value() || !reader.consume(':')) { return std::nullopt; }
+
+        if(key.value() == "benchmarks")
+        {
+            if(!reader.consume('[')) { return std::nullopt; }
+            if(reader.consume(']')) { continue; }
+
+            do
+            {
+                std::optional<PerfBenchmarkSamples> benchmark = ReadBenchmark(reader);
+                if(!benchmark.has_value()) { return std::nullopt; }
+                benchmarks.push_back(std::move(benchmark.value()));
+            } while(reader.consume(','));
+
+            if(!reader.consume(']')) { return std::nullopt; }
+        }
+        else if(!reader.skipValue()) { return std::nullopt; }
+    } while(reader.consume(','));
+
+    if(!reader.consume('}')) { return std::nullopt; }
+
+    return benchmarks;
+}
+} // namespace
+
+double PerfSampleMedian(std::vector<double> samples)
+{
+    if(samples.empty()) { return 0.0; }
+
+    const size_t middle = samples.size() / 2;
+    std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+    if(samples.size() % 2 == 1) { return samples[middle]; }
+
+    const double upper = samples[middle];
+    const double lower = *std::max_element(samples.begin(), samples.begin() + middle);
+    return (lower + upper) * 0.5;
+}
+
+bool WritePerfBaseline(const std::filesystem::path& filePath, const std::vector<PerfBenchmarkSamples>& benchmarks)
+{
+    fmt::memory_buffer json;
+    fmt::format_to(fmt::appender(json), "{{\n  \"version\": {},\n  \"benchmarks\": [", kBaselineVersion);
+
+    for(size_t benchmarkIndex = 0; benchmarkIndex < benchmarks.size(); ++benchmarkIndex)
+    {
+        const PerfBenchmarkSamples& benchmark = benchmarks[benchmarkIndex];
+
+        fmt::format_to(fmt::appender(json), "{}\n    {{\"name\": \"{}\", \"samples\": [",
+                       (benchmarkIndex > 0) ? "," : "", benchmark.name);
+
+        for(size_t sampleIndex = 0; sampleIndex < benchmark.samples.size(); ++sampleIndex)
+        {
+            fmt::format_to(fmt::appender(json), "{}{:.3f}", (sampleIndex > 0) ? ", " : "",
+                           benchmark.samples[sampleIndex]);
+        }
+
+        fmt::format_to(fmt::appender(json), "]}}");
+    }
+
+    fmt::format_to(fmt::appender(json), "\n  ]\n}}\n");
+
+    std::ofstream file(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
+    if(!file.is_open())
+    {
+        spdlog::error("Failed to open '{}' for the perf baseline", filePath.string());
+        return false;
+    }
+
+    file.write(json.data(), (std::streamsize)json.size());
+    return file.good();
+}
+
+std::optional<std::vector<PerfBenchmarkSamples>> ReadPerfBaseline(const std::filesystem::path& filePath)
+{
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if(!file.is_open())
+    {
+        spdlog::error("Failed to open the perf baseline '{}'", filePath.string());
+        return std::nullopt;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::optional<std::vector<PerfBenchmarkSamples>> benchmarks = ParsePerfBaseline(text.str());
+    if(!benchmarks.has_value()) { spdlog::error("The perf baseline '{}' isn't valid json", filePath.string()); }
+
+    return benchmarks;
+}
+
+std::optional<std::vector<PerfBenchmarkSamples>> ParsePerfBaseline(std::string_view json)
+{
+    JsonReader reader(json);
+    return ReadBaseline(reader);
+}
+
+double MannWhitneyPValue(const std::vector<double>& samplesA, const std::vector<double>& samplesB)
+{
+    const size_t countA = samplesA.size();
+    const size_t countB = samplesB.size();
+    if(countA == 0 || countB == 0) { return 1.0; }
+
+    struct RankedSample
+    {
+        double value;
+        bool isA;
+    };
+
+    std::vector<RankedSample> ranked;
+    ranked.reserve(countA + countB);
+    for(double value : samplesA)
+    {
+        ranked.push_back({value, true});
+    }
+    for(double value : samplesB)
+    {
+        ranked.push_back({value, false});
+    }
+
+    std::sort(ranked.begin(), ranked.end(),
+              [](const RankedSample& left, const RankedSample& right) { return left.value < right.value; });
+
+    // Ties get the mean of the ranks they span and shrink the variance
+    double rankSumA = 0.0;
+    double tieCorrection = 0.0;
+    for(size_t first = 0; first < ranked.size();)
+    {
+        size_t last = first + 1;
+        while(last < ranked.size() && ranked[last].value == ranked[first].value)
+        {
+            ++last;
+        }
+
+        const double tieCount = (double)(last - first);
+        const double meanRank = ((double)first + (double)last + 1.0) * 0.5;
+        for(size_t i = first; i < last; ++i)
+        {
+            if(ranked[i].isA) { rankSumA += meanRank; }
+        }
+
+        tieCorrection += tieCount * tieCount * tieCount - tieCount;
+        first = last;
+    }
+
+    const double n1 = (double)countA;
+    const double n2 = (double)countB;
+    const double n = n1 + n2;
+
+    const double u = rankSumA - n1 * (n1 + 1.0) * 0.5;
+    const double meanU = n1 * n2 * 0.5;
+    const double varianceU = n1 * n2 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+    if(varianceU <= 0.0) { return 1.0; }
+
+    // Normal approximation with a continuity correction, fine from about 8 samples a side
+    const double z = std::max(std::abs(u - meanU) - 0.5, 0.0) / std::sqrt(varianceU);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<PerfComparison> ComparePerfRuns(const std::vector<PerfBenchmarkSamples>& baseline,
+                                            const std::vector<PerfBenchmarkSamples>& current,
+                                            const PerfComparisonParams& params)
+{
+    std::vector<PerfComparison> comparisons;
+    comparisons.reserve(current.size());
+
+    for(const PerfBenchmarkSamples& benchmark : current)
+    {
+        PerfComparison& comparison = comparisons.emplace_back();
+        comparison.name = benchmark.name;
+        comparison.currentMedian = PerfSampleMedian(benchmark.samples);
+
+        auto baselineItr = std::find_if(baseline.begin(), baseline.end(), [&](const PerfBenchmarkSamples& entry) {
+            return entry.name == benchmark.name;
+        });
+
+        if(baselineItr == baseline.end() || baselineItr->samples.empty())
+        {
+            comparison.verdict = PerfVerdict::NoBaseline;
+            continue;
+        }
+
+        comparison.baselineMedian = PerfSampleMedian(baselineItr->samples);
+        comparison.changePercent = (comparison.baselineMedian > 0.0)
+                                       ? (comparison.currentMedian / comparison.baselineMedian - 1.0) * 100.0
+                                       : 0.0;
+        comparison.pValue = MannWhitneyPValue(baselineItr->samples, benchmark.samples);
+
+        if(comparison.pValue >= params.significance) { comparison.verdict = PerfVerdict::Unchanged; }
+        else if(comparison.changePercent > params.thresholdPercent) { comparison.verdict = PerfVerdict::Regression; }
+        else if(comparison.changePercent > 0.0) { comparison.verdict = PerfVerdict::Slower; }
+        else if(comparison.changePercent < -params.thresholdPercent) { comparison.verdict = PerfVerdict::Faster; }
+        else { comparison.verdict = PerfVerdict::Unchanged; }
+    }
+
+    return comparisons;
+}
+
+void LogPerfComparisons(const std::vector<PerfComparison>& comparisons)
+{
+    spdlog::info("Perf regression comparison against the baseline, median nanoseconds per iteration");
+
+    uint32_t regressionCount = 0;
+    for(const PerfComparison& comparison : comparisons)
+    {
+        if(comparison.verdict == PerfVerdict::NoBaseline)
+        {
+            spdlog::info("    {:<32} {:.1f}, not in the baseline", comparison.name, comparison.currentMedian);
+            continue;
+        }
+
+        const auto level = (comparison.verdict == PerfVerdict::Regression) ? spdlog::level::err : spdlog::level::info;
+        spdlog::log(level, "    {:<32} {:.1f} -> {:.1f} ({:+.1f}%, p {:.4f}) {}", comparison.name,
+                    comparison.baselineMedian, comparison.currentMedian, comparison.changePercent, comparison.pValue,
+                    ToStringView(comparison.verdict));
+
+        if(comparison.verdict == PerfVerdict::Regression) { ++regressionCount; }
+    }
+
+    if(regressionCount > 0) { spdlog::error("{} of {} benchmarks regressed", regressionCount, comparisons.size()); }
+    else { spdlog::info("No regressions in {} benchmarks", comparisons.size()); }
+}
+} // namespace scrap
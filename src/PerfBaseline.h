@@ -0,0 +1,85 @@
+// The samples of a perf regression run, the json baseline they're saved in and the comparison of two runs. Nothing in
+// here runs a benchmark, so it can be tested on its own.
+//
+// Comparing:
+//   A benchmark is compared with a two sided Mann-Whitney U test of its baseline samples against the new ones. It
+//   doesn't assume the times are normally distributed, and a few outliers from a busy machine don't move it much. A
+//   benchmark regressed when the test says the runs differ (p below significance) and the median got slower by more
+//   than thresholdPercent. Both are needed: with enough samples, the test finds differences too small to matter, and
+//   a large change of the median can be noise when the samples are spread out.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+struct PerfBenchmarkSamples
+{
+    std::string name;
+    // Nanoseconds per iteration
+    std::vector<double> samples;
+};
+
+enum class PerfVerdict
+{
+    Unchanged,
+    Faster,
+    Slower,
+    Regression,
+    NoBaseline,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(PerfVerdict verdict)
+{
+    switch(verdict)
+    {
+    case PerfVerdict::Unchanged: return "Unchanged";
+    case PerfVerdict::Faster: return "Faster";
+    case PerfVerdict::Slower: return "Slower";
+    case PerfVerdict::Regression: return "Regression";
+    case PerfVerdict::NoBaseline: return "NoBaseline";
+    default: return "Unknown PerfVerdict";
+    }
+}
+
+struct PerfComparison
+{
+    std::string name;
+    double baselineMedian = 0.0;
+    double currentMedian = 0.0;
+    // Of the median. Positive is slower.
+    double changePercent = 0.0;
+    double pValue = 1.0;
+    // Slower is a significant slowdown that stays under the threshold
+    PerfVerdict verdict = PerfVerdict::Unchanged;
+};
+
+struct PerfComparisonParams
+{
+    double thresholdPercent = 5.0;
+    double significance = 0.01;
+};
+
+// Logs an error and returns false or nullopt if the file can't be written or read
+bool WritePerfBaseline(const std::filesystem::path& filePath, const std::vector<PerfBenchmarkSamples>& benchmarks);
+[[nodiscard]] std::optional<std::vector<PerfBenchmarkSamples>> ReadPerfBaseline(const std::filesystem::path& filePath);
+// Returns nullopt if json isn't a baseline
+[[nodiscard]] std::optional<std::vector<PerfBenchmarkSamples>> ParsePerfBaseline(std::string_view json);
+
+[[nodiscard]] double PerfSampleMedian(std::vector<double> samples);
+
+// Returns the probability of samples at least this different if both come from the same distribution
+[[nodiscard]] double MannWhitneyPValue(const std::vector<double>& samplesA, const std::vector<double>& samplesB);
+
+[[nodiscard]] std::vector<PerfComparison> ComparePerfRuns(const std::vector<PerfBenchmarkSamples>& baseline,
+                                                          const std::vector<PerfBenchmarkSamples>& current,
+                                                          const PerfComparisonParams& params);
+
+void LogPerfComparisons(const std::vector<PerfComparison>& comparisons);
+} // namespace scrap
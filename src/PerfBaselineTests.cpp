@@ -0,0 +1,228 @@
+#include "PerfBaseline.h"
+#include "UnitTest.h"
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+// count samples from first up, step apart
+std::vector<double> MakeSamples(double first, double step, size_t count)
+{
+    std::vector<double> samples(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        samples[i] = first + step * (double)i;
+    }
+
+    return samples;
+}
+
+bool IsNear(double left, double right, double tolerance)
+{
+    return std::abs(left - right) <= tolerance;
+}
+
+const PerfComparison* FindComparison(const std::vector<PerfComparison>& comparisons, std::string_view name)
+{
+    for(const PerfComparison& comparison : comparisons)
+    {
+        if(comparison.name == name) { return &comparison; }
+    }
+
+    return nullptr;
+}
+} // namespace
+
+SCRAP_TEST(PerfBaseline, MedianOfOddAndEvenCounts)
+{
+    SCRAP_CHECK(PerfSampleMedian({}) == 0.0);
+    SCRAP_CHECK(PerfSampleMedian({3.0, 1.0, 2.0}) == 2.0);
+    SCRAP_CHECK(PerfSampleMedian({4.0, 1.0, 3.0, 2.0}) == 2.5);
+}
+
+SCRAP_TEST(PerfBaseline, IdenticalSamplesAreNotDifferent)
+{
+    const std::vector<double> samples = MakeSamples(100.0, 1.0, 30);
+
+    SCRAP_CHECK(IsNear(MannWhitneyPValue(samples, samples), 1.0, 1e-9));
+    SCRAP_CHECK(MannWhitneyPValue(samples, {}) == 1.0);
+    SCRAP_CHECK(MannWhitneyPValue({}, samples) == 1.0);
+}
+
+SCRAP_TEST(PerfBaseline, DisjointSamplesAreDifferent)
+{
+    const std::vector<double> baseline = MakeSamples(100.0, 1.0, 20);
+    const std::vector<double> shifted = MakeSamples(200.0, 1.0, 20);
+
+    const double pValue = MannWhitneyPValue(baseline, shifted);
+    SCRAP_CHECK(pValue < 0.001);
+    // Two sided, the order of the runs doesn't matter
+    SCRAP_CHECK(IsNear(MannWhitneyPValue(shifted, baseline), pValue, 1e-12));
+
+    // Interleaved samples of the same spread are not
+    const std::vector<double> interleaved = MakeSamples(100.5, 1.0, 20);
+    SCRAP_CHECK(MannWhitneyPValue(baseline, interleaved) > 0.5);
+}
+
+SCRAP_TEST(PerfBaseline, TiesShareTheirRanks)
+{
+    // Every sample tied leaves nothing to tell the runs apart
+    const std::vector<double> constant(16, 42.0);
+    SCRAP_CHECK(MannWhitneyPValue(constant, constant) == 1.0);
+
+    // U = 20 of a mean of 50 with 2 groups of tied samples. The expected value is the normal approximation with the
+    // tie and continuity corrections, the same as scipy's mannwhitneyu(method="asymptotic").
+    const std::vector<double> mostlyOnes{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 2.0, 2.0};
+    const std::vector<double> mostlyTwos{1.0, 1.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0};
+    SCRAP_CHECK(IsNear(MannWhitneyPValue(mostlyOnes, mostlyTwos), 0.0101186, 1e-6));
+}
+
+SCRAP_TEST(PerfBaseline, ComparisonVerdicts)
+{
+    const std::vector<double> baseline = MakeSamples(100.0, 0.01, 30);
+
+    const std::vector<PerfBenchmarkSamples> baselineRun{
+        {"Same", baseline},
+        {"Slower", baseline},
+        {"Regression", baseline},
+        {"Faster", baseline},
+        {"SlightlyFaster", baseline},
+        {"Empty", {}},
+    };
+    const std::vector<PerfBenchmarkSamples> currentRun{
+        {"Same", baseline},
+        {"Slower", MakeSamples(102.0, 0.01, 30)},
+        {"Regression", MakeSamples(110.0, 0.01, 30)},
+        {"Faster", MakeSamples(90.0, 0.01, 30)},
+        {"SlightlyFaster", MakeSamples(98.0, 0.01, 30)},
+        {"Empty", baseline},
+        {"New", baseline},
+    };
+
+    const std::vector<PerfComparison> comparisons =
+        ComparePerfRuns(baselineRun, currentRun, PerfComparisonParams{.thresholdPercent = 5.0, .significance = 0.01});
+    SCRAP_REQUIRE(comparisons.size() == currentRun.size());
+
+    const PerfComparison* same = FindComparison(comparisons, "Same");
+    SCRAP_REQUIRE(same != nullptr);
+    SCRAP_CHECK(same->verdict == PerfVerdict::Unchanged);
+    SCRAP_CHECK(same->pValue >= 0.01);
+    SCRAP_CHECK(same->changePercent == 0.0);
+
+    // Significant, but under the threshold
+    const PerfComparison* slower = FindComparison(comparisons, "Slower");
+    SCRAP_REQUIRE(slower != nullptr);
+    SCRAP_CHECK(slower->verdict == PerfVerdict::Slower);
+    SCRAP_CHECK(slower->pValue < 0.01);
+    SCRAP_CHECK(IsNear(slower->changePercent, 2.0, 0.01));
+
+    const PerfComparison* regression = FindComparison(comparisons, "Regression");
+    SCRAP_REQUIRE(regression != nullptr);
+    SCRAP_CHECK(regression->verdict == PerfVerdict::Regression);
+    SCRAP_CHECK(IsNear(regression->baselineMedian, 100.145, 1e-9));
+    SCRAP_CHECK(IsNear(regression->currentMedian, 110.145, 1e-9));
+
+    const PerfComparison* faster = FindComparison(comparisons, "Faster");
+    SCRAP_REQUIRE(faster != nullptr);
+    SCRAP_CHECK(faster->verdict == PerfVerdict::Faster);
+    SCRAP_CHECK(faster->changePercent < -5.0);
+
+    // Faster by less than the threshold doesn't count as a change
+    const PerfComparison* slightlyFaster = FindComparison(comparisons, "SlightlyFaster");
+    SCRAP_REQUIRE(slightlyFaster != nullptr);
+    SCRAP_CHECK(slightlyFaster->verdict == PerfVerdict::Unchanged);
+    SCRAP_CHECK(slightlyFaster->pValue < 0.01);
+
+    const PerfComparison* empty = FindComparison(comparisons, "Empty");
+    SCRAP_REQUIRE(empty != nullptr);
+    SCRAP_CHECK(empty->verdict == PerfVerdict::NoBaseline);
+
+    const PerfComparison* added = FindComparison(comparisons, "New");
+    SCRAP_REQUIRE(added != nullptr);
+    SCRAP_CHECK(added->verdict == PerfVerdict::NoBaseline);
+}
+
+SCRAP_TEST(PerfBaseline, RegressionNeedsSignificance)
+{
+    // The median is 10% slower, but the samples are spread too far apart for the test to tell the runs apart
+    const std::vector<PerfBenchmarkSamples> baselineRun{{"Noisy", {50.0, 100.0, 150.0, 200.0, 250.0}}};
+    const std::vector<PerfBenchmarkSamples> currentRun{{"Noisy", {60.0, 110.0, 165.0, 210.0, 260.0}}};
+
+    const std::vector<PerfComparison> comparisons = ComparePerfRuns(baselineRun, currentRun, PerfComparisonParams{});
+    SCRAP_REQUIRE(comparisons.size() == 1);
+    SCRAP_CHECK(comparisons[0].changePercent > 5.0);
+    SCRAP_CHECK(comparisons[0].verdict == PerfVerdict::Unchanged);
+}
+
+SCRAP_TEST(PerfBaseline, WriteReadRoundTrip)
+{
+    const std::vector<PerfBenchmarkSamples> benchmarks{
+        {"FreeBlockTracker/ReserveRelease", {12.5, 13.25, 1234.125}},
+        {"RenderGraph/Compile512", {}},
+        {"StringHash/Hash", {0.0, 7.0}},
+    };
+
+    const std::filesystem::path filePath = std::filesystem::temp_directory_path() / "ScrapPerfBaselineTests.json";
+    SCRAP_REQUIRE(WritePerfBaseline(filePath, benchmarks));
+
+    const std::optional<std::vector<PerfBenchmarkSamples>> readBenchmarks = ReadPerfBaseline(filePath);
+    std::error_code error;
+    std::filesystem::remove(filePath, error);
+
+    SCRAP_REQUIRE(readBenchmarks.has_value());
+    SCRAP_REQUIRE(readBenchmarks->size() == benchmarks.size());
+    for(size_t i = 0; i < benchmarks.size(); ++i)
+    {
+        SCRAP_CHECK(readBenchmarks.value()[i].name == benchmarks[i].name);
+        // Written with 3 decimals, which every sample above has room for
+        SCRAP_CHECK(readBenchmarks.value()[i].samples == benchmarks[i].samples);
+    }
+}
+
+SCRAP_TEST(PerfBaseline, ReadSkipsUnknownValues)
+{
+    const std::optional<std::vector<PerfBenchmarkSamples>> benchmarks = ParsePerfBaseline(
+        R"({"version": 2, "machine": {"cores": [8, 16], "name": "a \"b\"", "ci": true, "gpu": null},
+            "benchmarks": [{"name": "A", "unit": "ns", "samples": [1.5, 2e3]}, {"samples": [], "name": "B"}]})");
+
+    SCRAP_REQUIRE(benchmarks.has_value());
+    SCRAP_REQUIRE(benchmarks->size() == 2);
+    SCRAP_CHECK(benchmarks.value()[0].name == "A");
+    SCRAP_CHECK(benchmarks.value()[0].samples == std::vector<double>({1.5, 2000.0}));
+    SCRAP_CHECK(benchmarks.value()[1].name == "B");
+    SCRAP_CHECK(benchmarks.value()[1].samples.empty());
+
+    SCRAP_CHECK(ParsePerfBaseline("{}").has_value());
+}
+
+SCRAP_TEST(PerfBaseline, ReadRejectsMalformedInput)
+{
+    const std::vector<std::string_view> malformed{
+        "",
+        "[]",
+        "{",
+        R"({"benchmarks": [)",
+        R"({"benchmarks": [{"name": "A", "samples": [1, 2]})",
+        R"({"benchmarks" [{"name": "A"}]})",
+        R"({"benchmarks": [{"name": "A", "samples": [1, ]}]})",
+        R"({"benchmarks": [{"name": "A", "samples": ["1"]}]})",
+        R"({"benchmarks": [{"name": 5}]})",
+        R"({"benchmarks": [{"name": "A}]})",
+        R"({"benchmarks": {"name": "A"}})",
+        R"({"version": tru, "benchmarks": []})",
+    };
+
+    for(std::string_view json : malformed)
+    {
+        SCRAP_CHECK(!ParsePerfBaseline(json).has_value());
+    }
+
+    SCRAP_CHECK(!ReadPerfBaseline(std::filesystem::temp_directory_path() / "ScrapPerfBaselineMissing.json"));
+}
+} // namespace scrap
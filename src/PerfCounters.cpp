@@ -0,0 +1,188 @@
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+std::array<PerfCounters::Shard, PerfCounters::kShardCount> PerfCounters::sShards;
+std::array<std::atomic<int64_t>, ToUnderlying(PerfGauge::Count)> PerfCounters::sGauges{};
+std::atomic<uint32_t> PerfCounters::sNextShardIndex{0};
+
+// Threads are handed the shards round robin. With more threads than shards a few of them share one, which only costs
+// some contention.
+thread_local uint32_t PerfCounters::tShardIndex =
+    PerfCounters::sNextShardIndex.fetch_add(1, std::memory_order_relaxed) % PerfCounters::kShardCount;
+
+EnumArray<uint64_t, PerfCounter> PerfCounters::collectCounters()
+{
+    EnumArray<uint64_t, PerfCounter> counters{};
+
+    for(Shard& shard : sShards)
+    {
+        for(PerfCounter counter : enumerate<PerfCounter>())
+        {
+            counters[counter] += shard.counters[ToUnderlying(counter)].exchange(0, std::memory_order_relaxed);
+        }
+    }
+
+    return counters;
+}
+
+EnumArray<int64_t, PerfGauge> PerfCounters::readGauges()
+{
+    EnumArray<int64_t, PerfGauge> gauges{};
+
+    for(PerfGauge gauge : enumerate<PerfGauge>())
+    {
+        gauges[gauge] = getGauge(gauge);
+    }
+
+    return gauges;
+}
+
+PerfCounterRecorder::PerfCounterRecorder(const PerfCounterRecorderParams& params): mParams(params)
+{
+    mHistory.reserve(std::max(mParams.historyFrameCount, 1u));
+
+    // Whatever was counted before the recorder existed doesn't belong to its first frame
+    (void)PerfCounters::collectCounters();
+
+    if(!mParams.filePath.empty())
+    {
+        mFileFormat = (mParams.filePath.extension() == ".json") ? FileFormat::JsonLines : FileFormat::Csv;
+        openFile();
+    }
+}
+
+void PerfCounterRecorder::endFrame(uint64_t frameNumber)
+{
+    PerfFrameSnapshot snapshot;
+    snapshot.frameNumber = frameNumber;
+    snapshot.counters = PerfCounters::collectCounters();
+    snapshot.gauges = PerfCounters::readGauges();
+
+    if(mFile.is_open()) { writeSnapshot(snapshot); }
+
+    if(mParams.reportInterval > 0 && frameNumber % mParams.reportInterval == 0) { logSnapshot(snapshot); }
+
+    if(mHistory.size() < mHistory.capacity()) { mHistory.push_back(snapshot); }
+    else
+    {
+        mHistory[mHistoryStart] = snapshot;
+        mHistoryStart = (mHistoryStart + 1) % mHistory.size();
+    }
+}
+
+void PerfCounterRecorder::logSnapshot(const PerfFrameSnapshot& snapshot) const
+{
+    fmt::memory_buffer message;
+    fmt::format_to(fmt::appender(message), "Perf counters of frame {}:", snapshot.frameNumber);
+
+    for(PerfCounter counter : enumerate<PerfCounter>())
+    {
+        fmt::format_to(fmt::appender(message), "\n    {}: {}", ToStringView(counter), snapshot.counters[counter]);
+    }
+
+    for(PerfGauge gauge : enumerate<PerfGauge>())
+    {
+        fmt::format_to(fmt::appender(message), "\n    {}: {}", ToStringView(gauge), snapshot.gauges[gauge]);
+    }
+
+    spdlog::info("{}", std::string_view(message.data(), message.size()));
+}
+
+void PerfCounterRecorder::openFile()
+{
+    mFile.open(mParams.filePath, std::ios::out | std::ios::trunc);
+    if(!mFile.is_open())
+    {
+        spdlog::error("Failed to open '{}' for the perf counters", mParams.filePath.string());
+        return;
+    }
+
+    mFileByteSize = 0;
+
+    // Json lines name every value, csv gets it once in the header
+    if(mFileFormat == FileFormat::JsonLines) { return; }
+
+    fmt::memory_buffer header;
+    fmt::format_to(fmt::appender(header), "Frame");
+
+    for(PerfCounter counter : enumerate<PerfCounter>())
+    {
+        fmt::format_to(fmt::appender(header), ",{}", ToStringView(counter));
+    }
+
+    for(PerfGauge gauge : enumerate<PerfGauge>())
+    {
+        fmt::format_to(fmt::appender(header), ",{}", ToStringView(gauge));
+    }
+
+    header.push_back('\n');
+
+    mFile.write(header.data(), (std::streamsize)header.size());
+    mFileByteSize += header.size();
+}
+
+void PerfCounterRecorder::writeSnapshot(const PerfFrameSnapshot& snapshot)
+{
+    fmt::memory_buffer line;
+
+    if(mFileFormat == FileFormat::JsonLines)
+    {
+        fmt::format_to(fmt::appender(line), "{{\"frame\":{}", snapshot.frameNumber);
+
+        for(PerfCounter counter : enumerate<PerfCounter>())
+        {
+            fmt::format_to(fmt::appender(line), ",\"{}\":{}", ToStringView(counter), snapshot.counters[counter]);
+        }
+
+        for(PerfGauge gauge : enumerate<PerfGauge>())
+        {
+            fmt::format_to(fmt::appender(line), ",\"{}\":{}", ToStringView(gauge), snapshot.gauges[gauge]);
+        }
+
+        line.push_back('}');
+    }
+    else
+    {
+        fmt::format_to(fmt::appender(line), "{}", snapshot.frameNumber);
+
+        for(uint64_t value : snapshot.counters)
+        {
+            fmt::format_to(fmt::appender(line), ",{}", value);
+        }
+
+        for(int64_t value : snapshot.gauges)
+        {
+            fmt::format_to(fmt::appender(line), ",{}", value);
+        }
+    }
+
+    line.push_back('\n');
+
+    mFile.write(line.data(), (std::streamsize)line.size());
+    mFileByteSize += line.size();
+
+    if(mFileByteSize < mParams.maxFileByteSize) { return; }
+
+    // Roll over. The previous file is kept as <file>.old, the one before that is dropped.
+    mFile.close();
+
+    std::filesystem::path oldFilePath = mParams.filePath;
+    oldFilePath += ".old";
+
+    std::error_code error;
+    std::filesystem::rename(mParams.filePath, oldFilePath, error);
+    if(error)
+    {
+        spdlog::warn("Failed to move the perf counter file to '{}': {}", oldFilePath.string(), error.message());
+    }
+
+    openFile();
+}
+} // namespace scrap
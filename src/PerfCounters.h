@@ -0,0 +1,263 @@
+// Classes:
+//   PerfCounters
+//   PerfGaugeContribution
+//   PerfCounterRecorder
+//
+// Engine wide counters and gauges, like draws per frame or descriptors in use. Every counter and gauge is a value of
+// PerfCounter or PerfGauge, so their names are known at compile time and nothing is looked up or allocated when one is
+// updated.
+//
+// SCRAP_PERF_COUNTERS_ENABLED set to 0 compiles the updates out.
+//
+// PerfCounters:
+//   Counters add up what happened during a frame and start over at 0 once the frame was collected. They are sharded
+//   by thread, every thread adds to one of kShardCount cache line sized shards with a relaxed atomic add, so threads
+//   recording in parallel don't fight over a cache line. Gauges hold a current amount, like the descriptors in use,
+//   and are never reset.
+//
+// PerfGaugeContribution:
+//   The part of a gauge that belongs to one object. Setting it adds the difference to the gauge and destroying it takes
+//   it back out, so several objects, like the graphics and the copy context, can report into the same gauge.
+//
+// PerfCounterRecorder:
+//   Collects the counters and reads the gauges once per frame in endFrame. Keeps the snapshots of the last
+//   historyFrameCount frames and appends every snapshot to a file. A file ending in .json gets one json object per
+//   line, anything else gets csv. The file is moved to <file>.old once it grows past maxFileByteSize, and a new one is
+//   started, so a long run only keeps the last two files around.
+//
+//   Counts are added to the frame in which endFrame collects them. With the render stage on its own thread, the draws
+//   in a frame's snapshot belong to the previous simulation frame.
+
+#pragma once
+
+#include "EnumArray.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#ifndef SCRAP_PERF_COUNTERS_ENABLED
+#define SCRAP_PERF_COUNTERS_ENABLED 1
+#endif
+
+namespace scrap
+{
+enum class PerfCounter
+{
+    DrawCalls,
+    TrianglesSubmitted,
+    RayDispatches,
+    RaysDispatched,
+    UploadBytes,
+    TlasBuilds,
+    // State setters GraphicsCommandList skipped because the state was already bound
+    RedundantStateCalls,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(PerfCounter counter)
+{
+    switch(counter)
+    {
+    case PerfCounter::DrawCalls: return "DrawCalls";
+    case PerfCounter::TrianglesSubmitted: return "TrianglesSubmitted";
+    case PerfCounter::RayDispatches: return "RayDispatches";
+    case PerfCounter::RaysDispatched: return "RaysDispatched";
+    case PerfCounter::UploadBytes: return "UploadBytes";
+    case PerfCounter::TlasBuilds: return "TlasBuilds";
+    case PerfCounter::RedundantStateCalls: return "RedundantStateCalls";
+    default: return "Unknown PerfCounter";
+    }
+}
+
+enum class PerfGauge
+{
+    UploadBufferBytes,
+    CbvSrvUavDescriptorsInUse,
+    SamplerDescriptorsInUse,
+    RtvDescriptorsInUse,
+    DsvDescriptorsInUse,
+    TlasInstances,
+    ShaderTableRecordsInUse,
+    ShaderTableRecordCapacity,
+    PendingFreeObjects,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(PerfGauge gauge)
+{
+    switch(gauge)
+    {
+    case PerfGauge::UploadBufferBytes: return "UploadBufferBytes";
+    case PerfGauge::CbvSrvUavDescriptorsInUse: return "CbvSrvUavDescriptorsInUse";
+    case PerfGauge::SamplerDescriptorsInUse: return "SamplerDescriptorsInUse";
+    case PerfGauge::RtvDescriptorsInUse: return "RtvDescriptorsInUse";
+    case PerfGauge::DsvDescriptorsInUse: return "DsvDescriptorsInUse";
+    case PerfGauge::TlasInstances: return "TlasInstances";
+    case PerfGauge::ShaderTableRecordsInUse: return "ShaderTableRecordsInUse";
+    case PerfGauge::ShaderTableRecordCapacity: return "ShaderTableRecordCapacity";
+    case PerfGauge::PendingFreeObjects: return "PendingFreeObjects";
+    default: return "Unknown PerfGauge";
+    }
+}
+
+class PerfCounters
+{
+public:
+    static constexpr uint32_t kShardCount = 16;
+
+    PerfCounters() = delete;
+
+    static void add(PerfCounter counter, uint64_t value = 1)
+    {
+#if SCRAP_PERF_COUNTERS_ENABLED
+        sShards[tShardIndex].counters[ToUnderlying(counter)].fetch_add(value, std::memory_order_relaxed);
+#else
+        (void)counter;
+        (void)value;
+#endif
+    }
+
+    static void addToGauge(PerfGauge gauge, int64_t delta)
+    {
+#if SCRAP_PERF_COUNTERS_ENABLED
+        sGauges[ToUnderlying(gauge)].fetch_add(delta, std::memory_order_relaxed);
+#else
+        (void)gauge;
+        (void)delta;
+#endif
+    }
+
+    [[nodiscard]] static int64_t getGauge(PerfGauge gauge)
+    {
+        return sGauges[ToUnderlying(gauge)].load(std::memory_order_relaxed);
+    }
+
+    // Adds up the shards of every counter and resets them to 0
+    [[nodiscard]] static EnumArray<uint64_t, PerfCounter> collectCounters();
+    [[nodiscard]] static EnumArray<int64_t, PerfGauge> readGauges();
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, ToUnderlying(PerfCounter::Count)> counters{};
+    };
+
+    static std::array<Shard, kShardCount> sShards;
+    static std::array<std::atomic<int64_t>, ToUnderlying(PerfGauge::Count)> sGauges;
+    static std::atomic<uint32_t> sNextShardIndex;
+
+    thread_local static uint32_t tShardIndex;
+};
+
+class PerfGaugeContribution
+{
+public:
+    explicit PerfGaugeContribution(PerfGauge gauge): mGauge(gauge) {}
+    PerfGaugeContribution(const PerfGaugeContribution&) = delete;
+    PerfGaugeContribution(PerfGaugeContribution&& other) noexcept
+        : mGauge(other.mGauge)
+        , mValue(other.mValue)
+    {
+        other.mValue = 0;
+    }
+    ~PerfGaugeContribution() { set(0); }
+
+    PerfGaugeContribution& operator=(const PerfGaugeContribution&) = delete;
+    PerfGaugeContribution& operator=(PerfGaugeContribution&& other) noexcept
+    {
+        if(this == &other) { return *this; }
+
+        set(0);
+        mGauge = other.mGauge;
+        mValue = other.mValue;
+        other.mValue = 0;
+        return *this;
+    }
+
+    // Not thread safe. The owner has to serialize the calls, which it usually already does for the amount it reports.
+    void set(int64_t value)
+    {
+        if(value == mValue) { return; }
+
+        PerfCounters::addToGauge(mGauge, value - mValue);
+        mValue = value;
+    }
+
+    [[nodiscard]] int64_t get() const { return mValue; }
+
+private:
+    PerfGauge mGauge;
+    int64_t mValue = 0;
+};
+
+struct PerfFrameSnapshot
+{
+    uint64_t frameNumber = 0;
+    EnumArray<uint64_t, PerfCounter> counters{};
+    EnumArray<int64_t, PerfGauge> gauges{};
+};
+
+struct PerfCounterRecorderParams
+{
+    // Logs the snapshot of every reportInterval'th frame. 0 disables the report.
+    uint32_t reportInterval = 0;
+
+    // An empty path disables the file
+    std::filesystem::path filePath;
+    uint64_t maxFileByteSize = 64 * 1024 * 1024;
+
+    uint32_t historyFrameCount = 600;
+};
+
+class PerfCounterRecorder
+{
+public:
+    explicit PerfCounterRecorder(const PerfCounterRecorderParams& params);
+    PerfCounterRecorder(const PerfCounterRecorder&) = delete;
+    PerfCounterRecorder(PerfCounterRecorder&&) = delete;
+    ~PerfCounterRecorder() = default;
+
+    PerfCounterRecorder& operator=(const PerfCounterRecorder&) = delete;
+    PerfCounterRecorder& operator=(PerfCounterRecorder&&) = delete;
+
+    // Called once per frame by the thread that runs the frame loop
+    void endFrame(uint64_t frameNumber);
+
+    // Oldest first. index has to be less than getHistorySize().
+    [[nodiscard]] const PerfFrameSnapshot& getHistorySnapshot(size_t index) const
+    {
+        return mHistory[(mHistoryStart + index) % mHistory.size()];
+    }
+    [[nodiscard]] size_t getHistorySize() const { return mHistory.size(); }
+
+    void logSnapshot(const PerfFrameSnapshot& snapshot) const;
+
+private:
+    enum class FileFormat
+    {
+        Csv,
+        JsonLines,
+    };
+
+    void openFile();
+    void writeSnapshot(const PerfFrameSnapshot& snapshot);
+
+    PerfCounterRecorderParams mParams;
+
+    std::vector<PerfFrameSnapshot> mHistory;
+    size_t mHistoryStart = 0;
+
+    FileFormat mFileFormat = FileFormat::Csv;
+    std::ofstream mFile;
+    uint64_t mFileByteSize = 0;
+};
+} // namespace scrap
@@ -0,0 +1,509 @@
+#include "PerfRegression.h"
+
+#include "CpuMesh.h"
+#include "FormattedBuffer.h"
+#include "FreeBlockTracker.h"
+#include "GpuEventLabels.h"
+#include "LinearBufferAllocator.h"
+#include "PrimitiveMesh.h"
+#include "RenderGraph.h"
+#include "SceneBenchmark.h"
+#include "SharedString.h"
+#include "StringHash.h"
+#include "TransientResourcePlanner.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <random>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+// Written at the end of every iteration, so the compiler can't drop the work whose result goes into it
+volatile uint64_t sSink = 0;
+
+// Times sampleCount + 1 batches of iterationCount calls. The first batch is the warm up and isn't returned.
+template<class FunctionT>
+std::vector<double> SampleBenchmark(uint32_t sampleCount, uint32_t iterationCount, FunctionT&& function)
+{
+    std::vector<double> samples;
+    samples.reserve(sampleCount);
+
+    for(uint32_t batch = 0; batch <= sampleCount; ++batch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            function();
+        }
+        const std::chrono::duration<double, std::nano> batchTime = std::chrono::steady_clock::now() - start;
+
+        if(batch > 0) { samples.push_back(batchTime.count() / (double)iterationCount); }
+    }
+
+    return samples;
+}
+
+std::vector<std::string> MakeRandomStrings(size_t count, uint32_t seed)
+{
+    std::mt19937 randomEngine(seed);
+    std::uniform_int_distribution<size_t> lengthDistribution(4, 64);
+    std::uniform_int_distribution<int> charDistribution('a', 'z');
+
+    std::vector<std::string> strings(count);
+    for(std::string& string : strings)
+    {
+        string.resize(lengthDistribution(randomEngine));
+        for(char& character : string)
+        {
+            character = (char)charDistribution(randomEngine);
+        }
+    }
+
+    return strings;
+}
+
+// Reserves 512 ranges of 1 to 8 blocks and releases them in random order
+std::vector<double> BenchmarkFreeBlockTrackerReserveRelease(uint32_t sampleCount)
+{
+    constexpr size_t kRangeCount = 512;
+
+    std::mt19937 randomEngine(1);
+    std::uniform_int_distribution<size_t> sizeDistribution(1, 8);
+
+    std::vector<size_t> sizes(kRangeCount);
+    std::generate(sizes.begin(), sizes.end(), [&]() { return sizeDistribution(randomEngine); });
+
+    std::vector<size_t> releaseOrder(kRangeCount);
+    std::iota(releaseOrder.begin(), releaseOrder.end(), size_t(0));
+    std::shuffle(releaseOrder.begin(), releaseOrder.end(), randomEngine);
+
+    FreeBlockTracker tracker(4096);
+    std::vector<size_t> starts(kRangeCount);
+
+    return SampleBenchmark(sampleCount, 100, [&]() {
+        for(size_t i = 0; i < kRangeCount; ++i)
+        {
+            starts[i] = tracker.unsafeReserve(sizes[i]).value_or(0);
+        }
+
+        for(size_t i : releaseOrder)
+        {
+            tracker.unsafeRelease(starts[i], sizes[i]);
+        }
+
+        sSink = starts.back();
+    });
+}
+
+// Every other block is reserved. A reservation of 2 blocks searches all 2048 free ranges and fails, a reservation of 1
+// block takes the first range and its release puts it back.
+std::vector<double> BenchmarkFreeBlockTrackerFragmented(uint32_t sampleCount)
+{
+    constexpr size_t kCapacity = 4096;
+
+    FreeBlockTracker tracker(kCapacity);
+    for(size_t i = 0; i < kCapacity; ++i)
+    {
+        (void)tracker.unsafeReserve(1);
+    }
+
+    for(size_t i = 0; i < kCapacity; i += 2)
+    {
+        tracker.unsafeRelease(i, 1);
+    }
+
+    return SampleBenchmark(sampleCount, 1000, [&]() {
+        const bool reservedPair = tracker.unsafeReserve(2).has_value();
+
+        const size_t start = tracker.unsafeReserve(1).value_or(0);
+        tracker.unsafeRelease(start, 1);
+
+        sSink = start + (reservedPair ? 1 : 0);
+    });
+}
+
+// The UploadBufferPool's allocations of a frame with 8192 objects' constants
+std::vector<double> BenchmarkLinearBufferAllocator(uint32_t sampleCount)
+{
+    constexpr size_t kAllocationCount = 8192;
+    // An ObjectConstantBuffer rounded up to the constant buffer alignment
+    constexpr size_t kAllocationByteSize = 512;
+
+    LinearBufferAllocator allocator;
+    for(uint32_t i = 0; i < 4; ++i)
+    {
+        allocator.addBuffer(1024 * 1024);
+    }
+
+    return SampleBenchmark(sampleCount, 100, [&]() {
+        size_t offsetSum = 0;
+
+        for(size_t i = 0; i < kAllocationCount; ++i)
+        {
+            const std::optional<size_t> bufferIndex = allocator.findBuffer(kAllocationByteSize);
+            if(!bufferIndex.has_value()) { break; }
+
+            offsetSum += allocator.allocate(bufferIndex.value(), kAllocationByteSize);
+        }
+
+        allocator.reset();
+        sSink = offsetSum;
+    });
+}
+
+std::vector<double> BenchmarkStringHash(uint32_t sampleCount)
+{
+    const std::vector<std::string> strings = MakeRandomStrings(256, 2);
+
+    return SampleBenchmark(sampleCount, 1000, [&]() {
+        size_t hashes = 0;
+        for(const std::string& string : strings)
+        {
+            hashes ^= StringHash(std::string_view(string)).hashValue();
+        }
+
+        sSink = hashes;
+    });
+}
+
+// Allocates, copies and hashes every string and frees it again
+std::vector<double> BenchmarkSharedStringConstruct(uint32_t sampleCount)
+{
+    const std::vector<std::string> strings = MakeRandomStrings(256, 3);
+
+    std::vector<SharedString> sharedStrings;
+    sharedStrings.reserve(strings.size());
+
+    return SampleBenchmark(sampleCount, 100, [&]() {
+        for(const std::string& string : strings)
+        {
+            sharedStrings.emplace_back(std::string_view(string));
+        }
+
+        sSink = sharedStrings.back().size();
+        sharedStrings.clear();
+    });
+}
+
+// Copies bump the reference count, comparisons compare the hashes first
+std::vector<double> BenchmarkSharedStringCopyCompare(uint32_t sampleCount)
+{
+    const std::vector<std::string> strings = MakeRandomStrings(256, 4);
+
+    std::vector<SharedString> sharedStrings;
+    sharedStrings.reserve(strings.size());
+    for(const std::string& string : strings)
+    {
+        sharedStrings.emplace_back(std::string_view(string));
+    }
+
+    return SampleBenchmark(sampleCount, 1000, [&]() {
+        size_t equalCount = 0;
+
+        for(size_t i = 0; i < sharedStrings.size(); ++i)
+        {
+            const SharedString copy = sharedStrings[i];
+            if(copy == sharedStrings[(i * 7) % sharedStrings.size()]) { ++equalCount; }
+        }
+
+        sSink = equalCount;
+    });
+}
+
+std::vector<double> BenchmarkFormattedBufferElementAccess(uint32_t sampleCount)
+{
+    constexpr size_t kElementCount = 4096;
+
+    std::vector<std::byte> bytes(kElementCount * 3 * sizeof(float));
+    for(size_t i = 0; i < kElementCount * 3; ++i)
+    {
+        const float value = (float)i;
+        std::memcpy(bytes.data() + i * sizeof(float), &value, sizeof(value));
+    }
+
+    const FormattedBufferSpan buffer{gpufmt::Format::R32G32B32_SFLOAT, bytes};
+
+    return SampleBenchmark(sampleCount, 100, [&]() {
+        float sum = 0.0f;
+
+        const size_t elementCount = buffer.elementCount();
+        for(size_t i = 0; i < elementCount; ++i)
+        {
+            float x;
+            std::memcpy(&x, buffer.getElement(i).data(), sizeof(x));
+            sum += x;
+        }
+
+        sSink = (uint64_t)sum;
+    });
+}
+
+// Generates the geometry of a cube with 16 subdivisions into buffers that already exist
+std::vector<double> BenchmarkPrimitiveMeshGenerateCube(uint32_t sampleCount)
+{
+    constexpr uint32_t kSubdivisions = 16;
+
+    CpuMesh mesh = GenerateCubeMesh(CubeMeshTopologyType::Triangle, kSubdivisions);
+    PrimitiveMesh3dParams params(mesh);
+
+    return SampleBenchmark(sampleCount, 20, [&]() {
+        const MeshSizes sizes = GenerateCubeMeshTris(params, kSubdivisions);
+        sSink = sizes.vertexCount;
+    });
+}
+
+// Creates the index buffer and vertex elements of a cube with 16 subdivisions, without generating its geometry
+std::vector<double> BenchmarkCpuMeshBuild(uint32_t sampleCount)
+{
+    const MeshSizes sizes = CalculateCubeMeshSizes(CubeMeshTopologyType::Triangle, 16);
+
+    return SampleBenchmark(sampleCount, 100, [&]() {
+        CpuMesh mesh(PrimitiveTopology::TriangleList);
+        mesh.initIndices(IndexBufferFormat::UInt16, sizes.indexCount);
+        mesh.createVertexElement(ShaderVertexSemantic::Position, 0, gpufmt::Format::R32G32B32_SFLOAT,
+                                 sizes.vertexCount);
+        mesh.createVertexElement(ShaderVertexSemantic::Normal, 0, gpufmt::Format::R32G32B32_SFLOAT,
+                                 sizes.vertexCount);
+        mesh.createVertexElement(ShaderVertexSemantic::Tangent, 0, gpufmt::Format::R32G32B32_SFLOAT,
+                                 sizes.vertexCount);
+        mesh.createVertexElement(ShaderVertexSemantic::Binormal, 0, gpufmt::Format::R32G32B32_SFLOAT,
+                                 sizes.vertexCount);
+        mesh.createVertexElement(ShaderVertexSemantic::TexCoord, 0, gpufmt::Format::R32G32_SFLOAT,
+                                 sizes.vertexCount);
+
+        sSink = mesh.getVertexElements().size();
+    });
+}
+
+std::vector<double> BenchmarkSceneModelFrame(uint32_t sampleCount, uint32_t objectCount)
+{
+    SceneBenchmarkScene scene(objectCount, 1);
+    uint32_t frameIndex = 0;
+
+    return SampleBenchmark(sampleCount, 1, [&]() {
+        (void)scene.runFrame(frameIndex++);
+        sSink = frameIndex;
+    });
+}
+
+// A graph shaped like a frame with many passes: every pass writes its own target and reads the targets of a few
+// earlier passes, every eighth pass reads and writes a shared unordered access buffer and the last pass writes the
+// imported back buffer. The passes whose targets nothing reads are culled. Returns the shared buffer.
+RenderGraphResourceHandle BuildRenderGraphBenchmark(RenderGraph& graph, uint32_t passCount)
+{
+    std::mt19937 randomEngine(31);
+
+    const RenderGraphResourceHandle backBuffer =
+        graph.importResource("BackBuffer", ResourceState::Present, ResourceState::Present);
+    const RenderGraphResourceHandle sharedBuffer = graph.createResource("SharedBuffer");
+
+    std::vector<RenderGraphResourceHandle> targets;
+    targets.reserve(passCount);
+
+    for(uint32_t passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        RenderGraphPassBuilder pass = graph.addPass(fmt::format("Pass {}", passIndex), {});
+
+        for(uint32_t readIndex = 0; readIndex < 3 && !targets.empty(); ++readIndex)
+        {
+            std::uniform_int_distribution<size_t> targetDistribution(targets.size() > 16 ? targets.size() - 16 : 0,
+                                                                     targets.size() - 1);
+            pass.read(targets[targetDistribution(randomEngine)], ResourceState::PixelShaderResource);
+        }
+
+        if(passIndex % 8 == 0) { pass.write(sharedBuffer, ResourceState::UnorderedAccess); }
+
+        if(passIndex + 1 == passCount) { pass.write(backBuffer, ResourceState::RenderTarget); }
+        else
+        {
+            targets.push_back(graph.createResource(fmt::format("Target {}", passIndex)));
+            pass.write(targets.back(), ResourceState::RenderTarget);
+        }
+    }
+
+    return sharedBuffer;
+}
+
+// Culls, orders and builds the barriers of the graph. The graph is built once, compile is what runs every frame.
+std::vector<double> BenchmarkRenderGraphCompile(uint32_t sampleCount, uint32_t passCount)
+{
+    RenderGraph graph;
+    BuildRenderGraphBenchmark(graph, passCount);
+
+    return SampleBenchmark(sampleCount, 10, [&]() {
+        (void)graph.compile();
+        sSink = graph.getTotalBarrierCount();
+    });
+}
+
+constexpr uint64_t kTransientTargetByteSize = 1920 * 1080 * 4;
+constexpr uint64_t kTransientBufferByteSize = 1024 * 1024;
+constexpr uint64_t kTransientPlacementAlignment = 64 * 1024;
+
+// Requests the memory of every resource the compiled graph creates and uses. The targets are sized like 1080p RGBA8
+// render targets and the shared buffer like a 1 MiB buffer.
+void AddRenderGraphTransients(const RenderGraph& graph,
+                              RenderGraphResourceHandle sharedBuffer,
+                              TransientResourcePlanner& planner)
+{
+    for(uint32_t resourceIndex = 0; resourceIndex < graph.getResourceCount(); ++resourceIndex)
+    {
+        const RenderGraphResourceHandle resource(resourceIndex);
+        if(graph.isResourceImported(resource)) { continue; }
+
+        const std::optional<RenderGraphResourceLifetime> lifetime = graph.getResourceLifetime(resource);
+        if(!lifetime.has_value()) { continue; }
+
+        const bool isBuffer = (resource == sharedBuffer);
+        planner.addResource(TransientResourceRequest{
+            .name = graph.getResourceName(resource),
+            .byteSize = isBuffer ? kTransientBufferByteSize : kTransientTargetByteSize,
+            .alignment = kTransientPlacementAlignment,
+            .heapType = isBuffer ? TransientHeapType::Buffer : TransientHeapType::RenderTargetTexture,
+            .firstPass = lifetime->firstPosition,
+            .lastPass = lifetime->lastPosition});
+    }
+}
+
+// Plans the transient memory of the RenderGraph/Compile graph. The requests are added once, plan is what runs every
+// frame.
+std::vector<double> BenchmarkTransientResourcePlan(uint32_t sampleCount, uint32_t passCount)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle sharedBuffer = BuildRenderGraphBenchmark(graph, passCount);
+    (void)graph.compile();
+
+    TransientResourcePlanner planner;
+    AddRenderGraphTransients(graph, sharedBuffer, planner);
+
+    return SampleBenchmark(sampleCount, 10, [&]() {
+        planner.plan();
+        sSink = planner.getStats().aliasedByteSize;
+    });
+}
+
+constexpr uint32_t kGpuEventLabelObjectCount = 100000;
+
+// The per object labels the raytracing renderer used to format every frame
+std::vector<double> BenchmarkGpuEventLabelFormat(uint32_t sampleCount)
+{
+    const std::string_view name = "Cube";
+    std::string label;
+
+    return SampleBenchmark(sampleCount, 1, [&]() {
+        for(uint32_t objectId = 0; objectId < kGpuEventLabelObjectCount; ++objectId)
+        {
+            label.clear();
+            fmt::format_to(std::back_inserter(label), "{} {}", name, objectId);
+            sSink = label.size();
+        }
+    });
+}
+
+// The same labels from the cache, which is what a frame pays with the per object events turned on
+std::vector<double> BenchmarkGpuEventLabelCached(uint32_t sampleCount)
+{
+    const std::string_view name = "Cube";
+    GpuEventLabelCache labelCache;
+
+    return SampleBenchmark(sampleCount, 1, [&]() {
+        for(uint32_t objectId = 0; objectId < kGpuEventLabelObjectCount; ++objectId)
+        {
+            sSink = labelCache.getObjectLabel(objectId, name).size();
+        }
+    });
+}
+
+struct PerfBenchmark
+{
+    std::string_view name;
+    std::vector<double> (*run)(uint32_t sampleCount);
+};
+
+const std::array kBenchmarks{
+    PerfBenchmark{"FreeBlockTracker/ReserveRelease", &BenchmarkFreeBlockTrackerReserveRelease},
+    PerfBenchmark{"FreeBlockTracker/Fragmented", &BenchmarkFreeBlockTrackerFragmented},
+    PerfBenchmark{"LinearBufferAllocator/Allocate", &BenchmarkLinearBufferAllocator},
+    PerfBenchmark{"StringHash/Hash", &BenchmarkStringHash},
+    PerfBenchmark{"SharedString/Construct", &BenchmarkSharedStringConstruct},
+    PerfBenchmark{"SharedString/CopyCompare", &BenchmarkSharedStringCopyCompare},
+    PerfBenchmark{"FormattedBuffer/ElementAccess", &BenchmarkFormattedBufferElementAccess},
+    PerfBenchmark{"PrimitiveMesh/GenerateCube", &BenchmarkPrimitiveMeshGenerateCube},
+    PerfBenchmark{"CpuMesh/Build", &BenchmarkCpuMeshBuild},
+    PerfBenchmark{"GpuEventLabels/Format100k", &BenchmarkGpuEventLabelFormat},
+    PerfBenchmark{"GpuEventLabels/Cached100k", &BenchmarkGpuEventLabelCached},
+    PerfBenchmark{"SceneModel/Frame1k",
+                  [](uint32_t sampleCount) { return BenchmarkSceneModelFrame(sampleCount, 1000); }},
+    PerfBenchmark{"SceneModel/Frame10k",
+                  [](uint32_t sampleCount) { return BenchmarkSceneModelFrame(sampleCount, 10000); }},
+    PerfBenchmark{"RenderGraph/Compile512",
+                  [](uint32_t sampleCount) { return BenchmarkRenderGraphCompile(sampleCount, 512); }},
+    PerfBenchmark{"TransientResourcePlanner/Plan512",
+                  [](uint32_t sampleCount) { return BenchmarkTransientResourcePlan(sampleCount, 512); }},
+};
+
+} // namespace
+
+std::vector<PerfBenchmarkSamples> RunPerfRegressionSuite(const PerfRegressionParams& params)
+{
+    std::vector<PerfBenchmarkSamples> benchmarks;
+
+    for(const PerfBenchmark& benchmark : kBenchmarks)
+    {
+        if(!params.filter.empty() && benchmark.name.find(params.filter) == std::string_view::npos) { continue; }
+
+        spdlog::info("Running {}", benchmark.name);
+        benchmarks.push_back(PerfBenchmarkSamples{std::string(benchmark.name), benchmark.run(params.sampleCount)});
+    }
+
+    return benchmarks;
+}
+
+void LogPerfBenchmarks(const std::vector<PerfBenchmarkSamples>& benchmarks)
+{
+    spdlog::info("Perf regression benchmarks, nanoseconds per iteration");
+
+    for(const PerfBenchmarkSamples& benchmark : benchmarks)
+    {
+        if(benchmark.samples.empty()) { continue; }
+
+        const auto [minItr, maxItr] = std::minmax_element(benchmark.samples.begin(), benchmark.samples.end());
+        spdlog::info("    {:<32} median {:.1f}, min {:.1f}, max {:.1f} ({} samples)", benchmark.name,
+                     PerfSampleMedian(benchmark.samples), *minItr, *maxItr, benchmark.samples.size());
+    }
+}
+
+void LogTransientMemoryReport(uint32_t passCount)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle sharedBuffer = BuildRenderGraphBenchmark(graph, passCount);
+    if(std::optional<RenderGraphError> error = graph.compile(); error.has_value())
+    {
+        spdlog::error("The {} pass benchmark graph didn't compile. {}", passCount, ToStringView(error.value()));
+        return;
+    }
+
+    TransientResourcePlanner planner;
+    AddRenderGraphTransients(graph, sharedBuffer, planner);
+    planner.plan();
+
+    constexpr double kMebibyte = 1024.0 * 1024.0;
+    const TransientMemoryStats& stats = planner.getStats();
+    spdlog::info("Transient memory of the {} pass benchmark graph, {} resources", passCount,
+                 planner.getResourceCount());
+    spdlog::info("    without aliasing {:.1f} MiB", (double)stats.unaliasedByteSize / kMebibyte);
+    spdlog::info("    with aliasing    {:.1f} MiB in {} heaps, {} aliasing barriers",
+                 (double)stats.aliasedByteSize / kMebibyte, planner.getHeaps().size(),
+                 planner.getAliasingBarriers().size());
+    spdlog::info("    peak live        {:.1f} MiB", (double)stats.peakLiveByteSize / kMebibyte);
+}
+} // namespace scrap
@@ -0,0 +1,44 @@
+// Cpu performance regression suite. Runs a fixed set of benchmarks, writes their samples to a json baseline and
+// compares a later run against it.
+//
+// Benchmarks:
+//   FreeBlockTracker/ReserveRelease, FreeBlockTracker/Fragmented, LinearBufferAllocator/Allocate (the allocation logic
+//   of the UploadBufferPool), StringHash/Hash, SharedString/Construct, SharedString/CopyCompare,
+//   FormattedBuffer/ElementAccess, PrimitiveMesh/GenerateCube, CpuMesh/Build, GpuEventLabels/Format100k and
+//   GpuEventLabels/Cached100k (the per object gpu event labels of 100k objects, formatted every frame and cached),
+//   SceneModel/Frame1k and SceneModel/Frame10k (a SceneBenchmarkScene frame, the render scene's per object cpu work
+//   that runs without a device, not RenderScene itself), RenderGraph/Compile512 (compiling a 512 pass graph) and
+//   TransientResourcePlanner/Plan512 (planning the memory of that graph's transient resources). Every benchmark runs a
+//   fixed scenario with fixed seeds, so two runs do the same work.
+//
+// Every sample is the time of a batch of iterations divided by the iteration count, in nanoseconds. A batch is long
+// enough that the clock resolution doesn't matter. The first batch warms the caches up and isn't kept.
+//
+// The samples are compared against a baseline with the functions in PerfBaseline.h.
+
+#pragma once
+
+#include "PerfBaseline.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scrap
+{
+struct PerfRegressionParams
+{
+    uint32_t sampleCount = 30;
+    // Only runs the benchmarks whose name contains the filter. Empty runs all of them.
+    std::string filter;
+
+    PerfComparisonParams comparison;
+};
+
+[[nodiscard]] std::vector<PerfBenchmarkSamples> RunPerfRegressionSuite(const PerfRegressionParams& params);
+
+void LogPerfBenchmarks(const std::vector<PerfBenchmarkSamples>& benchmarks);
+// Plans the transient resources of the RenderGraph/Compile benchmark graph and logs their memory with and without
+// aliasing
+void LogTransientMemoryReport(uint32_t passCount);
+} // namespace scrap
@@ -0,0 +1,130 @@
+// Entry point of the PerfRegression console program. Runs the perf regression suite and compares it to a baseline.
+//
+// PerfRegression [-samples <count>] [-filter <text>] [-baseline <file>] [-writebaseline <file>] [-threshold <percent>]
+//                [-significance <p>] [-transientmemory]
+//   -samples <count> takes count samples of every benchmark, 30 by default.
+//   -filter <text> only runs the benchmarks whose name contains text.
+//   -baseline <file> compares the run against the baseline json file.
+//   -writebaseline <file> writes the run to file, to compare later runs against.
+//   -threshold <percent> is the slowdown of the median that counts as a regression, 5 by default.
+//   -significance <p> is the p value below which the Mann-Whitney test says the runs differ, 0.01 by default.
+//   -transientmemory logs the transient resource memory of the 512 pass render graph benchmark, with and without
+//   aliasing.
+//
+// Exits with 1 if a benchmark regressed against the baseline and with 2 if the baseline couldn't be read or written.
+
+#include "PerfRegression.h"
+
+#include <array>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+#include <spdlog/sinks/msvc_sink.h>
+#include <spdlog/sinks/stdout_sinks.h>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+constexpr int kExitRegression = 1;
+constexpr int kExitBaselineError = 2;
+
+// Returns the argument following args[index], if there is one
+std::string_view ParseOptionalValue(std::span<char*> args, size_t index)
+{
+    if(index + 1 >= args.size() || args[index + 1][0] == '-') { return {}; }
+    return args[index + 1];
+}
+
+uint32_t ParseOptionalCount(std::span<char*> args, size_t index, uint32_t defaultValue)
+{
+    if(index + 1 >= args.size() || args[index + 1][0] == '-') { return defaultValue; }
+    return (uint32_t)std::strtoul(args[index + 1], nullptr, 10);
+}
+
+double ParseOptionalDouble(std::span<char*> args, size_t index, double defaultValue)
+{
+    if(index + 1 >= args.size() || args[index + 1][0] == '-') { return defaultValue; }
+    return std::strtod(args[index + 1], nullptr);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::shared_ptr<spdlog::logger> scrapLogger;
+    {
+        // setup a logger for the Visual Studio output window and for standard console out
+        std::array<spdlog::sink_ptr, 2> sinks;
+        sinks[0] = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+        sinks[1] = std::make_shared<spdlog::sinks::msvc_sink_mt>();
+
+        scrapLogger = std::make_shared<spdlog::logger>("scrap", std::begin(sinks), std::end(sinks));
+        spdlog::set_default_logger(scrapLogger);
+    }
+
+    scrap::PerfRegressionParams params;
+    std::string_view baselinePath;
+    std::string_view writeBaselinePath;
+    bool logTransientMemory = false;
+    {
+        std::span<char*> args(argv, (size_t)argc);
+
+        for(size_t i = 1; i < args.size(); ++i)
+        {
+            const std::string_view arg = args[i];
+            if(arg == "-samples") { params.sampleCount = ParseOptionalCount(args, i, params.sampleCount); }
+            else if(arg == "-filter") { params.filter = ParseOptionalValue(args, i); }
+            else if(arg == "-baseline") { baselinePath = ParseOptionalValue(args, i); }
+            else if(arg == "-writebaseline") { writeBaselinePath = ParseOptionalValue(args, i); }
+            else if(arg == "-threshold")
+            {
+                params.comparison.thresholdPercent = ParseOptionalDouble(args, i, params.comparison.thresholdPercent);
+            }
+            else if(arg == "-significance")
+            {
+                params.comparison.significance = ParseOptionalDouble(args, i, params.comparison.significance);
+            }
+            else if(arg == "-transientmemory") { logTransientMemory = true; }
+        }
+    }
+
+    // Read the baseline first, a missing file shouldn't cost a whole run
+    std::optional<std::vector<scrap::PerfBenchmarkSamples>> baseline;
+    if(!baselinePath.empty())
+    {
+        baseline = scrap::ReadPerfBaseline(baselinePath);
+        if(!baseline.has_value())
+        {
+            scrapLogger->flush();
+            return kExitBaselineError;
+        }
+    }
+
+    const std::vector<scrap::PerfBenchmarkSamples> benchmarks = scrap::RunPerfRegressionSuite(params);
+    scrap::LogPerfBenchmarks(benchmarks);
+
+    if(logTransientMemory) { scrap::LogTransientMemoryReport(512); }
+
+    int exitCode = 0;
+
+    if(baseline.has_value())
+    {
+        const std::vector<scrap::PerfComparison> comparisons =
+            scrap::ComparePerfRuns(baseline.value(), benchmarks, params.comparison);
+        scrap::LogPerfComparisons(comparisons);
+
+        for(const scrap::PerfComparison& comparison : comparisons)
+        {
+            if(comparison.verdict == scrap::PerfVerdict::Regression) { exitCode = kExitRegression; }
+        }
+    }
+
+    if(!writeBaselinePath.empty() && !scrap::WritePerfBaseline(writeBaselinePath, benchmarks))
+    {
+        exitCode = kExitBaselineError;
+    }
+
+    scrapLogger->flush();
+
+    return exitCode;
+}
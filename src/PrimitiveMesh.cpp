@@ -1,6 +1,7 @@
 #include "PrimitiveMesh.h"
 
 #include "AABB.h"
+#include "MemoryTracker.h"
 
 #include <glm/common.hpp>
 #include <gpufmt/write.h>
@@ -286,6 +287,8 @@ MeshSizes GenerateCubeMesh(CubeMeshTopologyType topologyType,
 
 CpuMesh GenerateCubeMesh(CubeMeshTopologyType topologyType, uint32_t subdivisions, glm::vec3 offset, glm::vec3 size)
 {
+    SCRAP_MEMORY_TAG(Mesh);
+
     MeshSizes meshSizes = CalculateCubeMeshSizes(topologyType, subdivisions);
 
     CpuMesh cubeMesh(GetCubeMeshPrimitiveTopology(topologyType));
@@ -0,0 +1,231 @@
+#include "QueueScheduler.h"
+
+#include "EnumIterator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint32_t kNoWork = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kNoBatch = std::numeric_limits<uint32_t>::max();
+} // namespace
+
+void QueueScheduler::reset()
+{
+    mWork.clear();
+    mBatches.clear();
+    mWaits.clear();
+    mBatchWork.clear();
+    std::fill(mSignalCounts.begin(), mSignalCounts.end(), 0u);
+    mCoveredDependencyCount = 0;
+    mHasInvalidWorkIndex = false;
+    mCompiled = false;
+}
+
+uint32_t QueueScheduler::addWork(std::string_view name, CommandQueueType queue)
+{
+    Work& work = mWork.emplace_back();
+    work.name = name;
+    work.requestedQueue = queue;
+    mCompiled = false;
+
+    return (uint32_t)mWork.size() - 1;
+}
+
+void QueueScheduler::addDependency(uint32_t work, uint32_t dependency)
+{
+    mCompiled = false;
+
+    if(work >= mWork.size())
+    {
+        // Reported by compile
+        mHasInvalidWorkIndex = true;
+        return;
+    }
+
+    mWork[work].dependencies.push_back(dependency);
+}
+
+std::optional<QueueSchedulerError> QueueScheduler::compile(const CompileOptions& options)
+{
+    mCompiled = false;
+    mBatches.clear();
+    mWaits.clear();
+    mBatchWork.clear();
+    std::fill(mSignalCounts.begin(), mSignalCounts.end(), 0u);
+    mCoveredDependencyCount = 0;
+
+    if(auto error = validateDependencies(); error.has_value()) { return error; }
+
+    for(Work& work : mWork)
+    {
+        work.queue = (!options.asyncCompute && work.requestedQueue == CommandQueueType::Compute)
+                         ? CommandQueueType::Graphics
+                         : work.requestedQueue;
+        work.waitedOnWork.clear();
+        work.needsSignal = false;
+        work.signalValue = 0;
+    }
+
+    resolveWaits();
+    buildBatches();
+
+    mCompiled = true;
+    return std::nullopt;
+}
+
+std::optional<QueueSchedulerError> QueueScheduler::validateDependencies() const
+{
+    if(mHasInvalidWorkIndex) { return QueueSchedulerError::InvalidWorkIndex; }
+
+    for(uint32_t workIndex = 0; workIndex < (uint32_t)mWork.size(); ++workIndex)
+    {
+        for(uint32_t dependency : mWork[workIndex].dependencies)
+        {
+            if(dependency >= mWork.size()) { return QueueSchedulerError::InvalidWorkIndex; }
+
+            // Work is submitted in the order it was added, so a dependency on later work can never be satisfied
+            if(dependency >= workIndex) { return QueueSchedulerError::ForwardDependency; }
+        }
+    }
+
+    return std::nullopt;
+}
+
+void QueueScheduler::resolveWaits()
+{
+    EnumArray<int64_t, CommandQueueType> nextPositions{};
+
+    // How far each queue knows every other queue has progressed, through waits it has already done
+    EnumArray<QueuePositions, CommandQueueType> queueKnownPositions;
+    for(QueuePositions& knownPositions : queueKnownPositions)
+    {
+        std::fill(knownPositions.begin(), knownPositions.end(), -1);
+    }
+
+    for(uint32_t workIndex = 0; workIndex < (uint32_t)mWork.size(); ++workIndex)
+    {
+        Work& work = mWork[workIndex];
+        QueuePositions& knownPositions = queueKnownPositions[work.queue];
+
+        work.position = nextPositions[work.queue]++;
+
+        // Only the latest producer on each queue matters. Queues execute in order, so it finishing means all of the
+        // earlier producers on the same queue have finished too.
+        EnumArray<uint32_t, CommandQueueType> latestProducers;
+        std::fill(latestProducers.begin(), latestProducers.end(), kNoWork);
+        uint32_t crossQueueDependencyCount = 0;
+
+        for(uint32_t dependency : work.dependencies)
+        {
+            const Work& producer = mWork[dependency];
+            if(producer.queue == work.queue) { continue; }
+
+            ++crossQueueDependencyCount;
+
+            uint32_t& latestProducer = latestProducers[producer.queue];
+            if(latestProducer == kNoWork || producer.position > mWork[latestProducer].position)
+            {
+                latestProducer = dependency;
+            }
+        }
+
+        // A producer doesn't need its own wait if this queue already synchronized past it, or if waiting on one of the
+        // other producers covers it.
+        auto isCovered = [&](uint32_t producerIndex) {
+            const Work& producer = mWork[producerIndex];
+            if(producer.position <= knownPositions[producer.queue]) { return true; }
+
+            return std::any_of(latestProducers.cbegin(), latestProducers.cend(), [&](uint32_t otherProducerIndex) {
+                return otherProducerIndex != kNoWork && otherProducerIndex != producerIndex &&
+                       mWork[otherProducerIndex].knownPositions[producer.queue] >= producer.position;
+            });
+        };
+
+        for(uint32_t producerIndex : latestProducers)
+        {
+            if(producerIndex == kNoWork || isCovered(producerIndex)) { continue; }
+
+            work.waitedOnWork.push_back(producerIndex);
+        }
+
+        for(uint32_t producerIndex : work.waitedOnWork)
+        {
+            Work& producer = mWork[producerIndex];
+            producer.needsSignal = true;
+
+            for(CommandQueueType queue : enumerate<CommandQueueType>())
+            {
+                knownPositions[queue] = std::max(knownPositions[queue], producer.knownPositions[queue]);
+            }
+        }
+
+        mCoveredDependencyCount += crossQueueDependencyCount - (uint32_t)work.waitedOnWork.size();
+
+        knownPositions[work.queue] = work.position;
+        work.knownPositions = knownPositions;
+    }
+
+    for(Work& work : mWork)
+    {
+        if(work.needsSignal) { work.signalValue = ++mSignalCounts[work.queue]; }
+    }
+}
+
+void QueueScheduler::buildBatches()
+{
+    // A batch is closed by a signal and a wait starts a new one. Batches are ordered by their first work, which means
+    // every producer's batch is submitted before the batches that wait on it.
+    EnumArray<uint32_t, CommandQueueType> openBatches;
+    std::fill(openBatches.begin(), openBatches.end(), kNoBatch);
+
+    for(Work& work : mWork)
+    {
+        uint32_t& openBatch = openBatches[work.queue];
+
+        if(openBatch == kNoBatch || !work.waitedOnWork.empty())
+        {
+            openBatch = (uint32_t)mBatches.size();
+
+            QueueBatch& batch = mBatches.emplace_back();
+            batch.queue = work.queue;
+            batch.firstWait = (uint32_t)mWaits.size();
+            batch.waitCount = (uint32_t)work.waitedOnWork.size();
+
+            for(uint32_t producerIndex : work.waitedOnWork)
+            {
+                const Work& producer = mWork[producerIndex];
+                mWaits.push_back(QueueWait{producer.queue, producer.signalValue});
+            }
+        }
+
+        work.batch = openBatch;
+        ++mBatches[openBatch].workCount;
+
+        if(work.needsSignal)
+        {
+            mBatches[openBatch].signalValue = work.signalValue;
+            openBatch = kNoBatch;
+        }
+    }
+
+    // Batches can be added to while other batches are being created, so their work is laid out afterwards
+    uint32_t workOffset = 0;
+    for(QueueBatch& batch : mBatches)
+    {
+        batch.firstWork = workOffset;
+        workOffset += batch.workCount;
+        batch.workCount = 0;
+    }
+
+    mBatchWork.resize(mWork.size());
+    for(uint32_t workIndex = 0; workIndex < (uint32_t)mWork.size(); ++workIndex)
+    {
+        QueueBatch& batch = mBatches[mWork[workIndex].batch];
+        mBatchWork[batch.firstWork + batch.workCount++] = workIndex;
+    }
+}
+} // namespace scrap
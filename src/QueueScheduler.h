@@ -0,0 +1,183 @@
+// QueueScheduler spreads a frame's work over the graphics, async compute and copy queues and works out the
+// cross-queue synchronization it needs. Work is added in submission order and tagged with the queue it should run on.
+// Dependencies always point at earlier work.
+//
+// compile() groups the work into per queue batches and only inserts a Wait where a dependency isn't already covered.
+// Dependencies on the same queue are ordered by the queue itself. For other queues, every queue keeps track of how far
+// it has already synchronized with each of the others, including everything it learned transitively through the
+// batches it waited on. A producer only gets a Signal if something actually waits on it. Signal values are relative
+// to the start of the schedule and count up from 1 on each queue.
+//
+// Nothing in here touches the device. Submitting the batches and their fence operations to the queues is done by
+// d3d12::QueueScheduleExecutor.
+
+#pragma once
+
+#include "EnumArray.h"
+#include "RenderDefs.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+enum class CommandQueueType
+{
+    Graphics,
+    Compute,
+    Copy,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(CommandQueueType queueType)
+{
+    switch(queueType)
+    {
+    case scrap::CommandQueueType::Graphics: return "Graphics";
+    case scrap::CommandQueueType::Compute: return "Compute";
+    case scrap::CommandQueueType::Copy: return "Copy";
+    default: return "Unknown CommandQueueType";
+    }
+}
+
+enum class QueueSchedulerError
+{
+    InvalidWorkIndex,
+    ForwardDependency,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(QueueSchedulerError error)
+{
+    switch(error)
+    {
+    case scrap::QueueSchedulerError::InvalidWorkIndex: return "InvalidWorkIndex";
+    case scrap::QueueSchedulerError::ForwardDependency: return "ForwardDependency";
+    default: return "Unknown QueueSchedulerError";
+    }
+}
+
+struct QueueWait
+{
+    CommandQueueType queue = CommandQueueType::Graphics; // The queue that signals
+    uint64_t signalValue = 0;
+};
+
+// Consecutive work on one queue that can be submitted together. The waits happen before the work executes and the
+// signal after it.
+struct QueueBatch
+{
+    CommandQueueType queue = CommandQueueType::Graphics;
+    uint32_t firstWait = 0;
+    uint32_t waitCount = 0;
+    uint32_t firstWork = 0;
+    uint32_t workCount = 0;
+    uint64_t signalValue = 0; // 0 if nothing waits on the batch
+};
+
+class QueueScheduler
+{
+public:
+    struct CompileOptions
+    {
+        // Compute work runs on the graphics queue when disabled, for hardware without a separate compute engine or for
+        // comparing against a serialized frame.
+        bool asyncCompute = true;
+    };
+
+    QueueScheduler() = default;
+    QueueScheduler(const QueueScheduler&) = delete;
+    QueueScheduler(QueueScheduler&&) = default;
+    ~QueueScheduler() = default;
+
+    QueueScheduler& operator=(const QueueScheduler&) = delete;
+    QueueScheduler& operator=(QueueScheduler&&) = default;
+
+    // Removes all work. Keeps the allocated memory so the schedule can be rebuilt every frame.
+    void reset();
+
+    // Returns the index of the work. Indices are handed out in the order work is added.
+    uint32_t addWork(std::string_view name, CommandQueueType queue);
+
+    // work can't start until dependency has finished. dependency has to be added before work.
+    void addDependency(uint32_t work, uint32_t dependency);
+
+    [[nodiscard]] std::optional<QueueSchedulerError> compile(const CompileOptions& options);
+    [[nodiscard]] std::optional<QueueSchedulerError> compile() { return compile(CompileOptions{}); }
+
+    [[nodiscard]] bool isCompiled() const { return mCompiled; }
+
+    [[nodiscard]] uint32_t getWorkCount() const { return (uint32_t)mWork.size(); }
+    [[nodiscard]] std::string_view getWorkName(uint32_t work) const { return mWork[work].name; }
+
+    // The queue the work runs on. Only differs from the requested queue after compile with async compute disabled.
+    [[nodiscard]] CommandQueueType getWorkQueue(uint32_t work) const { return mWork[work].queue; }
+
+    // Batches in the order they have to be submitted in. Only valid after compile.
+    [[nodiscard]] std::span<const QueueBatch> getBatches() const { return mBatches; }
+    [[nodiscard]] std::span<const QueueWait> getWaits(const QueueBatch& batch) const
+    {
+        return std::span<const QueueWait>(mWaits).subspan(batch.firstWait, batch.waitCount);
+    }
+    [[nodiscard]] std::span<const uint32_t> getWork(const QueueBatch& batch) const
+    {
+        return std::span<const uint32_t>(mBatchWork).subspan(batch.firstWork, batch.workCount);
+    }
+
+    // The number of signals the schedule needs on the queue. Signal values on the queue go from 1 to the count.
+    [[nodiscard]] uint32_t getSignalCount(CommandQueueType queue) const { return mSignalCounts[queue]; }
+    [[nodiscard]] size_t getTotalWaitCount() const { return mWaits.size(); }
+
+    // Cross-queue dependencies that didn't need a wait of their own because an earlier wait already covered them
+    [[nodiscard]] uint32_t getCoveredDependencyCount() const { return mCoveredDependencyCount; }
+
+private:
+    using QueuePositions = EnumArray<int64_t, CommandQueueType>;
+
+    struct Work
+    {
+        std::string name;
+        CommandQueueType requestedQueue = CommandQueueType::Graphics;
+        std::vector<uint32_t> dependencies;
+
+        // Compile state
+        CommandQueueType queue = CommandQueueType::Graphics;
+        int64_t position = 0; // Position on its queue
+        QueuePositions knownPositions; // How far each queue is known to have progressed once the work has finished
+        std::vector<uint32_t> waitedOnWork; // Producers on other queues the work has to wait for
+        bool needsSignal = false;
+        uint64_t signalValue = 0;
+        uint32_t batch = 0;
+    };
+
+    std::optional<QueueSchedulerError> validateDependencies() const;
+    void resolveWaits();
+    void buildBatches();
+
+    std::vector<Work> mWork;
+    bool mHasInvalidWorkIndex = false;
+
+    // Compile state. Kept as members so rebuilding the schedule every frame doesn't reallocate.
+    std::vector<QueueBatch> mBatches;
+    std::vector<QueueWait> mWaits;
+    std::vector<uint32_t> mBatchWork;
+    EnumArray<uint32_t, CommandQueueType> mSignalCounts{};
+    uint32_t mCoveredDependencyCount = 0;
+    bool mCompiled = false;
+};
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::CommandQueueType> : public scrap::ToStringViewFormatter<scrap::CommandQueueType>
+{};
+
+template<>
+struct fmt::formatter<scrap::QueueSchedulerError> : public scrap::ToStringViewFormatter<scrap::QueueSchedulerError>
+{};
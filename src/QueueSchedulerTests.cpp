@@ -0,0 +1,179 @@
+#include "QueueScheduler.h"
+#include "UnitTest.h"
+
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+std::vector<QueueWait> GetAllWaits(const QueueScheduler& scheduler)
+{
+    std::vector<QueueWait> waits;
+    for(const QueueBatch& batch : scheduler.getBatches())
+    {
+        const std::span<const QueueWait> batchWaits = scheduler.getWaits(batch);
+        waits.insert(waits.end(), batchWaits.begin(), batchWaits.end());
+    }
+
+    return waits;
+}
+} // namespace
+
+SCRAP_TEST(QueueScheduler, NoWaitsOnSameQueue)
+{
+    QueueScheduler scheduler;
+    const uint32_t depthPrepass = scheduler.addWork("DepthPrepass", CommandQueueType::Graphics);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    const uint32_t transparent = scheduler.addWork("Transparent", CommandQueueType::Graphics);
+    scheduler.addDependency(opaque, depthPrepass);
+    scheduler.addDependency(transparent, opaque);
+
+    SCRAP_REQUIRE(!scheduler.compile().has_value());
+
+    SCRAP_CHECK(scheduler.getTotalWaitCount() == 0);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Graphics) == 0);
+    SCRAP_REQUIRE(scheduler.getBatches().size() == 1);
+    SCRAP_CHECK(scheduler.getBatches()[0].signalValue == 0);
+    SCRAP_CHECK(scheduler.getBatches()[0].workCount == 3);
+}
+
+SCRAP_TEST(QueueScheduler, WaitsOnlyForLatestProducerOfQueue)
+{
+    QueueScheduler scheduler;
+    const uint32_t cull = scheduler.addWork("Cull", CommandQueueType::Compute);
+    const uint32_t particles = scheduler.addWork("Particles", CommandQueueType::Compute);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    scheduler.addDependency(opaque, cull);
+    scheduler.addDependency(opaque, particles);
+
+    SCRAP_REQUIRE(!scheduler.compile().has_value());
+
+    // The compute queue finishing Particles means Cull has finished too
+    const std::vector<QueueWait> waits = GetAllWaits(scheduler);
+    SCRAP_REQUIRE(waits.size() == 1);
+    SCRAP_CHECK(waits[0].queue == CommandQueueType::Compute);
+    SCRAP_CHECK(waits[0].signalValue == 1);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Compute) == 1);
+    SCRAP_CHECK(scheduler.getCoveredDependencyCount() == 1);
+}
+
+SCRAP_TEST(QueueScheduler, DropsWaitsCoveredByEarlierWait)
+{
+    QueueScheduler scheduler;
+    const uint32_t cull = scheduler.addWork("Cull", CommandQueueType::Compute);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    const uint32_t transparent = scheduler.addWork("Transparent", CommandQueueType::Graphics);
+    scheduler.addDependency(opaque, cull);
+    scheduler.addDependency(transparent, cull);
+
+    SCRAP_REQUIRE(!scheduler.compile().has_value());
+
+    // The graphics queue already waited on Cull for Opaque
+    SCRAP_CHECK(scheduler.getTotalWaitCount() == 1);
+    SCRAP_CHECK(scheduler.getCoveredDependencyCount() == 1);
+    SCRAP_CHECK(scheduler.getBatches().size() == 2);
+}
+
+SCRAP_TEST(QueueScheduler, DropsTransitiveWaits)
+{
+    QueueScheduler scheduler;
+    const uint32_t upload = scheduler.addWork("Upload", CommandQueueType::Copy);
+    const uint32_t skinning = scheduler.addWork("Skinning", CommandQueueType::Compute);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    const uint32_t transparent = scheduler.addWork("Transparent", CommandQueueType::Graphics);
+    scheduler.addDependency(skinning, upload);
+    scheduler.addDependency(opaque, skinning);
+    scheduler.addDependency(opaque, upload);
+    scheduler.addDependency(transparent, upload);
+
+    SCRAP_REQUIRE(!scheduler.compile().has_value());
+
+    // Skinning waited on Upload, so waiting on Skinning covers Upload for Opaque and everything after it on graphics
+    SCRAP_CHECK(scheduler.getTotalWaitCount() == 2);
+    SCRAP_CHECK(scheduler.getCoveredDependencyCount() == 2);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Copy) == 1);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Compute) == 1);
+
+    for(const QueueBatch& batch : scheduler.getBatches())
+    {
+        if(batch.queue != CommandQueueType::Graphics) { continue; }
+
+        for(const QueueWait& wait : scheduler.getWaits(batch))
+        {
+            SCRAP_CHECK(wait.queue == CommandQueueType::Compute);
+        }
+    }
+}
+
+SCRAP_TEST(QueueScheduler, SignalValuesIncreasePerQueue)
+{
+    QueueScheduler scheduler;
+    const uint32_t cull = scheduler.addWork("Cull", CommandQueueType::Compute);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    const uint32_t ambientOcclusion = scheduler.addWork("AmbientOcclusion", CommandQueueType::Compute);
+    const uint32_t lighting = scheduler.addWork("Lighting", CommandQueueType::Graphics);
+    const uint32_t readback = scheduler.addWork("Readback", CommandQueueType::Copy);
+    scheduler.addDependency(opaque, cull);
+    scheduler.addDependency(ambientOcclusion, opaque);
+    scheduler.addDependency(lighting, ambientOcclusion);
+    scheduler.addDependency(readback, lighting);
+
+    SCRAP_REQUIRE(!scheduler.compile().has_value());
+
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Compute) == 2);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Graphics) == 2);
+    SCRAP_CHECK(scheduler.getSignalCount(CommandQueueType::Copy) == 0);
+
+    // Every wait on a queue is for a later signal than the wait before it
+    EnumArray<uint64_t, CommandQueueType> lastSignalValues{};
+    EnumArray<uint64_t, CommandQueueType> lastWaitValues{};
+    for(const QueueBatch& batch : scheduler.getBatches())
+    {
+        for(const QueueWait& wait : scheduler.getWaits(batch))
+        {
+            SCRAP_CHECK(wait.signalValue > lastWaitValues[wait.queue]);
+            SCRAP_CHECK(wait.signalValue <= lastSignalValues[wait.queue]);
+            lastWaitValues[wait.queue] = wait.signalValue;
+        }
+
+        if(batch.signalValue == 0) { continue; }
+
+        SCRAP_CHECK(batch.signalValue == lastSignalValues[batch.queue] + 1);
+        lastSignalValues[batch.queue] = batch.signalValue;
+    }
+}
+
+SCRAP_TEST(QueueScheduler, RunsComputeOnGraphicsWithoutAsyncCompute)
+{
+    QueueScheduler scheduler;
+    const uint32_t cull = scheduler.addWork("Cull", CommandQueueType::Compute);
+    const uint32_t opaque = scheduler.addWork("Opaque", CommandQueueType::Graphics);
+    scheduler.addDependency(opaque, cull);
+
+    SCRAP_REQUIRE(!scheduler.compile(QueueScheduler::CompileOptions{.asyncCompute = false}).has_value());
+
+    SCRAP_CHECK(scheduler.getWorkQueue(cull) == CommandQueueType::Graphics);
+    SCRAP_CHECK(scheduler.getTotalWaitCount() == 0);
+    SCRAP_CHECK(scheduler.getBatches().size() == 1);
+}
+
+SCRAP_TEST(QueueScheduler, RejectsInvalidDependencies)
+{
+    {
+        QueueScheduler scheduler;
+        const uint32_t first = scheduler.addWork("First", CommandQueueType::Graphics);
+        const uint32_t second = scheduler.addWork("Second", CommandQueueType::Compute);
+        scheduler.addDependency(first, second);
+        SCRAP_CHECK(scheduler.compile() == QueueSchedulerError::ForwardDependency);
+        SCRAP_CHECK(!scheduler.isCompiled());
+    }
+
+    {
+        QueueScheduler scheduler;
+        const uint32_t work = scheduler.addWork("Work", CommandQueueType::Graphics);
+        scheduler.addDependency(work, 5);
+        SCRAP_CHECK(scheduler.compile() == QueueSchedulerError::InvalidWorkIndex);
+    }
+}
+} // namespace scrap
@@ -35,6 +35,25 @@ template<>
     }
 }
 
+// Hardware creates the device on a real adapter. Null creates a device that records commands without executing them,
+// for measuring the cpu side of the renderer on machines without a gpu.
+enum class DeviceBackend
+{
+    Hardware,
+    Null,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(DeviceBackend deviceBackend)
+{
+    switch(deviceBackend)
+    {
+    case scrap::DeviceBackend::Hardware: return "Hardware";
+    case scrap::DeviceBackend::Null: return "Null";
+    default: return "Unknown DeviceBackend";
+    }
+}
+
 enum class GraphicsShaderStage
 {
     Vertex = 0,
@@ -263,6 +282,35 @@ enum class ResourceAccessFlags
 };
 DEFINE_ENUM_BITWISE_OPERATORS(ResourceAccessFlags);
 
+// How a pass uses a resource on the gpu. Mirrors the d3d12 resource states so they translate one to one.
+enum class ResourceState : uint32_t
+{
+    None = 0, // Common
+    VertexAndConstantBuffer = 1 << 0,
+    IndexBuffer = 1 << 1,
+    RenderTarget = 1 << 2,
+    UnorderedAccess = 1 << 3,
+    DepthWrite = 1 << 4,
+    DepthRead = 1 << 5,
+    NonPixelShaderResource = 1 << 6,
+    PixelShaderResource = 1 << 7,
+    IndirectArgument = 1 << 8,
+    CopyDest = 1 << 9,
+    CopySource = 1 << 10,
+    ResolveDest = 1 << 11,
+    ResolveSource = 1 << 12,
+    RaytracingAccelerationStructure = 1 << 13,
+    Present = None,
+    AllShaderResource = NonPixelShaderResource | PixelShaderResource,
+    AllWrite = RenderTarget | UnorderedAccess | DepthWrite | CopyDest | ResolveDest,
+};
+DEFINE_ENUM_BITWISE_OPERATORS(ResourceState);
+
+[[nodiscard]] constexpr bool IsWriteState(ResourceState state)
+{
+    return (state & ResourceState::AllWrite) != ResourceState::None;
+}
+
 enum class ShaderVertexSemantic
 {
     Position,
@@ -415,6 +463,10 @@ template<>
 struct fmt::formatter<scrap::GpuPreference> : public scrap::ToStringViewFormatter<scrap::GpuPreference>
 {};
 
+template<>
+struct fmt::formatter<scrap::DeviceBackend> : public scrap::ToStringViewFormatter<scrap::DeviceBackend>
+{};
+
 template<>
 struct fmt::formatter<scrap::GraphicsShaderStage> : public scrap::ToStringViewFormatter<scrap::GraphicsShaderStage>
 {};
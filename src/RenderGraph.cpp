@@ -0,0 +1,441 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <functional>
+#include <queue>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint32_t kInvalidPass = std::numeric_limits<uint32_t>::max();
+constexpr ResourceState kUavBarrierStates =
+    ResourceState::UnorderedAccess | ResourceState::RaytracingAccelerationStructure;
+
+void SortAndRemoveDuplicates(std::vector<uint32_t>& values)
+{
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+} // namespace
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::read(RenderGraphResourceHandle resource, ResourceState state)
+{
+    mGraph.addAccess(mPassIndex, resource, state, false);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::write(RenderGraphResourceHandle resource, ResourceState state)
+{
+    mGraph.addAccess(mPassIndex, resource, state, true);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::setHasSideEffects()
+{
+    mGraph.mPasses[mPassIndex].hasSideEffects = true;
+    mGraph.mCompiled = false;
+    return *this;
+}
+
+void RenderGraph::reset()
+{
+    mResources.clear();
+    mPasses.clear();
+    mExecutionOrder.clear();
+    mBarriers.clear();
+    mBarrierOffsets.clear();
+    mCompiled = false;
+}
+
+RenderGraphResourceHandle RenderGraph::importResource(std::string_view name, ResourceState initialState)
+{
+    return importResource(name, initialState, initialState);
+}
+
+RenderGraphResourceHandle RenderGraph::importResource(std::string_view name,
+                                                      ResourceState initialState,
+                                                      ResourceState finalState)
+{
+    mResources.push_back(Resource{std::string(name), initialState, finalState, true});
+    mCompiled = false;
+
+    return RenderGraphResourceHandle((uint32_t)mResources.size() - 1);
+}
+
+RenderGraphResourceHandle RenderGraph::createResource(std::string_view name)
+{
+    mResources.push_back(Resource{std::string(name), ResourceState::None, ResourceState::None, false});
+    mCompiled = false;
+
+    return RenderGraphResourceHandle((uint32_t)mResources.size() - 1);
+}
+
+RenderGraphPassBuilder RenderGraph::addPass(std::string_view name, ExecuteFunction executeFunction)
+{
+    Pass& pass = mPasses.emplace_back();
+    pass.name = name;
+    pass.executeFunction = std::move(executeFunction);
+    mCompiled = false;
+
+    return RenderGraphPassBuilder(*this, (uint32_t)mPasses.size() - 1);
+}
+
+std::optional<RenderGraphError> RenderGraph::compile(const CompileOptions& options)
+{
+    mCompiled = false;
+
+    if(auto error = validatePasses(); error.has_value()) { return error; }
+
+    buildDependencies();
+    cullPasses(options.cullPasses);
+    orderPasses();
+    buildBarriers(options.splitBarriers);
+
+    mCompiled = true;
+    return std::nullopt;
+}
+
+std::span<const RenderGraphBarrier> RenderGraph::getBarriers(uint32_t executionPosition) const
+{
+    assert(mCompiled);
+    assert((size_t)executionPosition + 1 < mBarrierOffsets.size());
+
+    const uint32_t begin = mBarrierOffsets[executionPosition];
+    const uint32_t end = mBarrierOffsets[executionPosition + 1];
+
+    return std::span<const RenderGraphBarrier>(mBarriers.data() + begin, end - begin);
+}
+
+std::optional<RenderGraphResourceLifetime> RenderGraph::getResourceLifetime(RenderGraphResourceHandle resource) const
+{
+    assert(mCompiled);
+    assert(resource.isValid() && resource.index() < mResourceUsages.size());
+
+    const std::vector<ResourceUsage>& usages = mResourceUsages[resource.index()];
+    if(usages.empty()) { return std::nullopt; }
+
+    return RenderGraphResourceLifetime{usages.front().firstPosition, usages.back().lastPosition};
+}
+
+void RenderGraph::executePass(uint32_t passIndex) const
+{
+    assert(passIndex < mPasses.size());
+
+    const Pass& pass = mPasses[passIndex];
+    if(pass.executeFunction) { pass.executeFunction(); }
+}
+
+void RenderGraph::addAccess(uint32_t passIndex, RenderGraphResourceHandle resource, ResourceState state, bool write)
+{
+    mCompiled = false;
+
+    // Reading a resource in a write state, like blending into a render target, still modifies it
+    write = write || IsWriteState(state);
+
+    Pass& pass = mPasses[passIndex];
+
+    auto itr = std::find_if(pass.accesses.begin(), pass.accesses.end(),
+                            [resource](const ResourceAccess& access) { return access.resource == resource; });
+
+    if(itr != pass.accesses.end())
+    {
+        itr->state |= state;
+        itr->write = itr->write || write;
+        return;
+    }
+
+    pass.accesses.push_back(ResourceAccess{resource, state, write});
+}
+
+std::optional<RenderGraphError> RenderGraph::validatePasses() const
+{
+    for(const Pass& pass : mPasses)
+    {
+        for(const ResourceAccess& access : pass.accesses)
+        {
+            if(!access.resource.isValid() || access.resource.index() >= mResources.size())
+            {
+                return RenderGraphError::InvalidResourceHandle;
+            }
+
+            // Write states can't be combined with any other state
+            if(IsWriteState(access.state) && std::popcount(ToUnderlying(access.state)) > 1)
+            {
+                return RenderGraphError::IncompatibleResourceStates;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+void RenderGraph::buildDependencies()
+{
+    const size_t passCount = mPasses.size();
+
+    mProducers.resize(passCount);
+    mSuccessors.resize(passCount);
+    for(size_t passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        mProducers[passIndex].clear();
+        mSuccessors[passIndex].clear();
+    }
+
+    std::vector<uint32_t> lastWriters(mResources.size(), kInvalidPass);
+    std::vector<std::vector<uint32_t>> readersSinceLastWrite(mResources.size());
+
+    // Declaration order defines what each access sees. A read sees the last write declared before it.
+    for(uint32_t passIndex = 0; passIndex < (uint32_t)passCount; ++passIndex)
+    {
+        for(const ResourceAccess& access : mPasses[passIndex].accesses)
+        {
+            const uint32_t resourceIndex = access.resource.index();
+            const uint32_t lastWriter = lastWriters[resourceIndex];
+
+            // Writes depend on the last writer as well since they might not overwrite all of the resource
+            if(lastWriter != kInvalidPass)
+            {
+                mProducers[passIndex].push_back(lastWriter);
+                mSuccessors[lastWriter].push_back(passIndex);
+            }
+
+            if(!access.write)
+            {
+                readersSinceLastWrite[resourceIndex].push_back(passIndex);
+                continue;
+            }
+
+            // Write after read. Only an ordering constraint, the readers don't keep this pass alive.
+            for(uint32_t reader : readersSinceLastWrite[resourceIndex])
+            {
+                mSuccessors[reader].push_back(passIndex);
+            }
+
+            readersSinceLastWrite[resourceIndex].clear();
+            lastWriters[resourceIndex] = passIndex;
+        }
+    }
+
+    for(size_t passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        SortAndRemoveDuplicates(mProducers[passIndex]);
+        SortAndRemoveDuplicates(mSuccessors[passIndex]);
+    }
+}
+
+void RenderGraph::cullPasses(bool cullingEnabled)
+{
+    mLivePasses.assign(mPasses.size(), !cullingEnabled);
+    if(!cullingEnabled) { return; }
+
+    std::vector<uint32_t> passStack;
+
+    for(uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); ++passIndex)
+    {
+        const Pass& pass = mPasses[passIndex];
+
+        const bool writesImportedResource =
+            std::any_of(pass.accesses.cbegin(), pass.accesses.cend(), [this](const ResourceAccess& access) {
+                return access.write && mResources[access.resource.index()].imported;
+            });
+
+        if(pass.hasSideEffects || writesImportedResource)
+        {
+            mLivePasses[passIndex] = true;
+            passStack.push_back(passIndex);
+        }
+    }
+
+    while(!passStack.empty())
+    {
+        const uint32_t passIndex = passStack.back();
+        passStack.pop_back();
+
+        for(uint32_t producer : mProducers[passIndex])
+        {
+            if(mLivePasses[producer]) { continue; }
+
+            mLivePasses[producer] = true;
+            passStack.push_back(producer);
+        }
+    }
+}
+
+void RenderGraph::orderPasses()
+{
+    const uint32_t passCount = (uint32_t)mPasses.size();
+
+    std::vector<uint32_t> remainingDependencies(passCount, 0);
+    for(uint32_t passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        if(!mLivePasses[passIndex]) { continue; }
+
+        for(uint32_t successor : mSuccessors[passIndex])
+        {
+            ++remainingDependencies[successor];
+        }
+    }
+
+    // Ready passes are keyed by the position they became ready at, then by declaration order. The key packs both so a
+    // plain integer min-heap can be used.
+    auto makeKey = [](uint32_t readyPosition, uint32_t passIndex) {
+        return ((uint64_t)readyPosition << 32) | (uint64_t)passIndex;
+    };
+
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> readyPasses;
+
+    for(uint32_t passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        if(mLivePasses[passIndex] && remainingDependencies[passIndex] == 0) { readyPasses.push(makeKey(0, passIndex)); }
+    }
+
+    mExecutionOrder.clear();
+
+    while(!readyPasses.empty())
+    {
+        const uint32_t passIndex = (uint32_t)(readyPasses.top() & 0xffffffffu);
+        readyPasses.pop();
+
+        mExecutionOrder.push_back(passIndex);
+        const uint32_t readyPosition = (uint32_t)mExecutionOrder.size();
+
+        for(uint32_t successor : mSuccessors[passIndex])
+        {
+            if(!mLivePasses[successor]) { continue; }
+
+            if(--remainingDependencies[successor] == 0) { readyPasses.push(makeKey(readyPosition, successor)); }
+        }
+    }
+
+    // Every edge points from an earlier declared pass to a later one, so there can't be any cycles
+    assert(mExecutionOrder.size() == (size_t)std::count(mLivePasses.cbegin(), mLivePasses.cend(), true));
+}
+
+void RenderGraph::buildBarriers(bool splitBarriers)
+{
+    const uint32_t executionCount = (uint32_t)mExecutionOrder.size();
+
+    mResourceUsages.resize(mResources.size());
+    for(std::vector<ResourceUsage>& usages : mResourceUsages)
+    {
+        usages.clear();
+    }
+
+    for(uint32_t position = 0; position < executionCount; ++position)
+    {
+        for(const ResourceAccess& access : mPasses[mExecutionOrder[position]].accesses)
+        {
+            std::vector<ResourceUsage>& usages = mResourceUsages[access.resource.index()];
+
+            // Consecutive reads are merged so a single transition covers all of them
+            if(!access.write && !usages.empty() && !usages.back().write)
+            {
+                usages.back().lastPosition = position;
+                usages.back().state |= access.state;
+                continue;
+            }
+
+            usages.push_back(ResourceUsage{position, position, access.state, access.write});
+        }
+    }
+
+    mBoundaryBarriers.resize(executionCount + 1);
+    for(uint32_t boundary = 0; boundary <= executionCount; ++boundary)
+    {
+        mBoundaryBarriers[boundary].clear();
+    }
+
+    for(uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); ++resourceIndex)
+    {
+        const Resource& resource = mResources[resourceIndex];
+        const std::vector<ResourceUsage>& usages = mResourceUsages[resourceIndex];
+        const RenderGraphResourceHandle handle(resourceIndex);
+
+        ResourceState currentState = resource.initialState;
+        bool lastUsageWrote = false;
+
+        // The first boundary a barrier for the next usage could begin at
+        uint32_t earliestPosition = 0;
+
+        for(size_t usageIndex = 0; usageIndex < usages.size(); ++usageIndex)
+        {
+            const ResourceUsage& usage = usages[usageIndex];
+
+            if(usageIndex == 0 && !resource.imported)
+            {
+                // Created resources start out in the state of their first use
+                currentState = usage.state;
+            }
+            else if(usage.state == currentState)
+            {
+                // Unordered access and acceleration structure writes aren't ordered by a state change, so anything
+                // after them needs a UAV barrier
+                if(lastUsageWrote && (currentState & kUavBarrierStates) != ResourceState::None)
+                {
+                    mBoundaryBarriers[usage.firstPosition].push_back(RenderGraphBarrier{
+                        .resource = handle, .type = RenderGraphBarrierType::UnorderedAccess});
+                }
+            }
+            else if(!usage.write && currentState != ResourceState::None && !IsWriteState(currentState) &&
+                    (usage.state & ~currentState) == ResourceState::None)
+            {
+                // Already in a read state that covers this usage
+            }
+            else
+            {
+                addTransition(handle, currentState, usage.state, earliestPosition, usage.firstPosition, splitBarriers);
+                currentState = usage.state;
+            }
+
+            lastUsageWrote = usage.write;
+            earliestPosition = usage.lastPosition + 1;
+        }
+
+        if(resource.imported && currentState != resource.finalState)
+        {
+            addTransition(handle, currentState, resource.finalState, earliestPosition, executionCount, splitBarriers);
+        }
+    }
+
+    mBarriers.clear();
+    mBarrierOffsets.resize(executionCount + 2);
+
+    for(uint32_t boundary = 0; boundary <= executionCount; ++boundary)
+    {
+        mBarrierOffsets[boundary] = (uint32_t)mBarriers.size();
+        mBarriers.insert(mBarriers.end(), mBoundaryBarriers[boundary].cbegin(), mBoundaryBarriers[boundary].cend());
+    }
+
+    mBarrierOffsets[executionCount + 1] = (uint32_t)mBarriers.size();
+}
+
+void RenderGraph::addTransition(RenderGraphResourceHandle resource,
+                                ResourceState stateBefore,
+                                ResourceState stateAfter,
+                                uint32_t earliestPosition,
+                                uint32_t nextPosition,
+                                bool splitBarriers)
+{
+    RenderGraphBarrier barrier{.resource = resource,
+                               .type = RenderGraphBarrierType::Transition,
+                               .stateBefore = stateBefore,
+                               .stateAfter = stateAfter};
+
+    // With passes in between the last and next use, the transition can start right after the last use and overlap
+    // with those passes
+    if(splitBarriers && earliestPosition < nextPosition)
+    {
+        barrier.split = RenderGraphBarrierSplit::Begin;
+        mBoundaryBarriers[earliestPosition].push_back(barrier);
+
+        barrier.split = RenderGraphBarrierSplit::End;
+        mBoundaryBarriers[nextPosition].push_back(barrier);
+        return;
+    }
+
+    mBoundaryBarriers[nextPosition].push_back(barrier);
+}
+} // namespace scrap
@@ -0,0 +1,257 @@
+// Classes:
+//   RenderGraph
+//   RenderGraphPassBuilder
+//
+// RenderGraph:
+//   Passes declare which virtual resources they read and write and in what state. compile() works out everything the
+//   passes used to do by hand:
+//     * Passes that nothing depends on are culled. A pass is kept if it has side effects, writes an imported resource
+//       or produces something a kept pass uses.
+//     * Kept passes are ordered by their dependencies. Among the passes that are ready, the one whose inputs were
+//       produced earliest goes first, which spreads producers and consumers apart.
+//     * Resource state barriers are generated for every pass boundary. Consecutive reads share one transition into
+//       the combined read state, anything after an unordered access or acceleration structure write gets a UAV
+//       barrier and transitions that have passes in between them are split into begin/end barriers.
+//   Resources only exist as handles. Imported resources are owned outside of the graph and are returned to their final
+//   state at the end of the graph. Created resources only live within the graph and are expected to already be in the
+//   state of their first use. Nothing in here touches the device. Recording the barriers and passes into a command list
+//   is done by d3d12::RenderGraphExecutor.
+//
+// RenderGraphPassBuilder:
+//   Returned by RenderGraph::addPass to declare the pass's resource usage.
+
+#pragma once
+
+#include "RenderDefs.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+class RenderGraphResourceHandle
+{
+public:
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    RenderGraphResourceHandle() = default;
+    explicit RenderGraphResourceHandle(uint32_t index): mIndex(index) {}
+
+    [[nodiscard]] bool isValid() const { return mIndex != kInvalidIndex; }
+    [[nodiscard]] uint32_t index() const { return mIndex; }
+
+    bool operator==(const RenderGraphResourceHandle&) const = default;
+
+private:
+    uint32_t mIndex = kInvalidIndex;
+};
+
+enum class RenderGraphError
+{
+    InvalidResourceHandle,
+    IncompatibleResourceStates,
+};
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(RenderGraphError error)
+{
+    switch(error)
+    {
+    case scrap::RenderGraphError::InvalidResourceHandle: return "InvalidResourceHandle";
+    case scrap::RenderGraphError::IncompatibleResourceStates: return "IncompatibleResourceStates";
+    default: return "Unknown RenderGraphError";
+    }
+}
+
+enum class RenderGraphBarrierType
+{
+    Transition,
+    UnorderedAccess,
+};
+
+enum class RenderGraphBarrierSplit
+{
+    None,
+    Begin,
+    End,
+};
+
+struct RenderGraphBarrier
+{
+    RenderGraphResourceHandle resource;
+    RenderGraphBarrierType type = RenderGraphBarrierType::Transition;
+    RenderGraphBarrierSplit split = RenderGraphBarrierSplit::None;
+    ResourceState stateBefore = ResourceState::None;
+    ResourceState stateAfter = ResourceState::None;
+};
+
+// Positions in the execution order of the first and last pass that use a resource
+struct RenderGraphResourceLifetime
+{
+    uint32_t firstPosition = 0;
+    uint32_t lastPosition = 0;
+};
+
+class RenderGraph;
+
+class RenderGraphPassBuilder
+{
+public:
+    RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex): mGraph(graph), mPassIndex(passIndex) {}
+
+    RenderGraphPassBuilder& read(RenderGraphResourceHandle resource, ResourceState state);
+    RenderGraphPassBuilder& write(RenderGraphResourceHandle resource, ResourceState state);
+
+    // The pass is never culled, even if nothing reads what it writes
+    RenderGraphPassBuilder& setHasSideEffects();
+
+    [[nodiscard]] uint32_t getPassIndex() const { return mPassIndex; }
+
+private:
+    RenderGraph& mGraph;
+    uint32_t mPassIndex;
+};
+
+class RenderGraph
+{
+public:
+    using ExecuteFunction = std::function<void()>;
+
+    struct CompileOptions
+    {
+        bool cullPasses = true;
+        bool splitBarriers = true;
+    };
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph(RenderGraph&&) = default;
+    ~RenderGraph() = default;
+
+    RenderGraph& operator=(const RenderGraph&) = delete;
+    RenderGraph& operator=(RenderGraph&&) = default;
+
+    // Removes all passes and resources. Keeps the allocated memory so the graph can be rebuilt every frame.
+    void reset();
+
+    RenderGraphResourceHandle importResource(std::string_view name, ResourceState initialState);
+    RenderGraphResourceHandle
+    importResource(std::string_view name, ResourceState initialState, ResourceState finalState);
+    RenderGraphResourceHandle createResource(std::string_view name);
+
+    RenderGraphPassBuilder addPass(std::string_view name, ExecuteFunction executeFunction);
+
+    [[nodiscard]] std::optional<RenderGraphError> compile(const CompileOptions& options);
+    [[nodiscard]] std::optional<RenderGraphError> compile() { return compile(CompileOptions{}); }
+
+    [[nodiscard]] bool isCompiled() const { return mCompiled; }
+
+    [[nodiscard]] uint32_t getPassCount() const { return (uint32_t)mPasses.size(); }
+    [[nodiscard]] uint32_t getResourceCount() const { return (uint32_t)mResources.size(); }
+    [[nodiscard]] std::string_view getPassName(uint32_t passIndex) const { return mPasses[passIndex].name; }
+    [[nodiscard]] std::string_view getResourceName(RenderGraphResourceHandle resource) const
+    {
+        return mResources[resource.index()].name;
+    }
+    [[nodiscard]] bool isResourceImported(RenderGraphResourceHandle resource) const
+    {
+        return mResources[resource.index()].imported;
+    }
+
+    // Indices of the passes that survived culling, in execution order. Only valid after compile.
+    [[nodiscard]] std::span<const uint32_t> getExecutionOrder() const { return mExecutionOrder; }
+    [[nodiscard]] uint32_t getCulledPassCount() const { return getPassCount() - (uint32_t)mExecutionOrder.size(); }
+
+    // Barriers to record before the pass at the position in the execution order. Only valid after compile.
+    [[nodiscard]] std::span<const RenderGraphBarrier> getBarriers(uint32_t executionPosition) const;
+
+    // Barriers to record after the last pass
+    [[nodiscard]] std::span<const RenderGraphBarrier> getFinalBarriers() const
+    {
+        return getBarriers((uint32_t)mExecutionOrder.size());
+    }
+
+    [[nodiscard]] size_t getTotalBarrierCount() const { return mBarriers.size(); }
+
+    // Empty if no pass that survived culling uses the resource. Only valid after compile. Can be used to plan the
+    // memory of created resources with a TransientResourcePlanner.
+    [[nodiscard]] std::optional<RenderGraphResourceLifetime>
+    getResourceLifetime(RenderGraphResourceHandle resource) const;
+
+    void executePass(uint32_t passIndex) const;
+
+private:
+    friend class RenderGraphPassBuilder;
+
+    struct Resource
+    {
+        std::string name;
+        ResourceState initialState = ResourceState::None;
+        ResourceState finalState = ResourceState::None;
+        bool imported = false;
+    };
+
+    struct ResourceAccess
+    {
+        RenderGraphResourceHandle resource;
+        ResourceState state = ResourceState::None;
+        bool write = false;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction executeFunction;
+        std::vector<ResourceAccess> accesses;
+        bool hasSideEffects = false;
+    };
+
+    // One or more passes in a row that use a resource in the same way. Consecutive reads are combined into one group.
+    struct ResourceUsage
+    {
+        uint32_t firstPosition = 0;
+        uint32_t lastPosition = 0;
+        ResourceState state = ResourceState::None;
+        bool write = false;
+    };
+
+    void addAccess(uint32_t passIndex, RenderGraphResourceHandle resource, ResourceState state, bool write);
+
+    std::optional<RenderGraphError> validatePasses() const;
+    void buildDependencies();
+    void cullPasses(bool cullingEnabled);
+    void orderPasses();
+    void buildBarriers(bool splitBarriers);
+
+    void addTransition(RenderGraphResourceHandle resource,
+                       ResourceState stateBefore,
+                       ResourceState stateAfter,
+                       uint32_t earliestPosition,
+                       uint32_t nextPosition,
+                       bool splitBarriers);
+
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+
+    // Compile state. Kept as members so rebuilding the graph every frame doesn't reallocate.
+    std::vector<std::vector<uint32_t>> mProducers; // Passes whose results a pass depends on
+    std::vector<std::vector<uint32_t>> mSuccessors; // Passes that have to run after a pass
+    std::vector<bool> mLivePasses;
+    std::vector<uint32_t> mExecutionOrder;
+    std::vector<std::vector<ResourceUsage>> mResourceUsages;
+    std::vector<std::vector<RenderGraphBarrier>> mBoundaryBarriers;
+    std::vector<RenderGraphBarrier> mBarriers;
+    std::vector<uint32_t> mBarrierOffsets;
+    bool mCompiled = false;
+};
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::RenderGraphError> : public scrap::ToStringViewFormatter<scrap::RenderGraphError>
+{};
@@ -0,0 +1,251 @@
+#include "RenderGraph.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+std::vector<uint32_t> GetExecutionOrder(const RenderGraph& graph)
+{
+    const std::span<const uint32_t> executionOrder = graph.getExecutionOrder();
+    return std::vector<uint32_t>(executionOrder.begin(), executionOrder.end());
+}
+} // namespace
+
+SCRAP_TEST(RenderGraph, CullsPassesWithoutRoots)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle backBuffer = graph.importResource("BackBuffer", ResourceState::RenderTarget);
+    const RenderGraphResourceHandle unusedTarget = graph.createResource("UnusedTarget");
+    const RenderGraphResourceHandle sceneColor = graph.createResource("SceneColor");
+
+    const uint32_t unusedPass =
+        graph.addPass("Unused", {}).write(unusedTarget, ResourceState::RenderTarget).getPassIndex();
+    const uint32_t scenePass = graph.addPass("Scene", {}).write(sceneColor, ResourceState::RenderTarget).getPassIndex();
+    const uint32_t compositePass = graph.addPass("Composite", {})
+                                       .read(sceneColor, ResourceState::PixelShaderResource)
+                                       .write(backBuffer, ResourceState::RenderTarget)
+                                       .getPassIndex();
+    const uint32_t capturePass = graph.addPass("Capture", {}).setHasSideEffects().getPassIndex();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+
+    // Composite writes an imported resource and Capture has side effects. Scene is kept for Composite.
+    const std::vector<uint32_t> executionOrder = GetExecutionOrder(graph);
+    SCRAP_CHECK(graph.getCulledPassCount() == 1);
+    SCRAP_CHECK(std::find(executionOrder.begin(), executionOrder.end(), unusedPass) == executionOrder.end());
+    SCRAP_CHECK(std::find(executionOrder.begin(), executionOrder.end(), scenePass) != executionOrder.end());
+    SCRAP_CHECK(std::find(executionOrder.begin(), executionOrder.end(), compositePass) != executionOrder.end());
+    SCRAP_CHECK(std::find(executionOrder.begin(), executionOrder.end(), capturePass) != executionOrder.end());
+    SCRAP_CHECK(!graph.getResourceLifetime(unusedTarget).has_value());
+}
+
+SCRAP_TEST(RenderGraph, KeepsEveryPassWithoutCulling)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle unusedTarget = graph.createResource("UnusedTarget");
+    graph.addPass("Unused", {}).write(unusedTarget, ResourceState::RenderTarget);
+
+    SCRAP_REQUIRE(!graph.compile(RenderGraph::CompileOptions{.cullPasses = false}).has_value());
+    SCRAP_CHECK(graph.getCulledPassCount() == 0);
+    SCRAP_CHECK(GetExecutionOrder(graph) == std::vector<uint32_t>{0});
+}
+
+SCRAP_TEST(RenderGraph, OrdersProducersBeforeConsumers)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle shadowMap = graph.createResource("ShadowMap");
+    const RenderGraphResourceHandle sceneColor = graph.createResource("SceneColor");
+
+    // Declared with the shadow consumer right after its producer
+    graph.addPass("Shadows", {}).write(shadowMap, ResourceState::DepthWrite);
+    graph.addPass("ShadowDebug", {}).read(shadowMap, ResourceState::PixelShaderResource).setHasSideEffects();
+    graph.addPass("Scene", {}).write(sceneColor, ResourceState::RenderTarget);
+    graph.addPass("SceneDebug", {}).read(sceneColor, ResourceState::PixelShaderResource).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+
+    // Scene became ready before ShadowDebug, so it goes between Shadows and ShadowDebug
+    SCRAP_CHECK((GetExecutionOrder(graph) == std::vector<uint32_t>{0, 2, 1, 3}));
+}
+
+SCRAP_TEST(RenderGraph, OrdersWriteAfterRead)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle history = graph.importResource("History", ResourceState::PixelShaderResource);
+
+    graph.addPass("Resolve", {}).write(history, ResourceState::RenderTarget);
+    graph.addPass("Read", {}).read(history, ResourceState::PixelShaderResource).setHasSideEffects();
+    graph.addPass("Overwrite", {}).write(history, ResourceState::CopyDest);
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+    SCRAP_CHECK((GetExecutionOrder(graph) == std::vector<uint32_t>{0, 1, 2}));
+}
+
+SCRAP_TEST(RenderGraph, MergesConsecutiveReads)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle sceneColor = graph.createResource("SceneColor");
+
+    graph.addPass("Scene", {}).write(sceneColor, ResourceState::RenderTarget);
+    graph.addPass("Bloom", {}).read(sceneColor, ResourceState::PixelShaderResource).setHasSideEffects();
+    graph.addPass("Histogram", {}).read(sceneColor, ResourceState::NonPixelShaderResource).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+    SCRAP_REQUIRE(GetExecutionOrder(graph).size() == 3);
+
+    // One transition into both read states before the first read, nothing before the second
+    const std::span<const RenderGraphBarrier> barriers = graph.getBarriers(1);
+    SCRAP_REQUIRE(barriers.size() == 1);
+    SCRAP_CHECK(barriers[0].resource == sceneColor);
+    SCRAP_CHECK(barriers[0].type == RenderGraphBarrierType::Transition);
+    SCRAP_CHECK(barriers[0].split == RenderGraphBarrierSplit::None);
+    SCRAP_CHECK(barriers[0].stateBefore == ResourceState::RenderTarget);
+    SCRAP_CHECK(barriers[0].stateAfter == ResourceState::AllShaderResource);
+    SCRAP_CHECK(graph.getBarriers(0).empty());
+    SCRAP_CHECK(graph.getBarriers(2).empty());
+    SCRAP_CHECK(graph.getTotalBarrierCount() == 1);
+
+    const std::optional<RenderGraphResourceLifetime> lifetime = graph.getResourceLifetime(sceneColor);
+    SCRAP_REQUIRE(lifetime.has_value());
+    SCRAP_CHECK(lifetime->firstPosition == 0);
+    SCRAP_CHECK(lifetime->lastPosition == 2);
+}
+
+SCRAP_TEST(RenderGraph, AddsUavBarrierAfterUnorderedAccessWrite)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle particles = graph.createResource("Particles");
+
+    graph.addPass("Emit", {}).write(particles, ResourceState::UnorderedAccess);
+    graph.addPass("Simulate", {}).write(particles, ResourceState::UnorderedAccess).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+
+    const std::span<const RenderGraphBarrier> barriers = graph.getBarriers(1);
+    SCRAP_REQUIRE(barriers.size() == 1);
+    SCRAP_CHECK(barriers[0].resource == particles);
+    SCRAP_CHECK(barriers[0].type == RenderGraphBarrierType::UnorderedAccess);
+}
+
+SCRAP_TEST(RenderGraph, AddsUavBarrierAfterAccelerationStructureWrite)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle tlas = graph.createResource("Tlas");
+
+    graph.addPass("BuildTlas", {}).write(tlas, ResourceState::RaytracingAccelerationStructure);
+    graph.addPass("TraceRays", {}).read(tlas, ResourceState::RaytracingAccelerationStructure).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+
+    const std::span<const RenderGraphBarrier> barriers = graph.getBarriers(1);
+    SCRAP_REQUIRE(barriers.size() == 1);
+    SCRAP_CHECK(barriers[0].resource == tlas);
+    SCRAP_CHECK(barriers[0].type == RenderGraphBarrierType::UnorderedAccess);
+}
+
+SCRAP_TEST(RenderGraph, NoUavBarrierBetweenReads)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle tlas =
+        graph.importResource("Tlas", ResourceState::RaytracingAccelerationStructure);
+
+    graph.addPass("TraceShadows", {}).read(tlas, ResourceState::RaytracingAccelerationStructure).setHasSideEffects();
+    graph.addPass("TraceReflections", {})
+        .read(tlas, ResourceState::RaytracingAccelerationStructure)
+        .setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+    SCRAP_CHECK(graph.getTotalBarrierCount() == 0);
+}
+
+SCRAP_TEST(RenderGraph, SplitsTransitionsWithPassesInBetween)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle shadowMap = graph.createResource("ShadowMap");
+    const RenderGraphResourceHandle particles = graph.createResource("Particles");
+
+    graph.addPass("Shadows", {}).write(shadowMap, ResourceState::DepthWrite);
+    graph.addPass("Particles", {}).write(particles, ResourceState::UnorderedAccess).setHasSideEffects();
+    graph.addPass("Lighting", {}).read(shadowMap, ResourceState::PixelShaderResource).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+    SCRAP_REQUIRE((GetExecutionOrder(graph) == std::vector<uint32_t>{0, 1, 2}));
+
+    // The transition begins right after Shadows and ends right before Lighting
+    const std::span<const RenderGraphBarrier> beginBarriers = graph.getBarriers(1);
+    SCRAP_REQUIRE(beginBarriers.size() == 1);
+    SCRAP_CHECK(beginBarriers[0].resource == shadowMap);
+    SCRAP_CHECK(beginBarriers[0].split == RenderGraphBarrierSplit::Begin);
+    SCRAP_CHECK(beginBarriers[0].stateBefore == ResourceState::DepthWrite);
+    SCRAP_CHECK(beginBarriers[0].stateAfter == ResourceState::PixelShaderResource);
+
+    const std::span<const RenderGraphBarrier> endBarriers = graph.getBarriers(2);
+    SCRAP_REQUIRE(endBarriers.size() == 1);
+    SCRAP_CHECK(endBarriers[0].resource == shadowMap);
+    SCRAP_CHECK(endBarriers[0].split == RenderGraphBarrierSplit::End);
+    SCRAP_CHECK(endBarriers[0].stateBefore == ResourceState::DepthWrite);
+    SCRAP_CHECK(endBarriers[0].stateAfter == ResourceState::PixelShaderResource);
+}
+
+SCRAP_TEST(RenderGraph, DoesNotSplitWithoutOption)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle shadowMap = graph.createResource("ShadowMap");
+    const RenderGraphResourceHandle particles = graph.createResource("Particles");
+
+    graph.addPass("Shadows", {}).write(shadowMap, ResourceState::DepthWrite);
+    graph.addPass("Particles", {}).write(particles, ResourceState::UnorderedAccess).setHasSideEffects();
+    graph.addPass("Lighting", {}).read(shadowMap, ResourceState::PixelShaderResource).setHasSideEffects();
+
+    SCRAP_REQUIRE(!graph.compile(RenderGraph::CompileOptions{.splitBarriers = false}).has_value());
+
+    SCRAP_CHECK(graph.getBarriers(1).empty());
+
+    const std::span<const RenderGraphBarrier> barriers = graph.getBarriers(2);
+    SCRAP_REQUIRE(barriers.size() == 1);
+    SCRAP_CHECK(barriers[0].split == RenderGraphBarrierSplit::None);
+}
+
+SCRAP_TEST(RenderGraph, ReturnsImportedResourcesToFinalState)
+{
+    RenderGraph graph;
+    const RenderGraphResourceHandle backBuffer =
+        graph.importResource("BackBuffer", ResourceState::Present, ResourceState::Present);
+
+    graph.addPass("Scene", {}).write(backBuffer, ResourceState::RenderTarget);
+
+    SCRAP_REQUIRE(!graph.compile().has_value());
+
+    const std::span<const RenderGraphBarrier> firstBarriers = graph.getBarriers(0);
+    SCRAP_REQUIRE(firstBarriers.size() == 1);
+    SCRAP_CHECK(firstBarriers[0].stateBefore == ResourceState::Present);
+    SCRAP_CHECK(firstBarriers[0].stateAfter == ResourceState::RenderTarget);
+
+    const std::span<const RenderGraphBarrier> finalBarriers = graph.getFinalBarriers();
+    SCRAP_REQUIRE(finalBarriers.size() == 1);
+    SCRAP_CHECK(finalBarriers[0].split == RenderGraphBarrierSplit::None);
+    SCRAP_CHECK(finalBarriers[0].stateBefore == ResourceState::RenderTarget);
+    SCRAP_CHECK(finalBarriers[0].stateAfter == ResourceState::Present);
+}
+
+SCRAP_TEST(RenderGraph, RejectsInvalidAccesses)
+{
+    {
+        RenderGraph graph;
+        graph.addPass("Invalid", {}).read(RenderGraphResourceHandle(), ResourceState::PixelShaderResource);
+        SCRAP_CHECK(graph.compile() == RenderGraphError::InvalidResourceHandle);
+        SCRAP_CHECK(!graph.isCompiled());
+    }
+
+    {
+        RenderGraph graph;
+        const RenderGraphResourceHandle target = graph.createResource("Target");
+        graph.addPass("Incompatible", {}).write(target, ResourceState::RenderTarget | ResourceState::CopyDest);
+        SCRAP_CHECK(graph.compile() == RenderGraphError::IncompatibleResourceStates);
+    }
+}
+} // namespace scrap
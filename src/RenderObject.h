@@ -1,11 +1,12 @@
 #pragma once
 
+#include "ShaderBindingLayout.h"
 #include "SharedString.h"
-#include "d3d12/D3D12ShaderTable.h"
 #include "d3d12/D3D12TLAccelerationStructure.h"
 #include "d3d12/D3D12Texture.h"
 
 #include <memory>
+#include <optional>
 
 #include <EASTL/vector_map.h>
 #include <glm/gtc/matrix_transform.hpp>
@@ -22,13 +23,45 @@ class GraphicsPipelineState;
 class RaytracingPipelineState;
 } // namespace d3d12
 
+// The material's textures and the mesh's buffers resolved against a shader's binding layout. Compiled the first time
+// it's needed and then reused until the layout or mesh changes, or the material's textures change.
+struct MaterialBindings
+{
+    const ShaderBindingLayout* layout = nullptr;
+    const GpuMesh* mesh = nullptr;
+    ShaderBindingIndices indices;
+
+    [[nodiscard]] bool isCompiledFor(const ShaderBindingLayout* bindingLayout, const GpuMesh* bindingMesh) const
+    {
+        return layout != nullptr && layout == bindingLayout && mesh == bindingMesh;
+    }
+};
+
 class Material
 {
 public:
+    // Use setTexture when changing textures so the compiled bindings get rebuilt
+    void setTexture(SharedString name, std::shared_ptr<d3d12::Texture> texture)
+    {
+        textures[std::move(name)] = std::move(texture);
+        invalidateBindings();
+    }
+
+    void invalidateBindings()
+    {
+        mRasterBindings = {};
+        mRaytracingBindings = {};
+        mHitGroupIndex.reset();
+    }
+
     eastl::vector_map<SharedString, std::shared_ptr<d3d12::Texture>> textures;
     std::shared_ptr<d3d12::GraphicsPipelineState> mRasterPipelineState;
     std::shared_ptr<d3d12::RaytracingPipelineState> mRaytracingPipelineState;
-    d3d12::ShaderTableAllocation mShaderTableAllocation;
+    MaterialBindings mRasterBindings;
+    MaterialBindings mRaytracingBindings;
+    // The hit group record of the raytracing pipeline state and bindings, shared with every material that has the same
+    // ones. Looked up again whenever the bindings are recompiled.
+    std::optional<uint32_t> mHitGroupIndex;
 };
 
 struct Transform
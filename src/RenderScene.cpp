@@ -1,9 +1,13 @@
 #include "RenderScene.h"
 
 #include "CpuMesh.h"
+#include "CpuProfiler.h"
 #include "FrameInfo.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
 #include "PrimitiveMesh.h"
 #include "SpanUtility.h"
+#include "StressScene.h"
 #include "Window.h"
 #include "d3d12/D3D12BLAccelerationStructure.h"
 #include "d3d12/D3D12Buffer.h"
@@ -68,28 +72,81 @@ SerializeAndCreateRootSignature(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc)
     return rootSignature;
 }
 
+// Resolves the material's textures and the mesh's buffers against a shader's binding layout. This is the only place
+// the resources get matched up with the shader's inputs. The result is cached on the material, so after the first
+// frame this just returns the compiled indices.
+const ShaderBindingIndices& CompileMaterialBindings(MaterialBindings& bindings,
+                                                   const ShaderBindingLayout& layout,
+                                                   const Material& material,
+                                                   const GpuMesh& mesh)
+{
+    if(bindings.isCompiledFor(&layout, &mesh)) { return bindings.indices; }
+
+    static const ShaderBindingKey kIndexBufferKey =
+        MakeShaderBindingKey(StringHash("IndexBuffer"), ShaderResourceType::Buffer, ShaderResourceDimension::Buffer);
+
+    bindings = MaterialBindings{.layout = &layout, .mesh = &mesh};
+
+    for(const d3d12::VertexBuffer& vertexElement : mesh.getVertexElements())
+    {
+        layout.bindVertexElement(bindings.indices,
+                                 MakeShaderBindingKey(vertexElement.semantic, vertexElement.semanticIndex),
+                                 vertexElement.buffer->getSrvDescriptorHeapIndex());
+    }
+
+    if(mesh.getIndexBuffer() != nullptr)
+    {
+        layout.bindResource(bindings.indices, kIndexBufferKey, mesh.getIndexBuffer()->getSrvDescriptorHeapIndex());
+    }
+
+    for(const auto& [key, texture] : material.textures)
+    {
+        layout.bindResource(bindings.indices,
+                            MakeShaderBindingKey(key.hash(), ShaderResourceType::Texture,
+                                                 texture->getShaderResourceDimension()),
+                            texture->getSrvDescriptorHeapIndex());
+    }
+
+    return bindings.indices;
+}
+
 //=====================================
 // RasterRenderer
 //=====================================
-RasterRenderer::RasterRenderer(): mCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, "RasterRenderer Command List")
+RasterRenderer::RasterRenderer()
+    : mCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, "RasterRenderer Command List")
+    , mPresentCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, "RasterRenderer Present Command List")
+    , mParallelRecorder(D3D12_COMMAND_LIST_TYPE_DIRECT, "RasterRenderer Command List")
 {
     mCommandList.beginRecording();
+}
 
-    createRenderTargets();
-    createRootSignature();
-    createFrameConstantBuffer();
+RasterRenderer::RasterRenderer(RasterRenderer&&) = default;
 
-    d3d12::DeviceContext& deviceContext = d3d12::DeviceContext::instance();
-    deviceContext.getCopyContext().execute();
+RasterRenderer::~RasterRenderer() = default;
 
-    mCommandList.execute(deviceContext.getGraphicsContext().getCommandQueue());
+InitTaskId RasterRenderer::addInitTasks(InitGraph& initGraph)
+{
+    const InitTaskId rootSignatureTask =
+        initGraph.addTask("Raster root signature", [this]() { return createRootSignature(); });
 
-    mInitialized = true;
+    mInitTasks = {
+        rootSignatureTask,
+        initGraph.addTask("Raster depth stencil target", [this]() { return createRenderTargets(); }),
+        initGraph.addTask("Raster frame constant buffer", [this]() { return createFrameConstantBuffer(); }),
+    };
+
+    return rootSignatureTask;
 }
 
-RasterRenderer::RasterRenderer(RasterRenderer&&) = default;
+void RasterRenderer::finishInit(const InitGraph& initGraph)
+{
+    if(!initGraph.hasSucceeded(mInitTasks)) { return; }
 
-RasterRenderer::~RasterRenderer() = default;
+    mCommandList.execute(d3d12::DeviceContext::instance().getGraphicsContext().getCommandQueue());
+
+    mInitialized = true;
+}
 
 bool RasterRenderer::createRootSignature()
 {
@@ -125,7 +182,8 @@ bool RasterRenderer::createRootSignature()
     objectConstantBuffer.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
     objectConstantBuffer.Descriptor.ShaderRegister = d3d12::shader::kObjectCBuffer.shaderRegister;
     objectConstantBuffer.Descriptor.RegisterSpace = d3d12::shader::kObjectCBuffer.registerSpace;
-    objectConstantBuffer.Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE;
+    // Every draw binds its own constants from the upload heap, which are written before the command list executes
+    objectConstantBuffer.Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
     objectConstantBuffer.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
     // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/ns-d3d12-d3d12_static_sampler_desc
@@ -172,7 +230,7 @@ bool RasterRenderer::createRootSignature()
     return true;
 }
 
-void RasterRenderer::createRenderTargets()
+bool RasterRenderer::createRenderTargets()
 {
     // Currently using the swap chain as our render targets. Just need the depth/stencil buffer
     d3d12::TextureParams params = {};
@@ -193,13 +251,15 @@ void RasterRenderer::createRenderTargets()
     if(error.has_value())
     {
         spdlog::critical("Failed to create depth stencil target for scene. {}", error.value());
-        return;
+        return false;
     }
 
     mDepthStencilTexture = std::move(depthStencilTexture);
+
+    return true;
 }
 
-void RasterRenderer::createFrameConstantBuffer()
+bool RasterRenderer::createFrameConstantBuffer()
 {
     d3d12::BufferSimpleParams params;
     params.accessFlags = ResourceAccessFlags::CpuWrite | ResourceAccessFlags::GpuRead;
@@ -208,25 +268,29 @@ void RasterRenderer::createFrameConstantBuffer()
     params.name = "Frame Constant Buffer";
 
     auto frameConstantBuffer = std::make_unique<d3d12::Buffer>();
-    frameConstantBuffer->init(params);
+    if(frameConstantBuffer->init(params).has_value())
+    {
+        spdlog::critical("Failed to create raster frame constant buffer");
+        return false;
+    }
 
     mFrameConstantBuffer = std::move(frameConstantBuffer);
 
-    params.byteSize = sizeof(ObjectConstantBuffer);
-    params.name = "Object Constant Buffers";
-
-    auto objectConstantBuffer = std::make_unique<d3d12::Buffer>();
-    objectConstantBuffer->init(params);
-
-    mObjectConstantBuffer = std::move(objectConstantBuffer);
+    return true;
 }
 
 RasterRenderer& RasterRenderer::operator=(RasterRenderer&&) = default;
 
 void RasterRenderer::preRender(const FrameInfo& frameInfo, const RenderParams& renderParams)
 {
+    SCRAP_CPU_ZONE("RasterRenderer::preRender");
+
     mCommandList.beginRecording();
 
+    // The write guard copies into the buffer when it goes out of scope
+    mCommandList.transitionResource(*mFrameConstantBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+    mCommandList.flushResourceBarriers();
+
     {
         d3d12::GpuBufferWriteGuard writeGuard(*mFrameConstantBuffer, mCommandList.get());
         auto& frameConstantBuffer = writeGuard.getWriteBufferAs<FrameConstantBuffer>().front();
@@ -238,133 +302,189 @@ void RasterRenderer::preRender(const FrameInfo& frameInfo, const RenderParams& r
         frameConstantBuffer.worldToClip = glm::transpose(frameConstantBuffer.worldToClip);
         frameConstantBuffer.clipToWorld = glm::transpose(frameConstantBuffer.clipToWorld);
     }
-}
 
-void RasterRenderer::bindTextures(Material& material)
-{
-    const d3d12::GraphicsShader& shader = *material.mRasterPipelineState->getShader();
-
-    // bind resources
-    for(const auto& [key, texture] : material.textures)
-    {
-        const uint32_t textureIndex =
-            shader.getResourceIndex(key, ShaderResourceType::Texture, texture->getShaderResourceDimension())
-                .value_or(d3d12::kMaxBindlessResources);
-        mCommandList.setBindlessResource(textureIndex, texture->getSrvDescriptorHeapIndex());
-    }
+    mCommandList.transitionResource(*mFrameConstantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 }
 
-void RasterRenderer::render(const FrameInfo& frameInfo, const RenderParams& renderParams)
+void RasterRenderer::bindPassState(d3d12::GraphicsCommandList& commandList)
 {
     d3d12::DeviceContext& d3d12Context = d3d12::DeviceContext::instance();
 
-    {
-        d3d12::ScopedGpuEvent gpuEvent(mCommandList.get(), "RasterRenderer");
-
-        D3D12_VIEWPORT viewport{};
-        viewport.TopLeftX = 0.0f;
-        viewport.TopLeftY = 0.0f;
-        viewport.Width = static_cast<float>(d3d12Context.getFrameSize().x);
-        viewport.Height = static_cast<float>(d3d12Context.getFrameSize().y);
-        viewport.MinDepth = 0.0f;
-        viewport.MaxDepth = 1.0f;
+    D3D12_VIEWPORT viewport{};
+    viewport.TopLeftX = 0.0f;
+    viewport.TopLeftY = 0.0f;
+    viewport.Width = static_cast<float>(d3d12Context.getFrameSize().x);
+    viewport.Height = static_cast<float>(d3d12Context.getFrameSize().y);
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
 
-        D3D12_RECT scissorRect{static_cast<LONG>(viewport.TopLeftX), static_cast<LONG>(viewport.TopLeftY),
-                               static_cast<LONG>(viewport.Width), static_cast<LONG>(viewport.Height)};
+    D3D12_RECT scissorRect{static_cast<LONG>(viewport.TopLeftX), static_cast<LONG>(viewport.TopLeftY),
+                           static_cast<LONG>(viewport.Width), static_cast<LONG>(viewport.Height)};
 
-        // Set necessary state.
+    // Descriptor heaps need to be set before setting the root signature when using dynamic resources.
+    // https://microsoft.github.io/DirectX-Specs/d3d/HLSL_SM_6_6_DynamicResources.html#setdescriptorheaps-and-setrootsignature
+    std::array<ID3D12DescriptorHeap*, 1> descriptorHeaps = {d3d12Context.getCbvSrvUavHeap().getGpuDescriptorHeap()};
+    commandList.setDescriptorHeaps(descriptorHeaps);
 
-        // Descriptor heaps need to be set before setting the root signature when using dynamic resources.
-        // https://microsoft.github.io/DirectX-Specs/d3d/HLSL_SM_6_6_DynamicResources.html#setdescriptorheaps-and-setrootsignature
-        std::array<ID3D12DescriptorHeap*, 1> descriptorHeaps = {d3d12Context.getCbvSrvUavHeap().getGpuDescriptorHeap()};
-        mCommandList.get()->SetDescriptorHeaps((UINT)descriptorHeaps.size(), descriptorHeaps.data());
+    commandList.setGraphicsRootSignature(mRootSignature.Get());
 
-        mCommandList.get()->SetGraphicsRootSignature(mRootSignature.Get());
+    commandList.get()->SetGraphicsRootConstantBufferView(d3d12::RasterRootParamSlot::FrameCB,
+                                                         mFrameConstantBuffer->getResource()->GetGPUVirtualAddress());
 
-        mCommandList.get()->SetGraphicsRootConstantBufferView(
-            d3d12::RasterRootParamSlot::FrameCB, mFrameConstantBuffer->getResource()->GetGPUVirtualAddress());
+    mFrameConstantBuffer->markAsUsed(commandList.get());
 
-        mCommandList.get()->SetGraphicsRootConstantBufferView(
-            d3d12::RasterRootParamSlot::ObjectCB, mObjectConstantBuffer->getResource()->GetGPUVirtualAddress());
+    commandList.get()->RSSetViewports(1, &viewport);
+    commandList.get()->RSSetScissorRects(1, &scissorRect);
 
-        mFrameConstantBuffer->markAsUsed(mCommandList.get());
-        mObjectConstantBuffer->markAsUsed(mCommandList.get());
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3d12Context.getBackBufferRtv();
+    D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = mDepthStencilTexture->getDsvCpu();
+    commandList.get()->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
 
-        mCommandList.get()->RSSetViewports(1, &viewport);
-        mCommandList.get()->RSSetScissorRects(1, &scissorRect);
+    mDepthStencilTexture->markAsUsed(commandList.get());
+}
 
-        // Indicate that the back buffer will be used as a render target.
-        D3D12_RESOURCE_BARRIER renderTargetBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            d3d12Context.getBackBuffer(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+void RasterRenderer::drawRenderObjects(d3d12::GraphicsCommandList& commandList,
+                                       const RenderParams& renderParams,
+                                       size_t firstObject,
+                                       size_t objectCount)
+{
+    SCRAP_CPU_ZONE("RasterRenderer::drawRenderObjects");
 
-        mCommandList.get()->ResourceBarrier(1, &renderTargetBarrier);
+    // Read straight from the frame's upload memory. Upload heap resources are always readable as constant buffers, so
+    // there's no copy or transition per object. The whole range's constants are allocated at once, so recording
+    // workers only contend on the pool once per chunk.
+    constexpr size_t kObjectConstantsStride =
+        d3d12::UploadBufferPool::AlignAllocationSize(sizeof(ObjectConstantBuffer));
+    auto& uploadBufferPool = d3d12::DeviceContext::instance().getGraphicsContext().getUploadBufferPool();
+    const d3d12::UploadBufferAllocation objectConstantsAllocation =
+        uploadBufferPool.allocate(objectCount * kObjectConstantsStride);
 
-        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3d12Context.getBackBufferRtv();
-        D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = mDepthStencilTexture->getDsvCpu();
-        mCommandList.get()->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+    if(objectConstantsAllocation.writeBuffer.empty()) { return; }
 
-        mDepthStencilTexture->markAsUsed(mCommandList.get());
+    for(size_t objectIndex = firstObject; objectIndex < firstObject + objectCount; ++objectIndex)
+    {
+        RenderObject& renderObject = renderParams.renderObjects[objectIndex];
 
-        // Record commands.
-        const float clearColor[] = {0.0f, 0.2f, 0.4f, 1.0f};
-        mCommandList.get()->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-        mCommandList.get()->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+        // The binding layout isn't available until the shader is done compiling
+        if(!renderObject.mMaterial.mRasterPipelineState->isReady()) { continue; }
 
-        auto& uploadBufferPool = d3d12::DeviceContext::instance().getGraphicsContext().getUploadBufferPool();
+        const ShaderBindingIndices& bindings = CompileMaterialBindings(
+            renderObject.mMaterial.mRasterBindings,
+            renderObject.mMaterial.mRasterPipelineState->getShader()->getBindingLayout(), renderObject.mMaterial,
+            *renderObject.mGpuMesh);
 
-        for(RenderObject& renderObject : renderParams.renderObjects)
         {
-            bindTextures(renderObject.mMaterial);
+            const ObjectConstantBuffer objectConstants = MakeObjectConstants(
+                renderParams.transforms[objectIndex].getMatrix4x4(), renderParams.frameConstants);
+
+            const size_t byteOffset = (objectIndex - firstObject) * kObjectConstantsStride;
+            std::memcpy(objectConstantsAllocation.writeBuffer.data() + byteOffset, &objectConstants,
+                        sizeof(objectConstants));
+            commandList.get()->SetGraphicsRootConstantBufferView(
+                d3d12::RasterRootParamSlot::ObjectCB, objectConstantsAllocation.gpuVirtualAddress + byteOffset);
+        }
 
-            {
-                glm::mat4x3 transformMat = renderObject.mTransform.getMatrix4x4();
-
-                const ObjectConstantBuffer objectConstants{
-                    .objectToWorld = glm::transpose(transformMat),
-                    .worldToObject = glm::inverse(objectConstants.objectToWorld),
-                    .objectToView = glm::transpose(renderParams.frameConstants.worldToView *
-                                                   static_cast<glm::mat4x4>(transformMat)),
-                    .viewToObject = glm::inverse(objectConstants.objectToView),
-                    .objectToClip = glm::transpose(renderParams.frameConstants.worldToClip *
-                                                   static_cast<glm::mat4x4>(transformMat)),
-                    .clipToObject = glm::inverse(objectConstants.objectToClip)};
-
-                d3d12::UploadBufferMap bufferMap = uploadBufferPool.map(sizeof(ObjectConstantBuffer));
-                std::memcpy(bufferMap.writeBuffer.data(), &objectConstants, sizeof(objectConstants));
-                d3d12::UploadBufferCopyData copyData = uploadBufferPool.unmap(bufferMap);
-                mCommandList.get()->CopyBufferRegion(mObjectConstantBuffer->getResource(), 0, copyData.buffer, copyData.byteOffset, copyData.byteSize);
-            }
+        d3d12::drawIndexed(commandList, d3d12::DrawIndexedParams{
+                                            .indexBuffer = renderObject.mGpuMesh->getIndexBuffer().get(),
+                                            .pipelineState = renderObject.mMaterial.mRasterPipelineState.get(),
+                                            .vertexBuffers = renderObject.mGpuMesh->getVertexElements(),
+                                            .bindings = &bindings,
+                                            .primitiveTopology = renderObject.mGpuMesh->getPrimitiveTopology(),
+                                            .indexCount = renderObject.mGpuMesh->getIndexCount(),
+                                            .instanceCount = 1});
+    }
+}
 
-            d3d12::drawIndexed(mCommandList, d3d12::DrawIndexedParams{
-                                                 .indexBuffer = renderObject.mGpuMesh->getIndexBuffer().get(),
-                                                 .pipelineState = renderObject.mMaterial.mRasterPipelineState.get(),
-                                                 .vertexBuffers = renderObject.mGpuMesh->getVertexElements(),
-                                                 .primitiveTopology = renderObject.mGpuMesh->getPrimitiveTopology(),
-                                                 .indexCount = renderObject.mGpuMesh->getIndexCount(),
-                                                 .instanceCount = 1});
-        }
+void RasterRenderer::render(const FrameInfo& frameInfo, const RenderParams& renderParams)
+{
+    SCRAP_CPU_ZONE("RasterRenderer::render");
+
+    d3d12::DeviceContext& d3d12Context = d3d12::DeviceContext::instance();
+
+    const bool recordInParallel =
+        mParallelRecordingEnabled && renderParams.renderObjects.size() >= 2 * kMinObjectsPerRecordingChunk;
+
+    mRenderGraph.reset();
+
+    const RenderGraphResourceHandle backBuffer = mRenderGraph.importResource("BackBuffer", ResourceState::Present);
+    const RenderGraphResourceHandle depthStencil =
+        mRenderGraph.importResource("DepthStencil", ResourceState::DepthWrite);
+
+    mRenderGraph
+        .addPass("RasterRenderer",
+                 [&]() {
+                     {
+                         d3d12::ScopedGpuEvent gpuEvent(mCommandList.get(), "RasterRenderer");
+
+                         bindPassState(mCommandList);
+
+                         // Record commands.
+                         const float clearColor[] = {0.0f, 0.2f, 0.4f, 1.0f};
+                         mCommandList.get()->ClearRenderTargetView(d3d12Context.getBackBufferRtv(), clearColor, 0,
+                                                                   nullptr);
+                         mCommandList.get()->ClearDepthStencilView(mDepthStencilTexture->getDsvCpu(),
+                                                                   D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+
+                         if(!recordInParallel)
+                         {
+                             drawRenderObjects(mCommandList, renderParams, 0, renderParams.renderObjects.size());
+                             return;
+                         }
+                     }
+
+                     mParallelRecorder.record(
+                         renderParams.renderObjects.size(), kMinObjectsPerRecordingChunk,
+                         [&](d3d12::GraphicsCommandList& commandList, const RecordingChunk& chunk) {
+                             d3d12::ScopedGpuEvent gpuEvent(commandList.get(), "RasterRenderer Chunk");
+
+                             bindPassState(commandList);
+                             drawRenderObjects(commandList, renderParams, chunk.begin, chunk.count);
+                         });
+
+                     // The chunk command lists are submitted after mCommandList, so the transition back to present
+                     // has to go in a command list that is submitted after them.
+                     mPresentCommandList.beginRecording();
+                     mRenderGraphExecutor.setCommandList(mPresentCommandList);
+                 })
+        .write(backBuffer, ResourceState::RenderTarget)
+        .write(depthStencil, ResourceState::DepthWrite);
+
+    // The pass switches command lists part way through, so split barriers can't be used
+    if(auto error = mRenderGraph.compile({.splitBarriers = false}); error.has_value())
+    {
+        spdlog::error("Failed to compile raster render graph. {}", error.value());
+        return;
+    }
 
-        // Indicate that the back buffer will now be used to present.
-        renderTargetBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            d3d12Context.getBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+    // Indexed by the resource handles above
+    const std::array<ID3D12Resource*, 2> resources{d3d12Context.getBackBuffer(), mDepthStencilTexture->getResource()};
+    mRenderGraphExecutor.execute(mRenderGraph, mCommandList, resources);
 
-        mCommandList.get()->ResourceBarrier(1, &renderTargetBarrier);
+    if(!recordInParallel)
+    {
+        mCommandList.execute(d3d12Context.getGraphicsContext().getCommandQueue());
+        return;
     }
 
-    mCommandList.execute(d3d12Context.getGraphicsContext().getCommandQueue());
+    std::array<d3d12::GraphicsCommandList*, 1> leadingCommandLists{&mCommandList};
+    std::array<d3d12::GraphicsCommandList*, 1> trailingCommandLists{&mPresentCommandList};
+    mParallelRecorder.execute(d3d12Context.getGraphicsContext().getCommandQueue(), leadingCommandLists,
+                              trailingCommandLists);
 }
 
 void RasterRenderer::endFrame()
 {
     mCommandList.endFrame();
+    mPresentCommandList.endFrame();
+    mParallelRecorder.endFrame();
 }
 
 std::shared_ptr<d3d12::GraphicsPipelineState>
-RasterRenderer::createPipelineState(d3d12::GraphicsShaderParams&& shaderParams,
+RasterRenderer::createPipelineState(std::shared_ptr<d3d12::GraphicsShader> shader,
                                     d3d12::GraphicsPipelineStateParams&& pipelineStateParams)
 {
     pipelineStateParams.rootSignature = mRootSignature;
-    pipelineStateParams.shader = std::make_shared<d3d12::GraphicsShader>(std::move(shaderParams));
+    pipelineStateParams.shader = std::move(shader);
     pipelineStateParams.renderTargetFormats = {DXGI_FORMAT_R8G8B8A8_UNORM};
     pipelineStateParams.depthStencilFormat = DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
 
@@ -374,60 +494,68 @@ RasterRenderer::createPipelineState(d3d12::GraphicsShaderParams&& shaderParams,
 //=====================================
 // RayTraceScene
 //=====================================
-RaytracingRenderer::RaytracingRenderer()
+RaytracingRenderer::RaytracingRenderer(uint32_t hitGroupRecordCapacity)
     : mCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, "RaytracingRenderer Command List")
+    , mHitGroupRecordCapacity(hitGroupRecordCapacity)
 {
     mCommandList.beginRecording();
+}
 
-    if(!createRenderTargets())
-    {
-        spdlog::critical("Failed to create raytracing render target.");
-        return;
-    }
+RaytracingRenderer::RaytracingRenderer(RaytracingRenderer&&) = default;
+RaytracingRenderer::~RaytracingRenderer() = default;
+RaytracingRenderer& RaytracingRenderer::operator=(RaytracingRenderer&&) = default;
 
-    if(!createRootSignatures())
-    {
-        spdlog::critical("Failed to create raytracing root signatures.");
-        return;
-    }
+InitTaskId RaytracingRenderer::addInitTasks(InitGraph& initGraph)
+{
+    const InitTaskId rootSignatureTask =
+        initGraph.addTask("Raytracing root signatures", [this]() { return createRootSignatures(); });
 
-    if(!createInternalPipelineStates())
-    {
-        spdlog::critical("Failed to create raytracing pipeline state.");
-        return;
-    }
+    const InitTaskId renderTargetTask =
+        initGraph.addTask("Raytracing render target", [this]() { return createRenderTargets(); });
 
-    if(!buildAccelerationStructures())
-    {
-        spdlog::critical("Failed to create raytracing acceleration structures.");
-        return;
-    }
+    const InitTaskId mainPassShaderTask =
+        initGraph.addTask("Compile raytracing main pass shader", [this]() { return compileMainPassShader(); });
 
-    if(!buildShaderTables())
-    {
-        spdlog::critical("Failed to create raytracing shader tables.");
-        return;
-    }
+    const InitTaskId pipelineStateTask =
+        initGraph.addTask("Raytracing internal pipeline states", [this]() { return createInternalPipelineStates(); },
+                          {rootSignatureTask, mainPassShaderTask});
+
+    const InitTaskId accelerationStructureTask =
+        initGraph.addTask("Raytracing acceleration structures", [this]() { return buildAccelerationStructures(); });
+
+    // The only task that records into mCommandList
+    const InitTaskId shaderTableTask = initGraph.addTask(
+        "Raytracing shader tables", [this]() { return buildShaderTables(); },
+        {pipelineStateTask, accelerationStructureTask});
 
-    d3d12::DeviceContext::instance().getCopyContext().execute();
-    d3d12::DeviceContext::instance().getCopyContext().waitOnGpu();
+    mInitTasks = {rootSignatureTask, renderTargetTask,          mainPassShaderTask,
+                  pipelineStateTask, accelerationStructureTask, shaderTableTask};
+
+    return rootSignatureTask;
+}
+
+void RaytracingRenderer::finishInit(const InitGraph& initGraph)
+{
+    if(!initGraph.hasSucceeded(mInitTasks)) { return; }
 
     mCommandList.execute(d3d12::DeviceContext::instance().getGraphicsContext().getCommandQueue());
 
     mInitialized = true;
 }
 
-RaytracingRenderer::RaytracingRenderer(RaytracingRenderer&&) = default;
-RaytracingRenderer::~RaytracingRenderer() = default;
-RaytracingRenderer& RaytracingRenderer::operator=(RaytracingRenderer&&) = default;
-
 void RaytracingRenderer::preRender(const FrameInfo& frameInfo, const RenderParams& renderParams)
 {
+    SCRAP_CPU_ZONE("RaytracingRenderer::preRender");
+
     mCommandList.beginRecording();
 
     {
         d3d12::ScopedGpuEvent gpuEvent(mCommandList.get(), "Update Constant Buffers");
 
+        // The write guard copies into the buffer when it goes out of scope
+        mCommandList.transitionResource(*mFrameConstantBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+        mCommandList.flushResourceBarriers();
+
         d3d12::GpuBufferWriteGuard writeGuard(*mFrameConstantBuffer, mCommandList.get());
         auto& frameConstantBuffer = writeGuard.getWriteBufferAs<FrameConstantBuffer>().front();
         frameConstantBuffer = renderParams.frameConstants;
@@ -439,157 +567,204 @@ void RaytracingRenderer::preRender(const FrameInfo& frameInfo, const RenderParam
         frameConstantBuffer.clipToWorld = glm::transpose(frameConstantBuffer.clipToWorld);
     }
 
+    mCommandList.transitionResource(*mFrameConstantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+
     if(!mShaderTable->isReady()) { return; }
 
+    SCRAP_CPU_ZONE("Update materials");
     d3d12::ScopedGpuEvent updateMaterialsEvent(mCommandList.get(), "Update Materials");
-    struct BindlessIndices
-    {
-        std::array<uint32_t, d3d12::kMaxBindlessResources> resourceIndices = {};
-        std::array<uint32_t, d3d12::kMaxBindlessVertexBuffers> vertexBufferIndices = {};
-    } bindlessIndices;
 
     mShaderTable->beginUpdate(mCommandList);
 
-    for(RenderObject& renderObject : renderParams.renderObjects)
-    {
-        mStringBuffer.clear();
-        fmt::format_to(std::back_inserter(mStringBuffer), "{} {}", renderObject.name, renderObject.mId.value());
-        d3d12::ScopedGpuEvent renderObjectEvent(mCommandList.get(), mStringBuffer);
+#if SCRAP_GPU_OBJECT_EVENTS_ENABLED
+    const bool recordObjectEvents = AreGpuObjectEventsEnabled();
+#endif
 
-        std::shared_ptr<d3d12::BLAccelerationStructure>& blas = renderObject.mGpuMesh->accessBlas();
-        if(blas->getBuildState() == d3d12::AccelerationStructureState::Invalid) { blas->build(mCommandList); }
+    for(size_t objectIndex = 0; objectIndex < renderParams.renderObjects.size(); ++objectIndex)
+    {
+        RenderObject& renderObject = renderParams.renderObjects[objectIndex];
 
-        if(!renderObject.mInstanceAllocation.isValid())
+#if SCRAP_GPU_OBJECT_EVENTS_ENABLED
+        std::optional<d3d12::ScopedGpuEvent> renderObjectEvent;
+        if(recordObjectEvents)
         {
-            auto addResult = mTlas->addInstance(
-                d3d12::TLAccelerationStructureInstanceParams{.accelerationStructure = renderObject.mGpuMesh->getBlas(),
-                                                             .transform = glm::identity<glm::mat4x3>(),
-                                                             .flags = d3d12::TlasInstanceFlags::TriangleFrontCcw,
-                                                             .instanceId = renderObject.mId.value()});
-
-            if(!addResult) { continue; }
-
-            renderObject.mInstanceAllocation = std::move(addResult.value());
+            renderObjectEvent.emplace(mCommandList.get(),
+                                      mObjectEventLabels.getObjectLabel(renderObject.mId.value(), renderObject.name));
         }
+#endif
 
-        renderObject.mInstanceAllocation.updateTransform(renderObject.mTransform.getMatrix4x4());
+        std::shared_ptr<d3d12::RaytracingShader> shader = renderObject.mMaterial.mRaytracingPipelineState->getShader();
+        const ShaderBindingLayout* bindingLayout = shader->getBindingLayout(RaytracingShaderStage::ClosestHit);
 
-        if(!renderObject.mMaterial.mShaderTableAllocation.isValid())
+        if(bindingLayout == nullptr) { continue; }
+
+        // Objects with the same pipeline state and bindings share a hit group record. The record only has to be
+        // looked up again when the bindings are recompiled.
+        if(!renderObject.mMaterial.mRaytracingBindings.isCompiledFor(bindingLayout, renderObject.mGpuMesh.get()) ||
+           !renderObject.mMaterial.mHitGroupIndex.has_value())
         {
-            mDispatchPipelineState->addPipelineState(renderObject.mMaterial.mRaytracingPipelineState);
+            const ShaderBindingIndices& bindings =
+                CompileMaterialBindings(renderObject.mMaterial.mRaytracingBindings, *bindingLayout,
+                                        renderObject.mMaterial, *renderObject.mGpuMesh);
 
-            auto addResult =
-                mShaderTable->addPipelineState(renderObject.mMaterial.mRaytracingPipelineState, {}, mCommandList.get());
+            renderObject.mMaterial.mHitGroupIndex =
+                getHitGroupRecord(renderObject.mMaterial.mRaytracingPipelineState, bindings);
 
-            if(!addResult) { continue; }
+            // Without a record the object can't be hit, so it stays out of the TLAS
+            if(!renderObject.mMaterial.mHitGroupIndex.has_value()) { continue; }
 
-            renderObject.mMaterial.mShaderTableAllocation = std::move(addResult.value());
+            if(renderObject.mInstanceAllocation.isValid())
+            {
+                renderObject.mInstanceAllocation.updateHitGroupIndex(renderObject.mMaterial.mHitGroupIndex.value());
+            }
         }
 
-        std::shared_ptr<d3d12::RaytracingShader> shader = renderObject.mMaterial.mRaytracingPipelineState->getShader();
+        std::shared_ptr<d3d12::BLAccelerationStructure>& blas = renderObject.mGpuMesh->accessBlas();
+        if(blas->getBuildState() == d3d12::AccelerationStructureState::Invalid) { blas->build(mCommandList); }
 
-        { // bind vertex buffers
-            // creating an array with one more than necessary to give a slot to assign buffers not used by the
-            // shader.
-            for(const d3d12::VertexBuffer& vertexElement : renderObject.mGpuMesh->getVertexElements())
+        if(!renderObject.mInstanceAllocation.isValid())
+        {
+            auto addResult = mTlas->addInstance(d3d12::TLAccelerationStructureInstanceParams{
+                .accelerationStructure = renderObject.mGpuMesh->getBlas(),
+                .transform = glm::identity<glm::mat4x3>(),
+                .flags = d3d12::TlasInstanceFlags::TriangleFrontCcw,
+                .instanceId = renderObject.mId.value(),
+                .instanceContributionToHitGroupIndex = renderObject.mMaterial.mHitGroupIndex.value()});
+
+            if(!addResult)
             {
-                const std::optional<uint32_t> constantBufferIndex = shader->getVertexElementIndex(
-                    RaytracingShaderStage::ClosestHit, vertexElement.semantic, vertexElement.semanticIndex);
-
-                if(!constantBufferIndex) { continue; }
-                bindlessIndices.vertexBufferIndices[constantBufferIndex.value()] =
-                    vertexElement.buffer->getSrvDescriptorHeapIndex();
-
-                vertexElement.buffer->markAsUsed(mCommandList.get());
+                spdlog::error("Failed to add a TLAS instance for render object {}", renderObject.mId.value());
+                continue;
             }
+
+            renderObject.mInstanceAllocation = std::move(addResult.value());
         }
 
-        { // bind index buffer
-            const std::optional<uint32_t> indexBufferIndex =
-                shader->getResourceIndex(RaytracingShaderStage::ClosestHit, SharedString("IndexBuffer"),
-                                         ShaderResourceType::Buffer, ShaderResourceDimension::Buffer);
+        renderObject.mInstanceAllocation.updateTransform(renderParams.transforms[objectIndex].getMatrix4x4());
 
-            if(indexBufferIndex)
-            {
-                bindlessIndices.resourceIndices[indexBufferIndex.value()] =
-                    renderObject.mGpuMesh->getIndexBuffer()->getSrvDescriptorHeapIndex();
-
-                renderObject.mGpuMesh->getIndexBuffer()->markAsUsed(mCommandList.get());
-            }
+        for(const d3d12::VertexBuffer& vertexElement : renderObject.mGpuMesh->getVertexElements())
+        {
+            vertexElement.buffer->markAsUsed(mCommandList.get());
         }
 
-        // bind resources
+        renderObject.mGpuMesh->getIndexBuffer()->markAsUsed(mCommandList.get());
+
         for(const auto& [key, texture] : renderObject.mMaterial.textures)
         {
-            const std::optional<uint32_t> textureIndex =
-                shader->getResourceIndex(RaytracingShaderStage::ClosestHit, key, ShaderResourceType::Texture,
-                                         texture->getShaderResourceDimension());
-
-            if(textureIndex)
-            {
-                bindlessIndices.resourceIndices[textureIndex.value()] = texture->getSrvDescriptorHeapIndex();
-                texture->markAsUsed(mCommandList.get());
-            }
+            texture->markAsUsed(mCommandList.get());
         }
-
-        renderObject.mMaterial.mShaderTableAllocation.updateLocalRootArguments(
-            RaytracingPipelineStage::HitGroup, ToByteSpan(bindlessIndices), mCommandList.get());
     }
 
     mShaderTable->endUpdate(mCommandList);
 }
 
-void RaytracingRenderer::render(const FrameInfo& frameInfo, const RenderParams& renderParams)
+std::optional<uint32_t>
+RaytracingRenderer::getHitGroupRecord(const std::shared_ptr<d3d12::RaytracingPipelineState>& pipelineState,
+                                      const ShaderBindingIndices& bindings)
 {
-    d3d12::DeviceContext& d3d12Context = d3d12::DeviceContext::instance();
+    const HitGroupRecordKey key{.pipelineState = pipelineState.get(), .bindings = bindings};
 
+    auto itr = mHitGroupRecords.find(key);
+    if(itr == mHitGroupRecords.end())
     {
-        d3d12::ScopedGpuEvent buildTlasEvent(mCommandList.get(), "Build TLAS");
-        mTlas->build(mCommandList);
-    }
-
-    mCommandList.get()->SetComputeRootSignature(mGlobalRootSignature.Get());
+        mDispatchPipelineState->addPipelineState(pipelineState);
 
-    {
-        d3d12::ScopedGpuEvent mainPassEvent(mCommandList.get(), "Main Pass");
-
-        std::array<d3d12::TLAccelerationStructure*, 1> accelerationStructures{mTlas.get()};
-        std::array<d3d12::Texture*, 1> rwTextures{mRenderTarget.get()};
+        auto addResult = mShaderTable->addPipelineState(pipelineState, {}, mCommandList.get());
+        if(!addResult)
+        {
+            if(!mHitGroupTableFullLogged)
+            {
+                spdlog::error("The hit group table is full at {} records. Objects without a record aren't raytraced.",
+                              mHitGroupRecordCapacity);
+                mHitGroupTableFullLogged = true;
+            }
 
-        d3d12::EngineConstantBuffers engineConstantBuffers;
-        engineConstantBuffers.frame = mFrameConstantBuffer.get();
+            return std::nullopt;
+        }
 
-        auto windowSize = frameInfo.mainWindow->getSize();
+        addResult->updateLocalRootArguments(RaytracingPipelineStage::HitGroup, ToByteSpan(bindings),
+                                            mCommandList.get());
 
-        d3d12::dispatchRays(mCommandList, d3d12::DispatchRaysParams{.pipelineState = mDispatchPipelineState.get(),
-                                                                    .accelerationStructures = accelerationStructures,
-                                                                    .shaderTable = mShaderTable.get(),
-                                                                    .constantBuffers = engineConstantBuffers,
-                                                                    .rwTextures = rwTextures,
-                                                                    .dimensions = {windowSize.x, windowSize.y, 1}});
+        itr = mHitGroupRecords.emplace(key, std::move(addResult.value())).first;
     }
 
-    {
-        d3d12::ScopedGpuEvent presentEvent(mCommandList.get(), "Copy To Backbuffer");
-
-        D3D12_RESOURCE_BARRIER preCopyBarriers[2];
-        preCopyBarriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(
-            d3d12Context.getBackBuffer(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_COPY_DEST);
-        preCopyBarriers[1] = CD3DX12_RESOURCE_BARRIER::Transition(
-            mRenderTarget->getResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
-        mCommandList.get()->ResourceBarrier(ARRAYSIZE(preCopyBarriers), preCopyBarriers);
+    return (uint32_t)itr->second.getRecordIndex(RaytracingPipelineStage::HitGroup);
+}
 
-        mCommandList.get()->CopyResource(d3d12Context.getBackBuffer(), mRenderTarget->getResource());
+void RaytracingRenderer::render(const FrameInfo& frameInfo, const RenderParams& renderParams)
+{
+    SCRAP_CPU_ZONE("RaytracingRenderer::render");
 
-        D3D12_RESOURCE_BARRIER postCopyBarriers[2];
-        postCopyBarriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(
-            d3d12Context.getBackBuffer(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PRESENT);
-        postCopyBarriers[1] = CD3DX12_RESOURCE_BARRIER::Transition(
-            mRenderTarget->getResource(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    d3d12::DeviceContext& d3d12Context = d3d12::DeviceContext::instance();
 
-        mCommandList.get()->ResourceBarrier(ARRAYSIZE(postCopyBarriers), postCopyBarriers);
+    mRenderGraph.reset();
+
+    const RenderGraphResourceHandle backBuffer = mRenderGraph.importResource("BackBuffer", ResourceState::Present);
+    const RenderGraphResourceHandle renderTarget =
+        mRenderGraph.importResource("RaytracingRenderTarget", ResourceState::UnorderedAccess);
+    const RenderGraphResourceHandle tlas =
+        mRenderGraph.importResource("TLAS", ResourceState::RaytracingAccelerationStructure);
+
+    // Indexed by the resource handles above. The TLAS buffer can be recreated by the build, so its entry is filled in
+    // by the build pass.
+    std::array<ID3D12Resource*, 3> resources{d3d12Context.getBackBuffer(), mRenderTarget->getResource(), nullptr};
+
+    mRenderGraph
+        .addPass("Build TLAS",
+                 [&]() {
+                     d3d12::ScopedGpuEvent buildTlasEvent(mCommandList.get(), "Build TLAS");
+
+                     if(mTlas->build(mCommandList))
+                     {
+                         resources[tlas.index()] = mTlas->getAccelerationStructureBuffer().getResource();
+                     }
+                 })
+        .write(tlas, ResourceState::RaytracingAccelerationStructure);
+
+    mRenderGraph
+        .addPass("Main Pass",
+                 [&]() {
+                     mCommandList.setComputeRootSignature(mGlobalRootSignature.Get());
+
+                     d3d12::ScopedGpuEvent mainPassEvent(mCommandList.get(), "Main Pass");
+
+                     std::array<d3d12::TLAccelerationStructure*, 1> accelerationStructures{mTlas.get()};
+                     std::array<d3d12::Texture*, 1> rwTextures{mRenderTarget.get()};
+
+                     d3d12::EngineConstantBuffers engineConstantBuffers;
+                     engineConstantBuffers.frame = mFrameConstantBuffer.get();
+
+                     const glm::i32vec2 windowSize = renderParams.viewportSize;
+
+                     d3d12::dispatchRays(mCommandList,
+                                         d3d12::DispatchRaysParams{.pipelineState = mDispatchPipelineState.get(),
+                                                                   .accelerationStructures = accelerationStructures,
+                                                                   .shaderTable = mShaderTable.get(),
+                                                                   .constantBuffers = engineConstantBuffers,
+                                                                   .rwTextures = rwTextures,
+                                                                   .dimensions = {windowSize.x, windowSize.y, 1}});
+                 })
+        .read(tlas, ResourceState::RaytracingAccelerationStructure)
+        .write(renderTarget, ResourceState::UnorderedAccess);
+
+    mRenderGraph
+        .addPass("Copy To Backbuffer",
+                 [&]() {
+                     d3d12::ScopedGpuEvent presentEvent(mCommandList.get(), "Copy To Backbuffer");
+
+                     mCommandList.get()->CopyResource(d3d12Context.getBackBuffer(), mRenderTarget->getResource());
+                 })
+        .read(renderTarget, ResourceState::CopySource)
+        .write(backBuffer, ResourceState::CopyDest);
+
+    if(auto error = mRenderGraph.compile(); error.has_value())
+    {
+        spdlog::error("Failed to compile raytracing render graph. {}", error.value());
+        return;
     }
 
+    mRenderGraphExecutor.execute(mRenderGraph, mCommandList, resources);
+
     mCommandList.execute(d3d12::DeviceContext::instance().getGraphicsContext().getCommandQueue());
 }
 
@@ -758,6 +933,25 @@ bool RaytracingRenderer::createRootSignatures()
     return true;
 }
 
+bool RaytracingRenderer::compileMainPassShader()
+{
+    std::array<d3d12::RaytracingFixedStageShaderEntryPoint, 2> fixedStageShaderEntryPoints = {
+        d3d12::RaytracingFixedStageShaderEntryPoint{RaytracingShaderStage::RayGen, SharedString("mainPassRaygen")},
+        d3d12::RaytracingFixedStageShaderEntryPoint{RaytracingShaderStage::Miss, SharedString("mainPassMiss")}};
+
+    d3d12::RaytracingShaderParams shaderParams;
+    shaderParams.filepath = "assets/raytracing_mainpass.hlsl";
+    shaderParams.fixedStageEntryPoints = fixedStageShaderEntryPoints;
+
+#ifdef _DEBUG
+    shaderParams.debug = true;
+#endif
+    mMainPassShader = std::make_shared<d3d12::RaytracingShader>(std::move(shaderParams));
+    mMainPassShader->create();
+
+    return mMainPassShader->status() == d3d12::RaytracingShaderState::Compiled;
+}
+
 bool RaytracingRenderer::createInternalPipelineStates()
 {
     { // Dispatch pipeline state
@@ -770,30 +964,14 @@ bool RaytracingRenderer::createInternalPipelineStates()
     }
 
     { // Main pass pipeline state
-        SharedString raygenEntryPointName("mainPassRaygen");
-        SharedString missEntryPointName("mainPassMiss");
-
-        std::array<d3d12::RaytracingFixedStageShaderEntryPoint, 2> fixedStageShaderEntryPoints = {
-            d3d12::RaytracingFixedStageShaderEntryPoint{RaytracingShaderStage::RayGen, raygenEntryPointName},
-            d3d12::RaytracingFixedStageShaderEntryPoint{RaytracingShaderStage::Miss, missEntryPointName}};
-
-        d3d12::RaytracingShaderParams shaderParams;
-        shaderParams.filepath = "assets/raytracing_mainpass.hlsl";
-        shaderParams.fixedStageEntryPoints = fixedStageShaderEntryPoints;
-
-#ifdef _DEBUG
-        shaderParams.debug = true;
-#endif
-        auto shader = std::make_shared<d3d12::RaytracingShader>(std::move(shaderParams));
-
         d3d12::RaytracingPipelineStateParams pipelineStateParams;
-        pipelineStateParams.shader = shader;
+        pipelineStateParams.shader = mMainPassShader;
 
         pipelineStateParams.fixedStages[RaytracingShaderStage::RayGen] = d3d12::RaytracingPipelineStateShaderParams{
-            .shaderEntryPointIndex = shader->getFixedStageIndex(RaytracingShaderStage::RayGen, raygenEntryPointName)};
+            .shaderEntryPointIndex = mMainPassShader->getFixedStageShader(RaytracingShaderStage::RayGen, 0)->index};
 
         pipelineStateParams.fixedStages[RaytracingShaderStage::Miss] = d3d12::RaytracingPipelineStateShaderParams{
-            .shaderEntryPointIndex = shader->getFixedStageIndex(RaytracingShaderStage::Miss, missEntryPointName)};
+            .shaderEntryPointIndex = mMainPassShader->getFixedStageShader(RaytracingShaderStage::Miss, 0)->index};
 
         // pipelineStateParams.hitGroupName = hitGroupName;
         pipelineStateParams.primitiveType = d3d12::RaytracingPipelineStatePrimitiveType::Triangles;
@@ -809,10 +987,8 @@ bool RaytracingRenderer::createInternalPipelineStates()
 }
 
 std::shared_ptr<d3d12::RaytracingPipelineState>
-RaytracingRenderer::createPipelineState(d3d12::RaytracingShaderParams&& shaderParams)
+RaytracingRenderer::createPipelineState(std::shared_ptr<d3d12::RaytracingShader> shader)
 {
-    auto shader = std::make_shared<d3d12::RaytracingShader>(std::move(shaderParams));
-
     d3d12::RaytracingPipelineStateParams pipelineStateParams{};
     pipelineStateParams.shader = shader;
 
@@ -837,7 +1013,7 @@ RaytracingRenderer::createPipelineState(d3d12::RaytracingShaderParams&& shaderPa
         callableParams.emplace_back(d3d12::RaytracingPipelineStateShaderParams{.shaderEntryPointIndex = i});
     }
 
-    std::string hitGroupName = fmt::format("{} hit group", shaderParams.filepath.generic_string());
+    std::string hitGroupName = fmt::format("{} hit group", shader->getFilepath().generic_string());
     pipelineStateParams.hitGroupName = hitGroupName;
 
     auto pipelineState = std::make_shared<d3d12::RaytracingPipelineState>(std::move(pipelineStateParams));
@@ -875,7 +1051,7 @@ bool RaytracingRenderer::buildShaderTables()
     params.raygen.capacity = 1;
     params.hitGroup.entryByteStride =
         sizeof(uint32_t) * (d3d12::kMaxBindlessVertexBuffers + d3d12::kMaxBindlessResources);
-    params.hitGroup.capacity = mTlas->getCapacity();
+    params.hitGroup.capacity = mHitGroupRecordCapacity;
     params.miss.entryByteStride = 0;
     params.miss.capacity = 1;
     params.name = "Shader Table";
@@ -896,21 +1072,120 @@ bool RaytracingRenderer::buildShaderTables()
 // RenderScene
 //=====================================
 
-RenderScene::RenderScene()
+namespace
+{
+// Black and color cells, 8 across
+cputex::UniqueTexture GenerateCheckerboardTexture(uint32_t extent, const std::array<uint8_t, 3>& color)
+{
+    SCRAP_MEMORY_TAG(Texture);
+
+    cputex::TextureParams textureParams;
+    textureParams.dimension = cputex::TextureDimension::Texture2D;
+    textureParams.extent = {extent, extent, 1};
+    textureParams.faces = 1;
+    textureParams.mips = cputex::maxMips(textureParams.extent);
+    textureParams.arraySize = 1;
+    textureParams.format = gpufmt::Format::R8G8B8A8_UNORM;
+    cputex::UniqueTexture cpuTexture{textureParams};
+
+    for(uint32_t mip = 0; mip < textureParams.mips; ++mip)
+    {
+        cputex::SurfaceSpan surface = cpuTexture.accessMipSurface(0, 0, mip);
+        const UINT bytesPerPixel = gpufmt::formatInfo(textureParams.format).blockByteSize;
+        const UINT rowPitch = surface.extent().x * bytesPerPixel;
+        const UINT cellPitch = std::max(rowPitch >> 3, 1u); // The width of a cell in the checkboard texture.
+        const UINT cellHeight =
+            std::max(surface.extent().x >> 3,
+                     std::max(cellPitch / bytesPerPixel, 1u)); // The height of a cell in the checkerboard texture.
+        const UINT textureSize = static_cast<UINT>(surface.sizeInBytes());
+
+        UINT8* pData = surface.accessDataAs<UINT8>().data();
+
+        for(UINT n = 0; n < textureSize; n += bytesPerPixel)
+        {
+            UINT x = n % rowPitch;
+            UINT y = n / rowPitch;
+            UINT i = x / cellPitch;
+            UINT j = y / cellHeight;
+
+            if(i % 2 == j % 2)
+            {
+                pData[n] = 0x00;     // R
+                pData[n + 1] = 0x00; // G
+                pData[n + 2] = 0x00; // B
+                pData[n + 3] = 0xff; // A
+            }
+            else
+            {
+                pData[n] = color[0];     // R
+                pData[n + 1] = color[1]; // G
+                pData[n + 2] = color[2]; // B
+                pData[n + 3] = 0xff;     // A
+            }
+        }
+    }
+
+    return cpuTexture;
+}
+} // namespace
+
+RenderScene::RenderScene(const StressSceneConfig* stressSceneConfig)
 {
+    SCRAP_MEMORY_TAG(Scene);
+
     d3d12::DeviceContext& deviceContext = d3d12::DeviceContext::instance();
 
     mRasterScene = std::make_unique<RasterRenderer>();
 
-    if(deviceContext.isRaytracingSupported()) { mRaytraceScene = std::make_unique<RaytracingRenderer>(); }
+    if(deviceContext.isRaytracingSupported())
+    {
+        // Every mesh and material pairing can compile to its own bindings. The single cube only has the one.
+        const uint32_t hitGroupRecordCapacity =
+            (stressSceneConfig != nullptr) ? stressSceneConfig->meshCount * stressSceneConfig->materialCount : 1;
+        mRaytraceScene = std::make_unique<RaytracingRenderer>(hitGroupRecordCapacity);
+    }
+
+    // Stress scenes start the camera just outside of their volume
+    const float cameraDistance = (stressSceneConfig != nullptr) ? stressSceneConfig->extent + 5.0f : 5.0f;
+    mCamera.setPosition(glm::vec3(0.0f, 0.0f, -cameraDistance));
+
+    InitGraph initGraph;
+
+    const InitTaskId rasterRootSignatureTask = mRasterScene->addInitTasks(initGraph);
+
+    std::optional<InitTaskId> raytracingRootSignatureTask;
+    if(mRaytraceScene != nullptr) { raytracingRootSignatureTask = mRaytraceScene->addInitTasks(initGraph); }
+
+    addRenderObjectInitTasks(initGraph, rasterRootSignatureTask, raytracingRootSignatureTask, stressSceneConfig);
 
-    mCamera.setPosition(glm::vec3(0.0f, 0.0f, -5.0f));
+    const bool initSucceeded = initGraph.run(JobSystem::instance());
 
-    createRenderObject();
+    // The tasks only record their uploads. Everything they recorded is submitted and waited on once, here, even when
+    // a task failed, so nothing is left referencing the uploads.
+    deviceContext.getCopyContext().execute();
+    deviceContext.getCopyContext().waitOnGpu();
+
+    initGraph.logReport("Scene startup");
+
+    if(!initSucceeded || mRenderObjects.empty())
+    {
+        spdlog::critical("Failed to initialize the scene");
+        return;
+    }
+
+    mRasterScene->finishInit(initGraph);
+    if(mRaytraceScene != nullptr) { mRaytraceScene->finishInit(initGraph); }
+
+    mInitialized = true;
 }
 
-void RenderScene::preRender(const FrameInfo& frameInfo)
+void RenderScene::simulate(const FrameInfo& frameInfo, RenderParams& renderParams)
 {
+    SCRAP_CPU_ZONE("RenderScene::simulate");
+    SCRAP_MEMORY_TAG(Scene);
+
+    if(!isInitialized()) { return; }
+
     if(frameInfo.keyboard->getKeyState(SDLK_SPACE).pressedCount > 0)
     {
         mActiveScene = (mActiveScene == Scene::Raster) ? Scene::Raytracing : Scene::Raster;
@@ -918,16 +1193,35 @@ void RenderScene::preRender(const FrameInfo& frameInfo)
 
     mCamera.update(frameInfo);
 
-    RenderObject& renderObject = mRenderObjects.front();
-    renderObject.mTransform.rotation =
-        glm::rotate(renderObject.mTransform.rotation, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
-    renderObject.mTransform.position = glm::vec3(std::sin(frameInfo.runtimeSec.count()) * 5.0f, 0.0f, 0.0f);
-    renderObject.mTransform.scale = glm::vec3(std::abs(std::sin(frameInfo.runtimeSec.count())) + 0.5f);
+    if(mIsStressScene)
+    {
+        for(size_t dynamicIndex = 0; dynamicIndex < mDynamicObjects.size(); ++dynamicIndex)
+        {
+            Transform& transform = mRenderObjects[mDynamicObjects[dynamicIndex]].mTransform;
+            transform.rotation =
+                glm::rotate(transform.rotation, mRotationSpeeds[dynamicIndex], glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+    }
+    else
+    {
+        RenderObject& renderObject = mRenderObjects.front();
+        renderObject.mTransform.rotation =
+            glm::rotate(renderObject.mTransform.rotation, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+        renderObject.mTransform.position = glm::vec3(std::sin(frameInfo.runtimeSec.count()) * 5.0f, 0.0f, 0.0f);
+        renderObject.mTransform.scale = glm::vec3(std::abs(std::sin(frameInfo.runtimeSec.count())) + 0.5f);
+    }
 
     const auto windowSize = frameInfo.mainWindow->getSize();
 
+    renderParams.frameInfo = frameInfo;
+    renderParams.frameInfo.mainWindow = nullptr;
+    renderParams.frameInfo.keyboard = nullptr;
+    renderParams.frameInfo.mouse = nullptr;
+    renderParams.activeScene = mActiveScene;
+    renderParams.viewportSize = windowSize;
+
     {
-        FrameConstantBuffer& frameCb = mRenderParams.frameConstants;
+        FrameConstantBuffer& frameCb = renderParams.frameConstants;
         frameCb.worldToView = mCamera.getCamera().worldToViewMatrix();
         frameCb.viewToWorld = glm::inverse(frameCb.worldToView);
         frameCb.viewToClip = glm::perspectiveFovLH_ZO(1.04719f, (float)windowSize.x, (float)windowSize.y, 0.1f, 100.0f);
@@ -939,100 +1233,128 @@ void RenderScene::preRender(const FrameInfo& frameInfo)
         frameCb.frameTimeDelta = frameInfo.frameDeltaSec.count();
     }
 
-    mRenderParams.renderObjects = mRenderObjects;
+    // Render objects are only created during construction, so the span stays valid for the render stage
+    renderParams.renderObjects = mRenderObjects;
 
-    if(mActiveScene == Scene::Raster) { mRasterScene->preRender(frameInfo, mRenderParams); }
-    else if(mRaytraceScene != nullptr && mActiveScene == Scene::Raytracing)
+    // The snapshot's vector keeps its capacity between the frames it's reused for
+    renderParams.transforms.resize(mRenderObjects.size());
+    for(size_t i = 0; i < mRenderObjects.size(); ++i)
     {
-        mRaytraceScene->preRender(frameInfo, mRenderParams);
+        renderParams.transforms[i] = mRenderObjects[i].mTransform;
     }
 }
 
-void RenderScene::render(const FrameInfo& frameInfo, d3d12::DeviceContext& d3d12Context)
+void RenderScene::preRender(const RenderParams& renderParams)
 {
-    if(mActiveScene == Scene::Raster) { mRasterScene->render(frameInfo, mRenderParams); }
-    else if(mRaytraceScene != nullptr && mActiveScene == Scene::Raytracing)
+    SCRAP_CPU_ZONE("RenderScene::preRender");
+    SCRAP_MEMORY_TAG(Scene);
+
+    if(!isInitialized()) { return; }
+
+    if(renderParams.activeScene == Scene::Raster) { mRasterScene->preRender(renderParams.frameInfo, renderParams); }
+    else if(mRaytraceScene != nullptr && renderParams.activeScene == Scene::Raytracing)
     {
-        mRaytraceScene->render(frameInfo, mRenderParams);
+        mRaytraceScene->preRender(renderParams.frameInfo, renderParams);
     }
 }
 
-void RenderScene::endFrame()
+void RenderScene::render(const RenderParams& renderParams, d3d12::DeviceContext& d3d12Context)
 {
-    if(mActiveScene == Scene::Raster) { mRasterScene->endFrame(); }
-    else if(mRaytraceScene != nullptr && mActiveScene == Scene::Raytracing)
+    SCRAP_CPU_ZONE("RenderScene::render");
+    SCRAP_MEMORY_TAG(Scene);
+
+    if(!isInitialized()) { return; }
+
+    if(renderParams.activeScene == Scene::Raster) { mRasterScene->render(renderParams.frameInfo, renderParams); }
+    else if(mRaytraceScene != nullptr && renderParams.activeScene == Scene::Raytracing)
     {
-        mRaytraceScene->endFrame();
+        mRaytraceScene->render(renderParams.frameInfo, renderParams);
     }
 }
 
-std::shared_ptr<d3d12::Texture> RenderScene::createTexture()
+void RenderScene::endFrame(const RenderParams& renderParams)
 {
-    cputex::TextureParams textureParams;
-    textureParams.dimension = cputex::TextureDimension::Texture2D;
-    textureParams.extent = {1024, 1024, 1};
-    textureParams.faces = 1;
-    textureParams.mips = cputex::maxMips(textureParams.extent);
-    textureParams.arraySize = 1;
-    textureParams.format = gpufmt::Format::R8G8B8A8_UNORM;
-    cputex::UniqueTexture cpuTexture{textureParams};
+    SCRAP_MEMORY_TAG(Scene);
 
-    //-------------------------------------
-    // Generate a checkboard texture
-    //-------------------------------------
-    for(uint32_t mip = 0; mip < textureParams.mips; ++mip)
-    {
-        cputex::SurfaceSpan surface = cpuTexture.accessMipSurface(0, 0, mip);
-        const UINT bytesPerPixel = gpufmt::formatInfo(textureParams.format).blockByteSize;
-        const UINT rowPitch = surface.extent().x * bytesPerPixel;
-        const UINT cellPitch = std::max(rowPitch >> 3, 1u); // The width of a cell in the checkboard texture.
-        const UINT cellHeight =
-            std::max(surface.extent().x >> 3,
-                     std::max(cellPitch / bytesPerPixel, 1u)); // The height of a cell in the checkerboard texture.
-        const UINT textureSize = static_cast<UINT>(surface.sizeInBytes());
+    if(!isInitialized()) { return; }
 
-        UINT8* pData = surface.accessDataAs<UINT8>().data();
-
-        for(UINT n = 0; n < textureSize; n += bytesPerPixel)
-        {
-            UINT x = n % rowPitch;
-            UINT y = n / rowPitch;
-            UINT i = x / cellPitch;
-            UINT j = y / cellHeight;
-
-            if(i % 2 == j % 2)
-            {
-                pData[n] = 0x00;     // R
-                pData[n + 1] = 0x00; // G
-                pData[n + 2] = 0x00; // B
-                pData[n + 3] = 0xff; // A
-            }
-            else
-            {
-                pData[n] = 0xff;     // R
-                pData[n + 1] = 0xff; // G
-                pData[n + 2] = 0xff; // B
-                pData[n + 3] = 0xff; // A
-            }
-        }
+    if(renderParams.activeScene == Scene::Raster) { mRasterScene->endFrame(); }
+    else if(mRaytraceScene != nullptr && renderParams.activeScene == Scene::Raytracing)
+    {
+        mRaytraceScene->endFrame();
     }
-
-    auto texture = std::make_unique<d3d12::Texture>();
-    texture->initFromMemory(cpuTexture, ResourceAccessFlags::GpuRead, "Firsrt Texture");
-
-    return texture;
 }
 
-bool RenderScene::createRenderObject()
+void RenderScene::addRenderObjectInitTasks(InitGraph& initGraph,
+                                           InitTaskId rasterRootSignatureTask,
+                                           std::optional<InitTaskId> raytracingRootSignatureTask,
+                                           const StressSceneConfig* stressSceneConfig)
 {
-    mTexture = createTexture();
-
-    RenderObject renderObject{RenderObjectId(mNextRenderObjectId++)};
-    renderObject.name = SharedString("Cube");
-    renderObject.mGpuMesh = std::make_shared<GpuMesh>(
-        GpuMesh(GenerateCubeMesh(CubeMeshTopologyType::Triangle, 1), ResourceAccessFlags::GpuRead, "Cube"));
+    SCRAP_MEMORY_TAG(Scene);
 
+    // What the tasks hand to each other. The graph holds on to it for as long as it holds on to the tasks.
+    struct CubeInitState
+    {
+        cputex::UniqueTexture cpuTexture;
+        CpuMesh cpuMesh;
+        std::shared_ptr<GpuMesh> gpuMesh;
+        std::shared_ptr<d3d12::GraphicsShader> rasterShader;
+        std::shared_ptr<d3d12::GraphicsPipelineState> rasterPipelineState;
+        std::shared_ptr<d3d12::RaytracingShader> raytracingShader;
+        std::shared_ptr<d3d12::RaytracingPipelineState> raytracingPipelineState;
+
+        // Only used by stress scenes
+        StressScene stressScene;
+        std::vector<cputex::UniqueTexture> stressCpuTextures;
+        std::vector<std::shared_ptr<d3d12::Texture>> stressTextures;
+        std::vector<std::shared_ptr<GpuMesh>> stressGpuMeshes;
+    };
+
+    auto state = std::make_shared<CubeInitState>();
+
+    std::vector<InitTaskId> renderObjectDependencies;
+
+    // Stress scenes bring their own meshes and palette, only the single cube uses the cube mesh and the checkerboard
+    if(stressSceneConfig == nullptr)
     {
+        const InitTaskId generateTextureTask = initGraph.addTask("Generate checkerboard texture", [state]() {
+            state->cpuTexture = GenerateCheckerboardTexture(1024, {0xff, 0xff, 0xff});
+            return true;
+        });
+
+        renderObjectDependencies.push_back(initGraph.addTask(
+            "Upload checkerboard texture",
+            [this, state]() {
+                auto texture = std::make_shared<d3d12::Texture>();
+                auto error =
+                    texture->initFromMemory(state->cpuTexture, ResourceAccessFlags::GpuRead, "Firsrt Texture");
+                if(error.has_value())
+                {
+                    spdlog::critical("Failed to create the checkerboard texture. {}", error.value());
+                    return false;
+                }
+
+                mTexture = std::move(texture);
+                return true;
+            },
+            {generateTextureTask}));
+
+        const InitTaskId generateMeshTask = initGraph.addTask("Generate cube mesh", [state]() {
+            state->cpuMesh = GenerateCubeMesh(CubeMeshTopologyType::Triangle, 1);
+            return true;
+        });
+
+        renderObjectDependencies.push_back(initGraph.addTask(
+            "Upload cube mesh",
+            [state]() {
+                state->gpuMesh =
+                    std::make_shared<GpuMesh>(GpuMesh(state->cpuMesh, ResourceAccessFlags::GpuRead, "Cube"));
+                return !state->gpuMesh->getVertexElements().empty();
+            },
+            {generateMeshTask}));
+    }
+
+    const InitTaskId compileRasterShaderTask = initGraph.addTask("Compile raster shader", [state]() {
         d3d12::GraphicsShaderParams shaderParams;
         shaderParams.filepaths[GraphicsShaderStage::Vertex] = L"assets\\raster_basic3d.hlsl";
         shaderParams.filepaths[GraphicsShaderStage::Pixel] = L"assets\\raster_basic3d.hlsl";
@@ -1043,41 +1365,191 @@ bool RenderScene::createRenderObject()
         shaderParams.debug = true;
 #endif
 
-        d3d12::GraphicsPipelineStateParams pipelineStateParams = {};
-        pipelineStateParams.rasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-        pipelineStateParams.rasterizerState.FrontCounterClockwise = true;
-        pipelineStateParams.blendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-        pipelineStateParams.depthStencilState.DepthEnable = TRUE;
-        pipelineStateParams.depthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
-        pipelineStateParams.depthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
-        pipelineStateParams.depthStencilState.StencilEnable = FALSE;
-        pipelineStateParams.primitiveTopologyType =
-            d3d12::TranslatePrimitiveTopologyType(renderObject.mGpuMesh->getPrimitiveTopology());
-
-        renderObject.mMaterial.mRasterPipelineState =
-            mRasterScene->createPipelineState(std::move(shaderParams), std::move(pipelineStateParams));
-    }
+        state->rasterShader = std::make_shared<d3d12::GraphicsShader>(std::move(shaderParams));
+        state->rasterShader->create();
+
+        return state->rasterShader->status() == d3d12::GraphicsShaderState::Compiled;
+    });
+
+    const InitTaskId rasterPipelineStateTask = initGraph.addTask(
+        "Create raster pipeline state",
+        [this, state]() {
+            d3d12::GraphicsPipelineStateParams pipelineStateParams = {};
+            pipelineStateParams.rasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+            pipelineStateParams.rasterizerState.FrontCounterClockwise = true;
+            pipelineStateParams.blendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+            pipelineStateParams.depthStencilState.DepthEnable = TRUE;
+            pipelineStateParams.depthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+            pipelineStateParams.depthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+            pipelineStateParams.depthStencilState.StencilEnable = FALSE;
+            // The cube and the stress scene meshes are all triangle cubes
+            pipelineStateParams.primitiveTopologyType = d3d12::TranslatePrimitiveTopologyType(
+                GetCubeMeshPrimitiveTopology(CubeMeshTopologyType::Triangle));
+
+            state->rasterPipelineState =
+                mRasterScene->createPipelineState(state->rasterShader, std::move(pipelineStateParams));
 
-    if(mRaytraceScene)
+            // Already queued on the job system. Creating it here means it's ready by the first frame.
+            state->rasterPipelineState->create();
+
+            return state->rasterPipelineState->isReady();
+        },
+        {rasterRootSignatureTask, compileRasterShaderTask});
+
+    renderObjectDependencies.push_back(rasterPipelineStateTask);
+
+    if(raytracingRootSignatureTask.has_value())
     {
-        d3d12::RaytracingShaderParams shaderParams;
-        shaderParams.filepath = "assets/raytracing_basic3d.hlsl";
+        const InitTaskId compileRaytracingShaderTask = initGraph.addTask("Compile raytracing shader", [state]() {
+            d3d12::RaytracingShaderParams shaderParams;
+            shaderParams.filepath = "assets/raytracing_basic3d.hlsl";
 
-        std::array fixedStageEntryPoints{
-            d3d12::RaytracingFixedStageShaderEntryPoint{.stage = RaytracingShaderStage::ClosestHit,
-                                                        .entryPoint = SharedString("MyClosestHitShader")}};
-        shaderParams.fixedStageEntryPoints = fixedStageEntryPoints;
+            std::array fixedStageEntryPoints{
+                d3d12::RaytracingFixedStageShaderEntryPoint{.stage = RaytracingShaderStage::ClosestHit,
+                                                            .entryPoint = SharedString("MyClosestHitShader")}};
+            shaderParams.fixedStageEntryPoints = fixedStageEntryPoints;
 
 #ifdef _DEBUG
-        shaderParams.debug = true;
+            shaderParams.debug = true;
 #endif
-        renderObject.mMaterial.mRaytracingPipelineState = mRaytraceScene->createPipelineState(std::move(shaderParams));
+            state->raytracingShader = std::make_shared<d3d12::RaytracingShader>(std::move(shaderParams));
+            state->raytracingShader->create();
+
+            return state->raytracingShader->status() == d3d12::RaytracingShaderState::Compiled;
+        });
+
+        renderObjectDependencies.push_back(initGraph.addTask(
+            "Create raytracing pipeline state",
+            [this, state]() {
+                state->raytracingPipelineState = mRaytraceScene->createPipelineState(state->raytracingShader);
+                return true;
+            },
+            {raytracingRootSignatureTask.value(), compileRaytracingShaderTask}));
     }
 
-    renderObject.mMaterial.textures.insert(eastl::make_pair(SharedString("Texture"), mTexture));
-    mRenderObjects.emplace_back(std::move(renderObject));
+    if(stressSceneConfig != nullptr)
+    {
+        mIsStressScene = true;
+
+        const InitTaskId generateStressSceneTask =
+            initGraph.addTask("Generate stress scene", [state, config = *stressSceneConfig]() {
+                LogStressSceneConfig(config);
+                state->stressScene = GenerateStressScene(config, &JobSystem::instance());
+                return true;
+            });
+
+        const InitTaskId generateStressTexturesTask = initGraph.addTask(
+            "Generate stress scene textures",
+            [state]() {
+                const std::vector<StressSceneTexture>& textures = state->stressScene.textures;
+                std::vector<cputex::UniqueTexture>& cpuTextures = state->stressCpuTextures;
+                cpuTextures.resize(textures.size());
+
+                JobSystem::instance().parallelFor(
+                    0, textures.size(),
+                    [&textures, &cpuTextures](size_t first, size_t last) {
+                        for(size_t textureIndex = first; textureIndex < last; ++textureIndex)
+                        {
+                            cpuTextures[textureIndex] = GenerateCheckerboardTexture(textures[textureIndex].extent,
+                                                                                   textures[textureIndex].color);
+                        }
+                    },
+                    1);
+
+                return true;
+            },
+            {generateStressSceneTask});
+
+        renderObjectDependencies.push_back(initGraph.addTask(
+            "Upload stress scene textures",
+            [state]() {
+                for(size_t textureIndex = 0; textureIndex < state->stressCpuTextures.size(); ++textureIndex)
+                {
+                    auto texture = std::make_shared<d3d12::Texture>();
+                    auto error = texture->initFromMemory(state->stressCpuTextures[textureIndex],
+                                                         ResourceAccessFlags::GpuRead,
+                                                         fmt::format("Stress Texture {}", textureIndex));
+                    if(error.has_value())
+                    {
+                        spdlog::critical("Failed to create stress scene texture {}. {}", textureIndex, error.value());
+                        return false;
+                    }
+
+                    state->stressTextures.push_back(std::move(texture));
+                }
+
+                return true;
+            },
+            {generateStressTexturesTask}));
+
+        renderObjectDependencies.push_back(initGraph.addTask(
+            "Upload stress scene meshes",
+            [state]() {
+                for(size_t meshIndex = 0; meshIndex < state->stressScene.meshes.size(); ++meshIndex)
+                {
+                    auto gpuMesh = std::make_shared<GpuMesh>(GpuMesh(state->stressScene.meshes[meshIndex],
+                                                                     ResourceAccessFlags::GpuRead,
+                                                                     fmt::format("Stress Mesh {}", meshIndex)));
+                    if(gpuMesh->getVertexElements().empty()) { return false; }
+
+                    state->stressGpuMeshes.push_back(std::move(gpuMesh));
+                }
+
+                return true;
+            },
+            {generateStressSceneTask}));
+    }
 
-    return true;
+    // Everything above runs in whatever order the job system gets to it. This is the one task that touches the
+    // render object list.
+    const auto createRenderObject = [this, state]() {
+        if(mIsStressScene)
+        {
+            const StressScene& stressScene = state->stressScene;
+
+            // Every object shares the two strings instead of allocating its own
+            const SharedString name("Stress Object");
+            const SharedString textureName("Texture");
+
+            mRenderObjects.reserve(stressScene.objects.size());
+            for(const StressSceneObject& object : stressScene.objects)
+            {
+                const StressSceneMaterial& material = stressScene.materials[object.materialIndex];
+
+                RenderObject renderObject{RenderObjectId(mNextRenderObjectId++)};
+                renderObject.name = name;
+                renderObject.mTransform = object.transform;
+                renderObject.mGpuMesh = state->stressGpuMeshes[object.meshIndex];
+                renderObject.mMaterial.mRasterPipelineState = state->rasterPipelineState;
+                renderObject.mMaterial.mRaytracingPipelineState = state->raytracingPipelineState;
+                renderObject.mMaterial.setTexture(textureName, state->stressTextures[material.textureIndex]);
+
+                mRenderObjects.emplace_back(std::move(renderObject));
+            }
+
+            mDynamicObjects = stressScene.dynamicObjects;
+            mRotationSpeeds.resize(mDynamicObjects.size());
+            for(size_t dynamicIndex = 0; dynamicIndex < mDynamicObjects.size(); ++dynamicIndex)
+            {
+                mRotationSpeeds[dynamicIndex] = stressScene.objects[mDynamicObjects[dynamicIndex]].rotationSpeed;
+            }
+
+            return true;
+        }
+
+        RenderObject renderObject{RenderObjectId(mNextRenderObjectId++)};
+        renderObject.name = SharedString("Cube");
+        renderObject.mGpuMesh = state->gpuMesh;
+        renderObject.mMaterial.mRasterPipelineState = state->rasterPipelineState;
+        renderObject.mMaterial.mRaytracingPipelineState = state->raytracingPipelineState;
+        renderObject.mMaterial.setTexture(SharedString("Texture"), mTexture);
+
+        mRenderObjects.emplace_back(std::move(renderObject));
+        return true;
+    };
+
+    initGraph.addTask(mIsStressScene ? "Create stress scene render objects" : "Create cube render object",
+                      createRenderObject, renderObjectDependencies);
 }
 
 } // namespace scrap
@@ -2,29 +2,46 @@
 // will see a lot of change. In earlier implementations, it will have lots of inline creation of D3D12 objects.
 // Eventaully those D3D12 objects will be encapsulated in other classes and RenderScene will begin to look a lot more
 // platform agnostic.
+//
+// Without a StressSceneConfig the scene is a single animated cube. With one, it's the StressScene the config generates.
+// Its objects share its meshes and textures, and its dynamic objects rotate every frame. The raytracing renderer's TLAS
+// grows with the objects. Its hit group table has a record for every pipeline state and set of bindings, which objects
+// with the same mesh and material share, so it's sized from the scene's meshes and materials.
 
 #pragma once
 
 #include "CameraController.h"
 #include "EnumArray.h"
+#include "FrameInfo.h"
+#include "GpuEventLabels.h"
 #include "GpuMesh.h"
+#include "InitGraph.h"
+#include "RenderGraph.h"
 #include "RenderObject.h"
 #include "d3d12/D3D12CommandList.h"
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
 #include "d3d12/D3D12Fwd.h"
+#include "d3d12/D3D12ParallelCommandRecorder.h"
+#include "d3d12/D3D12RenderGraphExecutor.h"
 #include "d3d12/D3D12ShaderTable.h"
 #include "d3d12/D3D12TLAccelerationStructure.h"
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <optional>
+#include <vector>
 
+#include <EASTL/vector_map.h>
+#include <glm/mat4x3.hpp>
+#include <glm/matrix.hpp>
 #include <glm/vec2.hpp>
 #include <wrl/client.h>
 
 namespace scrap
 {
-struct FrameInfo;
+struct StressSceneConfig;
 
 struct FrameConstantBuffer
 {
@@ -50,11 +67,20 @@ struct ObjectConstantBuffer
     glm::mat4x4 clipToObject;
 };
 
-struct RenderParams
+// The constants of an object with the objectToWorld transform, transposed for the shaders
+[[nodiscard]] inline ObjectConstantBuffer MakeObjectConstants(const glm::mat4x3& objectToWorld,
+                                                              const FrameConstantBuffer& frameConstants)
 {
-    FrameConstantBuffer frameConstants;
-    std::span<RenderObject> renderObjects;
-};
+    const ObjectConstantBuffer objectConstants{
+        .objectToWorld = glm::transpose(objectToWorld),
+        .worldToObject = glm::inverse(objectConstants.objectToWorld),
+        .objectToView = glm::transpose(frameConstants.worldToView * static_cast<glm::mat4x4>(objectToWorld)),
+        .viewToObject = glm::inverse(objectConstants.objectToView),
+        .objectToClip = glm::transpose(frameConstants.worldToClip * static_cast<glm::mat4x4>(objectToWorld)),
+        .clipToObject = glm::inverse(objectConstants.objectToClip)};
+
+    return objectConstants;
+}
 
 enum class Scene
 {
@@ -62,6 +88,26 @@ enum class Scene
     Raytracing
 };
 
+// A snapshot of everything the simulation stage produces for one frame. The render stage may run a frame behind the
+// simulation on another thread, so it reads the state the simulation owns only from here and never from the live
+// objects.
+struct RenderParams
+{
+    // The keyboard, mouse and window pointers are cleared. Input belongs to the simulation stage.
+    FrameInfo frameInfo;
+    FrameConstantBuffer frameConstants;
+    Scene activeScene = Scene::Raytracing;
+    glm::i32vec2 viewportSize{0, 0};
+
+    // The gpu resources of the render objects belong to the render stage. Their transforms are indexed the same way.
+    std::span<RenderObject> renderObjects;
+    std::vector<Transform> transforms;
+
+    uint64_t frameNumber = 0;
+    // When the input this frame was simulated with was sampled
+    std::chrono::steady_clock::time_point inputTime;
+};
+
 class RasterRenderer
 {
 public:
@@ -79,38 +125,56 @@ public:
 
     bool isInitialized() { return mInitialized; }
 
+    // Adds the tasks that create the renderer's gpu objects. Returns the task that creates the root signature, which
+    // createPipelineState needs.
+    InitTaskId addInitTasks(InitGraph& initGraph);
+    // Submits what the init tasks recorded. The graph has to have run and the copy queue has to have been flushed.
+    void finishInit(const InitGraph& initGraph);
+
+    // When enabled, large draw lists are split up and recorded on multiple threads
+    void setParallelRecordingEnabled(bool enabled) { mParallelRecordingEnabled = enabled; }
+    bool isParallelRecordingEnabled() const { return mParallelRecordingEnabled; }
+
     std::shared_ptr<d3d12::GraphicsPipelineState>
-    createPipelineState(d3d12::GraphicsShaderParams&& shaderParams,
+    createPipelineState(std::shared_ptr<d3d12::GraphicsShader> shader,
                         d3d12::GraphicsPipelineStateParams&& pipelineStateParams);
 
 private:
-    struct TextureBindingDesc
-    {
-        SharedString name;
-        d3d12::Texture* texture;
-    };
+    static constexpr size_t kMinObjectsPerRecordingChunk = 256;
 
     bool createRootSignature();
-    void createRenderTargets();
-    void createFrameConstantBuffer();
+    bool createRenderTargets();
+    bool createFrameConstantBuffer();
 
-    void bindTextures(Material& material);
+    void bindPassState(d3d12::GraphicsCommandList& commandList);
+    void drawRenderObjects(d3d12::GraphicsCommandList& commandList,
+                           const RenderParams& renderParams,
+                           size_t firstObject,
+                           size_t objectCount);
 
     Microsoft::WRL::ComPtr<ID3D12RootSignature> mRootSignature;
 
     d3d12::GraphicsCommandList mCommandList;
+    d3d12::GraphicsCommandList mPresentCommandList;
+    d3d12::ParallelCommandRecorder mParallelRecorder;
+    bool mParallelRecordingEnabled = true;
+
+    RenderGraph mRenderGraph;
+    d3d12::RenderGraphExecutor mRenderGraphExecutor;
 
     std::shared_ptr<d3d12::Buffer> mFrameConstantBuffer;
-    std::shared_ptr<d3d12::Buffer> mObjectConstantBuffer;
 
     std::unique_ptr<d3d12::Texture> mDepthStencilTexture;
+
+    std::vector<InitTaskId> mInitTasks;
     bool mInitialized = false;
 };
 
 class RaytracingRenderer
 {
 public:
-    RaytracingRenderer();
+    // hitGroupRecordCapacity is the number of distinct pipeline state and binding combinations the scene's objects have
+    explicit RaytracingRenderer(uint32_t hitGroupRecordCapacity);
     RaytracingRenderer(const RaytracingRenderer&) = delete;
     RaytracingRenderer(RaytracingRenderer&&);
     ~RaytracingRenderer();
@@ -124,53 +188,91 @@ public:
 
     bool isInitialized() { return mInitialized; }
 
-    std::shared_ptr<d3d12::RaytracingPipelineState> createPipelineState(d3d12::RaytracingShaderParams&& shaderParams);
+    // Adds the tasks that create the renderer's gpu objects. Returns the task that creates the root signatures, which
+    // createPipelineState needs.
+    InitTaskId addInitTasks(InitGraph& initGraph);
+    // Submits what the init tasks recorded. The graph has to have run and the copy queue has to have been flushed.
+    void finishInit(const InitGraph& initGraph);
+
+    // The shader has to be compiled
+    std::shared_ptr<d3d12::RaytracingPipelineState>
+    createPipelineState(std::shared_ptr<d3d12::RaytracingShader> shader);
 
 private:
     bool createRenderTargets();
     bool createRootSignatures();
+    bool compileMainPassShader();
     bool createInternalPipelineStates();
     bool buildAccelerationStructures();
     bool buildShaderTables();
 
+    // Returns the index of the hit group record for the pipeline state and bindings, adding the record the first time
+    // they're seen. Returns nullopt when the hit group table is full.
+    std::optional<uint32_t> getHitGroupRecord(const std::shared_ptr<d3d12::RaytracingPipelineState>& pipelineState,
+                                              const ShaderBindingIndices& bindings);
+
+    struct HitGroupRecordKey
+    {
+        const d3d12::RaytracingPipelineState* pipelineState = nullptr;
+        ShaderBindingIndices bindings;
+
+        auto operator<=>(const HitGroupRecordKey&) const = default;
+    };
+
     Microsoft::WRL::ComPtr<ID3D12RootSignature> mGlobalRootSignature;
     EnumArray<Microsoft::WRL::ComPtr<ID3D12RootSignature>, RaytracingShaderStage> mLocalRootSignatures;
     d3d12::GraphicsCommandList mCommandList;
 
+    RenderGraph mRenderGraph;
+    d3d12::RenderGraphExecutor mRenderGraphExecutor;
+
     std::unique_ptr<d3d12::Texture> mRenderTarget;
 
     std::unique_ptr<d3d12::TLAccelerationStructure> mTlas;
 
+    std::shared_ptr<d3d12::RaytracingShader> mMainPassShader;
     std::shared_ptr<d3d12::RaytracingDispatchPipelineState> mDispatchPipelineState;
     std::shared_ptr<d3d12::RaytracingPipelineState> mMainPassPipelineState;
     std::shared_ptr<d3d12::ShaderTable> mShaderTable;
     d3d12::ShaderTableAllocation mMainPassShaderTableAllocation;
+    eastl::vector_map<HitGroupRecordKey, d3d12::ShaderTableAllocation> mHitGroupRecords;
+    uint32_t mHitGroupRecordCapacity = 0;
+    bool mHitGroupTableFullLogged = false;
 
     std::shared_ptr<d3d12::Buffer> mFrameConstantBuffer;
 
+    std::vector<InitTaskId> mInitTasks;
     bool mInitialized = false;
 
-    std::string mStringBuffer;
+    GpuEventLabelCache mObjectEventLabels;
 };
 
 class RenderScene
 {
 public:
-    RenderScene();
+    // A null config creates the single cube scene
+    explicit RenderScene(const StressSceneConfig* stressSceneConfig = nullptr);
 
+    // False when any of the startup tasks failed. The stages do nothing for a scene that isn't initialized.
     [[nodiscard]] bool isInitialized() const
     {
-        return mRasterScene->isInitialized() && (mRaytraceScene == nullptr || mRaytraceScene->isInitialized());
+        return mInitialized && mRasterScene->isInitialized() &&
+               (mRaytraceScene == nullptr || mRaytraceScene->isInitialized());
     }
 
-    void preRender(const FrameInfo& frameInfo);
-    void render(const FrameInfo& frameInfo, d3d12::DeviceContext& d3d12Context);
-    void endFrame();
+    // Simulation stage. Advances the camera and the render objects, then writes the frame's snapshot.
+    void simulate(const FrameInfo& frameInfo, RenderParams& renderParams);
 
-private:
-    std::shared_ptr<d3d12::Texture> createTexture();
+    // Render stage. Everything the simulation owns is read from renderParams.
+    void preRender(const RenderParams& renderParams);
+    void render(const RenderParams& renderParams, d3d12::DeviceContext& d3d12Context);
+    void endFrame(const RenderParams& renderParams);
 
-    bool createRenderObject();
+private:
+    void addRenderObjectInitTasks(InitGraph& initGraph,
+                                  InitTaskId rasterRootSignatureTask,
+                                  std::optional<InitTaskId> raytracingRootSignatureTask,
+                                  const StressSceneConfig* stressSceneConfig);
 
     CameraController mCamera;
     std::unique_ptr<RasterRenderer> mRasterScene;
@@ -179,8 +281,15 @@ private:
 
     std::vector<RenderObject> mRenderObjects;
     uint32_t mNextRenderObjectId = 0;
+    bool mIsStressScene = false;
+
+    // The stress scene's objects that rotate, and their speeds
+    std::vector<uint32_t> mDynamicObjects;
+    std::vector<float> mRotationSpeeds;
 
+    // The single cube's checkerboard. Null for stress scenes.
     std::shared_ptr<d3d12::Texture> mTexture;
-    RenderParams mRenderParams{};
+
+    bool mInitialized = false;
 };
 } // namespace scrap
@@ -0,0 +1,382 @@
+#include "SceneBenchmark.h"
+
+#include "MemoryTracker.h"
+#include "PrimitiveMesh.h"
+#include "d3d12/D3D12UploadBufferPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <d3d12.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+// Objects whose constants are written into the upload buffer before it wraps around. The engine writes a recorded
+// chunk's constants into one allocation from the UploadBufferPool, the benchmark reuses the same memory.
+constexpr size_t kUploadBufferObjectCount = 1024;
+
+constexpr size_t kObjectConstantsStride = d3d12::UploadBufferPool::AlignAllocationSize(sizeof(ObjectConstantBuffer));
+
+// Made up descriptor heap indices. Every object gets its own, like objects with their own meshes and textures would.
+constexpr uint32_t kDescriptorsPerObject = 8;
+
+// The inputs a shader reflecting the cube's vertex elements, an index buffer and a texture would have
+ShaderInputs MakeShaderInputs(const CpuMesh& mesh)
+{
+    ShaderInputs inputs;
+
+    uint32_t slotIndex = 0;
+    for(const CpuMesh::VertexElement& vertexElement : mesh.getVertexElements())
+    {
+        ShaderVertexElement element;
+        element.index = slotIndex++;
+        element.type = ShaderResourceType::Buffer;
+        element.dimension = ShaderResourceDimension::Buffer;
+        element.semantic = vertexElement.semantic;
+        element.semanticIndex = vertexElement.semanticIndex;
+        inputs.vertexElements.push_back(std::move(element));
+    }
+
+    ShaderResource indexBuffer;
+    indexBuffer.name = SharedString("IndexBuffer");
+    indexBuffer.index = 0;
+    indexBuffer.type = ShaderResourceType::Buffer;
+    indexBuffer.dimension = ShaderResourceDimension::Buffer;
+    inputs.resources.push_back(std::move(indexBuffer));
+
+    ShaderResource texture;
+    texture.name = SharedString("Texture");
+    texture.index = 1;
+    texture.type = ShaderResourceType::Texture;
+    texture.dimension = ShaderResourceDimension::Texture2d;
+    texture.returnType = ShaderResourceReturnType::Float;
+    texture.returnTypeComponentCount = 4;
+    inputs.resources.push_back(std::move(texture));
+
+    return inputs;
+}
+
+StressSceneConfig MakeSweepConfig(uint32_t objectCount, uint32_t seed)
+{
+    StressSceneConfig config;
+    config.objectCount = objectCount;
+    config.meshCount = 1;
+    config.maxSubdivisions = 1;
+    config.materialCount = 1;
+    config.textureCount = 1;
+    config.dynamicFraction = 1.0f;
+    config.distribution = StressSceneDistribution::Uniform;
+    config.extent = 100.0f;
+    config.seed = seed;
+
+    return config;
+}
+} // namespace
+
+SceneBenchmarkScene::SceneBenchmarkScene(uint32_t objectCount, uint32_t seed)
+    : SceneBenchmarkScene(GenerateStressScene(MakeSweepConfig(objectCount, seed)))
+{}
+
+SceneBenchmarkScene::SceneBenchmarkScene(const StressScene& stressScene)
+{
+    SCRAP_MEMORY_TAG(Scene);
+
+    // Every stress scene mesh is a cube with the same vertex elements, so one binding layout fits all of them
+    mMesh = GenerateCubeMesh(CubeMeshTopologyType::Triangle, 1);
+    mBindingLayout = ShaderBindingLayout(MakeShaderInputs(mMesh));
+
+    const uint32_t objectCount = (uint32_t)stressScene.objects.size();
+
+    mTransforms.resize(objectCount);
+    for(uint32_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+    {
+        mTransforms[objectIndex] = stressScene.objects[objectIndex].transform;
+    }
+
+    mDynamicObjects = stressScene.dynamicObjects;
+    mRotationSpeeds.resize(mDynamicObjects.size());
+    for(size_t dynamicIndex = 0; dynamicIndex < mDynamicObjects.size(); ++dynamicIndex)
+    {
+        mRotationSpeeds[dynamicIndex] = stressScene.objects[mDynamicObjects[dynamicIndex]].rotationSpeed;
+    }
+
+    mBindings.resize(objectCount);
+    mUploadBuffer.resize(std::min<size_t>(objectCount, kUploadBufferObjectCount) * kObjectConstantsStride);
+
+    // Added like RaytracingRenderer::preRender adds them, without a BLAS to point at
+    mTlasInstanceIds.resize(objectCount);
+    for(uint32_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+    {
+        D3D12_RAYTRACING_INSTANCE_DESC instanceDesc = {};
+        instanceDesc.InstanceID = objectIndex;
+        instanceDesc.InstanceMask = 0xff;
+        instanceDesc.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
+
+        mTlasInstanceIds[objectIndex] = mTlasInstances.addInstance(instanceDesc);
+    }
+}
+
+EnumArray<std::chrono::nanoseconds, SceneBenchmarkStage> SceneBenchmarkScene::runFrame(uint32_t frameIndex)
+{
+    SCRAP_MEMORY_TAG(Scene);
+
+    EnumArray<std::chrono::nanoseconds, SceneBenchmarkStage> stageTimes{};
+
+    auto timeStage = [&](SceneBenchmarkStage stage, auto&& function) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        stageTimes[stage] =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    };
+
+    timeStage(SceneBenchmarkStage::Simulate, [&]() { simulate(frameIndex); });
+    timeStage(SceneBenchmarkStage::ObjectConstants, [&]() { buildObjectConstants(); });
+    timeStage(SceneBenchmarkStage::Bindless, [&]() { compileBindings(); });
+    timeStage(SceneBenchmarkStage::TlasInstances, [&]() { updateTlasInstances(); });
+
+    return stageTimes;
+}
+
+void SceneBenchmarkScene::simulate(uint32_t frameIndex)
+{
+    const float time = (float)frameIndex / 60.0f;
+
+    for(size_t dynamicIndex = 0; dynamicIndex < mDynamicObjects.size(); ++dynamicIndex)
+    {
+        Transform& transform = mTransforms[mDynamicObjects[dynamicIndex]];
+        transform.rotation =
+            glm::rotate(transform.rotation, mRotationSpeeds[dynamicIndex], glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    {
+        const glm::vec3 cameraPosition(std::sin(time) * 150.0f, 50.0f, std::cos(time) * 150.0f);
+
+        FrameConstantBuffer& frameCb = mFrameConstants;
+        frameCb.worldToView =
+            glm::lookAtLH(cameraPosition, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frameCb.viewToWorld = glm::inverse(frameCb.worldToView);
+        frameCb.viewToClip = glm::perspectiveFovLH_ZO(1.04719f, 1920.0f, 1080.0f, 0.1f, 100.0f);
+        frameCb.clipToView = glm::inverse(frameCb.viewToClip);
+        frameCb.worldToClip = frameCb.viewToClip * frameCb.worldToView;
+        frameCb.clipToWorld = glm::inverse(frameCb.worldToClip);
+        frameCb.cameraWorldPos = cameraPosition;
+        frameCb.time = time;
+        frameCb.frameTimeDelta = 1.0f / 60.0f;
+    }
+
+    mSnapshotTransforms.resize(mTransforms.size());
+    for(size_t objectIndex = 0; objectIndex < mTransforms.size(); ++objectIndex)
+    {
+        mSnapshotTransforms[objectIndex] = mTransforms[objectIndex];
+    }
+}
+
+void SceneBenchmarkScene::buildObjectConstants()
+{
+    const size_t uploadBufferObjectCount = mUploadBuffer.size() / kObjectConstantsStride;
+
+    for(size_t objectIndex = 0; objectIndex < mSnapshotTransforms.size(); ++objectIndex)
+    {
+        const ObjectConstantBuffer objectConstants =
+            MakeObjectConstants(mSnapshotTransforms[objectIndex].getMatrix4x4(), mFrameConstants);
+
+        const size_t byteOffset = (objectIndex % uploadBufferObjectCount) * kObjectConstantsStride;
+        std::memcpy(mUploadBuffer.data() + byteOffset, &objectConstants, sizeof(objectConstants));
+    }
+}
+
+void SceneBenchmarkScene::compileBindings()
+{
+    static const ShaderBindingKey kIndexBufferKey =
+        MakeShaderBindingKey(StringHash("IndexBuffer"), ShaderResourceType::Buffer, ShaderResourceDimension::Buffer);
+
+    const ShaderBindingLayout& layout = mBindingLayout;
+
+    for(size_t objectIndex = 0; objectIndex < mBindings.size(); ++objectIndex)
+    {
+        ObjectBindings& bindings = mBindings[objectIndex];
+        if(bindings.layout == &layout) { continue; }
+
+        bindings = ObjectBindings{.layout = &layout};
+
+        uint32_t descriptorIndex = (uint32_t)objectIndex * kDescriptorsPerObject;
+
+        for(const CpuMesh::VertexElement& vertexElement : mMesh.getVertexElements())
+        {
+            layout.bindVertexElement(bindings.indices,
+                                     MakeShaderBindingKey(vertexElement.semantic, vertexElement.semanticIndex),
+                                     descriptorIndex++);
+        }
+
+        layout.bindResource(bindings.indices, kIndexBufferKey, descriptorIndex++);
+        layout.bindResource(bindings.indices,
+                            MakeShaderBindingKey(mTextureName.hash(), ShaderResourceType::Texture,
+                                                 ShaderResourceDimension::Texture2d),
+                            descriptorIndex++);
+    }
+}
+
+void SceneBenchmarkScene::updateTlasInstances()
+{
+    for(size_t objectIndex = 0; objectIndex < mSnapshotTransforms.size(); ++objectIndex)
+    {
+        mTlasInstances.updateInstanceTransform(mTlasInstanceIds[objectIndex],
+                                               mSnapshotTransforms[objectIndex].getMatrix4x4());
+    }
+}
+
+namespace
+{
+uint64_t GetTotalAllocationCount()
+{
+    uint64_t allocationCount = 0;
+    for(MemoryTag tag : enumerate<MemoryTag>())
+    {
+        allocationCount += MemoryTracker::getStats(tag).allocationCount;
+    }
+
+    return allocationCount;
+}
+
+SceneStageTimes CalculateStageTimes(std::vector<std::chrono::nanoseconds>& samples)
+{
+    SceneStageTimes times;
+    if(samples.empty()) { return times; }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::chrono::nanoseconds total{0};
+    for(std::chrono::nanoseconds sample : samples)
+    {
+        total += sample;
+    }
+
+    times.mean = total / (int64_t)samples.size();
+    times.p50 = samples[(samples.size() - 1) / 2];
+    times.p99 = samples[((samples.size() - 1) * 99) / 100];
+    times.max = samples.back();
+
+    return times;
+}
+
+SceneBenchmarkResult MeasureSceneBenchmark(SceneBenchmarkScene& scene, const SceneBenchmarkParams& params)
+{
+    EnumArray<std::vector<std::chrono::nanoseconds>, SceneBenchmarkStage> stageSamples;
+    std::vector<std::chrono::nanoseconds> frameSamples;
+    std::vector<uint64_t> allocationSamples;
+
+    for(std::vector<std::chrono::nanoseconds>& samples : stageSamples)
+    {
+        samples.reserve(params.frameCount);
+    }
+    frameSamples.reserve(params.frameCount);
+    allocationSamples.reserve(params.frameCount);
+
+    // Frame 0 is the warm up frame
+    for(uint32_t frameIndex = 0; frameIndex <= params.frameCount; ++frameIndex)
+    {
+        const uint64_t allocationCountBefore = GetTotalAllocationCount();
+        const EnumArray<std::chrono::nanoseconds, SceneBenchmarkStage> stageTimes = scene.runFrame(frameIndex);
+        const uint64_t allocationCount = GetTotalAllocationCount() - allocationCountBefore;
+
+        if(frameIndex == 0) { continue; }
+
+        std::chrono::nanoseconds frameTime{0};
+        for(SceneBenchmarkStage stage : enumerate<SceneBenchmarkStage>())
+        {
+            stageSamples[stage].push_back(stageTimes[stage]);
+            frameTime += stageTimes[stage];
+        }
+
+        frameSamples.push_back(frameTime);
+        allocationSamples.push_back(allocationCount);
+    }
+
+    SceneBenchmarkResult result;
+    result.objectCount = (uint32_t)scene.getObjectCount();
+    result.frameCount = params.frameCount;
+
+    for(SceneBenchmarkStage stage : enumerate<SceneBenchmarkStage>())
+    {
+        result.stageTimes[stage] = CalculateStageTimes(stageSamples[stage]);
+    }
+    result.frameTimes = CalculateStageTimes(frameSamples);
+
+    if(!allocationSamples.empty())
+    {
+        uint64_t totalAllocationCount = 0;
+        for(uint64_t allocationCount : allocationSamples)
+        {
+            totalAllocationCount += allocationCount;
+            result.maxAllocationsPerFrame = std::max(result.maxAllocationsPerFrame, allocationCount);
+        }
+
+        result.meanAllocationsPerFrame = (double)totalAllocationCount / (double)allocationSamples.size();
+    }
+
+    return result;
+}
+
+SceneBenchmarkResult RunSceneBenchmark(uint32_t objectCount, const SceneBenchmarkParams& params)
+{
+    SceneBenchmarkScene scene(objectCount, params.seed);
+    return MeasureSceneBenchmark(scene, params);
+}
+} // namespace
+
+std::vector<SceneBenchmarkResult> RunSceneBenchmarks(const SceneBenchmarkParams& params)
+{
+    std::vector<SceneBenchmarkResult> results;
+
+    uint64_t objectCount = 1;
+    while(objectCount <= params.maxObjectCount)
+    {
+        results.push_back(RunSceneBenchmark((uint32_t)objectCount, params));
+        objectCount *= 10;
+    }
+
+    // A maximum that isn't a power of 10 is benchmarked too
+    if(results.empty() || results.back().objectCount < params.maxObjectCount)
+    {
+        results.push_back(RunSceneBenchmark(params.maxObjectCount, params));
+    }
+
+    return results;
+}
+
+SceneBenchmarkResult RunStressSceneBenchmark(const StressScene& stressScene, const SceneBenchmarkParams& params)
+{
+    SceneBenchmarkScene scene(stressScene);
+    return MeasureSceneBenchmark(scene, params);
+}
+
+void LogSceneBenchmarkReport(const std::vector<SceneBenchmarkResult>& results)
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    auto logTimes = [](std::string_view name, const SceneStageTimes& times) {
+        spdlog::info("        {:<16} mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms", name,
+                     Milliseconds(times.mean).count(), Milliseconds(times.p50).count(),
+                     Milliseconds(times.p99).count(), Milliseconds(times.max).count());
+    };
+
+    spdlog::info("Scene model cpu frame benchmarks");
+
+    for(const SceneBenchmarkResult& result : results)
+    {
+        spdlog::info("    {} objects, {} frames, {:.1f} allocations per frame (max {})", result.objectCount,
+                     result.frameCount, result.meanAllocationsPerFrame, result.maxAllocationsPerFrame);
+
+        for(SceneBenchmarkStage stage : enumerate<SceneBenchmarkStage>())
+        {
+            logTimes(ToStringView(stage), result.stageTimes[stage]);
+        }
+
+        logTimes("Frame", result.frameTimes);
+    }
+}
+} // namespace scrap
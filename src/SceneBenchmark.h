@@ -0,0 +1,160 @@
+// Benchmarks a model of the per object cpu work of a frame, for scenes from 1 up to maxObjectCount objects, growing
+// ten times each step. Runs without a window or a d3d12 device, so it can run on build machines without a gpu.
+//
+// This is not the engine's whole frame. The DeviceContext needs a window and its descriptor heaps only hold a few
+// thousand descriptors, so the benchmark doesn't create a RenderScene. The objects come from a StressScene, which gives
+// them a Transform, and get made up descriptor indices. The stages run the engine's own cpu code where it doesn't need
+// a device, and the loops around it are kept in step with the render scene's per object loops:
+//
+// Simulate: animates the dynamic objects' transforms and copies all of them into the frame's snapshot, like
+//     RenderScene::simulate.
+// ObjectConstants: builds every object's constants with MakeObjectConstants and writes them at the UploadBufferPool's
+//     allocation stride, like RasterRenderer::drawRenderObjects. The pool's allocation isn't part of it, the engine
+//     makes one per recorded chunk of objects.
+// Bindless: checks every material's compiled bindings against the binding layout and compiles the ones that are out of
+//     date with the ShaderBindingLayout, like CompileMaterialBindings.
+// TlasInstances: writes every transform into the TlasInstanceList the TLAccelerationStructure keeps its instances in,
+//     like RaytracingRenderer::preRender.
+//
+// There is no shader table stage. Objects with the same pipeline state and bindings share a hit group record, which is
+// written once when the bindings are compiled, so preRender doesn't write the shader table every frame.
+//
+// The first frame of a scene compiles the bindings and adds the TLAS instances and isn't counted.
+//
+// The object count sweep generates stress scenes with one mesh and material and every object moving.
+// RunStressSceneBenchmark measures the scene of a StressSceneConfig instead, the same workload the app loads with
+// -stressscene.
+//
+// SceneBenchmarkScene is one of the scenes. The regression suite times its frames too, as SceneModel/Frame1k and
+// SceneModel/Frame10k.
+
+#pragma once
+
+#include "CpuMesh.h"
+#include "EnumArray.h"
+#include "RenderObject.h"
+#include "RenderScene.h"
+#include "ShaderBindingLayout.h"
+#include "SharedString.h"
+#include "StressScene.h"
+#include "TlasInstanceList.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+enum class SceneBenchmarkStage
+{
+    Simulate,
+    ObjectConstants,
+    Bindless,
+    TlasInstances,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(SceneBenchmarkStage stage)
+{
+    switch(stage)
+    {
+    case SceneBenchmarkStage::Simulate: return "Simulate";
+    case SceneBenchmarkStage::ObjectConstants: return "ObjectConstants";
+    case SceneBenchmarkStage::Bindless: return "Bindless";
+    case SceneBenchmarkStage::TlasInstances: return "TlasInstances";
+    default: return "Unknown SceneBenchmarkStage";
+    }
+}
+
+class SceneBenchmarkScene
+{
+public:
+    // A scene of objectCount objects in a 200 unit cube, all of them moving
+    SceneBenchmarkScene(uint32_t objectCount, uint32_t seed);
+    explicit SceneBenchmarkScene(const StressScene& stressScene);
+    SceneBenchmarkScene(const SceneBenchmarkScene&) = delete;
+    SceneBenchmarkScene(SceneBenchmarkScene&&) = delete;
+    ~SceneBenchmarkScene() = default;
+
+    SceneBenchmarkScene& operator=(const SceneBenchmarkScene&) = delete;
+    SceneBenchmarkScene& operator=(SceneBenchmarkScene&&) = delete;
+
+    // Runs every stage of a frame and returns how long each one took
+    EnumArray<std::chrono::nanoseconds, SceneBenchmarkStage> runFrame(uint32_t frameIndex);
+
+    [[nodiscard]] size_t getObjectCount() const { return mTransforms.size(); }
+
+private:
+    // The part of MaterialBindings the benchmark needs. There is no GpuMesh to compile against.
+    struct ObjectBindings
+    {
+        const ShaderBindingLayout* layout = nullptr;
+        ShaderBindingIndices indices;
+    };
+
+    void simulate(uint32_t frameIndex);
+    void buildObjectConstants();
+    void compileBindings();
+    void updateTlasInstances();
+
+    CpuMesh mMesh;
+    ShaderBindingLayout mBindingLayout;
+    SharedString mTextureName{"Texture"};
+
+    // Owned by the simulation
+    std::vector<Transform> mTransforms;
+    std::vector<uint32_t> mDynamicObjects;
+    // Indexed like mDynamicObjects
+    std::vector<float> mRotationSpeeds;
+
+    // The frame's snapshot, like RenderParams
+    FrameConstantBuffer mFrameConstants{};
+    std::vector<Transform> mSnapshotTransforms;
+
+    // Owned by the render stage
+    std::vector<ObjectBindings> mBindings;
+    std::vector<std::byte> mUploadBuffer;
+    TlasInstanceList mTlasInstances;
+    // The TLAS instance id of every object
+    std::vector<size_t> mTlasInstanceIds;
+};
+
+struct SceneBenchmarkParams
+{
+    uint32_t frameCount = 60;
+    uint32_t maxObjectCount = 1000000;
+    uint32_t seed = 1;
+};
+
+struct SceneStageTimes
+{
+    std::chrono::nanoseconds mean{0};
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+};
+
+struct SceneBenchmarkResult
+{
+    uint32_t objectCount = 0;
+    uint32_t frameCount = 0;
+
+    EnumArray<SceneStageTimes, SceneBenchmarkStage> stageTimes{};
+    SceneStageTimes frameTimes;
+
+    // Counted by the MemoryTracker. Always 0 with SCRAP_MEMORY_TRACKING_ENABLED set to 0.
+    double meanAllocationsPerFrame = 0.0;
+    uint64_t maxAllocationsPerFrame = 0;
+};
+
+[[nodiscard]] std::vector<SceneBenchmarkResult> RunSceneBenchmarks(const SceneBenchmarkParams& params);
+// Ignores the params' maxObjectCount and seed, the stress scene has its own
+[[nodiscard]] SceneBenchmarkResult RunStressSceneBenchmark(const StressScene& stressScene,
+                                                           const SceneBenchmarkParams& params);
+
+void LogSceneBenchmarkReport(const std::vector<SceneBenchmarkResult>& results);
+} // namespace scrap
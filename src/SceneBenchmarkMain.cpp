@@ -0,0 +1,98 @@
+// Entry point of the SceneBenchmark console program. Runs the benchmarks of the SceneBenchmarkScene model of the
+// scene's per object cpu work and logs the report.
+//
+// SceneBenchmark [-frames <count>] [-maxobjects <count>] [-seed <value>] [-stressscene [file]]
+//   -frames <count> times count frames of every scene, 60 by default.
+//   -maxobjects <count> benchmarks scenes from 1 up to count objects, 1000000 by default.
+//   -seed <value> seeds the random transforms, so runs with the same seed benchmark the same scenes.
+//   -stressscene [file] benchmarks the stress scene the config file describes, or the default StressSceneConfig,
+//   instead of the object count sweep.
+
+#include "JobSystem.h"
+#include "SceneBenchmark.h"
+#include "StressScene.h"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include <spdlog/sinks/msvc_sink.h>
+#include <spdlog/sinks/stdout_sinks.h>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+// Parses the numeric argument following args[index], if there is one
+uint32_t ParseOptionalCount(std::span<char*> args, size_t index, uint32_t defaultValue)
+{
+    if(index + 1 >= args.size() || args[index + 1][0] == '-') { return defaultValue; }
+    return (uint32_t)std::strtoul(args[index + 1], nullptr, 10);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::shared_ptr<spdlog::logger> scrapLogger;
+    {
+        // setup a logger for the Visual Studio output window and for standard console out
+        std::array<spdlog::sink_ptr, 2> sinks;
+        sinks[0] = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+        sinks[1] = std::make_shared<spdlog::sinks::msvc_sink_mt>();
+
+        scrapLogger = std::make_shared<spdlog::logger>("scrap", std::begin(sinks), std::end(sinks));
+        spdlog::set_default_logger(scrapLogger);
+    }
+
+    scrap::SceneBenchmarkParams params;
+    std::optional<scrap::StressSceneConfig> stressSceneConfig;
+    {
+        std::span<char*> args(argv, (size_t)argc);
+
+        for(size_t i = 1; i < args.size(); ++i)
+        {
+            const std::string_view arg = args[i];
+            if(arg == "-frames") { params.frameCount = ParseOptionalCount(args, i, params.frameCount); }
+            else if(arg == "-maxobjects")
+            {
+                params.maxObjectCount = ParseOptionalCount(args, i, params.maxObjectCount);
+            }
+            else if(arg == "-seed") { params.seed = ParseOptionalCount(args, i, params.seed); }
+            else if(arg == "-stressscene")
+            {
+                if(i + 1 < args.size() && args[i + 1][0] != '-')
+                {
+                    stressSceneConfig = scrap::ReadStressSceneConfig(args[i + 1]);
+                    if(!stressSceneConfig.has_value())
+                    {
+                        scrapLogger->flush();
+                        return 1;
+                    }
+                }
+                else { stressSceneConfig = scrap::StressSceneConfig{}; }
+            }
+        }
+    }
+
+    if(stressSceneConfig.has_value())
+    {
+        // Only generates the scene. The frames are measured on this thread, like the sweep's.
+        scrap::JobSystem jobSystem;
+
+        scrap::LogStressSceneConfig(stressSceneConfig.value());
+
+        const auto generateStart = std::chrono::steady_clock::now();
+        const scrap::StressScene stressScene = scrap::GenerateStressScene(stressSceneConfig.value(), &jobSystem);
+        const std::chrono::duration<double, std::milli> generateTime = std::chrono::steady_clock::now() - generateStart;
+        spdlog::info("Generated the stress scene on {} threads in {:.1f} ms", jobSystem.getThreadCount(),
+                     generateTime.count());
+
+        scrap::LogSceneBenchmarkReport({scrap::RunStressSceneBenchmark(stressScene, params)});
+    }
+    else { scrap::LogSceneBenchmarkReport(scrap::RunSceneBenchmarks(params)); }
+    scrapLogger->flush();
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "ShaderBindingLayout.h"
+
+#include "Utility.h"
+
+#include <algorithm>
+
+#include <city.h>
+
+namespace scrap
+{
+ShaderBindingKey MakeShaderBindingKey(StringHash name, ShaderResourceType type, ShaderResourceDimension dimension)
+{
+    const uint64_t typeAndDimension = ((uint64_t)ToUnderlying(type) << 32) | (uint64_t)ToUnderlying(dimension);
+    return ShaderBindingKey(Hash128to64(uint128(name.hashValue(), typeAndDimension)));
+}
+
+ShaderBindingKey MakeShaderBindingKey(ShaderVertexSemantic semantic, uint32_t semanticIndex)
+{
+    // Vertex elements are stored separately from the resources, so there is no need to hash these to avoid
+    // collisions with resource keys.
+    return ShaderBindingKey(((uint64_t)ToUnderlying(semantic) << 32) | (uint64_t)semanticIndex);
+}
+
+ShaderBindingLayout::ShaderBindingLayout(const ShaderInputs& inputs)
+{
+    mResourceSlots.reserve(inputs.resources.size());
+    for(const ShaderResource& resource : inputs.resources)
+    {
+        mResourceSlots.push_back(
+            Slot{MakeShaderBindingKey(resource.name.hash(), resource.type, resource.dimension), resource.index});
+        mResourceSlotCount = std::max(mResourceSlotCount, resource.index + 1);
+    }
+
+    mVertexElementSlots.reserve(inputs.vertexElements.size());
+    for(const ShaderVertexElement& element : inputs.vertexElements)
+    {
+        mVertexElementSlots.push_back(
+            Slot{MakeShaderBindingKey(element.semantic, element.semanticIndex), element.index});
+        mVertexElementSlotCount = std::max(mVertexElementSlotCount, element.index + 1);
+    }
+
+    auto keyLess = [](const Slot& left, const Slot& right) { return left.key < right.key; };
+    std::sort(mResourceSlots.begin(), mResourceSlots.end(), keyLess);
+    std::sort(mVertexElementSlots.begin(), mVertexElementSlots.end(), keyLess);
+
+    mResourceSlotCount = std::min(mResourceSlotCount, d3d12::kMaxBindlessResources);
+    mVertexElementSlotCount = std::min(mVertexElementSlotCount, d3d12::kMaxBindlessVertexBuffers);
+}
+
+std::optional<uint32_t> ShaderBindingLayout::getResourceSlot(ShaderBindingKey key) const
+{
+    return findSlot(mResourceSlots, key);
+}
+
+std::optional<uint32_t> ShaderBindingLayout::getVertexElementSlot(ShaderBindingKey key) const
+{
+    return findSlot(mVertexElementSlots, key);
+}
+
+bool ShaderBindingLayout::bindResource(ShaderBindingIndices& indices,
+                                       ShaderBindingKey key,
+                                       uint32_t descriptorHeapIndex) const
+{
+    const std::optional<uint32_t> slot = getResourceSlot(key);
+    if(!slot || slot.value() >= indices.resourceIndices.size()) { return false; }
+
+    indices.resourceIndices[slot.value()] = descriptorHeapIndex;
+    return true;
+}
+
+bool ShaderBindingLayout::bindVertexElement(ShaderBindingIndices& indices,
+                                            ShaderBindingKey key,
+                                            uint32_t descriptorHeapIndex) const
+{
+    const std::optional<uint32_t> slot = getVertexElementSlot(key);
+    if(!slot || slot.value() >= indices.vertexBufferIndices.size()) { return false; }
+
+    indices.vertexBufferIndices[slot.value()] = descriptorHeapIndex;
+    return true;
+}
+
+std::optional<uint32_t> ShaderBindingLayout::findSlot(const std::vector<Slot>& slots, ShaderBindingKey key)
+{
+    auto itr = std::lower_bound(slots.cbegin(), slots.cend(), key,
+                                [](const Slot& slot, ShaderBindingKey key) { return slot.key < key; });
+
+    if(itr == slots.cend() || itr->key != key) { return std::nullopt; }
+
+    return itr->index;
+}
+} // namespace scrap
@@ -0,0 +1,92 @@
+// The bindless shaders read their descriptor heap indices out of root constants. Which root constant a resource ends
+// up in is decided by the shader compiler, so the CPU side has to match resources up with root constant indices at
+// some point. ShaderBindingLayout does that matching once, when the shader is compiled, instead of searching the
+// reflection data by name on every draw.
+//
+// Classes:
+//     ShaderBindingKey: Pre-hashed key for a binding. Resources are keyed by name, type and dimension. Vertex elements
+//                       are keyed by semantic and semantic index.
+//     ShaderBindingLayout: Immutable map from binding keys to root constant indices. Built from the reflected
+//                          ShaderInputs when a shader finishes compiling.
+//     ShaderBindingIndices: Flat "root constant index -> descriptor heap index" arrays. Materials compile into this
+//                           once against a layout and the result is copied straight into root constants at draw time.
+
+#pragma once
+
+#include "RenderDefs.h"
+#include "StringHash.h"
+#include "d3d12/D3D12Config.h"
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace scrap
+{
+class ShaderBindingKey
+{
+public:
+    constexpr ShaderBindingKey() = default;
+    constexpr explicit ShaderBindingKey(uint64_t value): mValue(value) {}
+
+    [[nodiscard]] constexpr uint64_t value() const { return mValue; }
+
+    constexpr auto operator<=>(const ShaderBindingKey&) const = default;
+
+private:
+    uint64_t mValue = 0;
+};
+
+[[nodiscard]] ShaderBindingKey
+MakeShaderBindingKey(StringHash name, ShaderResourceType type, ShaderResourceDimension dimension);
+[[nodiscard]] ShaderBindingKey MakeShaderBindingKey(ShaderVertexSemantic semantic, uint32_t semanticIndex);
+
+struct ShaderBindingIndices
+{
+    std::array<uint32_t, d3d12::kMaxBindlessResources> resourceIndices = {};
+    std::array<uint32_t, d3d12::kMaxBindlessVertexBuffers> vertexBufferIndices = {};
+
+    auto operator<=>(const ShaderBindingIndices&) const = default;
+};
+
+class ShaderBindingLayout
+{
+public:
+    ShaderBindingLayout() = default;
+    explicit ShaderBindingLayout(const ShaderInputs& inputs);
+    ShaderBindingLayout(const ShaderBindingLayout&) = default;
+    ShaderBindingLayout(ShaderBindingLayout&&) = default;
+    ~ShaderBindingLayout() = default;
+
+    ShaderBindingLayout& operator=(const ShaderBindingLayout&) = default;
+    ShaderBindingLayout& operator=(ShaderBindingLayout&&) = default;
+
+    [[nodiscard]] std::optional<uint32_t> getResourceSlot(ShaderBindingKey key) const;
+    [[nodiscard]] std::optional<uint32_t> getVertexElementSlot(ShaderBindingKey key) const;
+
+    // One past the highest root constant index used. This is the number of root constants that need to be set.
+    [[nodiscard]] uint32_t getResourceSlotCount() const { return mResourceSlotCount; }
+    [[nodiscard]] uint32_t getVertexElementSlotCount() const { return mVertexElementSlotCount; }
+
+    // Writes the descriptor heap index into the slot for the key. Returns false if the shader doesn't use the key.
+    bool bindResource(ShaderBindingIndices& indices, ShaderBindingKey key, uint32_t descriptorHeapIndex) const;
+    bool bindVertexElement(ShaderBindingIndices& indices, ShaderBindingKey key, uint32_t descriptorHeapIndex) const;
+
+private:
+    struct Slot
+    {
+        ShaderBindingKey key;
+        uint32_t index = 0;
+    };
+
+    static std::optional<uint32_t> findSlot(const std::vector<Slot>& slots, ShaderBindingKey key);
+
+    // Both are sorted by key
+    std::vector<Slot> mResourceSlots;
+    std::vector<Slot> mVertexElementSlots;
+    uint32_t mResourceSlotCount = 0;
+    uint32_t mVertexElementSlotCount = 0;
+};
+} // namespace scrap
@@ -0,0 +1,339 @@
+#include "StressScene.h"
+
+#include "EnumIterator.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include "PrimitiveMesh.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <span>
+#include <sstream>
+
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+// What a generator's values are used for. Combined with an index, so every mesh, texture, cluster and object gets its
+// own sequence.
+enum class RandomStream : uint64_t
+{
+    Object,
+    Mesh,
+    Texture,
+    Cluster,
+};
+
+// SplitMix64. Cheap enough to seed one for every object.
+class StressSceneRandom
+{
+public:
+    StressSceneRandom(uint32_t seed, RandomStream stream, uint64_t index)
+        : mState(((uint64_t)seed * 0x9e3779b97f4a7c15ull) ^
+                 ((((uint64_t)stream << 32) | index) * 0xd1b54a32d192ed03ull))
+    {}
+
+    uint64_t next()
+    {
+        uint64_t z = (mState += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1) from the top 24 bits, which is all a float's mantissa holds
+    float nextFloat() { return (float)(next() >> 40) * (1.0f / 16777216.0f); }
+    float nextFloat(float min, float max) { return min + (max - min) * nextFloat(); }
+
+    // Draws x, y and z in that order. The order function arguments are evaluated in isn't specified.
+    glm::vec3 nextVec3(float min, float max)
+    {
+        const float x = nextFloat(min, max);
+        const float y = nextFloat(min, max);
+        const float z = nextFloat(min, max);
+        return glm::vec3(x, y, z);
+    }
+
+    // [0, count)
+    uint32_t nextIndex(uint32_t count) { return (uint32_t)(((next() >> 32) * count) >> 32); }
+
+private:
+    uint64_t mState;
+};
+
+StressSceneConfig ClampConfig(StressSceneConfig config)
+{
+    config.meshCount = std::max(config.meshCount, 1u);
+    config.maxSubdivisions = std::min(config.maxSubdivisions, StressSceneConfig::kMaxSubdivisions);
+    config.materialCount = std::max(config.materialCount, 1u);
+    config.textureCount = std::max(config.textureCount, 1u);
+    config.dynamicFraction = std::clamp(config.dynamicFraction, 0.0f, 1.0f);
+    config.extent = std::max(config.extent, 1.0f);
+    config.clusterCount = std::max(config.clusterCount, 1u);
+
+    return config;
+}
+
+std::string_view Trim(std::string_view text)
+{
+    constexpr std::string_view kWhitespace = " \t\r\n";
+
+    const size_t first = text.find_first_not_of(kWhitespace);
+    if(first == std::string_view::npos) { return {}; }
+
+    return text.substr(first, text.find_last_not_of(kWhitespace) - first + 1);
+}
+
+bool ParseValue(std::string_view value, uint32_t& result)
+{
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    return error == std::errc() && end == value.data() + value.size();
+}
+
+bool ParseValue(std::string_view value, float& result)
+{
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    return error == std::errc() && end == value.data() + value.size();
+}
+
+bool ParseValue(std::string_view value, StressSceneDistribution& result)
+{
+    for(StressSceneDistribution distribution : enumerate<StressSceneDistribution>())
+    {
+        if(value == ToStringView(distribution))
+        {
+            result = distribution;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ParseEntry(std::string_view key, std::string_view value, StressSceneConfig& config)
+{
+    if(key == "objects") { return ParseValue(value, config.objectCount); }
+    if(key == "meshes") { return ParseValue(value, config.meshCount); }
+    if(key == "maxsubdivisions") { return ParseValue(value, config.maxSubdivisions); }
+    if(key == "materials") { return ParseValue(value, config.materialCount); }
+    if(key == "textures") { return ParseValue(value, config.textureCount); }
+    if(key == "dynamic") { return ParseValue(value, config.dynamicFraction); }
+    if(key == "distribution") { return ParseValue(value, config.distribution); }
+    if(key == "extent") { return ParseValue(value, config.extent); }
+    if(key == "clusters") { return ParseValue(value, config.clusterCount); }
+    if(key == "seed") { return ParseValue(value, config.seed); }
+
+    spdlog::error("Unknown stress scene config key '{}'", key);
+    return false;
+}
+
+// The meshes go from no subdivisions up to the maximum and each gets its own proportions
+CpuMesh GenerateMesh(const StressSceneConfig& config, uint32_t meshIndex)
+{
+    const uint32_t subdivisions =
+        (config.meshCount > 1) ? (meshIndex * config.maxSubdivisions) / (config.meshCount - 1) : 0;
+
+    StressSceneRandom random(config.seed, RandomStream::Mesh, meshIndex);
+    const glm::vec3 size = random.nextVec3(0.5f, 1.5f);
+
+    return GenerateCubeMesh(CubeMeshTopologyType::Triangle, subdivisions, glm::vec3(0.0f, 0.0f, 0.0f), size);
+}
+
+StressSceneTexture GenerateTexture(const StressSceneConfig& config, uint32_t textureIndex)
+{
+    StressSceneRandom random(config.seed, RandomStream::Texture, textureIndex);
+
+    StressSceneTexture texture;
+    texture.extent = 64u << random.nextIndex(4);
+    for(uint8_t& channel : texture.color)
+    {
+        channel = (uint8_t)random.nextIndex(256);
+    }
+
+    return texture;
+}
+
+glm::vec3 CalculateGridPosition(const StressSceneConfig& config, uint32_t objectIndex)
+{
+    const uint32_t side = std::max((uint32_t)std::ceil(std::cbrt((double)config.objectCount)), 1u);
+    const float spacing = 2.0f * config.extent / (float)side;
+
+    const glm::vec3 cell((float)(objectIndex % side), (float)((objectIndex / side) % side),
+                         (float)(objectIndex / (side * side)));
+
+    return glm::vec3(-config.extent) + (cell + 0.5f) * spacing;
+}
+
+StressSceneObject GenerateObject(const StressSceneConfig& config,
+                                 std::span<const glm::vec3> clusterCenters,
+                                 uint32_t objectIndex)
+{
+    StressSceneRandom random(config.seed, RandomStream::Object, objectIndex);
+
+    StressSceneObject object;
+
+    // Every distribution draws the same number of values, so the rest of the object doesn't depend on it
+    const glm::vec3 uniformPosition = random.nextVec3(-1.0f, 1.0f);
+    const uint32_t clusterIndex = random.nextIndex((uint32_t)clusterCenters.size());
+
+    switch(config.distribution)
+    {
+    case StressSceneDistribution::Uniform: object.transform.position = uniformPosition * config.extent; break;
+    case StressSceneDistribution::Clustered:
+    {
+        // Squaring the offset packs the objects closer to the center
+        const glm::vec3 offset = uniformPosition * glm::abs(uniformPosition);
+        object.transform.position = clusterCenters[clusterIndex] + offset * (config.extent * 0.1f);
+        break;
+    }
+    case StressSceneDistribution::Grid:
+        object.transform.position = CalculateGridPosition(config, objectIndex);
+        break;
+    default: break;
+    }
+
+    glm::vec3 axis = random.nextVec3(-1.0f, 1.0f);
+    if(glm::length(axis) < 0.001f) { axis = glm::vec3(0.0f, 1.0f, 0.0f); }
+    object.transform.rotation = glm::angleAxis(random.nextFloat(0.0f, glm::two_pi<float>()), glm::normalize(axis));
+    object.transform.scale = glm::vec3(random.nextFloat(0.5f, 2.0f));
+
+    object.meshIndex = random.nextIndex(config.meshCount);
+    object.materialIndex = random.nextIndex(config.materialCount);
+
+    const bool isDynamic = random.nextFloat() < config.dynamicFraction;
+    const float rotationSpeed = random.nextFloat(0.001f, 0.02f);
+    if(isDynamic) { object.rotationSpeed = rotationSpeed; }
+
+    return object;
+}
+} // namespace
+
+std::optional<StressSceneConfig> ParseStressSceneConfig(std::string_view text)
+{
+    StressSceneConfig config;
+
+    while(!text.empty())
+    {
+        const size_t lineEnd = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(std::min(lineEnd + 1, text.size()));
+
+        line = line.substr(0, line.find('#'));
+
+        while(!line.empty())
+        {
+            const size_t entryEnd = std::min(line.find(','), line.size());
+            const std::string_view entry = Trim(line.substr(0, entryEnd));
+            line.remove_prefix(std::min(entryEnd + 1, line.size()));
+
+            if(entry.empty()) { continue; }
+
+            const size_t separator = entry.find('=');
+            if(separator == std::string_view::npos)
+            {
+                spdlog::error("Stress scene config entry '{}' isn't a key = value pair", entry);
+                return std::nullopt;
+            }
+
+            const std::string_view key = Trim(entry.substr(0, separator));
+            const std::string_view value = Trim(entry.substr(separator + 1));
+
+            if(!ParseEntry(key, value, config))
+            {
+                spdlog::error("'{}' isn't a valid value for the stress scene config key '{}'", value, key);
+                return std::nullopt;
+            }
+        }
+    }
+
+    return ClampConfig(config);
+}
+
+std::optional<StressSceneConfig> ReadStressSceneConfig(const std::filesystem::path& filePath)
+{
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if(!file.is_open())
+    {
+        spdlog::error("Failed to open the stress scene config '{}'", filePath.string());
+        return std::nullopt;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    return ParseStressSceneConfig(text.str());
+}
+
+StressScene GenerateStressScene(const StressSceneConfig& config, JobSystem* jobSystem)
+{
+    SCRAP_MEMORY_TAG(Scene);
+
+    StressScene scene;
+    scene.config = ClampConfig(config);
+    const StressSceneConfig& clampedConfig = scene.config;
+
+    auto forEach = [jobSystem](size_t count, size_t grainSize, auto&& function) {
+        if(jobSystem != nullptr) { jobSystem->parallelFor(0, count, function, grainSize); }
+        else { function(size_t(0), count); }
+    };
+
+    // Meshes with many subdivisions take far longer than the others, so every mesh is its own grain
+    scene.meshes.resize(clampedConfig.meshCount);
+    forEach(scene.meshes.size(), 1, [&](size_t first, size_t last) {
+        for(size_t meshIndex = first; meshIndex < last; ++meshIndex)
+        {
+            scene.meshes[meshIndex] = GenerateMesh(clampedConfig, (uint32_t)meshIndex);
+        }
+    });
+
+    scene.textures.resize(clampedConfig.textureCount);
+    for(uint32_t textureIndex = 0; textureIndex < clampedConfig.textureCount; ++textureIndex)
+    {
+        scene.textures[textureIndex] = GenerateTexture(clampedConfig, textureIndex);
+    }
+
+    // Every texture is used once there are at least as many materials as textures
+    scene.materials.resize(clampedConfig.materialCount);
+    for(uint32_t materialIndex = 0; materialIndex < clampedConfig.materialCount; ++materialIndex)
+    {
+        scene.materials[materialIndex].textureIndex = materialIndex % clampedConfig.textureCount;
+    }
+
+    std::vector<glm::vec3> clusterCenters(clampedConfig.clusterCount);
+    for(uint32_t clusterIndex = 0; clusterIndex < clampedConfig.clusterCount; ++clusterIndex)
+    {
+        StressSceneRandom random(clampedConfig.seed, RandomStream::Cluster, clusterIndex);
+        clusterCenters[clusterIndex] = random.nextVec3(-0.8f, 0.8f) * clampedConfig.extent;
+    }
+
+    scene.objects.resize(clampedConfig.objectCount);
+    forEach(scene.objects.size(), 0, [&](size_t first, size_t last) {
+        for(size_t objectIndex = first; objectIndex < last; ++objectIndex)
+        {
+            scene.objects[objectIndex] = GenerateObject(clampedConfig, clusterCenters, (uint32_t)objectIndex);
+        }
+    });
+
+    for(uint32_t objectIndex = 0; objectIndex < clampedConfig.objectCount; ++objectIndex)
+    {
+        if(scene.objects[objectIndex].rotationSpeed != 0.0f) { scene.dynamicObjects.push_back(objectIndex); }
+    }
+
+    return scene;
+}
+
+void LogStressSceneConfig(const StressSceneConfig& config)
+{
+    spdlog::info("Stress scene: {} objects, {} meshes with up to {} subdivisions, {} materials, {} textures, {:.0f}% "
+                 "dynamic, {} distribution with an extent of {}, seed {}",
+                 config.objectCount, config.meshCount, config.maxSubdivisions, config.materialCount,
+                 config.textureCount, config.dynamicFraction * 100.0f, ToStringView(config.distribution), config.extent,
+                 config.seed);
+}
+} // namespace scrap
@@ -0,0 +1,130 @@
+// Classes:
+//   StressSceneConfig
+//   StressScene
+//
+// StressSceneConfig:
+//   Describes a large scene to measure the engine against: how many objects, how many distinct meshes, materials and
+//   textures they share, how many of them move and how they're spread out. Configs are text files of key = value pairs,
+//   one per line or separated by commas, so the same workload can be loaded by the app with -stressscene and by the
+//   SceneBenchmark program. # starts a comment.
+//
+//     objects = 100000
+//     meshes = 8             distinct cube meshes, from 0 up to maxsubdivisions subdivisions
+//     maxsubdivisions = 16
+//     materials = 32
+//     textures = 8           checkerboards of different colors and sizes, shared by the materials
+//     dynamic = 0.25         the fraction of objects that rotate every frame
+//     distribution = uniform uniform, clustered or grid
+//     extent = 50            half the size of the volume the objects are placed in
+//     clusters = 16          the cluster count of the clustered distribution
+//     seed = 1
+//
+// StressScene:
+//   The device independent description GenerateStressScene builds from a config: the cpu meshes, the textures'
+//   parameters, the materials and a transform, mesh and material for every object. RenderScene turns it into render
+//   objects and SceneBenchmarkScene into its model of their per object cpu work.
+//
+//   Generation is deterministic. Every object draws its random values from a generator seeded with the config's seed
+//   and its own index, so the scene doesn't depend on how the objects are split up between the job system's threads.
+//   The generator and the conversion to floats are written out instead of using the standard distributions, whose
+//   results differ between standard libraries.
+
+#pragma once
+
+#include "CpuMesh.h"
+#include "RenderObject.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+class JobSystem;
+
+enum class StressSceneDistribution
+{
+    // Anywhere in the volume
+    Uniform,
+    // Around cluster centers spread uniformly through the volume
+    Clustered,
+    // On a regular grid that fills the volume
+    Grid,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+[[nodiscard]] constexpr std::string_view ToStringView(StressSceneDistribution distribution)
+{
+    switch(distribution)
+    {
+    case StressSceneDistribution::Uniform: return "uniform";
+    case StressSceneDistribution::Clustered: return "clustered";
+    case StressSceneDistribution::Grid: return "grid";
+    default: return "Unknown StressSceneDistribution";
+    }
+}
+
+struct StressSceneConfig
+{
+    // The cube meshes use 16 bit indices, which limits their subdivisions
+    static constexpr uint32_t kMaxSubdivisions = 100;
+
+    uint32_t objectCount = 10000;
+    uint32_t meshCount = 4;
+    uint32_t maxSubdivisions = 8;
+    uint32_t materialCount = 16;
+    uint32_t textureCount = 4;
+    float dynamicFraction = 0.25f;
+    StressSceneDistribution distribution = StressSceneDistribution::Uniform;
+    float extent = 50.0f;
+    uint32_t clusterCount = 16;
+    uint32_t seed = 1;
+};
+
+struct StressSceneTexture
+{
+    uint32_t extent = 256;
+    std::array<uint8_t, 3> color = {0xff, 0xff, 0xff};
+};
+
+struct StressSceneMaterial
+{
+    uint32_t textureIndex = 0;
+};
+
+struct StressSceneObject
+{
+    Transform transform;
+    uint32_t meshIndex = 0;
+    uint32_t materialIndex = 0;
+    // Radians per frame around the y axis. 0 for static objects.
+    float rotationSpeed = 0.0f;
+};
+
+struct StressScene
+{
+    StressSceneConfig config;
+
+    std::vector<CpuMesh> meshes;
+    std::vector<StressSceneTexture> textures;
+    std::vector<StressSceneMaterial> materials;
+    std::vector<StressSceneObject> objects;
+    // The indices of the objects with a rotation speed, in ascending order
+    std::vector<uint32_t> dynamicObjects;
+};
+
+// Logs an error and returns nullopt for unknown keys and values that don't parse. Out of range values are clamped.
+[[nodiscard]] std::optional<StressSceneConfig> ParseStressSceneConfig(std::string_view text);
+[[nodiscard]] std::optional<StressSceneConfig> ReadStressSceneConfig(const std::filesystem::path& filePath);
+
+// Generates the meshes and objects in parallel on jobSystem, or on the calling thread if it's null. Can be called
+// from a job.
+[[nodiscard]] StressScene GenerateStressScene(const StressSceneConfig& config, JobSystem* jobSystem = nullptr);
+
+void LogStressSceneConfig(const StressSceneConfig& config);
+} // namespace scrap
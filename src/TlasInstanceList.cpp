@@ -0,0 +1,81 @@
+#include "TlasInstanceList.h"
+
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/mat3x4.hpp>
+#include <glm/matrix.hpp>
+
+namespace scrap
+{
+size_t TlasInstanceList::addInstance(const D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc)
+{
+    size_t id;
+    if(mFreeIds.empty())
+    {
+        id = mInstanceIndices.size();
+        mInstanceIndices.push_back(kInvalidInstanceIndex);
+    }
+    else
+    {
+        id = mFreeIds.back();
+        mFreeIds.pop_back();
+    }
+
+    mInstanceIndices[id] = mInstanceDescs.size();
+    mInstanceDescs.push_back(instanceDesc);
+    mInstanceIds.push_back(id);
+
+    return id;
+}
+
+size_t TlasInstanceList::getInstanceIndex(size_t id) const
+{
+    return (id < mInstanceIndices.size()) ? mInstanceIndices[id] : kInvalidInstanceIndex;
+}
+
+bool TlasInstanceList::removeInstance(size_t id)
+{
+    const size_t instanceIndex = getInstanceIndex(id);
+    if(instanceIndex == kInvalidInstanceIndex) { return false; }
+
+    const size_t lastIndex = mInstanceDescs.size() - 1;
+    if(instanceIndex != lastIndex)
+    {
+        mInstanceDescs[instanceIndex] = mInstanceDescs[lastIndex];
+        mInstanceIds[instanceIndex] = mInstanceIds[lastIndex];
+        mInstanceIndices[mInstanceIds[instanceIndex]] = instanceIndex;
+    }
+
+    mInstanceDescs.pop_back();
+    mInstanceIds.pop_back();
+
+    mInstanceIndices[id] = kInvalidInstanceIndex;
+    mFreeIds.push_back(id);
+
+    return true;
+}
+
+bool TlasInstanceList::updateInstanceTransform(size_t id, const glm::mat4x3& transform)
+{
+    const size_t instanceIndex = getInstanceIndex(id);
+    if(instanceIndex == kInvalidInstanceIndex) { return false; }
+
+    const glm::mat3x4 transposedTransform = glm::transpose(transform);
+
+    std::memcpy(mInstanceDescs[instanceIndex].Transform, glm::value_ptr(transposedTransform),
+                sizeof(D3D12_RAYTRACING_INSTANCE_DESC::Transform));
+
+    return true;
+}
+
+bool TlasInstanceList::updateInstanceHitGroupIndex(size_t id, uint32_t hitGroupIndex)
+{
+    const size_t instanceIndex = getInstanceIndex(id);
+    if(instanceIndex == kInvalidInstanceIndex) { return false; }
+
+    mInstanceDescs[instanceIndex].InstanceContributionToHitGroupIndex = hitGroupIndex;
+
+    return true;
+}
+} // namespace scrap
@@ -0,0 +1,61 @@
+// Classes:
+//   TlasInstanceList
+//
+// TlasInstanceList:
+//   The instance descs of a top level acceleration structure, kept dense so they can be copied into the instance desc
+//   buffer as they are. Every instance gets an id that stays the same while other instances are added and removed.
+//   Removing an instance moves the last one into its place, and an index per id finds an instance without searching.
+//   Removed ids are reused. Only tracks the descs, which is what lets the TLAccelerationStructure's per instance
+//   updates run without a d3d12 device. Not thread safe.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include <EASTL/vector.h>
+#include <d3d12.h>
+#include <glm/mat4x3.hpp>
+
+namespace scrap
+{
+class TlasInstanceList
+{
+public:
+    TlasInstanceList() = default;
+    TlasInstanceList(const TlasInstanceList&) = delete;
+    TlasInstanceList(TlasInstanceList&&) noexcept = default;
+    ~TlasInstanceList() = default;
+
+    TlasInstanceList& operator=(const TlasInstanceList&) = delete;
+    TlasInstanceList& operator=(TlasInstanceList&&) noexcept = default;
+
+    // Returns the id of the new instance
+    size_t addInstance(const D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc);
+
+    // The functions taking an id return false and do nothing for ids that aren't in use
+    bool removeInstance(size_t id);
+    bool updateInstanceTransform(size_t id, const glm::mat4x3& transform);
+    bool updateInstanceHitGroupIndex(size_t id, uint32_t hitGroupIndex);
+
+    [[nodiscard]] bool isInUse(size_t id) const { return getInstanceIndex(id) != kInvalidInstanceIndex; }
+
+    [[nodiscard]] std::span<const D3D12_RAYTRACING_INSTANCE_DESC> getInstanceDescs() const { return mInstanceDescs; }
+    [[nodiscard]] size_t getInstanceCount() const { return mInstanceDescs.size(); }
+
+private:
+    static constexpr size_t kInvalidInstanceIndex = std::numeric_limits<size_t>::max();
+
+    // Returns kInvalidInstanceIndex for ids that aren't in use
+    [[nodiscard]] size_t getInstanceIndex(size_t id) const;
+
+    // mInstanceDescs and mInstanceIds are dense and indexed the same
+    eastl::vector<D3D12_RAYTRACING_INSTANCE_DESC> mInstanceDescs;
+    eastl::vector<size_t> mInstanceIds;
+    // The index in mInstanceDescs of every id
+    eastl::vector<size_t> mInstanceIndices;
+    eastl::vector<size_t> mFreeIds;
+};
+} // namespace scrap
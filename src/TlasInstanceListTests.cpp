@@ -0,0 +1,99 @@
+#include "TlasInstanceList.h"
+#include "UnitTest.h"
+
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace scrap
+{
+namespace
+{
+D3D12_RAYTRACING_INSTANCE_DESC MakeInstanceDesc(uint32_t instanceId)
+{
+    D3D12_RAYTRACING_INSTANCE_DESC instanceDesc = {};
+    instanceDesc.InstanceID = instanceId;
+    instanceDesc.InstanceMask = 0xff;
+
+    return instanceDesc;
+}
+
+// The instance ids of the descs, in the order they are in the list
+std::vector<uint32_t> GetInstanceIds(const TlasInstanceList& instanceList)
+{
+    std::vector<uint32_t> instanceIds;
+    for(const D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc : instanceList.getInstanceDescs())
+    {
+        instanceIds.push_back(instanceDesc.InstanceID);
+    }
+
+    return instanceIds;
+}
+} // namespace
+
+SCRAP_TEST(TlasInstanceList, RemoveMovesLastInstanceIntoItsPlace)
+{
+    TlasInstanceList instanceList;
+    const size_t first = instanceList.addInstance(MakeInstanceDesc(10));
+    const size_t second = instanceList.addInstance(MakeInstanceDesc(11));
+    const size_t third = instanceList.addInstance(MakeInstanceDesc(12));
+    SCRAP_CHECK(GetInstanceIds(instanceList) == std::vector<uint32_t>({10, 11, 12}));
+
+    SCRAP_CHECK(instanceList.removeInstance(first));
+    SCRAP_CHECK(GetInstanceIds(instanceList) == std::vector<uint32_t>({12, 11}));
+    SCRAP_CHECK(!instanceList.isInUse(first));
+
+    // The moved instance is still found by its id
+    SCRAP_CHECK(instanceList.updateInstanceHitGroupIndex(third, 7));
+    SCRAP_CHECK(instanceList.getInstanceDescs()[0].InstanceContributionToHitGroupIndex == 7);
+    SCRAP_CHECK(instanceList.getInstanceDescs()[1].InstanceContributionToHitGroupIndex == 0);
+
+    SCRAP_CHECK(instanceList.removeInstance(second));
+    SCRAP_CHECK(instanceList.removeInstance(third));
+    SCRAP_CHECK(instanceList.getInstanceCount() == 0);
+}
+
+SCRAP_TEST(TlasInstanceList, ReusesRemovedIds)
+{
+    TlasInstanceList instanceList;
+    const size_t first = instanceList.addInstance(MakeInstanceDesc(0));
+    const size_t second = instanceList.addInstance(MakeInstanceDesc(1));
+
+    SCRAP_CHECK(instanceList.removeInstance(first));
+    const size_t reused = instanceList.addInstance(MakeInstanceDesc(2));
+    SCRAP_CHECK(reused == first);
+    SCRAP_CHECK(instanceList.isInUse(second));
+    SCRAP_CHECK(GetInstanceIds(instanceList) == std::vector<uint32_t>({1, 2}));
+}
+
+SCRAP_TEST(TlasInstanceList, IgnoresIdsNotInUse)
+{
+    TlasInstanceList instanceList;
+    const size_t id = instanceList.addInstance(MakeInstanceDesc(0));
+
+    SCRAP_CHECK(instanceList.removeInstance(id));
+    SCRAP_CHECK(!instanceList.removeInstance(id));
+    SCRAP_CHECK(!instanceList.updateInstanceTransform(id, glm::identity<glm::mat4x3>()));
+    SCRAP_CHECK(!instanceList.updateInstanceHitGroupIndex(id, 1));
+    SCRAP_CHECK(!instanceList.removeInstance(id + 100));
+    SCRAP_CHECK(instanceList.getInstanceCount() == 0);
+}
+
+SCRAP_TEST(TlasInstanceList, UpdateTransformWritesRowMajor)
+{
+    TlasInstanceList instanceList;
+    const size_t id = instanceList.addInstance(MakeInstanceDesc(0));
+
+    const glm::mat4x3 transform = glm::translate(glm::identity<glm::mat4x4>(), glm::vec3(1.0f, 2.0f, 3.0f));
+    SCRAP_CHECK(instanceList.updateInstanceTransform(id, transform));
+
+    // Every row of the 3x4 matrix ends with the translation
+    const D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc = instanceList.getInstanceDescs()[0];
+    SCRAP_CHECK(instanceDesc.Transform[0][0] == 1.0f);
+    SCRAP_CHECK(instanceDesc.Transform[0][3] == 1.0f);
+    SCRAP_CHECK(instanceDesc.Transform[1][1] == 1.0f);
+    SCRAP_CHECK(instanceDesc.Transform[1][3] == 2.0f);
+    SCRAP_CHECK(instanceDesc.Transform[2][2] == 1.0f);
+    SCRAP_CHECK(instanceDesc.Transform[2][3] == 3.0f);
+}
+} // namespace scrap
@@ -0,0 +1,296 @@
+#include "TransientResourcePlanner.h"
+
+#include "EnumIterator.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace scrap
+{
+void TransientResourcePlanner::reset()
+{
+    mResources.clear();
+    mPlacements.clear();
+    mHeaps.clear();
+    mAliasingBarriers.clear();
+    mStats = {};
+}
+
+uint32_t TransientResourcePlanner::addResource(const TransientResourceRequest& request)
+{
+    Resource& resource = mResources.emplace_back();
+    resource.name = request.name;
+    resource.byteSize = request.byteSize;
+    resource.alignment = std::max(request.alignment, uint64_t(1));
+    resource.heapType = request.heapType;
+    resource.firstPass = request.firstPass;
+    resource.lastPass = std::max(request.firstPass, request.lastPass);
+
+    return (uint32_t)mResources.size() - 1;
+}
+
+void TransientResourcePlanner::plan(const PlanOptions& options)
+{
+    mPlacements.assign(mResources.size(), TransientResourcePlacement{});
+    mHeaps.clear();
+    mAliasingBarriers.clear();
+    mStats = {};
+
+    for(const Resource& resource : mResources)
+    {
+        mStats.unaliasedByteSize += AlignInteger(resource.byteSize, resource.alignment);
+    }
+
+    calculatePeakLiveByteSize();
+
+    EnumArray<std::vector<uint32_t>, TransientHeapType> heapResources;
+
+    for(uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); ++resourceIndex)
+    {
+        const TransientHeapType heapType =
+            options.separateHeapTypes ? mResources[resourceIndex].heapType : TransientHeapType::First;
+        heapResources[heapType].push_back(resourceIndex);
+    }
+
+    for(TransientHeapType heapType : enumerate<TransientHeapType>())
+    {
+        if(heapResources[heapType].empty()) { continue; }
+
+        planHeap(heapResources[heapType], heapType);
+    }
+
+    for(const TransientHeapDesc& heap : mHeaps)
+    {
+        mStats.aliasedByteSize += heap.byteSize;
+    }
+
+    std::stable_sort(mAliasingBarriers.begin(), mAliasingBarriers.end(),
+                     [](const TransientAliasingBarrier& left, const TransientAliasingBarrier& right) {
+                         return left.pass < right.pass;
+                     });
+}
+
+void TransientResourcePlanner::calculatePeakLiveByteSize()
+{
+    // +size at the first pass, -size after the last pass. Ends sort before starts at the same pass.
+    struct Event
+    {
+        uint32_t pass;
+        bool start;
+        uint64_t byteSize;
+    };
+
+    std::vector<Event> events;
+    events.reserve(mResources.size() * 2);
+
+    for(const Resource& resource : mResources)
+    {
+        const uint64_t alignedByteSize = AlignInteger(resource.byteSize, resource.alignment);
+        events.push_back(Event{resource.firstPass, true, alignedByteSize});
+        events.push_back(Event{resource.lastPass + 1, false, alignedByteSize});
+    }
+
+    std::sort(events.begin(), events.end(), [](const Event& left, const Event& right) {
+        if(left.pass != right.pass) { return left.pass < right.pass; }
+        return !left.start && right.start;
+    });
+
+    uint64_t liveByteSize = 0;
+    for(const Event& event : events)
+    {
+        if(event.start)
+        {
+            liveByteSize += event.byteSize;
+            mStats.peakLiveByteSize = std::max(mStats.peakLiveByteSize, liveByteSize);
+        }
+        else
+        {
+            liveByteSize -= event.byteSize;
+        }
+    }
+}
+
+void TransientResourcePlanner::planHeap(std::span<const uint32_t> resourceIndices, TransientHeapType heapType)
+{
+    const uint32_t heapIndex = (uint32_t)mHeaps.size();
+    TransientHeapDesc& heap = mHeaps.emplace_back();
+    heap.type = heapType;
+
+    mFreeRanges.clear();
+    mOccupants.clear();
+
+    // Interval coloring order. Larger resources go first among the ones that start together, since they are the
+    // hardest to fit later.
+    std::vector<uint32_t> sortedResources(resourceIndices.begin(), resourceIndices.end());
+    std::sort(sortedResources.begin(), sortedResources.end(), [this](uint32_t left, uint32_t right) {
+        const Resource& leftResource = mResources[left];
+        const Resource& rightResource = mResources[right];
+
+        if(leftResource.firstPass != rightResource.firstPass)
+        {
+            return leftResource.firstPass < rightResource.firstPass;
+        }
+        if(leftResource.byteSize != rightResource.byteSize) { return leftResource.byteSize > rightResource.byteSize; }
+        return left < right;
+    });
+
+    // Resources that currently own memory, in the order they were placed
+    std::vector<uint32_t> liveResources;
+
+    for(uint32_t resourceIndex : sortedResources)
+    {
+        const Resource& resource = mResources[resourceIndex];
+
+        // Return the memory of everything that finished before this resource starts
+        auto liveEnd = std::remove_if(liveResources.begin(), liveResources.end(), [&](uint32_t liveIndex) {
+            if(mResources[liveIndex].lastPass >= resource.firstPass) { return false; }
+
+            const TransientResourcePlacement& placement = mPlacements[liveIndex];
+            releaseRange(MemoryRange{placement.offset, placement.byteSize});
+            return true;
+        });
+        liveResources.erase(liveEnd, liveResources.end());
+
+        const uint64_t alignedByteSize = AlignInteger(resource.byteSize, resource.alignment);
+
+        // Best fit among the free ranges
+        std::optional<MemoryRange> bestRange;
+        for(const MemoryRange& freeRange : mFreeRanges)
+        {
+            const uint64_t alignedOffset = AlignInteger(freeRange.offset, resource.alignment);
+            if(alignedOffset + alignedByteSize > freeRange.end()) { continue; }
+
+            if(!bestRange || freeRange.byteSize < bestRange->byteSize) { bestRange = freeRange; }
+        }
+
+        uint64_t offset = 0;
+        if(bestRange)
+        {
+            offset = AlignInteger(bestRange->offset, resource.alignment);
+        }
+        else
+        {
+            // Grow the heap. A free range at the end of the heap can be extended instead of starting past it.
+            offset = heap.byteSize;
+            if(!mFreeRanges.empty() && mFreeRanges.back().end() == heap.byteSize)
+            {
+                offset = mFreeRanges.back().offset;
+            }
+
+            offset = AlignInteger(offset, resource.alignment);
+
+            // Padding between the old end of the heap and the aligned offset can still be used by other resources
+            if(offset > heap.byteSize) { releaseRange(MemoryRange{heap.byteSize, offset - heap.byteSize}); }
+
+            heap.byteSize = std::max(heap.byteSize, offset + alignedByteSize);
+        }
+
+        const MemoryRange range{offset, alignedByteSize};
+        claimRange(range);
+        occupyRange(range, resourceIndex);
+
+        mPlacements[resourceIndex] = TransientResourcePlacement{heapIndex, offset, alignedByteSize};
+        heap.alignment = std::max(heap.alignment, resource.alignment);
+        liveResources.push_back(resourceIndex);
+    }
+}
+
+void TransientResourcePlanner::releaseRange(MemoryRange range)
+{
+    auto itr = std::lower_bound(
+        mFreeRanges.begin(), mFreeRanges.end(), range.offset,
+        [](const MemoryRange& freeRange, uint64_t offset) { return freeRange.offset < offset; });
+
+    itr = mFreeRanges.insert(itr, range);
+
+    // Merge with the next range, then the previous one
+    if(auto next = itr + 1; next != mFreeRanges.end() && itr->end() == next->offset)
+    {
+        itr->byteSize += next->byteSize;
+        mFreeRanges.erase(next);
+    }
+
+    if(itr != mFreeRanges.begin())
+    {
+        auto previous = itr - 1;
+        if(previous->end() == itr->offset)
+        {
+            previous->byteSize += itr->byteSize;
+            mFreeRanges.erase(itr);
+        }
+    }
+}
+
+void TransientResourcePlanner::claimRange(MemoryRange range)
+{
+    // The range is either inside a single free range or at least partially past the current end of the heap, in which
+    // case it can only overlap the last free range.
+    for(auto itr = mFreeRanges.begin(); itr != mFreeRanges.end(); ++itr)
+    {
+        if(range.offset >= itr->end() || range.end() <= itr->offset) { continue; }
+
+        const MemoryRange before{itr->offset, range.offset - itr->offset};
+        const MemoryRange after{range.end(), (itr->end() > range.end()) ? itr->end() - range.end() : 0};
+
+        itr = mFreeRanges.erase(itr);
+        if(after.byteSize > 0) { itr = mFreeRanges.insert(itr, after); }
+        if(before.byteSize > 0) { mFreeRanges.insert(itr, before); }
+        return;
+    }
+}
+
+void TransientResourcePlanner::occupyRange(MemoryRange range, uint32_t resourceIndex)
+{
+    std::vector<Occupant> occupants;
+    occupants.reserve(mOccupants.size() + 2);
+
+    for(const Occupant& occupant : mOccupants)
+    {
+        if(occupant.range.end() <= range.offset || occupant.range.offset >= range.end())
+        {
+            occupants.push_back(occupant);
+            continue;
+        }
+
+        // Only one barrier per previous resource, even if it is split up into multiple occupied ranges. The barriers
+        // for this resource are the last ones added.
+        bool hasBarrier = false;
+        for(auto itr = mAliasingBarriers.crbegin(); itr != mAliasingBarriers.crend(); ++itr)
+        {
+            if(itr->resourceAfter != resourceIndex) { break; }
+            if(itr->resourceBefore == occupant.resourceIndex)
+            {
+                hasBarrier = true;
+                break;
+            }
+        }
+
+        if(!hasBarrier)
+        {
+            mAliasingBarriers.push_back(
+                TransientAliasingBarrier{mResources[resourceIndex].firstPass, occupant.resourceIndex, resourceIndex});
+        }
+
+        // Keep the parts of the old occupant that the new resource doesn't cover
+        if(occupant.range.offset < range.offset)
+        {
+            const MemoryRange remainingRange{occupant.range.offset, range.offset - occupant.range.offset};
+            occupants.push_back(Occupant{remainingRange, occupant.resourceIndex});
+        }
+
+        if(occupant.range.end() > range.end())
+        {
+            const MemoryRange remainingRange{range.end(), occupant.range.end() - range.end()};
+            occupants.push_back(Occupant{remainingRange, occupant.resourceIndex});
+        }
+    }
+
+    occupants.push_back(Occupant{range, resourceIndex});
+
+    std::sort(occupants.begin(), occupants.end(),
+              [](const Occupant& left, const Occupant& right) { return left.range.offset < right.range.offset; });
+
+    mOccupants = std::move(occupants);
+}
+} // namespace scrap
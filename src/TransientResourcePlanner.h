@@ -0,0 +1,175 @@
+// Classes:
+//   TransientResourcePlanner
+//
+// TransientResourcePlanner:
+//   Packs resources that only live for part of a frame into shared heaps. Each resource is requested with its size,
+//   alignment, heap type and the range of passes it is used in. Resources whose pass ranges don't overlap can share
+//   memory.
+//
+//   The planner walks the resources in order of their first pass, which is the greedy interval coloring order. Memory
+//   of resources whose last pass is behind the current one goes back to a free list, and each resource takes the free
+//   range that wastes the least space (best fit). The heap only grows when nothing fits. Whenever a resource is placed
+//   over memory that another resource used earlier in the frame, an aliasing barrier is generated for the pass that
+//   first uses the new resource.
+//
+//   A resource placed over aliased memory has undefined contents. Render targets and depth stencil targets have to
+//   be cleared, discarded or fully copied to before their first use. If the heaps are reused across frames, the first
+//   resource placed in any range also needs an aliasing barrier with a null before resource.
+//
+//   Nothing in here touches the device. The sizes and alignments come from GetResourceAllocationInfo and the pass
+//   ranges can come from RenderGraph::getResourceLifetime.
+
+#pragma once
+
+#include "EnumArray.h"
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+// With resource heap tier 1, buffers, render target/depth stencil textures and all other textures can't share a heap
+enum class TransientHeapType
+{
+    Buffer,
+    Texture,
+    RenderTargetTexture,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+struct TransientResourceRequest
+{
+    std::string_view name;
+    uint64_t byteSize = 0;
+    uint64_t alignment = 0;
+    TransientHeapType heapType = TransientHeapType::Buffer;
+    uint32_t firstPass = 0;
+    uint32_t lastPass = 0;
+};
+
+struct TransientResourcePlacement
+{
+    uint32_t heapIndex = 0;
+    uint64_t offset = 0;
+    uint64_t byteSize = 0;
+};
+
+struct TransientHeapDesc
+{
+    TransientHeapType type = TransientHeapType::Buffer;
+    uint64_t byteSize = 0;
+    uint64_t alignment = 0;
+};
+
+// resourceBefore stops using the memory and resourceAfter starts using it at the start of pass
+struct TransientAliasingBarrier
+{
+    uint32_t pass = 0;
+    uint32_t resourceBefore = 0;
+    uint32_t resourceAfter = 0;
+};
+
+struct TransientMemoryStats
+{
+    // Every resource in its own allocation
+    uint64_t unaliasedByteSize = 0;
+
+    // Total size of the planned heaps
+    uint64_t aliasedByteSize = 0;
+
+    // Largest sum of resource sizes alive during a single pass. No plan can use less memory than this.
+    uint64_t peakLiveByteSize = 0;
+};
+
+class TransientResourcePlanner
+{
+public:
+    struct PlanOptions
+    {
+        // Disable for resource heap tier 2, where all resource types can share one heap
+        bool separateHeapTypes = true;
+    };
+
+    TransientResourcePlanner() = default;
+    TransientResourcePlanner(const TransientResourcePlanner&) = default;
+    TransientResourcePlanner(TransientResourcePlanner&&) = default;
+    ~TransientResourcePlanner() = default;
+
+    TransientResourcePlanner& operator=(const TransientResourcePlanner&) = default;
+    TransientResourcePlanner& operator=(TransientResourcePlanner&&) = default;
+
+    // Removes all requests. Keeps the allocated memory so the planner can be reused every frame.
+    void reset();
+
+    // Returns the index used for the resource in the placements and aliasing barriers
+    uint32_t addResource(const TransientResourceRequest& request);
+
+    void plan(const PlanOptions& options);
+    void plan() { plan(PlanOptions{}); }
+
+    [[nodiscard]] uint32_t getResourceCount() const { return (uint32_t)mResources.size(); }
+    [[nodiscard]] std::string_view getResourceName(uint32_t resourceIndex) const
+    {
+        return mResources[resourceIndex].name;
+    }
+
+    // Indexed by resource index. Only valid after plan.
+    [[nodiscard]] std::span<const TransientResourcePlacement> getPlacements() const { return mPlacements; }
+    [[nodiscard]] std::span<const TransientHeapDesc> getHeaps() const { return mHeaps; }
+
+    // Sorted by pass
+    [[nodiscard]] std::span<const TransientAliasingBarrier> getAliasingBarriers() const { return mAliasingBarriers; }
+
+    [[nodiscard]] const TransientMemoryStats& getStats() const { return mStats; }
+
+private:
+    struct Resource
+    {
+        std::string name;
+        uint64_t byteSize = 0;
+        uint64_t alignment = 0;
+        TransientHeapType heapType = TransientHeapType::Buffer;
+        uint32_t firstPass = 0;
+        uint32_t lastPass = 0;
+    };
+
+    struct MemoryRange
+    {
+        uint64_t offset = 0;
+        uint64_t byteSize = 0;
+
+        [[nodiscard]] uint64_t end() const { return offset + byteSize; }
+    };
+
+    // The resource that used a range of heap memory most recently
+    struct Occupant
+    {
+        MemoryRange range;
+        uint32_t resourceIndex = 0;
+    };
+
+    void calculatePeakLiveByteSize();
+    void planHeap(std::span<const uint32_t> resourceIndices, TransientHeapType heapType);
+
+    void releaseRange(MemoryRange range);
+    void claimRange(MemoryRange range);
+    void occupyRange(MemoryRange range, uint32_t resourceIndex);
+
+    std::vector<Resource> mResources;
+
+    std::vector<TransientResourcePlacement> mPlacements;
+    std::vector<TransientHeapDesc> mHeaps;
+    std::vector<TransientAliasingBarrier> mAliasingBarriers;
+    TransientMemoryStats mStats;
+
+    // Scratch state for the heap currently being planned. Sorted by offset.
+    std::vector<MemoryRange> mFreeRanges;
+    std::vector<Occupant> mOccupants;
+};
+} // namespace scrap
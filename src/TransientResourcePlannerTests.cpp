@@ -0,0 +1,216 @@
+#include "TransientResourcePlanner.h"
+#include "UnitTest.h"
+
+#include <random>
+#include <span>
+#include <vector>
+
+namespace scrap
+{
+namespace
+{
+constexpr uint64_t kAlignment = 64 * 1024;
+
+bool LifetimesOverlap(const TransientResourceRequest& left, const TransientResourceRequest& right)
+{
+    return left.firstPass <= right.lastPass && right.firstPass <= left.lastPass;
+}
+
+bool PlacementsOverlap(const TransientResourcePlacement& left, const TransientResourcePlacement& right)
+{
+    return left.heapIndex == right.heapIndex && left.offset < right.offset + right.byteSize &&
+           right.offset < left.offset + left.byteSize;
+}
+
+// Resources of up to 4 MiB that live for up to 8 of 64 passes, with a mix of heap types and alignments
+std::vector<TransientResourceRequest> MakeRandomRequests(uint32_t resourceCount, uint32_t seed)
+{
+    std::mt19937 randomEngine(seed);
+    std::uniform_int_distribution<uint64_t> sizeDistribution(1, 4 * 1024 * 1024);
+    std::uniform_int_distribution<uint32_t> firstPassDistribution(0, 63);
+    std::uniform_int_distribution<uint32_t> passCountDistribution(0, 7);
+    std::uniform_int_distribution<uint32_t> heapTypeDistribution(0, (uint32_t)TransientHeapType::Count - 1);
+    std::uniform_int_distribution<uint32_t> alignmentDistribution(0, 2);
+
+    std::vector<TransientResourceRequest> requests(resourceCount);
+    for(TransientResourceRequest& request : requests)
+    {
+        request.byteSize = sizeDistribution(randomEngine);
+        request.alignment = uint64_t(256) << (alignmentDistribution(randomEngine) * 4);
+        request.heapType = (TransientHeapType)heapTypeDistribution(randomEngine);
+        request.firstPass = firstPassDistribution(randomEngine);
+        request.lastPass = request.firstPass + passCountDistribution(randomEngine);
+    }
+
+    return requests;
+}
+
+void AddRequests(TransientResourcePlanner& planner, std::span<const TransientResourceRequest> requests)
+{
+    for(const TransientResourceRequest& request : requests)
+    {
+        planner.addResource(request);
+    }
+}
+} // namespace
+
+SCRAP_TEST(TransientResourcePlanner, SharesMemoryBetweenDisjointLifetimes)
+{
+    TransientResourcePlanner planner;
+    const uint32_t first = planner.addResource(
+        TransientResourceRequest{.name = "First", .byteSize = kAlignment, .alignment = kAlignment, .lastPass = 1});
+    const uint32_t second = planner.addResource(TransientResourceRequest{
+        .name = "Second", .byteSize = kAlignment, .alignment = kAlignment, .firstPass = 2, .lastPass = 3});
+    planner.plan();
+
+    const std::span<const TransientResourcePlacement> placements = planner.getPlacements();
+    SCRAP_REQUIRE(placements.size() == 2);
+    SCRAP_CHECK(planner.getHeaps().size() == 1);
+    SCRAP_CHECK(placements[first].heapIndex == placements[second].heapIndex);
+    SCRAP_CHECK(placements[first].offset == placements[second].offset);
+    SCRAP_CHECK(planner.getStats().unaliasedByteSize == 2 * kAlignment);
+    SCRAP_CHECK(planner.getStats().aliasedByteSize == kAlignment);
+    SCRAP_CHECK(planner.getStats().peakLiveByteSize == kAlignment);
+}
+
+SCRAP_TEST(TransientResourcePlanner, NeverAliasesOverlappingLifetimes)
+{
+    const std::vector<TransientResourceRequest> requests = MakeRandomRequests(256, 7);
+
+    TransientResourcePlanner planner;
+    AddRequests(planner, requests);
+    planner.plan();
+
+    const std::span<const TransientResourcePlacement> placements = planner.getPlacements();
+    SCRAP_REQUIRE(placements.size() == requests.size());
+
+    uint32_t overlapCount = 0;
+    for(size_t left = 0; left < requests.size(); ++left)
+    {
+        SCRAP_CHECK(placements[left].offset % requests[left].alignment == 0);
+        SCRAP_CHECK(placements[left].offset + placements[left].byteSize <=
+                    planner.getHeaps()[placements[left].heapIndex].byteSize);
+
+        for(size_t right = left + 1; right < requests.size(); ++right)
+        {
+            if(!LifetimesOverlap(requests[left], requests[right])) { continue; }
+            if(PlacementsOverlap(placements[left], placements[right])) { ++overlapCount; }
+        }
+    }
+
+    SCRAP_CHECK(overlapCount == 0);
+}
+
+SCRAP_TEST(TransientResourcePlanner, EmitsAliasingBarrierAtEachHandover)
+{
+    TransientResourcePlanner planner;
+    const uint32_t first = planner.addResource(
+        TransientResourceRequest{.name = "First", .byteSize = kAlignment, .alignment = kAlignment, .lastPass = 0});
+    const uint32_t second = planner.addResource(TransientResourceRequest{
+        .name = "Second", .byteSize = kAlignment, .alignment = kAlignment, .firstPass = 1, .lastPass = 2});
+    const uint32_t third = planner.addResource(TransientResourceRequest{
+        .name = "Third", .byteSize = kAlignment, .alignment = kAlignment, .firstPass = 4, .lastPass = 4});
+    planner.plan();
+
+    const std::span<const TransientAliasingBarrier> barriers = planner.getAliasingBarriers();
+    SCRAP_REQUIRE(barriers.size() == 2);
+    SCRAP_CHECK(barriers[0].pass == 1);
+    SCRAP_CHECK(barriers[0].resourceBefore == first);
+    SCRAP_CHECK(barriers[0].resourceAfter == second);
+    SCRAP_CHECK(barriers[1].pass == 4);
+    SCRAP_CHECK(barriers[1].resourceBefore == second);
+    SCRAP_CHECK(barriers[1].resourceAfter == third);
+}
+
+SCRAP_TEST(TransientResourcePlanner, BarriersCoverEveryAliasedPlacement)
+{
+    const std::vector<TransientResourceRequest> requests = MakeRandomRequests(128, 11);
+
+    TransientResourcePlanner planner;
+    AddRequests(planner, requests);
+    planner.plan();
+
+    const std::span<const TransientResourcePlacement> placements = planner.getPlacements();
+    const std::span<const TransientAliasingBarrier> barriers = planner.getAliasingBarriers();
+    SCRAP_CHECK(!barriers.empty());
+
+    for(size_t barrierIndex = 0; barrierIndex < barriers.size(); ++barrierIndex)
+    {
+        const TransientAliasingBarrier& barrier = barriers[barrierIndex];
+        const TransientResourceRequest& before = requests[barrier.resourceBefore];
+        const TransientResourceRequest& after = requests[barrier.resourceAfter];
+
+        // The barrier hands memory over at the first pass of the new resource, after the old one is done with it
+        SCRAP_CHECK(barrier.pass == after.firstPass);
+        SCRAP_CHECK(before.lastPass < after.firstPass);
+        SCRAP_CHECK(PlacementsOverlap(placements[barrier.resourceBefore], placements[barrier.resourceAfter]));
+        if(barrierIndex > 0) { SCRAP_CHECK(barriers[barrierIndex - 1].pass <= barrier.pass); }
+    }
+
+    // Every resource placed over memory an earlier resource used has a barrier from one of them
+    for(uint32_t resourceIndex = 0; resourceIndex < (uint32_t)requests.size(); ++resourceIndex)
+    {
+        bool reusesMemory = false;
+        for(uint32_t otherIndex = 0; otherIndex < (uint32_t)requests.size(); ++otherIndex)
+        {
+            if(requests[otherIndex].lastPass < requests[resourceIndex].firstPass &&
+               PlacementsOverlap(placements[otherIndex], placements[resourceIndex]))
+            {
+                reusesMemory = true;
+                break;
+            }
+        }
+
+        bool hasBarrier = false;
+        for(const TransientAliasingBarrier& barrier : barriers)
+        {
+            if(barrier.resourceAfter == resourceIndex) { hasBarrier = true; }
+        }
+
+        SCRAP_CHECK(reusesMemory == hasBarrier);
+    }
+}
+
+SCRAP_TEST(TransientResourcePlanner, AliasedSizeIsBetweenPeakAndUnaliased)
+{
+    for(uint32_t seed = 1; seed <= 8; ++seed)
+    {
+        const std::vector<TransientResourceRequest> requests = MakeRandomRequests(64 * seed, seed);
+
+        TransientResourcePlanner planner;
+        AddRequests(planner, requests);
+        planner.plan(TransientResourcePlanner::PlanOptions{.separateHeapTypes = false});
+
+        const TransientMemoryStats& stats = planner.getStats();
+        SCRAP_CHECK(stats.aliasedByteSize <= stats.unaliasedByteSize);
+        SCRAP_CHECK(stats.aliasedByteSize >= stats.peakLiveByteSize);
+    }
+}
+
+SCRAP_TEST(TransientResourcePlanner, SeparatesHeapTypes)
+{
+    TransientResourcePlanner planner;
+    const uint32_t buffer = planner.addResource(TransientResourceRequest{.name = "Buffer",
+                                                                         .byteSize = kAlignment,
+                                                                         .alignment = kAlignment,
+                                                                         .heapType = TransientHeapType::Buffer,
+                                                                         .lastPass = 0});
+    const uint32_t texture = planner.addResource(TransientResourceRequest{.name = "Texture",
+                                                                          .byteSize = kAlignment,
+                                                                          .alignment = kAlignment,
+                                                                          .heapType = TransientHeapType::Texture,
+                                                                          .firstPass = 1,
+                                                                          .lastPass = 1});
+
+    planner.plan();
+    SCRAP_CHECK(planner.getHeaps().size() == 2);
+    SCRAP_CHECK(planner.getPlacements()[buffer].heapIndex != planner.getPlacements()[texture].heapIndex);
+    SCRAP_CHECK(planner.getAliasingBarriers().empty());
+
+    // Resource heap tier 2 puts everything in one heap, where the two can share memory
+    planner.plan(TransientResourcePlanner::PlanOptions{.separateHeapTypes = false});
+    SCRAP_CHECK(planner.getHeaps().size() == 1);
+    SCRAP_CHECK(planner.getPlacements()[buffer].offset == planner.getPlacements()[texture].offset);
+    SCRAP_CHECK(planner.getAliasingBarriers().size() == 1);
+}
+} // namespace scrap
@@ -0,0 +1,64 @@
+#include "UnitTest.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace scrap
+{
+namespace
+{
+// A function local static, so tests registered from other translation units don't depend on initialization order
+std::vector<UnitTest>& GetUnitTests()
+{
+    static std::vector<UnitTest> sUnitTests;
+    return sUnitTests;
+}
+} // namespace
+
+bool UnitTestContext::check(bool condition, std::string_view expression, std::string_view file, uint32_t line)
+{
+    if(condition) { return true; }
+
+    ++mFailureCount;
+    spdlog::error("{}: {}({}): check failed: {}", mTestName, file, line, expression);
+
+    return false;
+}
+
+UnitTestRegistrar::UnitTestRegistrar(std::string_view name, UnitTestFunction function)
+{
+    GetUnitTests().push_back(UnitTest{name, function});
+}
+
+UnitTestResults RunUnitTests(std::string_view filter)
+{
+    std::vector<UnitTest> unitTests = GetUnitTests();
+    std::sort(unitTests.begin(), unitTests.end(),
+              [](const UnitTest& left, const UnitTest& right) { return left.name < right.name; });
+
+    UnitTestResults results;
+
+    for(const UnitTest& unitTest : unitTests)
+    {
+        if(!filter.empty() && unitTest.name.find(filter) == std::string_view::npos) { continue; }
+
+        UnitTestContext context(unitTest.name);
+        unitTest.function(context);
+
+        ++results.testCount;
+        if(context.getFailureCount() > 0)
+        {
+            ++results.failedTestCount;
+            results.failedTestNames.emplace_back(unitTest.name);
+            spdlog::error("{} failed with {} failed checks", unitTest.name, context.getFailureCount());
+        }
+        else
+        {
+            spdlog::info("{} passed", unitTest.name);
+        }
+    }
+
+    return results;
+}
+} // namespace scrap
@@ -0,0 +1,73 @@
+// Classes:
+//   UnitTestContext
+//
+// A small unit test harness for the code that doesn't need a device. The tests are built into the UnitTests console
+// program, which runs every registered test and exits with 1 if any of them failed.
+//
+// SCRAP_TEST(Group, Name) defines a test and registers it as "Group/Name" before main runs. Inside a test,
+// SCRAP_CHECK(condition) records a failure and keeps going, SCRAP_REQUIRE(condition) records a failure and leaves the
+// test, for conditions the rest of the test can't run without.
+//
+// UnitTestContext:
+//   Collects the failures of the test that is running. Failures are logged with their file and line as they happen.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap
+{
+class UnitTestContext
+{
+public:
+    explicit UnitTestContext(std::string_view testName): mTestName(testName) {}
+
+    // Returns the condition
+    bool check(bool condition, std::string_view expression, std::string_view file, uint32_t line);
+
+    [[nodiscard]] std::string_view getTestName() const { return mTestName; }
+    [[nodiscard]] uint32_t getFailureCount() const { return mFailureCount; }
+
+private:
+    std::string_view mTestName;
+    uint32_t mFailureCount = 0;
+};
+
+using UnitTestFunction = void (*)(UnitTestContext& context);
+
+struct UnitTest
+{
+    std::string_view name;
+    UnitTestFunction function = nullptr;
+};
+
+// Registers the test in the global list. Only used by SCRAP_TEST.
+struct UnitTestRegistrar
+{
+    UnitTestRegistrar(std::string_view name, UnitTestFunction function);
+};
+
+struct UnitTestResults
+{
+    uint32_t testCount = 0;
+    uint32_t failedTestCount = 0;
+    std::vector<std::string> failedTestNames;
+};
+
+// Runs the registered tests whose name contains the filter, in name order. An empty filter runs all of them.
+[[nodiscard]] UnitTestResults RunUnitTests(std::string_view filter);
+} // namespace scrap
+
+#define SCRAP_TEST(group, name)                                                                      \
+    static void ScrapUnitTest_##group##_##name(scrap::UnitTestContext& scrapTestContext);           \
+    static const scrap::UnitTestRegistrar sScrapUnitTestRegistrar_##group##_##name(                 \
+        #group "/" #name, &ScrapUnitTest_##group##_##name);                                          \
+    static void ScrapUnitTest_##group##_##name(scrap::UnitTestContext& scrapTestContext)
+
+#define SCRAP_CHECK(condition) scrapTestContext.check((condition), #condition, __FILE__, __LINE__)
+
+#define SCRAP_REQUIRE(condition) \
+    if(!scrapTestContext.check((condition), #condition, __FILE__, __LINE__)) { return; }
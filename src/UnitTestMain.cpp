@@ -0,0 +1,72 @@
+// Entry point of the UnitTests console program. Runs the unit tests of the code that doesn't need a device.
+//
+// UnitTests [-filter <text>]
+//   -filter <text> only runs the tests whose name contains text, like RenderGraph/ or QueueScheduler/SameQueue.
+//
+// Exits with 1 if a test failed.
+
+#include "UnitTest.h"
+
+#include <array>
+#include <span>
+#include <string_view>
+
+#include <spdlog/sinks/msvc_sink.h>
+#include <spdlog/sinks/stdout_sinks.h>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+constexpr int kExitFailure = 1;
+
+// Returns the argument following args[index], if there is one
+std::string_view ParseOptionalValue(std::span<char*> args, size_t index)
+{
+    if(index + 1 >= args.size() || args[index + 1][0] == '-') { return {}; }
+    return args[index + 1];
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::shared_ptr<spdlog::logger> scrapLogger;
+    {
+        // setup a logger for the Visual Studio output window and for standard console out
+        std::array<spdlog::sink_ptr, 2> sinks;
+        sinks[0] = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+        sinks[1] = std::make_shared<spdlog::sinks::msvc_sink_mt>();
+
+        scrapLogger = std::make_shared<spdlog::logger>("scrap", std::begin(sinks), std::end(sinks));
+        spdlog::set_default_logger(scrapLogger);
+    }
+
+    std::string_view filter;
+    {
+        std::span<char*> args(argv, (size_t)argc);
+
+        for(size_t i = 1; i < args.size(); ++i)
+        {
+            const std::string_view arg = args[i];
+            if(arg == "-filter") { filter = ParseOptionalValue(args, i); }
+        }
+    }
+
+    const scrap::UnitTestResults results = scrap::RunUnitTests(filter);
+
+    if(results.failedTestCount > 0)
+    {
+        spdlog::error("{} of {} tests failed", results.failedTestCount, results.testCount);
+        for(const std::string& name : results.failedTestNames)
+        {
+            spdlog::error("    {}", name);
+        }
+    }
+    else
+    {
+        spdlog::info("All {} tests passed", results.testCount);
+    }
+
+    scrapLogger->flush();
+
+    return (results.failedTestCount > 0) ? kExitFailure : 0;
+}
@@ -1,5 +1,7 @@
 #include "Window.h"
 
+#include "AsyncLog.h"
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
 #include <spdlog/spdlog.h>
@@ -112,44 +114,48 @@ void Window::handleEvent(const SDL_WindowEvent& windowEvent)
 {
     switch(windowEvent.event)
     {
-    case SDL_WINDOWEVENT_SHOWN: spdlog::debug("SDL_WINDOWEVENT_SHOWN: window {}", windowEvent.windowID); break;
-    case SDL_WINDOWEVENT_HIDDEN: spdlog::debug("SDL_WINDOWEVENT_HIDDEN: window {}", windowEvent.windowID); break;
-    case SDL_WINDOWEVENT_EXPOSED: spdlog::debug("SDL_WINDOWEVENT_EXPOSED: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_SHOWN: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_SHOWN: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_HIDDEN: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_HIDDEN: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_EXPOSED: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_EXPOSED: window {}", windowEvent.windowID); break;
     case SDL_WINDOWEVENT_MOVED:
-        spdlog::debug("SDL_WINDOWEVENT_MOVED: window {} pos ({}, {})", windowEvent.windowID, windowEvent.data1,
-                      windowEvent.data2);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_MOVED: window {} pos ({}, {})", windowEvent.windowID, windowEvent.data1,
+                        windowEvent.data2);
         break;
     case SDL_WINDOWEVENT_RESIZED:
-        spdlog::debug("SDL_WINDOWEVENT_RESIZED: window {} size({}, {})", windowEvent.windowID, windowEvent.data1,
-                      windowEvent.data2);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_RESIZED: window {} size({}, {})", windowEvent.windowID, windowEvent.data1,
+                        windowEvent.data2);
         break;
     case SDL_WINDOWEVENT_SIZE_CHANGED:
-        spdlog::debug("SDL_WINDOWEVENT_SIZE_CHANGED: window {} size({}, {})", windowEvent.windowID, windowEvent.data1,
-                      windowEvent.data2);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_SIZE_CHANGED: window {} size({}, {})", windowEvent.windowID, windowEvent.data1,
+                        windowEvent.data2);
+        break;
+    case SDL_WINDOWEVENT_MINIMIZED:
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_MINIMIZED: window {}", windowEvent.windowID);
+        break;
+    case SDL_WINDOWEVENT_MAXIMIZED:
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_MAXIMIZED: window {}", windowEvent.windowID);
         break;
-    case SDL_WINDOWEVENT_MINIMIZED: spdlog::debug("SDL_WINDOWEVENT_MINIMIZED: window {}", windowEvent.windowID); break;
-    case SDL_WINDOWEVENT_MAXIMIZED: spdlog::debug("SDL_WINDOWEVENT_MAXIMIZED: window {}", windowEvent.windowID); break;
-    case SDL_WINDOWEVENT_RESTORED: spdlog::debug("SDL_WINDOWEVENT_RESTORED: window {}", windowEvent.windowID); break;
-    case SDL_WINDOWEVENT_ENTER: spdlog::debug("SDL_WINDOWEVENT_ENTER: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_RESTORED: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_RESTORED: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_ENTER: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_ENTER: window {}", windowEvent.windowID); break;
     case SDL_WINDOWEVENT_LEAVE:
-        spdlog::debug("SDL_WINDOWEVENT_LEAVE: window {}", windowEvent.windowID);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_LEAVE: window {}", windowEvent.windowID);
         mMouse.invalidatePosition();
         break;
     case SDL_WINDOWEVENT_FOCUS_GAINED:
-        spdlog::debug("SDL_WINDOWEVENT_FOCUS_GAINED: window {}", windowEvent.windowID);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_FOCUS_GAINED: window {}", windowEvent.windowID);
         break;
     case SDL_WINDOWEVENT_FOCUS_LOST:
-        spdlog::debug("SDL_WINDOWEVENT_FOCUS_LOST: window {}", windowEvent.windowID);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_FOCUS_LOST: window {}", windowEvent.windowID);
         mMouse.invalidatePosition();
         break;
-    case SDL_WINDOWEVENT_CLOSE: spdlog::debug("SDL_WINDOWEVENT_CLOSE: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_CLOSE: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_CLOSE: window {}", windowEvent.windowID); break;
     case SDL_WINDOWEVENT_TAKE_FOCUS:
-        spdlog::debug("SDL_WINDOWEVENT_TAKE_FOCUS: window {}", windowEvent.windowID);
+        SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_TAKE_FOCUS: window {}", windowEvent.windowID);
         break;
-    case SDL_WINDOWEVENT_HIT_TEST: spdlog::debug("SDL_WINDOWEVENT_HIT_TEST: window {}", windowEvent.windowID); break;
+    case SDL_WINDOWEVENT_HIT_TEST: SCRAP_LOG_DEBUG("SDL_WINDOWEVENT_HIT_TEST: window {}", windowEvent.windowID); break;
     default:
-        spdlog::debug("Unknown SDL_WindowEvent: event {}, window {}, data1 {}, data2 {}", windowEvent.event,
-                      windowEvent.windowID, windowEvent.windowID, windowEvent.data1, windowEvent.data2);
+        SCRAP_LOG_DEBUG("Unknown SDL_WindowEvent: event {}, window {}, data1 {}, data2 {}", windowEvent.event,
+                        windowEvent.windowID, windowEvent.data1, windowEvent.data2);
         break;
     }
 }
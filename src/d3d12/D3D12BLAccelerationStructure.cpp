@@ -1,5 +1,6 @@
 #include "D3D12BLAccelerationStructure.h"
 
+#include "MemoryTracker.h"
 #include "d3d12/D3D12Context.h"
 
 #include <d3dx12.h>
@@ -19,6 +20,8 @@ void BLAccelerationStructure::reserve(size_t count)
 
 void BLAccelerationStructure::addMesh(const BLAccelerationStructureGeometryParams& geometryParams)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     D3D12_RAYTRACING_GEOMETRY_FLAGS flags = D3D12_RAYTRACING_GEOMETRY_FLAG_NONE;
 
     if((RaytracingGeometryFlags::Transparent & geometryParams.flags) == RaytracingGeometryFlags::None)
@@ -57,8 +60,10 @@ void BLAccelerationStructure::addMesh(std::span<const BLAccelerationStructureGeo
     }
 }
 
-bool BLAccelerationStructure::build(const GraphicsCommandList& commandList)
+bool BLAccelerationStructure::build(GraphicsCommandList& commandList)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     mState = AccelerationStructureState::Building;
 
     ID3D12Device5* device = DeviceContext::instance().getDevice5();
@@ -83,6 +88,7 @@ bool BLAccelerationStructure::build(const GraphicsCommandList& commandList)
         scratchBufferParams.byteSize = prebuildInfo.ScratchDataSizeInBytes;
         scratchBufferParams.flags = BufferFlags::UavEnabled;
         scratchBufferParams.name = scratchBufferName;
+        scratchBufferParams.memoryCategory = GpuMemoryCategory::AccelerationStructure;
 
         mScratchBuffer.init(scratchBufferParams);
     }
@@ -103,6 +109,8 @@ bool BLAccelerationStructure::build(const GraphicsCommandList& commandList)
     buildDesc.DestAccelerationStructureData = mAccelerationStructure.getResource()->GetGPUVirtualAddress();
     buildDesc.ScratchAccelerationStructureData = mScratchBuffer.getResource()->GetGPUVirtualAddress();
 
+    // The build reads the vertex and index buffers, which can still have transitions pending from their upload
+    commandList.flushResourceBarriers();
     commandList.get4()->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
 
     mScratchBuffer.markAsUsed(commandList.get());
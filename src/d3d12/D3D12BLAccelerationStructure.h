@@ -36,7 +36,7 @@ public:
     void addMesh(const BLAccelerationStructureGeometryParams& geometryParams);
     void addMesh(std::span<const BLAccelerationStructureGeometryParams> geometries);
 
-    bool build(const GraphicsCommandList& commandList);
+    bool build(GraphicsCommandList& commandList);
 
     void markAsUsed(const GraphicsCommandList& commandList);
 
@@ -1,12 +1,18 @@
 #pragma once
 
+#include "CpuProfiler.h"
+#include "PerfCounters.h"
+#include "d3d12/D3D12CommandAllocatorPool.h"
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12Debug.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
 #include "d3d12/D3D12FrameCodes.h"
+#include "d3d12/D3D12FrameTelemetry.h"
 #include "d3d12/D3D12UploadBufferPool.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <span>
 #include <string>
@@ -31,10 +37,12 @@ public:
     virtual ~BaseCommandContext()
     {
         waitOnGpu();
+        mFenceCompletionTracker.stop();
         if(mFenceEvent != nullptr) { CloseHandle(mFenceEvent); }
     }
 
     UploadBufferPool& getUploadBufferPool() { return mUploadBufferPool; }
+    CommandAllocatorPool& getCommandAllocatorPool() { return mCommandAllocatorPool; }
 
     void queueObjectForDestruction(Microsoft::WRL::ComPtr<ID3D12DeviceChild> deviceChild, FrameCodeT lastUsedFrameCode)
     {
@@ -57,6 +65,7 @@ public:
 
         std::lock_guard lockGuard(mPendingFreeListMutex);
         mPendingFreeList.emplace_back(std::move(deviceChild), std::move(descriptors), lastUsedFrameCode);
+        mPendingFreeGauge.set((int64_t)mPendingFreeList.size());
     }
 
     void queueObjectForDestruction(Microsoft::WRL::ComPtr<ID3D12DeviceChild> deviceChild,
@@ -72,6 +81,8 @@ public:
         {
             if(itr->isValid()) { mPendingFreeList.emplace_back(nullptr, std::move(*itr), lastUsedFrameCode); }
         }
+
+        mPendingFreeGauge.set((int64_t)mPendingFreeList.size());
     }
 
     virtual void beginFrame()
@@ -90,12 +101,18 @@ public:
             return;
         }
 
+        mSignalTimes[mFrameIndex] = std::chrono::steady_clock::now();
+        mFenceCompletionTracker.addSignal(currentFenceValue);
+
         // Update the frame index.
-        mFrameIndex = (mFrameIndex + 1u) % kFrameBufferCount;
+        mFrameIndex = (mFrameIndex + 1u) % mFramesInFlight;
 
         // If the next frame is not ready to be rendered yet, wait until it is ready.
+        const std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
         if(mFence->GetCompletedValue() < *mFenceValues[mFrameIndex])
         {
+            SCRAP_CPU_ZONE("Wait for frame in flight");
+
             if(FAILED(mFence->SetEventOnCompletion(*mFenceValues[mFrameIndex], mFenceEvent)))
             {
                 spdlog::error("Fence SetEventOnCompletion call failed");
@@ -105,7 +122,12 @@ public:
             WaitForSingleObjectEx(mFenceEvent, INFINITE, FALSE);
         }
 
+        mLastFrameTiming.cpuWaitTime = std::chrono::steady_clock::now() - waitStart;
+        updateFrameTiming();
+
         mLastCompletedFrameCode = mFenceValues[mFrameIndex];
+        mCommandAllocatorPool.endFrame(*mLastCompletedFrameCode);
+        mUploadBufferPool.beginFrame(mFrameIndex);
 
         // Set the fence value for the next frame.
         mFenceValues[mFrameIndex] = currentFenceValue + 1;
@@ -117,6 +139,7 @@ public:
                                                       return resource.lastUsedFrameCode <= mLastCompletedFrameCode;
                                                   }),
                                    mPendingFreeList.end());
+            mPendingFreeGauge.set((int64_t)mPendingFreeList.size());
         }
 
         Debug::instance().endGpuEvent(mCommandQueue.Get());
@@ -126,6 +149,8 @@ public:
     {
         if(mFence == nullptr) { return; }
 
+        SCRAP_CPU_ZONE("BaseCommandContext::waitOnGpu");
+
         const uint64_t fenceValue = *mFenceValues[mFrameIndex];
 
         // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12commandqueue-signal
@@ -145,12 +170,33 @@ public:
     }
 
     ID3D12CommandQueue* getCommandQueue() const { return mCommandQueue.Get(); }
+    uint32_t getFramesInFlight() const { return mFramesInFlight; }
     FrameCodeT getCurrentFrameCode() const { return mFenceValues[mFrameIndex]; }
+    uint32_t getFrameIndex() const { return mFrameIndex; }
     FrameCodeT getLastCompletedFrameCode() const { return mLastCompletedFrameCode; }
 
+    // Fence used to synchronize with other queues in the middle of a frame. It's separate from the frame fence so a
+    // signal doesn't mark the whole frame as completed.
+    ID3D12Fence* getSyncFence() const { return mSyncFence.Get(); }
+
+    // Reserves count consecutive sync fence values and returns the value before the first one. Reserved values have to
+    // be signaled on the queue in order.
+    uint64_t reserveSyncValues(uint64_t count)
+    {
+        const uint64_t baseValue = mLastSyncValue;
+        mLastSyncValue += count;
+        return baseValue;
+    }
+
+    // Timing of the frame endFrame last waited for. The cpu wait is for the endFrame call itself.
+    const CommandContextFrameTiming& getLastFrameTiming() const { return mLastFrameTiming; }
+
 protected:
-    HRESULT initInternal(ID3D12Device* device)
+    HRESULT initInternal(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE commandListType, uint32_t framesInFlight)
     {
+        mFramesInFlight = std::clamp(framesInFlight, kMinFramesInFlight, kMaxFramesInFlight);
+        mCommandAllocatorPool.init(device, commandListType, mDebugName);
+
         // Create synchronization objects and wait until assets have been uploaded to the GPU.
         HRESULT hr = device->CreateFence(*mFenceValues[mFrameIndex], D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence));
         if(FAILED(hr))
@@ -161,6 +207,15 @@ protected:
 
         ++mFenceValues[mFrameIndex];
 
+        mFenceCompletionTracker.init(mFence);
+
+        hr = device->CreateFence(mLastSyncValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mSyncFence));
+        if(FAILED(hr))
+        {
+            spdlog::error("Failed to create sync fence for command context");
+            return hr;
+        }
+
         // Create an event handle to use for frame synchronization.
         // https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createeventw
         mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
@@ -174,15 +229,47 @@ protected:
         return S_OK;
     }
 
+    // The frame in the slot endFrame just waited for has completed. Fence values go up by one per frame, so the frame
+    // before it was signaled with the previous value.
+    void updateFrameTiming()
+    {
+        const uint64_t fenceValue = *mFenceValues[mFrameIndex];
+        const std::chrono::steady_clock::time_point signalTime = mSignalTimes[mFrameIndex];
+
+        // Slots that haven't been used yet
+        if(signalTime == std::chrono::steady_clock::time_point{}) { return; }
+
+        // The tracker's worker may not have woken up yet if the fence only just completed
+        const std::chrono::steady_clock::time_point completionTime =
+            mFenceCompletionTracker.getCompletionTime(fenceValue).value_or(std::chrono::steady_clock::now());
+        mLastFrameTiming.signalToCompleteTime = std::max(std::chrono::nanoseconds(0), completionTime - signalTime);
+
+        mLastFrameTiming.gpuIdleTime = std::chrono::nanoseconds(0);
+        if(auto previousCompletionTime = mFenceCompletionTracker.getCompletionTime(fenceValue - 1);
+           previousCompletionTime.has_value() && *previousCompletionTime < signalTime)
+        {
+            mLastFrameTiming.gpuIdleTime = signalTime - *previousCompletionTime;
+        }
+    }
+
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
 
     uint32_t mFrameIndex = 0;
+    uint32_t mFramesInFlight = kDefaultFramesInFlight;
     Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
-    std::array<FrameCodeT, kFrameBufferCount> mFenceValues;
+    std::array<FrameCodeT, kMaxFramesInFlight> mFenceValues;
     HANDLE mFenceEvent = nullptr;
 
+    // When each frame slot's fence value was last signaled
+    std::array<std::chrono::steady_clock::time_point, kMaxFramesInFlight> mSignalTimes{};
+    FenceCompletionTracker mFenceCompletionTracker;
+    CommandContextFrameTiming mLastFrameTiming;
+
     FrameCodeT mLastCompletedFrameCode;
 
+    Microsoft::WRL::ComPtr<ID3D12Fence> mSyncFence;
+    uint64_t mLastSyncValue = 0;
+
     std::string mDebugName;
 
     struct PendingFreeObject
@@ -209,7 +296,9 @@ protected:
 
     std::mutex mPendingFreeListMutex;
     std::vector<PendingFreeObject> mPendingFreeList;
+    PerfGaugeContribution mPendingFreeGauge{PerfGauge::PendingFreeObjects};
 
     UploadBufferPool mUploadBufferPool;
+    CommandAllocatorPool mCommandAllocatorPool;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
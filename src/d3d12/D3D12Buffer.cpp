@@ -1,5 +1,6 @@
 #include "d3d12/D3D12Buffer.h"
 
+#include "MemoryTracker.h"
 #include "Utility.h"
 #include "d3d12/D3D12Context.h"
 
@@ -104,16 +105,10 @@ void Buffer::unmap(ID3D12GraphicsCommandList* commandList)
     mUploadResource.markAsUsed(commandList);
 }
 
-void Buffer::transition(ID3D12GraphicsCommandList* commandList,
-                        D3D12_RESOURCE_STATES before,
-                        D3D12_RESOURCE_STATES after)
-{
-    const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mResource.getResource(), before, after);
-    commandList->ResourceBarrier(1, &barrier);
-}
-
 std::optional<BufferError> Buffer::initInternal(Params params, std::span<const std::byte> buffer)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     assert(!mInitialized);
 
     DeviceContext& deviceContext = DeviceContext::instance();
@@ -232,9 +227,15 @@ std::optional<BufferError> Buffer::initInternal(Params params, std::span<const s
 
         if(FAILED(hr)) { return BufferError::FailedToCreateGpuResource; }
 
+        deviceContext.getCommandCapture().addResource(resource.Get(), initialResourceState);
         mResource = TrackedShaderResource(std::move(resource));
     }
 
+    mMemoryAllocation = deviceContext.getGpuMemoryRegistry().add(
+        {allocInfo.SizeInBytes, GpuHeapType::Default,
+         isAccelerationStructure ? GpuMemoryCategory::AccelerationStructure : params.memoryCategory,
+         std::string(params.name)});
+
     std::wstring wideName;
     int wideStrSize = MultiByteToWideChar(CP_UTF8, 0u, params.name.data(), (int)params.name.size(), nullptr, 0);
     wideName.reserve(wideStrSize + sizeof(" (Upload)"));
@@ -279,9 +280,13 @@ std::optional<BufferError> Buffer::initInternal(Params params, std::span<const s
             return BufferError::FailedToCreateUploadResource;
         }
 
+        deviceContext.getCommandCapture().addResource(uploadResource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
         mUploadResource = TrackedGpuObject(std::move(uploadResource));
     }
 
+    mUploadMemoryAllocation = deviceContext.getGpuMemoryRegistry().add(
+        {allocInfo.SizeInBytes, GpuHeapType::Upload, GpuMemoryCategory::Staging, std::string(params.name)});
+
     wideName.append(L" (Upload)");
     mUploadResource->SetName(wideName.c_str());
 
@@ -292,6 +297,8 @@ std::optional<BufferError> Buffer::initInternal(Params params, std::span<const s
     //============================================
     if(!buffer.empty())
     {
+        std::unique_lock copyLock = deviceContext.getCopyContext().lockCommandList();
+
         D3D12_SUBRESOURCE_DATA subresourceData = {};
         subresourceData.pData = buffer.data();
         subresourceData.RowPitch = buffer.size_bytes();
@@ -318,6 +325,10 @@ std::optional<BufferError> Buffer::initInternal(Params params, std::span<const s
         mInitFrameCode = deviceContext.getCopyContext().getCurrentFrameCode();
     }
 
+    // Command lists resolve their first use of the buffer against this state when they are submitted
+    mGlobalResourceState = std::make_shared<GlobalResourceState>(mResource.getResource(), 1,
+                                                                 buffer.empty() ? initialResourceState : postCopyState);
+
     if((params.accessFlags & ResourceAccessFlags::CpuWrite) != ResourceAccessFlags::CpuWrite)
     {
         // The upload buffer was only needed to initialize the resource and will not be used again.
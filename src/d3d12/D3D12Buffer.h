@@ -1,10 +1,13 @@
 #pragma once
 
+#include "GpuMemoryRegistry.h"
 #include "RenderDefs.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
 #include "d3d12/D3D12TrackedGpuObject.h"
 #include "d3d12/D3D12GpuWriteGuard.h"
+#include "d3d12/D3D12ResourceStateTracker.h"
 
+#include <memory>
 #include <optional>
 #include <span>
 
@@ -35,6 +38,8 @@ struct BufferCommonParams
     BufferFlags flags = BufferFlags::None;
     std::optional<D3D12_RESOURCE_STATES> initialResourceState;
     std::string_view name;
+    // What the buffer's memory is accounted as. Acceleration structure buffers are always AccelerationStructure.
+    GpuMemoryCategory memoryCategory = GpuMemoryCategory::Buffer;
 };
 
 struct BufferElementParams
@@ -96,6 +101,9 @@ public:
 
     ID3D12Resource* getResource() const { return mResource.getResource(); }
 
+    // Buffers only have one subresource. Transition them with GraphicsCommandList::transitionResource.
+    const std::shared_ptr<GlobalResourceState>& getGlobalResourceState() const { return mGlobalResourceState; }
+
     D3D12_CPU_DESCRIPTOR_HANDLE getSrvCpu() const;
     D3D12_GPU_DESCRIPTOR_HANDLE getSrvGpu() const;
     D3D12_CPU_DESCRIPTOR_HANDLE getUavCpu() const;
@@ -137,10 +145,10 @@ public:
         return std::span<T>(reinterpret_cast<T*>(buffer.data()), buffer.size_bytes() / sizeof(T));
     }
 
+    // Copies the upload buffer to the buffer. The buffer has to be in D3D12_RESOURCE_STATE_COPY_DEST with every queued
+    // barrier flushed.
     void unmap(ID3D12GraphicsCommandList* commandList);
 
-    void transition(ID3D12GraphicsCommandList* commandList, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
-
 private:
     enum class Type
     {
@@ -186,6 +194,9 @@ private:
     Params mParams;
     TrackedShaderResource mResource;
     TrackedGpuObject<ID3D12Resource> mUploadResource;
+    GpuMemoryAllocation mMemoryAllocation;
+    GpuMemoryAllocation mUploadMemoryAllocation;
+    std::shared_ptr<GlobalResourceState> mGlobalResourceState;
     CopyFrameCode mInitFrameCode;
     uint32_t mSrvIndex = 0;
     uint32_t mUavIndex = 0;
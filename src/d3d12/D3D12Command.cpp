@@ -1,5 +1,7 @@
 #include "d3d12/D3D12Command.h"
 
+#include "PerfCounters.h"
+#include "ShaderBindingLayout.h"
 #include "d3d12/D3D12CommandList.h"
 #include "d3d12/D3D12Context.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
@@ -16,6 +18,21 @@
 
 namespace scrap::d3d12
 {
+namespace
+{
+uint64_t TriangleCount(PrimitiveTopology primitiveTopology, uint32_t indexCount)
+{
+    switch(primitiveTopology)
+    {
+    case PrimitiveTopology::TriangleList: return indexCount / 3;
+    case PrimitiveTopology::TriangleStrip: return (indexCount >= 3) ? indexCount - 2 : 0;
+    case PrimitiveTopology::TriangleListAdj: return indexCount / 6;
+    case PrimitiveTopology::TriangleStripAdj: return (indexCount >= 6) ? (indexCount - 4) / 2 : 0;
+    default: return 0;
+    }
+}
+} // namespace
+
 void bindEngineConstantBuffers(d3d12::GraphicsCommandList& commandList,
                                const EngineConstantBuffers& engineConstantBuffers)
 {
@@ -39,27 +56,31 @@ std::optional<CommandError> drawIndexed(d3d12::GraphicsCommandList& commandList,
         if(!vertexBuffer.buffer->isReady()) { return CommandError::ResourcesNotReady; }
     }
 
-    const d3d12::GraphicsShader& shader = *params.pipelineState->getShader();
-
-    std::array<uint32_t, d3d12::kMaxBindlessVertexBuffers + 1> vertexBufferDescriptorIndices;
+    const ShaderBindingLayout& bindingLayout = params.pipelineState->getShader()->getBindingLayout();
 
     for(const VertexBuffer& vertexBuffer : params.vertexBuffers)
     {
-        const uint32_t constantBufferIndex =
-            shader.getVertexElementIndex(vertexBuffer.semantic, vertexBuffer.semanticIndex)
-                .value_or(d3d12::kMaxBindlessVertexBuffers);
-
-        vertexBufferDescriptorIndices[constantBufferIndex] = vertexBuffer.buffer->getSrvDescriptorHeapIndex();
-
         vertexBuffer.buffer->markAsUsed(commandList.get());
     }
 
-    commandList.get()->SetGraphicsRoot32BitConstants(
-        d3d12::RasterRootParamSlot::VertexIndices,
-        std::min((uint32_t)params.vertexBuffers.size(), d3d12::kMaxBindlessVertexBuffers),
-        vertexBufferDescriptorIndices.data(), 0);
-
-    commandList.commitBindlessResources();
+    // The bindings were resolved against the shader's binding layout ahead of time. All that's left is copying them
+    // into the root constants.
+    if(params.bindings != nullptr)
+    {
+        if(bindingLayout.getResourceSlotCount() > 0)
+        {
+            commandList.setGraphicsRoot32BitConstants(
+                d3d12::RasterRootParamSlot::ResourceIndices,
+                std::span(params.bindings->resourceIndices).first(bindingLayout.getResourceSlotCount()));
+        }
+
+        if(bindingLayout.getVertexElementSlotCount() > 0)
+        {
+            commandList.setGraphicsRoot32BitConstants(
+                d3d12::RasterRootParamSlot::VertexIndices,
+                std::span(params.bindings->vertexBufferIndices).first(bindingLayout.getVertexElementSlotCount()));
+        }
+    }
 
     params.indexBuffer->markAsUsed(commandList.get());
     params.pipelineState->markAsUsed(commandList.get());
@@ -67,12 +88,17 @@ std::optional<CommandError> drawIndexed(d3d12::GraphicsCommandList& commandList,
     const D3D_PRIMITIVE_TOPOLOGY primitiveTopology = d3d12::TranslatePrimitiveTopology(params.primitiveTopology);
     const D3D12_INDEX_BUFFER_VIEW ibv = params.indexBuffer->getIndexView();
 
-    commandList.get()->SetPipelineState(params.pipelineState->getPipelineState());
-    commandList.get()->IASetPrimitiveTopology(primitiveTopology);
-    commandList.get()->IASetIndexBuffer(&ibv);
+    commandList.setPipelineState(params.pipelineState->getPipelineState());
+    commandList.setPrimitiveTopology(primitiveTopology);
+    commandList.setIndexBuffer(ibv);
+    commandList.flushResourceBarriers();
     commandList.get()->DrawIndexedInstanced(params.indexCount, params.instanceCount, params.indexOffset,
                                             params.vertexOffset, params.instanceOffset);
 
+    PerfCounters::add(PerfCounter::DrawCalls);
+    PerfCounters::add(PerfCounter::TrianglesSubmitted,
+                      TriangleCount(params.primitiveTopology, params.indexCount) * params.instanceCount);
+
     return std::nullopt;
 }
 
@@ -94,7 +120,7 @@ std::optional<CommandError> dispatchRays(d3d12::GraphicsCommandList& commandList
 
     // Setup descriptor heaps for that bindless life
     std::array<ID3D12DescriptorHeap*, 1> descriptorHeaps = {d3d12Context.getCbvSrvUavHeap().getGpuDescriptorHeap()};
-    commandList.get()->SetDescriptorHeaps((uint32_t)descriptorHeaps.size(), descriptorHeaps.data());
+    commandList.setDescriptorHeaps(descriptorHeaps);
 
     // Texture UAVs (render targets)
     for(d3d12::Texture* rwTexture : params.rwTextures)
@@ -120,7 +146,7 @@ std::optional<CommandError> dispatchRays(d3d12::GraphicsCommandList& commandList
 
     // Pipeline state
     params.pipelineState->markAsUsed(commandList);
-    commandList.get4()->SetPipelineState1(params.pipelineState->getStateObject());
+    commandList.setPipelineState1(params.pipelineState->getStateObject());
 
     // Dispatch
     D3D12_DISPATCH_RAYS_DESC dispatchDesc = {};
@@ -133,8 +159,13 @@ std::optional<CommandError> dispatchRays(d3d12::GraphicsCommandList& commandList
 
     params.shaderTable->markAsUsed(commandList.get());
 
+    commandList.flushResourceBarriers();
     commandList.get4()->DispatchRays(&dispatchDesc);
 
+    PerfCounters::add(PerfCounter::RayDispatches);
+    PerfCounters::add(PerfCounter::RaysDispatched,
+                      (uint64_t)dispatchDesc.Width * dispatchDesc.Height * dispatchDesc.Depth);
+
     return std::nullopt;
 }
 } // namespace scrap::d3d12
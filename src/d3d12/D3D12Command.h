@@ -9,6 +9,11 @@
 #include <glm/ext/vector_uint3_sized.hpp>
 #include <glm/vec3.hpp>
 
+namespace scrap
+{
+struct ShaderBindingIndices;
+}
+
 namespace scrap::d3d12
 {
 class GpuMesh;
@@ -40,6 +45,7 @@ struct DrawIndexedParams
     d3d12::Buffer* indexBuffer = nullptr;
     d3d12::GraphicsPipelineState* pipelineState = nullptr;
     std::span<const VertexBuffer> vertexBuffers;
+    const ShaderBindingIndices* bindings = nullptr; // compiled against the pipeline state's shader binding layout
     PrimitiveTopology primitiveTopology = PrimitiveTopology::Undefined;
     uint32_t indexCount = 0;
     uint32_t instanceCount = 0;
@@ -0,0 +1,144 @@
+#include "d3d12/D3D12CommandAllocatorPool.h"
+
+#include <algorithm>
+
+#include <d3d12.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+void CommandAllocatorPool::init(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, std::string_view debugName)
+{
+    mDevice = device;
+    mCommandListType = type;
+
+    int wideStrSize = MultiByteToWideChar(CP_UTF8, 0u, debugName.data(), (int)debugName.size(), nullptr, 0);
+    mDebugName.resize(wideStrSize);
+    MultiByteToWideChar(CP_UTF8, 0u, debugName.data(), (int)debugName.size(), mDebugName.data(),
+                        (int)mDebugName.size());
+}
+
+ComPtr<ID3D12CommandAllocator> CommandAllocatorPool::acquire()
+{
+    ComPtr<ID3D12CommandAllocator> allocator;
+
+    {
+        std::lock_guard lockGuard(mMutex);
+
+        if(mCompletedAllocatorCount > 0)
+        {
+            allocator = std::move(mReleasedAllocators.front().allocator);
+            mReleasedAllocators.pop_front();
+            --mCompletedAllocatorCount;
+        }
+
+        mIdleAllocatorLowWater = std::min(mIdleAllocatorLowWater, mCompletedAllocatorCount);
+
+        if(allocator == nullptr) { return createAllocator(); }
+    }
+
+    // Command list allocators can only be reset when the associated command lists have finished execution on the GPU.
+    // The fence value the allocator was released with has already been reached.
+    if(FAILED(allocator->Reset()))
+    {
+        spdlog::error("Failed to reset d3d12 command allocator");
+
+        std::lock_guard lockGuard(mMutex);
+        --mAllocatorCount;
+        return createAllocator();
+    }
+
+    return allocator;
+}
+
+void CommandAllocatorPool::release(ComPtr<ID3D12CommandAllocator> allocator, uint64_t fenceValue)
+{
+    if(allocator == nullptr) { return; }
+
+    std::lock_guard lockGuard(mMutex);
+
+    if(fenceValue <= mCompletedFenceValue)
+    {
+        mReleasedAllocators.push_front(ReleasedAllocator{std::move(allocator), fenceValue});
+        ++mCompletedAllocatorCount;
+        return;
+    }
+
+    mReleasedAllocators.push_back(ReleasedAllocator{std::move(allocator), fenceValue});
+}
+
+void CommandAllocatorPool::endFrame(uint64_t completedFenceValue)
+{
+    std::lock_guard lockGuard(mMutex);
+
+    mCompletedFenceValue = std::max(mCompletedFenceValue, completedFenceValue);
+
+    // Allocators are released in fence order, so the completed ones are always at the front.
+    while(mCompletedAllocatorCount < mReleasedAllocators.size() &&
+          mReleasedAllocators[mCompletedAllocatorCount].fenceValue <= mCompletedFenceValue)
+    {
+        ++mCompletedAllocatorCount;
+    }
+
+    ++mFramesSinceTrim;
+    if(mFramesSinceTrim < mIdleFramesBeforeTrim) { return; }
+
+    trim(mIdleAllocatorLowWater);
+
+    mFramesSinceTrim = 0;
+    mIdleAllocatorLowWater = mCompletedAllocatorCount;
+}
+
+void CommandAllocatorPool::setIdleFramesBeforeTrim(uint32_t frameCount)
+{
+    std::lock_guard lockGuard(mMutex);
+    mIdleFramesBeforeTrim = std::max(frameCount, 1u);
+}
+
+uint32_t CommandAllocatorPool::getAllocatorCount() const
+{
+    std::lock_guard lockGuard(mMutex);
+    return mAllocatorCount;
+}
+
+uint32_t CommandAllocatorPool::getAvailableAllocatorCount() const
+{
+    std::lock_guard lockGuard(mMutex);
+    return mCompletedAllocatorCount;
+}
+
+ComPtr<ID3D12CommandAllocator> CommandAllocatorPool::createAllocator()
+{
+    // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12device-createcommandallocator
+    ComPtr<ID3D12CommandAllocator> allocator;
+    HRESULT hr = mDevice->CreateCommandAllocator(mCommandListType, IID_PPV_ARGS(&allocator));
+    if(FAILED(hr))
+    {
+        spdlog::critical("Failed to create d3d12 command allocator");
+        return nullptr;
+    }
+
+    const std::wstring debugName = fmt::format(L"{} allocator {}", mDebugName, mCreatedAllocatorCount);
+    allocator->SetName(debugName.c_str());
+
+    ++mCreatedAllocatorCount;
+    ++mAllocatorCount;
+
+    return allocator;
+}
+
+void CommandAllocatorPool::trim(uint32_t count)
+{
+    count = std::min(count, mCompletedAllocatorCount);
+    if(count == 0) { return; }
+
+    mReleasedAllocators.erase(mReleasedAllocators.begin(), mReleasedAllocators.begin() + count);
+    mCompletedAllocatorCount -= count;
+    mAllocatorCount -= count;
+
+    spdlog::debug("Trimmed {} idle command allocators. {} remaining", count, mAllocatorCount);
+}
+} // namespace scrap::d3d12
@@ -0,0 +1,87 @@
+// CommandAllocatorPool is a pool of command allocators shared by every command list of a single queue type. Command
+// lists acquire an allocator when they start recording and release it back to the pool with the fence value of the
+// submission that uses it. Released allocators are handed out again in FIFO order once the queue's fence has passed
+// that value, so an allocator is never reset while the gpu might still be reading from it.
+//
+// The pool keeps track of how many completed allocators sat unused over a window of frames. Once the window has gone by
+// without those allocators being needed, they are released, so a spike in recording doesn't hold on to allocator memory
+// forever.
+
+#pragma once
+
+#include "d3d12/D3D12Config.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+namespace scrap::d3d12
+{
+class CommandAllocatorPool
+{
+public:
+    CommandAllocatorPool() = default;
+    CommandAllocatorPool(const CommandAllocatorPool&) = delete;
+    CommandAllocatorPool(CommandAllocatorPool&&) = delete;
+    ~CommandAllocatorPool() = default;
+
+    CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
+    CommandAllocatorPool& operator=(CommandAllocatorPool&&) = delete;
+
+    void init(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, std::string_view debugName);
+
+    // Returns a reset allocator that the gpu is done with. A new allocator is created if the oldest released allocator
+    // is still in flight.
+    [[nodiscard]] Microsoft::WRL::ComPtr<ID3D12CommandAllocator> acquire();
+
+    // fenceValue is the value the queue signals once the commands recorded with the allocator have completed.
+    // Allocators that were never submitted can be released with a fence value of 0.
+    void release(Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator, uint64_t fenceValue);
+
+    // Called by the owning command context once per frame after the completed fence value has been updated.
+    void endFrame(uint64_t completedFenceValue);
+
+    void setIdleFramesBeforeTrim(uint32_t frameCount);
+    [[nodiscard]] uint32_t getIdleFramesBeforeTrim() const { return mIdleFramesBeforeTrim; }
+
+    // Allocators created by the pool that haven't been trimmed, including the ones currently acquired.
+    [[nodiscard]] uint32_t getAllocatorCount() const;
+    [[nodiscard]] uint32_t getAvailableAllocatorCount() const;
+
+private:
+    struct ReleasedAllocator
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        uint64_t fenceValue = 0;
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> createAllocator();
+    void trim(uint32_t count);
+
+    ID3D12Device* mDevice = nullptr;
+    D3D12_COMMAND_LIST_TYPE mCommandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    std::wstring mDebugName;
+
+    mutable std::mutex mMutex;
+
+    // Ordered by fence value. Allocators that were never submitted go to the front since they can be reused right away.
+    std::deque<ReleasedAllocator> mReleasedAllocators;
+    uint64_t mCompletedFenceValue = 0;
+
+    // Number of allocators at the front of mReleasedAllocators whose fence value has completed.
+    uint32_t mCompletedAllocatorCount = 0;
+
+    // Lowest mCompletedAllocatorCount seen since the trim window started. Anything above it was never needed.
+    uint32_t mIdleAllocatorLowWater = 0;
+    uint32_t mFramesSinceTrim = 0;
+    uint32_t mIdleFramesBeforeTrim = kCommandAllocatorIdleFramesBeforeTrim;
+
+    uint32_t mAllocatorCount = 0;
+    uint32_t mCreatedAllocatorCount = 0;
+};
+} // namespace scrap::d3d12
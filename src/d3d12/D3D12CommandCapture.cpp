@@ -0,0 +1,1317 @@
+#include "d3d12/D3D12CommandCapture.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+namespace
+{
+constexpr std::array<char, 4> kCaptureFileMagic = {'S', 'C', 'A', 'P'};
+constexpr uint32_t kCaptureFileVersion = 1;
+
+struct CommandCaptureFileHeader
+{
+    std::array<char, 4> magic = kCaptureFileMagic;
+    uint32_t version = kCaptureFileVersion;
+    uint32_t frameCount = 0;
+    uint32_t objectCount = 0;
+    uint32_t commandListCount = 0;
+    uint32_t reserved = 0;
+    uint64_t unresolvedAddressCount = 0;
+};
+
+struct CapturedCommandListHeader
+{
+    uint32_t frame = 0;
+    D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    uint32_t nameLength = 0;
+    uint32_t commandCount = 0;
+    uint64_t dataSize = 0;
+};
+
+template<class... Interfaces>
+bool IsInterface(REFIID riid)
+{
+    return ((riid == __uuidof(Interfaces)) || ...);
+}
+
+template<class T>
+std::span<const T> MakeSpan(const T* values, size_t count)
+{
+    return (values != nullptr) ? std::span<const T>(values, count) : std::span<const T>();
+}
+
+CapturedResourceBarrier CaptureResourceBarrier(CommandCapture& capture, const D3D12_RESOURCE_BARRIER& barrier)
+{
+    CapturedResourceBarrier capturedBarrier;
+    capturedBarrier.type = barrier.Type;
+    capturedBarrier.flags = barrier.Flags;
+
+    switch(barrier.Type)
+    {
+    case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+        capturedBarrier.resource = capture.getObjectId(barrier.Transition.pResource);
+        capturedBarrier.subresource = barrier.Transition.Subresource;
+        capturedBarrier.stateBefore = barrier.Transition.StateBefore;
+        capturedBarrier.stateAfter = barrier.Transition.StateAfter;
+        break;
+    case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+        capturedBarrier.resource = capture.getObjectId(barrier.Aliasing.pResourceBefore);
+        capturedBarrier.resourceAfter = capture.getObjectId(barrier.Aliasing.pResourceAfter);
+        break;
+    case D3D12_RESOURCE_BARRIER_TYPE_UAV:
+        capturedBarrier.resource = capture.getObjectId(barrier.UAV.pResource);
+        break;
+    default: break;
+    }
+
+    return capturedBarrier;
+}
+
+// Forwards every call to the command list it wraps and records the supported commands into a CommandStream in their
+// captured form. See CommandCapture.
+class CapturingCommandList final : public ID3D12GraphicsCommandList4
+{
+public:
+    CapturingCommandList(CommandCapture& capture, ID3D12GraphicsCommandList4* commandList)
+        : mCapture(capture)
+        , mCommandList(commandList)
+    {}
+    CapturingCommandList(const CapturingCommandList&) = delete;
+    CapturingCommandList(CapturingCommandList&&) = delete;
+    ~CapturingCommandList() = default;
+
+    CapturingCommandList& operator=(const CapturingCommandList&) = delete;
+    CapturingCommandList& operator=(CapturingCommandList&&) = delete;
+
+    [[nodiscard]] CommandStream takeStream() { return std::exchange(mStream, CommandStream{}); }
+
+    // IUnknown
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if(ppvObject == nullptr) { return E_POINTER; }
+
+        // Anything recorded through another interface would bypass the capture
+        if(IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12CommandList, ID3D12GraphicsCommandList,
+                       ID3D12GraphicsCommandList1, ID3D12GraphicsCommandList2, ID3D12GraphicsCommandList3,
+                       ID3D12GraphicsCommandList4>(riid))
+        {
+            *ppvObject = static_cast<ID3D12GraphicsCommandList4*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        return mCommandList->QueryInterface(riid, ppvObject);
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++mRefCount; }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        const ULONG refCount = --mRefCount;
+        if(refCount == 0) { delete this; }
+        return refCount;
+    }
+
+    // ID3D12Object
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* pDataSize, void* pData) override
+    {
+        return mCommandList->GetPrivateData(guid, pDataSize, pData);
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT DataSize, const void* pData) override
+    {
+        return mCommandList->SetPrivateData(guid, DataSize, pData);
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* pData) override
+    {
+        return mCommandList->SetPrivateDataInterface(guid, pData);
+    }
+
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR Name) override { return mCommandList->SetName(Name); }
+
+    // ID3D12DeviceChild
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override
+    {
+        return mCommandList->GetDevice(riid, ppvDevice);
+    }
+
+    // ID3D12CommandList
+    D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return mCommandList->GetType(); }
+
+    // ID3D12GraphicsCommandList
+    HRESULT STDMETHODCALLTYPE Close() override { return mCommandList->Close(); }
+
+    HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState) override
+    {
+        mStream.clear();
+
+        if(pInitialState != nullptr)
+        {
+            mStream.record(CommandType::SetPipelineState, mCapture.getObjectId(pInitialState));
+        }
+
+        return mCommandList->Reset(pAllocator, pInitialState);
+    }
+
+    void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* pPipelineState) override
+    {
+        mStream.record(CommandType::ClearState, mCapture.getObjectId(pPipelineState));
+        mCommandList->ClearState(pPipelineState);
+    }
+
+    void STDMETHODCALLTYPE DrawInstanced(UINT VertexCountPerInstance,
+                                         UINT InstanceCount,
+                                         UINT StartVertexLocation,
+                                         UINT StartInstanceLocation) override
+    {
+        mStream.record(CommandType::DrawInstanced, VertexCountPerInstance, InstanceCount, StartVertexLocation,
+                       StartInstanceLocation);
+        mCommandList->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation,
+                                    StartInstanceLocation);
+    }
+
+    void STDMETHODCALLTYPE DrawIndexedInstanced(UINT IndexCountPerInstance,
+                                                UINT InstanceCount,
+                                                UINT StartIndexLocation,
+                                                INT BaseVertexLocation,
+                                                UINT StartInstanceLocation) override
+    {
+        mStream.record(CommandType::DrawIndexedInstanced, IndexCountPerInstance, InstanceCount, StartIndexLocation,
+                       BaseVertexLocation, StartInstanceLocation);
+        mCommandList->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation,
+                                           BaseVertexLocation, StartInstanceLocation);
+    }
+
+    void STDMETHODCALLTYPE Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ) override
+    {
+        mStream.record(CommandType::Dispatch, ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+        mCommandList->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+    }
+
+    void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource* pDstBuffer,
+                                            UINT64 DstOffset,
+                                            ID3D12Resource* pSrcBuffer,
+                                            UINT64 SrcOffset,
+                                            UINT64 NumBytes) override
+    {
+        mStream.record(CommandType::CopyBufferRegion, mCapture.getObjectId(pDstBuffer), DstOffset,
+                       mCapture.getObjectId(pSrcBuffer), SrcOffset, NumBytes);
+        mCommandList->CopyBufferRegion(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
+    }
+
+    void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION* pDst,
+                                             UINT DstX,
+                                             UINT DstY,
+                                             UINT DstZ,
+                                             const D3D12_TEXTURE_COPY_LOCATION* pSrc,
+                                             const D3D12_BOX* pSrcBox) override
+    {
+        mStream.record(CommandType::CopyTextureRegion, captureCopyLocation(pDst), DstX, DstY, DstZ,
+                       captureCopyLocation(pSrc), (uint32_t)(pSrcBox != nullptr), MakeSpan(pSrcBox, 1));
+        mCommandList->CopyTextureRegion(pDst, DstX, DstY, DstZ, pSrc, pSrcBox);
+    }
+
+    void STDMETHODCALLTYPE CopyResource(ID3D12Resource* pDstResource, ID3D12Resource* pSrcResource) override
+    {
+        mStream.record(CommandType::CopyResource, mCapture.getObjectId(pDstResource),
+                       mCapture.getObjectId(pSrcResource));
+        mCommandList->CopyResource(pDstResource, pSrcResource);
+    }
+
+    void STDMETHODCALLTYPE CopyTiles(ID3D12Resource* pTiledResource,
+                                     const D3D12_TILED_RESOURCE_COORDINATE* pTileRegionStartCoordinate,
+                                     const D3D12_TILE_REGION_SIZE* pTileRegionSize,
+                                     ID3D12Resource* pBuffer,
+                                     UINT64 BufferStartOffsetInBytes,
+                                     D3D12_TILE_COPY_FLAGS Flags) override
+    {
+        mStream.record(CommandType::CopyTiles);
+        mCommandList->CopyTiles(pTiledResource, pTileRegionStartCoordinate, pTileRegionSize, pBuffer,
+                                BufferStartOffsetInBytes, Flags);
+    }
+
+    void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource* pDstResource,
+                                              UINT DstSubresource,
+                                              ID3D12Resource* pSrcResource,
+                                              UINT SrcSubresource,
+                                              DXGI_FORMAT Format) override
+    {
+        mStream.record(CommandType::ResolveSubresource);
+        mCommandList->ResolveSubresource(pDstResource, DstSubresource, pSrcResource, SrcSubresource, Format);
+    }
+
+    void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology) override
+    {
+        mStream.record(CommandType::IASetPrimitiveTopology, PrimitiveTopology);
+        mCommandList->IASetPrimitiveTopology(PrimitiveTopology);
+    }
+
+    void STDMETHODCALLTYPE RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT* pViewports) override
+    {
+        mStream.record(CommandType::RSSetViewports, (uint32_t)NumViewports, MakeSpan(pViewports, NumViewports));
+        mCommandList->RSSetViewports(NumViewports, pViewports);
+    }
+
+    void STDMETHODCALLTYPE RSSetScissorRects(UINT NumRects, const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::RSSetScissorRects, (uint32_t)NumRects, MakeSpan(pRects, NumRects));
+        mCommandList->RSSetScissorRects(NumRects, pRects);
+    }
+
+    void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT BlendFactor[4]) override
+    {
+        std::array<FLOAT, 4> blendFactor = {1.0f, 1.0f, 1.0f, 1.0f};
+        if(BlendFactor != nullptr) { std::copy_n(BlendFactor, 4, blendFactor.begin()); }
+
+        mStream.record(CommandType::OMSetBlendFactor, blendFactor);
+        mCommandList->OMSetBlendFactor(BlendFactor);
+    }
+
+    void STDMETHODCALLTYPE OMSetStencilRef(UINT StencilRef) override
+    {
+        mStream.record(CommandType::OMSetStencilRef, StencilRef);
+        mCommandList->OMSetStencilRef(StencilRef);
+    }
+
+    void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* pPipelineState) override
+    {
+        mStream.record(CommandType::SetPipelineState, mCapture.getObjectId(pPipelineState));
+        mCommandList->SetPipelineState(pPipelineState);
+    }
+
+    void STDMETHODCALLTYPE ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER* pBarriers) override
+    {
+        mBarrierBuffer.clear();
+        for(const D3D12_RESOURCE_BARRIER& barrier : MakeSpan(pBarriers, NumBarriers))
+        {
+            mBarrierBuffer.push_back(CaptureResourceBarrier(mCapture, barrier));
+        }
+
+        mStream.record(CommandType::ResourceBarrier, (uint32_t)mBarrierBuffer.size(),
+                       std::span<const CapturedResourceBarrier>(mBarrierBuffer));
+        mCommandList->ResourceBarrier(NumBarriers, pBarriers);
+    }
+
+    void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override
+    {
+        mStream.record(CommandType::ExecuteBundle);
+        mCommandList->ExecuteBundle(pCommandList);
+    }
+
+    void STDMETHODCALLTYPE SetDescriptorHeaps(UINT NumDescriptorHeaps,
+                                              ID3D12DescriptorHeap* const* ppDescriptorHeaps) override
+    {
+        std::array<CapturedObjectId, 2> heapIds = {};
+        const uint32_t heapCount = std::min<uint32_t>(NumDescriptorHeaps, (uint32_t)heapIds.size());
+
+        for(uint32_t i = 0; i < heapCount; ++i)
+        {
+            heapIds[i] = mCapture.getObjectId(ppDescriptorHeaps[i]);
+        }
+
+        mStream.record(CommandType::SetDescriptorHeaps, heapCount,
+                       std::span<const CapturedObjectId>(heapIds.data(), heapCount));
+        mCommandList->SetDescriptorHeaps(NumDescriptorHeaps, ppDescriptorHeaps);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* pRootSignature) override
+    {
+        mStream.record(CommandType::SetComputeRootSignature, mCapture.getObjectId(pRootSignature));
+        mCommandList->SetComputeRootSignature(pRootSignature);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature) override
+    {
+        mStream.record(CommandType::SetGraphicsRootSignature, mCapture.getObjectId(pRootSignature));
+        mCommandList->SetGraphicsRootSignature(pRootSignature);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT RootParameterIndex,
+                                                         D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+    {
+        mStream.record(CommandType::SetComputeRootDescriptorTable, RootParameterIndex,
+                       mCapture.resolve(BaseDescriptor));
+        mCommandList->SetComputeRootDescriptorTable(RootParameterIndex, BaseDescriptor);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT RootParameterIndex,
+                                                          D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+    {
+        mStream.record(CommandType::SetGraphicsRootDescriptorTable, RootParameterIndex,
+                       mCapture.resolve(BaseDescriptor));
+        mCommandList->SetGraphicsRootDescriptorTable(RootParameterIndex, BaseDescriptor);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT RootParameterIndex,
+                                                       UINT SrcData,
+                                                       UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetComputeRoot32BitConstant, RootParameterIndex, SrcData,
+                       DestOffsetIn32BitValues);
+        mCommandList->SetComputeRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT RootParameterIndex,
+                                                        UINT SrcData,
+                                                        UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetGraphicsRoot32BitConstant, RootParameterIndex, SrcData,
+                       DestOffsetIn32BitValues);
+        mCommandList->SetGraphicsRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT RootParameterIndex,
+                                                        UINT Num32BitValuesToSet,
+                                                        const void* pSrcData,
+                                                        UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetComputeRoot32BitConstants, RootParameterIndex, DestOffsetIn32BitValues,
+                       (uint32_t)Num32BitValuesToSet,
+                       MakeSpan(static_cast<const uint32_t*>(pSrcData), Num32BitValuesToSet));
+        mCommandList->SetComputeRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData,
+                                                   DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT RootParameterIndex,
+                                                         UINT Num32BitValuesToSet,
+                                                         const void* pSrcData,
+                                                         UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetGraphicsRoot32BitConstants, RootParameterIndex, DestOffsetIn32BitValues,
+                       (uint32_t)Num32BitValuesToSet,
+                       MakeSpan(static_cast<const uint32_t*>(pSrcData), Num32BitValuesToSet));
+        mCommandList->SetGraphicsRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData,
+                                                    DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT RootParameterIndex,
+                                                            D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootConstantBufferView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetComputeRootConstantBufferView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootConstantBufferView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetGraphicsRootConstantBufferView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT RootParameterIndex,
+                                                            D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootShaderResourceView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetComputeRootShaderResourceView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootShaderResourceView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetGraphicsRootShaderResourceView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootUnorderedAccessView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetComputeRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex,
+                                                              D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootUnorderedAccessView, RootParameterIndex,
+                       mCapture.resolve(BufferLocation));
+        mCommandList->SetGraphicsRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView) override
+    {
+        CapturedIndexBufferView view;
+        if(pView != nullptr)
+        {
+            view.bufferLocation = mCapture.resolve(pView->BufferLocation);
+            view.sizeInBytes = pView->SizeInBytes;
+            view.format = pView->Format;
+        }
+
+        mStream.record(CommandType::IASetIndexBuffer, (uint32_t)(pView != nullptr), view);
+        mCommandList->IASetIndexBuffer(pView);
+    }
+
+    void STDMETHODCALLTYPE IASetVertexBuffers(UINT StartSlot,
+                                              UINT NumViews,
+                                              const D3D12_VERTEX_BUFFER_VIEW* pViews) override
+    {
+        std::array<CapturedVertexBufferView, D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> views;
+        const uint32_t viewCount = (pViews != nullptr) ? std::min<uint32_t>(NumViews, (uint32_t)views.size()) : 0;
+
+        for(uint32_t i = 0; i < viewCount; ++i)
+        {
+            views[i].bufferLocation = mCapture.resolve(pViews[i].BufferLocation);
+            views[i].sizeInBytes = pViews[i].SizeInBytes;
+            views[i].strideInBytes = pViews[i].StrideInBytes;
+        }
+
+        mStream.record(CommandType::IASetVertexBuffers, StartSlot, viewCount,
+                       std::span<const CapturedVertexBufferView>(views.data(), viewCount));
+        mCommandList->IASetVertexBuffers(StartSlot, NumViews, pViews);
+    }
+
+    void STDMETHODCALLTYPE SOSetTargets(UINT StartSlot,
+                                        UINT NumViews,
+                                        const D3D12_STREAM_OUTPUT_BUFFER_VIEW* pViews) override
+    {
+        mStream.record(CommandType::SOSetTargets);
+        mCommandList->SOSetTargets(StartSlot, NumViews, pViews);
+    }
+
+    void STDMETHODCALLTYPE OMSetRenderTargets(UINT NumRenderTargetDescriptors,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE* pRenderTargetDescriptors,
+                                              BOOL RTsSingleHandleToDescriptorRange,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE* pDepthStencilDescriptor) override
+    {
+        std::array<CapturedAddress, D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT> renderTargets;
+        const uint32_t handleCount =
+            (pRenderTargetDescriptors == nullptr)
+                ? 0
+                : std::min<uint32_t>(RTsSingleHandleToDescriptorRange ? 1 : NumRenderTargetDescriptors,
+                                     (uint32_t)renderTargets.size());
+
+        for(uint32_t i = 0; i < handleCount; ++i)
+        {
+            renderTargets[i] = mCapture.resolve(pRenderTargetDescriptors[i]);
+        }
+
+        const CapturedAddress depthStencil =
+            (pDepthStencilDescriptor != nullptr) ? mCapture.resolve(*pDepthStencilDescriptor) : CapturedAddress{};
+
+        mStream.record(CommandType::OMSetRenderTargets, NumRenderTargetDescriptors, RTsSingleHandleToDescriptorRange,
+                       (uint32_t)(pDepthStencilDescriptor != nullptr), depthStencil, handleCount,
+                       std::span<const CapturedAddress>(renderTargets.data(), handleCount));
+        mCommandList->OMSetRenderTargets(NumRenderTargetDescriptors, pRenderTargetDescriptors,
+                                         RTsSingleHandleToDescriptorRange, pDepthStencilDescriptor);
+    }
+
+    void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView,
+                                                 D3D12_CLEAR_FLAGS ClearFlags,
+                                                 FLOAT Depth,
+                                                 UINT8 Stencil,
+                                                 UINT NumRects,
+                                                 const D3D12_RECT* pRects) override
+    {
+        const std::span<const D3D12_RECT> rects = MakeSpan(pRects, NumRects);
+        mStream.record(CommandType::ClearDepthStencilView, mCapture.resolve(DepthStencilView), ClearFlags, Depth,
+                       Stencil, (uint32_t)rects.size(), rects);
+        mCommandList->ClearDepthStencilView(DepthStencilView, ClearFlags, Depth, Stencil, NumRects, pRects);
+    }
+
+    void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+                                                 const FLOAT ColorRGBA[4],
+                                                 UINT NumRects,
+                                                 const D3D12_RECT* pRects) override
+    {
+        std::array<FLOAT, 4> color = {};
+        if(ColorRGBA != nullptr) { std::copy_n(ColorRGBA, 4, color.begin()); }
+
+        const std::span<const D3D12_RECT> rects = MakeSpan(pRects, NumRects);
+        mStream.record(CommandType::ClearRenderTargetView, mCapture.resolve(RenderTargetView), color,
+                       (uint32_t)rects.size(), rects);
+        mCommandList->ClearRenderTargetView(RenderTargetView, ColorRGBA, NumRects, pRects);
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+                                                        D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+                                                        ID3D12Resource* pResource,
+                                                        const UINT Values[4],
+                                                        UINT NumRects,
+                                                        const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearUnorderedAccessViewUint);
+        mCommandList->ClearUnorderedAccessViewUint(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values,
+                                                   NumRects, pRects);
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+                                                         D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+                                                         ID3D12Resource* pResource,
+                                                         const FLOAT Values[4],
+                                                         UINT NumRects,
+                                                         const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearUnorderedAccessViewFloat);
+        mCommandList->ClearUnorderedAccessViewFloat(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values,
+                                                    NumRects, pRects);
+    }
+
+    void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* pResource, const D3D12_DISCARD_REGION* pRegion) override
+    {
+        mStream.record(CommandType::DiscardResource);
+        mCommandList->DiscardResource(pResource, pRegion);
+    }
+
+    void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+    {
+        mStream.record(CommandType::BeginQuery);
+        mCommandList->BeginQuery(pQueryHeap, Type, Index);
+    }
+
+    void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+    {
+        mStream.record(CommandType::EndQuery);
+        mCommandList->EndQuery(pQueryHeap, Type, Index);
+    }
+
+    void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap* pQueryHeap,
+                                            D3D12_QUERY_TYPE Type,
+                                            UINT StartIndex,
+                                            UINT NumQueries,
+                                            ID3D12Resource* pDestinationBuffer,
+                                            UINT64 AlignedDestinationBufferOffset) override
+    {
+        mStream.record(CommandType::ResolveQueryData);
+        mCommandList->ResolveQueryData(pQueryHeap, Type, StartIndex, NumQueries, pDestinationBuffer,
+                                       AlignedDestinationBufferOffset);
+    }
+
+    void STDMETHODCALLTYPE SetPredication(ID3D12Resource* pBuffer,
+                                          UINT64 AlignedBufferOffset,
+                                          D3D12_PREDICATION_OP Operation) override
+    {
+        mStream.record(CommandType::SetPredication);
+        mCommandList->SetPredication(pBuffer, AlignedBufferOffset, Operation);
+    }
+
+    void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override
+    {
+        const std::span<const std::byte> data = MakeSpan(static_cast<const std::byte*>(pData), Size);
+        mStream.record(CommandType::SetMarker, Metadata, (uint32_t)data.size(), data);
+        mCommandList->SetMarker(Metadata, pData, Size);
+    }
+
+    void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override
+    {
+        const std::span<const std::byte> data = MakeSpan(static_cast<const std::byte*>(pData), Size);
+        mStream.record(CommandType::BeginEvent, Metadata, (uint32_t)data.size(), data);
+        mCommandList->BeginEvent(Metadata, pData, Size);
+    }
+
+    void STDMETHODCALLTYPE EndEvent() override
+    {
+        mStream.record(CommandType::EndEvent);
+        mCommandList->EndEvent();
+    }
+
+    void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature* pCommandSignature,
+                                           UINT MaxCommandCount,
+                                           ID3D12Resource* pArgumentBuffer,
+                                           UINT64 ArgumentBufferOffset,
+                                           ID3D12Resource* pCountBuffer,
+                                           UINT64 CountBufferOffset) override
+    {
+        mStream.record(CommandType::ExecuteIndirect);
+        mCommandList->ExecuteIndirect(pCommandSignature, MaxCommandCount, pArgumentBuffer, ArgumentBufferOffset,
+                                      pCountBuffer, CountBufferOffset);
+    }
+
+    // ID3D12GraphicsCommandList1
+    void STDMETHODCALLTYPE
+    AtomicCopyBufferUINT(ID3D12Resource* pDstBuffer,
+                         UINT64 DstOffset,
+                         ID3D12Resource* pSrcBuffer,
+                         UINT64 SrcOffset,
+                         UINT Dependencies,
+                         ID3D12Resource* const* ppDependentResources,
+                         const D3D12_SUBRESOURCE_RANGE_UINT64* pDependentSubresourceRanges) override
+    {
+        mStream.record(CommandType::AtomicCopyBufferUINT);
+        mCommandList->AtomicCopyBufferUINT(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, Dependencies,
+                                           ppDependentResources, pDependentSubresourceRanges);
+    }
+
+    void STDMETHODCALLTYPE
+    AtomicCopyBufferUINT64(ID3D12Resource* pDstBuffer,
+                           UINT64 DstOffset,
+                           ID3D12Resource* pSrcBuffer,
+                           UINT64 SrcOffset,
+                           UINT Dependencies,
+                           ID3D12Resource* const* ppDependentResources,
+                           const D3D12_SUBRESOURCE_RANGE_UINT64* pDependentSubresourceRanges) override
+    {
+        mStream.record(CommandType::AtomicCopyBufferUINT64);
+        mCommandList->AtomicCopyBufferUINT64(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, Dependencies,
+                                             ppDependentResources, pDependentSubresourceRanges);
+    }
+
+    void STDMETHODCALLTYPE OMSetDepthBounds(FLOAT Min, FLOAT Max) override
+    {
+        mStream.record(CommandType::OMSetDepthBounds);
+        mCommandList->OMSetDepthBounds(Min, Max);
+    }
+
+    void STDMETHODCALLTYPE SetSamplePositions(UINT NumSamplesPerPixel,
+                                              UINT NumPixels,
+                                              D3D12_SAMPLE_POSITION* pSamplePositions) override
+    {
+        mStream.record(CommandType::SetSamplePositions);
+        mCommandList->SetSamplePositions(NumSamplesPerPixel, NumPixels, pSamplePositions);
+    }
+
+    void STDMETHODCALLTYPE ResolveSubresourceRegion(ID3D12Resource* pDstResource,
+                                                    UINT DstSubresource,
+                                                    UINT DstX,
+                                                    UINT DstY,
+                                                    ID3D12Resource* pSrcResource,
+                                                    UINT SrcSubresource,
+                                                    D3D12_RECT* pSrcRect,
+                                                    DXGI_FORMAT Format,
+                                                    D3D12_RESOLVE_MODE ResolveMode) override
+    {
+        mStream.record(CommandType::ResolveSubresourceRegion);
+        mCommandList->ResolveSubresourceRegion(pDstResource, DstSubresource, DstX, DstY, pSrcResource, SrcSubresource,
+                                               pSrcRect, Format, ResolveMode);
+    }
+
+    void STDMETHODCALLTYPE SetViewInstanceMask(UINT Mask) override
+    {
+        mStream.record(CommandType::SetViewInstanceMask);
+        mCommandList->SetViewInstanceMask(Mask);
+    }
+
+    // ID3D12GraphicsCommandList2
+    void STDMETHODCALLTYPE WriteBufferImmediate(UINT Count,
+                                                const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER* pParams,
+                                                const D3D12_WRITEBUFFERIMMEDIATE_MODE* pModes) override
+    {
+        mStream.record(CommandType::WriteBufferImmediate);
+        mCommandList->WriteBufferImmediate(Count, pParams, pModes);
+    }
+
+    // ID3D12GraphicsCommandList3
+    void STDMETHODCALLTYPE
+    SetProtectedResourceSession(ID3D12ProtectedResourceSession* pProtectedResourceSession) override
+    {
+        mStream.record(CommandType::SetProtectedResourceSession);
+        mCommandList->SetProtectedResourceSession(pProtectedResourceSession);
+    }
+
+    // ID3D12GraphicsCommandList4
+    void STDMETHODCALLTYPE BeginRenderPass(UINT NumRenderTargets,
+                                           const D3D12_RENDER_PASS_RENDER_TARGET_DESC* pRenderTargets,
+                                           const D3D12_RENDER_PASS_DEPTH_STENCIL_DESC* pDepthStencil,
+                                           D3D12_RENDER_PASS_FLAGS Flags) override
+    {
+        mStream.record(CommandType::BeginRenderPass);
+        mCommandList->BeginRenderPass(NumRenderTargets, pRenderTargets, pDepthStencil, Flags);
+    }
+
+    void STDMETHODCALLTYPE EndRenderPass() override
+    {
+        mStream.record(CommandType::EndRenderPass);
+        mCommandList->EndRenderPass();
+    }
+
+    void STDMETHODCALLTYPE InitializeMetaCommand(ID3D12MetaCommand* pMetaCommand,
+                                                 const void* pInitializationParametersData,
+                                                 SIZE_T InitializationParametersDataSizeInBytes) override
+    {
+        mStream.record(CommandType::InitializeMetaCommand);
+        mCommandList->InitializeMetaCommand(pMetaCommand, pInitializationParametersData,
+                                            InitializationParametersDataSizeInBytes);
+    }
+
+    void STDMETHODCALLTYPE ExecuteMetaCommand(ID3D12MetaCommand* pMetaCommand,
+                                              const void* pExecutionParametersData,
+                                              SIZE_T ExecutionParametersDataSizeInBytes) override
+    {
+        mStream.record(CommandType::ExecuteMetaCommand);
+        mCommandList->ExecuteMetaCommand(pMetaCommand, pExecutionParametersData, ExecutionParametersDataSizeInBytes);
+    }
+
+    void STDMETHODCALLTYPE BuildRaytracingAccelerationStructure(
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC* pDesc,
+        UINT NumPostbuildInfoDescs,
+        const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC* pPostbuildInfoDescs) override
+    {
+        if(pDesc != nullptr) { recordAccelerationStructureBuild(*pDesc, NumPostbuildInfoDescs, pPostbuildInfoDescs); }
+
+        mCommandList->BuildRaytracingAccelerationStructure(pDesc, NumPostbuildInfoDescs, pPostbuildInfoDescs);
+    }
+
+    void STDMETHODCALLTYPE EmitRaytracingAccelerationStructurePostbuildInfo(
+        const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC* pDesc,
+        UINT NumSourceAccelerationStructures,
+        const D3D12_GPU_VIRTUAL_ADDRESS* pSourceAccelerationStructureData) override
+    {
+        mStream.record(CommandType::EmitRaytracingAccelerationStructurePostbuildInfo);
+        mCommandList->EmitRaytracingAccelerationStructurePostbuildInfo(pDesc, NumSourceAccelerationStructures,
+                                                                       pSourceAccelerationStructureData);
+    }
+
+    void STDMETHODCALLTYPE CopyRaytracingAccelerationStructure(
+        D3D12_GPU_VIRTUAL_ADDRESS DestAccelerationStructureData,
+        D3D12_GPU_VIRTUAL_ADDRESS SourceAccelerationStructureData,
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE Mode) override
+    {
+        mStream.record(CommandType::CopyRaytracingAccelerationStructure);
+        mCommandList->CopyRaytracingAccelerationStructure(DestAccelerationStructureData,
+                                                          SourceAccelerationStructureData, Mode);
+    }
+
+    void STDMETHODCALLTYPE SetPipelineState1(ID3D12StateObject* pStateObject) override
+    {
+        mStream.record(CommandType::SetPipelineState1, mCapture.getObjectId(pStateObject));
+        mCommandList->SetPipelineState1(pStateObject);
+    }
+
+    void STDMETHODCALLTYPE DispatchRays(const D3D12_DISPATCH_RAYS_DESC* pDesc) override
+    {
+        if(pDesc != nullptr)
+        {
+            CapturedDispatchRaysDesc desc;
+            desc.rayGenerationShaderRecord = {mCapture.resolve(pDesc->RayGenerationShaderRecord.StartAddress),
+                                              pDesc->RayGenerationShaderRecord.SizeInBytes, 0};
+            desc.missShaderTable = captureShaderTable(pDesc->MissShaderTable);
+            desc.hitGroupTable = captureShaderTable(pDesc->HitGroupTable);
+            desc.callableShaderTable = captureShaderTable(pDesc->CallableShaderTable);
+            desc.width = pDesc->Width;
+            desc.height = pDesc->Height;
+            desc.depth = pDesc->Depth;
+
+            mStream.record(CommandType::DispatchRays, desc);
+        }
+
+        mCommandList->DispatchRays(pDesc);
+    }
+
+private:
+    CapturedTextureCopyLocation captureCopyLocation(const D3D12_TEXTURE_COPY_LOCATION* location)
+    {
+        CapturedTextureCopyLocation capturedLocation;
+        if(location == nullptr) { return capturedLocation; }
+
+        capturedLocation.resource = mCapture.getObjectId(location->pResource);
+        capturedLocation.type = location->Type;
+
+        if(location->Type == D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT)
+        {
+            capturedLocation.placedFootprint = location->PlacedFootprint;
+        }
+        else
+        {
+            capturedLocation.subresourceIndex = location->SubresourceIndex;
+        }
+
+        return capturedLocation;
+    }
+
+    CapturedShaderTableRange captureShaderTable(const D3D12_GPU_VIRTUAL_ADDRESS_RANGE_AND_STRIDE& range)
+    {
+        return CapturedShaderTableRange{mCapture.resolve(range.StartAddress), range.SizeInBytes, range.StrideInBytes};
+    }
+
+    void recordAccelerationStructureBuild(
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC& desc,
+        UINT postbuildInfoDescCount,
+        const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC* postbuildInfoDescs)
+    {
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& inputs = desc.Inputs;
+
+        CapturedAccelerationStructureBuild build;
+        build.destAccelerationStructureData = mCapture.resolve(desc.DestAccelerationStructureData);
+        build.sourceAccelerationStructureData = mCapture.resolve(desc.SourceAccelerationStructureData);
+        build.scratchAccelerationStructureData = mCapture.resolve(desc.ScratchAccelerationStructureData);
+        build.type = inputs.Type;
+        build.flags = inputs.Flags;
+        build.descCount = inputs.NumDescs;
+
+        mGeometryBuffer.clear();
+
+        if(inputs.Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL)
+        {
+            build.instanceDescs = mCapture.resolve(inputs.InstanceDescs);
+        }
+        else
+        {
+            for(UINT i = 0; i < inputs.NumDescs; ++i)
+            {
+                const D3D12_RAYTRACING_GEOMETRY_DESC& geometryDesc =
+                    (inputs.DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY) ? inputs.pGeometryDescs[i]
+                                                                        : *inputs.ppGeometryDescs[i];
+
+                CapturedGeometryDesc& capturedDesc = mGeometryBuffer.emplace_back();
+                capturedDesc.type = geometryDesc.Type;
+                capturedDesc.flags = geometryDesc.Flags;
+
+                if(geometryDesc.Type == D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES)
+                {
+                    const D3D12_RAYTRACING_GEOMETRY_TRIANGLES_DESC& triangles = geometryDesc.Triangles;
+                    capturedDesc.transform3x4 = mCapture.resolve(triangles.Transform3x4);
+                    capturedDesc.indexFormat = triangles.IndexFormat;
+                    capturedDesc.vertexFormat = triangles.VertexFormat;
+                    capturedDesc.indexCount = triangles.IndexCount;
+                    capturedDesc.vertexCount = triangles.VertexCount;
+                    capturedDesc.indexBuffer = mCapture.resolve(triangles.IndexBuffer);
+                    capturedDesc.vertexBuffer = mCapture.resolve(triangles.VertexBuffer.StartAddress);
+                    capturedDesc.vertexStride = triangles.VertexBuffer.StrideInBytes;
+                }
+                else
+                {
+                    capturedDesc.vertexBuffer = mCapture.resolve(geometryDesc.AABBs.AABBs.StartAddress);
+                    capturedDesc.vertexStride = geometryDesc.AABBs.AABBs.StrideInBytes;
+                    capturedDesc.aabbCount = geometryDesc.AABBs.AABBCount;
+                }
+            }
+        }
+
+        mPostbuildInfoBuffer.clear();
+        for(const auto& postbuildInfoDesc : MakeSpan(postbuildInfoDescs, postbuildInfoDescCount))
+        {
+            mPostbuildInfoBuffer.push_back(
+                CapturedPostbuildInfoDesc{mCapture.resolve(postbuildInfoDesc.DestBuffer), postbuildInfoDesc.InfoType});
+        }
+
+        mStream.record(CommandType::BuildRaytracingAccelerationStructure, build, (uint32_t)mGeometryBuffer.size(),
+                       std::span<const CapturedGeometryDesc>(mGeometryBuffer), (uint32_t)mPostbuildInfoBuffer.size(),
+                       std::span<const CapturedPostbuildInfoDesc>(mPostbuildInfoBuffer));
+    }
+
+    CommandCapture& mCapture;
+    ComPtr<ID3D12GraphicsCommandList4> mCommandList;
+    CommandStream mStream;
+    std::vector<CapturedResourceBarrier> mBarrierBuffer;
+    std::vector<CapturedGeometryDesc> mGeometryBuffer;
+    std::vector<CapturedPostbuildInfoDesc> mPostbuildInfoBuffer;
+    std::atomic<ULONG> mRefCount{1};
+};
+
+template<class T>
+void WriteValue(std::ofstream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+bool ReadValue(std::ifstream& stream, T& value)
+{
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+}
+} // namespace
+
+void CommandCapture::init(const CommandCaptureParams& params)
+{
+    mParams = params;
+    mEnabled = (params.frameCount > 0);
+    mCapturing = mEnabled && (params.firstFrame == 0);
+    mFrame = 0;
+    mFile = {};
+    mFile.frameCount = params.frameCount;
+
+    if(mEnabled)
+    {
+        spdlog::info("Capturing {} frames of commands starting at frame {} to '{}'", params.frameCount,
+                     params.firstFrame, params.filePath.string());
+    }
+}
+
+void CommandCapture::endFrame()
+{
+    if(!mEnabled) { return; }
+
+    ++mFrame;
+
+    if(mFrame < mParams.firstFrame + mParams.frameCount)
+    {
+        mCapturing = (mFrame >= mParams.firstFrame);
+        return;
+    }
+
+    mCapturing = false;
+    mEnabled = false;
+
+    writeFile();
+
+    std::lock_guard lockGuard(mMutex);
+    mResources.clear();
+    mBufferAddresses.clear();
+    mDescriptorHeaps.clear();
+    mObjectIds.clear();
+    mObjectReferences.clear();
+    mFile = {};
+}
+
+void CommandCapture::addResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES initialState)
+{
+    if(!mEnabled || resource == nullptr) { return; }
+
+    std::lock_guard lockGuard(mMutex);
+    mResources[resource] = TrackedResource{resource, initialState};
+
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    if(desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        mBufferAddresses[resource->GetGPUVirtualAddress()] = resource;
+    }
+}
+
+void CommandCapture::addDescriptorHeap(ID3D12DescriptorHeap* descriptorHeap)
+{
+    if(!mEnabled || descriptorHeap == nullptr) { return; }
+
+    std::lock_guard lockGuard(mMutex);
+    getObjectIdLocked(descriptorHeap);
+}
+
+ComPtr<ID3D12GraphicsCommandList4> CommandCapture::createCapturingCommandList(ID3D12GraphicsCommandList4* commandList)
+{
+    if(commandList == nullptr) { return nullptr; }
+
+    ComPtr<ID3D12GraphicsCommandList4> capturingCommandList;
+    capturingCommandList.Attach(new CapturingCommandList(*this, commandList));
+    return capturingCommandList;
+}
+
+void CommandCapture::addCommandList(ID3D12GraphicsCommandList4* capturingCommandList, std::string_view name)
+{
+    if(capturingCommandList == nullptr) { return; }
+
+    CommandStream stream = static_cast<CapturingCommandList*>(capturingCommandList)->takeStream();
+    if(!mCapturing) { return; }
+
+    std::lock_guard lockGuard(mMutex);
+    mFile.commandLists.push_back(CapturedCommandList{mFrame - mParams.firstFrame, capturingCommandList->GetType(),
+                                                     std::string(name), std::move(stream)});
+}
+
+void CommandCapture::addResourceBarriers(D3D12_COMMAND_LIST_TYPE type,
+                                         std::string_view name,
+                                         std::span<const D3D12_RESOURCE_BARRIER> barriers)
+{
+    if(!mCapturing || barriers.empty()) { return; }
+
+    std::vector<CapturedResourceBarrier> capturedBarriers;
+    capturedBarriers.reserve(barriers.size());
+
+    for(const D3D12_RESOURCE_BARRIER& barrier : barriers)
+    {
+        capturedBarriers.push_back(CaptureResourceBarrier(*this, barrier));
+    }
+
+    CapturedCommandList commandList{mFrame - mParams.firstFrame, type, std::string(name), CommandStream{}};
+    commandList.stream.record(CommandType::ResourceBarrier, (uint32_t)capturedBarriers.size(),
+                              std::span<const CapturedResourceBarrier>(capturedBarriers));
+
+    std::lock_guard lockGuard(mMutex);
+    mFile.commandLists.push_back(std::move(commandList));
+}
+
+CapturedObjectId CommandCapture::getObjectId(ID3D12Resource* resource)
+{
+    if(resource == nullptr) { return 0; }
+
+    std::lock_guard lockGuard(mMutex);
+    return getObjectIdLocked(resource);
+}
+
+CapturedObjectId CommandCapture::getObjectId(ID3D12DescriptorHeap* descriptorHeap)
+{
+    if(descriptorHeap == nullptr) { return 0; }
+
+    std::lock_guard lockGuard(mMutex);
+    return getObjectIdLocked(descriptorHeap);
+}
+
+CapturedObjectId CommandCapture::getObjectId(ID3D12PipelineState* pipelineState)
+{
+    if(pipelineState == nullptr) { return 0; }
+
+    std::lock_guard lockGuard(mMutex);
+    if(CapturedObjectId id = findObjectId(pipelineState); id != 0) { return id; }
+
+    CapturedObject object;
+    object.type = CapturedObjectType::PipelineState;
+    return addObject(pipelineState, object);
+}
+
+CapturedObjectId CommandCapture::getObjectId(ID3D12RootSignature* rootSignature)
+{
+    if(rootSignature == nullptr) { return 0; }
+
+    std::lock_guard lockGuard(mMutex);
+    if(CapturedObjectId id = findObjectId(rootSignature); id != 0) { return id; }
+
+    CapturedObject object;
+    object.type = CapturedObjectType::RootSignature;
+    return addObject(rootSignature, object);
+}
+
+CapturedObjectId CommandCapture::getObjectId(ID3D12StateObject* stateObject)
+{
+    if(stateObject == nullptr) { return 0; }
+
+    std::lock_guard lockGuard(mMutex);
+    if(CapturedObjectId id = findObjectId(stateObject); id != 0) { return id; }
+
+    CapturedObject object;
+    object.type = CapturedObjectType::StateObject;
+    return addObject(stateObject, object);
+}
+
+CapturedAddress CommandCapture::resolve(D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    if(address == 0) { return {}; }
+
+    std::lock_guard lockGuard(mMutex);
+
+    // The last buffer that starts at or before the address
+    auto itr = mBufferAddresses.upper_bound(address);
+    if(itr != mBufferAddresses.begin())
+    {
+        --itr;
+
+        ID3D12Resource* buffer = itr->second;
+        if(address - itr->first < buffer->GetDesc().Width)
+        {
+            return CapturedAddress{getObjectIdLocked(buffer), 0, address - itr->first};
+        }
+    }
+
+    ++mFile.unresolvedAddressCount;
+    return CapturedAddress{0, 0, address};
+}
+
+CapturedAddress CommandCapture::resolve(D3D12_CPU_DESCRIPTOR_HANDLE descriptor)
+{
+    if(descriptor.ptr == 0) { return {}; }
+
+    std::lock_guard lockGuard(mMutex);
+
+    for(const TrackedDescriptorHeap& heap : mDescriptorHeaps)
+    {
+        const SIZE_T heapEnd = heap.cpuStart + (SIZE_T)heap.descriptorSize * heap.descriptorCount;
+        if(descriptor.ptr >= heap.cpuStart && descriptor.ptr < heapEnd)
+        {
+            return CapturedAddress{heap.id, 0, (descriptor.ptr - heap.cpuStart) / heap.descriptorSize};
+        }
+    }
+
+    ++mFile.unresolvedAddressCount;
+    return CapturedAddress{0, 0, descriptor.ptr};
+}
+
+CapturedAddress CommandCapture::resolve(D3D12_GPU_DESCRIPTOR_HANDLE descriptor)
+{
+    if(descriptor.ptr == 0) { return {}; }
+
+    std::lock_guard lockGuard(mMutex);
+
+    for(const TrackedDescriptorHeap& heap : mDescriptorHeaps)
+    {
+        if(heap.gpuStart == 0) { continue; }
+
+        if(descriptor.ptr >= heap.gpuStart &&
+           descriptor.ptr < heap.gpuStart + (UINT64)heap.descriptorSize * heap.descriptorCount)
+        {
+            return CapturedAddress{heap.id, 0, (descriptor.ptr - heap.gpuStart) / heap.descriptorSize};
+        }
+    }
+
+    ++mFile.unresolvedAddressCount;
+    return CapturedAddress{0, 0, descriptor.ptr};
+}
+
+CapturedObjectId CommandCapture::addObject(IUnknown* object, const CapturedObject& capturedObject)
+{
+    mFile.objects.push_back(capturedObject);
+    mObjectReferences.emplace_back(object);
+
+    const CapturedObjectId id = (CapturedObjectId)mFile.objects.size();
+    mObjectIds[object] = id;
+    return id;
+}
+
+CapturedObjectId CommandCapture::findObjectId(IUnknown* object) const
+{
+    auto itr = mObjectIds.find(object);
+    return (itr != mObjectIds.end()) ? itr->second : 0;
+}
+
+CapturedObjectId CommandCapture::getObjectIdLocked(ID3D12Resource* resource)
+{
+    if(CapturedObjectId id = findObjectId(resource); id != 0) { return id; }
+
+    CapturedObject object;
+    object.type = CapturedObjectType::Resource;
+    object.resourceDesc = resource->GetDesc();
+
+    D3D12_HEAP_PROPERTIES heapProperties;
+    if(SUCCEEDED(resource->GetHeapProperties(&heapProperties, nullptr))) { object.heapType = heapProperties.Type; }
+
+    // Resources that weren't created through a tracked path, like the swap chain's back buffers, start out in the
+    // common state
+    auto itr = mResources.find(resource);
+    if(itr != mResources.end()) { object.initialState = itr->second.initialState; }
+
+    return addObject(resource, object);
+}
+
+CapturedObjectId CommandCapture::getObjectIdLocked(ID3D12DescriptorHeap* descriptorHeap)
+{
+    if(CapturedObjectId id = findObjectId(descriptorHeap); id != 0) { return id; }
+
+    CapturedObject object;
+    object.type = CapturedObjectType::DescriptorHeap;
+    object.descriptorHeapDesc = descriptorHeap->GetDesc();
+
+    const CapturedObjectId id = addObject(descriptorHeap, object);
+
+    ComPtr<ID3D12Device> device;
+    descriptorHeap->GetDevice(IID_PPV_ARGS(&device));
+
+    TrackedDescriptorHeap& heap = mDescriptorHeaps.emplace_back();
+    heap.id = id;
+    heap.cpuStart = descriptorHeap->GetCPUDescriptorHandleForHeapStart().ptr;
+    heap.descriptorCount = object.descriptorHeapDesc.NumDescriptors;
+    heap.descriptorSize = (device != nullptr)
+                              ? device->GetDescriptorHandleIncrementSize(object.descriptorHeapDesc.Type)
+                              : 1;
+
+    if((object.descriptorHeapDesc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0)
+    {
+        heap.gpuStart = descriptorHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+    }
+
+    return id;
+}
+
+void CommandCapture::writeFile()
+{
+    uint64_t commandCount = 0;
+    for(const CapturedCommandList& commandList : mFile.commandLists)
+    {
+        commandCount += commandList.stream.getCommandCount();
+    }
+
+    if(auto error = SaveCommandCaptureFile(mParams.filePath, mFile); error.has_value())
+    {
+        spdlog::error("Failed to write command capture '{}'. {}", mParams.filePath.string(), error.value());
+        return;
+    }
+
+    spdlog::info("Wrote command capture '{}'. {} frames, {} command lists, {} commands and {} objects",
+                 mParams.filePath.string(), mFile.frameCount, mFile.commandLists.size(), commandCount,
+                 mFile.objects.size());
+
+    if(mFile.unresolvedAddressCount > 0)
+    {
+        spdlog::warn("{} gpu addresses or descriptors in the command capture didn't belong to a known object",
+                     mFile.unresolvedAddressCount);
+    }
+}
+
+tl::expected<CommandCaptureFile, CommandCaptureError> LoadCommandCaptureFile(const std::filesystem::path& filePath)
+{
+    std::ifstream stream(filePath, std::ios::binary);
+    if(!stream.is_open()) { return tl::make_unexpected(CommandCaptureError::FileOpenFailed); }
+
+    CommandCaptureFileHeader header;
+    if(!ReadValue(stream, header)) { return tl::make_unexpected(CommandCaptureError::FileReadFailed); }
+    if(header.magic != kCaptureFileMagic) { return tl::make_unexpected(CommandCaptureError::InvalidFile); }
+    if(header.version != kCaptureFileVersion) { return tl::make_unexpected(CommandCaptureError::UnsupportedVersion); }
+
+    CommandCaptureFile file;
+    file.frameCount = header.frameCount;
+    file.unresolvedAddressCount = header.unresolvedAddressCount;
+
+    file.objects.resize(header.objectCount);
+    for(CapturedObject& object : file.objects)
+    {
+        if(!ReadValue(stream, object)) { return tl::make_unexpected(CommandCaptureError::FileReadFailed); }
+        if(object.type >= CapturedObjectType::Count) { return tl::make_unexpected(CommandCaptureError::InvalidFile); }
+    }
+
+    file.commandLists.reserve(header.commandListCount);
+    for(uint32_t i = 0; i < header.commandListCount; ++i)
+    {
+        CapturedCommandListHeader commandListHeader;
+        if(!ReadValue(stream, commandListHeader)) { return tl::make_unexpected(CommandCaptureError::FileReadFailed); }
+
+        CapturedCommandList& commandList = file.commandLists.emplace_back();
+        commandList.frame = commandListHeader.frame;
+        commandList.type = commandListHeader.type;
+
+        commandList.name.resize(commandListHeader.nameLength);
+        stream.read(commandList.name.data(), commandList.name.size());
+
+        std::vector<std::byte> data(commandListHeader.dataSize);
+        stream.read(reinterpret_cast<char*>(data.data()), data.size());
+
+        if(!stream.good()) { return tl::make_unexpected(CommandCaptureError::FileReadFailed); }
+
+        if(!commandList.stream.assign(std::move(data)) ||
+           commandList.stream.getCommandCount() != commandListHeader.commandCount)
+        {
+            return tl::make_unexpected(CommandCaptureError::InvalidFile);
+        }
+    }
+
+    return file;
+}
+
+std::optional<CommandCaptureError> SaveCommandCaptureFile(const std::filesystem::path& filePath,
+                                                          const CommandCaptureFile& file)
+{
+    std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open()) { return CommandCaptureError::FileOpenFailed; }
+
+    CommandCaptureFileHeader header;
+    header.frameCount = file.frameCount;
+    header.objectCount = (uint32_t)file.objects.size();
+    header.commandListCount = (uint32_t)file.commandLists.size();
+    header.unresolvedAddressCount = file.unresolvedAddressCount;
+    WriteValue(stream, header);
+
+    for(const CapturedObject& object : file.objects)
+    {
+        WriteValue(stream, object);
+    }
+
+    for(const CapturedCommandList& commandList : file.commandLists)
+    {
+        const std::span<const std::byte> data = commandList.stream.getData();
+
+        CapturedCommandListHeader commandListHeader;
+        commandListHeader.frame = commandList.frame;
+        commandListHeader.type = commandList.type;
+        commandListHeader.nameLength = (uint32_t)commandList.name.size();
+        commandListHeader.commandCount = commandList.stream.getCommandCount();
+        commandListHeader.dataSize = data.size();
+        WriteValue(stream, commandListHeader);
+
+        stream.write(commandList.name.data(), commandList.name.size());
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    if(!stream.good()) { return CommandCaptureError::FileWriteFailed; }
+
+    return std::nullopt;
+}
+} // namespace scrap::d3d12
@@ -0,0 +1,344 @@
+// Classes:
+//   CommandCapture
+//
+// CommandCapture:
+//   Records every command recorded through a GraphicsCommandList for a range of frames and writes them to a compact
+//   binary file that CommandReplayer can issue again against any device. While a frame is being captured,
+//   GraphicsCommandList records through a proxy command list that forwards each call to the real command list and
+//   encodes it into a CommandStream. Pointers are stored as ids into the capture's object table and gpu virtual
+//   addresses and descriptor handles are stored relative to the object they point into, so the stream doesn't depend
+//   on the process or device it was captured on.
+//
+//   Only the commands themselves are captured. Buffer and texture contents, descriptor contents and how pipeline
+//   objects were created are not. Commands that aren't supported are kept as markers without arguments so the replay
+//   can count them.
+//
+//   File layout: CommandCaptureFileHeader, CapturedObject[objectCount], then per command list a
+//   CapturedCommandListHeader, the command list's name and its CommandStream data.
+
+#pragma once
+
+#include "d3d12/D3D12CommandStream.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <d3d12.h>
+#include <tl/expected.hpp>
+#include <wrl/client.h>
+
+namespace scrap::d3d12
+{
+enum class CapturedObjectType : uint32_t
+{
+    Resource,
+    DescriptorHeap,
+    PipelineState,
+    RootSignature,
+    StateObject,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+enum class CommandCaptureError
+{
+    FileOpenFailed,
+    FileWriteFailed,
+    FileReadFailed,
+    InvalidFile,
+    UnsupportedVersion,
+};
+
+// Ids start at 1. Id 0 is a null pointer.
+using CapturedObjectId = uint32_t;
+
+struct CapturedObject
+{
+    CapturedObjectType type = CapturedObjectType::Resource;
+    // The state the resource was created in
+    D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;
+    D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+    uint32_t reserved = 0;
+    D3D12_RESOURCE_DESC resourceDesc = {};
+    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
+};
+
+// A gpu virtual address is stored as a byte offset into the buffer that contains it and a descriptor handle as the
+// index of the descriptor in its heap. An objectId of 0 with a non zero offset is an address that couldn't be resolved
+// and the offset is the raw address.
+struct CapturedAddress
+{
+    CapturedObjectId objectId = 0;
+    uint32_t reserved = 0;
+    uint64_t offset = 0;
+
+    [[nodiscard]] bool isNull() const { return objectId == 0 && offset == 0; }
+    [[nodiscard]] bool isResolved() const { return objectId != 0 || offset == 0; }
+};
+
+// The captured form of the command arguments that contain pointers or addresses. Arrays are stored as a uint32_t count
+// followed by the values.
+struct CapturedResourceBarrier
+{
+    D3D12_RESOURCE_BARRIER_TYPE type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    // The resource before for aliasing barriers
+    CapturedObjectId resource = 0;
+    // Only used by aliasing barriers
+    CapturedObjectId resourceAfter = 0;
+    UINT subresource = 0;
+    D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON;
+    D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_COMMON;
+};
+
+struct CapturedTextureCopyLocation
+{
+    CapturedObjectId resource = 0;
+    D3D12_TEXTURE_COPY_TYPE type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT placedFootprint = {};
+    UINT subresourceIndex = 0;
+};
+
+struct CapturedIndexBufferView
+{
+    CapturedAddress bufferLocation;
+    UINT sizeInBytes = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+};
+
+struct CapturedVertexBufferView
+{
+    CapturedAddress bufferLocation;
+    UINT sizeInBytes = 0;
+    UINT strideInBytes = 0;
+};
+
+struct CapturedGeometryDesc
+{
+    D3D12_RAYTRACING_GEOMETRY_TYPE type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+    D3D12_RAYTRACING_GEOMETRY_FLAGS flags = D3D12_RAYTRACING_GEOMETRY_FLAG_NONE;
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_UNKNOWN;
+    DXGI_FORMAT vertexFormat = DXGI_FORMAT_UNKNOWN;
+    UINT indexCount = 0;
+    UINT vertexCount = 0;
+    CapturedAddress transform3x4;
+    CapturedAddress indexBuffer;
+    // The AABB buffer for procedural geometry
+    CapturedAddress vertexBuffer;
+    UINT64 vertexStride = 0;
+    UINT64 aabbCount = 0;
+};
+
+struct CapturedAccelerationStructureBuild
+{
+    CapturedAddress destAccelerationStructureData;
+    CapturedAddress sourceAccelerationStructureData;
+    CapturedAddress scratchAccelerationStructureData;
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS flags =
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_NONE;
+    UINT descCount = 0;
+    uint32_t reserved = 0;
+    // Only used by top level builds. Bottom level builds are followed by their CapturedGeometryDescs instead.
+    CapturedAddress instanceDescs;
+};
+
+struct CapturedPostbuildInfoDesc
+{
+    CapturedAddress destBuffer;
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_TYPE infoType =
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE;
+    uint32_t reserved = 0;
+};
+
+struct CapturedShaderTableRange
+{
+    CapturedAddress startAddress;
+    UINT64 sizeInBytes = 0;
+    // Not used by the ray generation shader record
+    UINT64 strideInBytes = 0;
+};
+
+struct CapturedDispatchRaysDesc
+{
+    CapturedShaderTableRange rayGenerationShaderRecord;
+    CapturedShaderTableRange missShaderTable;
+    CapturedShaderTableRange hitGroupTable;
+    CapturedShaderTableRange callableShaderTable;
+    UINT width = 0;
+    UINT height = 0;
+    UINT depth = 0;
+};
+
+struct CapturedCommandList
+{
+    uint32_t frame = 0;
+    D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    std::string name;
+    CommandStream stream;
+};
+
+struct CommandCaptureFile
+{
+    uint32_t frameCount = 0;
+    uint64_t unresolvedAddressCount = 0;
+    // Indexed by CapturedObjectId - 1
+    std::vector<CapturedObject> objects;
+    // In submission order
+    std::vector<CapturedCommandList> commandLists;
+};
+
+struct CommandCaptureParams
+{
+    std::filesystem::path filePath;
+    uint32_t firstFrame = 0;
+    // Zero disables capturing
+    uint32_t frameCount = 0;
+};
+
+class CommandCapture
+{
+public:
+    CommandCapture() = default;
+    CommandCapture(const CommandCapture&) = delete;
+    CommandCapture(CommandCapture&&) = delete;
+    ~CommandCapture() = default;
+
+    CommandCapture& operator=(const CommandCapture&) = delete;
+    CommandCapture& operator=(CommandCapture&&) = delete;
+
+    // Has to be called before any resources are created. Resources are tracked from then on so the gpu virtual
+    // addresses used by the captured frames can be resolved, even if the buffer was created long before.
+    void init(const CommandCaptureParams& params);
+
+    // True from init until the last captured frame has been written
+    [[nodiscard]] bool isEnabled() const { return mEnabled; }
+
+    // True while the current frame is being captured
+    [[nodiscard]] bool isCapturing() const { return mCapturing; }
+
+    // Called by DeviceContext at the end of every frame. Starts and stops capturing and writes the file once the last
+    // frame has been captured.
+    void endFrame();
+
+    void addResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES initialState);
+    void addDescriptorHeap(ID3D12DescriptorHeap* descriptorHeap);
+
+    // Returns a command list that forwards to commandList and captures everything recorded through it
+    [[nodiscard]] Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4>
+    createCapturingCommandList(ID3D12GraphicsCommandList4* commandList);
+
+    // Takes the commands recorded into a command list returned by createCapturingCommandList since its last Reset.
+    // Called in submission order.
+    void addCommandList(ID3D12GraphicsCommandList4* capturingCommandList, std::string_view name);
+
+    // Barriers that were recorded into their own command list and submitted right before the next added command list
+    void addResourceBarriers(D3D12_COMMAND_LIST_TYPE type,
+                             std::string_view name,
+                             std::span<const D3D12_RESOURCE_BARRIER> barriers);
+
+    // Used by the capturing command lists to translate their arguments
+    [[nodiscard]] CapturedObjectId getObjectId(ID3D12Resource* resource);
+    [[nodiscard]] CapturedObjectId getObjectId(ID3D12DescriptorHeap* descriptorHeap);
+    [[nodiscard]] CapturedObjectId getObjectId(ID3D12PipelineState* pipelineState);
+    [[nodiscard]] CapturedObjectId getObjectId(ID3D12RootSignature* rootSignature);
+    [[nodiscard]] CapturedObjectId getObjectId(ID3D12StateObject* stateObject);
+    [[nodiscard]] CapturedAddress resolve(D3D12_GPU_VIRTUAL_ADDRESS address);
+    [[nodiscard]] CapturedAddress resolve(D3D12_CPU_DESCRIPTOR_HANDLE descriptor);
+    [[nodiscard]] CapturedAddress resolve(D3D12_GPU_DESCRIPTOR_HANDLE descriptor);
+
+private:
+    struct TrackedResource
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    struct TrackedDescriptorHeap
+    {
+        CapturedObjectId id = 0;
+        SIZE_T cpuStart = 0;
+        UINT64 gpuStart = 0;
+        UINT descriptorSize = 0;
+        UINT descriptorCount = 0;
+    };
+
+    CapturedObjectId addObject(IUnknown* object, const CapturedObject& capturedObject);
+    CapturedObjectId findObjectId(IUnknown* object) const;
+    CapturedObjectId getObjectIdLocked(ID3D12Resource* resource);
+    CapturedObjectId getObjectIdLocked(ID3D12DescriptorHeap* descriptorHeap);
+    void writeFile();
+
+    CommandCaptureParams mParams;
+    bool mEnabled = false;
+    bool mCapturing = false;
+    uint32_t mFrame = 0;
+
+    std::mutex mMutex;
+    // Holding a reference keeps a destroyed buffer's address range from being reused while the capture is enabled
+    std::unordered_map<ID3D12Resource*, TrackedResource> mResources;
+    // Buffers by the start of their gpu virtual address range
+    std::map<D3D12_GPU_VIRTUAL_ADDRESS, ID3D12Resource*> mBufferAddresses;
+    std::vector<TrackedDescriptorHeap> mDescriptorHeaps;
+    std::unordered_map<IUnknown*, CapturedObjectId> mObjectIds;
+    // Keeps every captured object alive so its address can't be given to another object during the capture
+    std::vector<Microsoft::WRL::ComPtr<IUnknown>> mObjectReferences;
+    CommandCaptureFile mFile;
+};
+
+// Loaded files don't reference any objects, CommandReplayer creates them from the object table
+[[nodiscard]] tl::expected<CommandCaptureFile, CommandCaptureError>
+LoadCommandCaptureFile(const std::filesystem::path& filePath);
+[[nodiscard]] std::optional<CommandCaptureError> SaveCommandCaptureFile(const std::filesystem::path& filePath,
+                                                                       const CommandCaptureFile& file);
+} // namespace scrap::d3d12
+
+namespace scrap
+{
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(d3d12::CapturedObjectType objectType)
+{
+    switch(objectType)
+    {
+    case scrap::d3d12::CapturedObjectType::Resource: return "Resource";
+    case scrap::d3d12::CapturedObjectType::DescriptorHeap: return "DescriptorHeap";
+    case scrap::d3d12::CapturedObjectType::PipelineState: return "PipelineState";
+    case scrap::d3d12::CapturedObjectType::RootSignature: return "RootSignature";
+    case scrap::d3d12::CapturedObjectType::StateObject: return "StateObject";
+    default: return "Unknown CapturedObjectType";
+    }
+}
+
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(d3d12::CommandCaptureError error)
+{
+    switch(error)
+    {
+    case scrap::d3d12::CommandCaptureError::FileOpenFailed: return "FileOpenFailed";
+    case scrap::d3d12::CommandCaptureError::FileWriteFailed: return "FileWriteFailed";
+    case scrap::d3d12::CommandCaptureError::FileReadFailed: return "FileReadFailed";
+    case scrap::d3d12::CommandCaptureError::InvalidFile: return "InvalidFile";
+    case scrap::d3d12::CommandCaptureError::UnsupportedVersion: return "UnsupportedVersion";
+    default: return "Unknown CommandCaptureError";
+    }
+}
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::d3d12::CapturedObjectType>
+    : public scrap::ToStringViewFormatter<scrap::d3d12::CapturedObjectType>
+{};
+
+template<>
+struct fmt::formatter<scrap::d3d12::CommandCaptureError>
+    : public scrap::ToStringViewFormatter<scrap::d3d12::CommandCaptureError>
+{};
@@ -1,6 +1,11 @@
 #include "D3D12CommandList.h"
 
+#include "PerfCounters.h"
+#include "d3d12/D3D12Buffer.h"
 #include "d3d12/D3D12Context.h"
+#include "d3d12/D3D12Texture.h"
+
+#include <algorithm>
 
 #include <d3d12.h>
 
@@ -8,133 +13,395 @@ using namespace Microsoft::WRL;
 
 namespace scrap::d3d12
 {
+namespace
+{
+// Allocators are shared between every command list submitted to the same queue.
+CommandAllocatorPool& GetCommandAllocatorPool(D3D12_COMMAND_LIST_TYPE type)
+{
+    DeviceContext& deviceContext = DeviceContext::instance();
+
+    if(type == D3D12_COMMAND_LIST_TYPE_COPY) { return deviceContext.getCopyContext().getCommandAllocatorPool(); }
+    if(type == D3D12_COMMAND_LIST_TYPE_COMPUTE) { return deviceContext.getComputeContext().getCommandAllocatorPool(); }
+
+    return deviceContext.getGraphicsContext().getCommandAllocatorPool();
+}
+
+uint64_t GetCurrentFenceValue(D3D12_COMMAND_LIST_TYPE type)
+{
+    DeviceContext& deviceContext = DeviceContext::instance();
+
+    if(type == D3D12_COMMAND_LIST_TYPE_COPY) { return *deviceContext.getCopyContext().getCurrentFrameCode(); }
+    if(type == D3D12_COMMAND_LIST_TYPE_COMPUTE) { return *deviceContext.getComputeContext().getCurrentFrameCode(); }
+
+    return *deviceContext.getGraphicsContext().getCurrentFrameCode();
+}
+} // namespace
+
 GraphicsCommandList::GraphicsCommandList(D3D12_COMMAND_LIST_TYPE type, std::string_view debugName)
     : mCommandListType(type)
+    , mDebugName(debugName)
 {
     int wideStrSize = MultiByteToWideChar(CP_UTF8, 0u, debugName.data(), (int)debugName.size(), nullptr, 0);
     mDebugNameBase.resize(wideStrSize);
     MultiByteToWideChar(CP_UTF8, 0u, debugName.data(), (int)debugName.size(), mDebugNameBase.data(),
                         (int)mDebugNameBase.size());
 
-    DeviceContext& deviceContext = DeviceContext::instance();
-    ID3D12Device* device = deviceContext.getDevice();
+    ID3D12Device* device = DeviceContext::instance().getDevice();
+    CommandAllocatorPool& commandAllocatorPool = GetCommandAllocatorPool(type);
 
-    for(uint32_t frameIndex = 0; frameIndex < d3d12::kFrameBufferCount; ++frameIndex)
-    {
-        appendNewAllocator(frameIndex);
-    }
+    // Command lists are created in the recording state and need an allocator for that. It is released right after the
+    // list is closed since nothing was recorded with it.
+    ComPtr<ID3D12CommandAllocator> commandAllocator = commandAllocatorPool.acquire();
+    if(commandAllocator == nullptr) { return; }
 
     // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12device-createcommandlist
-    mFrameIndex = deviceContext.getFrameIndex();
-    HRESULT hr = device->CreateCommandList(0, type, mCommandAllocators[mFrameIndex].front().get(), nullptr,
-                                           IID_PPV_ARGS(&mCommandList));
+    HRESULT hr =
+        device->CreateCommandList(0, type, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&mNativeCommandList));
 
     if(FAILED(hr))
     {
+        commandAllocatorPool.release(std::move(commandAllocator), 0);
         spdlog::critical("Failed to create d3d12 command list");
         return;
     }
 
-    mCommandList->SetName(mDebugNameBase.c_str());
+    mNativeCommandList->SetName(mDebugNameBase.c_str());
+
+    hr = mNativeCommandList->QueryInterface(IID_PPV_ARGS(&mNativeCommandList4));
+
+    mNativeCommandList->Close();
 
-    hr = mCommandList->QueryInterface(IID_PPV_ARGS(&mCommandList4));
+    mCommandList = mNativeCommandList;
+    mCommandList4 = mNativeCommandList4;
 
-    mCommandList->Close();
+    commandAllocatorPool.release(std::move(commandAllocator), 0);
 }
 
 HRESULT GraphicsCommandList::beginRecording()
 {
-    auto& currentCommandAllocatorArray = mCommandAllocators[mFrameIndex];
+    CommandAllocatorPool& commandAllocatorPool = GetCommandAllocatorPool(mCommandListType);
 
-    TrackedGpuObject<ID3D12CommandAllocator>* currentCommandAllocator = nullptr;
-    for(TrackedGpuObject<ID3D12CommandAllocator>& commandAllocator : currentCommandAllocatorArray)
+    // beginRecording without a close in between. Nothing was submitted, so the allocator can go straight back to the
+    // pool once the list stops referencing it.
+    if(mCommandAllocator != nullptr)
     {
-        if(commandAllocator.isInUse(mCommandList.Get())) { continue; }
-
-        currentCommandAllocator = &commandAllocator;
+        mCommandList->Close();
+        commandAllocatorPool.release(std::move(mCommandAllocator), 0);
     }
 
-    if(currentCommandAllocator == nullptr)
-    {
-        appendNewAllocator(mFrameIndex);
-        currentCommandAllocator = &currentCommandAllocatorArray.back();
-    }
+    // The pool only hands out allocators that the gpu is done with, already reset
+    mCommandAllocator = commandAllocatorPool.acquire();
+    if(mCommandAllocator == nullptr) { return E_OUTOFMEMORY; }
 
-    // Command list allocators can only be reset when the associated
-    // command lists have finished execution on the GPU; apps should use
-    // fences to determine GPU execution progress.
-    HRESULT hr = (*currentCommandAllocator)->Reset();
-    if(FAILED(hr)) { return hr; }
+    // Capturing needs the ID3D12GraphicsCommandList4 interface to forward to
+    CommandCapture& commandCapture = DeviceContext::instance().getCommandCapture();
+    mCapturingRecording = commandCapture.isCapturing() && mNativeCommandList4 != nullptr;
 
-    currentCommandAllocator->markAsUsed(mCommandList.Get());
+    if(mCapturingRecording)
+    {
+        if(mCapturingCommandList == nullptr)
+        {
+            mCapturingCommandList = commandCapture.createCapturingCommandList(mNativeCommandList4.Get());
+        }
+
+        mCommandList = mCapturingCommandList;
+        mCommandList4 = mCapturingCommandList;
+    }
+    else
+    {
+        mCommandList = mNativeCommandList;
+        mCommandList4 = mNativeCommandList4;
+    }
 
     // However, when ExecuteCommandList() is called on a particular command
     // list, that command list can then be reset at any time and must be before
     // re-recording.
-    hr = mCommandList->Reset(currentCommandAllocator->get(), nullptr);
+    HRESULT hr = mCommandList->Reset(mCommandAllocator.Get(), nullptr);
     if(FAILED(hr)) { return hr; }
 
+    // Reset puts the command list back in its default state
+    mShadowState = {};
+
+    // Anything tracked from a recording that was never submitted is thrown away
+    mResourceStateTracker.reset();
+
     return S_OK;
 }
 
-HRESULT GraphicsCommandList::execute(ID3D12CommandQueue* commandQueue)
+HRESULT GraphicsCommandList::close()
 {
+    mResourceStateTracker.flush(mCommandList.Get());
+
     HRESULT hr = mCommandList->Close();
+
+    if(mCommandAllocator != nullptr)
+    {
+        GetCommandAllocatorPool(mCommandListType)
+            .release(std::move(mCommandAllocator), GetCurrentFenceValue(mCommandListType));
+    }
+
+    return hr;
+}
+
+HRESULT GraphicsCommandList::execute(ID3D12CommandQueue* commandQueue)
+{
+    HRESULT hr = close();
     if(FAILED(hr)) { return hr; }
 
-    std::array<ID3D12CommandList*, 1> commandLists = {mCommandList.Get()};
-    commandQueue->ExecuteCommandLists((UINT)commandLists.size(), commandLists.data());
+    std::array<ID3D12CommandList*, 2> commandLists;
+    uint32_t commandListCount = 0;
+
+    if(ID3D12CommandList* pendingBarrierCommandList = resolvePendingResourceBarriers())
+    {
+        commandLists[commandListCount++] = pendingBarrierCommandList;
+    }
+
+    commandLists[commandListCount++] = mNativeCommandList.Get();
+    commandQueue->ExecuteCommandLists(commandListCount, commandLists.data());
 
     return S_OK;
 }
 
+ID3D12CommandList* GraphicsCommandList::resolvePendingResourceBarriers()
+{
+    mPendingBarriers.clear();
+    mResourceStateTracker.resolvePendingBarriers(mPendingBarriers);
+
+    if(mCapturingRecording)
+    {
+        CommandCapture& commandCapture = DeviceContext::instance().getCommandCapture();
+        if(!mPendingBarriers.empty())
+        {
+            commandCapture.addResourceBarriers(mCommandListType, mDebugName + " (Pending Barriers)", mPendingBarriers);
+        }
+
+        commandCapture.addCommandList(mCapturingCommandList.Get(), mDebugName);
+        mCapturingRecording = false;
+    }
+
+    if(mPendingBarriers.empty()) { return nullptr; }
+
+    CommandAllocatorPool& commandAllocatorPool = GetCommandAllocatorPool(mCommandListType);
+
+    ComPtr<ID3D12CommandAllocator> commandAllocator = commandAllocatorPool.acquire();
+    if(commandAllocator == nullptr)
+    {
+        spdlog::error("Failed to acquire a command allocator for the pending resource barriers");
+        return nullptr;
+    }
+
+    HRESULT hr;
+    if(mPendingBarrierCommandList == nullptr)
+    {
+        hr = DeviceContext::instance().getDevice()->CreateCommandList(
+            0, mCommandListType, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&mPendingBarrierCommandList));
+
+        if(SUCCEEDED(hr)) { mPendingBarrierCommandList->SetName((mDebugNameBase + L" (Pending Barriers)").c_str()); }
+    }
+    else
+    {
+        hr = mPendingBarrierCommandList->Reset(commandAllocator.Get(), nullptr);
+    }
+
+    if(FAILED(hr))
+    {
+        commandAllocatorPool.release(std::move(commandAllocator), 0);
+        spdlog::error("Failed to record the pending resource barriers");
+        return nullptr;
+    }
+
+    mPendingBarrierCommandList->ResourceBarrier((UINT)mPendingBarriers.size(), mPendingBarriers.data());
+    hr = mPendingBarrierCommandList->Close();
+
+    commandAllocatorPool.release(std::move(commandAllocator), GetCurrentFenceValue(mCommandListType));
+
+    if(FAILED(hr)) { return nullptr; }
+
+    return mPendingBarrierCommandList.Get();
+}
+
 void GraphicsCommandList::endFrame()
 {
-    mFrameIndex = (mFrameIndex + 1) % kFrameBufferCount;
+    PerfCounters::add(PerfCounter::RedundantStateCalls, mRedundantStateCounters.total());
+    mRedundantStateCounters = {};
 }
 
-void GraphicsCommandList::setBindlessResource(uint32_t constantBufferIndex, uint32_t descriptorHeapIndex)
+void GraphicsCommandList::transitionResource(const Buffer& buffer, D3D12_RESOURCE_STATES state)
 {
-    mBindlessChangeBegin = std::min(mBindlessChangeBegin, constantBufferIndex);
-    mBindlessChangeEnd = std::max(mBindlessChangeEnd, constantBufferIndex + 1);
+    mResourceStateTracker.transition(buffer.getGlobalResourceState(), state);
+}
 
-    mBindlessResourceIndices[constantBufferIndex] = descriptorHeapIndex;
+void GraphicsCommandList::transitionResource(const Texture& texture, D3D12_RESOURCE_STATES state, uint32_t subresource)
+{
+    mResourceStateTracker.transition(texture.getGlobalResourceState(), state, subresource);
 }
 
-void GraphicsCommandList::commitBindlessResources()
+void GraphicsCommandList::uavBarrier(const Buffer& buffer)
 {
-    if(mBindlessChangeBegin > mBindlessChangeEnd) { return; }
+    mResourceStateTracker.uavBarrier(buffer.getResource());
+}
 
-    mCommandList->SetGraphicsRoot32BitConstants(
-        d3d12::RasterRootParamSlot::ResourceIndices, mBindlessChangeEnd - mBindlessChangeBegin,
-        mBindlessResourceIndices.data() + mBindlessChangeBegin, mBindlessChangeBegin);
+void GraphicsCommandList::uavBarrier(const Texture& texture)
+{
+    mResourceStateTracker.uavBarrier(texture.getResource());
+}
 
-    mBindlessChangeBegin = d3d12::kMaxBindlessResources;
-    mBindlessChangeEnd = 0;
+void GraphicsCommandList::flushResourceBarriers()
+{
+    mResourceStateTracker.flush(mCommandList.Get());
 }
 
-HRESULT GraphicsCommandList::appendNewAllocator(uint32_t frameIndex)
+void GraphicsCommandList::copyBufferRegion(ID3D12Resource* dstBuffer,
+                                           uint64_t dstOffset,
+                                           ID3D12Resource* srcBuffer,
+                                           uint64_t srcOffset,
+                                           uint64_t byteSize)
 {
-    DeviceContext& deviceContext = DeviceContext::instance();
-    ID3D12Device* device = deviceContext.getDevice();
+    flushResourceBarriers();
+    mCommandList->CopyBufferRegion(dstBuffer, dstOffset, srcBuffer, srcOffset, byteSize);
+}
 
-    ComPtr<ID3D12CommandAllocator> commandAllocator;
-    HRESULT hr = device->CreateCommandAllocator(mCommandListType, IID_PPV_ARGS(&commandAllocator));
+void GraphicsCommandList::setPipelineState(ID3D12PipelineState* pipelineState)
+{
+    if(mShadowState.pipelineState == pipelineState)
+    {
+        ++mRedundantStateCounters.pipelineStates;
+        return;
+    }
 
-    // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12device-createcommandallocator
-    if(FAILED(hr))
+    mCommandList->SetPipelineState(pipelineState);
+    mShadowState.pipelineState = pipelineState;
+
+    // Pipeline states and raytracing state objects replace each other
+    mShadowState.stateObject = nullptr;
+}
+
+void GraphicsCommandList::setPipelineState1(ID3D12StateObject* stateObject)
+{
+    if(mShadowState.stateObject == stateObject)
+    {
+        ++mRedundantStateCounters.pipelineStates;
+        return;
+    }
+
+    mCommandList4->SetPipelineState1(stateObject);
+    mShadowState.stateObject = stateObject;
+    mShadowState.pipelineState = nullptr;
+}
+
+void GraphicsCommandList::setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY primitiveTopology)
+{
+    if(mShadowState.primitiveTopology == primitiveTopology)
     {
-        spdlog::critical("Failed to create d3d12 command allocator");
-        return hr;
+        ++mRedundantStateCounters.primitiveTopologies;
+        return;
     }
 
-    mDebugNameBuffer.clear();
-    fmt::format_to(std::back_inserter(mDebugNameBuffer), L"{} allocator {}[{}]", mDebugNameBase, frameIndex,
-                   mCommandAllocators[frameIndex].size());
-    commandAllocator->SetName(mDebugNameBuffer.c_str());
+    mCommandList->IASetPrimitiveTopology(primitiveTopology);
+    mShadowState.primitiveTopology = primitiveTopology;
+}
 
-    mCommandAllocators[frameIndex].emplace_back(std::move(commandAllocator));
+void GraphicsCommandList::setIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& indexBufferView)
+{
+    const D3D12_INDEX_BUFFER_VIEW& boundView = mShadowState.indexBufferView;
+    if(boundView.BufferLocation == indexBufferView.BufferLocation &&
+       boundView.SizeInBytes == indexBufferView.SizeInBytes && boundView.Format == indexBufferView.Format)
+    {
+        ++mRedundantStateCounters.indexBuffers;
+        return;
+    }
 
-    return S_OK;
+    mCommandList->IASetIndexBuffer(&indexBufferView);
+    mShadowState.indexBufferView = indexBufferView;
+}
+
+void GraphicsCommandList::setGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+    if(mShadowState.graphicsRootSignature == rootSignature)
+    {
+        ++mRedundantStateCounters.rootSignatures;
+        return;
+    }
+
+    mCommandList->SetGraphicsRootSignature(rootSignature);
+    mShadowState.graphicsRootSignature = rootSignature;
+
+    // Changing the root signature clears all of the root arguments
+    // https://docs.microsoft.com/en-us/windows/win32/direct3d12/using-a-root-signature
+    mShadowState.graphicsRootConstants = {};
+}
+
+void GraphicsCommandList::setComputeRootSignature(ID3D12RootSignature* rootSignature)
+{
+    if(mShadowState.computeRootSignature == rootSignature)
+    {
+        ++mRedundantStateCounters.rootSignatures;
+        return;
+    }
+
+    mCommandList->SetComputeRootSignature(rootSignature);
+    mShadowState.computeRootSignature = rootSignature;
+}
+
+void GraphicsCommandList::setDescriptorHeaps(std::span<ID3D12DescriptorHeap* const> descriptorHeaps)
+{
+    if(descriptorHeaps.size() == mShadowState.descriptorHeapCount &&
+       std::equal(descriptorHeaps.begin(), descriptorHeaps.end(), mShadowState.descriptorHeaps.begin()))
+    {
+        ++mRedundantStateCounters.descriptorHeaps;
+        return;
+    }
+
+    mCommandList->SetDescriptorHeaps((UINT)descriptorHeaps.size(), descriptorHeaps.data());
+
+    if(descriptorHeaps.size() <= kMaxShadowedDescriptorHeaps)
+    {
+        std::copy(descriptorHeaps.begin(), descriptorHeaps.end(), mShadowState.descriptorHeaps.begin());
+        mShadowState.descriptorHeapCount = (uint32_t)descriptorHeaps.size();
+    }
+    else
+    {
+        mShadowState.descriptorHeapCount = 0;
+    }
+}
+
+void GraphicsCommandList::setGraphicsRoot32BitConstants(uint32_t rootParameterIndex,
+                                                        std::span<const uint32_t> values,
+                                                        uint32_t destOffsetIn32BitValues)
+{
+    if(rootParameterIndex >= kMaxShadowedRootParameters ||
+       destOffsetIn32BitValues + values.size() > kMaxShadowedRootConstants)
+    {
+        mCommandList->SetGraphicsRoot32BitConstants(rootParameterIndex, (UINT)values.size(), values.data(),
+                                                    destOffsetIn32BitValues);
+        return;
+    }
+
+    ShadowedRootConstants& shadow = mShadowState.graphicsRootConstants[rootParameterIndex];
+
+    // Narrow the call down to the range of constants that actually changed
+    uint32_t changeBegin = (uint32_t)values.size();
+    uint32_t changeEnd = 0;
+
+    for(uint32_t i = 0; i < (uint32_t)values.size(); ++i)
+    {
+        const uint32_t shadowIndex = destOffsetIn32BitValues + i;
+        if(shadow.valid[shadowIndex] && shadow.values[shadowIndex] == values[i]) { continue; }
+
+        changeBegin = std::min(changeBegin, i);
+        changeEnd = i + 1;
+
+        shadow.values[shadowIndex] = values[i];
+        shadow.valid[shadowIndex] = true;
+    }
+
+    if(changeBegin >= changeEnd)
+    {
+        ++mRedundantStateCounters.rootConstants;
+        return;
+    }
+
+    mCommandList->SetGraphicsRoot32BitConstants(rootParameterIndex, changeEnd - changeBegin,
+                                                values.data() + changeBegin, destOffsetIn32BitValues + changeBegin);
 }
 } // namespace scrap::d3d12
@@ -2,15 +2,35 @@
 
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12Fwd.h"
+#include "d3d12/D3D12ResourceStateTracker.h"
 #include "d3d12/D3D12TrackedGpuObject.h"
 
 #include <array>
 #include <span>
+#include <string>
+#include <vector>
 
+#include <d3d12.h>
 #include <wrl/client.h>
 
 namespace scrap::d3d12
 {
+// Number of calls GraphicsCommandList dropped because they would have set state that was already bound.
+struct RedundantStateCounters
+{
+    uint32_t pipelineStates = 0;
+    uint32_t primitiveTopologies = 0;
+    uint32_t indexBuffers = 0;
+    uint32_t rootSignatures = 0;
+    uint32_t descriptorHeaps = 0;
+    uint32_t rootConstants = 0;
+
+    [[nodiscard]] uint32_t total() const
+    {
+        return pipelineStates + primitiveTopologies + indexBuffers + rootSignatures + descriptorHeaps + rootConstants;
+    }
+};
+
 class GraphicsCommandList
 {
 public:
@@ -22,32 +42,106 @@ public:
     GraphicsCommandList& operator=(const GraphicsCommandList&) = delete;
     GraphicsCommandList& operator=(GraphicsCommandList&&) = default;
 
+    // The interface to record through. While a command capture is running this is a capturing command list that
+    // forwards to the real one.
     ID3D12GraphicsCommandList* get() const { return mCommandList.Get(); }
     ID3D12GraphicsCommandList4* get4() const { return mCommandList4.Get(); }
 
+    // The command list to pass to ExecuteCommandLists. Queues only accept the runtime's own command lists.
+    ID3D12GraphicsCommandList* getForSubmission() const { return mNativeCommandList.Get(); }
+
+    // Acquires a command allocator from the queue's CommandAllocatorPool and resets the command list with it. Records
+    // through a capturing command list if the DeviceContext's command capture is capturing the current frame.
     HRESULT beginRecording();
+
+    // Flushes queued barriers, closes the command list and releases its allocator back to the pool with the queue's
+    // current frame code. The command list has to be submitted before the queue's command context ends the frame.
+    HRESULT close();
+
+    // Closes the command list and submits it along with its pending resource barriers
     HRESULT execute(ID3D12CommandQueue* commandQueue);
 
+    // Whoever submits the command list has to call this after close, in submission order. Resolves the first use of
+    // each tracked resource against the resource's global state. If any transitions are needed, they are recorded into
+    // a separate command list that is returned and has to execute right before this one. Returns nullptr otherwise.
+    // Also hands the recorded commands to the command capture, since this is where submission order is known.
+    [[nodiscard]] ID3D12CommandList* resolvePendingResourceBarriers();
+
+    // Adds the state calls skipped since the last endFrame to PerfCounter::RedundantStateCalls
     void endFrame();
 
-    void setBindlessResource(uint32_t constantBufferIndex, uint32_t descriptorHeapIndex);
+    // State setters that keep a shadow copy of what is bound and skip the call when nothing would change. Anything
+    // set through get() directly bypasses the shadow, so use these for the state they cover.
+    void setPipelineState(ID3D12PipelineState* pipelineState);
+    void setPipelineState1(ID3D12StateObject* stateObject);
+    void setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY primitiveTopology);
+    void setIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& indexBufferView);
+    void setGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+    void setComputeRootSignature(ID3D12RootSignature* rootSignature);
+    void setDescriptorHeaps(std::span<ID3D12DescriptorHeap* const> descriptorHeaps);
+    void setGraphicsRoot32BitConstants(uint32_t rootParameterIndex,
+                                       std::span<const uint32_t> values,
+                                       uint32_t destOffsetIn32BitValues = 0);
 
-    [[nodiscard]] std::span<const uint32_t> getBindlessResourceIndices() const { return mBindlessResourceIndices; }
+    // Resource state tracking. Transitions are worked out from the state this command list last left the subresource in
+    // and queued. Queued barriers are recorded with a single ResourceBarrier call by flushResourceBarriers, which
+    // d3d12::drawIndexed, d3d12::dispatchRays, copyBufferRegion and close call before recording anything. Work
+    // recorded through get() directly has to flush first.
+    void transitionResource(const Buffer& buffer, D3D12_RESOURCE_STATES state);
+    void transitionResource(const Texture& texture,
+                            D3D12_RESOURCE_STATES state,
+                            uint32_t subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void uavBarrier(const Buffer& buffer);
+    void uavBarrier(const Texture& texture);
+    void flushResourceBarriers();
 
-    void commitBindlessResources();
+    void copyBufferRegion(ID3D12Resource* dstBuffer,
+                          uint64_t dstOffset,
+                          ID3D12Resource* srcBuffer,
+                          uint64_t srcOffset,
+                          uint64_t byteSize);
 
 private:
-    HRESULT appendNewAllocator(uint32_t frameIndex);
+    static constexpr uint32_t kMaxShadowedRootParameters = 8;
+    static constexpr uint32_t kMaxShadowedRootConstants = 16;
+    static constexpr uint32_t kMaxShadowedDescriptorHeaps = 2;
+
+    struct ShadowedRootConstants
+    {
+        std::array<uint32_t, kMaxShadowedRootConstants> values = {};
+        std::array<bool, kMaxShadowedRootConstants> valid = {};
+    };
+
+    struct ShadowState
+    {
+        ID3D12PipelineState* pipelineState = nullptr;
+        ID3D12StateObject* stateObject = nullptr;
+        D3D_PRIMITIVE_TOPOLOGY primitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+        ID3D12RootSignature* graphicsRootSignature = nullptr;
+        ID3D12RootSignature* computeRootSignature = nullptr;
+        std::array<ID3D12DescriptorHeap*, kMaxShadowedDescriptorHeaps> descriptorHeaps = {};
+        uint32_t descriptorHeapCount = 0;
+        std::array<ShadowedRootConstants, kMaxShadowedRootParameters> graphicsRootConstants;
+    };
 
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> mCommandList4;
-    std::array<std::vector<TrackedGpuObject<ID3D12CommandAllocator>>, kFrameBufferCount> mCommandAllocators;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mNativeCommandList;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> mNativeCommandList4;
+    // Created the first time a recording is captured and kept for later captured recordings
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> mCapturingCommandList;
+    bool mCapturingRecording = false;
+    // Acquired from the queue's CommandAllocatorPool in beginRecording and released back to it in close
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mCommandAllocator;
+    // Records the transitions resolvePendingResourceBarriers finds into their own command list
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mPendingBarrierCommandList;
     D3D12_COMMAND_LIST_TYPE mCommandListType;
-    uint32_t mFrameIndex = 0;
+    std::string mDebugName;
     std::wstring mDebugNameBase;
-    std::wstring mDebugNameBuffer;
-    std::array<uint32_t, d3d12::kMaxBindlessResources> mBindlessResourceIndices;
-    uint32_t mBindlessChangeBegin = d3d12::kMaxBindlessResources;
-    uint32_t mBindlessChangeEnd = 0;
+    ResourceStateTracker mResourceStateTracker;
+    std::vector<D3D12_RESOURCE_BARRIER> mPendingBarriers;
+    ShadowState mShadowState;
+    RedundantStateCounters mRedundantStateCounters;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
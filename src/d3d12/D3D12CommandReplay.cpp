@@ -0,0 +1,1091 @@
+#include "d3d12/D3D12CommandReplay.h"
+
+#include "EnumIterator.h"
+#include "d3d12/D3D12NullDevice.h"
+#include "d3d12/D3D12Strings.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <fmt/chrono.h>
+#include <spdlog/spdlog.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] constexpr size_t GetQueueIndex(D3D12_COMMAND_LIST_TYPE type)
+{
+    switch(type)
+    {
+    case D3D12_COMMAND_LIST_TYPE_COMPUTE: return 1;
+    case D3D12_COMMAND_LIST_TYPE_COPY: return 2;
+    default: return 0;
+    }
+}
+
+[[nodiscard]] constexpr D3D12_COMMAND_LIST_TYPE GetQueueType(size_t queueIndex)
+{
+    switch(queueIndex)
+    {
+    case 1: return D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    case 2: return D3D12_COMMAND_LIST_TYPE_COPY;
+    default: return D3D12_COMMAND_LIST_TYPE_DIRECT;
+    }
+}
+
+// The cheapest a pair of clock reads gets. Taken out of every per command measurement.
+std::chrono::nanoseconds MeasureClockOverhead()
+{
+    constexpr int kSampleCount = 1000;
+
+    Clock::duration overhead = Clock::duration::max();
+    for(int i = 0; i < kSampleCount; ++i)
+    {
+        const Clock::time_point start = Clock::now();
+        const Clock::time_point end = Clock::now();
+        overhead = std::min(overhead, end - start);
+    }
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(overhead);
+}
+
+void CreateNullDescriptors(ID3D12Device* device, ID3D12DescriptorHeap* descriptorHeap)
+{
+    const D3D12_DESCRIPTOR_HEAP_DESC desc = descriptorHeap->GetDesc();
+    const UINT descriptorSize = device->GetDescriptorHandleIncrementSize(desc.Type);
+    D3D12_CPU_DESCRIPTOR_HANDLE descriptor = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
+
+    for(UINT i = 0; i < desc.NumDescriptors; ++i, descriptor.ptr += descriptorSize)
+    {
+        switch(desc.Type)
+        {
+        case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV:
+        {
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srvDesc.Texture2D.MipLevels = 1;
+            device->CreateShaderResourceView(nullptr, &srvDesc, descriptor);
+            break;
+        }
+        case D3D12_DESCRIPTOR_HEAP_TYPE_RTV:
+        {
+            D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+            rtvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+            device->CreateRenderTargetView(nullptr, &rtvDesc, descriptor);
+            break;
+        }
+        case D3D12_DESCRIPTOR_HEAP_TYPE_DSV:
+        {
+            D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+            dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+            dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+            device->CreateDepthStencilView(nullptr, &dsvDesc, descriptor);
+            break;
+        }
+        case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER:
+        {
+            D3D12_SAMPLER_DESC samplerDesc = {};
+            samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+            samplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
+            device->CreateSampler(&samplerDesc, descriptor);
+            break;
+        }
+        default: break;
+        }
+    }
+}
+} // namespace
+
+CommandReplayer::CommandReplayer(ComPtr<ID3D12Device> device): mDevice(std::move(device))
+{
+    mDevice.As(&mDevice5);
+}
+
+CommandReplayer::~CommandReplayer()
+{
+    if(mFence != nullptr && mLastSubmittedQueue != nullptr) { waitForGpu(); }
+    if(mFenceEvent != nullptr) { CloseHandle(mFenceEvent); }
+}
+
+HRESULT CommandReplayer::init(const CommandCaptureFile& file)
+{
+    mFile = &file;
+    mReport.frameCount = file.frameCount;
+    mReport.clockOverhead = MeasureClockOverhead();
+
+    for(size_t queueIndex = 0; queueIndex < mQueues.size(); ++queueIndex)
+    {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = GetQueueType(queueIndex);
+
+        HRESULT hr = mDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mQueues[queueIndex].commandQueue));
+        if(FAILED(hr))
+        {
+            spdlog::error("Failed to create a command queue for the replay. {}", HRESULT_t(hr));
+            return hr;
+        }
+    }
+
+    mCommandAllocators.resize(file.commandLists.size());
+    for(size_t i = 0; i < file.commandLists.size(); ++i)
+    {
+        HRESULT hr = mDevice->CreateCommandAllocator(file.commandLists[i].type, IID_PPV_ARGS(&mCommandAllocators[i]));
+        if(FAILED(hr))
+        {
+            spdlog::error("Failed to create a command allocator for the replay. {}", HRESULT_t(hr));
+            return hr;
+        }
+    }
+
+    HRESULT hr = mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence));
+    if(FAILED(hr))
+    {
+        spdlog::error("Failed to create the replay fence. {}", HRESULT_t(hr));
+        return hr;
+    }
+
+    mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if(mFenceEvent == nullptr) { return HRESULT_FROM_WIN32(GetLastError()); }
+
+    return createObjects();
+}
+
+HRESULT CommandReplayer::createObjects()
+{
+    // Only the null device accepts these. Real devices need the shaders the objects were created with.
+    constexpr std::array<uint32_t, 1> kPlaceholderRootSignatureBlob = {0};
+
+    mObjects.resize(mFile->objects.size());
+    mDescriptorHeaps.resize(mFile->objects.size());
+
+    for(size_t i = 0; i < mFile->objects.size(); ++i)
+    {
+        const CapturedObject& object = mFile->objects[i];
+        HRESULT hr = E_FAIL;
+
+        switch(object.type)
+        {
+        case CapturedObjectType::Resource:
+        {
+            // Custom heaps depend on the adapter's memory architecture
+            D3D12_HEAP_PROPERTIES heapProperties = {};
+            heapProperties.Type = object.heapType;
+            if(heapProperties.Type == D3D12_HEAP_TYPE_CUSTOM) { heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT; }
+
+            // Upload and readback heaps only allow one state
+            D3D12_RESOURCE_STATES initialState = object.initialState;
+            if(heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD) { initialState = D3D12_RESOURCE_STATE_GENERIC_READ; }
+            if(heapProperties.Type == D3D12_HEAP_TYPE_READBACK) { initialState = D3D12_RESOURCE_STATE_COPY_DEST; }
+
+            ComPtr<ID3D12Resource> resource;
+            hr = mDevice->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &object.resourceDesc,
+                                                  initialState, nullptr, IID_PPV_ARGS(&resource));
+            mObjects[i] = resource;
+            break;
+        }
+        case CapturedObjectType::DescriptorHeap:
+        {
+            ComPtr<ID3D12DescriptorHeap> descriptorHeap;
+            hr = mDevice->CreateDescriptorHeap(&object.descriptorHeapDesc, IID_PPV_ARGS(&descriptorHeap));
+            if(FAILED(hr)) { break; }
+
+            CreateNullDescriptors(mDevice.Get(), descriptorHeap.Get());
+
+            DescriptorHeapState& heapState = mDescriptorHeaps[i];
+            heapState.cpuStart = descriptorHeap->GetCPUDescriptorHandleForHeapStart().ptr;
+            heapState.descriptorSize = mDevice->GetDescriptorHandleIncrementSize(object.descriptorHeapDesc.Type);
+            if((object.descriptorHeapDesc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0)
+            {
+                heapState.gpuStart = descriptorHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+            }
+
+            mObjects[i] = descriptorHeap;
+            break;
+        }
+        case CapturedObjectType::PipelineState:
+        {
+            const D3D12_COMPUTE_PIPELINE_STATE_DESC desc = {};
+            ComPtr<ID3D12PipelineState> pipelineState;
+            hr = mDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+            mObjects[i] = pipelineState;
+            break;
+        }
+        case CapturedObjectType::RootSignature:
+        {
+            ComPtr<ID3D12RootSignature> rootSignature;
+            hr = mDevice->CreateRootSignature(0, kPlaceholderRootSignatureBlob.data(),
+                                              sizeof(kPlaceholderRootSignatureBlob), IID_PPV_ARGS(&rootSignature));
+            mObjects[i] = rootSignature;
+            break;
+        }
+        case CapturedObjectType::StateObject:
+        {
+            if(mDevice5 == nullptr) { break; }
+
+            const D3D12_STATE_OBJECT_DESC desc = {D3D12_STATE_OBJECT_TYPE_RAYTRACING_PIPELINE, 0, nullptr};
+            ComPtr<ID3D12StateObject> stateObject;
+            hr = mDevice5->CreateStateObject(&desc, IID_PPV_ARGS(&stateObject));
+            mObjects[i] = stateObject;
+            break;
+        }
+        default: break;
+        }
+
+        if(FAILED(hr))
+        {
+            mObjects[i] = nullptr;
+            ++mReport.failedObjectCount;
+        }
+    }
+
+    if(mReport.failedObjectCount > 0)
+    {
+        spdlog::warn("{} of the capture's {} objects couldn't be created. Commands that use them will be skipped",
+                     mReport.failedObjectCount, mFile->objects.size());
+    }
+
+    return S_OK;
+}
+
+HRESULT CommandReplayer::replay(uint32_t iterationCount)
+{
+    if(mFile == nullptr) { return E_FAIL; }
+
+    const Clock::time_point start = Clock::now();
+    const uint32_t commandListCount = (uint32_t)mFile->commandLists.size();
+
+    for(uint32_t iteration = 0; iteration < iterationCount; ++iteration)
+    {
+        // Command lists are stored in submission order, so every frame's command lists are next to each other
+        uint32_t firstCommandList = 0;
+        while(firstCommandList < commandListCount)
+        {
+            const uint32_t frame = mFile->commandLists[firstCommandList].frame;
+
+            uint32_t endCommandList = firstCommandList + 1;
+            while(endCommandList < commandListCount && mFile->commandLists[endCommandList].frame == frame)
+            {
+                ++endCommandList;
+            }
+
+            HRESULT hr = replayFrame(firstCommandList, endCommandList - firstCommandList);
+            if(FAILED(hr)) { return hr; }
+
+            firstCommandList = endCommandList;
+        }
+
+        ++mReport.iterationCount;
+    }
+
+    mReport.totalTime += Clock::now() - start;
+    return S_OK;
+}
+
+HRESULT CommandReplayer::replayFrame(uint32_t firstCommandList, uint32_t commandListCount)
+{
+    for(uint32_t i = firstCommandList; i < firstCommandList + commandListCount; ++i)
+    {
+        HRESULT hr = replayCommandList(i);
+        if(FAILED(hr)) { return hr; }
+    }
+
+    return waitForGpu();
+}
+
+HRESULT CommandReplayer::replayCommandList(uint32_t commandListIndex)
+{
+    const CapturedCommandList& capturedCommandList = mFile->commandLists[commandListIndex];
+    QueueState& queue = mQueues[GetQueueIndex(capturedCommandList.type)];
+    ID3D12CommandAllocator* commandAllocator = mCommandAllocators[commandListIndex].Get();
+
+    Clock::time_point start = Clock::now();
+
+    // The allocator was last used by the previous iteration, which has finished on the gpu
+    HRESULT hr = commandAllocator->Reset();
+    if(FAILED(hr)) { return hr; }
+
+    if(queue.commandList == nullptr)
+    {
+        hr = mDevice->CreateCommandList(0, capturedCommandList.type, commandAllocator, nullptr,
+                                        IID_PPV_ARGS(&queue.commandList));
+    }
+    else
+    {
+        hr = queue.commandList->Reset(commandAllocator, nullptr);
+    }
+
+    if(FAILED(hr))
+    {
+        spdlog::error("Failed to reset the replay command list for '{}'. {}", capturedCommandList.name, HRESULT_t(hr));
+        return hr;
+    }
+
+    Clock::time_point end = Clock::now();
+    mReport.resetTime += end - start;
+    start = end;
+
+    mBindingState = {};
+
+    capturedCommandList.stream.forEach([&](CommandType type, std::span<const std::byte> payload) {
+        CommandTypeReplayStatistics& statistics = mReport.commandTypes[type];
+
+        const Clock::time_point commandStart = Clock::now();
+        const bool replayed = replayCommand(type, payload, queue.commandList.Get());
+        const Clock::time_point commandEnd = Clock::now();
+
+        ++statistics.count;
+        statistics.recordTime += std::max(
+            std::chrono::nanoseconds(0),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(commandEnd - commandStart) - mReport.clockOverhead);
+
+        if(!replayed)
+        {
+            ++statistics.skippedCount;
+            ++mReport.skippedCommandCount;
+        }
+    });
+
+    end = Clock::now();
+    mReport.recordTime += end - start;
+    mReport.commandCount += capturedCommandList.stream.getCommandCount();
+    ++mReport.commandListCount;
+    start = end;
+
+    hr = queue.commandList->Close();
+    if(FAILED(hr))
+    {
+        spdlog::error("Failed to close the replay command list for '{}'. {}", capturedCommandList.name, HRESULT_t(hr));
+        return hr;
+    }
+
+    end = Clock::now();
+    mReport.closeTime += end - start;
+    start = end;
+
+    // Queue waits weren't captured. Waiting on whatever was submitted last keeps every dependency.
+    if(mLastSubmittedQueue != nullptr && mLastSubmittedQueue != queue.commandQueue.Get())
+    {
+        ++mFenceValue;
+        mLastSubmittedQueue->Signal(mFence.Get(), mFenceValue);
+        queue.commandQueue->Wait(mFence.Get(), mFenceValue);
+    }
+
+    ID3D12CommandList* commandLists[] = {queue.commandList.Get()};
+    queue.commandQueue->ExecuteCommandLists(1, commandLists);
+    mLastSubmittedQueue = queue.commandQueue.Get();
+
+    mReport.executeTime += Clock::now() - start;
+    return S_OK;
+}
+
+HRESULT CommandReplayer::waitForGpu()
+{
+    if(mLastSubmittedQueue == nullptr) { return S_OK; }
+
+    const Clock::time_point start = Clock::now();
+
+    ++mFenceValue;
+    HRESULT hr = mLastSubmittedQueue->Signal(mFence.Get(), mFenceValue);
+    if(FAILED(hr)) { return hr; }
+
+    if(mFence->GetCompletedValue() < mFenceValue)
+    {
+        hr = mFence->SetEventOnCompletion(mFenceValue, mFenceEvent);
+        if(FAILED(hr)) { return hr; }
+
+        WaitForSingleObject(mFenceEvent, INFINITE);
+    }
+
+    mReport.gpuWaitTime += Clock::now() - start;
+    return S_OK;
+}
+
+bool CommandReplayer::replayCommand(CommandType type,
+                                    std::span<const std::byte> payload,
+                                    ID3D12GraphicsCommandList4* commandList)
+{
+    CommandPayloadReader reader(payload);
+    mCommandValid = true;
+
+    // Arguments are read into locals first. The order function arguments are evaluated in isn't specified.
+    auto canRecord = [&](bool bindingsValid = true) { return bindingsValid && mCommandValid && !reader.hasOverrun(); };
+
+    switch(type)
+    {
+    case CommandType::ClearState:
+    {
+        ID3D12PipelineState* pipelineState =
+            getObject<ID3D12PipelineState>(reader.read<CapturedObjectId>(), CapturedObjectType::PipelineState);
+        if(!canRecord()) { return false; }
+
+        commandList->ClearState(pipelineState);
+        mBindingState = {};
+        return true;
+    }
+    case CommandType::DrawInstanced:
+    {
+        const UINT vertexCountPerInstance = reader.read<UINT>();
+        const UINT instanceCount = reader.read<UINT>();
+        const UINT startVertexLocation = reader.read<UINT>();
+        const UINT startInstanceLocation = reader.read<UINT>();
+        if(!canRecord(mBindingState.graphicsRootSignatureValid && mBindingState.pipelineStateValid)) { return false; }
+
+        commandList->DrawInstanced(vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+        return true;
+    }
+    case CommandType::DrawIndexedInstanced:
+    {
+        const UINT indexCountPerInstance = reader.read<UINT>();
+        const UINT instanceCount = reader.read<UINT>();
+        const UINT startIndexLocation = reader.read<UINT>();
+        const INT baseVertexLocation = reader.read<INT>();
+        const UINT startInstanceLocation = reader.read<UINT>();
+        if(!canRecord(mBindingState.graphicsRootSignatureValid && mBindingState.pipelineStateValid)) { return false; }
+
+        commandList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+                                          startInstanceLocation);
+        return true;
+    }
+    case CommandType::Dispatch:
+    {
+        const UINT threadGroupCountX = reader.read<UINT>();
+        const UINT threadGroupCountY = reader.read<UINT>();
+        const UINT threadGroupCountZ = reader.read<UINT>();
+        if(!canRecord(mBindingState.computeRootSignatureValid && mBindingState.pipelineStateValid)) { return false; }
+
+        commandList->Dispatch(threadGroupCountX, threadGroupCountY, threadGroupCountZ);
+        return true;
+    }
+    case CommandType::CopyBufferRegion:
+    {
+        ID3D12Resource* dstBuffer = getResource(reader.read<CapturedObjectId>());
+        const UINT64 dstOffset = reader.read<UINT64>();
+        ID3D12Resource* srcBuffer = getResource(reader.read<CapturedObjectId>());
+        const UINT64 srcOffset = reader.read<UINT64>();
+        const UINT64 numBytes = reader.read<UINT64>();
+        if(!canRecord()) { return false; }
+
+        commandList->CopyBufferRegion(dstBuffer, dstOffset, srcBuffer, srcOffset, numBytes);
+        return true;
+    }
+    case CommandType::CopyTextureRegion:
+    {
+        const D3D12_TEXTURE_COPY_LOCATION dst = getCopyLocation(reader.read<CapturedTextureCopyLocation>());
+        const UINT dstX = reader.read<UINT>();
+        const UINT dstY = reader.read<UINT>();
+        const UINT dstZ = reader.read<UINT>();
+        const D3D12_TEXTURE_COPY_LOCATION src = getCopyLocation(reader.read<CapturedTextureCopyLocation>());
+        const bool hasSrcBox = reader.read<uint32_t>() != 0;
+        const D3D12_BOX srcBox = hasSrcBox ? reader.read<D3D12_BOX>() : D3D12_BOX{};
+        if(!canRecord()) { return false; }
+
+        commandList->CopyTextureRegion(&dst, dstX, dstY, dstZ, &src, hasSrcBox ? &srcBox : nullptr);
+        return true;
+    }
+    case CommandType::CopyResource:
+    {
+        ID3D12Resource* dstResource = getResource(reader.read<CapturedObjectId>());
+        ID3D12Resource* srcResource = getResource(reader.read<CapturedObjectId>());
+        if(!canRecord()) { return false; }
+
+        commandList->CopyResource(dstResource, srcResource);
+        return true;
+    }
+    case CommandType::IASetPrimitiveTopology:
+    {
+        const D3D12_PRIMITIVE_TOPOLOGY primitiveTopology = reader.read<D3D12_PRIMITIVE_TOPOLOGY>();
+        if(!canRecord()) { return false; }
+
+        commandList->IASetPrimitiveTopology(primitiveTopology);
+        return true;
+    }
+    case CommandType::RSSetViewports:
+    {
+        reader.read(mViewportBuffer, reader.read<uint32_t>());
+        if(!canRecord()) { return false; }
+
+        commandList->RSSetViewports((UINT)mViewportBuffer.size(), mViewportBuffer.data());
+        return true;
+    }
+    case CommandType::RSSetScissorRects:
+    {
+        reader.read(mRectBuffer, reader.read<uint32_t>());
+        if(!canRecord()) { return false; }
+
+        commandList->RSSetScissorRects((UINT)mRectBuffer.size(), mRectBuffer.data());
+        return true;
+    }
+    case CommandType::OMSetBlendFactor:
+    {
+        const std::array<FLOAT, 4> blendFactor = reader.read<std::array<FLOAT, 4>>();
+        if(!canRecord()) { return false; }
+
+        commandList->OMSetBlendFactor(blendFactor.data());
+        return true;
+    }
+    case CommandType::OMSetStencilRef:
+    {
+        const UINT stencilRef = reader.read<UINT>();
+        if(!canRecord()) { return false; }
+
+        commandList->OMSetStencilRef(stencilRef);
+        return true;
+    }
+    case CommandType::SetPipelineState:
+    {
+        ID3D12PipelineState* pipelineState =
+            getObject<ID3D12PipelineState>(reader.read<CapturedObjectId>(), CapturedObjectType::PipelineState);
+        mBindingState.pipelineStateValid = canRecord();
+        if(!mBindingState.pipelineStateValid) { return false; }
+
+        commandList->SetPipelineState(pipelineState);
+        return true;
+    }
+    case CommandType::ResourceBarrier:
+    {
+        reader.read(mCapturedBarrierBuffer, reader.read<uint32_t>());
+
+        mBarrierBuffer.clear();
+        for(const CapturedResourceBarrier& capturedBarrier : mCapturedBarrierBuffer)
+        {
+            D3D12_RESOURCE_BARRIER& barrier = mBarrierBuffer.emplace_back();
+            barrier.Type = capturedBarrier.type;
+            barrier.Flags = capturedBarrier.flags;
+
+            switch(capturedBarrier.type)
+            {
+            case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+                barrier.Transition.pResource = getResource(capturedBarrier.resource);
+                barrier.Transition.Subresource = capturedBarrier.subresource;
+                barrier.Transition.StateBefore = capturedBarrier.stateBefore;
+                barrier.Transition.StateAfter = capturedBarrier.stateAfter;
+                break;
+            case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+                barrier.Aliasing.pResourceBefore = getResource(capturedBarrier.resource);
+                barrier.Aliasing.pResourceAfter = getResource(capturedBarrier.resourceAfter);
+                break;
+            case D3D12_RESOURCE_BARRIER_TYPE_UAV: barrier.UAV.pResource = getResource(capturedBarrier.resource); break;
+            default: break;
+            }
+        }
+
+        if(!canRecord()) { return false; }
+
+        commandList->ResourceBarrier((UINT)mBarrierBuffer.size(), mBarrierBuffer.data());
+        return true;
+    }
+    case CommandType::SetDescriptorHeaps:
+    {
+        reader.read(mObjectIdBuffer, reader.read<uint32_t>());
+
+        mDescriptorHeapBuffer.clear();
+        for(CapturedObjectId heapId : mObjectIdBuffer)
+        {
+            mDescriptorHeapBuffer.push_back(getDescriptorHeap(heapId));
+        }
+
+        if(!canRecord()) { return false; }
+
+        commandList->SetDescriptorHeaps((UINT)mDescriptorHeapBuffer.size(), mDescriptorHeapBuffer.data());
+        return true;
+    }
+    case CommandType::SetComputeRootSignature:
+    {
+        ID3D12RootSignature* rootSignature =
+            getObject<ID3D12RootSignature>(reader.read<CapturedObjectId>(), CapturedObjectType::RootSignature);
+        mBindingState.computeRootSignatureValid = canRecord();
+        if(!mBindingState.computeRootSignatureValid) { return false; }
+
+        commandList->SetComputeRootSignature(rootSignature);
+        return true;
+    }
+    case CommandType::SetGraphicsRootSignature:
+    {
+        ID3D12RootSignature* rootSignature =
+            getObject<ID3D12RootSignature>(reader.read<CapturedObjectId>(), CapturedObjectType::RootSignature);
+        mBindingState.graphicsRootSignatureValid = canRecord();
+        if(!mBindingState.graphicsRootSignatureValid) { return false; }
+
+        commandList->SetGraphicsRootSignature(rootSignature);
+        return true;
+    }
+    case CommandType::SetComputeRootDescriptorTable:
+    case CommandType::SetGraphicsRootDescriptorTable:
+    {
+        const UINT rootParameterIndex = reader.read<UINT>();
+        const D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor = getGpuDescriptor(reader.read<CapturedAddress>());
+
+        if(type == CommandType::SetComputeRootDescriptorTable)
+        {
+            if(!canRecord(mBindingState.computeRootSignatureValid)) { return false; }
+            commandList->SetComputeRootDescriptorTable(rootParameterIndex, baseDescriptor);
+        }
+        else
+        {
+            if(!canRecord(mBindingState.graphicsRootSignatureValid)) { return false; }
+            commandList->SetGraphicsRootDescriptorTable(rootParameterIndex, baseDescriptor);
+        }
+
+        return true;
+    }
+    case CommandType::SetComputeRoot32BitConstant:
+    case CommandType::SetGraphicsRoot32BitConstant:
+    {
+        const UINT rootParameterIndex = reader.read<UINT>();
+        const UINT srcData = reader.read<UINT>();
+        const UINT destOffsetIn32BitValues = reader.read<UINT>();
+
+        if(type == CommandType::SetComputeRoot32BitConstant)
+        {
+            if(!canRecord(mBindingState.computeRootSignatureValid)) { return false; }
+            commandList->SetComputeRoot32BitConstant(rootParameterIndex, srcData, destOffsetIn32BitValues);
+        }
+        else
+        {
+            if(!canRecord(mBindingState.graphicsRootSignatureValid)) { return false; }
+            commandList->SetGraphicsRoot32BitConstant(rootParameterIndex, srcData, destOffsetIn32BitValues);
+        }
+
+        return true;
+    }
+    case CommandType::SetComputeRoot32BitConstants:
+    case CommandType::SetGraphicsRoot32BitConstants:
+    {
+        const UINT rootParameterIndex = reader.read<UINT>();
+        const UINT destOffsetIn32BitValues = reader.read<UINT>();
+        reader.read(mValueBuffer, reader.read<uint32_t>());
+
+        if(type == CommandType::SetComputeRoot32BitConstants)
+        {
+            if(!canRecord(mBindingState.computeRootSignatureValid)) { return false; }
+            commandList->SetComputeRoot32BitConstants(rootParameterIndex, (UINT)mValueBuffer.size(),
+                                                      mValueBuffer.data(), destOffsetIn32BitValues);
+        }
+        else
+        {
+            if(!canRecord(mBindingState.graphicsRootSignatureValid)) { return false; }
+            commandList->SetGraphicsRoot32BitConstants(rootParameterIndex, (UINT)mValueBuffer.size(),
+                                                       mValueBuffer.data(), destOffsetIn32BitValues);
+        }
+
+        return true;
+    }
+    case CommandType::SetComputeRootConstantBufferView:
+    case CommandType::SetComputeRootShaderResourceView:
+    case CommandType::SetComputeRootUnorderedAccessView:
+    {
+        const UINT rootParameterIndex = reader.read<UINT>();
+        const D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = getGpuAddress(reader.read<CapturedAddress>());
+        if(!canRecord(mBindingState.computeRootSignatureValid)) { return false; }
+
+        if(type == CommandType::SetComputeRootConstantBufferView)
+        {
+            commandList->SetComputeRootConstantBufferView(rootParameterIndex, bufferLocation);
+        }
+        else if(type == CommandType::SetComputeRootShaderResourceView)
+        {
+            commandList->SetComputeRootShaderResourceView(rootParameterIndex, bufferLocation);
+        }
+        else
+        {
+            commandList->SetComputeRootUnorderedAccessView(rootParameterIndex, bufferLocation);
+        }
+
+        return true;
+    }
+    case CommandType::SetGraphicsRootConstantBufferView:
+    case CommandType::SetGraphicsRootShaderResourceView:
+    case CommandType::SetGraphicsRootUnorderedAccessView:
+    {
+        const UINT rootParameterIndex = reader.read<UINT>();
+        const D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = getGpuAddress(reader.read<CapturedAddress>());
+        if(!canRecord(mBindingState.graphicsRootSignatureValid)) { return false; }
+
+        if(type == CommandType::SetGraphicsRootConstantBufferView)
+        {
+            commandList->SetGraphicsRootConstantBufferView(rootParameterIndex, bufferLocation);
+        }
+        else if(type == CommandType::SetGraphicsRootShaderResourceView)
+        {
+            commandList->SetGraphicsRootShaderResourceView(rootParameterIndex, bufferLocation);
+        }
+        else
+        {
+            commandList->SetGraphicsRootUnorderedAccessView(rootParameterIndex, bufferLocation);
+        }
+
+        return true;
+    }
+    case CommandType::IASetIndexBuffer:
+    {
+        const bool hasView = reader.read<uint32_t>() != 0;
+        const CapturedIndexBufferView capturedView = reader.read<CapturedIndexBufferView>();
+
+        D3D12_INDEX_BUFFER_VIEW view = {};
+        view.BufferLocation = getGpuAddress(capturedView.bufferLocation);
+        view.SizeInBytes = capturedView.sizeInBytes;
+        view.Format = capturedView.format;
+        if(!canRecord()) { return false; }
+
+        commandList->IASetIndexBuffer(hasView ? &view : nullptr);
+        return true;
+    }
+    case CommandType::IASetVertexBuffers:
+    {
+        const UINT startSlot = reader.read<UINT>();
+        reader.read(mCapturedVertexBufferViewBuffer, reader.read<uint32_t>());
+
+        mVertexBufferViewBuffer.clear();
+        for(const CapturedVertexBufferView& capturedView : mCapturedVertexBufferViewBuffer)
+        {
+            mVertexBufferViewBuffer.push_back(D3D12_VERTEX_BUFFER_VIEW{
+                getGpuAddress(capturedView.bufferLocation), capturedView.sizeInBytes, capturedView.strideInBytes});
+        }
+
+        if(!canRecord()) { return false; }
+
+        commandList->IASetVertexBuffers(startSlot, (UINT)mVertexBufferViewBuffer.size(),
+                                        mVertexBufferViewBuffer.empty() ? nullptr : mVertexBufferViewBuffer.data());
+        return true;
+    }
+    case CommandType::OMSetRenderTargets:
+    {
+        const UINT numRenderTargetDescriptors = reader.read<UINT>();
+        const BOOL singleHandleToDescriptorRange = reader.read<BOOL>();
+        const bool hasDepthStencil = reader.read<uint32_t>() != 0;
+        const D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = getCpuDescriptor(reader.read<CapturedAddress>());
+        reader.read(mAddressBuffer, reader.read<uint32_t>());
+
+        mDescriptorBuffer.clear();
+        for(const CapturedAddress& renderTarget : mAddressBuffer)
+        {
+            mDescriptorBuffer.push_back(getCpuDescriptor(renderTarget));
+        }
+
+        if(!canRecord()) { return false; }
+
+        commandList->OMSetRenderTargets(numRenderTargetDescriptors,
+                                        mDescriptorBuffer.empty() ? nullptr : mDescriptorBuffer.data(),
+                                        singleHandleToDescriptorRange, hasDepthStencil ? &depthStencil : nullptr);
+        return true;
+    }
+    case CommandType::ClearDepthStencilView:
+    {
+        const D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView = getCpuDescriptor(reader.read<CapturedAddress>());
+        const D3D12_CLEAR_FLAGS clearFlags = reader.read<D3D12_CLEAR_FLAGS>();
+        const FLOAT depth = reader.read<FLOAT>();
+        const UINT8 stencil = reader.read<UINT8>();
+        reader.read(mRectBuffer, reader.read<uint32_t>());
+        if(!canRecord()) { return false; }
+
+        commandList->ClearDepthStencilView(depthStencilView, clearFlags, depth, stencil, (UINT)mRectBuffer.size(),
+                                           mRectBuffer.empty() ? nullptr : mRectBuffer.data());
+        return true;
+    }
+    case CommandType::ClearRenderTargetView:
+    {
+        const D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView = getCpuDescriptor(reader.read<CapturedAddress>());
+        const std::array<FLOAT, 4> color = reader.read<std::array<FLOAT, 4>>();
+        reader.read(mRectBuffer, reader.read<uint32_t>());
+        if(!canRecord()) { return false; }
+
+        commandList->ClearRenderTargetView(renderTargetView, color.data(), (UINT)mRectBuffer.size(),
+                                           mRectBuffer.empty() ? nullptr : mRectBuffer.data());
+        return true;
+    }
+    case CommandType::SetMarker:
+    case CommandType::BeginEvent:
+    {
+        const UINT metadata = reader.read<UINT>();
+        reader.read(mByteBuffer, reader.read<uint32_t>());
+        if(!canRecord()) { return false; }
+
+        if(type == CommandType::SetMarker)
+        {
+            commandList->SetMarker(metadata, mByteBuffer.data(), (UINT)mByteBuffer.size());
+        }
+        else
+        {
+            commandList->BeginEvent(metadata, mByteBuffer.data(), (UINT)mByteBuffer.size());
+        }
+
+        return true;
+    }
+    case CommandType::EndEvent:
+    {
+        commandList->EndEvent();
+        return true;
+    }
+    case CommandType::BuildRaytracingAccelerationStructure:
+    {
+        const CapturedAccelerationStructureBuild build = reader.read<CapturedAccelerationStructureBuild>();
+        reader.read(mCapturedGeometryBuffer, reader.read<uint32_t>());
+        reader.read(mCapturedPostbuildInfoBuffer, reader.read<uint32_t>());
+
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc = {};
+        desc.DestAccelerationStructureData = getGpuAddress(build.destAccelerationStructureData);
+        desc.SourceAccelerationStructureData = getGpuAddress(build.sourceAccelerationStructureData);
+        desc.ScratchAccelerationStructureData = getGpuAddress(build.scratchAccelerationStructureData);
+        desc.Inputs.Type = build.type;
+        desc.Inputs.Flags = build.flags;
+        desc.Inputs.NumDescs = build.descCount;
+        desc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+
+        if(build.type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL)
+        {
+            desc.Inputs.InstanceDescs = getGpuAddress(build.instanceDescs);
+        }
+        else
+        {
+            mGeometryBuffer.clear();
+            for(const CapturedGeometryDesc& capturedDesc : mCapturedGeometryBuffer)
+            {
+                D3D12_RAYTRACING_GEOMETRY_DESC& geometryDesc = mGeometryBuffer.emplace_back();
+                geometryDesc.Type = capturedDesc.type;
+                geometryDesc.Flags = capturedDesc.flags;
+
+                if(capturedDesc.type == D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES)
+                {
+                    geometryDesc.Triangles.Transform3x4 = getGpuAddress(capturedDesc.transform3x4);
+                    geometryDesc.Triangles.IndexFormat = capturedDesc.indexFormat;
+                    geometryDesc.Triangles.VertexFormat = capturedDesc.vertexFormat;
+                    geometryDesc.Triangles.IndexCount = capturedDesc.indexCount;
+                    geometryDesc.Triangles.VertexCount = capturedDesc.vertexCount;
+                    geometryDesc.Triangles.IndexBuffer = getGpuAddress(capturedDesc.indexBuffer);
+                    geometryDesc.Triangles.VertexBuffer.StartAddress = getGpuAddress(capturedDesc.vertexBuffer);
+                    geometryDesc.Triangles.VertexBuffer.StrideInBytes = capturedDesc.vertexStride;
+                }
+                else
+                {
+                    geometryDesc.AABBs.AABBCount = capturedDesc.aabbCount;
+                    geometryDesc.AABBs.AABBs.StartAddress = getGpuAddress(capturedDesc.vertexBuffer);
+                    geometryDesc.AABBs.AABBs.StrideInBytes = capturedDesc.vertexStride;
+                }
+            }
+
+            desc.Inputs.NumDescs = (UINT)mGeometryBuffer.size();
+            desc.Inputs.pGeometryDescs = mGeometryBuffer.data();
+        }
+
+        mPostbuildInfoBuffer.clear();
+        for(const CapturedPostbuildInfoDesc& capturedDesc : mCapturedPostbuildInfoBuffer)
+        {
+            mPostbuildInfoBuffer.push_back(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC{
+                getGpuAddress(capturedDesc.destBuffer), capturedDesc.infoType});
+        }
+
+        if(!canRecord()) { return false; }
+
+        commandList->BuildRaytracingAccelerationStructure(&desc, (UINT)mPostbuildInfoBuffer.size(),
+                                                          mPostbuildInfoBuffer.empty() ? nullptr
+                                                                                       : mPostbuildInfoBuffer.data());
+        return true;
+    }
+    case CommandType::SetPipelineState1:
+    {
+        ID3D12StateObject* stateObject =
+            getObject<ID3D12StateObject>(reader.read<CapturedObjectId>(), CapturedObjectType::StateObject);
+        mBindingState.stateObjectValid = canRecord();
+        if(!mBindingState.stateObjectValid) { return false; }
+
+        commandList->SetPipelineState1(stateObject);
+        return true;
+    }
+    case CommandType::DispatchRays:
+    {
+        const CapturedDispatchRaysDesc capturedDesc = reader.read<CapturedDispatchRaysDesc>();
+
+        D3D12_DISPATCH_RAYS_DESC desc = {};
+        desc.RayGenerationShaderRecord.StartAddress =
+            getGpuAddress(capturedDesc.rayGenerationShaderRecord.startAddress);
+        desc.RayGenerationShaderRecord.SizeInBytes = capturedDesc.rayGenerationShaderRecord.sizeInBytes;
+        desc.MissShaderTable = getShaderTable(capturedDesc.missShaderTable);
+        desc.HitGroupTable = getShaderTable(capturedDesc.hitGroupTable);
+        desc.CallableShaderTable = getShaderTable(capturedDesc.callableShaderTable);
+        desc.Width = capturedDesc.width;
+        desc.Height = capturedDesc.height;
+        desc.Depth = capturedDesc.depth;
+        if(!canRecord(mBindingState.computeRootSignatureValid && mBindingState.stateObjectValid)) { return false; }
+
+        commandList->DispatchRays(&desc);
+        return true;
+    }
+    default:
+        // Captured without arguments
+        return false;
+    }
+}
+
+template<class T>
+T* CommandReplayer::getObject(CapturedObjectId id, CapturedObjectType type)
+{
+    if(id == 0) { return nullptr; }
+
+    if(id > mObjects.size() || mFile->objects[id - 1].type != type || mObjects[id - 1] == nullptr)
+    {
+        mCommandValid = false;
+        return nullptr;
+    }
+
+    return static_cast<T*>(mObjects[id - 1].Get());
+}
+
+ID3D12Resource* CommandReplayer::getResource(CapturedObjectId id)
+{
+    return getObject<ID3D12Resource>(id, CapturedObjectType::Resource);
+}
+
+ID3D12DescriptorHeap* CommandReplayer::getDescriptorHeap(CapturedObjectId id)
+{
+    return getObject<ID3D12DescriptorHeap>(id, CapturedObjectType::DescriptorHeap);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS CommandReplayer::getGpuAddress(const CapturedAddress& address)
+{
+    if(address.isNull()) { return 0; }
+
+    // The raw address belongs to the device the capture was taken on
+    if(!address.isResolved())
+    {
+        mCommandValid = false;
+        return 0;
+    }
+
+    ID3D12Resource* resource = getResource(address.objectId);
+    return (resource != nullptr) ? resource->GetGPUVirtualAddress() + address.offset : 0;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE CommandReplayer::getCpuDescriptor(const CapturedAddress& address)
+{
+    if(address.isNull()) { return D3D12_CPU_DESCRIPTOR_HANDLE{0}; }
+
+    if(!address.isResolved() || getDescriptorHeap(address.objectId) == nullptr)
+    {
+        mCommandValid = false;
+        return D3D12_CPU_DESCRIPTOR_HANDLE{0};
+    }
+
+    const DescriptorHeapState& heap = mDescriptorHeaps[address.objectId - 1];
+    return D3D12_CPU_DESCRIPTOR_HANDLE{heap.cpuStart + (SIZE_T)address.offset * heap.descriptorSize};
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE CommandReplayer::getGpuDescriptor(const CapturedAddress& address)
+{
+    if(address.isNull()) { return D3D12_GPU_DESCRIPTOR_HANDLE{0}; }
+
+    if(!address.isResolved() || getDescriptorHeap(address.objectId) == nullptr ||
+       mDescriptorHeaps[address.objectId - 1].gpuStart == 0)
+    {
+        mCommandValid = false;
+        return D3D12_GPU_DESCRIPTOR_HANDLE{0};
+    }
+
+    const DescriptorHeapState& heap = mDescriptorHeaps[address.objectId - 1];
+    return D3D12_GPU_DESCRIPTOR_HANDLE{heap.gpuStart + address.offset * heap.descriptorSize};
+}
+
+D3D12_TEXTURE_COPY_LOCATION CommandReplayer::getCopyLocation(const CapturedTextureCopyLocation& location)
+{
+    D3D12_TEXTURE_COPY_LOCATION copyLocation = {};
+    copyLocation.pResource = getResource(location.resource);
+    copyLocation.Type = location.type;
+
+    if(location.type == D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT)
+    {
+        copyLocation.PlacedFootprint = location.placedFootprint;
+    }
+    else
+    {
+        copyLocation.SubresourceIndex = location.subresourceIndex;
+    }
+
+    return copyLocation;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS_RANGE_AND_STRIDE CommandReplayer::getShaderTable(const CapturedShaderTableRange& range)
+{
+    return D3D12_GPU_VIRTUAL_ADDRESS_RANGE_AND_STRIDE{getGpuAddress(range.startAddress), range.sizeInBytes,
+                                                      range.strideInBytes};
+}
+
+void LogCommandReplayReport(const CommandReplayReport& report)
+{
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    spdlog::info("Command replay: {} iterations of {} frames. {} command lists, {} commands, {} skipped",
+                 report.iterationCount, report.frameCount, report.commandListCount, report.commandCount,
+                 report.skippedCommandCount);
+
+    spdlog::info("{:<48} {:>10} {:>10} {:>14} {:>12}", "Command", "Count", "Skipped", "Total (us)", "Mean (ns)");
+
+    for(CommandType type : enumerate<CommandType>())
+    {
+        const CommandTypeReplayStatistics& statistics = report.commandTypes[type];
+        if(statistics.count == 0) { continue; }
+
+        spdlog::info("{:<48} {:>10} {:>10} {:>14.1f} {:>12.1f}", type, statistics.count, statistics.skippedCount,
+                     Microseconds(statistics.recordTime).count(),
+                     (double)statistics.recordTime.count() / (double)statistics.count);
+    }
+
+    spdlog::info("Clock overhead {} per measurement, taken out of the per command times", report.clockOverhead);
+    spdlog::info("Reset {:.1f} us, record {:.1f} us, close {:.1f} us, execute {:.1f} us, gpu wait {:.1f} us, "
+                 "total {:.1f} us",
+                 Microseconds(report.resetTime).count(), Microseconds(report.recordTime).count(),
+                 Microseconds(report.closeTime).count(), Microseconds(report.executeTime).count(),
+                 Microseconds(report.gpuWaitTime).count(), Microseconds(report.totalTime).count());
+
+    if(report.failedObjectCount > 0)
+    {
+        spdlog::info("{} objects couldn't be created on the replay device", report.failedObjectCount);
+    }
+}
+
+int RunCommandReplay(const std::filesystem::path& filePath, DeviceBackend backend, uint32_t iterationCount)
+{
+    auto file = LoadCommandCaptureFile(filePath);
+    if(!file)
+    {
+        spdlog::critical("Failed to load command capture '{}'. {}", filePath.string(), file.error());
+        return 1;
+    }
+
+    spdlog::info("Replaying command capture '{}' with the {} backend", filePath.string(), backend);
+
+    ComPtr<ID3D12Device> device;
+    HRESULT hr = (backend == DeviceBackend::Null)
+                     ? CreateNullDevice(NullDeviceOptions{}, IID_PPV_ARGS(&device))
+                     : D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device));
+
+    if(FAILED(hr))
+    {
+        spdlog::critical("Failed to create a device for the replay. {}", HRESULT_t(hr));
+        return 1;
+    }
+
+    CommandReplayer replayer(device);
+
+    hr = replayer.init(file.value());
+    if(SUCCEEDED(hr)) { hr = replayer.replay(iterationCount); }
+
+    if(FAILED(hr))
+    {
+        spdlog::critical("Command replay failed. {}", HRESULT_t(hr));
+        return 1;
+    }
+
+    LogCommandReplayReport(replayer.getReport());
+    return 0;
+}
+} // namespace scrap::d3d12
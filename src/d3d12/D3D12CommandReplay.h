@@ -0,0 +1,170 @@
+// Classes:
+//   CommandReplayer
+//
+// CommandReplayer:
+//   Issues the commands of a CommandCaptureFile again on any device and measures how long recording each type of
+//   command takes. Resources and descriptor heaps are created from the capture's object table with their original
+//   descriptions, but their contents are left uninitialized and every descriptor is a null view. Pipeline states, root
+//   signatures and state objects can't be rebuilt without their shaders, so they are created as placeholders that only
+//   the null device accepts. On other devices, commands that depend on an object that couldn't be created are skipped
+//   and counted instead of being recorded.
+//
+//   Every command list is submitted in capture order and each queue waits on the previous submission, so the replay
+//   never runs work from different queues at the same time. The cpu waits for the gpu at the end of every frame.
+
+#pragma once
+
+#include "EnumArray.h"
+#include "RenderDefs.h"
+#include "d3d12/D3D12CommandCapture.h"
+#include "d3d12/D3D12CommandStream.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+namespace scrap::d3d12
+{
+struct CommandTypeReplayStatistics
+{
+    uint64_t count = 0;
+    // Commands that weren't recorded, either because they aren't supported or because they depend on an object that
+    // couldn't be created
+    uint64_t skippedCount = 0;
+    // Time spent recording the command, with the cost of reading the clock taken out
+    std::chrono::nanoseconds recordTime{0};
+};
+
+struct CommandReplayReport
+{
+    uint32_t iterationCount = 0;
+    uint32_t frameCount = 0;
+    uint64_t commandListCount = 0;
+    uint64_t commandCount = 0;
+    uint64_t skippedCommandCount = 0;
+    uint32_t failedObjectCount = 0;
+    EnumArray<CommandTypeReplayStatistics, CommandType> commandTypes{};
+
+    std::chrono::nanoseconds clockOverhead{0};
+    std::chrono::nanoseconds resetTime{0};
+    std::chrono::nanoseconds recordTime{0};
+    std::chrono::nanoseconds closeTime{0};
+    std::chrono::nanoseconds executeTime{0};
+    std::chrono::nanoseconds gpuWaitTime{0};
+    std::chrono::nanoseconds totalTime{0};
+};
+
+class CommandReplayer
+{
+public:
+    explicit CommandReplayer(Microsoft::WRL::ComPtr<ID3D12Device> device);
+    CommandReplayer(const CommandReplayer&) = delete;
+    CommandReplayer(CommandReplayer&&) = delete;
+    ~CommandReplayer();
+
+    CommandReplayer& operator=(const CommandReplayer&) = delete;
+    CommandReplayer& operator=(CommandReplayer&&) = delete;
+
+    // Creates the queues and the objects the capture references. Objects that fail to create are counted in the report.
+    HRESULT init(const CommandCaptureFile& file);
+
+    // Replays every captured frame iterationCount times. The report accumulates over calls.
+    HRESULT replay(uint32_t iterationCount);
+
+    [[nodiscard]] const CommandReplayReport& getReport() const { return mReport; }
+
+private:
+    struct QueueState
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> commandQueue;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> commandList;
+    };
+
+    struct DescriptorHeapState
+    {
+        SIZE_T cpuStart = 0;
+        UINT64 gpuStart = 0;
+        UINT descriptorSize = 0;
+    };
+
+    // What the command list being replayed has bound. Arguments for a root signature or pipeline that couldn't be
+    // created have nothing to apply to.
+    struct BindingState
+    {
+        bool graphicsRootSignatureValid = true;
+        bool computeRootSignatureValid = true;
+        bool pipelineStateValid = true;
+        bool stateObjectValid = true;
+    };
+
+    HRESULT createObjects();
+    HRESULT replayFrame(uint32_t firstCommandList, uint32_t commandListCount);
+    HRESULT replayCommandList(uint32_t commandListIndex);
+    HRESULT waitForGpu();
+
+    // Records a single command. Returns false if the command was skipped.
+    bool replayCommand(CommandType type, std::span<const std::byte> payload, ID3D12GraphicsCommandList4* commandList);
+
+    // These clear mCommandValid when the object couldn't be created or the address couldn't be resolved
+    ID3D12Resource* getResource(CapturedObjectId id);
+    ID3D12DescriptorHeap* getDescriptorHeap(CapturedObjectId id);
+    D3D12_GPU_VIRTUAL_ADDRESS getGpuAddress(const CapturedAddress& address);
+    D3D12_CPU_DESCRIPTOR_HANDLE getCpuDescriptor(const CapturedAddress& address);
+    D3D12_GPU_DESCRIPTOR_HANDLE getGpuDescriptor(const CapturedAddress& address);
+    D3D12_TEXTURE_COPY_LOCATION getCopyLocation(const CapturedTextureCopyLocation& location);
+    D3D12_GPU_VIRTUAL_ADDRESS_RANGE_AND_STRIDE getShaderTable(const CapturedShaderTableRange& range);
+    template<class T>
+    T* getObject(CapturedObjectId id, CapturedObjectType type);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+    Microsoft::WRL::ComPtr<ID3D12Device5> mDevice5;
+    const CommandCaptureFile* mFile = nullptr;
+
+    // Indexed by CapturedObjectId - 1. Null for objects that couldn't be created.
+    std::vector<Microsoft::WRL::ComPtr<ID3D12DeviceChild>> mObjects;
+    std::vector<DescriptorHeapState> mDescriptorHeaps;
+
+    std::array<QueueState, 3> mQueues;
+    // One per captured command list. They are only reset after the frame they were used in has finished on the gpu.
+    std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> mCommandAllocators;
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+    uint64_t mFenceValue = 0;
+    HANDLE mFenceEvent = nullptr;
+    ID3D12CommandQueue* mLastSubmittedQueue = nullptr;
+
+    BindingState mBindingState;
+    bool mCommandValid = true;
+
+    // Reused between commands so replaying doesn't allocate
+    std::vector<CapturedObjectId> mObjectIdBuffer;
+    std::vector<CapturedAddress> mAddressBuffer;
+    std::vector<CapturedResourceBarrier> mCapturedBarrierBuffer;
+    std::vector<CapturedVertexBufferView> mCapturedVertexBufferViewBuffer;
+    std::vector<CapturedGeometryDesc> mCapturedGeometryBuffer;
+    std::vector<CapturedPostbuildInfoDesc> mCapturedPostbuildInfoBuffer;
+    std::vector<uint32_t> mValueBuffer;
+    std::vector<std::byte> mByteBuffer;
+    std::vector<D3D12_VIEWPORT> mViewportBuffer;
+    std::vector<D3D12_RECT> mRectBuffer;
+    std::vector<ID3D12DescriptorHeap*> mDescriptorHeapBuffer;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mDescriptorBuffer;
+    std::vector<D3D12_VERTEX_BUFFER_VIEW> mVertexBufferViewBuffer;
+    std::vector<D3D12_RESOURCE_BARRIER> mBarrierBuffer;
+    std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> mGeometryBuffer;
+    std::vector<D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC> mPostbuildInfoBuffer;
+
+    CommandReplayReport mReport;
+};
+
+void LogCommandReplayReport(const CommandReplayReport& report);
+
+// Loads the capture at filePath, replays it on a new device of the given backend and logs the report. Returns the
+// process exit code.
+int RunCommandReplay(const std::filesystem::path& filePath, DeviceBackend backend, uint32_t iterationCount);
+} // namespace scrap::d3d12
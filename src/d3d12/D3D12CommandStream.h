@@ -0,0 +1,370 @@
+// Classes:
+//   CommandStream
+//   CommandPayloadReader
+//
+// CommandStream:
+//   A compact, append only record of command list calls. Every command is a CommandHeader followed by its payload,
+//   padded so the next header stays 8 byte aligned. The payload layout is up to whoever records the command. The null
+//   device stores the arguments of every ID3D12GraphicsCommandList4 call as they were passed. CommandCapture stores
+//   them with object ids in place of pointers so they can be written to disk and replayed.
+//
+// CommandPayloadReader:
+//   Reads a payload back in the order it was recorded.
+
+#pragma once
+
+#include "EnumArray.h"
+#include "StringUtils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace scrap::d3d12
+{
+// One entry per ID3D12GraphicsCommandList4 method that records a command. Close and Reset aren't commands.
+enum class CommandType : uint16_t
+{
+    ClearState,
+    DrawInstanced,
+    DrawIndexedInstanced,
+    Dispatch,
+    CopyBufferRegion,
+    CopyTextureRegion,
+    CopyResource,
+    CopyTiles,
+    ResolveSubresource,
+    IASetPrimitiveTopology,
+    RSSetViewports,
+    RSSetScissorRects,
+    OMSetBlendFactor,
+    OMSetStencilRef,
+    SetPipelineState,
+    ResourceBarrier,
+    ExecuteBundle,
+    SetDescriptorHeaps,
+    SetComputeRootSignature,
+    SetGraphicsRootSignature,
+    SetComputeRootDescriptorTable,
+    SetGraphicsRootDescriptorTable,
+    SetComputeRoot32BitConstant,
+    SetGraphicsRoot32BitConstant,
+    SetComputeRoot32BitConstants,
+    SetGraphicsRoot32BitConstants,
+    SetComputeRootConstantBufferView,
+    SetGraphicsRootConstantBufferView,
+    SetComputeRootShaderResourceView,
+    SetGraphicsRootShaderResourceView,
+    SetComputeRootUnorderedAccessView,
+    SetGraphicsRootUnorderedAccessView,
+    IASetIndexBuffer,
+    IASetVertexBuffers,
+    SOSetTargets,
+    OMSetRenderTargets,
+    ClearDepthStencilView,
+    ClearRenderTargetView,
+    ClearUnorderedAccessViewUint,
+    ClearUnorderedAccessViewFloat,
+    DiscardResource,
+    BeginQuery,
+    EndQuery,
+    ResolveQueryData,
+    SetPredication,
+    SetMarker,
+    BeginEvent,
+    EndEvent,
+    ExecuteIndirect,
+    AtomicCopyBufferUINT,
+    AtomicCopyBufferUINT64,
+    OMSetDepthBounds,
+    SetSamplePositions,
+    ResolveSubresourceRegion,
+    SetViewInstanceMask,
+    WriteBufferImmediate,
+    SetProtectedResourceSession,
+    BeginRenderPass,
+    EndRenderPass,
+    InitializeMetaCommand,
+    ExecuteMetaCommand,
+    BuildRaytracingAccelerationStructure,
+    EmitRaytracingAccelerationStructurePostbuildInfo,
+    CopyRaytracingAccelerationStructure,
+    SetPipelineState1,
+    DispatchRays,
+    Count,
+    First = 0,
+    Last = Count - 1,
+};
+
+struct CommandHeader
+{
+    CommandType type;
+    uint16_t reserved = 0;
+    uint32_t payloadSize = 0;
+};
+
+// Commands are stored back to back as a CommandHeader followed by the command's arguments. Pointer arguments are
+// stored by address and arrays are stored inline after the values before them.
+class CommandStream
+{
+public:
+    CommandStream() = default;
+    CommandStream(const CommandStream&) = delete;
+    CommandStream(CommandStream&&) = default;
+    ~CommandStream() = default;
+
+    CommandStream& operator=(const CommandStream&) = delete;
+    CommandStream& operator=(CommandStream&&) = default;
+
+    template<class... Args>
+    void record(CommandType type, const Args&... args)
+    {
+        const size_t payloadSize = (size_t{0} + ... + getArgumentSize(args));
+        const size_t offset = mData.size();
+
+        mData.resize(offset + sizeof(CommandHeader) + AlignPayloadSize(payloadSize));
+
+        const CommandHeader header{type, 0, (uint32_t)payloadSize};
+        std::memcpy(mData.data() + offset, &header, sizeof(header));
+
+        [[maybe_unused]] std::byte* payload = mData.data() + offset + sizeof(header);
+        (writeArgument(payload, args), ...);
+
+        ++mCommandCount;
+    }
+
+    void clear()
+    {
+        mData.clear();
+        mCommandCount = 0;
+    }
+
+    // Replaces the stream with data taken from another stream's getData. Returns false and leaves the stream empty if
+    // the data isn't a valid sequence of commands.
+    [[nodiscard]] bool assign(std::vector<std::byte> data)
+    {
+        clear();
+
+        uint32_t commandCount = 0;
+        size_t offset = 0;
+        while(offset < data.size())
+        {
+            if(data.size() - offset < sizeof(CommandHeader)) { return false; }
+
+            CommandHeader header;
+            std::memcpy(&header, data.data() + offset, sizeof(header));
+            offset += sizeof(header);
+
+            if(header.type >= CommandType::Count || data.size() - offset < AlignPayloadSize(header.payloadSize))
+            {
+                return false;
+            }
+
+            offset += AlignPayloadSize(header.payloadSize);
+            ++commandCount;
+        }
+
+        mData = std::move(data);
+        mCommandCount = commandCount;
+        return true;
+    }
+
+    [[nodiscard]] uint32_t getCommandCount() const { return mCommandCount; }
+    [[nodiscard]] std::span<const std::byte> getData() const { return mData; }
+
+    // Calls func(CommandType, std::span<const std::byte> payload) for every command in recording order
+    template<class Func>
+    void forEach(Func&& func) const
+    {
+        size_t offset = 0;
+        while(offset < mData.size())
+        {
+            CommandHeader header;
+            std::memcpy(&header, mData.data() + offset, sizeof(header));
+            offset += sizeof(header);
+
+            func(header.type, std::span<const std::byte>(mData).subspan(offset, header.payloadSize));
+            offset += AlignPayloadSize(header.payloadSize);
+        }
+    }
+
+private:
+    // Keeps every header aligned
+    static constexpr size_t AlignPayloadSize(size_t size) { return (size + 7) & ~size_t(7); }
+
+    template<class T>
+    static size_t getArgumentSize(const T&)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Command arguments are copied into the stream byte by byte");
+        return sizeof(T);
+    }
+
+    template<class T>
+    static size_t getArgumentSize(std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Command arguments are copied into the stream byte by byte");
+        return values.size_bytes();
+    }
+
+    template<class T>
+    static void writeArgument(std::byte*& payload, const T& value)
+    {
+        std::memcpy(payload, &value, sizeof(T));
+        payload += sizeof(T);
+    }
+
+    template<class T>
+    static void writeArgument(std::byte*& payload, std::span<const T> values)
+    {
+        if(values.empty()) { return; }
+
+        std::memcpy(payload, values.data(), values.size_bytes());
+        payload += values.size_bytes();
+    }
+
+    std::vector<std::byte> mData;
+    uint32_t mCommandCount = 0;
+};
+
+class CommandPayloadReader
+{
+public:
+    explicit CommandPayloadReader(std::span<const std::byte> payload): mPayload(payload) {}
+
+    // Payloads are only byte aligned, so values are copied out instead of being read in place
+    template<class T>
+    [[nodiscard]] T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Command arguments are copied out of the stream byte by byte");
+
+        T value{};
+        if(mOffset + sizeof(T) > mPayload.size())
+        {
+            mOverrun = true;
+            return value;
+        }
+
+        std::memcpy(&value, mPayload.data() + mOffset, sizeof(T));
+        mOffset += sizeof(T);
+        return value;
+    }
+
+    // Replaces the contents of values with count values read from the payload
+    template<class T>
+    void read(std::vector<T>& values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Command arguments are copied out of the stream byte by byte");
+
+        values.clear();
+        if(mOffset + count * sizeof(T) > mPayload.size())
+        {
+            mOverrun = true;
+            return;
+        }
+
+        values.resize(count);
+        if(count > 0) { std::memcpy(values.data(), mPayload.data() + mOffset, count * sizeof(T)); }
+        mOffset += count * sizeof(T);
+    }
+
+    // True once a read went past the end of the payload
+    [[nodiscard]] bool hasOverrun() const { return mOverrun; }
+
+private:
+    std::span<const std::byte> mPayload;
+    size_t mOffset = 0;
+    bool mOverrun = false;
+};
+} // namespace scrap::d3d12
+
+namespace scrap
+{
+template<>
+[[nodiscard]] constexpr std::string_view ToStringView(d3d12::CommandType commandType)
+{
+    switch(commandType)
+    {
+    case scrap::d3d12::CommandType::ClearState: return "ClearState";
+    case scrap::d3d12::CommandType::DrawInstanced: return "DrawInstanced";
+    case scrap::d3d12::CommandType::DrawIndexedInstanced: return "DrawIndexedInstanced";
+    case scrap::d3d12::CommandType::Dispatch: return "Dispatch";
+    case scrap::d3d12::CommandType::CopyBufferRegion: return "CopyBufferRegion";
+    case scrap::d3d12::CommandType::CopyTextureRegion: return "CopyTextureRegion";
+    case scrap::d3d12::CommandType::CopyResource: return "CopyResource";
+    case scrap::d3d12::CommandType::CopyTiles: return "CopyTiles";
+    case scrap::d3d12::CommandType::ResolveSubresource: return "ResolveSubresource";
+    case scrap::d3d12::CommandType::IASetPrimitiveTopology: return "IASetPrimitiveTopology";
+    case scrap::d3d12::CommandType::RSSetViewports: return "RSSetViewports";
+    case scrap::d3d12::CommandType::RSSetScissorRects: return "RSSetScissorRects";
+    case scrap::d3d12::CommandType::OMSetBlendFactor: return "OMSetBlendFactor";
+    case scrap::d3d12::CommandType::OMSetStencilRef: return "OMSetStencilRef";
+    case scrap::d3d12::CommandType::SetPipelineState: return "SetPipelineState";
+    case scrap::d3d12::CommandType::ResourceBarrier: return "ResourceBarrier";
+    case scrap::d3d12::CommandType::ExecuteBundle: return "ExecuteBundle";
+    case scrap::d3d12::CommandType::SetDescriptorHeaps: return "SetDescriptorHeaps";
+    case scrap::d3d12::CommandType::SetComputeRootSignature: return "SetComputeRootSignature";
+    case scrap::d3d12::CommandType::SetGraphicsRootSignature: return "SetGraphicsRootSignature";
+    case scrap::d3d12::CommandType::SetComputeRootDescriptorTable: return "SetComputeRootDescriptorTable";
+    case scrap::d3d12::CommandType::SetGraphicsRootDescriptorTable: return "SetGraphicsRootDescriptorTable";
+    case scrap::d3d12::CommandType::SetComputeRoot32BitConstant: return "SetComputeRoot32BitConstant";
+    case scrap::d3d12::CommandType::SetGraphicsRoot32BitConstant: return "SetGraphicsRoot32BitConstant";
+    case scrap::d3d12::CommandType::SetComputeRoot32BitConstants: return "SetComputeRoot32BitConstants";
+    case scrap::d3d12::CommandType::SetGraphicsRoot32BitConstants: return "SetGraphicsRoot32BitConstants";
+    case scrap::d3d12::CommandType::SetComputeRootConstantBufferView: return "SetComputeRootConstantBufferView";
+    case scrap::d3d12::CommandType::SetGraphicsRootConstantBufferView: return "SetGraphicsRootConstantBufferView";
+    case scrap::d3d12::CommandType::SetComputeRootShaderResourceView: return "SetComputeRootShaderResourceView";
+    case scrap::d3d12::CommandType::SetGraphicsRootShaderResourceView: return "SetGraphicsRootShaderResourceView";
+    case scrap::d3d12::CommandType::SetComputeRootUnorderedAccessView: return "SetComputeRootUnorderedAccessView";
+    case scrap::d3d12::CommandType::SetGraphicsRootUnorderedAccessView: return "SetGraphicsRootUnorderedAccessView";
+    case scrap::d3d12::CommandType::IASetIndexBuffer: return "IASetIndexBuffer";
+    case scrap::d3d12::CommandType::IASetVertexBuffers: return "IASetVertexBuffers";
+    case scrap::d3d12::CommandType::SOSetTargets: return "SOSetTargets";
+    case scrap::d3d12::CommandType::OMSetRenderTargets: return "OMSetRenderTargets";
+    case scrap::d3d12::CommandType::ClearDepthStencilView: return "ClearDepthStencilView";
+    case scrap::d3d12::CommandType::ClearRenderTargetView: return "ClearRenderTargetView";
+    case scrap::d3d12::CommandType::ClearUnorderedAccessViewUint: return "ClearUnorderedAccessViewUint";
+    case scrap::d3d12::CommandType::ClearUnorderedAccessViewFloat: return "ClearUnorderedAccessViewFloat";
+    case scrap::d3d12::CommandType::DiscardResource: return "DiscardResource";
+    case scrap::d3d12::CommandType::BeginQuery: return "BeginQuery";
+    case scrap::d3d12::CommandType::EndQuery: return "EndQuery";
+    case scrap::d3d12::CommandType::ResolveQueryData: return "ResolveQueryData";
+    case scrap::d3d12::CommandType::SetPredication: return "SetPredication";
+    case scrap::d3d12::CommandType::SetMarker: return "SetMarker";
+    case scrap::d3d12::CommandType::BeginEvent: return "BeginEvent";
+    case scrap::d3d12::CommandType::EndEvent: return "EndEvent";
+    case scrap::d3d12::CommandType::ExecuteIndirect: return "ExecuteIndirect";
+    case scrap::d3d12::CommandType::AtomicCopyBufferUINT: return "AtomicCopyBufferUINT";
+    case scrap::d3d12::CommandType::AtomicCopyBufferUINT64: return "AtomicCopyBufferUINT64";
+    case scrap::d3d12::CommandType::OMSetDepthBounds: return "OMSetDepthBounds";
+    case scrap::d3d12::CommandType::SetSamplePositions: return "SetSamplePositions";
+    case scrap::d3d12::CommandType::ResolveSubresourceRegion: return "ResolveSubresourceRegion";
+    case scrap::d3d12::CommandType::SetViewInstanceMask: return "SetViewInstanceMask";
+    case scrap::d3d12::CommandType::WriteBufferImmediate: return "WriteBufferImmediate";
+    case scrap::d3d12::CommandType::SetProtectedResourceSession: return "SetProtectedResourceSession";
+    case scrap::d3d12::CommandType::BeginRenderPass: return "BeginRenderPass";
+    case scrap::d3d12::CommandType::EndRenderPass: return "EndRenderPass";
+    case scrap::d3d12::CommandType::InitializeMetaCommand: return "InitializeMetaCommand";
+    case scrap::d3d12::CommandType::ExecuteMetaCommand: return "ExecuteMetaCommand";
+    case scrap::d3d12::CommandType::BuildRaytracingAccelerationStructure:
+        return "BuildRaytracingAccelerationStructure";
+    case scrap::d3d12::CommandType::EmitRaytracingAccelerationStructurePostbuildInfo:
+        return "EmitRaytracingAccelerationStructurePostbuildInfo";
+    case scrap::d3d12::CommandType::CopyRaytracingAccelerationStructure:
+        return "CopyRaytracingAccelerationStructure";
+    case scrap::d3d12::CommandType::SetPipelineState1: return "SetPipelineState1";
+    case scrap::d3d12::CommandType::DispatchRays: return "DispatchRays";
+    default: return "Unknown CommandType";
+    }
+}
+} // namespace scrap
+
+template<>
+struct fmt::formatter<scrap::d3d12::CommandType>
+    : public scrap::ToStringViewFormatter<scrap::d3d12::CommandType>
+{};
@@ -0,0 +1,37 @@
+#include "d3d12/D3D12ComputeContext.h"
+
+#include "d3d12/D3D12Context.h"
+
+namespace scrap::d3d12
+{
+ComputeContext::ComputeContext(): BaseCommandContext<ComputeFrameCode>("Compute") {}
+
+HRESULT ComputeContext::init()
+{
+    DeviceContext& deviceContext = DeviceContext::instance();
+
+    HRESULT hr = BaseCommandContext<ComputeFrameCode>::initInternal(deviceContext.getDevice(),
+                                                                    D3D12_COMMAND_LIST_TYPE_COMPUTE,
+                                                                    deviceContext.getFramesInFlight());
+
+    if(FAILED(hr)) { return hr; }
+
+    D3D12_COMMAND_QUEUE_DESC commandQueueDesc{};
+    commandQueueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    commandQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+
+    // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12device-createcommandqueue
+    hr = deviceContext.getDevice()->CreateCommandQueue(&commandQueueDesc, IID_PPV_ARGS(&mCommandQueue));
+    if(FAILED(hr))
+    {
+        spdlog::critical("Failed to create d3d12 compute command queue");
+        return hr;
+    }
+
+    mCommandQueue->SetName(L"Compute Command Queue");
+
+    spdlog::info("Created d3d12 compute command queue");
+
+    return S_OK;
+}
+} // namespace scrap::d3d12
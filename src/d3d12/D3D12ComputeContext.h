@@ -0,0 +1,26 @@
+#pragma once
+
+#include "d3d12/D3D12BaseCommandContext.h"
+#include "d3d12/D3D12FrameCodes.h"
+
+namespace scrap::d3d12
+{
+// Owns the async compute queue. Work on it runs alongside the render queue and only waits on it where a
+// QueueScheduler says a dependency requires it.
+class ComputeContext : public BaseCommandContext<ComputeFrameCode>
+{
+public:
+    ComputeContext();
+
+    ComputeContext(const ComputeContext&) = delete;
+    ComputeContext(ComputeContext&&) = default;
+    virtual ~ComputeContext() final = default;
+
+    ComputeContext& operator=(const ComputeContext&) = delete;
+    ComputeContext& operator=(ComputeContext&&) = default;
+
+    HRESULT init();
+
+private:
+};
+} // namespace scrap::d3d12
@@ -5,7 +5,17 @@
 
 namespace scrap::d3d12
 {
-constexpr size_t kFrameBufferCount = 2u;
+// Frames the cpu can record ahead of the gpu. The count is picked when the DeviceContext is created. Fewer frames
+// lower the latency, more frames keep the gpu busy through cpu spikes.
+constexpr uint32_t kMinFramesInFlight = 1u;
+constexpr uint32_t kMaxFramesInFlight = 4u;
+constexpr uint32_t kDefaultFramesInFlight = 2u;
+
+// Flip model swap chains need at least two buffers, even when only one frame is in flight
+constexpr uint32_t kMinSwapChainBufferCount = 2u;
+
+// Completed command allocators that go unused for this many frames are released by the CommandAllocatorPool
+constexpr uint32_t kCommandAllocatorIdleFramesBeforeTrim = 120u;
 
 // Bindless resources
 constexpr uint32_t kMaxBindlessVertexBuffers = 4;
@@ -1,10 +1,13 @@
 #include "D3D12Context.h"
 
+#include "CpuProfiler.h"
 #include "D3D12Debug.h"
 #include "D3D12Strings.h"
+#include "MemoryTracker.h"
 #include "Window.h"
 #include "d3d12/D3D12GraphicsPipelineState.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include <d3d12.h>
@@ -56,34 +59,59 @@ namespace d3d12
 {
 DeviceContext* DeviceContext::sInstance = nullptr;
 
-DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
+DeviceContext::DeviceContext(const Window& window,
+                             GpuPreference gpuPreference,
+                             DeviceBackend backend,
+                             const NullDeviceOptions& nullDeviceOptions,
+                             const CommandCaptureParams& commandCaptureParams,
+                             const FramePacingParams& framePacingParams,
+                             const GpuProfilerParams& gpuProfilerParams,
+                             const GpuMemoryParams& gpuMemoryParams)
+    : mBackend(backend)
+    , mGpuMemoryRegistry(gpuMemoryParams)
+    , mFramesInFlight(std::clamp(framePacingParams.framesInFlight, kMinFramesInFlight, kMaxFramesInFlight))
+    , mBackBufferCount(std::max(mFramesInFlight, kMinSwapChainBufferCount))
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     assert(sInstance == nullptr);
     sInstance = this;
 
-    spdlog::info("Initializing D3D12");
+    spdlog::info("Initializing D3D12 with the {} backend", mBackend);
+    spdlog::info("{} frames in flight, {} back buffers", mFramesInFlight, mBackBufferCount);
 
-    mDebug.init(DebugOptions::EnableAttachToProcess);
+    mFrameTelemetry.init(mFramesInFlight, framePacingParams.telemetryReportInterval);
+    QueryPerformanceFrequency(&mQpcFrequency);
 
-    ComPtr<IDXGIFactory4> dxgiFactory4;
-    UINT createFactoryFlags = 0;
-#ifdef _DEBUG
-    createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
-#endif
-
-    if(FAILED(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory4))))
-    {
-        spdlog::critical("CreateDXGIFactory2 failed.");
-        return;
-    }
+    // Before anything is created so every resource the captured frames use is tracked
+    mCommandCapture.init(commandCaptureParams);
 
     // Feature level documentation
     // https://docs.microsoft.com/en-us/windows/win32/direct3d12/hardware-feature-levels
     constexpr D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
 
-    getHardwareAdapter(gpuPreference, featureLevel, dxgiFactory4.Get());
+    // The null backend doesn't use dxgi. It has no adapter to pick and no window to present to.
+    ComPtr<IDXGIFactory4> dxgiFactory4;
 
-    if(FAILED(createDevice(featureLevel))) { return; }
+    if(mBackend == DeviceBackend::Hardware)
+    {
+        mDebug.init(DebugOptions::EnableAttachToProcess);
+
+        UINT createFactoryFlags = 0;
+#ifdef _DEBUG
+        createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
+#endif
+
+        if(FAILED(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory4))))
+        {
+            spdlog::critical("CreateDXGIFactory2 failed.");
+            return;
+        }
+
+        getHardwareAdapter(gpuPreference, featureLevel, dxgiFactory4.Get());
+    }
+
+    if(FAILED(createDevice(featureLevel, nullDeviceOptions))) { return; }
 
     mDebug.setDevice(mDevice);
 
@@ -92,11 +120,15 @@ DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
     mGraphicsContext = std::make_unique<GraphicsContext>();
     mGraphicsContext->init();
 
+    mComputeContext = std::make_unique<ComputeContext>();
+    mComputeContext->init();
+
+    if(mBackend == DeviceBackend::Hardware)
     { // create swap chain
         const glm::i32vec2 frameSize = window.getDrawableSize();
 
         DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-        swapChainDesc.BufferCount = kFrameBufferCount;
+        swapChainDesc.BufferCount = mBackBufferCount;
         swapChainDesc.Width = frameSize.x;
         swapChainDesc.Height = frameSize.y;
         swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -129,10 +161,15 @@ DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
 
         spdlog::info("Created d3d12 swap chain");
     }
+    else
+    {
+        mFrameBufferSize = window.getDrawableSize();
+        mFrameIndex = 0;
+    }
 
     { // Create descriptor heaps.
         // https://docs.microsoft.com/en-us/windows/win32/direct3d12/creating-descriptor-heaps
-        mSwapChainRtvHeap = std::make_unique<MonotonicDescriptorHeap_RTV>(*this, (uint32_t)d3d12::kFrameBufferCount);
+        mSwapChainRtvHeap = std::make_unique<MonotonicDescriptorHeap_RTV>(*this, mBackBufferCount);
         if(!mSwapChainRtvHeap->isValid())
         {
             spdlog::critical("Failed to create RTV descriptor heap");
@@ -177,7 +214,7 @@ DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
     }
 
     { // Create frame resources.
-        auto rtvDescriptors = mSwapChainRtvHeap->allocate(kFrameBufferCount);
+        auto rtvDescriptors = mSwapChainRtvHeap->allocate(mBackBufferCount);
 
         if(!rtvDescriptors)
         {
@@ -187,9 +224,13 @@ DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
 
         mSwapChainRtvs = std::move(rtvDescriptors.value());
 
-        for(uint32_t frameIndex = 0; frameIndex < d3d12::kFrameBufferCount; ++frameIndex)
+        for(uint32_t frameIndex = 0; frameIndex < mBackBufferCount; ++frameIndex)
         {
-            if(FAILED(mSwapChain->GetBuffer(frameIndex, IID_PPV_ARGS(&mRenderTargets[frameIndex]))))
+            const HRESULT hr = (mBackend == DeviceBackend::Hardware)
+                                   ? mSwapChain->GetBuffer(frameIndex, IID_PPV_ARGS(&mRenderTargets[frameIndex]))
+                                   : createNullBackBuffer(mRenderTargets[frameIndex]);
+
+            if(FAILED(hr))
             {
                 spdlog::critical("Failed to get render target buffer for frame {}", frameIndex);
                 return;
@@ -197,15 +238,35 @@ DeviceContext::DeviceContext(const Window& window, GpuPreference gpuPreference)
 
             mSwapChainRtvHeap->createRenderTargetView(*this, mSwapChainRtvs, frameIndex,
                                                       mRenderTargets[frameIndex].Get(), nullptr);
+
+            mCommandCapture.addResource(mRenderTargets[frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT);
         }
 
         spdlog::info("Created render target views");
     }
 
+    if(mCommandCapture.isEnabled())
+    {
+        mCommandCapture.addDescriptorHeap(mSwapChainRtvHeap->getDescriptorHeap());
+        mCommandCapture.addDescriptorHeap(mCbvSrvUavHeap->getCpuDescriptorHeap());
+        mCommandCapture.addDescriptorHeap(mCbvSrvUavHeap->getGpuDescriptorHeap());
+        mCommandCapture.addDescriptorHeap(mRtvHeap->getCpuDescriptorHeap());
+        mCommandCapture.addDescriptorHeap(mDsvHeap->getCpuDescriptorHeap());
+    }
+
     mCopyContext = std::make_unique<CopyContext>();
     mCopyContext->init();
     mCopyContext->beginFrame();
 
+    if(gpuProfilerParams.enabled)
+    {
+        mGpuProfiler = std::make_unique<GpuProfiler>(mDevice.Get(), mGraphicsContext->getCommandQueue(),
+                                                     mFramesInFlight, gpuProfilerParams);
+
+        if(mGpuProfiler->isInitialized()) { mGpuProfiler->beginFrame(mGraphicsContext->getFrameIndex()); }
+        else { mGpuProfiler.reset(); }
+    }
+
     mInitialized = true;
 }
 
@@ -213,15 +274,17 @@ DeviceContext::~DeviceContext()
 {
     spdlog::info("Destroying D3D12");
 
-    for(auto& future : mFutures)
-    {
-        if(!future.valid()) { continue; }
-        future.wait();
-    }
-    mFutures.clear();
+    JobSystem::instance().wait(mPipelineStateJobs);
 
     if(mCopyContext != nullptr) { mCopyContext->releaseResources(); }
 
+    // The query heap and readback buffer can still be in use by the last frames
+    if(mGpuProfiler != nullptr)
+    {
+        mGraphicsContext->waitOnGpu();
+        mGpuProfiler.reset();
+    }
+
     assert(sInstance != nullptr);
     sInstance = nullptr;
 }
@@ -246,45 +309,116 @@ D3D12_CPU_DESCRIPTOR_HANDLE DeviceContext::getBackBufferRtv() const
 
 void DeviceContext::beginFrame()
 {
+    SCRAP_CPU_ZONE("DeviceContext::beginFrame");
+
     mGraphicsContext->beginFrame();
+    mComputeContext->beginFrame();
 
     mCbvSrvUavHeap->uploadPendingDescriptors(*this);
 
-    mFutures.erase(std::remove_if(mFutures.begin(), mFutures.end(),
-                                  [](const std::future<void>& future) {
-                                      return future.valid() &&
-                                             future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-                                  }),
-                   mFutures.end());
-
     mCopyContext->endFrame();
     mCopyContext->beginFrame();
 }
 
 void DeviceContext::endFrame()
 {
-    HRESULT hr = mSwapChain->Present(1, 0);
-    if(FAILED(hr))
+    SCRAP_CPU_ZONE("DeviceContext::endFrame");
+
+    // Everything the frame recorded has been submitted by now
+    if(mGpuProfiler != nullptr) { mGpuProfiler->resolveFrame(); }
+
+    if(mBackend == DeviceBackend::Hardware)
     {
-        spdlog::error("Present call failed {}", HRESULT_t(hr));
+        HRESULT hr = mSwapChain->Present(1, 0);
+        if(FAILED(hr))
+        {
+            spdlog::error("Present call failed {}", HRESULT_t(hr));
 
-        if(hr == DXGI_ERROR_DEVICE_REMOVED) { mDebug.handleDeviceRemoved(); }
+            if(hr == DXGI_ERROR_DEVICE_REMOVED) { mDebug.handleDeviceRemoved(); }
 
-        return;
-    }
+            return;
+        }
 
-    // Update the frame index.
-    mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
+        recordPresentTime();
 
+        // Update the frame index.
+        mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
+    }
+    else
+    {
+        // Nothing is presented. The back buffers are cycled in the same order a flip model swap chain would.
+        mFrameIndex = (mFrameIndex + 1) % mBackBufferCount;
+    }
+
+    mComputeContext->endFrame();
     mGraphicsContext->endFrame();
+
+    // The graphics context waited for the frame slot it moved to, so its timestamps are ready
+    if(mGpuProfiler != nullptr) { mGpuProfiler->beginFrame(mGraphicsContext->getFrameIndex()); }
+
+    addFrameTelemetry();
+
+    // The device's budget only matters when none is configured
+    mGpuMemoryRegistry.endFrame((mGpuMemoryRegistry.getParams().budgetBytes == 0) ? queryVideoMemoryBudget() : 0);
+
+    mCommandCapture.endFrame();
+}
+
+uint64_t DeviceContext::queryVideoMemoryBudget() const
+{
+    if(mAdapter == nullptr) { return 0; }
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO localInfo{};
+    DXGI_QUERY_VIDEO_MEMORY_INFO nonLocalInfo{};
+    if(FAILED(mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &localInfo))) { return 0; }
+    if(FAILED(mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonLocalInfo))) { return 0; }
+
+    return localInfo.Budget + nonLocalInfo.Budget;
+}
+
+void DeviceContext::recordPresentTime()
+{
+    UINT presentCount = 0;
+    if(FAILED(mSwapChain->GetLastPresentCount(&presentCount))) { return; }
+
+    const size_t slot = presentCount % mPresentQpcTimes.size();
+    QueryPerformanceCounter(&mPresentQpcTimes[slot]);
+    mPresentCounts[slot] = presentCount;
+}
+
+void DeviceContext::addFrameTelemetry()
+{
+    FrameTelemetrySample sample;
+    sample.graphics = mGraphicsContext->getLastFrameTiming();
+    sample.compute = mComputeContext->getLastFrameTiming();
+
+    // The statistics are for the last present that made it to the screen, which is a few frames behind. They aren't
+    // available before the first vsync or for windows composed by DWM in some configurations.
+    DXGI_FRAME_STATISTICS frameStatistics{};
+    if(mSwapChain != nullptr && SUCCEEDED(mSwapChain->GetFrameStatistics(&frameStatistics)))
+    {
+        const size_t slot = frameStatistics.PresentCount % mPresentQpcTimes.size();
+        if(mPresentCounts[slot] == frameStatistics.PresentCount &&
+           frameStatistics.SyncQPCTime.QuadPart >= mPresentQpcTimes[slot].QuadPart && mQpcFrequency.QuadPart > 0)
+        {
+            const LONGLONG ticks = frameStatistics.SyncQPCTime.QuadPart - mPresentQpcTimes[slot].QuadPart;
+            sample.presentLatency = std::chrono::nanoseconds((ticks * 1'000'000'000) / mQpcFrequency.QuadPart);
+            sample.presentLatencyFromDisplayStatistics = true;
+        }
+    }
+
+    if(!sample.presentLatencyFromDisplayStatistics)
+    {
+        sample.presentLatency = sample.graphics.signalToCompleteTime;
+    }
+
+    mFrameTelemetry.addFrame(sample);
 }
 
 std::shared_ptr<GraphicsPipelineState> DeviceContext::createGraphicsPipelineState(GraphicsPipelineStateParams&& params)
 {
     auto pipelineState = std::make_shared<GraphicsPipelineState>(std::move(params));
-    // This is a really cheesy way to do multithreaded creation of pipeline states. In the future, I would like to make
-    // some kind of task manager for handling async resource creation
-    mFutures.emplace_back(std::async(std::launch::async, [pipelineState]() { pipelineState->create(); }));
+    JobSystem::instance().run([pipelineState]() { pipelineState->create(); }, &mPipelineStateJobs);
 
     return pipelineState;
 }
@@ -381,9 +515,13 @@ void DeviceContext::getHardwareAdapter(GpuPreference gpuPreference,
     spdlog::info("Using adapter {}", selectedAdapterIndex);
 }
 
-HRESULT DeviceContext::createDevice(D3D_FEATURE_LEVEL featureLevel)
+HRESULT DeviceContext::createDevice(D3D_FEATURE_LEVEL featureLevel, const NullDeviceOptions& nullDeviceOptions)
 {
-    if(FAILED(D3D12CreateDevice(mAdapter.Get(), featureLevel, IID_PPV_ARGS(&mDevice))))
+    const HRESULT hr = (mBackend == DeviceBackend::Null)
+                           ? CreateNullDevice(nullDeviceOptions, IID_PPV_ARGS(&mDevice))
+                           : D3D12CreateDevice(mAdapter.Get(), featureLevel, IID_PPV_ARGS(&mDevice));
+
+    if(FAILED(hr))
     {
         spdlog::critical("Failed to create d3d12 device with {}", featureLevel);
         return E_FAIL;
@@ -429,6 +567,17 @@ HRESULT DeviceContext::createDevice(D3D_FEATURE_LEVEL featureLevel)
     return S_OK;
 }
 
+HRESULT DeviceContext::createNullBackBuffer(ComPtr<ID3D12Resource>& backBuffer)
+{
+    const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+    const CD3DX12_RESOURCE_DESC resourceDesc =
+        CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, (UINT64)mFrameBufferSize.x, (UINT)mFrameBufferSize.y,
+                                     1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+    return mDevice->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
+                                            D3D12_RESOURCE_STATE_PRESENT, nullptr, IID_PPV_ARGS(&backBuffer));
+}
+
 bool DeviceContext::checkFeatureSupport()
 {
     { // check for hlsl dynamic resources support
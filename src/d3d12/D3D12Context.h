@@ -4,19 +4,25 @@
 
 #pragma once
 
+#include "GpuMemoryRegistry.h"
+#include "JobSystem.h"
 #include "RenderDefs.h"
+#include "d3d12/D3D12CommandCapture.h"
+#include "d3d12/D3D12ComputeContext.h"
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12CopyContext.h"
 #include "d3d12/D3D12Debug.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
 #include "d3d12/D3D12FrameCodes.h"
+#include "d3d12/D3D12FrameTelemetry.h"
 #include "d3d12/D3D12Fwd.h"
+#include "d3d12/D3D12GpuProfiler.h"
 #include "d3d12/D3D12GraphicsContext.h"
 #include "d3d12/D3D12MonotonicDescriptorHeap.h"
+#include "d3d12/D3D12NullDevice.h"
 
 #include <array>
 #include <bitset>
-#include <future>
 
 #include <fmt/format.h>
 #include <glm/vec2.hpp>
@@ -36,7 +42,15 @@ private:
 public:
     static DeviceContext& instance() { return *sInstance; }
 
-    DeviceContext(const Window& window, GpuPreference gpuPreference);
+    // nullDeviceOptions is only used by DeviceBackend::Null
+    DeviceContext(const Window& window,
+                  GpuPreference gpuPreference,
+                  DeviceBackend backend,
+                  const NullDeviceOptions& nullDeviceOptions,
+                  const CommandCaptureParams& commandCaptureParams = {},
+                  const FramePacingParams& framePacingParams = {},
+                  const GpuProfilerParams& gpuProfilerParams = {},
+                  const GpuMemoryParams& gpuMemoryParams = {});
     DeviceContext(const DeviceContext&) = delete;
     DeviceContext(DeviceContext&&) = delete;
     ~DeviceContext();
@@ -46,6 +60,8 @@ public:
 
     [[nodiscard]] bool isInitialized() const { return mInitialized; }
 
+    [[nodiscard]] DeviceBackend getBackend() const { return mBackend; }
+
     [[nodiscard]] ID3D12Device* getDevice() { return mDevice.Get(); }
     [[nodiscard]] ID3D12Device1* getDevice1() { return mDevice1.Get(); }
     [[nodiscard]] ID3D12Device2* getDevice2() { return mDevice2.Get(); }
@@ -56,6 +72,8 @@ public:
     [[nodiscard]] ID3D12Device7* getDevice7() { return mDevice7.Get(); }
 
     [[nodiscard]] uint32_t getFrameIndex() const { return mFrameIndex; }
+    [[nodiscard]] uint32_t getFramesInFlight() const { return mFramesInFlight; }
+    [[nodiscard]] uint32_t getBackBufferCount() const { return mBackBufferCount; }
 
     [[nodiscard]] ID3D12Resource* getBackBuffer() { return mRenderTargets[mFrameIndex].Get(); }
     [[nodiscard]] D3D12_CPU_DESCRIPTOR_HANDLE getBackBufferRtv() const;
@@ -66,10 +84,22 @@ public:
     [[nodiscard]] CopyContext& getCopyContext() { return *mCopyContext; }
     [[nodiscard]] const CopyContext& getCopyContext() const { return *mCopyContext; }
 
+    [[nodiscard]] ComputeContext& getComputeContext() { return *mComputeContext; }
+    [[nodiscard]] const ComputeContext& getComputeContext() const { return *mComputeContext; }
+
     [[nodiscard]] d3d12::FixedDescriptorHeap_CBV_SRV_UAV& getCbvSrvUavHeap() { return *mCbvSrvUavHeap; }
     [[nodiscard]] d3d12::FixedDescriptorHeap_RTV& getRtvHeap() { return *mRtvHeap; }
     [[nodiscard]] d3d12::FixedDescriptorHeap_DSV& getDsvHeap() { return *mDsvHeap; }
 
+    [[nodiscard]] CommandCapture& getCommandCapture() { return mCommandCapture; }
+
+    [[nodiscard]] GpuMemoryRegistry& getGpuMemoryRegistry() { return mGpuMemoryRegistry; }
+    [[nodiscard]] const GpuMemoryRegistry& getGpuMemoryRegistry() const { return mGpuMemoryRegistry; }
+    // Local and non-local memory the OS currently grants the process. 0 without a hardware adapter.
+    [[nodiscard]] uint64_t queryVideoMemoryBudget() const;
+
+    [[nodiscard]] const FrameTelemetry& getFrameTelemetry() const { return mFrameTelemetry; }
+
     [[nodiscard]] glm::i32vec2 getFrameSize() const { return mFrameBufferSize; }
 
     [[nodiscard]] D3D_ROOT_SIGNATURE_VERSION getRootSignatureVersion() const { return mRootSignatureVersion; }
@@ -94,14 +124,25 @@ public:
 
 private:
     void getHardwareAdapter(GpuPreference gpuPreference, D3D_FEATURE_LEVEL featureLevel, IDXGIFactory4* dxgiFactory);
-    HRESULT createDevice(D3D_FEATURE_LEVEL featureLevel);
+    HRESULT createDevice(D3D_FEATURE_LEVEL featureLevel, const NullDeviceOptions& nullDeviceOptions);
+    HRESULT createNullBackBuffer(Microsoft::WRL::ComPtr<ID3D12Resource>& backBuffer);
     bool checkFeatureSupport();
     void collectFormatSupport();
+    void recordPresentTime();
+    void addFrameTelemetry();
 
     // Debug needs to be the first member so it's the last one destroyed. Debug checks to see what
     // d3d12 and dxgi objects are still live on destruction.
     Debug mDebug;
 
+    DeviceBackend mBackend;
+
+    // Holds references to every resource created while it's enabled, so it's destroyed after the resources it tracks
+    CommandCapture mCommandCapture;
+
+    // Every resource that registers its memory holds an allocation of the registry, so it's destroyed after them
+    GpuMemoryRegistry mGpuMemoryRegistry;
+
     Microsoft::WRL::ComPtr<IDXGIAdapter4> mAdapter;
     Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
     Microsoft::WRL::ComPtr<ID3D12Device1> mDevice1;
@@ -114,22 +155,36 @@ private:
     Microsoft::WRL::ComPtr<IDXGISwapChain3> mSwapChain;
     std::unique_ptr<MonotonicDescriptorHeap_RTV> mSwapChainRtvHeap;
     d3d12::MonotonicDescriptorHeapAllocation mSwapChainRtvs;
-    std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, d3d12::kFrameBufferCount> mRenderTargets;
+    std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, kMaxFramesInFlight> mRenderTargets;
 
     std::unique_ptr<FixedDescriptorHeap_CBV_SRV_UAV> mCbvSrvUavHeap;
     std::unique_ptr<FixedDescriptorHeap_RTV> mRtvHeap;
     std::unique_ptr<FixedDescriptorHeap_DSV> mDsvHeap;
 
-    // Graphcs and copy context need to be declared after the descriptor heaps so they are destroyed before the
+    // Graphcs, copy and compute context need to be declared after the descriptor heaps so they are destroyed before the
     // descriptor heaps.
     std::unique_ptr<GraphicsContext> mGraphicsContext;
     std::unique_ptr<CopyContext> mCopyContext;
+    std::unique_ptr<ComputeContext> mComputeContext;
+
+    // Declared after the command contexts since it records with the graphics context's command allocators
+    std::unique_ptr<GpuProfiler> mGpuProfiler;
 
     glm::i32vec2 mFrameBufferSize{0, 0};
 
     uint32_t mFrameIndex = 0;
-
-    std::vector<std::future<void>> mFutures;
+    uint32_t mFramesInFlight = kDefaultFramesInFlight;
+    uint32_t mBackBufferCount = kMinSwapChainBufferCount;
+
+    FrameTelemetry mFrameTelemetry;
+    // Performance counter value of each Present call, indexed by the present count. Display statistics refer back to
+    // presents by their count.
+    std::array<LARGE_INTEGER, 2 * kMaxFramesInFlight> mPresentQpcTimes{};
+    std::array<UINT, 2 * kMaxFramesInFlight> mPresentCounts{};
+    LARGE_INTEGER mQpcFrequency{};
+
+    // Pipeline states that are still being created on the job system
+    JobCounter mPipelineStateJobs;
 
     bool mInitialized = false;
 
@@ -1,5 +1,6 @@
 #include "d3d12/D3D12CopyContext.h"
 
+#include "CpuProfiler.h"
 #include "d3d12/D3D12Context.h"
 #include "d3d12/D3D12Debug.h"
 
@@ -16,7 +17,8 @@ HRESULT CopyContext::init()
 {
     DeviceContext& deviceContext = DeviceContext::instance();
 
-    BaseCommandContext<CopyFrameCode>::initInternal(deviceContext.instance().getDevice());
+    BaseCommandContext<CopyFrameCode>::initInternal(deviceContext.instance().getDevice(), D3D12_COMMAND_LIST_TYPE_COPY,
+                                                    deviceContext.getFramesInFlight());
 
     D3D12_COMMAND_QUEUE_DESC desc = {};
     desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
@@ -44,18 +46,25 @@ void CopyContext::beginFrame()
 {
     BaseCommandContext<CopyFrameCode>::beginFrame();
 
+    std::lock_guard lockGuard(mCommandListMutex);
     mCommandList->beginRecording();
 }
 
 void CopyContext::endFrame()
 {
-    mCommandList->execute(mCommandQueue.Get());
+    {
+        std::lock_guard lockGuard(mCommandListMutex);
+        mCommandList->execute(mCommandQueue.Get());
+    }
 
     BaseCommandContext<CopyFrameCode>::endFrame();
 }
 
 void CopyContext::execute()
 {
+    SCRAP_CPU_ZONE("CopyContext::execute");
+
+    std::lock_guard lockGuard(mCommandListMutex);
     mCommandList->execute(mCommandQueue.Get());
     mCommandList->beginRecording();
 }
@@ -7,6 +7,7 @@
 #include "d3d12/D3D12Fwd.h"
 
 #include <array>
+#include <mutex>
 #include <vector>
 
 #include <wrl/client.h>
@@ -30,6 +31,10 @@ public:
 
     ID3D12GraphicsCommandList* getCommandList() const { return mCommandList->get(); }
 
+    // Everything that uploads records into the same command list. Threads recording at the same time, like the init
+    // tasks during startup, have to hold this lock while they record.
+    [[nodiscard]] std::unique_lock<std::mutex> lockCommandList() { return std::unique_lock(mCommandListMutex); }
+
     void beginFrame() final;
     void endFrame() final;
 
@@ -37,5 +42,6 @@ public:
 
 private:
     std::unique_ptr<GraphicsCommandList> mCommandList;
+    std::mutex mCommandListMutex;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
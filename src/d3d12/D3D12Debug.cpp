@@ -1,5 +1,7 @@
 #include "d3d12/D3D12Debug.h"
 
+#include "d3d12/D3D12GpuProfiler.h"
+
 #include <cassert>
 
 #include <d3d12.h>
@@ -278,6 +280,7 @@ ScopedGpuEvent::ScopedGpuEvent(ID3D12GraphicsCommandList* commandList, std::stri
     , mContextType(ContextType::GraphicsCommandList)
 {
     PIXBeginEvent(commandList, PIX_COLOR_DEFAULT, label.data());
+    beginTimestamp(commandList, label);
 }
 
 ScopedGpuEvent::ScopedGpuEvent(ID3D12GraphicsCommandList* commandList, std::wstring_view label)
@@ -303,6 +306,8 @@ ScopedGpuEvent::ScopedGpuEvent(ID3D12CommandQueue* commandQueue, std::wstring_vi
 
 ScopedGpuEvent::~ScopedGpuEvent()
 {
+    endTimestamp();
+
     if(mContext != nullptr)
     {
         switch(mContextType)
@@ -365,7 +370,10 @@ bool Debug::endCapture(bool discard)
 
 void Debug::handleDeviceRemoved() {}
 
-ScopedGpuEvent::ScopedGpuEvent(ID3D12GraphicsCommandList*, std::string_view) {}
+ScopedGpuEvent::ScopedGpuEvent(ID3D12GraphicsCommandList* commandList, std::string_view label)
+{
+    beginTimestamp(commandList, label);
+}
 
 ScopedGpuEvent::ScopedGpuEvent(ID3D12GraphicsCommandList*, std::wstring_view) {}
 
@@ -373,6 +381,29 @@ ScopedGpuEvent::ScopedGpuEvent(ID3D12CommandQueue*, std::string_view) {}
 
 ScopedGpuEvent::ScopedGpuEvent(ID3D12CommandQueue*, std::wstring_view) {}
 
-ScopedGpuEvent::~ScopedGpuEvent() {}
+ScopedGpuEvent::~ScopedGpuEvent()
+{
+    endTimestamp();
+}
 #endif
+
+void ScopedGpuEvent::beginTimestamp(ID3D12GraphicsCommandList* commandList, std::string_view label)
+{
+    GpuProfiler* gpuProfiler = GpuProfiler::instance();
+    if(gpuProfiler == nullptr) { return; }
+
+    if(std::optional<uint32_t> query = gpuProfiler->beginScope(commandList, label))
+    {
+        mTimedCommandList = commandList;
+        mTimestampQuery = *query;
+    }
+}
+
+void ScopedGpuEvent::endTimestamp()
+{
+    if(mTimedCommandList == nullptr) { return; }
+
+    // The profiler outlives every command list it times
+    GpuProfiler::instance()->endScope(mTimedCommandList, mTimestampQuery);
+}
 } // namespace scrap::d3d12
\ No newline at end of file
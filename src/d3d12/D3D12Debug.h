@@ -142,6 +142,8 @@ private:
     bool mIsPixAttached = false;
 };
 
+// Begins a PIX event when it's created and ends it when it goes out of scope. While there is a GpuProfiler, the events
+// on direct command lists with a std::string_view label are also timed with timestamp queries.
 class ScopedGpuEvent
 {
 public:
@@ -163,9 +165,16 @@ private:
         CommandQueue,
         Unknown,
     };
+
+    void beginTimestamp(ID3D12GraphicsCommandList* commandList, std::string_view label);
+    void endTimestamp();
+
 #ifdef _DEBUG
     void* mContext = nullptr;
     ContextType mContextType = ContextType::Unknown;
 #endif
+    // Only set while the GpuProfiler times the event
+    ID3D12GraphicsCommandList* mTimedCommandList = nullptr;
+    uint32_t mTimestampQuery = 0;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
@@ -9,9 +9,24 @@
 
 namespace scrap::d3d12
 {
+namespace
+{
+PerfGauge DescriptorsInUseGauge(D3D12_DESCRIPTOR_HEAP_TYPE heapType)
+{
+    switch(heapType)
+    {
+    case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER: return PerfGauge::SamplerDescriptorsInUse;
+    case D3D12_DESCRIPTOR_HEAP_TYPE_RTV: return PerfGauge::RtvDescriptorsInUse;
+    case D3D12_DESCRIPTOR_HEAP_TYPE_DSV: return PerfGauge::DsvDescriptorsInUse;
+    default: return PerfGauge::CbvSrvUavDescriptorsInUse;
+    }
+}
+} // namespace
+
 FixedDescriptorHeapAllocator::FixedDescriptorHeapAllocator(DeviceContext& context,
                                                            D3D12_DESCRIPTOR_HEAP_TYPE heapType,
                                                            uint32_t descriptorCount)
+    : mDescriptorsInUseGauge(DescriptorsInUseGauge(heapType))
 {
     D3D12_DESCRIPTOR_HEAP_DESC cpuDesc = {};
     cpuDesc.Type = heapType;
@@ -59,6 +74,7 @@ FixedDescriptorHeapAllocator::allocateSubHeap(uint32_t descriptorCount)
 
     FreeBlockTracker::Range range{reservation.value(), descriptorCount};
     mCpuRangesToCopy.push_back(range);
+    mDescriptorsInUseGauge.set((int64_t)mFreeBlockTracker.getReservedBlockCount());
 
     return std::make_shared<FixedDescriptorHeapSubAllocator>(*this, range);
 }
@@ -73,6 +89,7 @@ FixedDescriptorHeapAllocator::allocateMonotonicSubHeap(uint32_t descriptorCount)
 
     FreeBlockTracker::Range range{reservation.value(), descriptorCount};
     mCpuRangesToCopy.push_back(range);
+    mDescriptorsInUseGauge.set((int64_t)mFreeBlockTracker.getReservedBlockCount());
 
     return std::make_shared<FixedDescriptorHeapMonotonicSubAllocator>(*this, range);
 }
@@ -87,6 +104,7 @@ FixedDescriptorHeapAllocator::reserve(uint32_t descriptorCount)
 
     FreeBlockTracker::Range range{reservation.value(), descriptorCount};
     mCpuRangesToCopy.push_back(range);
+    mDescriptorsInUseGauge.set((int64_t)mFreeBlockTracker.getReservedBlockCount());
 
     return FixedDescriptorHeapReservation(*this, range);
 }
@@ -128,6 +146,7 @@ void FixedDescriptorHeapAllocator::deallocate(FreeBlockTracker::Range range)
     }
 
     mFreeBlockTracker.unsafeRelease(range);
+    mDescriptorsInUseGauge.set((int64_t)mFreeBlockTracker.getReservedBlockCount());
 }
 
 void FixedDescriptorHeapAllocator::uploadPendingDescriptors(DeviceContext& context)
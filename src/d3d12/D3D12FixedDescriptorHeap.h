@@ -21,6 +21,7 @@
 #pragma once
 
 #include "FreeBlockTracker.h"
+#include "PerfCounters.h"
 #include "d3d12/D3D12Fwd.h"
 
 #include <array>
@@ -98,6 +99,7 @@ protected:
     FreeBlockTracker mFreeBlockTracker;
     std::vector<FreeBlockTracker::Range> mCpuRangesToCopy;
     uint32_t mDescriptorSize = 0u;
+    PerfGaugeContribution mDescriptorsInUseGauge{PerfGauge::CbvSrvUavDescriptorsInUse};
 };
 
 // Represents a contiguous block of descriptors from a FixedDescriptorHeapAllocator. It does not keep track of any
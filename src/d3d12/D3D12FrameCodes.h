@@ -85,6 +85,47 @@ public:
     bool operator>(const CopyFrameCode& right) const { return mValue > right.mValue; }
     bool operator>=(const CopyFrameCode& right) const { return mValue >= right.mValue; }
 
+private:
+    FrameCodeValueType mValue{0};
+};
+
+class ComputeFrameCode
+{
+public:
+    ComputeFrameCode() = default;
+    explicit ComputeFrameCode(FrameCodeValueType value): mValue(value) {}
+    ComputeFrameCode(const ComputeFrameCode&) = default;
+    ComputeFrameCode(ComputeFrameCode&&) = default;
+    ~ComputeFrameCode() = default;
+
+    ComputeFrameCode& operator=(const ComputeFrameCode&) = default;
+    ComputeFrameCode& operator=(ComputeFrameCode&&) = default;
+
+    ComputeFrameCode& operator=(const FrameCodeValueType& value)
+    {
+        mValue = value;
+        return *this;
+    }
+
+    explicit operator uint64_t() const { return mValue; }
+
+    ComputeFrameCode& operator++()
+    {
+        ++mValue;
+        return *this;
+    }
+
+    ComputeFrameCode operator++(int) { return ComputeFrameCode(mValue++); }
+
+    FrameCodeValueType operator*() const { return mValue; }
+
+    bool operator==(const ComputeFrameCode& right) const { return mValue == right.mValue; }
+    bool operator!=(const ComputeFrameCode& right) const { return mValue != right.mValue; }
+    bool operator<(const ComputeFrameCode& right) const { return mValue < right.mValue; }
+    bool operator<=(const ComputeFrameCode& right) const { return mValue <= right.mValue; }
+    bool operator>(const ComputeFrameCode& right) const { return mValue > right.mValue; }
+    bool operator>=(const ComputeFrameCode& right) const { return mValue >= right.mValue; }
+
 private:
     FrameCodeValueType mValue{0};
 };
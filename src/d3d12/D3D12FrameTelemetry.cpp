@@ -0,0 +1,128 @@
+#include "d3d12/D3D12FrameTelemetry.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+FenceCompletionTracker::~FenceCompletionTracker()
+{
+    stop();
+}
+
+void FenceCompletionTracker::init(ComPtr<ID3D12Fence> fence)
+{
+    mFence = std::move(fence);
+    mThread = std::thread([this]() { run(); });
+}
+
+void FenceCompletionTracker::addSignal(uint64_t value)
+{
+    if(mFence == nullptr) { return; }
+
+    {
+        std::lock_guard lockGuard(mMutex);
+        mPendingValues.push_back(value);
+    }
+
+    mSignalAdded.notify_one();
+}
+
+std::optional<std::chrono::steady_clock::time_point> FenceCompletionTracker::getCompletionTime(uint64_t value) const
+{
+    std::lock_guard lockGuard(mMutex);
+
+    const Completion& completion = mCompletions[value % kHistorySize];
+    if(completion.value != value) { return std::nullopt; }
+
+    return completion.time;
+}
+
+void FenceCompletionTracker::stop()
+{
+    {
+        std::lock_guard lockGuard(mMutex);
+        mStopping = true;
+    }
+
+    mSignalAdded.notify_one();
+
+    if(mThread.joinable()) { mThread.join(); }
+}
+
+void FenceCompletionTracker::run()
+{
+    std::unique_lock lock(mMutex);
+
+    while(true)
+    {
+        mSignalAdded.wait(lock, [this]() { return mStopping || !mPendingValues.empty(); });
+        if(mPendingValues.empty()) { return; }
+
+        const uint64_t value = mPendingValues.front();
+        mPendingValues.pop_front();
+
+        // Without an event, SetEventOnCompletion blocks until the fence reaches the value
+        lock.unlock();
+        const HRESULT hr = mFence->SetEventOnCompletion(value, nullptr);
+        const std::chrono::steady_clock::time_point completionTime = std::chrono::steady_clock::now();
+        lock.lock();
+
+        if(FAILED(hr)) { continue; }
+
+        mCompletions[value % kHistorySize] = Completion{value, completionTime};
+    }
+}
+
+void FrameTelemetry::init(uint32_t framesInFlight, uint32_t reportInterval)
+{
+    mFramesInFlight = framesInFlight;
+    mReportInterval = reportInterval;
+}
+
+void FrameTelemetry::addFrame(const FrameTelemetrySample& sample)
+{
+    mLastFrame = sample;
+
+    mGraphicsCpuWait.add(sample.graphics.cpuWaitTime);
+    mComputeCpuWait.add(sample.compute.cpuWaitTime);
+    mGraphicsGpuIdle.add(sample.graphics.gpuIdleTime);
+    mComputeGpuIdle.add(sample.compute.gpuIdleTime);
+    mPresentLatency.add(sample.presentLatency);
+    if(sample.presentLatencyFromDisplayStatistics) { ++mDisplayStatisticsFrameCount; }
+
+    ++mFrameCount;
+    if(mReportInterval > 0 && mFrameCount >= mReportInterval) { report(); }
+}
+
+void FrameTelemetry::report()
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    auto mean = [this](const Accumulator& accumulator) {
+        return Milliseconds(accumulator.total).count() / (double)mFrameCount;
+    };
+    auto max = [](const Accumulator& accumulator) { return Milliseconds(accumulator.max).count(); };
+
+    spdlog::info("Frame telemetry over {} frames with {} frames in flight", mFrameCount, mFramesInFlight);
+    spdlog::info("    Graphics cpu wait:  mean {:.3f} ms, max {:.3f} ms", mean(mGraphicsCpuWait),
+                 max(mGraphicsCpuWait));
+    spdlog::info("    Compute cpu wait:   mean {:.3f} ms, max {:.3f} ms", mean(mComputeCpuWait), max(mComputeCpuWait));
+    spdlog::info("    Graphics gpu idle:  mean {:.3f} ms, max {:.3f} ms", mean(mGraphicsGpuIdle),
+                 max(mGraphicsGpuIdle));
+    spdlog::info("    Compute gpu idle:   mean {:.3f} ms, max {:.3f} ms", mean(mComputeGpuIdle), max(mComputeGpuIdle));
+    spdlog::info("    Present latency:    mean {:.3f} ms, max {:.3f} ms ({} of {} frames from display statistics)",
+                 mean(mPresentLatency), max(mPresentLatency), mDisplayStatisticsFrameCount, mFrameCount);
+
+    mFrameCount = 0;
+    mDisplayStatisticsFrameCount = 0;
+    mGraphicsCpuWait = {};
+    mComputeCpuWait = {};
+    mGraphicsGpuIdle = {};
+    mComputeGpuIdle = {};
+    mPresentLatency = {};
+}
+} // namespace scrap::d3d12
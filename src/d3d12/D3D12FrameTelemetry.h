@@ -0,0 +1,144 @@
+// Classes:
+//   FenceCompletionTracker
+//   FrameTelemetry
+//
+// FenceCompletionTracker:
+//   Records when a fence reached each value it was signaled with. A worker thread blocks on the values in signal order
+//   with SetEventOnCompletion(value, nullptr), so the recorded time is when the wait returned rather than when the cpu
+//   happened to look. The last kHistorySize values are kept.
+//
+// FrameTelemetry:
+//   Collects the per frame latency numbers of the command contexts and the swap chain and logs their mean and max
+//   every reportInterval frames. The gpu idle time is measured from the previous frame's fence completing to the
+//   current frame's fence being signaled. The renderers submit right before the signal, so it covers the time the
+//   queue had nothing to do, but work a frame submits early shortens the real gap.
+
+#pragma once
+
+#include "d3d12/D3D12Config.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+namespace scrap::d3d12
+{
+struct FramePacingParams
+{
+    // Frames the cpu can record ahead of the gpu. Clamped to [kMinFramesInFlight, kMaxFramesInFlight].
+    uint32_t framesInFlight = kDefaultFramesInFlight;
+
+    // Logs the frame telemetry every this many frames. 0 disables the log, the numbers are still collected.
+    uint32_t telemetryReportInterval = 0;
+};
+
+// The timing of the last frame a command context waited for
+struct CommandContextFrameTiming
+{
+    // Time endFrame spent blocked waiting for the frame slot to free up
+    std::chrono::nanoseconds cpuWaitTime{0};
+    // Time the queue sat empty before the frame was signaled
+    std::chrono::nanoseconds gpuIdleTime{0};
+    // From the frame's fence being signaled to it completing
+    std::chrono::nanoseconds signalToCompleteTime{0};
+};
+
+class FenceCompletionTracker
+{
+public:
+    static constexpr size_t kHistorySize = 2 * kMaxFramesInFlight;
+
+    FenceCompletionTracker() = default;
+    FenceCompletionTracker(const FenceCompletionTracker&) = delete;
+    FenceCompletionTracker(FenceCompletionTracker&&) = delete;
+    ~FenceCompletionTracker();
+
+    FenceCompletionTracker& operator=(const FenceCompletionTracker&) = delete;
+    FenceCompletionTracker& operator=(FenceCompletionTracker&&) = delete;
+
+    void init(Microsoft::WRL::ComPtr<ID3D12Fence> fence);
+
+    // Has to be called after the value was signaled on a queue, in signal order
+    void addSignal(uint64_t value);
+
+    // Empty until the worker has seen the value complete, or once it dropped out of the history
+    [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> getCompletionTime(uint64_t value) const;
+
+    // Waits for every added value to complete and joins the worker. The fence has to reach them eventually.
+    void stop();
+
+private:
+    struct Completion
+    {
+        uint64_t value = 0;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    void run();
+
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+    std::thread mThread;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mSignalAdded;
+    std::deque<uint64_t> mPendingValues;
+    std::array<Completion, kHistorySize> mCompletions{};
+    bool mStopping = false;
+};
+
+struct FrameTelemetrySample
+{
+    CommandContextFrameTiming graphics;
+    CommandContextFrameTiming compute;
+    // From the Present call to the frame being displayed. Without display statistics, from the Present call to the
+    // frame's gpu work completing.
+    std::chrono::nanoseconds presentLatency{0};
+    bool presentLatencyFromDisplayStatistics = false;
+};
+
+class FrameTelemetry
+{
+public:
+    void init(uint32_t framesInFlight, uint32_t reportInterval);
+
+    void addFrame(const FrameTelemetrySample& sample);
+
+    [[nodiscard]] const FrameTelemetrySample& getLastFrame() const { return mLastFrame; }
+
+private:
+    struct Accumulator
+    {
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+
+        void add(std::chrono::nanoseconds value)
+        {
+            total += value;
+            max = std::max(max, value);
+        }
+    };
+
+    void report();
+
+    uint32_t mFramesInFlight = kDefaultFramesInFlight;
+    uint32_t mReportInterval = 0;
+    uint32_t mFrameCount = 0;
+    uint32_t mDisplayStatisticsFrameCount = 0;
+    FrameTelemetrySample mLastFrame;
+
+    Accumulator mGraphicsCpuWait;
+    Accumulator mComputeCpuWait;
+    Accumulator mGraphicsGpuIdle;
+    Accumulator mComputeGpuIdle;
+    Accumulator mPresentLatency;
+};
+} // namespace scrap::d3d12
@@ -4,6 +4,7 @@ namespace scrap::d3d12
 {
 class BLAccelerationStructure;
 class Buffer;
+class ComputeContext;
 class CopyContext;
 class Debug;
 class DeviceContext;
@@ -0,0 +1,167 @@
+#include "d3d12/D3D12GpuProfiler.h"
+
+#include "CpuProfiler.h"
+#include "d3d12/D3D12Context.h"
+
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+GpuProfiler* GpuProfiler::sInstance = nullptr;
+thread_local uint32_t GpuProfiler::tScopeDepth = 0;
+
+GpuProfiler::GpuProfiler(ID3D12Device* device,
+                         ID3D12CommandQueue* commandQueue,
+                         uint32_t framesInFlight,
+                         const GpuProfilerParams& params)
+    : mParams(params)
+    , mCommandQueue(commandQueue)
+    , mResolveCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, "GpuProfiler Resolve")
+{
+    assert(sInstance == nullptr);
+
+    if(FAILED(mCommandQueue->GetTimestampFrequency(&mTimestampFrequency)))
+    {
+        spdlog::error("Failed to get the gpu timestamp frequency. Gpu events won't be timed.");
+        return;
+    }
+
+    mTracker.init(framesInFlight, mParams.maxScopesPerFrame);
+
+    D3D12_QUERY_HEAP_DESC queryHeapDesc{};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = mTracker.getQueryCount();
+
+    if(FAILED(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&mQueryHeap))))
+    {
+        spdlog::error("Failed to create the timestamp query heap. Gpu events won't be timed.");
+        return;
+    }
+
+    mQueryHeap->SetName(L"GpuProfiler Timestamps");
+
+    D3D12_HEAP_PROPERTIES readbackHeapProps{};
+    readbackHeapProps.Type = D3D12_HEAP_TYPE_READBACK;
+
+    D3D12_RESOURCE_DESC bufferDesc{};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = (UINT64)mTracker.getQueryCount() * sizeof(uint64_t);
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    if(FAILED(device->CreateCommittedResource(&readbackHeapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                              D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                              IID_PPV_ARGS(&mReadbackBuffer))))
+    {
+        spdlog::error("Failed to create the timestamp readback buffer. Gpu events won't be timed.");
+        return;
+    }
+
+    mReadbackBuffer->SetName(L"GpuProfiler Readback");
+    DeviceContext::instance().getCommandCapture().addResource(mReadbackBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    mReadbackMemoryAllocation = DeviceContext::instance().getGpuMemoryRegistry().add(
+        {bufferDesc.Width, GpuHeapType::Readback, GpuMemoryCategory::Readback, "GpuProfiler Readback"});
+
+    // Readback buffers can stay mapped. Each slot is only read after the gpu is done writing it.
+    void* readbackData = nullptr;
+    if(FAILED(mReadbackBuffer->Map(0, nullptr, &readbackData)))
+    {
+        spdlog::error("Failed to map the timestamp readback buffer. Gpu events won't be timed.");
+        return;
+    }
+
+    mReadbackTimestamps = static_cast<const uint64_t*>(readbackData);
+
+    spdlog::info("Timing gpu events, {} timestamp queries per frame", mParams.maxScopesPerFrame * 2);
+
+    mInitialized = true;
+    sInstance = this;
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if(sInstance == this) { sInstance = nullptr; }
+
+    if(mReadbackTimestamps != nullptr)
+    {
+        const D3D12_RANGE writtenRange{0, 0};
+        mReadbackBuffer->Unmap(0, &writtenRange);
+    }
+}
+
+std::optional<uint32_t> GpuProfiler::beginScope(ID3D12GraphicsCommandList* commandList, std::string_view label)
+{
+    if(commandList == nullptr || commandList->GetType() != D3D12_COMMAND_LIST_TYPE_DIRECT) { return std::nullopt; }
+
+    const std::optional<uint32_t> query = mTracker.beginScope(label, tScopeDepth);
+    if(!query) { return std::nullopt; }
+
+    commandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *query);
+    ++tScopeDepth;
+
+    return query;
+}
+
+void GpuProfiler::endScope(ID3D12GraphicsCommandList* commandList, uint32_t query)
+{
+    commandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query + 1);
+    --tScopeDepth;
+}
+
+void GpuProfiler::resolveFrame()
+{
+    const GpuTimestampQueryRange queryRange = mTracker.endFrame(mFrameNumber++);
+    if(queryRange.queryCount == 0) { return; }
+
+    if(FAILED(mResolveCommandList.beginRecording())) { return; }
+
+    mResolveCommandList.get()->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryRange.firstQuery,
+                                                queryRange.queryCount, mReadbackBuffer.Get(),
+                                                (UINT64)queryRange.firstQuery * sizeof(uint64_t));
+
+    mResolveCommandList.execute(mCommandQueue);
+    mResolveCommandList.endFrame();
+}
+
+void GpuProfiler::beginFrame(uint32_t frameSlot)
+{
+    const std::span<const uint64_t> timestamps(mReadbackTimestamps, mTracker.getQueryCount());
+    if(!mTracker.beginFrame(frameSlot, timestamps, mTimestampFrequency)) { return; }
+
+    if(CpuProfiler* cpuProfiler = CpuProfiler::instance())
+    {
+        cpuProfiler->publishGpuPasses(mTracker.getPassTimingsFrameNumber(), mTracker.getFrameMilliseconds(),
+                                      mTracker.getPassTimings());
+    }
+
+    const uint64_t frameNumber = mTracker.getPassTimingsFrameNumber();
+    if(mParams.reportInterval > 0 && frameNumber % mParams.reportInterval == 0) { logReport(); }
+}
+
+void GpuProfiler::logReport() const
+{
+    spdlog::info("Gpu passes of frame {}: {:.3f} ms", mTracker.getPassTimingsFrameNumber(),
+                 mTracker.getFrameMilliseconds());
+
+    for(const GpuPassTiming& passTiming : mTracker.getPassTimings())
+    {
+        spdlog::info("    {:{}}{}: {:.3f} ms, {} scopes", "", passTiming.depth * 2, passTiming.label,
+                     passTiming.milliseconds, passTiming.scopeCount);
+    }
+
+    if(mTracker.getDroppedScopeCount() > 0)
+    {
+        spdlog::warn("    {} gpu events weren't timed because a frame ran out of timestamp queries",
+                     mTracker.getDroppedScopeCount());
+    }
+}
+} // namespace scrap::d3d12
@@ -0,0 +1,89 @@
+// Times the ScopedGpuEvents recorded into direct command lists with timestamp queries. The queries of a frame are
+// resolved into a readback buffer right before the graphics queue signals the frame's fence, and read once the frame
+// slot comes around again, which is framesInFlight frames later. By then the graphics context has waited for the fence,
+// so reading them never stalls.
+//
+// Only the ScopedGpuEvents that take a command list and a std::string_view label are timed. Events on queues can't hold
+// queries, and copy and compute command lists would need their own resolve. The per pass times are logged every
+// reportInterval frames and handed to the CpuProfiler, if there is one, so they show up in its frame report.
+
+#pragma once
+
+#include "GpuMemoryRegistry.h"
+#include "GpuTimestampTracker.h"
+#include "d3d12/D3D12CommandList.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+namespace scrap::d3d12
+{
+struct GpuProfilerParams
+{
+    bool enabled = false;
+
+    // Logs the pass times every reportInterval frames. 0 disables the log.
+    uint32_t reportInterval = 0;
+
+    // Scopes past this in a frame aren't timed
+    uint32_t maxScopesPerFrame = 1024;
+};
+
+class GpuProfiler
+{
+public:
+    GpuProfiler(ID3D12Device* device,
+                ID3D12CommandQueue* commandQueue,
+                uint32_t framesInFlight,
+                const GpuProfilerParams& params);
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler(GpuProfiler&&) = delete;
+    ~GpuProfiler();
+
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+    // Can be nullptr
+    [[nodiscard]] static GpuProfiler* instance() { return sInstance; }
+
+    [[nodiscard]] bool isInitialized() const { return mInitialized; }
+
+    // Writes the begin timestamp and returns its query, which endScope needs. Empty when the scope isn't timed.
+    [[nodiscard]] std::optional<uint32_t> beginScope(ID3D12GraphicsCommandList* commandList, std::string_view label);
+    void endScope(ID3D12GraphicsCommandList* commandList, uint32_t query);
+
+    // Resolves the frame's queries on the graphics queue. Has to be called after the frame's last command list was
+    // submitted and before the graphics context signals the frame's fence.
+    void resolveFrame();
+
+    // Reads the frame that last used the slot and starts recording into it. Has to be called once the graphics context
+    // has waited for the slot.
+    void beginFrame(uint32_t frameSlot);
+
+    [[nodiscard]] const GpuTimestampTracker& getTracker() const { return mTracker; }
+
+private:
+    void logReport() const;
+
+    static GpuProfiler* sInstance;
+    thread_local static uint32_t tScopeDepth;
+
+    GpuProfilerParams mParams;
+    ID3D12CommandQueue* mCommandQueue;
+    uint64_t mTimestampFrequency = 0;
+
+    GpuTimestampTracker mTracker;
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> mQueryHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> mReadbackBuffer;
+    GpuMemoryAllocation mReadbackMemoryAllocation;
+    const uint64_t* mReadbackTimestamps = nullptr;
+    GraphicsCommandList mResolveCommandList;
+    uint64_t mFrameNumber = 0;
+
+    bool mInitialized = false;
+};
+} // namespace scrap::d3d12
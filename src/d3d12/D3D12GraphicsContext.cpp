@@ -10,7 +10,9 @@ HRESULT GraphicsContext::init()
 {
     DeviceContext& deviceContext = DeviceContext::instance();
 
-    HRESULT hr = BaseCommandContext<RenderFrameCode>::initInternal(deviceContext.instance().getDevice());
+    HRESULT hr = BaseCommandContext<RenderFrameCode>::initInternal(deviceContext.instance().getDevice(),
+                                                                   D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                                   deviceContext.getFramesInFlight());
 
     if(FAILED(hr)) { return hr; }
 
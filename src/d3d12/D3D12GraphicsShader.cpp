@@ -1,5 +1,6 @@
 #include "d3d12/D3D12GraphicsShader.h"
 
+#include "MemoryTracker.h"
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12ShaderReflection.h"
 #include "d3d12/D3D12Strings.h"
@@ -25,6 +26,8 @@ GraphicsShader::GraphicsShader(GraphicsShader&& other) noexcept
     : mParams(std::move(other.mParams))
     , mShaders(std::move(other.mShaders))
     , mState(other.mState)
+    , mShaderInputs(std::move(other.mShaderInputs))
+    , mBindingLayout(std::move(other.mBindingLayout))
 {
     other.mState = GraphicsShaderState::Invalid;
 }
@@ -34,6 +37,8 @@ GraphicsShader& GraphicsShader::operator=(GraphicsShader&& other) noexcept
     mParams = std::move(other.mParams);
     mShaders = std::move(other.mShaders);
     mState = other.mState;
+    mShaderInputs = std::move(other.mShaderInputs);
+    mBindingLayout = std::move(other.mBindingLayout);
     other.mState = GraphicsShaderState::Invalid;
 
     return *this;
@@ -41,6 +46,8 @@ GraphicsShader& GraphicsShader::operator=(GraphicsShader&& other) noexcept
 
 void GraphicsShader::create()
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     std::lock_guard lockGuard(mCreationMutex);
 
     if(mState != GraphicsShaderState::Initialized) { return; }
@@ -293,6 +300,8 @@ void GraphicsShader::create()
         }
     }
 
+    if(compiled) { mBindingLayout = ShaderBindingLayout(mShaderInputs); }
+
     mState = (compiled) ? GraphicsShaderState::Compiled : GraphicsShaderState::Failed;
 }
 
@@ -304,32 +313,6 @@ D3D12_SHADER_BYTECODE GraphicsShader::getShaderByteCode(GraphicsShaderStage stag
     return {};
 }
 
-std::optional<uint32_t> GraphicsShader::getVertexElementIndex(ShaderVertexSemantic semantic,
-                                                              uint32_t semanticIndex) const
-{
-    for(const ShaderVertexElement& element : mShaderInputs.vertexElements)
-    {
-        if(element.semantic == semantic && element.semanticIndex == semanticIndex) { return element.index; }
-    }
-
-    return std::nullopt;
-}
-
-std::optional<uint32_t> GraphicsShader::getResourceIndex(SharedString name,
-                                                         ShaderResourceType resourceType,
-                                                         ShaderResourceDimension resourceDimension) const
-{
-    for(const ShaderResource& resource : mShaderInputs.resources)
-    {
-        if(resource.name == name && resource.type == resourceType && resource.dimension == resourceDimension)
-        {
-            return resource.index;
-        }
-    }
-
-    return std::nullopt;
-}
-
 void GraphicsShader::logShaderErrorImpl(GraphicsShaderStage stage, std::string_view message)
 {
     spdlog::error("{}({}): {}", mParams.filepaths[stage].generic_string(), stage, message);
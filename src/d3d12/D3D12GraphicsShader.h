@@ -2,6 +2,7 @@
 
 #include "EnumArray.h"
 #include "RenderDefs.h"
+#include "ShaderBindingLayout.h"
 #include "Utility.h"
 #include "d3d12/D3D12Fwd.h"
 
@@ -57,13 +58,10 @@ public:
     ID3DBlob* getShader(GraphicsShaderStage stage) const { return mShaders[stage].shaderBlob.Get(); }
     D3D12_SHADER_BYTECODE getShaderByteCode(GraphicsShaderStage stage) const;
 
-    ShaderInputs& accessShaderInputs() { return mShaderInputs; }
     const ShaderInputs& getShaderInputs() const { return mShaderInputs; }
 
-    std::optional<uint32_t> getVertexElementIndex(ShaderVertexSemantic semantic, uint32_t semanticIndex) const;
-    std::optional<uint32_t> getResourceIndex(SharedString name,
-                                             ShaderResourceType resourceType,
-                                             ShaderResourceDimension resourceDimension) const;
+    // Only valid once the shader is compiled. The layout doesn't change after that.
+    const ShaderBindingLayout& getBindingLayout() const { return mBindingLayout; }
 
 private:
     struct ShaderInfo
@@ -89,5 +87,6 @@ private:
 
     bool mVertexConstantBufferFound = false;
     ShaderInputs mShaderInputs;
+    ShaderBindingLayout mBindingLayout;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
@@ -0,0 +1,2084 @@
+#include "d3d12/D3D12NullDevice.h"
+
+#include "Utility.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <d3d12.h>
+#include <gpufmt/dxgi.h>
+#include <gpufmt/traits.h>
+#include <spdlog/spdlog.h>
+#include <wrl/client.h>
+
+using namespace Microsoft::WRL;
+
+namespace scrap::d3d12
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr UINT kNullDescriptorSize = 32;
+constexpr UINT64 kNullGpuTimestampFrequency = 1'000'000'000; // Timestamps are in nanoseconds
+constexpr size_t kNullShaderIdentifierSize = D3D12_SHADER_IDENTIFIER_SIZE_IN_BYTES;
+
+template<class... Interfaces>
+bool IsInterface(REFIID riid)
+{
+    return ((riid == __uuidof(Interfaces)) || ...);
+}
+
+template<class T>
+std::span<const T> MakeSpan(const T* values, size_t count)
+{
+    return (values != nullptr) ? std::span<const T>(values, count) : std::span<const T>();
+}
+
+template<class T>
+T ValueOrDefault(const T* value)
+{
+    return (value != nullptr) ? *value : T{};
+}
+
+class NullDevice;
+
+// Implements IUnknown, ID3D12Object and ID3D12DeviceChild for everything the null device creates. Every object holds
+// a reference to the device, the same as real D3D12 objects do.
+template<class InterfaceT>
+class NullDeviceChild : public InterfaceT
+{
+public:
+    explicit NullDeviceChild(NullDevice* device);
+    NullDeviceChild(const NullDeviceChild&) = delete;
+    NullDeviceChild(NullDeviceChild&&) = delete;
+    virtual ~NullDeviceChild() = default;
+
+    NullDeviceChild& operator=(const NullDeviceChild&) = delete;
+    NullDeviceChild& operator=(NullDeviceChild&&) = delete;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if(ppvObject == nullptr) { return E_POINTER; }
+
+        if(!isSupportedInterface(riid))
+        {
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        *ppvObject = static_cast<InterfaceT*>(this);
+        AddRef();
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++mRefCount; }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        const ULONG refCount = --mRefCount;
+        if(refCount == 0) { delete this; }
+        return refCount;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID /*guid*/, UINT* pDataSize, void* /*pData*/) override
+    {
+        if(pDataSize != nullptr) { *pDataSize = 0; }
+        return DXGI_ERROR_NOT_FOUND;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID /*guid*/, UINT /*DataSize*/, const void* /*pData*/) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID /*guid*/, const IUnknown* /*pData*/) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR Name) override
+    {
+        mName = (Name != nullptr) ? Name : L"";
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override;
+
+protected:
+    virtual bool isSupportedInterface(REFIID riid) const
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, InterfaceT>(riid);
+    }
+
+    ComPtr<NullDevice> mDevice;
+    std::wstring mName;
+
+private:
+    std::atomic<ULONG> mRefCount{1};
+};
+
+class NullFence final : public NullDeviceChild<ID3D12Fence>
+{
+public:
+    NullFence(NullDevice* device, UINT64 initialValue)
+        : NullDeviceChild<ID3D12Fence>(device)
+        , mCompletedValue(initialValue)
+    {}
+
+    UINT64 STDMETHODCALLTYPE GetCompletedValue() override
+    {
+        std::lock_guard lockGuard(mMutex);
+        update();
+        return mCompletedValue;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetEventOnCompletion(UINT64 Value, HANDLE hEvent) override
+    {
+        std::unique_lock lock(mMutex);
+        update();
+
+        if(mCompletedValue < Value)
+        {
+            std::optional<Clock::time_point> completionTime = getCompletionTime(Value);
+            if(!completionTime.has_value())
+            {
+                // Nothing has been scheduled to signal the value yet. The event fires once something does.
+                mPendingEvents.push_back(PendingEvent{Value, hEvent});
+                return S_OK;
+            }
+
+            // Nothing runs on the simulated timeline, so waiting for it is the same as sleeping until it catches up
+            lock.unlock();
+            std::this_thread::sleep_until(*completionTime);
+            lock.lock();
+            update();
+        }
+
+        if(hEvent != nullptr) { SetEvent(hEvent); }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Signal(UINT64 Value) override
+    {
+        scheduleSignal(Value, Clock::now());
+        return S_OK;
+    }
+
+    void scheduleSignal(UINT64 value, Clock::time_point time)
+    {
+        std::lock_guard lockGuard(mMutex);
+        mPendingSignals.push_back(PendingSignal{value, time});
+        update();
+    }
+
+    // When the fence reaches the value on the simulated timeline. Empty if nothing has been scheduled to signal it.
+    std::optional<Clock::time_point> getScheduledCompletionTime(UINT64 value)
+    {
+        std::lock_guard lockGuard(mMutex);
+        update();
+
+        if(mCompletedValue >= value) { return Clock::now(); }
+        return getCompletionTime(value);
+    }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12Fence>(riid);
+    }
+
+private:
+    struct PendingSignal
+    {
+        UINT64 value;
+        Clock::time_point time;
+    };
+
+    struct PendingEvent
+    {
+        UINT64 value;
+        HANDLE event;
+    };
+
+    // Has to be called with mMutex locked
+    void update()
+    {
+        const Clock::time_point now = Clock::now();
+
+        std::erase_if(mPendingSignals, [&](const PendingSignal& signal) {
+            if(signal.time > now) { return false; }
+
+            mCompletedValue = std::max(mCompletedValue, signal.value);
+            return true;
+        });
+
+        std::erase_if(mPendingEvents, [&](const PendingEvent& pendingEvent) {
+            if(pendingEvent.value > mCompletedValue) { return false; }
+
+            if(pendingEvent.event != nullptr) { SetEvent(pendingEvent.event); }
+            return true;
+        });
+    }
+
+    // Has to be called with mMutex locked
+    std::optional<Clock::time_point> getCompletionTime(UINT64 value) const
+    {
+        std::optional<Clock::time_point> completionTime;
+
+        for(const PendingSignal& signal : mPendingSignals)
+        {
+            if(signal.value >= value && (!completionTime.has_value() || signal.time < *completionTime))
+            {
+                completionTime = signal.time;
+            }
+        }
+
+        return completionTime;
+    }
+
+    std::mutex mMutex;
+    UINT64 mCompletedValue;
+    std::vector<PendingSignal> mPendingSignals;
+    std::vector<PendingEvent> mPendingEvents;
+};
+
+class NullCommandAllocator final : public NullDeviceChild<ID3D12CommandAllocator>
+{
+public:
+    NullCommandAllocator(NullDevice* device, D3D12_COMMAND_LIST_TYPE type)
+        : NullDeviceChild<ID3D12CommandAllocator>(device)
+        , mType(type)
+    {}
+
+    HRESULT STDMETHODCALLTYPE Reset() override { return S_OK; }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12CommandAllocator>(riid);
+    }
+
+private:
+    D3D12_COMMAND_LIST_TYPE mType;
+};
+
+class NullRootSignature final : public NullDeviceChild<ID3D12RootSignature>
+{
+public:
+    explicit NullRootSignature(NullDevice* device): NullDeviceChild<ID3D12RootSignature>(device) {}
+};
+
+class NullPipelineState final : public NullDeviceChild<ID3D12PipelineState>
+{
+public:
+    explicit NullPipelineState(NullDevice* device): NullDeviceChild<ID3D12PipelineState>(device) {}
+
+    HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob** ppBlob) override
+    {
+        if(ppBlob != nullptr) { *ppBlob = nullptr; }
+        return E_NOTIMPL;
+    }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12PipelineState>(riid);
+    }
+};
+
+class NullStateObject final : public NullDeviceChild<ID3D12StateObject>, public ID3D12StateObjectProperties
+{
+public:
+    explicit NullStateObject(NullDevice* device): NullDeviceChild<ID3D12StateObject>(device) {}
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if(ppvObject == nullptr) { return E_POINTER; }
+
+        if(riid == __uuidof(ID3D12StateObjectProperties))
+        {
+            *ppvObject = static_cast<ID3D12StateObjectProperties*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        return NullDeviceChild<ID3D12StateObject>::QueryInterface(riid, ppvObject);
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return NullDeviceChild<ID3D12StateObject>::AddRef(); }
+    ULONG STDMETHODCALLTYPE Release() override { return NullDeviceChild<ID3D12StateObject>::Release(); }
+
+    // Identifiers only have to be unique and stay the same for the lifetime of the state object
+    void* STDMETHODCALLTYPE GetShaderIdentifier(LPCWSTR pExportName) override
+    {
+        if(pExportName == nullptr) { return nullptr; }
+
+        std::lock_guard lockGuard(mMutex);
+
+        auto [itr, inserted] = mShaderIdentifiers.try_emplace(pExportName);
+        if(inserted)
+        {
+            const uint64_t identifier = mShaderIdentifiers.size();
+            std::memcpy(itr->second.data(), &identifier, sizeof(identifier));
+        }
+
+        return itr->second.data();
+    }
+
+    UINT64 STDMETHODCALLTYPE GetShaderStackSize(LPCWSTR /*pExportName*/) override { return 0; }
+    UINT64 STDMETHODCALLTYPE GetPipelineStackSize() override { return mPipelineStackSize; }
+    void STDMETHODCALLTYPE SetPipelineStackSize(UINT64 PipelineStackSizeInBytes) override
+    {
+        mPipelineStackSize = PipelineStackSizeInBytes;
+    }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12StateObject>(riid);
+    }
+
+private:
+    std::mutex mMutex;
+    std::unordered_map<std::wstring, std::array<std::byte, kNullShaderIdentifierSize>> mShaderIdentifiers;
+    UINT64 mPipelineStackSize = 0;
+};
+
+class NullDescriptorHeap final : public NullDeviceChild<ID3D12DescriptorHeap>
+{
+public:
+    NullDescriptorHeap(NullDevice* device,
+                       const D3D12_DESCRIPTOR_HEAP_DESC& desc,
+                       D3D12_CPU_DESCRIPTOR_HANDLE cpuStart,
+                       D3D12_GPU_DESCRIPTOR_HANDLE gpuStart)
+        : NullDeviceChild<ID3D12DescriptorHeap>(device)
+        , mDesc(desc)
+        , mCpuStart(cpuStart)
+        , mGpuStart(gpuStart)
+    {}
+
+    D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GetDesc() override { return mDesc; }
+    D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override { return mCpuStart; }
+    D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override { return mGpuStart; }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12DescriptorHeap>(riid);
+    }
+
+private:
+    D3D12_DESCRIPTOR_HEAP_DESC mDesc;
+    D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart;
+};
+
+// Queries are recorded into command streams but never written, so resolving them leaves the destination untouched
+class NullQueryHeap final : public NullDeviceChild<ID3D12QueryHeap>
+{
+public:
+    explicit NullQueryHeap(NullDevice* device): NullDeviceChild<ID3D12QueryHeap>(device) {}
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12QueryHeap>(riid);
+    }
+};
+
+class NullResource final : public NullDeviceChild<ID3D12Resource>
+{
+public:
+    NullResource(NullDevice* device,
+                 const D3D12_RESOURCE_DESC& desc,
+                 const D3D12_HEAP_PROPERTIES& heapProperties,
+                 D3D12_HEAP_FLAGS heapFlags,
+                 D3D12_GPU_VIRTUAL_ADDRESS gpuVirtualAddress)
+        : NullDeviceChild<ID3D12Resource>(device)
+        , mDesc(desc)
+        , mHeapProperties(heapProperties)
+        , mHeapFlags(heapFlags)
+        , mGpuVirtualAddress(gpuVirtualAddress)
+    {
+        if(IsMappable(desc, heapProperties)) { mData = std::make_unique<std::byte[]>((size_t)desc.Width); }
+    }
+
+    static bool IsMappable(const D3D12_RESOURCE_DESC& desc, const D3D12_HEAP_PROPERTIES& heapProperties)
+    {
+        return desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER &&
+               (heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD || heapProperties.Type == D3D12_HEAP_TYPE_READBACK);
+    }
+
+    HRESULT STDMETHODCALLTYPE Map(UINT Subresource, const D3D12_RANGE* /*pReadRange*/, void** ppData) override
+    {
+        if(mData == nullptr || Subresource != 0) { return E_INVALIDARG; }
+
+        if(ppData != nullptr) { *ppData = mData.get(); }
+        return S_OK;
+    }
+
+    void STDMETHODCALLTYPE Unmap(UINT /*Subresource*/, const D3D12_RANGE* /*pWrittenRange*/) override {}
+
+    D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override { return mDesc; }
+
+    D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override { return mGpuVirtualAddress; }
+
+    HRESULT STDMETHODCALLTYPE WriteToSubresource(UINT /*DstSubresource*/,
+                                                 const D3D12_BOX* /*pDstBox*/,
+                                                 const void* /*pSrcData*/,
+                                                 UINT /*SrcRowPitch*/,
+                                                 UINT /*SrcDepthPitch*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE ReadFromSubresource(void* /*pDstData*/,
+                                                  UINT /*DstRowPitch*/,
+                                                  UINT /*DstDepthPitch*/,
+                                                  UINT /*SrcSubresource*/,
+                                                  const D3D12_BOX* /*pSrcBox*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES* pHeapProperties,
+                                                D3D12_HEAP_FLAGS* pHeapFlags) override
+    {
+        if(pHeapProperties != nullptr) { *pHeapProperties = mHeapProperties; }
+        if(pHeapFlags != nullptr) { *pHeapFlags = mHeapFlags; }
+        return S_OK;
+    }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12Resource>(riid);
+    }
+
+private:
+    D3D12_RESOURCE_DESC mDesc;
+    D3D12_HEAP_PROPERTIES mHeapProperties;
+    D3D12_HEAP_FLAGS mHeapFlags;
+    D3D12_GPU_VIRTUAL_ADDRESS mGpuVirtualAddress;
+    std::unique_ptr<std::byte[]> mData;
+};
+
+class NullCommandList final : public NullDeviceChild<ID3D12GraphicsCommandList4>
+{
+public:
+    NullCommandList(NullDevice* device, D3D12_COMMAND_LIST_TYPE type, bool recording)
+        : NullDeviceChild<ID3D12GraphicsCommandList4>(device)
+        , mType(type)
+        , mRecording(recording)
+    {}
+
+    [[nodiscard]] const CommandStream& getStream() const { return mStream; }
+    [[nodiscard]] bool isRecording() const { return mRecording; }
+
+    // ID3D12CommandList
+    D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return mType; }
+
+    // ID3D12GraphicsCommandList
+    HRESULT STDMETHODCALLTYPE Close() override
+    {
+        if(!mRecording) { return E_FAIL; }
+
+        mRecording = false;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* /*pAllocator*/,
+                                    ID3D12PipelineState* pInitialState) override
+    {
+        mStream.clear();
+        mRecording = true;
+
+        if(pInitialState != nullptr) { mStream.record(CommandType::SetPipelineState, pInitialState); }
+        return S_OK;
+    }
+
+    void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* pPipelineState) override
+    {
+        mStream.record(CommandType::ClearState, pPipelineState);
+    }
+
+    void STDMETHODCALLTYPE DrawInstanced(UINT VertexCountPerInstance,
+                                         UINT InstanceCount,
+                                         UINT StartVertexLocation,
+                                         UINT StartInstanceLocation) override
+    {
+        mStream.record(CommandType::DrawInstanced, VertexCountPerInstance, InstanceCount, StartVertexLocation,
+                       StartInstanceLocation);
+    }
+
+    void STDMETHODCALLTYPE DrawIndexedInstanced(UINT IndexCountPerInstance,
+                                                UINT InstanceCount,
+                                                UINT StartIndexLocation,
+                                                INT BaseVertexLocation,
+                                                UINT StartInstanceLocation) override
+    {
+        mStream.record(CommandType::DrawIndexedInstanced, IndexCountPerInstance, InstanceCount, StartIndexLocation,
+                       BaseVertexLocation, StartInstanceLocation);
+    }
+
+    void STDMETHODCALLTYPE Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ) override
+    {
+        mStream.record(CommandType::Dispatch, ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+    }
+
+    void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource* pDstBuffer,
+                                            UINT64 DstOffset,
+                                            ID3D12Resource* pSrcBuffer,
+                                            UINT64 SrcOffset,
+                                            UINT64 NumBytes) override
+    {
+        mStream.record(CommandType::CopyBufferRegion, pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
+    }
+
+    void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION* pDst,
+                                             UINT DstX,
+                                             UINT DstY,
+                                             UINT DstZ,
+                                             const D3D12_TEXTURE_COPY_LOCATION* pSrc,
+                                             const D3D12_BOX* pSrcBox) override
+    {
+        mStream.record(CommandType::CopyTextureRegion, ValueOrDefault(pDst), DstX, DstY, DstZ,
+                       ValueOrDefault(pSrc), MakeSpan(pSrcBox, 1));
+    }
+
+    void STDMETHODCALLTYPE CopyResource(ID3D12Resource* pDstResource, ID3D12Resource* pSrcResource) override
+    {
+        mStream.record(CommandType::CopyResource, pDstResource, pSrcResource);
+    }
+
+    void STDMETHODCALLTYPE CopyTiles(ID3D12Resource* pTiledResource,
+                                     const D3D12_TILED_RESOURCE_COORDINATE* pTileRegionStartCoordinate,
+                                     const D3D12_TILE_REGION_SIZE* pTileRegionSize,
+                                     ID3D12Resource* pBuffer,
+                                     UINT64 BufferStartOffsetInBytes,
+                                     D3D12_TILE_COPY_FLAGS Flags) override
+    {
+        mStream.record(CommandType::CopyTiles, pTiledResource, ValueOrDefault(pTileRegionStartCoordinate),
+                       ValueOrDefault(pTileRegionSize), pBuffer, BufferStartOffsetInBytes, Flags);
+    }
+
+    void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource* pDstResource,
+                                              UINT DstSubresource,
+                                              ID3D12Resource* pSrcResource,
+                                              UINT SrcSubresource,
+                                              DXGI_FORMAT Format) override
+    {
+        mStream.record(CommandType::ResolveSubresource, pDstResource, DstSubresource, pSrcResource, SrcSubresource,
+                       Format);
+    }
+
+    void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology) override
+    {
+        mStream.record(CommandType::IASetPrimitiveTopology, PrimitiveTopology);
+    }
+
+    void STDMETHODCALLTYPE RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT* pViewports) override
+    {
+        mStream.record(CommandType::RSSetViewports, MakeSpan(pViewports, NumViewports));
+    }
+
+    void STDMETHODCALLTYPE RSSetScissorRects(UINT NumRects, const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::RSSetScissorRects, MakeSpan(pRects, NumRects));
+    }
+
+    void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT BlendFactor[4]) override
+    {
+        mStream.record(CommandType::OMSetBlendFactor, MakeSpan(BlendFactor, 4));
+    }
+
+    void STDMETHODCALLTYPE OMSetStencilRef(UINT StencilRef) override
+    {
+        mStream.record(CommandType::OMSetStencilRef, StencilRef);
+    }
+
+    void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* pPipelineState) override
+    {
+        mStream.record(CommandType::SetPipelineState, pPipelineState);
+    }
+
+    void STDMETHODCALLTYPE ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER* pBarriers) override
+    {
+        mStream.record(CommandType::ResourceBarrier, MakeSpan(pBarriers, NumBarriers));
+    }
+
+    void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override
+    {
+        mStream.record(CommandType::ExecuteBundle, pCommandList);
+    }
+
+    void STDMETHODCALLTYPE SetDescriptorHeaps(UINT NumDescriptorHeaps,
+                                              ID3D12DescriptorHeap* const* ppDescriptorHeaps) override
+    {
+        mStream.record(CommandType::SetDescriptorHeaps, MakeSpan(ppDescriptorHeaps, NumDescriptorHeaps));
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* pRootSignature) override
+    {
+        mStream.record(CommandType::SetComputeRootSignature, pRootSignature);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature) override
+    {
+        mStream.record(CommandType::SetGraphicsRootSignature, pRootSignature);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT RootParameterIndex,
+                                                         D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+    {
+        mStream.record(CommandType::SetComputeRootDescriptorTable, RootParameterIndex, BaseDescriptor);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT RootParameterIndex,
+                                                          D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+    {
+        mStream.record(CommandType::SetGraphicsRootDescriptorTable, RootParameterIndex, BaseDescriptor);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT RootParameterIndex,
+                                                       UINT SrcData,
+                                                       UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetComputeRoot32BitConstant, RootParameterIndex, SrcData,
+                       DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT RootParameterIndex,
+                                                        UINT SrcData,
+                                                        UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetGraphicsRoot32BitConstant, RootParameterIndex, SrcData,
+                       DestOffsetIn32BitValues);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT RootParameterIndex,
+                                                        UINT Num32BitValuesToSet,
+                                                        const void* pSrcData,
+                                                        UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetComputeRoot32BitConstants, RootParameterIndex, DestOffsetIn32BitValues,
+                       MakeSpan(static_cast<const uint32_t*>(pSrcData), Num32BitValuesToSet));
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT RootParameterIndex,
+                                                         UINT Num32BitValuesToSet,
+                                                         const void* pSrcData,
+                                                         UINT DestOffsetIn32BitValues) override
+    {
+        mStream.record(CommandType::SetGraphicsRoot32BitConstants, RootParameterIndex, DestOffsetIn32BitValues,
+                       MakeSpan(static_cast<const uint32_t*>(pSrcData), Num32BitValuesToSet));
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT RootParameterIndex,
+                                                            D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootConstantBufferView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootConstantBufferView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT RootParameterIndex,
+                                                            D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootShaderResourceView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootShaderResourceView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT RootParameterIndex,
+                                                             D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetComputeRootUnorderedAccessView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex,
+                                                              D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+    {
+        mStream.record(CommandType::SetGraphicsRootUnorderedAccessView, RootParameterIndex, BufferLocation);
+    }
+
+    void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView) override
+    {
+        mStream.record(CommandType::IASetIndexBuffer, MakeSpan(pView, 1));
+    }
+
+    void STDMETHODCALLTYPE IASetVertexBuffers(UINT StartSlot,
+                                              UINT NumViews,
+                                              const D3D12_VERTEX_BUFFER_VIEW* pViews) override
+    {
+        mStream.record(CommandType::IASetVertexBuffers, StartSlot, MakeSpan(pViews, NumViews));
+    }
+
+    void STDMETHODCALLTYPE SOSetTargets(UINT StartSlot,
+                                        UINT NumViews,
+                                        const D3D12_STREAM_OUTPUT_BUFFER_VIEW* pViews) override
+    {
+        mStream.record(CommandType::SOSetTargets, StartSlot, MakeSpan(pViews, NumViews));
+    }
+
+    void STDMETHODCALLTYPE OMSetRenderTargets(UINT NumRenderTargetDescriptors,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE* pRenderTargetDescriptors,
+                                              BOOL RTsSingleHandleToDescriptorRange,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE* pDepthStencilDescriptor) override
+    {
+        const size_t handleCount = RTsSingleHandleToDescriptorRange ? 1 : NumRenderTargetDescriptors;
+        mStream.record(CommandType::OMSetRenderTargets, NumRenderTargetDescriptors,
+                       RTsSingleHandleToDescriptorRange, ValueOrDefault(pDepthStencilDescriptor),
+                       MakeSpan(pRenderTargetDescriptors, handleCount));
+    }
+
+    void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView,
+                                                 D3D12_CLEAR_FLAGS ClearFlags,
+                                                 FLOAT Depth,
+                                                 UINT8 Stencil,
+                                                 UINT NumRects,
+                                                 const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearDepthStencilView, DepthStencilView, ClearFlags, Depth, Stencil,
+                       MakeSpan(pRects, NumRects));
+    }
+
+    void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+                                                 const FLOAT ColorRGBA[4],
+                                                 UINT NumRects,
+                                                 const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearRenderTargetView, RenderTargetView, MakeSpan(ColorRGBA, 4),
+                       MakeSpan(pRects, NumRects));
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+                                                        D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+                                                        ID3D12Resource* pResource,
+                                                        const UINT Values[4],
+                                                        UINT NumRects,
+                                                        const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearUnorderedAccessViewUint, ViewGPUHandleInCurrentHeap, ViewCPUHandle,
+                       pResource, MakeSpan(Values, 4), MakeSpan(pRects, NumRects));
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+                                                         D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+                                                         ID3D12Resource* pResource,
+                                                         const FLOAT Values[4],
+                                                         UINT NumRects,
+                                                         const D3D12_RECT* pRects) override
+    {
+        mStream.record(CommandType::ClearUnorderedAccessViewFloat, ViewGPUHandleInCurrentHeap, ViewCPUHandle,
+                       pResource, MakeSpan(Values, 4), MakeSpan(pRects, NumRects));
+    }
+
+    void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* pResource, const D3D12_DISCARD_REGION* pRegion) override
+    {
+        mStream.record(CommandType::DiscardResource, pResource, MakeSpan(pRegion, 1));
+    }
+
+    void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+    {
+        mStream.record(CommandType::BeginQuery, pQueryHeap, Type, Index);
+    }
+
+    void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+    {
+        mStream.record(CommandType::EndQuery, pQueryHeap, Type, Index);
+    }
+
+    void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap* pQueryHeap,
+                                            D3D12_QUERY_TYPE Type,
+                                            UINT StartIndex,
+                                            UINT NumQueries,
+                                            ID3D12Resource* pDestinationBuffer,
+                                            UINT64 AlignedDestinationBufferOffset) override
+    {
+        mStream.record(CommandType::ResolveQueryData, pQueryHeap, Type, StartIndex, NumQueries, pDestinationBuffer,
+                       AlignedDestinationBufferOffset);
+    }
+
+    void STDMETHODCALLTYPE SetPredication(ID3D12Resource* pBuffer,
+                                          UINT64 AlignedBufferOffset,
+                                          D3D12_PREDICATION_OP Operation) override
+    {
+        mStream.record(CommandType::SetPredication, pBuffer, AlignedBufferOffset, Operation);
+    }
+
+    void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override
+    {
+        mStream.record(CommandType::SetMarker, Metadata, MakeSpan(static_cast<const std::byte*>(pData), Size));
+    }
+
+    void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override
+    {
+        mStream.record(CommandType::BeginEvent, Metadata, MakeSpan(static_cast<const std::byte*>(pData), Size));
+    }
+
+    void STDMETHODCALLTYPE EndEvent() override { mStream.record(CommandType::EndEvent); }
+
+    void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature* pCommandSignature,
+                                           UINT MaxCommandCount,
+                                           ID3D12Resource* pArgumentBuffer,
+                                           UINT64 ArgumentBufferOffset,
+                                           ID3D12Resource* pCountBuffer,
+                                           UINT64 CountBufferOffset) override
+    {
+        mStream.record(CommandType::ExecuteIndirect, pCommandSignature, MaxCommandCount, pArgumentBuffer,
+                       ArgumentBufferOffset, pCountBuffer, CountBufferOffset);
+    }
+
+    // ID3D12GraphicsCommandList1
+    void STDMETHODCALLTYPE
+    AtomicCopyBufferUINT(ID3D12Resource* pDstBuffer,
+                         UINT64 DstOffset,
+                         ID3D12Resource* pSrcBuffer,
+                         UINT64 SrcOffset,
+                         UINT Dependencies,
+                         ID3D12Resource* const* ppDependentResources,
+                         const D3D12_SUBRESOURCE_RANGE_UINT64* pDependentSubresourceRanges) override
+    {
+        mStream.record(CommandType::AtomicCopyBufferUINT, pDstBuffer, DstOffset, pSrcBuffer, SrcOffset,
+                       MakeSpan(ppDependentResources, Dependencies),
+                       MakeSpan(pDependentSubresourceRanges, Dependencies));
+    }
+
+    void STDMETHODCALLTYPE
+    AtomicCopyBufferUINT64(ID3D12Resource* pDstBuffer,
+                           UINT64 DstOffset,
+                           ID3D12Resource* pSrcBuffer,
+                           UINT64 SrcOffset,
+                           UINT Dependencies,
+                           ID3D12Resource* const* ppDependentResources,
+                           const D3D12_SUBRESOURCE_RANGE_UINT64* pDependentSubresourceRanges) override
+    {
+        mStream.record(CommandType::AtomicCopyBufferUINT64, pDstBuffer, DstOffset, pSrcBuffer, SrcOffset,
+                       MakeSpan(ppDependentResources, Dependencies),
+                       MakeSpan(pDependentSubresourceRanges, Dependencies));
+    }
+
+    void STDMETHODCALLTYPE OMSetDepthBounds(FLOAT Min, FLOAT Max) override
+    {
+        mStream.record(CommandType::OMSetDepthBounds, Min, Max);
+    }
+
+    void STDMETHODCALLTYPE SetSamplePositions(UINT NumSamplesPerPixel,
+                                              UINT NumPixels,
+                                              D3D12_SAMPLE_POSITION* pSamplePositions) override
+    {
+        mStream.record(CommandType::SetSamplePositions, NumSamplesPerPixel, NumPixels,
+                       MakeSpan<D3D12_SAMPLE_POSITION>(pSamplePositions, (size_t)NumSamplesPerPixel * NumPixels));
+    }
+
+    void STDMETHODCALLTYPE ResolveSubresourceRegion(ID3D12Resource* pDstResource,
+                                                    UINT DstSubresource,
+                                                    UINT DstX,
+                                                    UINT DstY,
+                                                    ID3D12Resource* pSrcResource,
+                                                    UINT SrcSubresource,
+                                                    D3D12_RECT* pSrcRect,
+                                                    DXGI_FORMAT Format,
+                                                    D3D12_RESOLVE_MODE ResolveMode) override
+    {
+        mStream.record(CommandType::ResolveSubresourceRegion, pDstResource, DstSubresource, DstX, DstY,
+                       pSrcResource, SrcSubresource, Format, ResolveMode, MakeSpan<D3D12_RECT>(pSrcRect, 1));
+    }
+
+    void STDMETHODCALLTYPE SetViewInstanceMask(UINT Mask) override
+    {
+        mStream.record(CommandType::SetViewInstanceMask, Mask);
+    }
+
+    // ID3D12GraphicsCommandList2
+    void STDMETHODCALLTYPE WriteBufferImmediate(UINT Count,
+                                                const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER* pParams,
+                                                const D3D12_WRITEBUFFERIMMEDIATE_MODE* pModes) override
+    {
+        mStream.record(CommandType::WriteBufferImmediate, MakeSpan(pParams, Count), MakeSpan(pModes, Count));
+    }
+
+    // ID3D12GraphicsCommandList3
+    void STDMETHODCALLTYPE
+    SetProtectedResourceSession(ID3D12ProtectedResourceSession* pProtectedResourceSession) override
+    {
+        mStream.record(CommandType::SetProtectedResourceSession, pProtectedResourceSession);
+    }
+
+    // ID3D12GraphicsCommandList4
+    void STDMETHODCALLTYPE BeginRenderPass(UINT NumRenderTargets,
+                                           const D3D12_RENDER_PASS_RENDER_TARGET_DESC* pRenderTargets,
+                                           const D3D12_RENDER_PASS_DEPTH_STENCIL_DESC* pDepthStencil,
+                                           D3D12_RENDER_PASS_FLAGS Flags) override
+    {
+        mStream.record(CommandType::BeginRenderPass, Flags, ValueOrDefault(pDepthStencil),
+                       MakeSpan(pRenderTargets, NumRenderTargets));
+    }
+
+    void STDMETHODCALLTYPE EndRenderPass() override { mStream.record(CommandType::EndRenderPass); }
+
+    void STDMETHODCALLTYPE InitializeMetaCommand(ID3D12MetaCommand* pMetaCommand,
+                                                 const void* pInitializationParametersData,
+                                                 SIZE_T InitializationParametersDataSizeInBytes) override
+    {
+        mStream.record(CommandType::InitializeMetaCommand, pMetaCommand,
+                       MakeSpan(static_cast<const std::byte*>(pInitializationParametersData),
+                                InitializationParametersDataSizeInBytes));
+    }
+
+    void STDMETHODCALLTYPE ExecuteMetaCommand(ID3D12MetaCommand* pMetaCommand,
+                                              const void* pExecutionParametersData,
+                                              SIZE_T ExecutionParametersDataSizeInBytes) override
+    {
+        mStream.record(
+            CommandType::ExecuteMetaCommand, pMetaCommand,
+            MakeSpan(static_cast<const std::byte*>(pExecutionParametersData), ExecutionParametersDataSizeInBytes));
+    }
+
+    void STDMETHODCALLTYPE BuildRaytracingAccelerationStructure(
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC* pDesc,
+        UINT NumPostbuildInfoDescs,
+        const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC* pPostbuildInfoDescs) override
+    {
+        mStream.record(CommandType::BuildRaytracingAccelerationStructure, ValueOrDefault(pDesc),
+                       MakeSpan(pPostbuildInfoDescs, NumPostbuildInfoDescs));
+    }
+
+    void STDMETHODCALLTYPE EmitRaytracingAccelerationStructurePostbuildInfo(
+        const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC* pDesc,
+        UINT NumSourceAccelerationStructures,
+        const D3D12_GPU_VIRTUAL_ADDRESS* pSourceAccelerationStructureData) override
+    {
+        mStream.record(CommandType::EmitRaytracingAccelerationStructurePostbuildInfo, ValueOrDefault(pDesc),
+                       MakeSpan(pSourceAccelerationStructureData, NumSourceAccelerationStructures));
+    }
+
+    void STDMETHODCALLTYPE CopyRaytracingAccelerationStructure(
+        D3D12_GPU_VIRTUAL_ADDRESS DestAccelerationStructureData,
+        D3D12_GPU_VIRTUAL_ADDRESS SourceAccelerationStructureData,
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE Mode) override
+    {
+        mStream.record(CommandType::CopyRaytracingAccelerationStructure, DestAccelerationStructureData,
+                       SourceAccelerationStructureData, Mode);
+    }
+
+    void STDMETHODCALLTYPE SetPipelineState1(ID3D12StateObject* pStateObject) override
+    {
+        mStream.record(CommandType::SetPipelineState1, pStateObject);
+    }
+
+    void STDMETHODCALLTYPE DispatchRays(const D3D12_DISPATCH_RAYS_DESC* pDesc) override
+    {
+        mStream.record(CommandType::DispatchRays, ValueOrDefault(pDesc));
+    }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12CommandList, ID3D12GraphicsCommandList,
+                           ID3D12GraphicsCommandList1, ID3D12GraphicsCommandList2, ID3D12GraphicsCommandList3,
+                           ID3D12GraphicsCommandList4>(riid);
+    }
+
+private:
+    D3D12_COMMAND_LIST_TYPE mType;
+    bool mRecording;
+    CommandStream mStream;
+};
+
+class NullCommandQueue final : public NullDeviceChild<ID3D12CommandQueue>
+{
+public:
+    NullCommandQueue(NullDevice* device, const D3D12_COMMAND_QUEUE_DESC& desc)
+        : NullDeviceChild<ID3D12CommandQueue>(device)
+        , mDesc(desc)
+    {}
+
+    void STDMETHODCALLTYPE UpdateTileMappings(ID3D12Resource* /*pResource*/,
+                                              UINT /*NumResourceRegions*/,
+                                              const D3D12_TILED_RESOURCE_COORDINATE* /*pRegionStartCoordinates*/,
+                                              const D3D12_TILE_REGION_SIZE* /*pResourceRegionSizes*/,
+                                              ID3D12Heap* /*pHeap*/,
+                                              UINT /*NumRanges*/,
+                                              const D3D12_TILE_RANGE_FLAGS* /*pRangeFlags*/,
+                                              const UINT* /*pHeapRangeStartOffsets*/,
+                                              const UINT* /*pRangeTileCounts*/,
+                                              D3D12_TILE_MAPPING_FLAGS /*Flags*/) override
+    {}
+
+    void STDMETHODCALLTYPE CopyTileMappings(ID3D12Resource* /*pDstResource*/,
+                                            const D3D12_TILED_RESOURCE_COORDINATE* /*pDstRegionStartCoordinate*/,
+                                            ID3D12Resource* /*pSrcResource*/,
+                                            const D3D12_TILED_RESOURCE_COORDINATE* /*pSrcRegionStartCoordinate*/,
+                                            const D3D12_TILE_REGION_SIZE* /*pRegionSize*/,
+                                            D3D12_TILE_MAPPING_FLAGS /*Flags*/) override
+    {}
+
+    void STDMETHODCALLTYPE ExecuteCommandLists(UINT NumCommandLists, ID3D12CommandList* const* ppCommandLists) override;
+
+    void STDMETHODCALLTYPE SetMarker(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override {}
+    void STDMETHODCALLTYPE BeginEvent(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override {}
+    void STDMETHODCALLTYPE EndEvent() override {}
+
+    HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence* pFence, UINT64 Value) override
+    {
+        if(pFence == nullptr) { return E_INVALIDARG; }
+
+        std::lock_guard lockGuard(mMutex);
+        static_cast<NullFence*>(pFence)->scheduleSignal(Value, std::max(mIdleTime, Clock::now()));
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence* pFence, UINT64 Value) override
+    {
+        if(pFence == nullptr) { return E_INVALIDARG; }
+
+        std::optional<Clock::time_point> completionTime =
+            static_cast<NullFence*>(pFence)->getScheduledCompletionTime(Value);
+
+        // The real queue would stall until the fence is signaled. There's no timeline to stall on, so the wait is
+        // dropped and the queue carries on.
+        if(!completionTime.has_value())
+        {
+            spdlog::warn("Null command queue waits on fence value {} that nothing has signaled yet", Value);
+            return S_OK;
+        }
+
+        std::lock_guard lockGuard(mMutex);
+        mIdleTime = std::max(mIdleTime, *completionTime);
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64* pFrequency) override
+    {
+        if(pFrequency == nullptr) { return E_INVALIDARG; }
+
+        *pFrequency = kNullGpuTimestampFrequency;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64* pGpuTimestamp, UINT64* pCpuTimestamp) override
+    {
+        const UINT64 timestamp =
+            (UINT64)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+
+        if(pGpuTimestamp != nullptr) { *pGpuTimestamp = timestamp; }
+        if(pCpuTimestamp != nullptr) { *pCpuTimestamp = timestamp; }
+        return S_OK;
+    }
+
+    D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override { return mDesc; }
+
+protected:
+    bool isSupportedInterface(REFIID riid) const override
+    {
+        return IsInterface<IUnknown, ID3D12Object, ID3D12DeviceChild, ID3D12Pageable, ID3D12CommandQueue>(riid);
+    }
+
+private:
+    D3D12_COMMAND_QUEUE_DESC mDesc;
+
+    std::mutex mMutex;
+    Clock::time_point mIdleTime; // When the simulated queue finishes everything submitted to it so far
+};
+
+class NullDevice final : public ID3D12Device7
+{
+public:
+    explicit NullDevice(const NullDeviceOptions& options): mOptions(options) {}
+    NullDevice(const NullDevice&) = delete;
+    NullDevice(NullDevice&&) = delete;
+    virtual ~NullDevice() = default;
+
+    NullDevice& operator=(const NullDevice&) = delete;
+    NullDevice& operator=(NullDevice&&) = delete;
+
+    [[nodiscard]] const NullDeviceOptions& getOptions() const { return mOptions; }
+
+    [[nodiscard]] NullDeviceStatistics getStatistics()
+    {
+        std::lock_guard lockGuard(mStatisticsMutex);
+        return mStatistics;
+    }
+
+    void addExecutedCommandList(const CommandStream& stream)
+    {
+        std::lock_guard lockGuard(mStatisticsMutex);
+
+        ++mStatistics.executedCommandListCount;
+        mStatistics.executedCommandCount += stream.getCommandCount();
+        stream.forEach([this](CommandType commandType, std::span<const std::byte> /*payload*/) {
+            ++mStatistics.executedCommandCounts[commandType];
+        });
+    }
+
+    // IUnknown
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if(ppvObject == nullptr) { return E_POINTER; }
+
+        if(!IsInterface<IUnknown, ID3D12Object, ID3D12Device, ID3D12Device1, ID3D12Device2, ID3D12Device3,
+                        ID3D12Device4, ID3D12Device5, ID3D12Device6, ID3D12Device7>(riid))
+        {
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        *ppvObject = static_cast<ID3D12Device7*>(this);
+        AddRef();
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++mRefCount; }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        const ULONG refCount = --mRefCount;
+        if(refCount == 0) { delete this; }
+        return refCount;
+    }
+
+    // ID3D12Object
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID /*guid*/, UINT* pDataSize, void* /*pData*/) override
+    {
+        if(pDataSize != nullptr) { *pDataSize = 0; }
+        return DXGI_ERROR_NOT_FOUND;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID /*guid*/, UINT /*DataSize*/, const void* /*pData*/) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID /*guid*/, const IUnknown* /*pData*/) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR /*Name*/) override { return S_OK; }
+
+    // ID3D12Device
+    UINT STDMETHODCALLTYPE GetNodeCount() override { return 1; }
+
+    HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc,
+                                                 REFIID riid,
+                                                 void** ppCommandQueue) override;
+
+    HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE type,
+                                                     REFIID riid,
+                                                     void** ppCommandAllocator) override;
+
+    HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc,
+                                                          REFIID riid,
+                                                          void** ppPipelineState) override;
+
+    HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc,
+                                                         REFIID riid,
+                                                         void** ppPipelineState) override;
+
+    HRESULT STDMETHODCALLTYPE CreateCommandList(UINT nodeMask,
+                                                D3D12_COMMAND_LIST_TYPE type,
+                                                ID3D12CommandAllocator* pCommandAllocator,
+                                                ID3D12PipelineState* pInitialState,
+                                                REFIID riid,
+                                                void** ppCommandList) override;
+
+    HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE Feature,
+                                                  void* pFeatureSupportData,
+                                                  UINT FeatureSupportDataSize) override;
+
+    HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc,
+                                                   REFIID riid,
+                                                   void** ppvHeap) override;
+
+    UINT STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapType*/) override
+    {
+        return kNullDescriptorSize;
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateRootSignature(UINT nodeMask,
+                                                  const void* pBlobWithRootSignature,
+                                                  SIZE_T blobLengthInBytes,
+                                                  REFIID riid,
+                                                  void** ppvRootSignature) override;
+
+    void STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* /*pDesc*/,
+                                                    D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource* /*pResource*/,
+                                                    const D3D12_SHADER_RESOURCE_VIEW_DESC* /*pDesc*/,
+                                                    D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D12Resource* /*pResource*/,
+                                                     ID3D12Resource* /*pCounterResource*/,
+                                                     const D3D12_UNORDERED_ACCESS_VIEW_DESC* /*pDesc*/,
+                                                     D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource* /*pResource*/,
+                                                  const D3D12_RENDER_TARGET_VIEW_DESC* /*pDesc*/,
+                                                  D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource* /*pResource*/,
+                                                  const D3D12_DEPTH_STENCIL_VIEW_DESC* /*pDesc*/,
+                                                  D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC* /*pDesc*/,
+                                         D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptor*/) override
+    {}
+
+    void STDMETHODCALLTYPE CopyDescriptors(UINT /*NumDestDescriptorRanges*/,
+                                           const D3D12_CPU_DESCRIPTOR_HANDLE* /*pDestDescriptorRangeStarts*/,
+                                           const UINT* /*pDestDescriptorRangeSizes*/,
+                                           UINT /*NumSrcDescriptorRanges*/,
+                                           const D3D12_CPU_DESCRIPTOR_HANDLE* /*pSrcDescriptorRangeStarts*/,
+                                           const UINT* /*pSrcDescriptorRangeSizes*/,
+                                           D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapsType*/) override
+    {}
+
+    void STDMETHODCALLTYPE CopyDescriptorsSimple(UINT /*NumDescriptors*/,
+                                                 D3D12_CPU_DESCRIPTOR_HANDLE /*DestDescriptorRangeStart*/,
+                                                 D3D12_CPU_DESCRIPTOR_HANDLE /*SrcDescriptorRangeStart*/,
+                                                 D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapsType*/) override
+    {}
+
+    D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE
+    GetResourceAllocationInfo(UINT visibleMask,
+                              UINT numResourceDescs,
+                              const D3D12_RESOURCE_DESC* pResourceDescs) override
+    {
+        return GetResourceAllocationInfo1(visibleMask, numResourceDescs, pResourceDescs, nullptr);
+    }
+
+    D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType) override;
+
+    HRESULT STDMETHODCALLTYPE CreateCommittedResource(const D3D12_HEAP_PROPERTIES* pHeapProperties,
+                                                      D3D12_HEAP_FLAGS HeapFlags,
+                                                      const D3D12_RESOURCE_DESC* pDesc,
+                                                      D3D12_RESOURCE_STATES InitialResourceState,
+                                                      const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+                                                      REFIID riidResource,
+                                                      void** ppvResource) override;
+
+    HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC* /*pDesc*/, REFIID /*riid*/, void** ppvHeap) override
+    {
+        return NotImplemented(ppvHeap);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreatePlacedResource(ID3D12Heap* /*pHeap*/,
+                                                   UINT64 /*HeapOffset*/,
+                                                   const D3D12_RESOURCE_DESC* /*pDesc*/,
+                                                   D3D12_RESOURCE_STATES /*InitialState*/,
+                                                   const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/,
+                                                   REFIID /*riid*/,
+                                                   void** ppvResource) override
+    {
+        return NotImplemented(ppvResource);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateReservedResource(const D3D12_RESOURCE_DESC* /*pDesc*/,
+                                                     D3D12_RESOURCE_STATES /*InitialState*/,
+                                                     const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/,
+                                                     REFIID /*riid*/,
+                                                     void** ppvResource) override
+    {
+        return NotImplemented(ppvResource);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateSharedHandle(ID3D12DeviceChild* /*pObject*/,
+                                                 const SECURITY_ATTRIBUTES* /*pAttributes*/,
+                                                 DWORD /*Access*/,
+                                                 LPCWSTR /*Name*/,
+                                                 HANDLE* /*pHandle*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE /*NTHandle*/, REFIID /*riid*/, void** ppvObj) override
+    {
+        return NotImplemented(ppvObj);
+    }
+
+    HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR /*Name*/, DWORD /*Access*/, HANDLE* /*pNTHandle*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE MakeResident(UINT /*NumObjects*/, ID3D12Pageable* const* /*ppObjects*/) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Evict(UINT /*NumObjects*/, ID3D12Pageable* const* /*ppObjects*/) override { return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE CreateFence(UINT64 InitialValue,
+                                          D3D12_FENCE_FLAGS Flags,
+                                          REFIID riid,
+                                          void** ppFence) override;
+
+    HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+
+    void STDMETHODCALLTYPE GetCopyableFootprints(const D3D12_RESOURCE_DESC* pResourceDesc,
+                                                 UINT FirstSubresource,
+                                                 UINT NumSubresources,
+                                                 UINT64 BaseOffset,
+                                                 D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts,
+                                                 UINT* pNumRows,
+                                                 UINT64* pRowSizeInBytes,
+                                                 UINT64* pTotalBytes) override;
+
+    HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap) override
+    {
+        if(pDesc == nullptr) { return E_INVALIDARG; }
+
+        return createObject<NullQueryHeap>(riid, ppvHeap);
+    }
+
+    HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL /*Enable*/) override { return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC* /*pDesc*/,
+                                                     ID3D12RootSignature* /*pRootSignature*/,
+                                                     REFIID /*riid*/,
+                                                     void** ppvCommandSignature) override
+    {
+        return NotImplemented(ppvCommandSignature);
+    }
+
+    void STDMETHODCALLTYPE GetResourceTiling(ID3D12Resource* /*pTiledResource*/,
+                                             UINT* pNumTilesForEntireResource,
+                                             D3D12_PACKED_MIP_INFO* pPackedMipDesc,
+                                             D3D12_TILE_SHAPE* pStandardTileShapeForNonPackedMips,
+                                             UINT* pNumSubresourceTilings,
+                                             UINT /*FirstSubresourceTilingToGet*/,
+                                             D3D12_SUBRESOURCE_TILING* /*pSubresourceTilingsForNonPackedMips*/) override
+    {
+        if(pNumTilesForEntireResource != nullptr) { *pNumTilesForEntireResource = 0; }
+        if(pPackedMipDesc != nullptr) { *pPackedMipDesc = {}; }
+        if(pStandardTileShapeForNonPackedMips != nullptr) { *pStandardTileShapeForNonPackedMips = {}; }
+        if(pNumSubresourceTilings != nullptr) { *pNumSubresourceTilings = 0; }
+    }
+
+    LUID STDMETHODCALLTYPE GetAdapterLuid() override { return LUID{}; }
+
+    // ID3D12Device1
+    HRESULT STDMETHODCALLTYPE CreatePipelineLibrary(const void* /*pLibraryBlob*/,
+                                                    SIZE_T /*BlobLength*/,
+                                                    REFIID /*riid*/,
+                                                    void** ppPipelineLibrary) override
+    {
+        if(ppPipelineLibrary != nullptr) { *ppPipelineLibrary = nullptr; }
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetEventOnMultipleFenceCompletion(ID3D12Fence* const* /*ppFences*/,
+                                                                const UINT64* /*pFenceValues*/,
+                                                                UINT /*NumFences*/,
+                                                                D3D12_MULTIPLE_FENCE_WAIT_FLAGS /*Flags*/,
+                                                                HANDLE /*hEvent*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetResidencyPriority(UINT /*NumObjects*/,
+                                                   ID3D12Pageable* const* /*ppObjects*/,
+                                                   const D3D12_RESIDENCY_PRIORITY* /*pPriorities*/) override
+    {
+        return S_OK;
+    }
+
+    // ID3D12Device2
+    HRESULT STDMETHODCALLTYPE CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC* pDesc,
+                                                  REFIID riid,
+                                                  void** ppPipelineState) override;
+
+    // ID3D12Device3
+    HRESULT STDMETHODCALLTYPE OpenExistingHeapFromAddress(const void* /*pAddress*/,
+                                                          REFIID /*riid*/,
+                                                          void** ppvHeap) override
+    {
+        return NotImplemented(ppvHeap);
+    }
+
+    HRESULT STDMETHODCALLTYPE OpenExistingHeapFromFileMapping(HANDLE /*hFileMapping*/,
+                                                              REFIID /*riid*/,
+                                                              void** ppvHeap) override
+    {
+        return NotImplemented(ppvHeap);
+    }
+
+    HRESULT STDMETHODCALLTYPE EnqueueMakeResident(D3D12_RESIDENCY_FLAGS /*Flags*/,
+                                                  UINT /*NumObjects*/,
+                                                  ID3D12Pageable* const* /*ppObjects*/,
+                                                  ID3D12Fence* pFenceToSignal,
+                                                  UINT64 FenceValueToSignal) override
+    {
+        return (pFenceToSignal != nullptr) ? pFenceToSignal->Signal(FenceValueToSignal) : E_INVALIDARG;
+    }
+
+    // ID3D12Device4
+    HRESULT STDMETHODCALLTYPE CreateCommandList1(UINT nodeMask,
+                                                 D3D12_COMMAND_LIST_TYPE type,
+                                                 D3D12_COMMAND_LIST_FLAGS flags,
+                                                 REFIID riid,
+                                                 void** ppCommandList) override;
+
+    HRESULT STDMETHODCALLTYPE CreateProtectedResourceSession(const D3D12_PROTECTED_RESOURCE_SESSION_DESC* /*pDesc*/,
+                                                             REFIID /*riid*/,
+                                                             void** ppSession) override
+    {
+        return NotImplemented(ppSession);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateCommittedResource1(const D3D12_HEAP_PROPERTIES* pHeapProperties,
+                                                       D3D12_HEAP_FLAGS HeapFlags,
+                                                       const D3D12_RESOURCE_DESC* pDesc,
+                                                       D3D12_RESOURCE_STATES InitialResourceState,
+                                                       const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+                                                       ID3D12ProtectedResourceSession* /*pProtectedSession*/,
+                                                       REFIID riidResource,
+                                                       void** ppvResource) override
+    {
+        return CreateCommittedResource(pHeapProperties, HeapFlags, pDesc, InitialResourceState, pOptimizedClearValue,
+                                       riidResource, ppvResource);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateHeap1(const D3D12_HEAP_DESC* /*pDesc*/,
+                                          ID3D12ProtectedResourceSession* /*pProtectedSession*/,
+                                          REFIID /*riid*/,
+                                          void** ppvHeap) override
+    {
+        return NotImplemented(ppvHeap);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateReservedResource1(const D3D12_RESOURCE_DESC* /*pDesc*/,
+                                                      D3D12_RESOURCE_STATES /*InitialState*/,
+                                                      const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/,
+                                                      ID3D12ProtectedResourceSession* /*pProtectedSession*/,
+                                                      REFIID /*riid*/,
+                                                      void** ppvResource) override
+    {
+        return NotImplemented(ppvResource);
+    }
+
+    D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE
+    GetResourceAllocationInfo1(UINT visibleMask,
+                               UINT numResourceDescs,
+                               const D3D12_RESOURCE_DESC* pResourceDescs,
+                               D3D12_RESOURCE_ALLOCATION_INFO1* pResourceAllocationInfo1) override;
+
+    // ID3D12Device5
+    HRESULT STDMETHODCALLTYPE CreateLifetimeTracker(ID3D12LifetimeOwner* /*pOwner*/,
+                                                    REFIID /*riid*/,
+                                                    void** ppvTracker) override
+    {
+        return NotImplemented(ppvTracker);
+    }
+
+    void STDMETHODCALLTYPE RemoveDevice() override {}
+
+    HRESULT STDMETHODCALLTYPE EnumerateMetaCommands(UINT* pNumMetaCommands,
+                                                    D3D12_META_COMMAND_DESC* /*pDescs*/) override
+    {
+        if(pNumMetaCommands == nullptr) { return E_INVALIDARG; }
+
+        *pNumMetaCommands = 0;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE
+    EnumerateMetaCommandParameters(REFGUID /*CommandId*/,
+                                   D3D12_META_COMMAND_PARAMETER_STAGE /*Stage*/,
+                                   UINT* /*pTotalStructureSizeInBytes*/,
+                                   UINT* /*pParameterCount*/,
+                                   D3D12_META_COMMAND_PARAMETER_DESC* /*pParameterDescs*/) override
+    {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateMetaCommand(REFGUID /*CommandId*/,
+                                                UINT /*NodeMask*/,
+                                                const void* /*pCreationParametersData*/,
+                                                SIZE_T /*CreationParametersDataSizeInBytes*/,
+                                                REFIID /*riid*/,
+                                                void** ppMetaCommand) override
+    {
+        return NotImplemented(ppMetaCommand);
+    }
+
+    HRESULT STDMETHODCALLTYPE CreateStateObject(const D3D12_STATE_OBJECT_DESC* pDesc,
+                                                REFIID riid,
+                                                void** ppStateObject) override;
+
+    void STDMETHODCALLTYPE GetRaytracingAccelerationStructurePrebuildInfo(
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* pDesc,
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO* pInfo) override;
+
+    D3D12_DRIVER_MATCHING_IDENTIFIER_STATUS STDMETHODCALLTYPE
+    CheckDriverMatchingIdentifier(D3D12_SERIALIZED_DATA_TYPE /*SerializedDataType*/,
+                                  const D3D12_SERIALIZED_DATA_DRIVER_MATCHING_IDENTIFIER* /*pIdentifier*/) override
+    {
+        return D3D12_DRIVER_MATCHING_IDENTIFIER_UNRECOGNIZED;
+    }
+
+    // ID3D12Device6
+    HRESULT STDMETHODCALLTYPE SetBackgroundProcessingMode(D3D12_BACKGROUND_PROCESSING_MODE /*Mode*/,
+                                                          D3D12_MEASUREMENTS_ACTION /*MeasurementsAction*/,
+                                                          HANDLE /*hEventToSignalUponCompletion*/,
+                                                          BOOL* pbFurtherMeasurementsDesired) override
+    {
+        if(pbFurtherMeasurementsDesired != nullptr) { *pbFurtherMeasurementsDesired = FALSE; }
+        return S_OK;
+    }
+
+    // ID3D12Device7
+    HRESULT STDMETHODCALLTYPE AddToStateObject(const D3D12_STATE_OBJECT_DESC* pAddition,
+                                               ID3D12StateObject* pStateObjectToGrowFrom,
+                                               REFIID riid,
+                                               void** ppNewStateObject) override;
+
+    HRESULT STDMETHODCALLTYPE CreateProtectedResourceSession1(const D3D12_PROTECTED_RESOURCE_SESSION_DESC1* /*pDesc*/,
+                                                              REFIID /*riid*/,
+                                                              void** ppSession) override
+    {
+        return NotImplemented(ppSession);
+    }
+
+private:
+    static HRESULT NotImplemented(void** ppObject)
+    {
+        if(ppObject != nullptr) { *ppObject = nullptr; }
+        return E_NOTIMPL;
+    }
+
+    template<class T, class... Args>
+    HRESULT createObject(REFIID riid, void** ppObject, Args&&... args)
+    {
+        // D3D12 returns S_FALSE when it's only asked to validate the arguments
+        if(ppObject == nullptr) { return S_FALSE; }
+
+        ComPtr<T> object;
+        object.Attach(new T(this, std::forward<Args>(args)...));
+        return object->QueryInterface(riid, ppObject);
+    }
+
+    UINT64 getResourceSize(const D3D12_RESOURCE_DESC& desc);
+
+    NullDeviceOptions mOptions;
+    std::atomic<ULONG> mRefCount{1};
+
+    // Fake addresses only have to be unique. Nothing ever dereferences them.
+    std::atomic<D3D12_GPU_VIRTUAL_ADDRESS> mNextGpuVirtualAddress{D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT};
+    std::atomic<SIZE_T> mNextCpuDescriptorAddress{kNullDescriptorSize};
+    std::atomic<UINT64> mNextGpuDescriptorAddress{kNullDescriptorSize};
+
+    std::mutex mStatisticsMutex;
+    NullDeviceStatistics mStatistics;
+};
+
+template<class InterfaceT>
+NullDeviceChild<InterfaceT>::NullDeviceChild(NullDevice* device): mDevice(device)
+{}
+
+template<class InterfaceT>
+HRESULT STDMETHODCALLTYPE NullDeviceChild<InterfaceT>::GetDevice(REFIID riid, void** ppvDevice)
+{
+    return mDevice->QueryInterface(riid, ppvDevice);
+}
+
+void STDMETHODCALLTYPE NullCommandQueue::ExecuteCommandLists(UINT NumCommandLists,
+                                                             ID3D12CommandList* const* ppCommandLists)
+{
+    uint64_t commandCount = 0;
+
+    for(UINT i = 0; i < NumCommandLists; ++i)
+    {
+        const NullCommandList* commandList = static_cast<const NullCommandList*>(ppCommandLists[i]);
+        if(commandList->isRecording())
+        {
+            spdlog::error("Null command queue was asked to execute a command list that hasn't been closed");
+            continue;
+        }
+
+        commandCount += commandList->getStream().getCommandCount();
+        mDevice->addExecutedCommandList(commandList->getStream());
+    }
+
+    const std::chrono::nanoseconds duration = mDevice->getOptions().simulatedCommandDuration * commandCount;
+
+    std::lock_guard lockGuard(mMutex);
+    mIdleTime = std::max(mIdleTime, Clock::now()) + duration;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc,
+                                                         REFIID riid,
+                                                         void** ppCommandQueue)
+{
+    if(pDesc == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullCommandQueue>(riid, ppCommandQueue, *pDesc);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE type,
+                                                             REFIID riid,
+                                                             void** ppCommandAllocator)
+{
+    return createObject<NullCommandAllocator>(riid, ppCommandAllocator, type);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc,
+                                                                  REFIID riid,
+                                                                  void** ppPipelineState)
+{
+    if(pDesc == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullPipelineState>(riid, ppPipelineState);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc,
+                                                                 REFIID riid,
+                                                                 void** ppPipelineState)
+{
+    if(pDesc == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullPipelineState>(riid, ppPipelineState);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateCommandList(UINT /*nodeMask*/,
+                                                        D3D12_COMMAND_LIST_TYPE type,
+                                                        ID3D12CommandAllocator* pCommandAllocator,
+                                                        ID3D12PipelineState* pInitialState,
+                                                        REFIID riid,
+                                                        void** ppCommandList)
+{
+    if(pCommandAllocator == nullptr) { return E_INVALIDARG; }
+
+    HRESULT hr = createObject<NullCommandList>(riid, ppCommandList, type, true);
+
+    if(SUCCEEDED(hr) && ppCommandList != nullptr && pInitialState != nullptr)
+    {
+        static_cast<ID3D12GraphicsCommandList*>(*ppCommandList)->SetPipelineState(pInitialState);
+    }
+
+    return hr;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CheckFeatureSupport(D3D12_FEATURE Feature,
+                                                          void* pFeatureSupportData,
+                                                          UINT FeatureSupportDataSize)
+{
+    if(pFeatureSupportData == nullptr) { return E_INVALIDARG; }
+
+    // Reports the features DeviceContext requires so the renderers take the same paths they would on real hardware
+    switch(Feature)
+    {
+    case D3D12_FEATURE_D3D12_OPTIONS:
+    {
+        if(FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_D3D12_OPTIONS)) { return E_INVALIDARG; }
+
+        auto& options = *static_cast<D3D12_FEATURE_DATA_D3D12_OPTIONS*>(pFeatureSupportData);
+        options = {};
+        options.ResourceBindingTier = D3D12_RESOURCE_BINDING_TIER_3;
+        options.TiledResourcesTier = D3D12_TILED_RESOURCES_TIER_NOT_SUPPORTED;
+        options.ResourceHeapTier = D3D12_RESOURCE_HEAP_TIER_2;
+        return S_OK;
+    }
+    case D3D12_FEATURE_D3D12_OPTIONS5:
+    {
+        if(FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_D3D12_OPTIONS5)) { return E_INVALIDARG; }
+
+        auto& options = *static_cast<D3D12_FEATURE_DATA_D3D12_OPTIONS5*>(pFeatureSupportData);
+        options = {};
+        options.RenderPassesTier = D3D12_RENDER_PASS_TIER_0;
+        options.RaytracingTier = D3D12_RAYTRACING_TIER_1_1;
+        return S_OK;
+    }
+    case D3D12_FEATURE_SHADER_MODEL:
+    {
+        if(FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_SHADER_MODEL)) { return E_INVALIDARG; }
+
+        auto& shaderModel = *static_cast<D3D12_FEATURE_DATA_SHADER_MODEL*>(pFeatureSupportData);
+        shaderModel.HighestShaderModel = std::min(shaderModel.HighestShaderModel, D3D_SHADER_MODEL_6_6);
+        return S_OK;
+    }
+    case D3D12_FEATURE_ROOT_SIGNATURE:
+    {
+        if(FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_ROOT_SIGNATURE)) { return E_INVALIDARG; }
+
+        auto& rootSignature = *static_cast<D3D12_FEATURE_DATA_ROOT_SIGNATURE*>(pFeatureSupportData);
+        rootSignature.HighestVersion = std::min(rootSignature.HighestVersion, D3D_ROOT_SIGNATURE_VERSION_1_1);
+        return S_OK;
+    }
+    case D3D12_FEATURE_FORMAT_SUPPORT:
+    {
+        if(FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_FORMAT_SUPPORT)) { return E_INVALIDARG; }
+
+        auto& formatSupport = *static_cast<D3D12_FEATURE_DATA_FORMAT_SUPPORT*>(pFeatureSupportData);
+        formatSupport.Support1 = D3D12_FORMAT_SUPPORT1_NONE;
+        formatSupport.Support2 = D3D12_FORMAT_SUPPORT2_NONE;
+
+        const std::optional<gpufmt::Format> format = gpufmt::dxgi::translateFormat(formatSupport.Format);
+        if(!format.has_value() || gpufmt::formatInfo(*format).blockByteSize == 0) { return E_FAIL; }
+
+        switch(formatSupport.Format)
+        {
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT: [[fallthrough]];
+        case DXGI_FORMAT_D32_FLOAT: [[fallthrough]];
+        case DXGI_FORMAT_D24_UNORM_S8_UINT: [[fallthrough]];
+        case DXGI_FORMAT_D16_UNORM:
+            formatSupport.Support1 = D3D12_FORMAT_SUPPORT1_TEXTURE2D | D3D12_FORMAT_SUPPORT1_DEPTH_STENCIL;
+            break;
+        case DXGI_FORMAT_R16_UINT: [[fallthrough]];
+        case DXGI_FORMAT_R32_UINT:
+            formatSupport.Support1 = D3D12_FORMAT_SUPPORT1_BUFFER | D3D12_FORMAT_SUPPORT1_IA_INDEX_BUFFER |
+                                     D3D12_FORMAT_SUPPORT1_TEXTURE2D | D3D12_FORMAT_SUPPORT1_RENDER_TARGET |
+                                     D3D12_FORMAT_SUPPORT1_SHADER_LOAD;
+            break;
+        default:
+            if(gpufmt::formatInfo(*format).blockExtent.x > 1)
+            {
+                // Block compressed formats can only be sampled
+                formatSupport.Support1 = D3D12_FORMAT_SUPPORT1_TEXTURE2D | D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE;
+                break;
+            }
+
+            formatSupport.Support1 = D3D12_FORMAT_SUPPORT1_BUFFER | D3D12_FORMAT_SUPPORT1_TEXTURE2D |
+                                     D3D12_FORMAT_SUPPORT1_RENDER_TARGET | D3D12_FORMAT_SUPPORT1_SHADER_LOAD |
+                                     D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE;
+            break;
+        }
+
+        return S_OK;
+    }
+    default: return E_INVALIDARG;
+    }
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc,
+                                                           REFIID riid,
+                                                           void** ppvHeap)
+{
+    if(pDescriptorHeapDesc == nullptr) { return E_INVALIDARG; }
+
+    const SIZE_T heapSize = (SIZE_T)pDescriptorHeapDesc->NumDescriptors * kNullDescriptorSize;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuStart{mNextCpuDescriptorAddress.fetch_add(heapSize + kNullDescriptorSize)};
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuStart{0};
+
+    if((pDescriptorHeapDesc->Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0)
+    {
+        gpuStart.ptr = mNextGpuDescriptorAddress.fetch_add(heapSize + kNullDescriptorSize);
+    }
+
+    return createObject<NullDescriptorHeap>(riid, ppvHeap, *pDescriptorHeapDesc, cpuStart, gpuStart);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateRootSignature(UINT /*nodeMask*/,
+                                                          const void* pBlobWithRootSignature,
+                                                          SIZE_T blobLengthInBytes,
+                                                          REFIID riid,
+                                                          void** ppvRootSignature)
+{
+    if(pBlobWithRootSignature == nullptr || blobLengthInBytes == 0) { return E_INVALIDARG; }
+
+    return createObject<NullRootSignature>(riid, ppvRootSignature);
+}
+
+D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE NullDevice::GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType)
+{
+    D3D12_HEAP_PROPERTIES heapProperties{};
+    heapProperties.Type = D3D12_HEAP_TYPE_CUSTOM;
+    heapProperties.CreationNodeMask = nodeMask;
+    heapProperties.VisibleNodeMask = nodeMask;
+
+    switch(heapType)
+    {
+    case D3D12_HEAP_TYPE_UPLOAD:
+        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE;
+        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+        break;
+    case D3D12_HEAP_TYPE_READBACK:
+        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK;
+        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+        break;
+    default:
+        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE;
+        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L1;
+        break;
+    }
+
+    return heapProperties;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateCommittedResource(const D3D12_HEAP_PROPERTIES* pHeapProperties,
+                                                              D3D12_HEAP_FLAGS HeapFlags,
+                                                              const D3D12_RESOURCE_DESC* pDesc,
+                                                              D3D12_RESOURCE_STATES /*InitialResourceState*/,
+                                                              const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/,
+                                                              REFIID riidResource,
+                                                              void** ppvResource)
+{
+    if(pHeapProperties == nullptr || pDesc == nullptr) { return E_INVALIDARG; }
+    if(ppvResource == nullptr) { return S_FALSE; }
+
+    D3D12_GPU_VIRTUAL_ADDRESS gpuVirtualAddress = 0;
+    if(pDesc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        const UINT64 size = AlignInteger<UINT64>(pDesc->Width, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        gpuVirtualAddress = mNextGpuVirtualAddress.fetch_add(size);
+    }
+
+    HRESULT hr = createObject<NullResource>(riidResource, ppvResource, *pDesc, *pHeapProperties, HeapFlags,
+                                            gpuVirtualAddress);
+    if(FAILED(hr)) { return hr; }
+
+    std::lock_guard lockGuard(mStatisticsMutex);
+    ++mStatistics.createdResourceCount;
+    if(NullResource::IsMappable(*pDesc, *pHeapProperties)) { mStatistics.mappableResourceBytes += pDesc->Width; }
+
+    return hr;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateFence(UINT64 InitialValue,
+                                                  D3D12_FENCE_FLAGS /*Flags*/,
+                                                  REFIID riid,
+                                                  void** ppFence)
+{
+    return createObject<NullFence>(riid, ppFence, InitialValue);
+}
+
+// Lays subresources out the same way the runtime does: rows aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and
+// subresources aligned to D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT. Planar formats are treated as a single plane.
+void STDMETHODCALLTYPE NullDevice::GetCopyableFootprints(const D3D12_RESOURCE_DESC* pResourceDesc,
+                                                         UINT FirstSubresource,
+                                                         UINT NumSubresources,
+                                                         UINT64 BaseOffset,
+                                                         D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts,
+                                                         UINT* pNumRows,
+                                                         UINT64* pRowSizeInBytes,
+                                                         UINT64* pTotalBytes)
+{
+    if(pResourceDesc == nullptr) { return; }
+
+    const D3D12_RESOURCE_DESC& desc = *pResourceDesc;
+
+    if(desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        if(pLayouts != nullptr)
+        {
+            pLayouts[0].Offset = BaseOffset;
+            pLayouts[0].Footprint = {DXGI_FORMAT_UNKNOWN, (UINT)desc.Width, 1, 1,
+                                     AlignInteger<UINT>((UINT)desc.Width, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)};
+        }
+        if(pNumRows != nullptr) { pNumRows[0] = 1; }
+        if(pRowSizeInBytes != nullptr) { pRowSizeInBytes[0] = desc.Width; }
+        if(pTotalBytes != nullptr) { *pTotalBytes = desc.Width; }
+        return;
+    }
+
+    const std::optional<gpufmt::Format> format = gpufmt::dxgi::translateFormat(desc.Format);
+    if(!format.has_value() || gpufmt::formatInfo(*format).blockByteSize == 0)
+    {
+        if(pTotalBytes != nullptr) { *pTotalBytes = std::numeric_limits<UINT64>::max(); }
+        return;
+    }
+
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(*format);
+    const UINT mipLevels = std::max<UINT>(desc.MipLevels, 1u);
+
+    UINT64 offset = BaseOffset;
+    UINT64 totalBytes = 0;
+
+    for(UINT i = 0; i < NumSubresources; ++i)
+    {
+        const UINT subresource = FirstSubresource + i;
+        const UINT mip = subresource % mipLevels;
+
+        const UINT width = std::max<UINT>((UINT)(desc.Width >> mip), 1u);
+        const UINT height = std::max<UINT>(desc.Height >> mip, 1u);
+        const UINT depth =
+            (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? std::max<UINT>(desc.DepthOrArraySize >> mip, 1u)
+                                                                   : 1u;
+
+        const UINT blockCountX = (width + formatInfo.blockExtent.x - 1) / formatInfo.blockExtent.x;
+        const UINT blockCountY = (height + formatInfo.blockExtent.y - 1) / formatInfo.blockExtent.y;
+        const UINT64 rowSize = (UINT64)blockCountX * formatInfo.blockByteSize;
+        const UINT rowPitch = AlignInteger<UINT>((UINT)rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+        offset = AlignInteger<UINT64>(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        if(pLayouts != nullptr)
+        {
+            pLayouts[i].Offset = offset;
+            pLayouts[i].Footprint = {desc.Format, blockCountX * formatInfo.blockExtent.x,
+                                     blockCountY * formatInfo.blockExtent.y, depth, rowPitch};
+        }
+        if(pNumRows != nullptr) { pNumRows[i] = blockCountY; }
+        if(pRowSizeInBytes != nullptr) { pRowSizeInBytes[i] = rowSize; }
+
+        const UINT64 subresourceSize = (UINT64)rowPitch * (blockCountY * depth - 1) + rowSize;
+        totalBytes = offset + subresourceSize - BaseOffset;
+        offset += (UINT64)rowPitch * blockCountY * depth;
+    }
+
+    if(pTotalBytes != nullptr) { *pTotalBytes = totalBytes; }
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC* pDesc,
+                                                          REFIID riid,
+                                                          void** ppPipelineState)
+{
+    if(pDesc == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullPipelineState>(riid, ppPipelineState);
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateCommandList1(UINT /*nodeMask*/,
+                                                         D3D12_COMMAND_LIST_TYPE type,
+                                                         D3D12_COMMAND_LIST_FLAGS /*flags*/,
+                                                         REFIID riid,
+                                                         void** ppCommandList)
+{
+    return createObject<NullCommandList>(riid, ppCommandList, type, false);
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE
+NullDevice::GetResourceAllocationInfo1(UINT /*visibleMask*/,
+                                       UINT numResourceDescs,
+                                       const D3D12_RESOURCE_DESC* pResourceDescs,
+                                       D3D12_RESOURCE_ALLOCATION_INFO1* pResourceAllocationInfo1)
+{
+    D3D12_RESOURCE_ALLOCATION_INFO allocationInfo{0, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT};
+
+    for(UINT i = 0; i < numResourceDescs; ++i)
+    {
+        const D3D12_RESOURCE_DESC& desc = pResourceDescs[i];
+        const UINT64 alignment = (desc.Alignment != 0) ? desc.Alignment : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        const UINT64 size = AlignInteger<UINT64>(getResourceSize(desc), alignment);
+        const UINT64 offset = AlignInteger<UINT64>(allocationInfo.SizeInBytes, alignment);
+
+        if(pResourceAllocationInfo1 != nullptr) { pResourceAllocationInfo1[i] = {offset, alignment, size}; }
+
+        allocationInfo.SizeInBytes = offset + size;
+        allocationInfo.Alignment = std::max(allocationInfo.Alignment, alignment);
+    }
+
+    return allocationInfo;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::CreateStateObject(const D3D12_STATE_OBJECT_DESC* pDesc,
+                                                        REFIID riid,
+                                                        void** ppStateObject)
+{
+    if(pDesc == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullStateObject>(riid, ppStateObject);
+}
+
+void STDMETHODCALLTYPE NullDevice::GetRaytracingAccelerationStructurePrebuildInfo(
+    const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* pDesc,
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO* pInfo)
+{
+    if(pDesc == nullptr || pInfo == nullptr) { return; }
+
+    // Sizes only have to be plausible. They are what the renderer allocates its acceleration structure buffers with.
+    constexpr UINT64 kBytesPerPrimitive = 64;
+    constexpr UINT64 kBytesPerInstance = 64;
+    constexpr UINT64 kHeaderSize = 256;
+
+    UINT64 elementCount = 0;
+
+    if(pDesc->Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL)
+    {
+        elementCount = (UINT64)pDesc->NumDescs * (kBytesPerInstance / kBytesPerPrimitive);
+    }
+    else
+    {
+        for(UINT i = 0; i < pDesc->NumDescs; ++i)
+        {
+            const D3D12_RAYTRACING_GEOMETRY_DESC& geometry = (pDesc->DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY)
+                                                                 ? pDesc->pGeometryDescs[i]
+                                                                 : *pDesc->ppGeometryDescs[i];
+
+            if(geometry.Type == D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES)
+            {
+                const UINT vertexCount = (geometry.Triangles.IndexCount != 0) ? geometry.Triangles.IndexCount
+                                                                               : geometry.Triangles.VertexCount;
+                elementCount += vertexCount / 3;
+            }
+            else
+            {
+                elementCount += geometry.AABBs.AABBCount;
+            }
+        }
+    }
+
+    constexpr UINT64 kAlignment = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT;
+    pInfo->ResultDataMaxSizeInBytes = AlignInteger(kHeaderSize + elementCount * kBytesPerPrimitive, kAlignment);
+    pInfo->ScratchDataSizeInBytes = AlignInteger(kHeaderSize + elementCount * kBytesPerPrimitive / 2, kAlignment);
+    pInfo->UpdateScratchDataSizeInBytes = pInfo->ScratchDataSizeInBytes;
+}
+
+HRESULT STDMETHODCALLTYPE NullDevice::AddToStateObject(const D3D12_STATE_OBJECT_DESC* pAddition,
+                                                       ID3D12StateObject* pStateObjectToGrowFrom,
+                                                       REFIID riid,
+                                                       void** ppNewStateObject)
+{
+    if(pAddition == nullptr || pStateObjectToGrowFrom == nullptr) { return E_INVALIDARG; }
+
+    return createObject<NullStateObject>(riid, ppNewStateObject);
+}
+
+UINT64 NullDevice::getResourceSize(const D3D12_RESOURCE_DESC& desc)
+{
+    if(desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) { return desc.Width; }
+
+    const UINT arraySize = (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? 1u : desc.DepthOrArraySize;
+    const UINT subresourceCount = std::max<UINT>(desc.MipLevels, 1u) * arraySize;
+
+    UINT64 totalBytes = 0;
+    GetCopyableFootprints(&desc, 0, subresourceCount, 0, nullptr, nullptr, nullptr, &totalBytes);
+    return totalBytes;
+}
+} // namespace
+
+HRESULT CreateNullDevice(const NullDeviceOptions& options, REFIID riid, void** ppDevice)
+{
+    if(ppDevice == nullptr) { return E_INVALIDARG; }
+
+    ComPtr<NullDevice> device;
+    device.Attach(new NullDevice(options));
+    return device->QueryInterface(riid, ppDevice);
+}
+
+NullDeviceStatistics GetNullDeviceStatistics(ID3D12Device* device)
+{
+    return static_cast<NullDevice*>(device)->getStatistics();
+}
+
+const CommandStream& GetNullCommandStream(ID3D12CommandList* commandList)
+{
+    return static_cast<NullCommandList*>(commandList)->getStream();
+}
+} // namespace scrap::d3d12
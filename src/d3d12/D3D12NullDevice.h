@@ -0,0 +1,51 @@
+// A D3D12 device that doesn't need a gpu. CreateNullDevice returns an ID3D12Device7 whose objects implement the
+// interfaces DeviceContext, GraphicsCommandList, Buffer, Texture, GpuProfiler and the descriptor heaps use, so the
+// renderer's cpu paths can run and be measured on machines without a gpu or driver.
+//
+// Nothing is ever executed. Command lists record their calls into a CommandStream. Resources only have memory when
+// the cpu can map them (upload and readback heaps) and views, descriptors and shaders are accepted and ignored. Fences
+// either complete as soon as they are signaled, or on a simulated timeline where every submitted command keeps the
+// queue busy for NullDeviceOptions::simulatedCommandDuration.
+//
+// This is a Windows backend. It implements the d3d12 COM interfaces, so it still builds against the Windows SDK
+// headers and WRL, waits on Win32 events and compiles shaders through DXC. It lets the whole frame loop run on Windows
+// machines without a usable gpu. It doesn't make the renderer build on other platforms, that would need the
+// renderer to stop talking to d3d12 types directly.
+
+#pragma once
+
+#include "EnumArray.h"
+#include "d3d12/D3D12CommandStream.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include <d3d12.h>
+
+namespace scrap::d3d12
+{
+struct NullDeviceOptions
+{
+    // How long each command in a submitted command list keeps the queue busy. Zero completes every fence signal as soon
+    // as it's submitted.
+    std::chrono::nanoseconds simulatedCommandDuration{0};
+};
+
+struct NullDeviceStatistics
+{
+    uint64_t executedCommandListCount = 0;
+    uint64_t executedCommandCount = 0;
+    EnumArray<uint64_t, CommandType> executedCommandCounts{};
+    uint64_t createdResourceCount = 0;
+    uint64_t mappableResourceBytes = 0;
+};
+
+HRESULT CreateNullDevice(const NullDeviceOptions& options, REFIID riid, void** ppDevice);
+
+// Only valid for devices created by CreateNullDevice
+[[nodiscard]] NullDeviceStatistics GetNullDeviceStatistics(ID3D12Device* device);
+
+// The commands recorded into a command list created by a null device since it was last reset. Only valid for command
+// lists created by a null device.
+[[nodiscard]] const CommandStream& GetNullCommandStream(ID3D12CommandList* commandList);
+} // namespace scrap::d3d12
@@ -0,0 +1,159 @@
+#include "d3d12/D3D12ParallelCommandRecorder.h"
+
+#include "CpuProfiler.h"
+#include "JobSystem.h"
+
+#include <d3d12.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap::d3d12
+{
+ParallelCommandRecorder::ParallelCommandRecorder(D3D12_COMMAND_LIST_TYPE type,
+                                                 std::string_view debugName,
+                                                 uint32_t workerCount)
+    : mCommandListType(type)
+    , mDebugName(debugName)
+{
+    if(workerCount == 0) { workerCount = JobSystem::instance().getThreadCount(); }
+
+    mWorkerPools.resize(workerCount);
+}
+
+void ParallelCommandRecorder::record(size_t itemCount, size_t minItemsPerChunk, const RecordChunkFunction& recordChunk)
+{
+    SCRAP_CPU_ZONE("ParallelCommandRecorder::record");
+
+    mPlan = CommandRecordingPlan(itemCount, getWorkerCount(), minItemsPerChunk);
+    mRecordedCommandLists.assign(mPlan.getChunks().size(), nullptr);
+
+    // The single chunk of an empty draw list has nothing to record
+    if(itemCount == 0) { return; }
+
+    // Worker 0 is the calling thread. A recording worker is one job, so each pool is only used by one thread at a time
+    // no matter which job system thread picks the job up.
+    JobSystem& jobSystem = JobSystem::instance();
+    JobCounter counter;
+
+    for(uint32_t workerIndex = 1; workerIndex < getWorkerCount(); ++workerIndex)
+    {
+        if(workerIndex >= mPlan.getChunks().size()) { break; }
+
+        const RecordChunkFunction* recordChunkPointer = &recordChunk;
+        jobSystem.run(
+            [this, workerIndex, recordChunkPointer]() { recordWorkerChunks(workerIndex, *recordChunkPointer); },
+            &counter);
+    }
+
+    recordWorkerChunks(0, recordChunk);
+
+    jobSystem.wait(counter);
+}
+
+HRESULT ParallelCommandRecorder::execute(ID3D12CommandQueue* commandQueue,
+                                         std::span<GraphicsCommandList* const> leadingCommandLists,
+                                         std::span<GraphicsCommandList* const> trailingCommandLists)
+{
+    SCRAP_CPU_ZONE("ParallelCommandRecorder::execute");
+
+    std::vector<ID3D12CommandList*> commandLists;
+    // Room for a pending barrier command list in front of each one
+    const size_t commandListCount =
+        leadingCommandLists.size() + mRecordedCommandLists.size() + trailingCommandLists.size();
+    commandLists.reserve(2 * commandListCount);
+
+    auto closeAndAppend = [&commandLists](GraphicsCommandList* commandList) {
+        if(commandList == nullptr) { return S_OK; }
+
+        HRESULT hr = commandList->close();
+        if(FAILED(hr)) { return hr; }
+
+        // Resolved in submission order, so each command list starts from the states the previous one left behind
+        if(ID3D12CommandList* pendingBarrierCommandList = commandList->resolvePendingResourceBarriers())
+        {
+            commandLists.push_back(pendingBarrierCommandList);
+        }
+
+        commandLists.push_back(commandList->getForSubmission());
+        return S_OK;
+    };
+
+    for(GraphicsCommandList* commandList : leadingCommandLists)
+    {
+        HRESULT hr = closeAndAppend(commandList);
+        if(FAILED(hr)) { return hr; }
+    }
+
+    for(GraphicsCommandList* commandList : mRecordedCommandLists)
+    {
+        HRESULT hr = closeAndAppend(commandList);
+        if(FAILED(hr)) { return hr; }
+    }
+
+    for(GraphicsCommandList* commandList : trailingCommandLists)
+    {
+        HRESULT hr = closeAndAppend(commandList);
+        if(FAILED(hr)) { return hr; }
+    }
+
+    mRecordedCommandLists.clear();
+
+    if(commandLists.empty()) { return S_OK; }
+
+    commandQueue->ExecuteCommandLists((UINT)commandLists.size(), commandLists.data());
+
+    return S_OK;
+}
+
+void ParallelCommandRecorder::endFrame()
+{
+    for(WorkerPool& workerPool : mWorkerPools)
+    {
+        for(std::unique_ptr<GraphicsCommandList>& commandList : workerPool.commandLists)
+        {
+            commandList->endFrame();
+        }
+
+        workerPool.nextCommandList = 0;
+    }
+}
+
+GraphicsCommandList* ParallelCommandRecorder::acquireCommandList(uint32_t workerIndex)
+{
+    WorkerPool& workerPool = mWorkerPools[workerIndex];
+
+    if(workerPool.nextCommandList == workerPool.commandLists.size())
+    {
+        const std::string debugName =
+            fmt::format("{} worker {}[{}]", mDebugName, workerIndex, workerPool.commandLists.size());
+        workerPool.commandLists.push_back(std::make_unique<GraphicsCommandList>(mCommandListType, debugName));
+    }
+
+    GraphicsCommandList* commandList = workerPool.commandLists[workerPool.nextCommandList].get();
+
+    if(FAILED(commandList->beginRecording()))
+    {
+        spdlog::error("Failed to begin recording '{}' worker {} command list", mDebugName, workerIndex);
+        return nullptr;
+    }
+
+    ++workerPool.nextCommandList;
+
+    return commandList;
+}
+
+void ParallelCommandRecorder::recordWorkerChunks(uint32_t workerIndex, const RecordChunkFunction& recordChunk)
+{
+    SCRAP_CPU_ZONE("ParallelCommandRecorder::recordWorkerChunks");
+
+    for(uint32_t chunkIndex : mPlan.getWorkerChunkIndices(workerIndex))
+    {
+        GraphicsCommandList* commandList = acquireCommandList(workerIndex);
+        if(commandList == nullptr) { continue; }
+
+        recordChunk(*commandList, mPlan.getChunks()[chunkIndex]);
+
+        mRecordedCommandLists[chunkIndex] = commandList;
+    }
+}
+} // namespace scrap::d3d12
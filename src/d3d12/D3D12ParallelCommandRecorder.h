@@ -0,0 +1,75 @@
+// ParallelCommandRecorder records a pass's draw list on the JobSystem's threads. The draw list is split up by a
+// CommandRecordingPlan and each chunk is recorded into its own GraphicsCommandList. Every worker has its own pool of
+// command lists, so workers never share a command list. Allocators come from the queue's CommandAllocatorPool. Once
+// all of the chunks are recorded, the command lists are submitted in chunk order with a single ExecuteCommandLists
+// call.
+//
+// Command lists don't inherit any state from each other. The record function has to bind all of the pass state
+// (descriptor heaps, root signature, render targets, viewport, ...) at the start of every chunk.
+
+#pragma once
+
+#include "CommandRecordingPlan.h"
+#include "d3d12/D3D12CommandList.h"
+#include "d3d12/D3D12Fwd.h"
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scrap::d3d12
+{
+class ParallelCommandRecorder
+{
+public:
+    using RecordChunkFunction = std::function<void(GraphicsCommandList& commandList, const RecordingChunk& chunk)>;
+
+    // A worker count of 0 picks one worker per JobSystem thread
+    ParallelCommandRecorder(D3D12_COMMAND_LIST_TYPE type, std::string_view debugName, uint32_t workerCount = 0);
+    ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+    ParallelCommandRecorder(ParallelCommandRecorder&&) = default;
+    ~ParallelCommandRecorder() = default;
+
+    ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+    ParallelCommandRecorder& operator=(ParallelCommandRecorder&&) = default;
+
+    [[nodiscard]] uint32_t getWorkerCount() const { return (uint32_t)mWorkerPools.size(); }
+
+    // Splits itemCount items into chunks and records each chunk on a worker. The first chunk is recorded on the calling
+    // thread. Blocks until every chunk has been recorded.
+    void record(size_t itemCount, size_t minItemsPerChunk, const RecordChunkFunction& recordChunk);
+
+    // Closes the recorded command lists and submits them with one ExecuteCommandLists call. The leading lists go
+    // first, then the recorded chunks in chunk order, then the trailing lists. Each list's pending resource barriers
+    // are resolved in that order.
+    HRESULT execute(ID3D12CommandQueue* commandQueue,
+                    std::span<GraphicsCommandList* const> leadingCommandLists = {},
+                    std::span<GraphicsCommandList* const> trailingCommandLists = {});
+
+    void endFrame();
+
+private:
+    struct WorkerPool
+    {
+        std::vector<std::unique_ptr<GraphicsCommandList>> commandLists;
+        size_t nextCommandList = 0;
+    };
+
+    // Only called from the worker that owns the pool
+    GraphicsCommandList* acquireCommandList(uint32_t workerIndex);
+
+    void recordWorkerChunks(uint32_t workerIndex, const RecordChunkFunction& recordChunk);
+
+    D3D12_COMMAND_LIST_TYPE mCommandListType;
+    std::string mDebugName;
+    std::vector<WorkerPool> mWorkerPools;
+
+    CommandRecordingPlan mPlan;
+
+    // Indexed by chunk index. Each worker only writes the entries for its own chunks.
+    std::vector<GraphicsCommandList*> mRecordedCommandLists;
+};
+} // namespace scrap::d3d12
@@ -0,0 +1,133 @@
+#include "d3d12/D3D12QueueScheduleExecutor.h"
+
+#include "EnumArray.h"
+#include "d3d12/D3D12Context.h"
+
+#include <d3d12.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap::d3d12
+{
+namespace
+{
+struct QueueTarget
+{
+    ID3D12CommandQueue* commandQueue = nullptr;
+    ID3D12Fence* syncFence = nullptr;
+    uint64_t baseSyncValue = 0;
+};
+
+template<class ContextT>
+QueueTarget CreateQueueTarget(ContextT& context, uint32_t signalCount)
+{
+    return QueueTarget{context.getCommandQueue(), context.getSyncFence(), context.reserveSyncValues(signalCount)};
+}
+
+[[nodiscard]] constexpr D3D12_COMMAND_LIST_TYPE TranslateCommandQueueType(CommandQueueType queueType)
+{
+    switch(queueType)
+    {
+    case scrap::CommandQueueType::Graphics: return D3D12_COMMAND_LIST_TYPE_DIRECT;
+    case scrap::CommandQueueType::Compute: return D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    case scrap::CommandQueueType::Copy: return D3D12_COMMAND_LIST_TYPE_COPY;
+    default: assert(false); return D3D12_COMMAND_LIST_TYPE_DIRECT;
+    }
+}
+} // namespace
+
+HRESULT QueueScheduleExecutor::execute(const QueueScheduler& scheduler,
+                                       std::span<GraphicsCommandList* const> commandLists)
+{
+    if(!scheduler.isCompiled())
+    {
+        spdlog::error("Tried to execute a queue schedule that hasn't been compiled");
+        return E_INVALIDARG;
+    }
+
+    if(commandLists.size() < scheduler.getWorkCount())
+    {
+        spdlog::error("Queue schedule has {} work items, but only {} command lists were provided",
+                      scheduler.getWorkCount(), commandLists.size());
+        return E_INVALIDARG;
+    }
+
+    for(uint32_t workIndex = 0; workIndex < scheduler.getWorkCount(); ++workIndex)
+    {
+        const GraphicsCommandList* commandList = commandLists[workIndex];
+        const CommandQueueType queue = scheduler.getWorkQueue(workIndex);
+
+        if(commandList != nullptr && commandList->get()->GetType() != TranslateCommandQueueType(queue))
+        {
+            spdlog::error("Command list for '{}' can't be submitted to the {} queue", scheduler.getWorkName(workIndex),
+                          queue);
+            return E_INVALIDARG;
+        }
+    }
+
+    DeviceContext& deviceContext = DeviceContext::instance();
+
+    EnumArray<QueueTarget, CommandQueueType> queueTargets;
+    queueTargets[CommandQueueType::Graphics] = CreateQueueTarget(deviceContext.getGraphicsContext(),
+                                                                 scheduler.getSignalCount(CommandQueueType::Graphics));
+    queueTargets[CommandQueueType::Compute] = CreateQueueTarget(deviceContext.getComputeContext(),
+                                                                scheduler.getSignalCount(CommandQueueType::Compute));
+    queueTargets[CommandQueueType::Copy] = CreateQueueTarget(deviceContext.getCopyContext(),
+                                                             scheduler.getSignalCount(CommandQueueType::Copy));
+
+    for(const QueueBatch& batch : scheduler.getBatches())
+    {
+        const QueueTarget& target = queueTargets[batch.queue];
+
+        for(const QueueWait& wait : scheduler.getWaits(batch))
+        {
+            const QueueTarget& signalingTarget = queueTargets[wait.queue];
+
+            // https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12commandqueue-wait
+            HRESULT hr = target.commandQueue->Wait(signalingTarget.syncFence,
+                                                   signalingTarget.baseSyncValue + wait.signalValue);
+            if(FAILED(hr))
+            {
+                spdlog::error("Failed to make the {} queue wait on the {} queue", batch.queue, wait.queue);
+                return hr;
+            }
+        }
+
+        mCommandListBuffer.clear();
+
+        for(uint32_t workIndex : scheduler.getWork(batch))
+        {
+            GraphicsCommandList* commandList = commandLists[workIndex];
+            if(commandList == nullptr) { continue; }
+
+            HRESULT hr = commandList->close();
+            if(FAILED(hr)) { return hr; }
+
+            // Resolved in submission order, so each command list starts from the states the previous one left behind
+            if(ID3D12CommandList* pendingBarrierCommandList = commandList->resolvePendingResourceBarriers())
+            {
+                mCommandListBuffer.push_back(pendingBarrierCommandList);
+            }
+
+            mCommandListBuffer.push_back(commandList->getForSubmission());
+        }
+
+        if(!mCommandListBuffer.empty())
+        {
+            target.commandQueue->ExecuteCommandLists((UINT)mCommandListBuffer.size(), mCommandListBuffer.data());
+        }
+
+        // Signaled even if the batch ended up empty, something on another queue is waiting for it
+        if(batch.signalValue != 0)
+        {
+            HRESULT hr = target.commandQueue->Signal(target.syncFence, target.baseSyncValue + batch.signalValue);
+            if(FAILED(hr))
+            {
+                spdlog::error("Failed to signal the {} queue's sync fence", batch.queue);
+                return hr;
+            }
+        }
+    }
+
+    return S_OK;
+}
+} // namespace scrap::d3d12
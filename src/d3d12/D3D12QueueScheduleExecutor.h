@@ -0,0 +1,40 @@
+// QueueScheduleExecutor submits the batches of a compiled QueueScheduler to the graphics, compute and copy queues. Each
+// wait becomes an ID3D12CommandQueue::Wait on the signaling context's sync fence and each signal an
+// ID3D12CommandQueue::Signal after the batch's command lists. The scheduler's signal values are relative to the
+// schedule, so the executor reserves a range of sync fence values on every context before submitting.
+//
+// Pending resource barriers are resolved in submission order, the same as ParallelCommandRecorder. Compute command
+// lists can only transition resources between states the compute queue supports, so resources shared with the
+// graphics queue should be handed over in a state like D3D12_RESOURCE_STATE_COMMON or UNORDERED_ACCESS.
+
+#pragma once
+
+#include "QueueScheduler.h"
+#include "d3d12/D3D12CommandList.h"
+
+#include <span>
+#include <vector>
+
+#include <d3d12.h>
+
+namespace scrap::d3d12
+{
+class QueueScheduleExecutor
+{
+public:
+    QueueScheduleExecutor() = default;
+    QueueScheduleExecutor(const QueueScheduleExecutor&) = delete;
+    QueueScheduleExecutor(QueueScheduleExecutor&&) = default;
+    ~QueueScheduleExecutor() = default;
+
+    QueueScheduleExecutor& operator=(const QueueScheduleExecutor&) = delete;
+    QueueScheduleExecutor& operator=(QueueScheduleExecutor&&) = default;
+
+    // commandLists is indexed by the scheduler's work index. Work that didn't record anything can be nullptr. Every
+    // command list has to be of the type of the queue its work ended up on (QueueScheduler::getWorkQueue).
+    HRESULT execute(const QueueScheduler& scheduler, std::span<GraphicsCommandList* const> commandLists);
+
+private:
+    std::vector<ID3D12CommandList*> mCommandListBuffer;
+};
+} // namespace scrap::d3d12
@@ -1,5 +1,6 @@
 #include "D3D12RaytracingShader.h"
 
+#include "MemoryTracker.h"
 #include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12ShaderReflection.h"
 #include "d3d12/D3D12Strings.h"
@@ -104,6 +105,8 @@ RaytracingShaderStage getRaytracingFixedShaderStage(uint32_t shaderVersion)
 
 void RaytracingShader::create()
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     std::lock_guard lockGuard(mCreationMutex);
 
     if(mState != RaytracingShaderState::Initialized) { return; }
@@ -355,6 +358,16 @@ void RaytracingShader::create()
         }
     }
 
+    for(RaytracingFixedStageShaderInfo& shaderInfo : mFixedStageShaders)
+    {
+        shaderInfo.bindingLayout = ShaderBindingLayout(shaderInfo.inputs);
+    }
+
+    for(RaytracingCallableShaderInfo& shaderInfo : mCallableShaders)
+    {
+        shaderInfo.bindingLayout = ShaderBindingLayout(shaderInfo.inputs);
+    }
+
     mState = RaytracingShaderState::Compiled;
 }
 
@@ -437,40 +450,15 @@ size_t RaytracingShader::getFixedStageIndex(RaytracingShaderStage stage, const W
     return getFixedStageIndex(stage, entryPointName.hash());
 }
 
-std::optional<uint32_t> RaytracingShader::getVertexElementIndex(RaytracingShaderStage stage,
-                                                                ShaderVertexSemantic semantic,
-                                                                uint32_t semanticIndex) const
+const ShaderBindingLayout* RaytracingShader::getBindingLayout(RaytracingShaderStage stage) const
 {
-    const RaytracingFixedStageShaderInfo* shaderInfo = getFixedStageShader(stage, 0);
+    if(mState != RaytracingShaderState::Compiled) { return nullptr; }
 
-    if(shaderInfo == nullptr) { return std::nullopt; }
-
-    for(const ShaderVertexElement& element : shaderInfo->inputs.vertexElements)
-    {
-        if(element.semantic == semantic && element.semanticIndex == semanticIndex) { return element.index; }
-    }
-
-    return std::nullopt;
-}
-
-std::optional<uint32_t> RaytracingShader::getResourceIndex(RaytracingShaderStage stage,
-                                                           SharedString name,
-                                                           ShaderResourceType resourceType,
-                                                           ShaderResourceDimension resourceDimension) const
-{
     const RaytracingFixedStageShaderInfo* shaderInfo = getFixedStageShader(stage, 0);
 
-    if(shaderInfo == nullptr) { return std::nullopt; }
-
-    for(const ShaderResource& resource : shaderInfo->inputs.resources)
-    {
-        if(resource.name == name && resource.type == resourceType && resource.dimension == resourceDimension)
-        {
-            return resource.index;
-        }
-    }
+    if(shaderInfo == nullptr) { return nullptr; }
 
-    return std::nullopt;
+    return &shaderInfo->bindingLayout;
 }
 
 void RaytracingShader::logShaderErrorImpl(std::string_view stageName, std::string_view message)
@@ -2,6 +2,7 @@
 
 #include "EastlFixedVectorExt.h"
 #include "RenderDefs.h"
+#include "ShaderBindingLayout.h"
 #include "SharedString.h"
 #include "d3d12/D3D12Fwd.h"
 
@@ -33,6 +34,7 @@ struct RaytracingShaderInfo
     SharedString entryPoint;
     WSharedString wideEntryPoint;
     ShaderInputs inputs;
+    ShaderBindingLayout bindingLayout;
 };
 } // namespace detail
 
@@ -78,6 +80,8 @@ public:
 
     RaytracingShaderState status() const { return mState; }
 
+    const std::filesystem::path& getFilepath() const { return mFilepath; }
+
     bool hasShaderStage(RaytracingShaderStage stage)
     {
         auto stageMask = RaytracingShaderStageToMask(stage);
@@ -100,12 +104,9 @@ public:
     size_t getFixedStageIndex(RaytracingShaderStage stage, const SharedString& entryPointName) const;
     size_t getFixedStageIndex(RaytracingShaderStage stage, const WSharedString& entryPointName) const;
 
-    std::optional<uint32_t>
-    getVertexElementIndex(RaytracingShaderStage stage, ShaderVertexSemantic semantic, uint32_t semanticIndex) const;
-    std::optional<uint32_t> getResourceIndex(RaytracingShaderStage stage,
-                                             SharedString name,
-                                             ShaderResourceType resourceType,
-                                             ShaderResourceDimension resourceDimension) const;
+    // Binding layout of the first shader for the stage. Returns nullptr if the shader isn't compiled yet or doesn't
+    // have the stage.
+    const ShaderBindingLayout* getBindingLayout(RaytracingShaderStage stage) const;
 
 private:
     template<class... Args>
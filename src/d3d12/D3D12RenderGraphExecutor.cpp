@@ -0,0 +1,74 @@
+#include "d3d12/D3D12RenderGraphExecutor.h"
+
+#include "CpuProfiler.h"
+#include "d3d12/D3D12Translations.h"
+
+#include <d3d12.h>
+#include <d3dx12.h>
+#include <spdlog/spdlog.h>
+
+namespace scrap::d3d12
+{
+void RenderGraphExecutor::execute(const RenderGraph& graph,
+                                  GraphicsCommandList& commandList,
+                                  std::span<ID3D12Resource* const> resources)
+{
+    SCRAP_CPU_ZONE("RenderGraphExecutor::execute");
+
+    if(!graph.isCompiled())
+    {
+        spdlog::error("Tried to execute a render graph that hasn't been compiled");
+        return;
+    }
+
+    if(resources.size() < graph.getResourceCount())
+    {
+        spdlog::error("Render graph has {} resources, but only {} d3d12 resources were provided",
+                      graph.getResourceCount(), resources.size());
+        return;
+    }
+
+    mCommandList = &commandList;
+
+    const std::span<const uint32_t> executionOrder = graph.getExecutionOrder();
+
+    for(uint32_t position = 0; position < (uint32_t)executionOrder.size(); ++position)
+    {
+        recordBarriers(graph.getBarriers(position), resources);
+        graph.executePass(executionOrder[position]);
+    }
+
+    recordBarriers(graph.getFinalBarriers(), resources);
+
+    mCommandList = nullptr;
+}
+
+void RenderGraphExecutor::recordBarriers(std::span<const RenderGraphBarrier> barriers,
+                                         std::span<ID3D12Resource* const> resources)
+{
+    if(barriers.empty()) { return; }
+
+    mBarrierBuffer.clear();
+
+    for(const RenderGraphBarrier& barrier : barriers)
+    {
+        ID3D12Resource* resource = resources[barrier.resource.index()];
+
+        if(barrier.type == RenderGraphBarrierType::UnorderedAccess)
+        {
+            mBarrierBuffer.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+            continue;
+        }
+
+        D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        if(barrier.split == RenderGraphBarrierSplit::Begin) { flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY; }
+        else if(barrier.split == RenderGraphBarrierSplit::End) { flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY; }
+
+        mBarrierBuffer.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+            resource, TranslateResourceState(barrier.stateBefore), TranslateResourceState(barrier.stateAfter),
+            D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+    }
+
+    mCommandList->get()->ResourceBarrier((UINT)mBarrierBuffer.size(), mBarrierBuffer.data());
+}
+} // namespace scrap::d3d12
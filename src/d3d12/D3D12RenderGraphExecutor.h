@@ -0,0 +1,46 @@
+// RenderGraphExecutor records a compiled RenderGraph into a command list. All of the barriers for a pass boundary are
+// recorded with a single ResourceBarrier call before the pass's execute function runs. The graph only knows about
+// resource handles, so the d3d12 resources are passed in at execution time, indexed by RenderGraphResourceHandle.
+//
+// The graph's barriers bypass the command list's ResourceStateTracker. Imported Buffers and Textures have to be
+// imported in the state their global state says they are in and returned to it, so the tracked state stays correct.
+
+#pragma once
+
+#include "RenderGraph.h"
+#include "d3d12/D3D12CommandList.h"
+
+#include <span>
+#include <vector>
+
+#include <d3d12.h>
+
+namespace scrap::d3d12
+{
+class RenderGraphExecutor
+{
+public:
+    RenderGraphExecutor() = default;
+    RenderGraphExecutor(const RenderGraphExecutor&) = delete;
+    RenderGraphExecutor(RenderGraphExecutor&&) = default;
+    ~RenderGraphExecutor() = default;
+
+    RenderGraphExecutor& operator=(const RenderGraphExecutor&) = delete;
+    RenderGraphExecutor& operator=(RenderGraphExecutor&&) = default;
+
+    void execute(const RenderGraph& graph,
+                 GraphicsCommandList& commandList,
+                 std::span<ID3D12Resource* const> resources);
+
+    // Switches the command list the remaining barriers are recorded into. Only meant to be called from inside a pass's
+    // execute function, when the pass continues recording in another command list. Split barriers must not straddle
+    // the switch, so graphs that use this should be compiled with split barriers disabled.
+    void setCommandList(GraphicsCommandList& commandList) { mCommandList = &commandList; }
+
+private:
+    void recordBarriers(std::span<const RenderGraphBarrier> barriers, std::span<ID3D12Resource* const> resources);
+
+    GraphicsCommandList* mCommandList = nullptr;
+    std::vector<D3D12_RESOURCE_BARRIER> mBarrierBuffer;
+};
+} // namespace scrap::d3d12
@@ -0,0 +1,209 @@
+#include "d3d12/D3D12ResourceStateTracker.h"
+
+#include <algorithm>
+
+#include <d3d12.h>
+#include <d3dx12.h>
+
+namespace scrap::d3d12
+{
+namespace
+{
+constexpr D3D12_RESOURCE_STATES kReadOnlyResourceStates =
+    D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER |
+    D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+    D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT | D3D12_RESOURCE_STATE_COPY_SOURCE | D3D12_RESOURCE_STATE_DEPTH_READ |
+    D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+bool IsReadOnlyState(D3D12_RESOURCE_STATES state)
+{
+    return state != D3D12_RESOURCE_STATE_COMMON && (state & ~kReadOnlyResourceStates) == 0;
+}
+
+// A subresource in a combined read state, like D3D12_RESOURCE_STATE_GENERIC_READ, can already be used in any of the
+// read states it is made of.
+bool IsStateIncluded(D3D12_RESOURCE_STATES currentState, D3D12_RESOURCE_STATES requestedState)
+{
+    if(currentState == requestedState) { return true; }
+
+    return IsReadOnlyState(currentState) && IsReadOnlyState(requestedState) &&
+           (currentState & requestedState) == requestedState;
+}
+} // namespace
+
+void SubresourceStates::setState(uint32_t subresource, D3D12_RESOURCE_STATES state)
+{
+    if(subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || mSubresourceCount <= 1)
+    {
+        mState = state;
+        mSubresourceStates.clear();
+        return;
+    }
+
+    if(isUniform())
+    {
+        if(mState == state) { return; }
+
+        mSubresourceStates.assign(mSubresourceCount, mState);
+    }
+
+    mSubresourceStates[subresource] = state;
+
+    // Go back to a single state once every subresource agrees again
+    if(std::all_of(mSubresourceStates.cbegin(), mSubresourceStates.cend(),
+                   [state](D3D12_RESOURCE_STATES subresourceState) { return subresourceState == state; }))
+    {
+        mState = state;
+        mSubresourceStates.clear();
+    }
+}
+
+void ResourceStateTracker::transition(const std::shared_ptr<GlobalResourceState>& resource,
+                                      D3D12_RESOURCE_STATES state,
+                                      uint32_t subresource)
+{
+    TrackedResource& trackedResource = getTrackedResource(resource);
+
+    if(subresource != D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+    {
+        transitionSubresource(trackedResource, subresource, state);
+        return;
+    }
+
+    if(!trackedResource.currentStates.isUniform())
+    {
+        // The subresources were used separately, so they each need their own transition
+        for(uint32_t i = 0; i < trackedResource.currentStates.getSubresourceCount(); ++i)
+        {
+            transitionSubresource(trackedResource, i, state);
+        }
+        return;
+    }
+
+    const D3D12_RESOURCE_STATES currentState = trackedResource.currentStates.getUniformState();
+
+    if(currentState == kUnknownResourceState)
+    {
+        // First use. The transition into state is resolved when the command list is submitted.
+        trackedResource.firstStates.setState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
+        trackedResource.currentStates.setState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
+        return;
+    }
+
+    if(IsStateIncluded(currentState, state)) { return; }
+
+    mQueuedBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource->getResource(), currentState, state,
+                                                                    D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES));
+    trackedResource.currentStates.setState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
+}
+
+void ResourceStateTracker::uavBarrier(ID3D12Resource* resource)
+{
+    mQueuedBarriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+}
+
+void ResourceStateTracker::flush(ID3D12GraphicsCommandList* commandList)
+{
+    if(mQueuedBarriers.empty()) { return; }
+
+    commandList->ResourceBarrier((UINT)mQueuedBarriers.size(), mQueuedBarriers.data());
+    mQueuedBarriers.clear();
+}
+
+void ResourceStateTracker::resolvePendingBarriers(std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+{
+    for(TrackedResource& trackedResource : mTrackedResources)
+    {
+        GlobalResourceState& globalState = *trackedResource.globalState;
+        const SubresourceStates& globalStates = globalState.getStates();
+        const SubresourceStates& firstStates = trackedResource.firstStates;
+        const SubresourceStates& currentStates = trackedResource.currentStates;
+
+        // Only exact matches are skipped here. Barriers recorded later in the command list expect the subresource to be
+        // in exactly the first state.
+        if(firstStates.isUniform() && globalStates.isUniform())
+        {
+            const D3D12_RESOURCE_STATES firstState = firstStates.getUniformState();
+            if(firstState != kUnknownResourceState && firstState != globalStates.getUniformState())
+            {
+                barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(globalState.getResource(),
+                                                                        globalStates.getUniformState(), firstState,
+                                                                        D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES));
+            }
+        }
+        else
+        {
+            for(uint32_t i = 0; i < firstStates.getSubresourceCount(); ++i)
+            {
+                const D3D12_RESOURCE_STATES firstState = firstStates.getState(i);
+                if(firstState == kUnknownResourceState || firstState == globalStates.getState(i)) { continue; }
+
+                barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(globalState.getResource(),
+                                                                        globalStates.getState(i), firstState, i));
+            }
+        }
+
+        if(currentStates.isUniform())
+        {
+            if(currentStates.getUniformState() != kUnknownResourceState)
+            {
+                globalState.setState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, currentStates.getUniformState());
+            }
+        }
+        else
+        {
+            for(uint32_t i = 0; i < currentStates.getSubresourceCount(); ++i)
+            {
+                const D3D12_RESOURCE_STATES currentState = currentStates.getState(i);
+                if(currentState != kUnknownResourceState) { globalState.setState(i, currentState); }
+            }
+        }
+    }
+
+    reset();
+}
+
+void ResourceStateTracker::reset()
+{
+    mTrackedResources.clear();
+    mTrackedResourceIndices.clear();
+    mQueuedBarriers.clear();
+}
+
+ResourceStateTracker::TrackedResource&
+ResourceStateTracker::getTrackedResource(const std::shared_ptr<GlobalResourceState>& resource)
+{
+    auto [itr, inserted] = mTrackedResourceIndices.try_emplace(resource.get(), (uint32_t)mTrackedResources.size());
+
+    if(inserted)
+    {
+        const uint32_t subresourceCount = resource->getStates().getSubresourceCount();
+        mTrackedResources.push_back(TrackedResource{
+            .globalState = resource,
+            .firstStates = SubresourceStates(subresourceCount, kUnknownResourceState),
+            .currentStates = SubresourceStates(subresourceCount, kUnknownResourceState)});
+    }
+
+    return mTrackedResources[itr->second];
+}
+
+void ResourceStateTracker::transitionSubresource(TrackedResource& trackedResource,
+                                                 uint32_t subresource,
+                                                 D3D12_RESOURCE_STATES state)
+{
+    const D3D12_RESOURCE_STATES currentState = trackedResource.currentStates.getState(subresource);
+
+    if(currentState == kUnknownResourceState)
+    {
+        trackedResource.firstStates.setState(subresource, state);
+        trackedResource.currentStates.setState(subresource, state);
+        return;
+    }
+
+    if(IsStateIncluded(currentState, state)) { return; }
+
+    mQueuedBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(trackedResource.globalState->getResource(),
+                                                                    currentState, state, subresource));
+    trackedResource.currentStates.setState(subresource, state);
+}
+} // namespace scrap::d3d12
@@ -0,0 +1,149 @@
+// Classes:
+//   SubresourceStates
+//   GlobalResourceState
+//   ResourceStateTracker
+//
+// SubresourceStates:
+//   The state of every subresource of a resource. Stored as a single state while all subresources agree and only
+//   expanded to one state per subresource once a single subresource is transitioned on its own.
+//
+// GlobalResourceState:
+//   The state a resource is left in by the last submitted command list that used it. Owned by Buffer and Texture. It
+//   only changes when a command list is submitted, so it has to be read and written from the thread that submits.
+//
+// ResourceStateTracker:
+//   Owned by each GraphicsCommandList. Callers ask for the state they need a resource in and the tracker works out the
+//   transition from the state the command list last left each subresource in. Transitions are queued and all of them
+//   are recorded with one ResourceBarrier call when the tracker is flushed.
+//
+//   Command lists are recorded in any order and on any thread, so the state a resource is in when a command list starts
+//   executing isn't known while it is being recorded. The first time a command list uses a subresource, the requested
+//   state is remembered instead of queuing a barrier. When the command list is submitted, resolvePendingBarriers
+//   compares those first states against the global state, returns the transitions that are needed to get there and
+//   moves the global state to wherever the command list left each subresource.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <d3d12.h>
+
+namespace scrap::d3d12
+{
+// Used by ResourceStateTracker for subresources a command list hasn't used yet
+constexpr D3D12_RESOURCE_STATES kUnknownResourceState = static_cast<D3D12_RESOURCE_STATES>(-1);
+
+class SubresourceStates
+{
+public:
+    SubresourceStates() = default;
+    SubresourceStates(uint32_t subresourceCount, D3D12_RESOURCE_STATES state)
+        : mSubresourceCount(subresourceCount)
+        , mState(state)
+    {}
+
+    [[nodiscard]] uint32_t getSubresourceCount() const { return mSubresourceCount; }
+
+    // True while every subresource is in the same state
+    [[nodiscard]] bool isUniform() const { return mSubresourceStates.empty(); }
+
+    // The state of every subresource. Only valid while isUniform is true.
+    [[nodiscard]] D3D12_RESOURCE_STATES getUniformState() const { return mState; }
+
+    [[nodiscard]] D3D12_RESOURCE_STATES getState(uint32_t subresource) const
+    {
+        return isUniform() ? mState : mSubresourceStates[subresource];
+    }
+
+    // subresource can be D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+    void setState(uint32_t subresource, D3D12_RESOURCE_STATES state);
+
+private:
+    uint32_t mSubresourceCount = 0;
+    D3D12_RESOURCE_STATES mState = D3D12_RESOURCE_STATE_COMMON;
+    std::vector<D3D12_RESOURCE_STATES> mSubresourceStates; // Empty while all subresources are in mState
+};
+
+class GlobalResourceState
+{
+public:
+    GlobalResourceState(ID3D12Resource* resource, uint32_t subresourceCount, D3D12_RESOURCE_STATES initialState)
+        : mResource(resource)
+        , mStates(subresourceCount, initialState)
+    {}
+    GlobalResourceState(const GlobalResourceState&) = delete;
+    GlobalResourceState(GlobalResourceState&&) = delete;
+    ~GlobalResourceState() = default;
+
+    GlobalResourceState& operator=(const GlobalResourceState&) = delete;
+    GlobalResourceState& operator=(GlobalResourceState&&) = delete;
+
+    [[nodiscard]] ID3D12Resource* getResource() const { return mResource; }
+    [[nodiscard]] const SubresourceStates& getStates() const { return mStates; }
+
+    // For state changes that happen outside of a ResourceStateTracker, like barriers recorded by hand during
+    // initialization.
+    void setState(uint32_t subresource, D3D12_RESOURCE_STATES state) { mStates.setState(subresource, state); }
+
+private:
+    ID3D12Resource* mResource;
+    SubresourceStates mStates;
+};
+
+class ResourceStateTracker
+{
+public:
+    ResourceStateTracker() = default;
+    ResourceStateTracker(const ResourceStateTracker&) = delete;
+    ResourceStateTracker(ResourceStateTracker&&) = default;
+    ~ResourceStateTracker() = default;
+
+    ResourceStateTracker& operator=(const ResourceStateTracker&) = delete;
+    ResourceStateTracker& operator=(ResourceStateTracker&&) = default;
+
+    // Queues the barriers needed to get the subresource into state. subresource can be
+    // D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES. Nothing is queued if the subresource is already in state, or in a read
+    // state that includes it.
+    void transition(const std::shared_ptr<GlobalResourceState>& resource,
+                    D3D12_RESOURCE_STATES state,
+                    uint32_t subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+    // Queues a barrier between unordered access writes and whatever uses the resource next
+    void uavBarrier(ID3D12Resource* resource);
+
+    // Records every queued barrier with a single ResourceBarrier call
+    void flush(ID3D12GraphicsCommandList* commandList);
+
+    [[nodiscard]] bool hasQueuedBarriers() const { return !mQueuedBarriers.empty(); }
+
+    // Call once the command list is closed, in the order command lists are submitted. Appends the transitions from the
+    // global state of each resource to the state the command list first used it in, then updates the global state to
+    // the state the command list leaves the resource in and resets the tracker.
+    void resolvePendingBarriers(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+
+    // Forgets everything without touching the global state. Used when recording starts over.
+    void reset();
+
+private:
+    struct TrackedResource
+    {
+        std::shared_ptr<GlobalResourceState> globalState;
+
+        // The state each subresource was first used in. kUnknownResourceState if the command list hasn't used it.
+        SubresourceStates firstStates;
+
+        // The state the command list leaves each subresource in so far
+        SubresourceStates currentStates;
+    };
+
+    TrackedResource& getTrackedResource(const std::shared_ptr<GlobalResourceState>& resource);
+    void transitionSubresource(TrackedResource& trackedResource, uint32_t subresource, D3D12_RESOURCE_STATES state);
+
+    std::vector<TrackedResource> mTrackedResources;
+    std::unordered_map<const GlobalResourceState*, uint32_t> mTrackedResourceIndices;
+    std::vector<D3D12_RESOURCE_BARRIER> mQueuedBarriers;
+};
+} // namespace scrap::d3d12
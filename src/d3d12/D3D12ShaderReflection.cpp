@@ -1,5 +1,6 @@
 #include "D3D12ShaderReflection.h"
 
+#include "MemoryTracker.h"
 #include "StringUtils.h"
 #include "d3d12/D3D12Config.h"
 
@@ -394,6 +395,8 @@ bool IsResourceIndicesRegister(const D3D12_SHADER_INPUT_BIND_DESC& desc)
 tl::expected<VertexInputsCbInfo, ShaderReflectionErrorInfo>
 CollectVertexInputs(ID3D12ShaderReflection* reflection, const D3D12_SHADER_INPUT_BIND_DESC& shaderInputBindDesc)
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     if(shaderInputBindDesc.Type != D3D_SIT_CBUFFER)
     {
         return tl::make_unexpected(
@@ -415,6 +418,8 @@ CollectVertexInputs(ID3D12ShaderReflection* reflection, const D3D12_SHADER_INPUT
 tl::expected<VertexInputsCbInfo, ShaderReflectionErrorInfo>
 CollectVertexInputs(ID3D12ShaderReflectionConstantBuffer* constantBufferReflection)
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     D3D12_SHADER_BUFFER_DESC vertexCbDesc;
     if(FAILED(constantBufferReflection->GetDesc(&vertexCbDesc)))
     {
@@ -465,6 +470,8 @@ CollectVertexInputs(ID3D12ShaderReflectionConstantBuffer* constantBufferReflecti
 tl::expected<ResourcesCbInfo, ShaderReflectionErrorInfo>
 CollectResourceInputs(ID3D12ShaderReflection* reflection, const D3D12_SHADER_INPUT_BIND_DESC& shaderInputBindDesc)
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     if(shaderInputBindDesc.Type != D3D_SIT_CBUFFER)
     {
         return tl::make_unexpected(
@@ -486,6 +493,8 @@ CollectResourceInputs(ID3D12ShaderReflection* reflection, const D3D12_SHADER_INP
 tl::expected<ResourcesCbInfo, ShaderReflectionErrorInfo>
 CollectResourceInputs(ID3D12ShaderReflectionConstantBuffer* constantBufferReflection)
 {
+    SCRAP_MEMORY_TAG(ShaderReflection);
+
     D3D12_SHADER_BUFFER_DESC resourceCbDesc;
     if(FAILED(constantBufferReflection->GetDesc(&resourceCbDesc)))
     {
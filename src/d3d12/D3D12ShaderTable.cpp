@@ -1,7 +1,9 @@
 #include "d3d12/D3D12ShaderTable.h"
 
+#include "CpuProfiler.h"
 #include "EnumArray.h"
 #include "EnumIterator.h"
+#include "MemoryTracker.h"
 #include "d3d12/D3D12Buffer.h"
 #include "d3d12/D3D12CommandList.h"
 #include "d3d12/D3D12Context.h"
@@ -14,6 +16,8 @@ namespace scrap::d3d12
 {
 void ShaderTable::init(const ShaderTableParams& params)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     mParams[RaytracingPipelineStage::RayGen] = params.raygen;
     mParams[RaytracingPipelineStage::HitGroup] = params.hitGroup;
     mParams[RaytracingPipelineStage::Miss] = params.miss;
@@ -24,10 +28,13 @@ void ShaderTable::init(const ShaderTableParams& params)
         fmt::format("{} (Miss Table)", params.name),
     };
 
+    int64_t recordCapacity = 0;
+
     BufferSimpleParams bufferParams;
     bufferParams.accessFlags = ResourceAccessFlags::CpuWrite;
     bufferParams.flags = BufferFlags::NonPixelShaderResource;
     bufferParams.initialResourceState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    bufferParams.memoryCategory = GpuMemoryCategory::ShaderTable;
 
     for(RaytracingPipelineStage stage : enumerate<RaytracingPipelineStage>())
     {
@@ -42,7 +49,11 @@ void ShaderTable::init(const ShaderTableParams& params)
         stageShaderTable.shaderTableBuffer = std::make_shared<Buffer>();
         stageShaderTable.shaderTableBuffer->init(bufferParams);
         stageShaderTable.freeBlocks = FreeBlockTracker(params.capacity);
+
+        recordCapacity += (int64_t)params.capacity;
     }
+
+    mRecordCapacityGauge.set(recordCapacity);
 }
 
 tl::expected<ShaderTableAllocation, ShaderTable::Error>
@@ -50,6 +61,8 @@ ShaderTable::addPipelineState(std::shared_ptr<RaytracingPipelineState> pipelineS
                               EnumArray<std::span<const std::byte>, RaytracingPipelineStage> localRootArguments,
                               ID3D12GraphicsCommandList* commandList)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     ShaderTableAllocation allocation;
     allocation.mShaderTable = this;
 
@@ -114,16 +127,15 @@ void ShaderTable::deallocate(const std::shared_ptr<RaytracingPipelineState>& pip
 
 void ShaderTable::beginUpdate(GraphicsCommandList& commandList)
 {
-    EnumArray<D3D12_RESOURCE_BARRIER, RaytracingPipelineStage> barriers;
+    SCRAP_CPU_ZONE("ShaderTable::beginUpdate");
 
-    for(auto [stage, stageTable] : enumerate(mShaderTables))
+    for(const auto& stageTable : mShaderTables)
     {
-        barriers[stage] = CD3DX12_RESOURCE_BARRIER::Transition(
-            stageTable.shaderTableBuffer->getResource(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
-            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+        commandList.transitionResource(*stageTable.shaderTableBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
     }
 
-    commandList.get()->ResourceBarrier((uint32_t)barriers.size(), barriers.data());
+    // The write guards copy into the buffers when they are released in endUpdate
+    commandList.flushResourceBarriers();
 
     for(auto stage : enumerate<RaytracingPipelineStage>())
     {
@@ -134,22 +146,29 @@ void ShaderTable::beginUpdate(GraphicsCommandList& commandList)
 
 void ShaderTable::endUpdate(GraphicsCommandList& commandList)
 {
+    SCRAP_CPU_ZONE("ShaderTable::endUpdate");
+
     for(auto stage : enumerate<RaytracingPipelineStage>())
     {
         mShaderTableBufferMaps[stage] = {};
     }
 
-    EnumArray<D3D12_RESOURCE_BARRIER, RaytracingPipelineStage> barriers;
-
-    for(auto stage : enumerate<RaytracingPipelineStage>())
     {
-        const auto& stageTable = mShaderTables[stage];
-        barriers[stage] = CD3DX12_RESOURCE_BARRIER::Transition(
-            stageTable.shaderTableBuffer->getResource(), D3D12_RESOURCE_STATE_COPY_DEST,
-            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+        std::lock_guard lockGuard(mMutex);
+
+        int64_t recordsInUse = 0;
+        for(const StageShaderTable& stageTable : mShaderTables)
+        {
+            recordsInUse += (int64_t)stageTable.freeBlocks.getReservedBlockCount();
+        }
+
+        mRecordsInUseGauge.set(recordsInUse);
     }
 
-    commandList.get()->ResourceBarrier((uint32_t)barriers.size(), barriers.data());
+    for(const auto& stageTable : mShaderTables)
+    {
+        commandList.transitionResource(*stageTable.shaderTableBuffer, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    }
 }
 
 void ShaderTable::updateLocalRootArguments(RaytracingPipelineStage stage,
@@ -2,6 +2,7 @@
 
 #include "EnumArray.h"
 #include "FreeBlockTracker.h"
+#include "PerfCounters.h"
 #include "RenderDefs.h"
 #include "d3d12/D3D12Buffer.h"
 #include "d3d12/D3D12Fwd.h"
@@ -52,6 +53,12 @@ public:
 
     [[nodiscard]] bool isValid() const { return mShaderTable != nullptr; }
 
+    // The index of the stage's record in its table
+    [[nodiscard]] size_t getRecordIndex(RaytracingPipelineStage stage) const
+    {
+        return mTableReservations[stage].getRange().start;
+    }
+
     void updateLocalRootArguments(RaytracingPipelineStage stage,
                                   std::span<const std::byte> localRootArguments,
                                   ID3D12GraphicsCommandList* commandList);
@@ -136,5 +143,7 @@ private:
     eastl::vector_set<RefCountedPipelineState> mPipelineStates;
     std::mutex mMutex;
     EnumArray<GpuBufferWriteGuard, RaytracingPipelineStage> mShaderTableBufferMaps;
+    PerfGaugeContribution mRecordsInUseGauge{PerfGauge::ShaderTableRecordsInUse};
+    PerfGaugeContribution mRecordCapacityGauge{PerfGauge::ShaderTableRecordCapacity};
 };
 } // namespace scrap::d3d12
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "D3D12TLAccelerationStructure.h"
 
-#include "SpanUtility.h"
+#include "CpuProfiler.h"
+#include "MemoryTracker.h"
 #include "d3d12/D3D12Context.h"
 
 #include <d3dx12.h>
@@ -16,6 +17,8 @@ TLAccelerationStructure::TLAccelerationStructure(const TLAccelerationStructurePa
 tl::expected<TlasInstanceAllocation, TlasError>
 TLAccelerationStructure::addInstance(const TLAccelerationStructureInstanceParams& params)
 {
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     const glm::mat3x4 transposedTransform = glm::transpose(params.transform);
 
     uint8_t flags = 0;
@@ -37,78 +40,78 @@ TLAccelerationStructure::addInstance(const TLAccelerationStructureInstanceParams
         flags |= D3D12_RAYTRACING_INSTANCE_FLAG_FORCE_NON_OPAQUE;
     }
 
-    InternalInstance& internalInstance = mInstances.emplace_back();
-    internalInstance.blas = params.accelerationStructure;
-    internalInstance.id = mNextId++;
-
-    D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc = mInstanceDescs.emplace_back();
+    D3D12_RAYTRACING_INSTANCE_DESC instanceDesc = {};
     instanceDesc.AccelerationStructure =
         params.accelerationStructure->getBuffer().getResource()->GetGPUVirtualAddress();
     instanceDesc.Flags = flags;
-    instanceDesc.InstanceContributionToHitGroupIndex = params.instanceId + params.instanceContributionToHitGroupIndex;
+    instanceDesc.InstanceContributionToHitGroupIndex = params.instanceContributionToHitGroupIndex;
     instanceDesc.InstanceID = params.instanceId;
     instanceDesc.InstanceMask = params.instanceMask;
     std::memcpy(instanceDesc.Transform, glm::value_ptr(transposedTransform), sizeof(instanceDesc.Transform));
 
+    const size_t id = mInstanceList.addInstance(instanceDesc);
+    if(id >= mInstanceBlases.size()) { mInstanceBlases.resize(id + 1); }
+    mInstanceBlases[id] = params.accelerationStructure;
+
     mIsDirty = true;
+    mInstancesGauge.set((int64_t)mInstanceList.getInstanceCount());
 
-    return TlasInstanceAllocation(*this, internalInstance.id);
+    return TlasInstanceAllocation(*this, id);
 }
 
 void TLAccelerationStructure::removeInstanceById(size_t id)
 {
-    auto itr = std::find_if(mInstances.begin(), mInstances.end(),
-                            [id](const InternalInstance& params) { return params.id == id; });
+    if(!mInstanceList.removeInstance(id)) { return; }
 
-    if(itr == mInstances.end()) { return; }
-
-    mInstances.erase_unsorted(itr);
-    mInstanceDescs.erase_unsorted(mInstanceDescs.begin() + std::distance(mInstances.begin(), itr));
+    mInstanceBlases[id] = nullptr;
 
     mIsDirty = true;
+    mInstancesGauge.set((int64_t)mInstanceList.getInstanceCount());
 }
 
 void TLAccelerationStructure::updateInstanceTransformById(size_t id, const glm::mat4x3& transform)
 {
-    auto itr = std::find_if(mInstances.begin(), mInstances.end(),
-                            [id](const InternalInstance& params) { return params.id == id; });
-
-    if(itr == mInstances.end()) { return; }
-
-    const glm::mat3x4 transposedTransform = glm::transpose(transform);
-
-    size_t instanceDescIndex = std::distance(mInstances.begin(), itr);
-    std::memcpy(mInstanceDescs[instanceDescIndex].Transform, glm::value_ptr(transposedTransform),
-                sizeof(D3D12_RAYTRACING_INSTANCE_DESC::Transform));
+    if(mInstanceList.updateInstanceTransform(id, transform)) { mIsDirty = true; }
+}
 
-    mIsDirty = true;
+void TLAccelerationStructure::updateInstanceHitGroupIndexById(size_t id, uint32_t hitGroupIndex)
+{
+    if(mInstanceList.updateInstanceHitGroupIndex(id, hitGroupIndex)) { mIsDirty = true; }
 }
 
-bool TLAccelerationStructure::build(const GraphicsCommandList& commandList)
+bool TLAccelerationStructure::build(GraphicsCommandList& commandList)
 {
+    SCRAP_CPU_ZONE("TLAccelerationStructure::build");
+    SCRAP_MEMORY_TAG(D3D12Wrapper);
+
     auto device = d3d12::DeviceContext::instance().getDevice5();
 
-    if(doesInstanceDescsNeedResize((uint32_t)mInstances.size()))
+    const std::span<const D3D12_RAYTRACING_INSTANCE_DESC> instanceDescs = mInstanceList.getInstanceDescs();
+
+    if(doesInstanceDescsNeedResize((uint32_t)instanceDescs.size()))
     {
-        resizeInstanceDescsBuffer((uint32_t)mInstances.size());
+        resizeInstanceDescsBuffer((uint32_t)instanceDescs.size());
     }
     else if(mIsDirty)
     {
+        // The write guard copies into the buffer when it goes out of scope
+        commandList.transitionResource(*mInstanceDescsGpuBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+        commandList.flushResourceBarriers();
+
         {
             GpuBufferWriteGuard writeGuard(*mInstanceDescsGpuBuffer, commandList.get());
             auto writeBuffer = writeGuard.getWriteBufferAs<D3D12_RAYTRACING_INSTANCE_DESC>();
 
-            std::copy(mInstanceDescs.cbegin(), mInstanceDescs.cend(), writeBuffer.begin());
+            std::copy(instanceDescs.begin(), instanceDescs.end(), writeBuffer.begin());
         }
-
-        mInstanceDescsGpuBuffer->transition(commandList.get(), D3D12_RESOURCE_STATE_COPY_DEST,
-                                            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
     }
 
+    commandList.transitionResource(*mInstanceDescsGpuBuffer, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+
     D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
     inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
     inputs.Flags = TranslateAccelerationStructureBuildFlags(mParams.flags, mParams.buildOption);
-    inputs.NumDescs = (uint32_t)mInstances.size();
+    inputs.NumDescs = (uint32_t)instanceDescs.size();
     inputs.InstanceDescs = mInstanceDescsGpuBuffer->getResource()->GetGPUVirtualAddress();
     inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 
@@ -127,6 +130,7 @@ bool TLAccelerationStructure::build(const GraphicsCommandList& commandList)
         params.byteSize = prebuildInfo.ScratchDataSizeInBytes;
         params.flags = BufferFlags::UavEnabled;
         params.name = scratchBufferName;
+        params.memoryCategory = GpuMemoryCategory::AccelerationStructure;
 
         mScratchGpuBuffer->init(params);
     }
@@ -162,7 +166,9 @@ bool TLAccelerationStructure::build(const GraphicsCommandList& commandList)
 
     // commandList.get()->ResourceBarrier((uint32_t)blasTransitions.size(), blasTransitions.data());
 
+    commandList.flushResourceBarriers();
     commandList.get4()->BuildRaytracingAccelerationStructure(&desc, 0, nullptr);
+    PerfCounters::add(PerfCounter::TlasBuilds);
 
     mScratchGpuBuffer->markAsUsed(commandList.get());
     mInstanceDescsGpuBuffer->markAsUsed(commandList.get());
@@ -175,9 +181,9 @@ void TLAccelerationStructure::markAsUsed(const GraphicsCommandList& commandList)
 {
     mAccelerationStructureGpuBuffer->markAsUsed(commandList.get());
 
-    for(InternalInstance& instance : mInstances)
+    for(const std::shared_ptr<BLAccelerationStructure>& blas : mInstanceBlases)
     {
-        instance.blas->markAsUsed(commandList);
+        if(blas != nullptr) { blas->markAsUsed(commandList); }
     }
 }
 
@@ -207,9 +213,10 @@ void TLAccelerationStructure::resizeInstanceDescsBuffer(uint32_t capacity)
                                                        uint32_t(D3D12_RAYTRACING_INSTANCE_DESCS_BYTE_ALIGNMENT));
     instanceDescsParams.flags = mParams.instanceDescs.bufferFlags | BufferFlags::NonPixelShaderResource;
     instanceDescsParams.name = instanceDescsName;
+    instanceDescsParams.memoryCategory = GpuMemoryCategory::AccelerationStructure;
     instanceDescsParams.numElements = capacity;
 
-    mInstanceDescsGpuBuffer->init(instanceDescsParams, ToByteSpan(mInstanceDescs));
+    mInstanceDescsGpuBuffer->init(instanceDescsParams, std::as_bytes(mInstanceList.getInstanceDescs()));
 }
 
 TlasInstanceAllocation& TlasInstanceAllocation::operator=(TlasInstanceAllocation&& other)
@@ -234,4 +241,9 @@ void TlasInstanceAllocation::updateTransform(const glm::mat4x3& transform)
 {
     mAccelerationStructure->updateInstanceTransformById(mId, transform);
 }
+
+void TlasInstanceAllocation::updateHitGroupIndex(uint32_t hitGroupIndex)
+{
+    mAccelerationStructure->updateInstanceHitGroupIndexById(mId, hitGroupIndex);
+}
 } // namespace scrap::d3d12
\ No newline at end of file
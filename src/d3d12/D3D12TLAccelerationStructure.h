@@ -1,10 +1,13 @@
 #pragma once
 
+#include "PerfCounters.h"
+#include "TlasInstanceList.h"
 #include "d3d12/D3D12AccelerationStructureCommon.h"
 #include "d3d12/D3D12BLAccelerationStructure.h"
 #include "d3d12/D3D12Buffer.h"
 #include "d3d12/D3D12CommandList.h"
 
+#include <limits>
 #include <memory>
 
 #include <EASTL/vector.h>
@@ -58,6 +61,7 @@ public:
     ~TlasInstanceAllocation();
 
     void updateTransform(const glm::mat4x3& transform);
+    void updateHitGroupIndex(uint32_t hitGroupIndex);
 
     bool isValid() const { return mAccelerationStructure != nullptr; }
 
@@ -78,6 +82,7 @@ struct TLAccelerationStructureInstanceParams
     TlasInstanceFlags flags = TlasInstanceFlags::None;
     uint32_t instanceId : 24 = 0xffffff;
     uint32_t instanceMask : 8 = 0xff;
+    // The index of the instance's record in the shader table's hit group table
     uint32_t instanceContributionToHitGroupIndex : 24 = 0;
     uint32_t padding : 8 = 0xff;
 };
@@ -92,8 +97,9 @@ public:
     tl::expected<TlasInstanceAllocation, TlasError> addInstance(const TLAccelerationStructureInstanceParams& params);
     void removeInstanceById(size_t id);
     void updateInstanceTransformById(size_t id, const glm::mat4x3& transform);
+    void updateInstanceHitGroupIndexById(size_t id, uint32_t hitGroupIndex);
 
-    bool build(const GraphicsCommandList& commandList);
+    bool build(GraphicsCommandList& commandList);
 
     void markAsUsed(const GraphicsCommandList& commandList);
 
@@ -105,15 +111,11 @@ private:
     bool doesInstanceDescsNeedResize(uint32_t newCapacity);
     void resizeInstanceDescsBuffer(uint32_t capacity);
 
-    struct InternalInstance
-    {
-        size_t id;
-        std::shared_ptr<BLAccelerationStructure> blas;
-    };
-    eastl::vector<InternalInstance> mInstances;
-    eastl::vector<D3D12_RAYTRACING_INSTANCE_DESC> mInstanceDescs;
-    size_t mNextId = 0;
+    TlasInstanceList mInstanceList;
+    // Indexed by instance id. Null for ids that aren't in use.
+    eastl::vector<std::shared_ptr<BLAccelerationStructure>> mInstanceBlases;
     bool mIsDirty = false;
+    PerfGaugeContribution mInstancesGauge{PerfGauge::TlasInstances};
 
     TLAccelerationStructureParams mParams;
 
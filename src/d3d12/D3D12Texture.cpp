@@ -2,6 +2,7 @@
 
 #include "D3D12Context.h"
 #include "D3D12Translations.h"
+#include "MemoryTracker.h"
 
 #include <ostream>
 
@@ -91,6 +92,8 @@ void Texture::markAsUsed(ID3D12CommandList* commandList)
 
 std::optional<TextureError> Texture::init(const TextureParams& params, const cputex::TextureView* texture)
 {
+    SCRAP_MEMORY_TAG(Texture);
+
     DeviceContext& deviceContext = DeviceContext::instance();
     ID3D12GraphicsCommandList* commandList = deviceContext.getCopyContext().getCommandList();
 
@@ -266,9 +269,15 @@ std::optional<TextureError> Texture::init(const TextureParams& params, const cpu
 
         if(FAILED(hr)) { return TextureError::FailedToCreateResource; }
 
+        deviceContext.getCommandCapture().addResource(resource.Get(), initialResourceState);
         mResource = TrackedShaderResource(std::move(resource));
     }
 
+    mMemoryAllocation = deviceContext.getGpuMemoryRegistry().add(
+        {allocInfo.SizeInBytes, GpuHeapType::Default,
+         (params.isRenderTarget || isDepthStencil) ? GpuMemoryCategory::RenderTarget : GpuMemoryCategory::Texture,
+         std::string(params.name)});
+
     std::wstring wideName;
     int wideStrSize = MultiByteToWideChar(CP_UTF8, 0u, params.name.data(), (int)params.name.size(), nullptr, 0);
     wideName.reserve(wideStrSize + sizeof(" (Upload)"));
@@ -313,9 +322,13 @@ std::optional<TextureError> Texture::init(const TextureParams& params, const cpu
             return TextureError::FailedToCreateUploadResource;
         }
 
+        deviceContext.getCommandCapture().addResource(uploadResource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
         mUploadResource = TrackedGpuObject(std::move(uploadResource));
     }
 
+    mUploadMemoryAllocation = deviceContext.getGpuMemoryRegistry().add(
+        {allocInfo.SizeInBytes, GpuHeapType::Upload, GpuMemoryCategory::Staging, std::string(params.name)});
+
     wideName.append(L" (Upload)");
     mUploadResource->SetName(wideName.c_str());
 
@@ -324,6 +337,8 @@ std::optional<TextureError> Texture::init(const TextureParams& params, const cpu
     //============================================
     if(texture != nullptr)
     {
+        std::unique_lock copyLock = deviceContext.getCopyContext().lockCommandList();
+
         // Using 15 because its the maximum number of mips a 16384x16384 texture can have plus 1.
         std::array<D3D12_SUBRESOURCE_DATA, 16> subresources;
         UINT subresourceCount = 0;
@@ -381,6 +396,18 @@ std::optional<TextureError> Texture::init(const TextureParams& params, const cpu
         mInitFrameCode = deviceContext.getCopyContext().getCurrentFrameCode();
     }
 
+    {
+        // Command lists resolve their first use of every subresource against this state when they are submitted
+        const uint32_t arraySize =
+            (textureDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? 1u : textureDesc.DepthOrArraySize;
+        const uint32_t subresourceCount = textureDesc.MipLevels * arraySize *
+                                          D3D12GetFormatPlaneCount(deviceContext.getDevice(), textureDesc.Format);
+
+        mGlobalResourceState = std::make_shared<GlobalResourceState>(
+            mResource.getResource(), subresourceCount,
+            (texture != nullptr) ? postCopyResourceState : initialResourceState);
+    }
+
     if((params.accessFlags & ResourceAccessFlags::CpuWrite) != ResourceAccessFlags::CpuWrite)
     {
         // The upload buffer was only needed to initialize the resource and will not be used again.
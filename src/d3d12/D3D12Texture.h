@@ -1,13 +1,16 @@
 #pragma once
 
+#include "GpuMemoryRegistry.h"
 #include "RenderDefs.h"
 #include "StringUtils.h"
 #include "Utility.h"
 #include "d3d12/D3D12FixedDescriptorHeap.h"
 #include "d3d12/D3D12FrameCodes.h"
+#include "d3d12/D3D12ResourceStateTracker.h"
 #include "d3d12/D3D12TrackedGpuObject.h"
 
 #include <array>
+#include <memory>
 
 #include <cputex/unique_texture.h>
 #include <d3d12.h>
@@ -73,6 +76,10 @@ public:
 
     ID3D12Resource* getResource() const { return mResource.getResource(); }
 
+    // Tracks every mip, array slice and plane separately. Transition the texture with
+    // GraphicsCommandList::transitionResource.
+    const std::shared_ptr<GlobalResourceState>& getGlobalResourceState() const { return mGlobalResourceState; }
+
     D3D12_CPU_DESCRIPTOR_HANDLE getSrvCpu() const;
     D3D12_GPU_DESCRIPTOR_HANDLE getSrvGpu() const;
     D3D12_CPU_DESCRIPTOR_HANDLE getRtvCpu() const;
@@ -111,6 +118,9 @@ private:
     // Specifically look at the descriptions for 'D3D12_HEAP_TYPE_UPLOAD' and 'D3D12_HEAP_TYPE_DEFAULT'.
     TrackedShaderResource mResource;
     TrackedGpuObject<ID3D12Resource> mUploadResource;
+    GpuMemoryAllocation mMemoryAllocation;
+    GpuMemoryAllocation mUploadMemoryAllocation;
+    std::shared_ptr<GlobalResourceState> mGlobalResourceState;
     uint32_t mSrvIndex = std::numeric_limits<uint32_t>::max();
     uint32_t mUavIndex = std::numeric_limits<uint32_t>::max();
     uint32_t mRtvIndex = std::numeric_limits<uint32_t>::max();
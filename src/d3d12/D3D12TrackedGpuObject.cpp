@@ -2,22 +2,48 @@
 
 #include "d3d12/D3D12Context.h"
 
+#include <atomic>
+
 #include <d3d12.h>
 #include <spdlog/spdlog.h>
 
 namespace scrap::d3d12
 {
+// Objects can be marked as used from several recording threads at once (see ParallelCommandRecorder), so the frame
+// codes are only ever accessed atomically. The frame code only moves forward, so a compare exchange loop keeps a thread
+// that read an older frame code from overwriting a newer one.
+template<class FrameCodeT>
+void StoreFrameCode(FrameCodeT& frameCode, FrameCodeT newFrameCode)
+{
+    std::atomic_ref<FrameCodeT> atomicFrameCode(frameCode);
+
+    FrameCodeT currentFrameCode = atomicFrameCode.load(std::memory_order_relaxed);
+    while(currentFrameCode < newFrameCode &&
+          !atomicFrameCode.compare_exchange_weak(currentFrameCode, newFrameCode, std::memory_order_relaxed))
+    {}
+}
+
+template<class FrameCodeT>
+FrameCodeT LoadFrameCode(const FrameCodeT& frameCode)
+{
+    return std::atomic_ref<FrameCodeT>(const_cast<FrameCodeT&>(frameCode)).load(std::memory_order_relaxed);
+}
+
 void UpdateFrameCode(D3D12_COMMAND_LIST_TYPE commandListType,
                      RenderFrameCode& renderFrameCode,
-                     CopyFrameCode& copyFrameCode)
+                     CopyFrameCode& copyFrameCode,
+                     ComputeFrameCode& computeFrameCode)
 {
     switch(commandListType)
     {
     case D3D12_COMMAND_LIST_TYPE_DIRECT:
-        renderFrameCode = DeviceContext::instance().getGraphicsContext().getCurrentFrameCode();
+        StoreFrameCode(renderFrameCode, DeviceContext::instance().getGraphicsContext().getCurrentFrameCode());
         break;
     case D3D12_COMMAND_LIST_TYPE_COPY:
-        copyFrameCode = DeviceContext::instance().getCopyContext().getCurrentFrameCode();
+        StoreFrameCode(copyFrameCode, DeviceContext::instance().getCopyContext().getCurrentFrameCode());
+        break;
+    case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+        StoreFrameCode(computeFrameCode, DeviceContext::instance().getComputeContext().getCurrentFrameCode());
         break;
     default:
         assert(false);
@@ -26,14 +52,20 @@ void UpdateFrameCode(D3D12_COMMAND_LIST_TYPE commandListType,
     }
 }
 
-void UpdateFrameCode(ID3D12CommandQueue* commandQueue, RenderFrameCode& renderFrameCode, CopyFrameCode& copyFrameCode)
+void UpdateFrameCode(ID3D12CommandQueue* commandQueue,
+                     RenderFrameCode& renderFrameCode,
+                     CopyFrameCode& copyFrameCode,
+                     ComputeFrameCode& computeFrameCode)
 {
-    UpdateFrameCode(commandQueue->GetDesc().Type, renderFrameCode, copyFrameCode);
+    UpdateFrameCode(commandQueue->GetDesc().Type, renderFrameCode, copyFrameCode, computeFrameCode);
 }
 
-void UpdateFrameCode(ID3D12CommandList* commandList, RenderFrameCode& renderFrameCode, CopyFrameCode& copyFrameCode)
+void UpdateFrameCode(ID3D12CommandList* commandList,
+                     RenderFrameCode& renderFrameCode,
+                     CopyFrameCode& copyFrameCode,
+                     ComputeFrameCode& computeFrameCode)
 {
-    UpdateFrameCode(commandList->GetType(), renderFrameCode, copyFrameCode);
+    UpdateFrameCode(commandList->GetType(), renderFrameCode, copyFrameCode, computeFrameCode);
 }
 
 void TrackedDeviceChild::destroy()
@@ -41,21 +73,25 @@ void TrackedDeviceChild::destroy()
     if(mDeviceChild == nullptr) { return; }
 
     DeviceContext::instance().getGraphicsContext().queueObjectForDestruction(mDeviceChild, mLastUsedRenderFrameCode);
+    DeviceContext::instance().getComputeContext().queueObjectForDestruction(mDeviceChild, mLastUsedComputeFrameCode);
     DeviceContext::instance().getCopyContext().queueObjectForDestruction(std::move(mDeviceChild),
                                                                          mLastUsedCopyFrameCode);
 }
 
 void TrackedDeviceChild::markAsUsed(ID3D12CommandQueue* commandQueue)
 {
-    UpdateFrameCode(commandQueue, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    UpdateFrameCode(commandQueue, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode, mLastUsedComputeFrameCode);
 }
 
 void TrackedDeviceChild::markAsUsed(ID3D12CommandList* commandList)
 {
-    UpdateFrameCode(commandList, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    UpdateFrameCode(commandList, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode, mLastUsedComputeFrameCode);
 }
 
-bool IsInUse(D3D12_COMMAND_LIST_TYPE commandListType, RenderFrameCode renderFrameCode, CopyFrameCode copyFrameCode)
+bool IsInUse(D3D12_COMMAND_LIST_TYPE commandListType,
+             RenderFrameCode renderFrameCode,
+             CopyFrameCode copyFrameCode,
+             ComputeFrameCode computeFrameCode)
 {
     switch(commandListType)
     {
@@ -63,6 +99,8 @@ bool IsInUse(D3D12_COMMAND_LIST_TYPE commandListType, RenderFrameCode renderFram
         return renderFrameCode > DeviceContext::instance().getGraphicsContext().getLastCompletedFrameCode();
     case D3D12_COMMAND_LIST_TYPE_COPY:
         return copyFrameCode > DeviceContext::instance().getCopyContext().getLastCompletedFrameCode();
+    case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+        return computeFrameCode > DeviceContext::instance().getComputeContext().getLastCompletedFrameCode();
     default:
         assert(false);
         spdlog::critical("TrackedDeviceChild::isInUse unsupported D3D12_COMMAND_LIST_TYPE '{}'", commandListType);
@@ -72,12 +110,14 @@ bool IsInUse(D3D12_COMMAND_LIST_TYPE commandListType, RenderFrameCode renderFram
 
 bool TrackedDeviceChild::isInUse(ID3D12CommandQueue* commandQueue) const
 {
-    return IsInUse(commandQueue->GetDesc().Type, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    return IsInUse(commandQueue->GetDesc().Type, LoadFrameCode(mLastUsedRenderFrameCode),
+                   LoadFrameCode(mLastUsedCopyFrameCode), LoadFrameCode(mLastUsedComputeFrameCode));
 }
 
 bool TrackedDeviceChild::isInUse(ID3D12CommandList* commandList) const
 {
-    return IsInUse(commandList->GetType(), mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    return IsInUse(commandList->GetType(), LoadFrameCode(mLastUsedRenderFrameCode),
+                   LoadFrameCode(mLastUsedCopyFrameCode), LoadFrameCode(mLastUsedComputeFrameCode));
 }
 
 void TrackedShaderResource::destroy()
@@ -92,6 +132,7 @@ void TrackedShaderResource::destroy()
     DeviceContext& deviceContext = DeviceContext::instance();
 
     deviceContext.getCopyContext().queueObjectForDestruction(mResource, mLastUsedCopyFrameCode);
+    deviceContext.getComputeContext().queueObjectForDestruction(mResource, mLastUsedComputeFrameCode);
 
     if(validDescriptorReservationCount > 0)
     {
@@ -144,21 +185,23 @@ void TrackedShaderResource::setDsvDescriptorHeapReservation(FixedDescriptorHeapR
 
 void TrackedShaderResource::markAsUsed(ID3D12CommandQueue* commandQueue)
 {
-    UpdateFrameCode(commandQueue, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    UpdateFrameCode(commandQueue, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode, mLastUsedComputeFrameCode);
 }
 
 void TrackedShaderResource::markAsUsed(ID3D12CommandList* commandList)
 {
-    UpdateFrameCode(commandList, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    UpdateFrameCode(commandList, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode, mLastUsedComputeFrameCode);
 }
 
 bool TrackedShaderResource::isInUse(ID3D12CommandQueue* commandQueue) const
 {
-    return IsInUse(commandQueue->GetDesc().Type, mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    return IsInUse(commandQueue->GetDesc().Type, LoadFrameCode(mLastUsedRenderFrameCode),
+                   LoadFrameCode(mLastUsedCopyFrameCode), LoadFrameCode(mLastUsedComputeFrameCode));
 }
 
 bool TrackedShaderResource::isInUse(ID3D12CommandList* commandList) const
 {
-    return IsInUse(commandList->GetType(), mLastUsedRenderFrameCode, mLastUsedCopyFrameCode);
+    return IsInUse(commandList->GetType(), LoadFrameCode(mLastUsedRenderFrameCode),
+                   LoadFrameCode(mLastUsedCopyFrameCode), LoadFrameCode(mLastUsedComputeFrameCode));
 }
 } // namespace scrap::d3d12
\ No newline at end of file
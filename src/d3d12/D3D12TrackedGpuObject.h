@@ -56,6 +56,7 @@ public:
 
         mLastUsedRenderFrameCode = RenderFrameCode{};
         mLastUsedCopyFrameCode = CopyFrameCode{};
+        mLastUsedComputeFrameCode = ComputeFrameCode{};
     }
 
 protected:
@@ -64,6 +65,7 @@ protected:
     Microsoft::WRL::ComPtr<ID3D12DeviceChild> mDeviceChild;
     RenderFrameCode mLastUsedRenderFrameCode;
     CopyFrameCode mLastUsedCopyFrameCode;
+    ComputeFrameCode mLastUsedComputeFrameCode;
 };
 
 class TrackedShaderResource
@@ -120,6 +122,7 @@ public:
         destroy();
         mLastUsedRenderFrameCode = RenderFrameCode{};
         mLastUsedCopyFrameCode = CopyFrameCode{};
+        mLastUsedComputeFrameCode = ComputeFrameCode{};
     }
 
 protected:
@@ -131,6 +134,7 @@ protected:
     FixedDescriptorHeapReservation mDsvDescriptorHeapReservation;
     RenderFrameCode mLastUsedRenderFrameCode;
     CopyFrameCode mLastUsedCopyFrameCode;
+    ComputeFrameCode mLastUsedComputeFrameCode;
 };
 
 template<class T>
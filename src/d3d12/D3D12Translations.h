@@ -142,4 +142,31 @@ TranslateRtvDimension(cputex::TextureDimension dimension, size_t arraySize, bool
     default: return D3D12_UAV_DIMENSION_UNKNOWN;
     }
 }
+
+[[nodiscard]] constexpr D3D12_RESOURCE_STATES TranslateResourceState(ResourceState state)
+{
+    D3D12_RESOURCE_STATES d3d12State = D3D12_RESOURCE_STATE_COMMON;
+
+    auto translateFlag = [&](ResourceState flag, D3D12_RESOURCE_STATES d3d12Flag) {
+        if((state & flag) != ResourceState::None) { d3d12State |= d3d12Flag; }
+    };
+
+    translateFlag(ResourceState::VertexAndConstantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+    translateFlag(ResourceState::IndexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+    translateFlag(ResourceState::RenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    translateFlag(ResourceState::UnorderedAccess, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    translateFlag(ResourceState::DepthWrite, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    translateFlag(ResourceState::DepthRead, D3D12_RESOURCE_STATE_DEPTH_READ);
+    translateFlag(ResourceState::NonPixelShaderResource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    translateFlag(ResourceState::PixelShaderResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    translateFlag(ResourceState::IndirectArgument, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+    translateFlag(ResourceState::CopyDest, D3D12_RESOURCE_STATE_COPY_DEST);
+    translateFlag(ResourceState::CopySource, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    translateFlag(ResourceState::ResolveDest, D3D12_RESOURCE_STATE_RESOLVE_DEST);
+    translateFlag(ResourceState::ResolveSource, D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+    translateFlag(ResourceState::RaytracingAccelerationStructure,
+                  D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+
+    return d3d12State;
+}
 } // namespace scrap::d3d12
\ No newline at end of file
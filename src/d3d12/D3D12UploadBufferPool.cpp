@@ -13,76 +13,49 @@ void UploadBufferPool::init()
     pushBackBuffer();
 }
 
-void UploadBufferPool::update()
+void UploadBufferPool::beginFrame(uint32_t frameIndex)
 {
-    for(UploadBuffer& buffer : mUploadBuffers)
-    {
-        buffer.byteOffset = 0;
-    }
-}
-
-UploadBufferMap UploadBufferPool::map(size_t bytes)
-{
-    for(size_t i = 0; i < mUploadBuffers.size(); ++i)
-    {
-        UploadBuffer& uploadBuffer = mUploadBuffers[i];
+    std::lock_guard lockGuard(mMutex);
 
-        const size_t remainingByteSize = uploadBuffer.byteSize - uploadBuffer.byteOffset;
-        if(remainingByteSize >= bytes)
-        {
-            UploadBufferMap bufferMap = mapUnchecked(i, bytes);
-
-            if(bufferMap.writeBuffer.empty()) { continue; }
-        }
-    }
-
-    pushBackBuffer(std::max(bytes, sMinBufferByteSize));
-
-    return mapUnchecked(mUploadBuffers.size() - 1, bytes);
+    mFrameIndex = frameIndex;
+    mFrameSlots[mFrameIndex].allocator.reset();
 }
 
-UploadBufferCopyData UploadBufferPool::unmap(const UploadBufferMap& bufferMap)
+UploadBufferAllocation UploadBufferPool::allocate(size_t byteSize)
 {
-    UploadBuffer& uploadBuffer = mUploadBuffers[bufferMap.bufferIndex];
+    std::lock_guard lockGuard(mMutex);
 
-    UploadBufferCopyData copyData;
-    copyData.buffer = uploadBuffer.buffer.Get();
-    copyData.byteSize = bufferMap.writeBuffer.size();
-    copyData.byteOffset = bufferMap.byteOffset;
+    LinearBufferAllocator& allocator = mFrameSlots[mFrameIndex].allocator;
 
-    D3D12_RANGE range;
-    range.Begin = bufferMap.byteOffset;
-    range.End = bufferMap.writeBuffer.size_bytes();
+    // Buffer sizes are multiples of the alignment, so aligned sizes keep every offset aligned
+    const size_t allocationSize = AlignAllocationSize(byteSize);
 
-    uploadBuffer.buffer->Unmap(0, &range);
+    if(std::optional<size_t> index = allocator.findBuffer(allocationSize); index.has_value())
+    {
+        return allocateUnchecked(index.value(), byteSize);
+    }
 
-    return copyData;
+    if(!pushBackBuffer(std::max(allocationSize, sMinBufferByteSize))) { return {}; }
+
+    return allocateUnchecked(mFrameSlots[mFrameIndex].uploadBuffers.size() - 1, byteSize);
 }
 
-UploadBufferMap UploadBufferPool::mapUnchecked(size_t index, size_t byteSize)
+UploadBufferAllocation UploadBufferPool::allocateUnchecked(size_t index, size_t byteSize)
 {
-    UploadBuffer& uploadBuffer = mUploadBuffers[index];
-
-    D3D12_RANGE range;
-    range.Begin = uploadBuffer.byteOffset;
-    range.End = uploadBuffer.byteOffset + byteSize;
-
-    void* data;
-    HRESULT hr = uploadBuffer.buffer->Map(0, &range, &data);
+    FrameSlot& frameSlot = mFrameSlots[mFrameIndex];
+    ID3D12Resource* uploadBuffer = frameSlot.uploadBuffers[index].Get();
 
-    if(FAILED(hr)) { return {}; }
+    UploadBufferAllocation allocation;
+    allocation.buffer = uploadBuffer;
+    allocation.byteOffset = frameSlot.allocator.allocate(index, AlignAllocationSize(byteSize));
+    allocation.writeBuffer = std::span<std::byte>(frameSlot.mappedData[index] + allocation.byteOffset, byteSize);
+    allocation.gpuVirtualAddress = uploadBuffer->GetGPUVirtualAddress() + allocation.byteOffset;
+    PerfCounters::add(PerfCounter::UploadBytes, byteSize);
 
-    UploadBufferMap bufferMap;
-    bufferMap.bufferIndex = index;
-    bufferMap.writeBuffer = std::span<std::byte>(reinterpret_cast<std::byte*>(data), byteSize);
-    bufferMap.byteOffset = uploadBuffer.byteOffset;
-
-    uploadBuffer.byteOffset += byteSize;
-
-    return bufferMap;
+    return allocation;
 }
 
-void UploadBufferPool::pushBackBuffer(size_t byteSize)
+bool UploadBufferPool::pushBackBuffer(size_t byteSize)
 {
     ID3D12Device* device = d3d12::DeviceContext::instance().getDevice();
 
@@ -117,9 +90,29 @@ void UploadBufferPool::pushBackBuffer(size_t byteSize)
     if(FAILED(hr))
     {
         spdlog::critical("Failed to create upload buffer for UploadBufferPool.");
-        return;
+        return false;
     }
 
-    mUploadBuffers.emplace_back(std::move(uploadResource), bufferDesc.Width);
+    // Mapped until the buffer is released. Nothing is read back.
+    D3D12_RANGE readRange{0, 0};
+    void* data = nullptr;
+    hr = uploadResource->Map(0, &readRange, &data);
+    if(FAILED(hr))
+    {
+        spdlog::critical("Failed to map upload buffer for UploadBufferPool.");
+        return false;
+    }
+
+    FrameSlot& frameSlot = mFrameSlots[mFrameIndex];
+
+    DeviceContext::instance().getCommandCapture().addResource(uploadResource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+    frameSlot.uploadBuffers.push_back(std::move(uploadResource));
+    frameSlot.mappedData.push_back(reinterpret_cast<std::byte*>(data));
+    frameSlot.memoryAllocations.push_back(DeviceContext::instance().getGpuMemoryRegistry().add(
+        {bufferDesc.Width, GpuHeapType::Upload, GpuMemoryCategory::UploadPool, "UploadBufferPool"}));
+    frameSlot.allocator.addBuffer(bufferDesc.Width);
+    mBufferBytesGauge.set(mBufferBytesGauge.get() + (int64_t)bufferDesc.Width);
+
+    return true;
 }
 } // namespace scrap::d3d12
\ No newline at end of file
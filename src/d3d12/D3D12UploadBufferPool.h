@@ -1,52 +1,77 @@
 #pragma once
 
 #include "FreeBlockTracker.h"
+#include "GpuMemoryRegistry.h"
+#include "LinearBufferAllocator.h"
+#include "PerfCounters.h"
+#include "d3d12/D3D12Config.h"
 #include "d3d12/D3D12Fwd.h"
 #include "d3d12/D3D12TrackedGpuObject.h"
 
+#include <array>
+#include <mutex>
 #include <span>
 
 #include <wrl/client.h>
 
 namespace scrap::d3d12
 {
-struct UploadBufferMap
+struct UploadBufferAllocation
 {
     std::span<std::byte> writeBuffer;
-    size_t bufferIndex = 0;
-    size_t byteOffset = 0;
-};
-
-struct UploadBufferCopyData
-{
     ID3D12Resource* buffer = nullptr;
-    size_t byteSize = 0;
     size_t byteOffset = 0;
+    // Of the first byte, for binding the data as a root constant buffer view
+    uint64_t gpuVirtualAddress = 0;
 };
 
+// Hands out upload heap memory for one frame. Every frame in flight has its own buffers, which are reused once the
+// frame's fence has completed. Allocations start at a multiple of the constant buffer alignment, so they can be read
+// by copies or bound as constant buffers directly, and are only writable until the end of the frame.
+//
+// The buffers stay mapped for their whole lifetime, which upload heaps allow, so an allocation is only an offset bump
+// under the lock. Callers that write many small pieces (e.g. a recording worker's object constants) should allocate
+// them in one block and split it up themselves instead of taking the lock for each one.
 class UploadBufferPool
 {
 public:
+    // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+    constexpr static size_t kAllocationAlignment = 256;
+
+    [[nodiscard]] constexpr static size_t AlignAllocationSize(size_t byteSize)
+    {
+        return (byteSize + kAllocationAlignment - 1) & ~(kAllocationAlignment - 1);
+    }
+
     void init();
 
-    void update();
+    // Starts allocating from the frame slot. The gpu has to be done with the frame that last used it.
+    void beginFrame(uint32_t frameIndex);
+
+    // Returns an empty write buffer if no upload buffer could be created
+    UploadBufferAllocation allocate(size_t byteSize);
 
-    UploadBufferMap map(size_t bytes);
-    UploadBufferCopyData unmap(const UploadBufferMap& bufferMap);
-    
 private:
     constexpr static size_t sMinBufferByteSize = 1024 * 1024; // 1MB
 
-    UploadBufferMap mapUnchecked(size_t index, size_t byteSize);
-
-    void pushBackBuffer(size_t byteSize = sMinBufferByteSize);
-
-    struct UploadBuffer
+    struct FrameSlot
     {
-        Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
-        size_t byteSize = 0;
-        size_t byteOffset = 0;
+        // Indexed the same as the allocator's buffers
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploadBuffers;
+        std::vector<std::byte*> mappedData;
+        std::vector<GpuMemoryAllocation> memoryAllocations;
+        LinearBufferAllocator allocator;
     };
-    std::vector<UploadBuffer> mUploadBuffers;
+
+    UploadBufferAllocation allocateUnchecked(size_t index, size_t byteSize);
+
+    bool pushBackBuffer(size_t byteSize = sMinBufferByteSize);
+
+    std::array<FrameSlot, kMaxFramesInFlight> mFrameSlots;
+    uint32_t mFrameIndex = 0;
+    PerfGaugeContribution mBufferBytesGauge{PerfGauge::UploadBufferBytes};
+
+    // allocate can be called from multiple recording threads
+    std::mutex mMutex;
 };
 } // namespace scrap::d3d12
\ No newline at end of file
@@ -1,42 +1,48 @@
 // Main entry point into the program. Creates the Application instance and runs the update loop.
 
 #include "Application.h"
+#include "AsyncLog.h"
+#include "AsyncLogBenchmark.h"
+#include "CpuProfiler.h"
+#include "FramePipeline.h"
+#include "GpuEventLabels.h"
+#include "GpuMemoryRegistry.h"
+#include "InputRecording.h"
+#include "JobSystemBenchmark.h"
+#include "MemoryTracker.h"
+#include "PerfCounters.h"
+#include "StressScene.h"
+#include "d3d12/D3D12CommandCapture.h"
+#include "d3d12/D3D12CommandReplay.h"
+#include "d3d12/D3D12FrameTelemetry.h"
+#include "d3d12/D3D12GpuProfiler.h"
 
 #include <array>
+#include <cwchar>
 #include <locale>
-#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
 
 #include <Windows.h>
+#include <shellapi.h>
 #include <spdlog/sinks/msvc_sink.h>
 #include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/spdlog.h>
 
-// eastl new operators
-void* operator new[](size_t size,
-                     const char* /*pName*/,
-                     int /*flags*/,
-                     unsigned /*debugFlags*/,
-                     const char* /*file*/,
-                     int /*line*/)
+namespace
 {
-    return malloc(size);
-}
-
-void* operator new[](size_t size,
-                     size_t alignment,
-                     size_t alignmentOffset,
-                     const char* /*pName*/,
-                     int /*flags*/,
-                     unsigned /*debugFlags*/,
-                     const char* /*file*/,
-                     int /*line*/)
+// Parses the numeric argument following args[index], if there is one
+uint32_t ParseOptionalCount(std::span<wchar_t*> args, size_t index, uint32_t defaultValue)
 {
-    return _aligned_offset_malloc(size, alignment, alignmentOffset);
+    if(index + 1 >= args.size() || args[index + 1][0] == L'-') { return defaultValue; }
+    return (uint32_t)std::wcstoul(args[index + 1], nullptr, 10);
 }
+} // namespace
 
 int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
                     _In_opt_ HINSTANCE /*hPrevInstance*/,
-                    _In_ PWSTR /*lpCmdLine*/,
+                    _In_ PWSTR lpCmdLine,
                     _In_ int /*nCmdShow*/)
 {
     // Setting up the system preferred locale, which is specified by using and empty string. The locale will inform how
@@ -55,11 +61,231 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
         spdlog::set_default_logger(scrapLogger);
     }
 
-    scrap::Application app;
+    // -nulldevice runs the frame loop against a d3d12 device that records commands without a gpu executing them
+    const bool useNullDevice = std::wstring_view(lpCmdLine).find(L"-nulldevice") != std::wstring_view::npos;
+    const scrap::DeviceBackend deviceBackend =
+        useNullDevice ? scrap::DeviceBackend::Null : scrap::DeviceBackend::Hardware;
+
+    // -capture <frameCount> [firstFrame] writes the commands of frameCount frames to capture.scap.
+    // -replay <file> [iterationCount] replays a capture without opening a window and logs how long each command took.
+    // -pipelined [snapshotCount] renders on a separate thread with 2 (default) or 3 RenderParams snapshots.
+    // -frametiming [frameCount] logs the frame time and input to submit latency every frameCount frames.
+    // -framesinflight <count> lets the cpu record 1 to 4 frames ahead of the gpu.
+    // -telemetry [frameCount] logs the cpu wait, gpu idle and present latency every frameCount frames.
+    // -benchmarkjobs [maxThreadCount] runs the job system microbenchmarks without opening a window.
+    // -benchmarklog measures the cost of a log call on the calling thread without opening a window.
+    // -verboselog logs debug messages. Together with -frametiming it shows what verbose logging costs a frame.
+    // -cpuprofile [frameCount] logs the tree of SCRAP_CPU_ZONE timings every frameCount frames.
+    // -cpucapture <frameCount> [firstFrame] writes the SCRAP_CPU_ZONEs of frameCount frames to cpu_capture.json, which
+    // opens in chrome://tracing.
+    // -gpuprofile [frameCount] times the ScopedGpuEvents with timestamp queries and logs them every frameCount frames.
+    // With -cpuprofile the gpu times are also part of the cpu profile report.
+    // -gpuobjectevents records a gpu event for every render object, for looking at a frame in PIX. Debug builds only.
+    // -gpumemory [frameCount] [allocationCount] logs the committed gpu memory of every category and the allocationCount
+    // largest allocations every frameCount frames.
+    // -gpumemorybudget <MiB> warns when the committed gpu memory exceeds MiB instead of the budget the adapter reports.
+    // -memorytags [frameCount] logs the cpu memory and allocations of every SCRAP_MEMORY_TAG every frameCount frames.
+    // -perfcounters [frameCount] logs the perf counters and gauges every frameCount frames.
+    // -perfcounterfile <file> writes the perf counters of every frame to file, as json lines if it ends in .json and
+    // as csv otherwise.
+    // -stressscene [file] replaces the cube with the stress scene the config file describes, or the default
+    // StressSceneConfig without a file.
+    // -recordinput <file> writes the keyboard and mouse input and the frame times of every frame to file on exit.
+    // -replayinput <file> [fps] replays the input in file instead of the live input and quits at its end. Frames
+    // advance by a fixed 1/fps seconds, or by the recorded frame times without fps.
+    scrap::d3d12::CommandCaptureParams commandCaptureParams;
+    scrap::FramePipelineParams framePipelineParams;
+    scrap::d3d12::FramePacingParams framePacingParams;
+    scrap::d3d12::GpuProfilerParams gpuProfilerParams;
+    scrap::GpuMemoryParams gpuMemoryParams;
+    std::filesystem::path replayFilePath;
+    uint32_t replayIterationCount = 1;
+    uint32_t jobBenchmarkMaxThreadCount = 0;
+    bool runLogBenchmark = false;
+    bool verboseLogging = false;
+    scrap::CpuProfilerParams cpuProfilerParams;
+    scrap::PerfCounterRecorderParams perfCounterParams;
+    scrap::MemoryTagRecorderParams memoryTagParams;
+    std::optional<scrap::StressSceneConfig> stressSceneConfig;
+    scrap::InputRecordingParams inputRecordingParams;
+    {
+        int argCount = 0;
+        LPWSTR* argValues = CommandLineToArgvW(GetCommandLineW(), &argCount);
+        std::span<wchar_t*> args(argValues, (argValues != nullptr) ? (size_t)argCount : 0);
+
+        for(size_t i = 0; i < args.size(); ++i)
+        {
+            const std::wstring_view arg = args[i];
+            if(arg == L"-capture")
+            {
+                commandCaptureParams.filePath = "capture.scap";
+                commandCaptureParams.frameCount = ParseOptionalCount(args, i, 0);
+                if(commandCaptureParams.frameCount == 0) { commandCaptureParams.frameCount = 1; }
+                else { commandCaptureParams.firstFrame = ParseOptionalCount(args, i + 1, 0); }
+            }
+            else if(arg == L"-pipelined")
+            {
+                framePipelineParams.snapshotCount = ParseOptionalCount(args, i, 2);
+            }
+            else if(arg == L"-frametiming")
+            {
+                framePipelineParams.timingReportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-framesinflight")
+            {
+                framePacingParams.framesInFlight = ParseOptionalCount(args, i, scrap::d3d12::kDefaultFramesInFlight);
+            }
+            else if(arg == L"-telemetry")
+            {
+                framePacingParams.telemetryReportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-benchmarkjobs")
+            {
+                jobBenchmarkMaxThreadCount = ParseOptionalCount(args, i, 64);
+            }
+            else if(arg == L"-benchmarklog")
+            {
+                runLogBenchmark = true;
+            }
+            else if(arg == L"-verboselog")
+            {
+                verboseLogging = true;
+            }
+            else if(arg == L"-cpuprofile")
+            {
+                cpuProfilerParams.reportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-gpuprofile")
+            {
+                gpuProfilerParams.enabled = true;
+                gpuProfilerParams.reportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-gpuobjectevents")
+            {
+                scrap::SetGpuEventVerbosity(scrap::GpuEventVerbosity::Objects);
+            }
+            else if(arg == L"-gpumemory")
+            {
+                gpuMemoryParams.reportInterval = ParseOptionalCount(args, i, 300);
+                gpuMemoryParams.reportAllocationCount =
+                    ParseOptionalCount(args, i + 1, gpuMemoryParams.reportAllocationCount);
+            }
+            else if(arg == L"-gpumemorybudget")
+            {
+                gpuMemoryParams.budgetBytes = (uint64_t)ParseOptionalCount(args, i, 0) * 1024 * 1024;
+            }
+            else if(arg == L"-cpucapture")
+            {
+                cpuProfilerParams.captureFilePath = "cpu_capture.json";
+                cpuProfilerParams.captureFrameCount = ParseOptionalCount(args, i, 0);
+                if(cpuProfilerParams.captureFrameCount == 0) { cpuProfilerParams.captureFrameCount = 1; }
+                else { cpuProfilerParams.captureFirstFrame = ParseOptionalCount(args, i + 1, 0); }
+            }
+            else if(arg == L"-memorytags")
+            {
+                memoryTagParams.reportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-perfcounters")
+            {
+                perfCounterParams.reportInterval = ParseOptionalCount(args, i, 300);
+            }
+            else if(arg == L"-perfcounterfile" && i + 1 < args.size())
+            {
+                perfCounterParams.filePath = args[i + 1];
+            }
+            else if(arg == L"-stressscene")
+            {
+                if(i + 1 < args.size() && args[i + 1][0] != L'-')
+                {
+                    stressSceneConfig = scrap::ReadStressSceneConfig(args[i + 1]);
+                    if(!stressSceneConfig.has_value())
+                    {
+                        LocalFree(argValues);
+                        scrapLogger->flush();
+                        return 1;
+                    }
+                }
+                else { stressSceneConfig = scrap::StressSceneConfig{}; }
+            }
+            else if(arg == L"-recordinput" && i + 1 < args.size())
+            {
+                inputRecordingParams.recordFilePath = args[i + 1];
+            }
+            else if(arg == L"-replayinput" && i + 1 < args.size())
+            {
+                inputRecordingParams.replayFilePath = args[i + 1];
+                const uint32_t framesPerSecond = ParseOptionalCount(args, i + 1, 0);
+                if(framesPerSecond > 0)
+                {
+                    inputRecordingParams.fixedTimestep =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(1)) / framesPerSecond;
+                }
+            }
+            else if(arg == L"-replay" && i + 1 < args.size())
+            {
+                replayFilePath = args[i + 1];
+                replayIterationCount = ParseOptionalCount(args, i + 1, 1);
+            }
+        }
+
+        LocalFree(argValues);
+    }
+
+    if(!replayFilePath.empty())
+    {
+        const int result = scrap::d3d12::RunCommandReplay(replayFilePath, deviceBackend, replayIterationCount);
+        scrapLogger->flush();
+        return result;
+    }
+
+    if(jobBenchmarkMaxThreadCount > 0)
+    {
+        scrap::LogJobSystemBenchmarkReport(scrap::RunJobSystemBenchmarks(jobBenchmarkMaxThreadCount));
+        scrapLogger->flush();
+        return 0;
+    }
+
+    if(runLogBenchmark)
+    {
+        scrap::LogAsyncLogBenchmarkReport(scrap::RunAsyncLogBenchmark());
+        scrapLogger->flush();
+        return 0;
+    }
+
+    if(verboseLogging) { scrapLogger->set_level(spdlog::level::debug); }
+
+    // Formats the SCRAP_LOG_* messages and flushes the sinks on its own thread. Outlives the application so nothing
+    // logged during shutdown is lost.
+    scrap::AsyncLog asyncLog(scrapLogger);
+
+    // SCRAP_CPU_ZONEs only record while there is a profiler
+    SCRAP_CPU_THREAD_NAME("Main");
+    std::optional<scrap::CpuProfiler> cpuProfiler;
+    if(cpuProfilerParams.reportInterval > 0 || cpuProfilerParams.captureFrameCount > 0)
+    {
+        cpuProfiler.emplace(cpuProfilerParams);
+    }
+
+    std::optional<scrap::PerfCounterRecorder> perfCounterRecorder;
+    if(perfCounterParams.reportInterval > 0 || !perfCounterParams.filePath.empty())
+    {
+        perfCounterRecorder.emplace(perfCounterParams);
+    }
+
+    std::optional<scrap::MemoryTagRecorder> memoryTagRecorder;
+    if(memoryTagParams.reportInterval > 0) { memoryTagRecorder.emplace(memoryTagParams); }
+
+    scrap::Application app(deviceBackend, commandCaptureParams, framePipelineParams, framePacingParams,
+                           gpuProfilerParams, gpuMemoryParams,
+                           stressSceneConfig.has_value() ? &stressSceneConfig.value() : nullptr, inputRecordingParams);
+    uint64_t frameNumber = 0;
     while(app)
     {
         app.update();
-        scrapLogger->flush();
+        if(cpuProfiler) { cpuProfiler->endFrame(frameNumber); }
+        if(perfCounterRecorder) { perfCounterRecorder->endFrame(frameNumber); }
+        if(memoryTagRecorder) { memoryTagRecorder->endFrame(frameNumber); }
+        ++frameNumber;
     }
 
     return 0;